@@ -12,6 +12,8 @@
 #include <OpenTissue/collision/aabb_tree/policies/aabb_tree_refitter_policy.h>
 #include <OpenTissue/collision/aabb_tree/policies/aabb_tree_self_collision_policy.h>
 #include <OpenTissue/collision/aabb_tree/policies/aabb_tree_single_collision_policy.h>
+#include <OpenTissue/collision/aabb_tree/policies/aabb_tree_ray_policy.h>
+#include <OpenTissue/collision/aabb_tree/policies/aabb_tree_distance_policy.h>
 #include <OpenTissue/collision/aabb_tree/policies/aabb_tree_graph_converter.h>
 #include <OpenTissue/collision/aabb_tree/policies/aabb_tree_bottom_up_constructor_policy.h>
 
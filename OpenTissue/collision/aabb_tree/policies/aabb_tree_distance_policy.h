@@ -0,0 +1,329 @@
+#ifndef OPENTISSUE_COLLISION_AABB_TREE_POLICIES_AABB_TREE_DISTANCE_POLICY_H
+#define OPENTISSUE_COLLISION_AABB_TREE_POLICIES_AABB_TREE_DISTANCE_POLICY_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+namespace OpenTissue
+{
+  namespace aabb_tree
+  {
+
+    /**
+    * AABB Tree Distance Policy.
+    * This policy is used by the bvh::DistanceQuery to find the closest
+    * points on the triangles of an AABB tree, either to a point or to
+    * another triangle.
+    */
+    template<typename aabb_tree_geometry>
+    class DistancePolicy
+    {
+    public:
+
+      typedef typename aabb_tree_geometry::bvh_type       bvh_type;
+      typedef typename bvh_type::volume_type              volume_type;
+      typedef typename bvh_type::geometry_type            geometry_type;
+
+      typedef typename volume_type::math_types            math_types;
+      typedef typename math_types::real_type              real_type;
+      typedef typename math_types::vector3_type           vector3_type;
+
+    public:
+
+      /**
+      * Closest Point on Triangle.
+      * Classifies the point against the Voronoi regions of the vertices,
+      * edges and face of the triangle, as described by Ericson in "Real-Time
+      * Collision Detection". Degenerate triangles are handled.
+      *
+      * @param triangle   The triangle.
+      * @param p          The point.
+      * @param q          Upon return holds the point on the triangle closest to p.
+      *
+      * @return           The squared distance between p and q.
+      */
+      real_type closest_point(
+        geometry_type const & triangle
+        , vector3_type const & p
+        , vector3_type & q
+        ) const
+      {
+        return point_triangle( triangle.m_p0->position(), triangle.m_p1->position(), triangle.m_p2->position(), p, q );
+      }
+
+      /**
+      * Closest Points between Triangles.
+      * If an edge of either triangle crosses the other triangle then the
+      * triangles intersect, and the crossing point is returned. Otherwise
+      * the closest points are realized by a vertex of one triangle and the
+      * other triangle, or by a pair of edges, and all these combinations are
+      * tested. Degenerate triangles are handled.
+      *
+      * @param triangle   The triangle of the AABB tree.
+      * @param a          The first corner of the other triangle.
+      * @param b          The second corner of the other triangle.
+      * @param c          The third corner of the other triangle.
+      * @param p          Upon return holds the point on the triangle of the AABB tree closest to the other triangle.
+      * @param q          Upon return holds the point on the other triangle closest to p.
+      *
+      * @return           The squared distance between p and q, zero if the triangles intersect.
+      */
+      real_type closest_points(
+        geometry_type const & triangle
+        , vector3_type const & a
+        , vector3_type const & b
+        , vector3_type const & c
+        , vector3_type & p
+        , vector3_type & q
+        ) const
+      {
+        vector3_type const s[3] = { triangle.m_p0->position(), triangle.m_p1->position(), triangle.m_p2->position() };
+        vector3_type const t[3] = { a, b, c };
+
+        for(size_t i = 0u; i < 3u; ++i)
+        {
+          size_t const j = (i + 1u) % 3u;
+          if( segment_triangle( t[i], t[j], s[0], s[1], s[2], p ) || segment_triangle( s[i], s[j], t[0], t[1], t[2], p ) )
+          {
+            q = p;
+            return real_type(0);
+          }
+        }
+
+        vector3_type x;
+        vector3_type y;
+        real_type best = point_triangle( s[0], s[1], s[2], t[0], p );
+        q = t[0];
+        for(size_t i = 0u; i < 3u; ++i)
+        {
+          if( i > 0u )
+          {
+            real_type const d2 = point_triangle( s[0], s[1], s[2], t[i], x );
+            if( d2 < best )
+            {
+              best = d2;
+              p    = x;
+              q    = t[i];
+            }
+          }
+          real_type const d2 = point_triangle( t[0], t[1], t[2], s[i], y );
+          if( d2 < best )
+          {
+            best = d2;
+            p    = s[i];
+            q    = y;
+          }
+        }
+
+        for(size_t i = 0u; i < 3u; ++i)
+          for(size_t j = 0u; j < 3u; ++j)
+          {
+            real_type const d2 = segment_segment( s[i], s[(i + 1u) % 3u], t[j], t[(j + 1u) % 3u], x, y );
+            if( d2 < best )
+            {
+              best = d2;
+              p    = x;
+              q    = y;
+            }
+          }
+        return best;
+      }
+
+    protected:
+
+      /**
+      * Closest Point on Triangle.
+      * Classifies the point against the Voronoi regions of the vertices,
+      * edges and face of the triangle, as described by Ericson in "Real-Time
+      * Collision Detection".
+      */
+      static real_type point_triangle(
+        vector3_type const & a
+        , vector3_type const & b
+        , vector3_type const & c
+        , vector3_type const & p
+        , vector3_type & q
+        )
+      {
+        vector3_type const ab = b - a;
+        vector3_type const ac = c - a;
+
+        vector3_type const ap = p - a;
+        real_type    const d1 = dot( ab, ap );
+        real_type    const d2 = dot( ac, ap );
+        if( d1 <= real_type(0) && d2 <= real_type(0) )
+          return finish( p, a, q );
+
+        vector3_type const bp = p - b;
+        real_type    const d3 = dot( ab, bp );
+        real_type    const d4 = dot( ac, bp );
+        if( d3 >= real_type(0) && d4 <= d3 )
+          return finish( p, b, q );
+
+        real_type const vc = d1*d4 - d3*d2;
+        if( vc <= real_type(0) && d1 >= real_type(0) && d3 <= real_type(0) && d1 - d3 > real_type(0) )
+          return finish( p, a + ab*( d1 / (d1 - d3) ), q );
+
+        vector3_type const cp = p - c;
+        real_type    const d5 = dot( ab, cp );
+        real_type    const d6 = dot( ac, cp );
+        if( d6 >= real_type(0) && d5 <= d6 )
+          return finish( p, c, q );
+
+        real_type const vb = d5*d2 - d1*d6;
+        if( vb <= real_type(0) && d2 >= real_type(0) && d6 <= real_type(0) && d2 - d6 > real_type(0) )
+          return finish( p, a + ac*( d2 / (d2 - d6) ), q );
+
+        real_type const va = d3*d6 - d5*d4;
+        if( va <= real_type(0) && (d4 - d3) >= real_type(0) && (d5 - d6) >= real_type(0) && (d4 - d3) + (d5 - d6) > real_type(0) )
+          return finish( p, b + (c - b)*( (d4 - d3) / ((d4 - d3) + (d5 - d6)) ), q );
+
+        real_type const sum = va + vb + vc;
+        if( sum > real_type(0) )
+          return finish( p, a + ab*(vb/sum) + ac*(vc/sum), q );
+
+        //--- Degenerate triangle, the closest point lies on one of the edges
+        real_type best = finish( p, a, q );
+        edge( p, a, b, best, q );
+        edge( p, b, c, best, q );
+        edge( p, c, a, best, q );
+        return best;
+      }
+
+      /**
+      * Segment Triangle Crossing.
+      * Tests whether the segment crosses the plane of the triangle inside the
+      * triangle. Segments lying in the plane of the triangle are not reported,
+      * such contacts are found by the vertex and edge distances.
+      *
+      * @return   If the segment crosses the triangle then the return value is
+      *           true and x holds the crossing point, otherwise it is false.
+      */
+      static bool segment_triangle(
+        vector3_type const & s0
+        , vector3_type const & s1
+        , vector3_type const & a
+        , vector3_type const & b
+        , vector3_type const & c
+        , vector3_type & x
+        )
+      {
+        vector3_type const n  = cross( b - a, c - a );
+        real_type    const d0 = dot( n, s0 - a );
+        real_type    const d1 = dot( n, s1 - a );
+        if( d0 == d1 || (d0 > real_type(0) && d1 > real_type(0)) || (d0 < real_type(0) && d1 < real_type(0)) )
+          return false;
+        vector3_type const y = s0 + (s1 - s0)*( d0 / (d0 - d1) );
+        if( dot( cross( b - a, y - a ), n ) < real_type(0) )
+          return false;
+        if( dot( cross( c - b, y - b ), n ) < real_type(0) )
+          return false;
+        if( dot( cross( a - c, y - c ), n ) < real_type(0) )
+          return false;
+        x = y;
+        return true;
+      }
+
+      /**
+      * Closest Points between Segments.
+      * As described by Ericson in "Real-Time Collision Detection", segments
+      * of zero length are handled.
+      *
+      * @return   The squared distance between x on the first segment and y on the second segment.
+      */
+      static real_type segment_segment(
+        vector3_type const & p0
+        , vector3_type const & p1
+        , vector3_type const & q0
+        , vector3_type const & q1
+        , vector3_type & x
+        , vector3_type & y
+        )
+      {
+        vector3_type const d1 = p1 - p0;
+        vector3_type const d2 = q1 - q0;
+        vector3_type const r  = p0 - q0;
+        real_type    const a  = dot( d1, d1 );
+        real_type    const e  = dot( d2, d2 );
+        real_type    const f  = dot( d2, r );
+
+        real_type s = real_type(0);
+        real_type t = real_type(0);
+        if( a > real_type(0) || e > real_type(0) )
+        {
+          if( a <= real_type(0) )
+          {
+            t = clamp( f / e );
+          }
+          else
+          {
+            real_type const c = dot( d1, r );
+            if( e <= real_type(0) )
+            {
+              s = clamp( -c / a );
+            }
+            else
+            {
+              real_type const b     = dot( d1, d2 );
+              real_type const denom = a*e - b*b;
+              s = denom > real_type(0) ? clamp( (b*f - c*e) / denom ) : real_type(0);
+              t = (b*s + f) / e;
+              if( t < real_type(0) )
+              {
+                t = real_type(0);
+                s = clamp( -c / a );
+              }
+              else if( t > real_type(1) )
+              {
+                t = real_type(1);
+                s = clamp( (b - c) / a );
+              }
+            }
+          }
+        }
+        x = p0 + d1*s;
+        y = q0 + d2*t;
+        vector3_type const d = x - y;
+        return dot( d, d );
+      }
+
+      static real_type clamp(real_type const & t)
+      {
+        return t < real_type(0) ? real_type(0) : ( t > real_type(1) ? real_type(1) : t );
+      }
+
+      static real_type finish(vector3_type const & p, vector3_type const & x, vector3_type & q)
+      {
+        q = x;
+        vector3_type const d = p - x;
+        return dot( d, d );
+      }
+
+      static void edge(vector3_type const & p, vector3_type const & a, vector3_type const & b, real_type & best, vector3_type & q)
+      {
+        vector3_type const ab = b - a;
+        real_type    const l2 = dot( ab, ab );
+        real_type          t  = l2 > real_type(0) ? dot( p - a, ab ) / l2 : real_type(0);
+        t = t < real_type(0) ? real_type(0) : ( t > real_type(1) ? real_type(1) : t );
+        vector3_type x;
+        real_type const d2 = finish( p, a + ab*t, x );
+        if( d2 < best )
+        {
+          best = d2;
+          q    = x;
+        }
+      }
+
+    };
+
+  } // namespace aabb_tree
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_AABB_TREE_POLICIES_AABB_TREE_DISTANCE_POLICY_H
+#endif
@@ -0,0 +1,99 @@
+#ifndef OPENTISSUE_COLLISION_AABB_TREE_POLICIES_AABB_TREE_RAY_POLICY_H
+#define OPENTISSUE_COLLISION_AABB_TREE_POLICIES_AABB_TREE_RAY_POLICY_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace aabb_tree
+  {
+
+    /**
+    * AABB Tree Ray Policy.
+    * This policy is used by the bvh::RayQuery to test rays against the
+    * triangles of an AABB tree. Triangles are two-sided.
+    */
+    template<typename aabb_tree_geometry>
+    class RayPolicy
+    {
+    public:
+
+      typedef typename aabb_tree_geometry::bvh_type       bvh_type;
+      typedef typename bvh_type::volume_type              volume_type;
+      typedef typename bvh_type::geometry_type            geometry_type;
+
+      typedef typename volume_type::math_types            math_types;
+      typedef typename math_types::real_type              real_type;
+      typedef typename math_types::vector3_type           vector3_type;
+
+    public:
+
+      /**
+      * Ray Triangle Intersection Test.
+      * Uses the method by Moller and Trumbore.
+      *
+      * @param triangle   The triangle.
+      * @param p          The origin of the ray.
+      * @param r          The direction of the ray.
+      * @param t_max      The maximum ray parameter.
+      * @param t          Upon return holds the ray parameter of the intersection point.
+      *
+      * @return           If the ray p + t r hits the triangle for some t in [0..t_max] then
+      *                   the return value is true otherwise it is false.
+      */
+      bool intersect(
+        geometry_type const & triangle
+        , vector3_type const & p
+        , vector3_type const & r
+        , real_type const & t_max
+        , real_type & t
+        ) const
+      {
+        using std::fabs;
+
+        vector3_type const x0 = triangle.m_p0->position();
+        vector3_type const e1 = triangle.m_p1->position() - x0;
+        vector3_type const e2 = triangle.m_p2->position() - x0;
+
+        vector3_type const h = cross( r, e2 );
+        real_type    const a = dot( e1, h );
+
+        //--- Ray is parallel to the plane of the triangle
+        if( fabs(a) <= math::working_precision<real_type>() * length(e1) * length(e2) * length(r) )
+          return false;
+
+        real_type    const f = real_type(1) / a;
+        vector3_type const s = p - x0;
+        real_type    const u = f * dot( s, h );
+        if( u < real_type(0) || u > real_type(1) )
+          return false;
+
+        vector3_type const q = cross( s, e1 );
+        real_type    const v = f * dot( r, q );
+        if( v < real_type(0) || u + v > real_type(1) )
+          return false;
+
+        real_type const s_t = f * dot( e2, q );
+        if( s_t < real_type(0) || s_t > t_max )
+          return false;
+
+        t = s_t;
+        return true;
+      }
+
+    };
+
+  } // namespace aabb_tree
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_AABB_TREE_POLICIES_AABB_TREE_RAY_POLICY_H
+#endif
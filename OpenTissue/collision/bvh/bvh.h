@@ -15,6 +15,9 @@
 #include <OpenTissue/collision/bvh/bvh_world_collision_query.h>
 #include <OpenTissue/collision/bvh/bvh_model_collision_query.h>
 #include <OpenTissue/collision/bvh/bvh_single_collision_query.h>
+#include <OpenTissue/collision/bvh/bvh_flat_tree.h>
+#include <OpenTissue/collision/bvh/bvh_ray_query.h>
+#include <OpenTissue/collision/bvh/bvh_distance_query.h>
 
 #include <OpenTissue/collision/bvh/bvh_bottom_up_refitter.h>
 
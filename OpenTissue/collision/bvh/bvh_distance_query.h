@@ -0,0 +1,625 @@
+#ifndef OPENTISSUE_COLLISION_BVH_BVH_DISTANCE_QUERY_H
+#define OPENTISSUE_COLLISION_BVH_BVH_DISTANCE_QUERY_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/bvh/bvh_flat_tree.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace bvh
+  {
+
+    /**
+    * Distance Hit.
+    * A geometry found by a distance query.
+    */
+    template<typename real_type, typename vector3_type, typename geometry_type>
+    class DistanceHit
+    {
+    public:
+
+      real_type             m_distance;   ///< The distance from the query point (or triangle) to the geometry.
+      vector3_type          m_point;      ///< The point on the geometry closest to the query point (or triangle).
+      geometry_type const * m_geometry;   ///< The geometry, null if nothing was found.
+
+    public:
+
+      DistanceHit()
+        : m_distance()
+        , m_point()
+        , m_geometry(0)
+      {}
+
+      bool operator<(DistanceHit const & hit) const { return m_distance < hit.m_distance; }
+
+    };
+
+    /**
+    * Distance Query.
+    * This query finds the geometry of a BVH with axis aligned bounding volumes
+    * (the volume type must provide min() and max() corners) that is closest
+    * to a point. It supports closest point, k-nearest and within-radius
+    * queries for single points and for large batches of points. Besides
+    * points, it finds the geometry closest to a triangle, and the closest
+    * pair of points between a triangle mesh and the geometry of the BVH.
+    *
+    * Prior to any query the BVH must be flattened by invoking init(), see
+    * bvh::FlatTree. Whenever the volumes of the BVH are refitted init() must
+    * be invoked again.
+    *
+    * Closest point and k-nearest queries are branch-and-bound searches.
+    * Nodes are kept in a priority queue ordered by the distance from the
+    * point to their boxes, and the search ends as soon as the closest box
+    * is farther away than the best geometry found so far. The search can be
+    * started with an upper bound, either a maximum distance or a starting
+    * guess such as the closest geometry of the previous frame. When the
+    * point moves coherently the guess is close to optimal, and only the
+    * few nodes near the point are visited.
+    *
+    * The distance policy must provide a method
+    *
+    *   real_type closest_point(geometry_type const & g, vector3_type const & p, vector3_type & q) const
+    *
+    * that computes the point q on the geometry closest to p and returns the squared
+    * distance between p and q. The method must be thread-safe since batch queries
+    * invoke it from multiple threads. Triangle and mesh queries furthermore need
+    * a method
+    *
+    *   real_type closest_points(geometry_type const & g, vector3_type const & a, vector3_type const & b, vector3_type const & c, vector3_type & p, vector3_type & q) const
+    *
+    * that computes the closest points p on the geometry and q on the triangle
+    * with corners a, b and c, and returns the squared distance between them.
+    * These searches use the distance between the box of a node and the box of
+    * the query triangle as lower bound.
+    *
+    * @tparam bvh_type         The BVH type.
+    * @tparam distance_policy  The distance policy, computing closest points on the geometry of the leaves.
+    */
+    template <typename bvh_type, typename distance_policy>
+    class DistanceQuery
+      : public distance_policy
+      , public FlatTree<bvh_type>
+    {
+    public:
+
+      typedef          FlatTree<bvh_type>                                 flat_tree_type;
+      typedef typename bvh_type::geometry_type                            geometry_type;
+      typedef typename bvh_type::volume_type                              volume_type;
+      typedef typename volume_type::vector3_type                          vector3_type;
+      typedef typename volume_type::real_type                             real_type;
+      typedef          DistanceHit<real_type, vector3_type, geometry_type>  hit_type;
+
+    protected:
+
+      typedef typename flat_tree_type::Node                               Node;
+
+      using flat_tree_type::m_nodes;
+      using flat_tree_type::m_geometry;
+
+      /**
+      * Priority Queue Entry.
+      */
+      class Entry
+      {
+      public:
+
+        real_type  m_d2;        ///< Squared distance from the query point to the box of the node.
+        size_t     m_node;      ///< Index of the node.
+
+        bool operator<(Entry const & entry) const { return m_d2 > entry.m_d2; }   //--- Closest node on top of the heap
+
+      };
+
+    public:
+
+      /**
+      * Closest Point Query.
+      *
+      * @param p              The query point.
+      * @param max_distance   Only geometries closer than this distance are considered.
+      * @param hit            Upon return holds the closest geometry (if any).
+      * @param guess          A geometry that is expected to be close to the point,
+      *                       for instance the closest geometry of the previous frame,
+      *                       can be null. The guess only affects performance.
+      *
+      * @return               If any geometry was found within the maximum distance then
+      *                       the return value is true otherwise it is false.
+      */
+      bool closest_point(
+        vector3_type const & p
+        , real_type const & max_distance
+        , hit_type & hit
+        , geometry_type const * guess = 0
+        ) const
+      {
+        real_type best = max_distance*max_distance;
+        hit.m_distance = max_distance;
+        hit.m_geometry = 0;
+
+        if( guess )
+        {
+          vector3_type q;
+          real_type const d2 = distance_policy::closest_point( *guess, p, q );
+          if( d2 <= best )
+          {
+            best           = d2;
+            hit.m_point    = q;
+            hit.m_geometry = guess;
+          }
+        }
+
+        if( m_nodes.empty() )
+          return finish( best, hit );
+
+        std::vector<Entry> queue;
+        push( queue, p, 0u, best );
+        while( !queue.empty() )
+        {
+          std::pop_heap( queue.begin(), queue.end() );
+          Entry const entry = queue.back();
+          queue.pop_back();
+
+          //--- All remaining nodes are farther away than the best geometry
+          if( entry.m_d2 > best )
+            break;
+
+          Node const & node = m_nodes[entry.m_node];
+          if( node.m_count > 0u )
+          {
+            for(size_t g = node.m_first; g < node.m_first + node.m_count; ++g)
+            {
+              if( m_geometry[g] == guess )
+                continue;
+              vector3_type q;
+              real_type const d2 = distance_policy::closest_point( *m_geometry[g], p, q );
+              if( d2 < best || (d2 == best && !hit.m_geometry) )
+              {
+                best           = d2;
+                hit.m_point    = q;
+                hit.m_geometry = m_geometry[g];
+              }
+            }
+            continue;
+          }
+          for(size_t c = entry.m_node + 1u; c < node.m_skip; c = m_nodes[c].m_skip)
+            push( queue, p, c, best );
+        }
+        return finish( best, hit );
+      }
+
+      /**
+      * K-Nearest Query.
+      *
+      * @param p              The query point.
+      * @param k              The number of geometries to find.
+      * @param max_distance   Only geometries closer than this distance are considered.
+      * @param hits           Upon return holds at most k geometries sorted by increasing distance.
+      *
+      * @return               The number of geometries found.
+      */
+      size_t k_nearest(
+        vector3_type const & p
+        , size_t k
+        , real_type const & max_distance
+        , std::vector<hit_type> & hits
+        ) const
+      {
+        using std::sqrt;
+
+        hits.clear();
+        if( k == 0u || m_nodes.empty() )
+          return 0u;
+
+        //--- The hits form a max-heap, such that the k'th closest geometry is on top
+        real_type bound = max_distance*max_distance;
+        std::vector<Entry> queue;
+        push( queue, p, 0u, bound );
+        while( !queue.empty() )
+        {
+          std::pop_heap( queue.begin(), queue.end() );
+          Entry const entry = queue.back();
+          queue.pop_back();
+          if( entry.m_d2 > bound )
+            break;
+
+          Node const & node = m_nodes[entry.m_node];
+          if( node.m_count > 0u )
+          {
+            for(size_t g = node.m_first; g < node.m_first + node.m_count; ++g)
+            {
+              hit_type hit;
+              real_type const d2 = distance_policy::closest_point( *m_geometry[g], p, hit.m_point );
+              if( d2 > bound || (hits.size() == k && d2 == bound) )
+                continue;
+              hit.m_distance = d2;
+              hit.m_geometry = m_geometry[g];
+              if( hits.size() == k )
+              {
+                std::pop_heap( hits.begin(), hits.end() );
+                hits.pop_back();
+              }
+              hits.push_back( hit );
+              std::push_heap( hits.begin(), hits.end() );
+              if( hits.size() == k )
+                bound = hits.front().m_distance;
+            }
+            continue;
+          }
+          for(size_t c = entry.m_node + 1u; c < node.m_skip; c = m_nodes[c].m_skip)
+            push( queue, p, c, bound );
+        }
+
+        std::sort_heap( hits.begin(), hits.end() );
+        for(size_t i = 0u; i < hits.size(); ++i)
+          hits[i].m_distance = sqrt( hits[i].m_distance );
+        return hits.size();
+      }
+
+      /**
+      * Within Radius Query.
+      *
+      * @param p              The query point.
+      * @param radius         The radius.
+      * @param hits           Upon return holds all geometries within the radius of
+      *                       the point, sorted by increasing distance.
+      *
+      * @return               The number of geometries found.
+      */
+      size_t within_radius(
+        vector3_type const & p
+        , real_type const & radius
+        , std::vector<hit_type> & hits
+        ) const
+      {
+        using std::sqrt;
+
+        hits.clear();
+        if( m_nodes.empty() )
+          return 0u;
+
+        real_type const r2 = radius*radius;
+
+        //--- Every node within the radius is visited, so a depth-first traversal is used
+        std::vector<size_t> stack;
+        if( box_distance2( m_nodes[0], p ) <= r2 )
+          stack.push_back( 0u );
+        while( !stack.empty() )
+        {
+          size_t const idx = stack.back();
+          stack.pop_back();
+
+          Node const & node = m_nodes[idx];
+          if( node.m_count > 0u )
+          {
+            for(size_t g = node.m_first; g < node.m_first + node.m_count; ++g)
+            {
+              hit_type hit;
+              real_type const d2 = distance_policy::closest_point( *m_geometry[g], p, hit.m_point );
+              if( d2 > r2 )
+                continue;
+              hit.m_distance = sqrt( d2 );
+              hit.m_geometry = m_geometry[g];
+              hits.push_back( hit );
+            }
+            continue;
+          }
+          for(size_t c = idx + 1u; c < node.m_skip; c = m_nodes[c].m_skip)
+            if( box_distance2( m_nodes[c], p ) <= r2 )
+              stack.push_back( c );
+        }
+        std::sort( hits.begin(), hits.end() );
+        return hits.size();
+      }
+
+      /**
+      * Closest Point Batch Query.
+      * Points are distributed over all available threads when OpenMP is
+      * enabled. Within each chunk of points the closest geometry of the
+      * previous point is used as the starting guess for the next point,
+      * so points should be ordered coherently, like the vertices of a mesh.
+      *
+      * @param count          The number of points.
+      * @param p              The query points.
+      * @param max_distance   Only geometries closer than this distance are considered.
+      * @param hits           Upon return holds the closest geometry of each point.
+      * @param coherent       If true then hits holds the results of a previous query of
+      *                       slightly moved points upon invocation, and the geometries
+      *                       are used as starting guesses. Default is false.
+      */
+      void closest_point(
+        size_t count
+        , vector3_type const * p
+        , real_type const & max_distance
+        , hit_type * hits
+        , bool const coherent = false
+        ) const
+      {
+        size_t const chunk  = 64u;
+        long   const chunks = static_cast<long>( (count + chunk - 1u) / chunk );
+
+#pragma omp parallel for schedule(dynamic) if(chunks > 1)
+        for(long i = 0; i < chunks; ++i)
+        {
+          size_t const first = static_cast<size_t>(i)*chunk;
+          size_t const last  = std::min( count, first + chunk );
+          geometry_type const * guess = 0;
+          for(size_t j = first; j < last; ++j)
+          {
+            if( coherent && hits[j].m_geometry )
+              guess = hits[j].m_geometry;
+            closest_point( p[j], max_distance, hits[j], guess );
+            if( hits[j].m_geometry )
+              guess = hits[j].m_geometry;
+          }
+        }
+      }
+
+      /**
+      * Closest Triangle Query.
+      * Finds the geometry closest to a triangle. This is the same best-first
+      * search as for a point, with the distance between the box of a node
+      * and the bounding box of the triangle as lower bound.
+      *
+      * @param a              The first corner of the triangle.
+      * @param b              The second corner of the triangle.
+      * @param c              The third corner of the triangle.
+      * @param max_distance   Only geometries closer than this distance are considered.
+      * @param hit            Upon return holds the closest geometry (if any) and the point on it closest to the triangle.
+      * @param q              Upon return holds the point on the triangle closest to the geometry (if any).
+      * @param guess          A geometry that is expected to be close to the triangle, can be null.
+      *
+      * @return               If any geometry was found within the maximum distance then
+      *                       the return value is true otherwise it is false.
+      */
+      bool triangle_distance(
+        vector3_type const & a
+        , vector3_type const & b
+        , vector3_type const & c
+        , real_type const & max_distance
+        , hit_type & hit
+        , vector3_type & q
+        , geometry_type const * guess = 0
+        ) const
+      {
+        real_type best = max_distance*max_distance;
+        hit.m_distance = max_distance;
+        hit.m_geometry = 0;
+
+        if( guess )
+        {
+          vector3_type x;
+          vector3_type y;
+          real_type const d2 = distance_policy::closest_points( *guess, a, b, c, x, y );
+          if( d2 <= best )
+          {
+            best           = d2;
+            hit.m_point    = x;
+            hit.m_geometry = guess;
+            q              = y;
+          }
+        }
+
+        if( m_nodes.empty() )
+          return finish( best, hit );
+
+        real_type lower[3];
+        real_type upper[3];
+        for(size_t k = 0u; k < 3u; ++k)
+        {
+          lower[k] = std::min( a(k), std::min( b(k), c(k) ) );
+          upper[k] = std::max( a(k), std::max( b(k), c(k) ) );
+        }
+
+        std::vector<Entry> queue;
+        push( queue, lower, upper, 0u, best );
+        while( !queue.empty() )
+        {
+          std::pop_heap( queue.begin(), queue.end() );
+          Entry const entry = queue.back();
+          queue.pop_back();
+
+          if( entry.m_d2 > best )
+            break;
+
+          Node const & node = m_nodes[entry.m_node];
+          if( node.m_count > 0u )
+          {
+            for(size_t g = node.m_first; g < node.m_first + node.m_count; ++g)
+            {
+              if( m_geometry[g] == guess )
+                continue;
+              vector3_type x;
+              vector3_type y;
+              real_type const d2 = distance_policy::closest_points( *m_geometry[g], a, b, c, x, y );
+              if( d2 < best || (d2 == best && !hit.m_geometry) )
+              {
+                best           = d2;
+                hit.m_point    = x;
+                hit.m_geometry = m_geometry[g];
+                q              = y;
+              }
+            }
+            continue;
+          }
+          for(size_t child = entry.m_node + 1u; child < node.m_skip; child = m_nodes[child].m_skip)
+            push( queue, lower, upper, child, best );
+        }
+        return finish( best, hit );
+      }
+
+      /**
+      * Mesh Distance Query.
+      * Finds the closest pair of points between a triangle mesh and the
+      * geometry of the BVH. Every triangle of the mesh runs a closest
+      * triangle query, bounded by the closest pair found so far, so
+      * triangles far from the BVH are rejected at the root. Triangles are
+      * distributed over all available threads in chunks when OpenMP is
+      * enabled, and within a chunk the closest geometry of the previous
+      * triangle is used as the starting guess for the next triangle, so
+      * triangles should be ordered coherently.
+      *
+      * @param count          The number of triangles of the mesh.
+      * @param corners        The corners of the triangles, the corners of the i'th
+      *                       triangle are corners[3*i], corners[3*i+1] and corners[3*i+2].
+      * @param max_distance   Only geometries closer than this distance are considered.
+      * @param hit            Upon return holds the closest geometry (if any) and the point on it closest to the mesh.
+      * @param q              Upon return holds the point on the mesh closest to the geometry (if any).
+      * @param triangle       Upon return holds the index of the triangle of the mesh containing q (if any).
+      *
+      * @return               If any geometry was found within the maximum distance then
+      *                       the return value is true otherwise it is false.
+      */
+      bool mesh_distance(
+        size_t count
+        , vector3_type const * corners
+        , real_type const & max_distance
+        , hit_type & hit
+        , vector3_type & q
+        , size_t & triangle
+        ) const
+      {
+        size_t const chunk  = 64u;
+        long   const chunks = static_cast<long>( (count + chunk - 1u) / chunk );
+
+        hit.m_distance = max_distance;
+        hit.m_geometry = 0;
+        triangle       = count;
+
+#pragma omp parallel for schedule(dynamic) if(chunks > 1)
+        for(long i = 0; i < chunks; ++i)
+        {
+          size_t const first = static_cast<size_t>(i)*chunk;
+          size_t const last  = std::min( count, first + chunk );
+
+          hit_type     best;
+          vector3_type best_q;
+          size_t       best_triangle = count;
+          best.m_distance = max_distance;
+          best.m_geometry = 0;
+
+          geometry_type const * guess = 0;
+          for(size_t j = first; j < last; ++j)
+          {
+            hit_type     current;
+            vector3_type current_q;
+            if( !triangle_distance( corners[3u*j], corners[3u*j+1u], corners[3u*j+2u], best.m_distance, current, current_q, guess ) )
+              continue;
+            guess = current.m_geometry;
+            if( !best.m_geometry || current.m_distance < best.m_distance )
+            {
+              best          = current;
+              best_q        = current_q;
+              best_triangle = j;
+            }
+          }
+
+          if( !best.m_geometry )
+            continue;
+#pragma omp critical (bvh_distance_query_mesh_distance)
+          {
+            if( !hit.m_geometry || best.m_distance < hit.m_distance || (best.m_distance == hit.m_distance && best_triangle < triangle) )
+            {
+              hit      = best;
+              q        = best_q;
+              triangle = best_triangle;
+            }
+          }
+        }
+        return hit.m_geometry != 0;
+      }
+
+    protected:
+
+      /**
+      * Squared Distance from Point to Box.
+      * This is a lower bound of the squared distance to any geometry inside the box.
+      */
+      static real_type box_distance2(Node const & node, vector3_type const & p)
+      {
+        real_type d2 = real_type(0);
+        for(size_t k = 0u; k < 3u; ++k)
+        {
+          real_type const below = node.m_min[k] - p(k);
+          real_type const above = p(k) - node.m_max[k];
+          real_type const d     = below > real_type(0) ? below : ( above > real_type(0) ? above : real_type(0) );
+          d2 += d*d;
+        }
+        return d2;
+      }
+
+      /**
+      * Squared Distance between Boxes.
+      * This is a lower bound of the squared distance between any geometry
+      * inside the box of the node and any geometry inside the other box.
+      */
+      static real_type box_distance2(Node const & node, real_type const * lower, real_type const * upper)
+      {
+        real_type d2 = real_type(0);
+        for(size_t k = 0u; k < 3u; ++k)
+        {
+          real_type const below = node.m_min[k] - upper[k];
+          real_type const above = lower[k] - node.m_max[k];
+          real_type const d     = below > real_type(0) ? below : ( above > real_type(0) ? above : real_type(0) );
+          d2 += d*d;
+        }
+        return d2;
+      }
+
+      /**
+      * Push node onto the priority queue, unless it is farther away than the bound.
+      */
+      void push(std::vector<Entry> & queue, vector3_type const & p, size_t const idx, real_type const & bound) const
+      {
+        Entry entry;
+        entry.m_d2   = box_distance2( m_nodes[idx], p );
+        entry.m_node = idx;
+        if( entry.m_d2 > bound )
+          return;
+        queue.push_back( entry );
+        std::push_heap( queue.begin(), queue.end() );
+      }
+
+      /**
+      * Push node onto the priority queue, unless its distance to the box
+      * given by lower and upper corners is larger than the bound.
+      */
+      void push(std::vector<Entry> & queue, real_type const * lower, real_type const * upper, size_t const idx, real_type const & bound) const
+      {
+        Entry entry;
+        entry.m_d2   = box_distance2( m_nodes[idx], lower, upper );
+        entry.m_node = idx;
+        if( entry.m_d2 > bound )
+          return;
+        queue.push_back( entry );
+        std::push_heap( queue.begin(), queue.end() );
+      }
+
+      static bool finish(real_type const & best, hit_type & hit)
+      {
+        using std::sqrt;
+
+        if( !hit.m_geometry )
+          return false;
+        hit.m_distance = sqrt( best );
+        return true;
+      }
+
+    };
+
+  } // namespace bvh
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_BVH_BVH_DISTANCE_QUERY_H
+#endif
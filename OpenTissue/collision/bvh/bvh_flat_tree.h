@@ -0,0 +1,148 @@
+#ifndef OPENTISSUE_COLLISION_BVH_BVH_FLAT_TREE_H
+#define OPENTISSUE_COLLISION_BVH_BVH_FLAT_TREE_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <vector>
+#include <algorithm>
+
+namespace OpenTissue
+{
+  namespace bvh
+  {
+
+    /**
+    * Flat Tree.
+    * A flattened copy of a BVH with axis aligned bounding volumes (the volume
+    * type must provide min() and max() corners). The boxes of all nodes are
+    * stored in depth-first order, such that a traversal only touches a
+    * compact array. This is the tree traversed by the bvh::RayQuery and the
+    * bvh::DistanceQuery.
+    *
+    * The children of a node follow right after the node, and are linked
+    * through their skip indices. The geometries of a leaf are stored
+    * contiguously.
+    *
+    * Whenever the BVH is changed or refitted init() must be invoked again.
+    *
+    * @tparam bvh_type   The BVH type.
+    */
+    template <typename bvh_type>
+    class FlatTree
+    {
+    public:
+
+      typedef typename bvh_type::bv_type                    bv_type;
+      typedef typename bvh_type::annotated_bv_type          annotated_bv_type;
+      typedef typename bvh_type::bv_const_ptr_iterator      bv_const_ptr_iterator;
+      typedef typename bvh_type::geometry_type              geometry_type;
+      typedef typename bvh_type::volume_type                volume_type;
+      typedef typename volume_type::real_type               real_type;
+
+      /**
+      * Flattened BVH node.
+      */
+      class Node
+      {
+      public:
+
+        real_type  m_min[3];    ///< Minimum corner of box.
+        real_type  m_max[3];    ///< Maximum corner of box.
+        size_t     m_skip;      ///< Index of next node after the subtree of this node, the children of a node are linked through their skip indices.
+        size_t     m_first;     ///< Index of first geometry of a leaf node.
+        size_t     m_count;     ///< Number of geometries of a leaf node (zero for internal nodes).
+
+      };
+
+    protected:
+
+      std::vector<Node>                    m_nodes;        ///< The flattened tree in depth-first order.
+      std::vector<geometry_type const *>   m_geometry;     ///< The geometries of the leaf nodes.
+      size_t                               m_stack_size;   ///< The maximum number of traversal stack entries needed by the tree.
+
+    public:
+
+      FlatTree()
+        : m_stack_size(0u)
+      {}
+
+    public:
+
+      /**
+      * Initialize.
+      * Flattens the BVH. Must be invoked again whenever the BVH is changed or refitted.
+      *
+      * @param bvh    The BVH.
+      */
+      void init(bvh_type const & bvh)
+      {
+        m_nodes.clear();
+        m_geometry.clear();
+        m_nodes.reserve( bvh.size() );
+        m_stack_size = 0u;
+        if( bvh.root() )
+          m_stack_size = flatten( bvh.root().get() );
+      }
+
+    protected:
+
+      /**
+      * Flatten Subtree.
+      *
+      * @param bv    The root of the subtree.
+      *
+      * @return      The number of stack entries needed for a depth-first traversal of the subtree.
+      */
+      size_t flatten(bv_type const * bv)
+      {
+        size_t const idx = m_nodes.size();
+        m_nodes.push_back( Node() );
+
+        {
+          Node & node = m_nodes[idx];
+          for(size_t k = 0u; k < 3u; ++k)
+          {
+            node.m_min[k] = bv->volume().min()(k);
+            node.m_max[k] = bv->volume().max()(k);
+          }
+          node.m_first = m_geometry.size();
+          node.m_count = 0u;
+        }
+
+        size_t stack_size = 1u;
+        if( bv->is_leaf() )
+        {
+          annotated_bv_type const * leaf = static_cast<annotated_bv_type const *>( bv );
+          for(typename annotated_bv_type::geometry_const_iterator g = leaf->geometry_begin(); g != leaf->geometry_end(); ++g)
+            m_geometry.push_back( &(*g) );
+          m_nodes[idx].m_count = m_geometry.size() - m_nodes[idx].m_first;
+        }
+        else
+        {
+          //--- Expanding the node replaces its entry by all its children, the siblings
+          //--- of the visited child stay on the stack while the child is traversed
+          size_t children = 0u;
+          size_t deepest  = 0u;
+          for(bv_const_ptr_iterator child = bv->child_ptr_begin(); child != bv->child_ptr_end(); ++child, ++children)
+            deepest = std::max( deepest, flatten( child->get() ) );
+          stack_size = std::max( stack_size, children - 1u + deepest );
+        }
+
+        m_nodes[idx].m_skip = m_nodes.size();
+        return stack_size;
+      }
+
+    };
+
+  } // namespace bvh
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_BVH_BVH_FLAT_TREE_H
+#endif
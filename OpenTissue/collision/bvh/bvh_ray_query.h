@@ -0,0 +1,555 @@
+#ifndef OPENTISSUE_COLLISION_BVH_BVH_RAY_QUERY_H
+#define OPENTISSUE_COLLISION_BVH_BVH_RAY_QUERY_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/bvh/bvh_flat_tree.h>
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace bvh
+  {
+
+    /**
+    * Ray Hit.
+    * The result of a closest hit ray query.
+    */
+    template<typename real_type, typename geometry_type>
+    class RayHit
+    {
+    public:
+
+      real_type             m_t;          ///< The ray parameter of the hit point, that is p + t r.
+      geometry_type const * m_geometry;   ///< The geometry that was hit, null if the ray did not hit anything.
+
+    public:
+
+      RayHit()
+        : m_t()
+        , m_geometry(0)
+      {}
+
+    };
+
+    /**
+    * Ray Query.
+    * This query casts rays against a BVH with axis aligned bounding volumes (the
+    * volume type must provide min() and max() corners). It supports closest hit
+    * and any hit queries for single rays, for packets of rays and for large
+    * batches of rays.
+    *
+    * Prior to casting rays the BVH must be flattened by invoking init(), see
+    * bvh::FlatTree. Whenever the volumes of the BVH are refitted init() must
+    * be invoked again.
+    *
+    * The traversal visits the children of a node in front-to-back order and
+    * skips any node whose entry point lies beyond the closest hit found so far.
+    *
+    * A packet of rays traverses the tree together. At each node the slab tests
+    * of all rays in the packet are done in one branch free loop, which the
+    * compiler maps onto SIMD registers. A subtree is skipped only if none of
+    * the rays hit its box.
+    *
+    * The ray policy must provide a method
+    *
+    *   bool intersect(geometry_type const & g, vector3_type const & p, vector3_type const & r, real_type const & t_max, real_type & t) const
+    *
+    * that returns true if the ray p + t r hits the geometry for some t in [0..t_max]. The
+    * method must be thread-safe since batch queries invoke it from multiple threads.
+    *
+    * @tparam bvh_type         The BVH type.
+    * @tparam ray_policy       The ray policy, testing rays against the geometry of the leaves.
+    * @tparam packet_width     The number of rays in a ray packet, typically 4 or 8.
+    */
+    template <typename bvh_type, typename ray_policy, size_t packet_width = 8u>
+    class RayQuery
+      : public ray_policy
+      , public FlatTree<bvh_type>
+    {
+    public:
+
+      typedef          FlatTree<bvh_type>                   flat_tree_type;
+      typedef typename bvh_type::geometry_type              geometry_type;
+      typedef typename bvh_type::volume_type                volume_type;
+      typedef typename volume_type::vector3_type            vector3_type;
+      typedef typename volume_type::real_type               real_type;
+      typedef          RayHit<real_type, geometry_type>     hit_type;
+
+      static size_t const W = packet_width;
+
+    protected:
+
+      typedef typename flat_tree_type::Node                 Node;
+
+      using flat_tree_type::m_nodes;
+      using flat_tree_type::m_geometry;
+      using flat_tree_type::m_stack_size;
+
+      /**
+      * Traversal Stack Entry.
+      */
+      class Entry
+      {
+      public:
+
+        real_type  m_t;         ///< Smallest entry point of the rays into the box of the node.
+        size_t     m_node;      ///< Index of the node.
+        int        m_mask;      ///< Bit mask of the rays in a packet that hit the box of the node.
+
+      };
+
+      static size_t const local_stack_size = 64u;
+
+    public:
+
+      /**
+      * Closest Hit Query.
+      *
+      * @param p       The origin of the ray.
+      * @param r       The direction of the ray.
+      * @param t_max   The maximum ray parameter, only hits with t in [0..t_max] are reported.
+      * @param hit     Upon return holds the closest hit (if any).
+      *
+      * @return        If the ray hits anything then the return value is true otherwise it is false.
+      */
+      bool closest_hit(vector3_type const & p, vector3_type const & r, real_type const & t_max, hit_type & hit) const
+      {
+        hit.m_t        = t_max;
+        hit.m_geometry = 0;
+        traverse( p, r, hit, false );
+        return hit.m_geometry != 0;
+      }
+
+      /**
+      * Any Hit Query.
+      * Terminates as soon as some hit is found, this is typically used for shadow
+      * or line-of-sight rays.
+      *
+      * @param p       The origin of the ray.
+      * @param r       The direction of the ray.
+      * @param t_max   The maximum ray parameter, only hits with t in [0..t_max] are considered.
+      *
+      * @return        If the ray hits anything then the return value is true otherwise it is false.
+      */
+      bool any_hit(vector3_type const & p, vector3_type const & r, real_type const & t_max) const
+      {
+        hit_type hit;
+        hit.m_t        = t_max;
+        hit.m_geometry = 0;
+        traverse( p, r, hit, true );
+        return hit.m_geometry != 0;
+      }
+
+      /**
+      * Closest Hit Packet Query.
+      *
+      * @param count   The number of rays in the packet, at most packet_width.
+      * @param p       The origins of the rays.
+      * @param r       The directions of the rays.
+      * @param t_max   The maximum ray parameter.
+      * @param hits    Upon return holds the closest hit of each ray.
+      */
+      void closest_hit_packet(size_t count, vector3_type const * p, vector3_type const * r, real_type const & t_max, hit_type * hits) const
+      {
+        traverse_packet( count, p, r, t_max, hits, false );
+      }
+
+      /**
+      * Any Hit Packet Query.
+      *
+      * @param count   The number of rays in the packet, at most packet_width.
+      * @param p       The origins of the rays.
+      * @param r       The directions of the rays.
+      * @param t_max   The maximum ray parameter.
+      * @param hits    Upon return holds a non-zero value for each ray that hit anything.
+      */
+      template<typename flag_type>
+      void any_hit_packet(size_t count, vector3_type const * p, vector3_type const * r, real_type const & t_max, flag_type * hits) const
+      {
+        hit_type result[W];
+        traverse_packet( count, p, r, t_max, result, true );
+        for(size_t l = 0u; l < count; ++l)
+          hits[l] = (result[l].m_geometry != 0);
+      }
+
+      /**
+      * Closest Hit Batch Query.
+      * The rays are processed in packets, and packets are distributed over all
+      * available threads when OpenMP is enabled. Coherent rays (for instance the
+      * rays of a camera or a sensor in scan-line order) should be stored next to
+      * each other for the packets to be effective. Packets of rays pointing
+      * into different octants are traced one ray at a time.
+      *
+      * @param count   The number of rays.
+      * @param p       The origins of the rays.
+      * @param r       The directions of the rays.
+      * @param t_max   The maximum ray parameter.
+      * @param hits    Upon return holds the closest hit of each ray.
+      */
+      void closest_hit(size_t count, vector3_type const * p, vector3_type const * r, real_type const & t_max, hit_type * hits) const
+      {
+        long const packets = static_cast<long>( (count + W - 1u) / W );
+
+#pragma omp parallel for schedule(dynamic,16) if(packets > 64)
+        for(long i = 0; i < packets; ++i)
+        {
+          size_t const first = static_cast<size_t>(i)*W;
+          size_t const n     = std::min( W, count - first );
+          if( is_coherent( n, r + first ) )
+          {
+            traverse_packet( n, p + first, r + first, t_max, hits + first, false );
+            continue;
+          }
+          for(size_t l = first; l < first + n; ++l)
+            closest_hit( p[l], r[l], t_max, hits[l] );
+        }
+      }
+
+      /**
+      * Any Hit Batch Query.
+      *
+      * @param count   The number of rays.
+      * @param p       The origins of the rays.
+      * @param r       The directions of the rays.
+      * @param t_max   The maximum ray parameter.
+      * @param hits    Upon return holds a non-zero value for each ray that hit anything.
+      */
+      template<typename flag_type>
+      void any_hit(size_t count, vector3_type const * p, vector3_type const * r, real_type const & t_max, flag_type * hits) const
+      {
+        long const packets = static_cast<long>( (count + W - 1u) / W );
+
+#pragma omp parallel for schedule(dynamic,16) if(packets > 64)
+        for(long i = 0; i < packets; ++i)
+        {
+          size_t const first = static_cast<size_t>(i)*W;
+          size_t const n     = std::min( W, count - first );
+          if( is_coherent( n, r + first ) )
+          {
+            any_hit_packet( n, p + first, r + first, t_max, hits + first );
+            continue;
+          }
+          for(size_t l = first; l < first + n; ++l)
+            hits[l] = any_hit( p[l], r[l], t_max );
+        }
+      }
+
+    protected:
+
+      /**
+      * Test if all rays of a packet point into the same octant. Only such
+      * packets tend to visit the same nodes and benefit from packet traversal.
+      */
+      static bool is_coherent(size_t count, vector3_type const * r)
+      {
+        for(size_t l = 1u; l < count; ++l)
+          for(size_t k = 0u; k < 3u; ++k)
+            if( (r[l](k) < 0) != (r[0](k) < 0) )
+              return false;
+        return true;
+      }
+
+      /**
+      * Sort entries in back-to-front order, such that the closest node ends up
+      * on top of the stack. Nodes have few children so insertion sort is used.
+      */
+      static void sort_entries(Entry * begin, Entry * end)
+      {
+        for(Entry * i = begin + 1; i < end; ++i)
+        {
+          Entry const tmp = *i;
+          Entry * j = i;
+          for(; j > begin && (j-1)->m_t < tmp.m_t; --j)
+            *j = *(j-1);
+          *j = tmp;
+        }
+      }
+
+      /**
+      * Slab Test.
+      *
+      * @param node    The node to test.
+      * @param o       The origin of the ray.
+      * @param inv     The component-wise inverse direction of the ray.
+      * @param t_max   The maximum ray parameter.
+      * @param t_near  Upon return holds the ray parameter where the ray enters the box.
+      *
+      * @return        If the ray segment [0..t_max] overlaps the box then the return value is true otherwise it is false.
+      */
+      static bool slab_test(Node const & node, real_type const * o, real_type const * inv, real_type const & t_max, real_type & t_near)
+      {
+        real_type t_far  = t_max;
+        t_near = real_type();
+        for(size_t k = 0u; k < 3u; ++k)
+        {
+          real_type const t0 = (node.m_min[k] - o[k])*inv[k];
+          real_type const t1 = (node.m_max[k] - o[k])*inv[k];
+          real_type const lo = t0 < t1 ? t0 : t1;
+          real_type const hi = t0 < t1 ? t1 : t0;
+          t_near = t_near < lo ? lo : t_near;
+          t_far  = hi < t_far  ? hi : t_far;
+        }
+        return t_near <= t_far;
+      }
+
+      void traverse(vector3_type const & p, vector3_type const & r, hit_type & hit, bool const any) const
+      {
+        if( m_nodes.empty() )
+          return;
+
+        real_type const o[3]   = { p(0), p(1), p(2) };
+        real_type const inv[3] = { real_type(1)/r(0), real_type(1)/r(1), real_type(1)/r(2) };
+
+        Entry              local[local_stack_size];
+        std::vector<Entry> extended;
+        Entry *            stack = local;
+        if( m_stack_size > local_stack_size )
+        {
+          extended.resize( m_stack_size );
+          stack = &extended[0];
+        }
+
+        real_type t_root;
+        if( !slab_test( m_nodes[0], o, inv, hit.m_t, t_root ) )
+          return;
+
+        size_t top = 0u;
+        stack[top].m_t    = t_root;
+        stack[top].m_node = 0u;
+        stack[top].m_mask = 1;
+        ++top;
+
+        while( top > 0u )
+        {
+          Entry const entry = stack[--top];
+
+          //--- A closer hit was found after the node was pushed
+          if( entry.m_t > hit.m_t )
+            continue;
+
+          Node const & node = m_nodes[entry.m_node];
+          if( node.m_count > 0u )
+          {
+            for(size_t g = node.m_first; g < node.m_first + node.m_count; ++g)
+            {
+              real_type t;
+              if( this->intersect( *m_geometry[g], p, r, hit.m_t, t ) )
+              {
+                hit.m_t        = t;
+                hit.m_geometry = m_geometry[g];
+                if( any )
+                  return;
+              }
+            }
+            continue;
+          }
+
+          size_t const first = top;
+          for(size_t c = entry.m_node + 1u; c < node.m_skip; c = m_nodes[c].m_skip)
+          {
+            real_type t_near;
+            if( !slab_test( m_nodes[c], o, inv, hit.m_t, t_near ) )
+              continue;
+            stack[top].m_t    = t_near;
+            stack[top].m_node = c;
+            stack[top].m_mask = 1;
+            ++top;
+          }
+          sort_entries( stack + first, stack + top );
+        }
+      }
+
+      void traverse_packet(size_t count, vector3_type const * p, vector3_type const * r, real_type const & t_max, hit_type * hits, bool const any) const
+      {
+        assert( count <= W || !"RayQuery::traverse_packet(): too many rays in packet");
+
+        real_type ox[W], oy[W], oz[W];
+        real_type ix[W], iy[W], iz[W];
+        real_type t_best[W];
+        real_type t_near[W];
+        int       active[W];
+        int       hit[W];
+
+        for(size_t l = 0u; l < W; ++l)
+        {
+          size_t const j = l < count ? l : 0u;
+          ox[l] = p[j](0);
+          oy[l] = p[j](1);
+          oz[l] = p[j](2);
+          ix[l] = real_type(1)/r[j](0);
+          iy[l] = real_type(1)/r[j](1);
+          iz[l] = real_type(1)/r[j](2);
+          t_best[l] = t_max;
+          active[l] = l < count;
+        }
+        for(size_t l = 0u; l < count; ++l)
+        {
+          hits[l].m_t        = t_max;
+          hits[l].m_geometry = 0;
+        }
+
+        if( m_nodes.empty() )
+          return;
+
+        Entry              local[local_stack_size];
+        std::vector<Entry> extended;
+        Entry *            stack = local;
+        if( m_stack_size > local_stack_size )
+        {
+          extended.resize( m_stack_size );
+          stack = &extended[0];
+        }
+
+        size_t top = 0u;
+        {
+          real_type t_min;
+          int const mask = slab_test_packet( m_nodes[0], ox, oy, oz, ix, iy, iz, t_best, active, t_near, t_min );
+          if( !mask )
+            return;
+          stack[top].m_t    = t_min;
+          stack[top].m_node = 0u;
+          stack[top].m_mask = mask;
+          ++top;
+        }
+
+        while( top > 0u )
+        {
+          Entry const entry = stack[--top];
+
+          //--- Drop rays that already have a hit closer than the entry point of the node
+          int mask = 0;
+          for(size_t l = 0u; l < W; ++l)
+            mask |= ( (entry.m_mask >> l) & 1 & active[l] & (entry.m_t <= t_best[l]) ) << l;
+          if( !mask )
+            continue;
+
+          Node const & node = m_nodes[entry.m_node];
+          if( node.m_count > 0u )
+          {
+            for(size_t g = node.m_first; g < node.m_first + node.m_count; ++g)
+            {
+              for(size_t l = 0u; l < count; ++l)
+              {
+                if( !( (mask >> l) & 1 ) || !active[l] )
+                  continue;
+                real_type t;
+                if( this->intersect( *m_geometry[g], p[l], r[l], t_best[l], t ) )
+                {
+                  t_best[l]          = t;
+                  hits[l].m_t        = t;
+                  hits[l].m_geometry = m_geometry[g];
+                  if( any )
+                    active[l] = 0;
+                }
+              }
+            }
+            if( any )
+            {
+              int any_active = 0;
+              for(size_t l = 0u; l < W; ++l)
+                any_active |= active[l];
+              if( !any_active )
+                return;
+            }
+            continue;
+          }
+
+          for(size_t l = 0u; l < W; ++l)
+            hit[l] = active[l] & ( (mask >> l) & 1 );
+
+          size_t const first = top;
+          for(size_t c = entry.m_node + 1u; c < node.m_skip; c = m_nodes[c].m_skip)
+          {
+            real_type t_min;
+            int const child_mask = slab_test_packet( m_nodes[c], ox, oy, oz, ix, iy, iz, t_best, hit, t_near, t_min );
+            if( !child_mask )
+              continue;
+            stack[top].m_t    = t_min;
+            stack[top].m_node = c;
+            stack[top].m_mask = child_mask;
+            ++top;
+          }
+          sort_entries( stack + first, stack + top );
+        }
+      }
+
+      /**
+      * Packet Slab Test.
+      * The loop over the lanes is branch free such that it can be vectorized.
+      *
+      * @param t_near   Upon return holds the entry points of all rays.
+      * @param t_min    Upon return holds the smallest entry point of the rays that hit the box.
+      *
+      * @return         A bit mask of the rays that hit the box.
+      */
+      static int slab_test_packet(
+        Node const & node
+        , real_type const * ox, real_type const * oy, real_type const * oz
+        , real_type const * ix, real_type const * iy, real_type const * iz
+        , real_type const * t_max
+        , int const * active
+        , real_type * t_near
+        , real_type & t_min
+        )
+      {
+        int hit[W];
+        for(size_t l = 0u; l < W; ++l)
+        {
+          real_type const tx0 = (node.m_min[0] - ox[l])*ix[l];
+          real_type const tx1 = (node.m_max[0] - ox[l])*ix[l];
+          real_type const ty0 = (node.m_min[1] - oy[l])*iy[l];
+          real_type const ty1 = (node.m_max[1] - oy[l])*iy[l];
+          real_type const tz0 = (node.m_min[2] - oz[l])*iz[l];
+          real_type const tz1 = (node.m_max[2] - oz[l])*iz[l];
+
+          real_type t_enter = real_type();
+          real_type t_exit  = t_max[l];
+          real_type lo = tx0 < tx1 ? tx0 : tx1;
+          real_type hi = tx0 < tx1 ? tx1 : tx0;
+          t_enter = t_enter < lo ? lo : t_enter;
+          t_exit  = hi < t_exit  ? hi : t_exit;
+          lo = ty0 < ty1 ? ty0 : ty1;
+          hi = ty0 < ty1 ? ty1 : ty0;
+          t_enter = t_enter < lo ? lo : t_enter;
+          t_exit  = hi < t_exit  ? hi : t_exit;
+          lo = tz0 < tz1 ? tz0 : tz1;
+          hi = tz0 < tz1 ? tz1 : tz0;
+          t_enter = t_enter < lo ? lo : t_enter;
+          t_exit  = hi < t_exit  ? hi : t_exit;
+
+          t_near[l] = t_enter;
+          hit[l]    = active[l] & (t_enter <= t_exit);
+        }
+
+        int mask = 0;
+        t_min = t_near[0];
+        bool found = false;
+        for(size_t l = 0u; l < W; ++l)
+        {
+          if( !hit[l] )
+            continue;
+          mask |= 1 << l;
+          t_min = ( !found || t_near[l] < t_min ) ? t_near[l] : t_min;
+          found = true;
+        }
+        return mask;
+      }
+
+    };
+
+  } // namespace bvh
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_BVH_BVH_RAY_QUERY_H
+#endif
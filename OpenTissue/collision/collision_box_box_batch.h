@@ -0,0 +1,549 @@
+#ifndef OPENTISSUE_COLLISION_COLLISION_BOX_BOX_BATCH_H
+#define OPENTISSUE_COLLISION_COLLISION_BOX_BOX_BATCH_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/collision_box_box_improved.h>
+#include <OpenTissue/utility/utility_openmp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace collision
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Number of box pairs processed together by the batched separating axis test.
+      * The separating axis test is written such that each box pair occupies
+      * one lane, and all lanes are processed by the same branch-free
+      * instructions. Thereby the compiler can map the lanes onto SIMD
+      * registers, 8 lanes fill an AVX register in single precision.
+      */
+      enum { box_box_batch_width = 8 };
+
+      /**
+      * Maximum number of contacts box_box_improved() can generate. The edge
+      * crossings of the incident and the reference face give at most eight
+      * points, and each box can have up to eight corners inside the other.
+      */
+      enum { box_box_max_contacts = 24 };
+
+      /**
+      * Separating Axis Test and Corner Classification for a Block of Box Pairs.
+      * This is the part of box_box_improved() that does not depend on the
+      * number of contacts, written such that every box pair occupies one
+      * lane. The 15 potential separating axes are tested, the axis of minimum
+      * overlap is picked, the corners of each box are tested for inclusion in
+      * the other box, and the edge-edge axis is replaced by the best face
+      * axis if any corner is inside, all by the rules of box_box_improved().
+      * The boxes are projected onto the axes through their corner points,
+      * with the same arithmetic as box_box_improved(), such that ties between
+      * nearly parallel axes, which are common in resting contacts, are broken
+      * the same way. The corners are classified by rotation matrices instead
+      * of quaternions, so the classification agrees with box_box_improved()
+      * up to round-off.
+      *
+      * The box data must be given in structure-of-arrays layout and in WCS.
+      *
+      * @param R_a        Orientations of the A-boxes, R_a[i][j][l] is the (i,j) entry in lane l.
+      * @param p_a        Centers of the A-boxes, p_a[i][l] is the i'th coordinate in lane l.
+      * @param ext_a      Extents of the A-boxes, ext_a[i][l] is the i'th extent in lane l.
+      * @param R_b        Orientations of the B-boxes.
+      * @param p_b        Centers of the B-boxes.
+      * @param ext_b      Extents of the B-boxes.
+      * @param envelope   The size of the collision envelope.
+      * @param separated  Upon return the l'th value is non-zero if a separating axis was found for lane l.
+      * @param code       Upon return the axis of the contact normal of lane l, numbered as in
+      *                   detail::box_box_improved_axis(), or 15 if no axis was found.
+      * @param flip       Upon return non-zero if the axis of lane l must be negated to point from box A towards box B.
+      * @param distance   Upon return the separation along the axis of lane l.
+      * @param inside_a   Upon return bit i of the l'th value is set if the i'th corner of box A lies inside box B
+      *                   grown by the envelope, corners are numbered as in detail::box_box_improved_corners().
+      * @param inside_b   Upon return bit i of the l'th value is set if the i'th corner of box B lies inside box A.
+      */
+      template<typename real_type>
+      inline void box_box_sat_block(
+        real_type const (&R_a)[3][3][box_box_batch_width]
+        , real_type const (&p_a)[3][box_box_batch_width]
+        , real_type const (&ext_a)[3][box_box_batch_width]
+        , real_type const (&R_b)[3][3][box_box_batch_width]
+        , real_type const (&p_b)[3][box_box_batch_width]
+        , real_type const (&ext_b)[3][box_box_batch_width]
+        , real_type const & envelope
+        , int (&separated)[box_box_batch_width]
+        , int (&code)[box_box_batch_width]
+        , int (&flip)[box_box_batch_width]
+        , real_type (&distance)[box_box_batch_width]
+        , int (&inside_a)[box_box_batch_width]
+        , int (&inside_b)[box_box_batch_width]
+        )
+      {
+        using std::fabs;
+        using std::sqrt;
+
+        int const W = box_box_batch_width;
+
+        real_type const lowest  = math::detail::lowest<real_type>();
+        real_type const highest = math::detail::highest<real_type>();
+
+        //--- Box axes in WCS, A[k][i][l] is the i'th coordinate of the k'th axis. Components
+        //--- are truncated as in box_box_improved_axes().
+        real_type A[3][3][W];
+        real_type B[3][3][W];
+        for(int k = 0; k < 3; ++k)
+          for(int i = 0; i < 3; ++i)
+            for(int l = 0; l < W; ++l)
+            {
+              A[k][i][l] = fabs( R_a[i][k][l] ) < real_type(10e-7) ? real_type(0) : R_a[i][k][l];
+              B[k][i][l] = fabs( R_b[i][k][l] ) < real_type(10e-7) ? real_type(0) : R_b[i][k][l];
+            }
+
+        //--- Corner points of the boxes in WCS, see box_box_improved_corners()
+        real_type a[8][3][W];
+        real_type b[8][3][W];
+        for(int mask = 0; mask < 8; ++mask)
+        {
+          real_type const s0 = (mask&0x0001) ? real_type(1) : real_type(-1);
+          real_type const s1 = ((mask>>1)&0x0001) ? real_type(1) : real_type(-1);
+          real_type const s2 = ((mask>>2)&0x0001) ? real_type(1) : real_type(-1);
+          for(int i = 0; i < 3; ++i)
+            for(int l = 0; l < W; ++l)
+            {
+              a[mask][i][l] = s2*A[2][i][l]*ext_a[2][l] + s1*A[1][i][l]*ext_a[1][l] + s0*A[0][i][l]*ext_a[0][l] + p_a[i][l];
+              b[mask][i][l] = s2*B[2][i][l]*ext_b[2][l] + s1*B[1][i][l]*ext_b[1][l] + s0*B[0][i][l]*ext_b[0][l] + p_b[i][l];
+            }
+        }
+
+        real_type face_overlap[6][W];
+        int       face_flip[6][W];
+
+        for(int l = 0; l < W; ++l)
+        {
+          separated[l] = 0;
+          code[l]      = 15;
+          flip[l]      = 0;
+          distance[l]  = lowest;
+        }
+
+        //--- Face axes are tested before edge-edge axes, so face cases are favored
+        for(int i = 0; i < 15; ++i)
+        {
+          real_type X[3][W];
+          if(i < 3)
+          {
+            for(int c = 0; c < 3; ++c)
+              for(int l = 0; l < W; ++l)
+                X[c][l] = A[i][c][l];
+          }
+          else if(i < 6)
+          {
+            for(int c = 0; c < 3; ++c)
+              for(int l = 0; l < W; ++l)
+                X[c][l] = B[i-3][c][l];
+          }
+          else
+          {
+            int const u = (i-6)/3;
+            int const v = (i-6)%3;
+            for(int l = 0; l < W; ++l)
+            {
+              real_type const x = A[u][1][l]*B[v][2][l] - B[v][1][l]*A[u][2][l];
+              real_type const y = B[v][0][l]*A[u][2][l] - A[u][0][l]*B[v][2][l];
+              real_type const z = A[u][0][l]*B[v][1][l] - B[v][0][l]*A[u][1][l];
+              //--- Parallel edges give no axis, use the face axis instead
+              bool      const valid  = !( x == 0 && y == 0 && z == 0 );
+              real_type const length = valid ? sqrt( x*x + y*y + z*z ) : real_type(1);
+              X[0][l] = valid ? x / length : A[u][0][l];
+              X[1][l] = valid ? y / length : A[u][1][l];
+              X[2][l] = valid ? z / length : A[u][2][l];
+            }
+          }
+
+          //--- Projections of the boxes onto the axis
+          real_type min_proj_a[W];
+          real_type max_proj_a[W];
+          real_type min_proj_b[W];
+          real_type max_proj_b[W];
+          for(int l = 0; l < W; ++l)
+          {
+            min_proj_a[l] = min_proj_b[l] = highest;
+            max_proj_a[l] = max_proj_b[l] = lowest;
+          }
+          for(int k = 0; k < 8; ++k)
+            for(int l = 0; l < W; ++l)
+            {
+              real_type const proj_a = a[k][0][l]*X[0][l] + a[k][1][l]*X[1][l] + a[k][2][l]*X[2][l];
+              real_type const proj_b = b[k][0][l]*X[0][l] + b[k][1][l]*X[1][l] + b[k][2][l]*X[2][l];
+              min_proj_a[l] = proj_a < min_proj_a[l] ? proj_a : min_proj_a[l];
+              max_proj_a[l] = max_proj_a[l] < proj_a ? proj_a : max_proj_a[l];
+              min_proj_b[l] = proj_b < min_proj_b[l] ? proj_b : min_proj_b[l];
+              max_proj_b[l] = max_proj_b[l] < proj_b ? proj_b : max_proj_b[l];
+            }
+
+          //--- The overlap cases of box_box_improved(), in the same order. The
+          //--- overlap along the axis is o, f tells if the axis must be flipped.
+          real_type o[W];
+          int       f[W];
+          for(int l = 0; l < W; ++l)
+          {
+            real_type const min_a = min_proj_a[l];
+            real_type const max_a = max_proj_a[l];
+            real_type const min_b = min_proj_b[l];
+            real_type const max_b = max_proj_b[l];
+
+            separated[l] |= ( min_a > max_b + envelope ) | ( min_b > max_a + envelope );
+
+            real_type d = distance[l];
+            int       k = code[l];
+            real_type s = highest;
+            int       g = 0;
+            bool      c;
+            bool      take;
+
+            c    = max_a <= min_b;
+            s    = ( c & ( min_b - max_a < s ) ) ? min_b - max_a : s;
+            take = c & ( s > d );
+            d    = take ? s : d;
+            k    = take ? i : k;
+            g    = take ? 0 : g;
+
+            c    = max_b <= min_a;
+            s    = ( c & ( min_a - max_b < s ) ) ? min_a - max_b : s;
+            take = c & ( s > d );
+            d    = take ? s : d;
+            k    = take ? i : k;
+            g    = take ? 1 : g;
+
+            c    = ( min_a <= min_b ) & ( min_b <= max_a );
+            s    = ( c & ( -(max_a - min_b) < s ) ) ? -(max_a - min_b) : s;
+            take = c & ( s > d );
+            d    = take ? s : d;
+            k    = take ? i : k;
+            g    = take ? 0 : g;
+
+            c    = ( min_b <= min_a ) & ( min_a <= max_b );
+            s    = ( c & ( -(max_b - min_a) < s ) ) ? -(max_b - min_a) : s;
+            take = c & ( s > d );
+            d    = take ? s : d;
+            k    = take ? i : k;
+            g    = take ? 1 : g;
+
+            distance[l] = d;
+            code[l]     = k;
+            flip[l]     = ( k == i ) ? g : flip[l];
+            o[l]        = s;
+            f[l]        = g;
+          }
+
+          if(i < 6)
+          {
+            for(int l = 0; l < W; ++l)
+            {
+              face_overlap[i][l] = o[l];
+              face_flip[i][l]    = f[l];
+            }
+          }
+        }
+
+        for(int l = 0; l < W; ++l)
+        {
+          separated[l] |= ( distance[l] > envelope );
+          inside_a[l] = 0;
+          inside_b[l] = 0;
+        }
+
+        //--- Classify the corners of each box against the other box grown by the envelope
+        for(int mask = 0; mask < 8; ++mask)
+        {
+          for(int l = 0; l < W; ++l)
+          {
+            real_type const xa = a[mask][0][l] - p_b[0][l];
+            real_type const ya = a[mask][1][l] - p_b[1][l];
+            real_type const za = a[mask][2][l] - p_b[2][l];
+            real_type const xb = b[mask][0][l] - p_a[0][l];
+            real_type const yb = b[mask][1][l] - p_a[1][l];
+            real_type const zb = b[mask][2][l] - p_a[2][l];
+            bool const in_a =
+              ( fabs( R_b[0][0][l]*xa + R_b[1][0][l]*ya + R_b[2][0][l]*za ) <= ext_b[0][l] + envelope )
+              & ( fabs( R_b[0][1][l]*xa + R_b[1][1][l]*ya + R_b[2][1][l]*za ) <= ext_b[1][l] + envelope )
+              & ( fabs( R_b[0][2][l]*xa + R_b[1][2][l]*ya + R_b[2][2][l]*za ) <= ext_b[2][l] + envelope );
+            bool const in_b =
+              ( fabs( R_a[0][0][l]*xb + R_a[1][0][l]*yb + R_a[2][0][l]*zb ) <= ext_a[0][l] + envelope )
+              & ( fabs( R_a[0][1][l]*xb + R_a[1][1][l]*yb + R_a[2][1][l]*zb ) <= ext_a[1][l] + envelope )
+              & ( fabs( R_a[0][2][l]*xb + R_a[1][2][l]*yb + R_a[2][2][l]*zb ) <= ext_a[2][l] + envelope );
+            inside_a[l] |= ( in_a ? 1 : 0 ) << mask;
+            inside_b[l] |= ( in_b ? 1 : 0 ) << mask;
+          }
+        }
+
+        //--- An edge-edge case is replaced by the face case of minimum overlap if any corner is inside
+        for(int l = 0; l < W; ++l)
+        {
+          real_type best      = lowest;
+          int       best_code = 15;
+          int       best_flip = 0;
+          for(int i = 0; i < 6; ++i)
+          {
+            bool const take = face_overlap[i][l] > best;
+            best      = take ? face_overlap[i][l] : best;
+            best_code = take ? i                  : best_code;
+            best_flip = take ? face_flip[i][l]    : best_flip;
+          }
+          bool const fallback = code[l] >= 6 && ( inside_a[l] | inside_b[l] ) != 0;
+          code[l]     = fallback ? best_code : code[l];
+          flip[l]     = fallback ? best_flip : flip[l];
+          distance[l] = fallback ? best      : distance[l];
+        }
+      }
+
+      /**
+      * Runs the batched separating axis test on a block of box pairs.
+      *
+      * @param first  The index of the first box pair of the block. Lanes past
+      *               the last box pair replicate the last box pair.
+      */
+      template<typename real_type,typename vector3_type,typename matrix3x3_type>
+      inline void box_box_sat_block(
+        size_t first
+        , size_t count
+        , vector3_type const * p_a
+        , matrix3x3_type const * R_a
+        , vector3_type const * ext_a
+        , vector3_type const * p_b
+        , matrix3x3_type const * R_b
+        , vector3_type const * ext_b
+        , real_type const & envelope
+        , int (&separated)[box_box_batch_width]
+        , int (&code)[box_box_batch_width]
+        , int (&flip)[box_box_batch_width]
+        , real_type (&distance)[box_box_batch_width]
+        , int (&inside_a)[box_box_batch_width]
+        , int (&inside_b)[box_box_batch_width]
+        )
+      {
+        int const W = box_box_batch_width;
+
+        real_type Ra[3][3][W];
+        real_type Rb[3][3][W];
+        real_type pa[3][W];
+        real_type pb[3][W];
+        real_type ea[3][W];
+        real_type eb[3][W];
+
+        //--- Transpose the box data into lanes
+        for(int l = 0; l < W; ++l)
+        {
+          size_t const k = std::min( first + l, count - 1 );
+          for(int i = 0; i < 3; ++i)
+          {
+            for(int j = 0; j < 3; ++j)
+            {
+              Ra[i][j][l] = R_a[k](i,j);
+              Rb[i][j][l] = R_b[k](i,j);
+            }
+            pa[i][l] = p_a[k](i);
+            pb[i][l] = p_b[k](i);
+            ea[i][l] = ext_a[k](i);
+            eb[i][l] = ext_b[k](i);
+          }
+        }
+
+        box_box_sat_block( Ra, pa, ea, Rb, pb, eb, envelope, separated, code, flip, distance, inside_a, inside_b );
+      }
+
+    } // namespace detail
+
+    /**
+    * Batched Box Box Overlap Test.
+    * Runs the separating axis test of box_box_improved() on many box pairs.
+    * Box pairs are processed in blocks of detail::box_box_batch_width pairs,
+    * such that the separating axis test of a block can be vectorized. Blocks
+    * are processed in parallel if OpenMP is enabled.
+    *
+    * @param count     The number of box pairs.
+    * @param p_a       Array of centers of the A-boxes in WCS.
+    * @param R_a       Array of orientations of the A-boxes in WCS.
+    * @param ext_a     Array of extents of the A-boxes.
+    * @param p_b       Array of centers of the B-boxes in WCS.
+    * @param R_b       Array of orientations of the B-boxes in WCS.
+    * @param ext_b     Array of extents of the B-boxes.
+    * @param envelope  Box pairs separated by less than this distance are reported as overlapping.
+    * @param overlap   Upon return the i'th value is true if no separating axis was found for the i'th box pair. The
+    *                  flag type could for instance be bool or int.
+    */
+    template<typename real_type,typename vector3_type,typename matrix3x3_type,typename flag_type>
+    void box_box_overlap_batch(
+      size_t count
+      , vector3_type const * p_a
+      , matrix3x3_type const * R_a
+      , vector3_type const * ext_a
+      , vector3_type const * p_b
+      , matrix3x3_type const * R_b
+      , vector3_type const * ext_b
+      , real_type const & envelope
+      , flag_type * overlap
+      )
+    {
+      int const W = detail::box_box_batch_width;
+      int const blocks = static_cast<int>( (count + W - 1) / W );
+
+#pragma omp parallel for if(blocks > 1)
+      for(int block = 0; block < blocks; ++block)
+      {
+        int       separated[W];
+        int       code[W];
+        int       flip[W];
+        real_type distance[W];
+        int       inside_a[W];
+        int       inside_b[W];
+
+        size_t const first = static_cast<size_t>(block)*W;
+
+        detail::box_box_sat_block( first, count, p_a, R_a, ext_a, p_b, R_b, ext_b, envelope, separated, code, flip, distance, inside_a, inside_b );
+
+        for(int l = 0; l < W && first + l < count; ++l)
+          overlap[first + l] = ( separated[l] == 0 );
+      }
+    }
+
+    /**
+    * Batched Box Box Collision Test.
+    * Generates the contacts of box_box_improved() for many box pairs at
+    * once. The separating axis test, the choice of contact normal and the
+    * classification of the box corners are done in blocks of
+    * detail::box_box_batch_width vectorized lanes, see
+    * detail::box_box_sat_block(). Only the contact generation itself,
+    * detail::box_box_improved_contacts(), runs one box pair at a time: it
+    * clips the edges of the incident face against the reference face and
+    * emits a different number of contacts for every box pair, so lanes
+    * would diverge on every edge and the contacts would have to be
+    * compacted serially anyway. The separating axis test is done once per
+    * box pair, which matters for resting contacts such as box stacks,
+    * where most box pairs overlap.
+    *
+    * The contacts are those of box_box_improved(), up to round-off. Blocks
+    * are processed in parallel if OpenMP is enabled.
+    *
+    * @param count     The number of box pairs.
+    * @param p_a       Array of centers of the A-boxes in WCS.
+    * @param R_a       Array of orientations of the A-boxes in WCS.
+    * @param ext_a     Array of extents of the A-boxes, i.e. half edge sizes.
+    * @param p_b       Array of centers of the B-boxes in WCS.
+    * @param R_b       Array of orientations of the B-boxes in WCS.
+    * @param ext_b     Array of extents of the B-boxes, i.e. half edge sizes.
+    * @param envelope  The size of the collision envelope, contacts separated by more than this distance are dropped.
+    * @param stride    The number of contacts reserved per box pair in the contact arrays. Box pairs generating more contacts
+    *                  than this are truncated, see detail::box_box_max_contacts.
+    * @param p         Array of contact points, must have room for stride vectors per box pair. The contacts of
+    *                  the i'th box pair are stored from index stride*i.
+    * @param n         Array of contact normals, one per box pair, pointing from box A towards box B.
+    * @param distances Array of separation (or penetration) distances, same layout as p.
+    * @param contacts  Upon return the i'th value holds the number of contacts of the i'th box pair.
+    *
+    * @return          The total number of contacts.
+    */
+    template<typename real_type,typename vector3_type,typename matrix3x3_type>
+    size_t box_box_batch(
+      size_t count
+      , vector3_type const * p_a
+      , matrix3x3_type const * R_a
+      , vector3_type const * ext_a
+      , vector3_type const * p_b
+      , matrix3x3_type const * R_b
+      , vector3_type const * ext_b
+      , real_type const & envelope
+      , unsigned int stride
+      , vector3_type * p
+      , vector3_type * n
+      , real_type * distances
+      , unsigned int * contacts
+      )
+    {
+      assert(p);
+      assert(n);
+      assert(distances);
+      assert(contacts);
+
+      if(count == 0)
+        return 0;
+
+      int const W = detail::box_box_batch_width;
+      int const blocks = static_cast<int>( (count + W - 1) / W );
+      size_t total = 0;
+
+#pragma omp parallel for reduction(+:total) schedule(dynamic,8) if(blocks > 1)
+      for(int block = 0; block < blocks; ++block)
+      {
+        int       separated[W];
+        int       code[W];
+        int       flip[W];
+        real_type distance[W];
+        int       inside_a[W];
+        int       inside_b[W];
+
+        size_t const first = static_cast<size_t>(block)*W;
+
+        detail::box_box_sat_block( first, count, p_a, R_a, ext_a, p_b, R_b, ext_b, envelope, separated, code, flip, distance, inside_a, inside_b );
+
+        for(int l = 0; l < W && first + l < count; ++l)
+        {
+          size_t const i = first + l;
+          contacts[i] = 0;
+          if( separated[l] || code[l] == 15 )
+            continue;
+
+          vector3_type A[3];
+          vector3_type B[3];
+          detail::box_box_improved_axes( R_a[i], A );
+          detail::box_box_improved_axes( R_b[i], B );
+
+          vector3_type a[8];
+          vector3_type b[8];
+          detail::box_box_improved_corners( p_a[i], A, ext_a[i], a );
+          detail::box_box_improved_corners( p_b[i], B, ext_b[i], b );
+
+          bool AinB[8];
+          bool BinA[8];
+          for(int k = 0; k < 8; ++k)
+          {
+            AinB[k] = ( ( inside_a[l] >> k ) & 0x0001 ) != 0;
+            BinA[k] = ( ( inside_b[l] >> k ) & 0x0001 ) != 0;
+          }
+
+          n[i] = detail::box_box_improved_axis( A, B, static_cast<unsigned int>( code[l] ) );
+          if(flip[l])
+            n[i] = - n[i];
+
+          vector3_type points[detail::box_box_max_contacts];
+          real_type    depths[detail::box_box_max_contacts];
+          unsigned int const cnt = std::min(
+            stride
+            , detail::box_box_improved_contacts( p_a[i], A, ext_a[i], a, AinB, p_b[i], B, ext_b[i], b, BinA, static_cast<unsigned int>( code[l] ), n[i], distance[l], envelope, points, depths )
+            );
+          std::copy( points, points + cnt, p + stride*i );
+          std::copy( depths, depths + cnt, distances + stride*i );
+          contacts[i] = cnt;
+          total += cnt;
+        }
+      }
+      return total;
+    }
+
+  } //End of namespace collision
+
+} //End of namespace OpenTissue
+
+// OPENTISSUE_COLLISION_COLLISION_BOX_BOX_BATCH_H
+#endif
@@ -21,296 +21,146 @@ namespace OpenTissue
   namespace collision
   {
 
-    /**
-    * Improved Box Box Collision Test.
-    *
-    * @param p_a       Center of box A in WCS.
-    * @param p_b       Center of box B in WCS
-    * @param R_a       Box A's orientation in WCS
-    * @param R_b       Box B's orientation in WCS
-    * @param ext_a     Extents of box A, i.e. half edge sizes.
-    * @param ext_b     Extents of box B, i.e. half edge sizes.
-    * @param envelope  The size of the collision envelope. If cloest point are separted by more than this distance then there is no contact.
-    * @param p         Pointer to array of contact points, must have room for at least eight vectors.
-    * @param n         Upon return this argument holds the contact normal pointing from box A towards box B.
-    * @param distance  Pointer to array of separation (or penetration) distances. Must have room for at least eight values.
-    *
-    * @return          If contacts exist then the return value indicates the number of contacts, if no contacts exist the return valeu is zero.
-    */
-    template<typename real_type,typename vector3_type,typename matrix3x3_type>
-    unsigned int box_box_improved(
-      vector3_type  p_a
-      , matrix3x3_type R_a
-      , vector3_type const & ext_a
-      , vector3_type  p_b
-      , matrix3x3_type R_b
-      , vector3_type const & ext_b
-      , real_type const & envelope
-      , vector3_type * p
-      , vector3_type & n
-      , real_type * distances
-      )
+    namespace detail
     {
-      using std::fabs;
-      using std::min;
-      using std::max;
-      using std::sqrt;
 
-      typedef          math::CoordSys<real_type>      coordsys_type;
-      typedef typename coordsys_type::quaternion_type quaternion_type;
-
-      assert(p);
-      assert(distances);
-
-      //--- Sign lookup table, could be precomputed!!!
-      vector3_type sign[8];
-      for(unsigned int mask=0;mask<8;++mask)
+      /**
+      * Extracts the axes of a box in WCS, as used by box_box_improved().
+      * Components that are numerically zero are truncated to zero.
+      *
+      * @param R   The orientation of the box in WCS.
+      * @param A   Upon return A[i] holds the i'th axis of the box.
+      */
+      template<typename vector3_type,typename matrix3x3_type>
+      inline void box_box_improved_axes( matrix3x3_type const & R, vector3_type (&A)[3] )
       {
-        sign[mask](0) = (mask&0x0001)?1:-1;
-        sign[mask](1) = ((mask>>1)&0x0001)?1:-1;
-        sign[mask](2) = ((mask>>2)&0x0001)?1:-1;
+        using std::fabs;
+
+        A[0](0) = R(0,0);   A[0](1) = R(1,0);   A[0](2) = R(2,0);
+        A[1](0) = R(0,1);   A[1](1) = R(1,1);   A[1](2) = R(2,1);
+        A[2](0) = R(0,2);   A[2](1) = R(1,2);   A[2](2) = R(2,2);
+
+        //--- To compat numerical round-offs, these tend to favor edge-edge
+        //--- cases, when one really rather wants a face-case. Truncating
+        //--- seems to let the algorithm pick face cases over edge-edge
+        //--- cases.
+        for(unsigned int i=0;i<3;++i)
+          for(unsigned int j=0;j<3;++j)
+            if( fabs( A[i](j) ) < 10e-7 )
+              A[i](j) = 0.;
       }
-      //--- extract axis of boxes in WCS
-      vector3_type A[3];
-      A[0](0) = R_a(0,0);   A[0](1) = R_a(1,0);   A[0](2) = R_a(2,0);
-      A[1](0) = R_a(0,1);   A[1](1) = R_a(1,1);   A[1](2) = R_a(2,1);
-      A[2](0) = R_a(0,2);   A[2](1) = R_a(1,2);   A[2](2) = R_a(2,2);
 
-      vector3_type B[3];
-      B[0](0) = R_b(0,0);   B[0](1) = R_b(1,0);   B[0](2) = R_b(2,0);
-      B[1](0) = R_b(0,1);   B[1](1) = R_b(1,1);   B[1](2) = R_b(2,1);
-      B[2](0) = R_b(0,2);   B[2](1) = R_b(1,2);   B[2](2) = R_b(2,2);
-
-      //--- To compat numerical round-offs, these tend to favor edge-edge
-      //--- cases, when one really rather wants a face-case. Truncating
-      //--- seems to let the algorithm pick face cases over edge-edge
-      //--- cases.
-      for(unsigned int i=0;i<3;++i)
-        for(unsigned int j=0;j<3;++j)
-        {
-          if( fabs( A[i](j) ) < 10e-7 )
-            A[i](j) = 0.;
-          if( fabs( B[i](j) ) < 10e-7 )
-            B[i](j) = 0.;
-        }
-
-        vector3_type a[8];
-        vector3_type b[8];
-        //--- corner points of boxes in WCS
-        for(unsigned int i=0;i<8;++i)
+      /**
+      * Computes the corner points of a box in WCS. The i'th corner lies on
+      * the positive side of the k'th axis if the k'th bit of i is set.
+      *
+      * @param c     The center of the box in WCS.
+      * @param A     The axes of the box in WCS.
+      * @param ext   The extents of the box.
+      * @param corners  Upon return holds the eight corner points.
+      */
+      template<typename vector3_type>
+      inline void box_box_improved_corners(
+        vector3_type const & c
+        , vector3_type const (&A)[3]
+        , vector3_type const & ext
+        , vector3_type (&corners)[8]
+        )
+      {
+        for(unsigned int mask=0;mask<8;++mask)
         {
-          a[i] = sign[i](2)*A[2]*ext_a(2) + sign[i](1)*A[1]*ext_a(1) + sign[i](0)*A[0]*ext_a(0) + p_a;
-          b[i] = sign[i](2)*B[2]*ext_b(2) + sign[i](1)*B[1]*ext_b(1) + sign[i](0)*B[0]*ext_b(0) + p_b;
+          vector3_type sign;
+          sign(0) = (mask&0x0001)?1:-1;
+          sign(1) = ((mask>>1)&0x0001)?1:-1;
+          sign(2) = ((mask>>2)&0x0001)?1:-1;
+          corners[mask] = sign(2)*A[2]*ext(2) + sign(1)*A[1]*ext(1) + sign(0)*A[0]*ext(0) + c;
         }
+      }
 
-        //--- Potential separating axes in WCS
-        vector3_type axis[15];
-        axis[0] = A[0];
-        axis[1] = A[1];
-        axis[2] = A[2];
-        axis[3] = B[0];
-        axis[4] = B[1];
-        axis[5] = B[2];
-        axis[6] = A[0] % B[0];
-        if(axis[6](0)==0 && axis[6](1)==0 && axis[6](2)==0)
-          axis[6] = A[0];
-        else
-          axis[6] /= sqrt(axis[6]*axis[6]);
-        axis[7] = A[0] % B[1];
-        if(axis[7](0)==0 && axis[7](1)==0 && axis[7](2)==0)
-          axis[7] = A[0];
-        else
-          axis[7] /= sqrt(axis[7]*axis[7]);
-        axis[8] = A[0] % B[2];
-        if(axis[8](0)==0 && axis[8](1)==0 && axis[8](2)==0)
-          axis[8] = A[0];
-        else
-          axis[8] /= sqrt(axis[8]*axis[8]);
-        axis[9] = A[1] % B[0];
-        if(axis[9](0)==0 && axis[9](1)==0 && axis[9](2)==0)
-          axis[9] = A[1];
-        else
-          axis[9] /= sqrt(axis[9]*axis[9]);
-        axis[10] = A[1] % B[1];
-        if(axis[10](0)==0 && axis[10](1)==0 && axis[10](2)==0)
-          axis[10] = A[1];
-        else
-          axis[10] /= sqrt(axis[10]*axis[10]);
-        axis[11] = A[1] % B[2];
-        if(axis[11](0)==0 && axis[11](1)==0 && axis[11](2)==0)
-          axis[11] = A[1];
-        else
-          axis[11] /= sqrt(axis[11]*axis[11]);
-        axis[12] = A[2] % B[0];
-        if(axis[12](0)==0 && axis[12](1)==0 && axis[12](2)==0)
-          axis[12] = A[2];
-        else
-          axis[12] /= sqrt(axis[12]*axis[12]);
-        axis[13] = A[2] % B[1];
-        if(axis[13](0)==0 && axis[13](1)==0 && axis[13](2)==0)
-          axis[13] = A[2];
-        else
-          axis[13] /= sqrt(axis[13]*axis[13]);
-        axis[14] = A[2] % B[2];
-        if(axis[14](0)==0 && axis[14](1)==0 && axis[14](2)==0)
-          axis[14] = A[2];
-        else
-          axis[14] /= sqrt(axis[14]*axis[14]);
+      /**
+      * Returns one of the 15 potential separating axes of box_box_improved().
+      * Axes 0-2 are the axes of box A, axes 3-5 the axes of box B, and axis
+      * 6 + 3*i + j is the normalized cross product of A[i] and B[j]. Parallel
+      * edges give no cross product, A[i] is used instead.
+      */
+      template<typename vector3_type>
+      inline vector3_type box_box_improved_axis(
+        vector3_type const (&A)[3]
+        , vector3_type const (&B)[3]
+        , unsigned int i
+        )
+      {
+        using std::sqrt;
+
+        if(i < 3)
+          return A[i];
+        if(i < 6)
+          return B[i-3];
+        vector3_type axis = A[(i-6)/3] % B[(i-6)%3];
+        if(axis(0)==0 && axis(1)==0 && axis(2)==0)
+          return A[(i-6)/3];
+        axis /= sqrt(axis*axis);
+        return axis;
+      }
 
+      /**
+      * Contact Generation of box_box_improved().
+      * Generates the contacts once the contact normal is known, either a
+      * single edge-edge contact or the face contacts, given by the edge
+      * crossings of the incident and the reference face and by the corners
+      * of each box that lie inside the other box.
+      *
+      * @param p_a             Center of box A in WCS.
+      * @param A               Axes of box A, see box_box_improved_axes().
+      * @param ext_a           Extents of box A.
+      * @param a               Corners of box A, see box_box_improved_corners().
+      * @param AinB            AinB[i] is true if the i'th corner of box A lies inside box B grown by the envelope.
+      * @param p_b             Center of box B in WCS.
+      * @param B               Axes of box B.
+      * @param ext_b           Extents of box B.
+      * @param b               Corners of box B.
+      * @param BinA            BinA[i] is true if the i'th corner of box B lies inside box A grown by the envelope.
+      * @param minimum_axis    The index of the contact normal axis, see box_box_improved_axis().
+      * @param n               The contact normal, pointing from box A towards box B.
+      * @param minimum_overlap The separation along the contact normal.
+      * @param envelope        The size of the collision envelope.
+      * @param p               Pointer to array of contact points.
+      * @param distances       Pointer to array of separation (or penetration) distances.
+      *
+      * @return                The number of contacts.
+      */
+      template<typename real_type,typename vector3_type>
+      inline unsigned int box_box_improved_contacts(
+        vector3_type p_a
+        , vector3_type const (&A)[3]
+        , vector3_type const & ext_a
+        , vector3_type const (&a)[8]
+        , bool const (&AinB)[8]
+        , vector3_type p_b
+        , vector3_type const (&B)[3]
+        , vector3_type const & ext_b
+        , vector3_type const (&b)[8]
+        , bool const (&BinA)[8]
+        , unsigned int minimum_axis
+        , vector3_type const & n
+        , real_type const & minimum_overlap
+        , real_type const & envelope
+        , vector3_type * p
+        , real_type * distances
+        )
+      {
+        using std::fabs;
 
-        //--- project vertices of boxes onto separating axis
-        real_type min_proj_a[15];
-        real_type min_proj_b[15];
-        real_type max_proj_a[15];
-        real_type max_proj_b[15];
-        for(unsigned int i=0;i<15;++i)
-        {
-          min_proj_a[i] = min_proj_b[i] = math::detail::highest<real_type>();
-          max_proj_a[i] = max_proj_b[i] = math::detail::lowest<real_type>();
-        }
-        for(unsigned int i=0;i<15;++i)
-        {
-          for(unsigned int j=0;j<8;++j)
-          {
-            real_type proj_a = a[j]*axis[i];
-            real_type proj_b = b[j]*axis[i];
-            min_proj_a[i] = min(min_proj_a[i],proj_a);
-            max_proj_a[i] = max(max_proj_a[i],proj_a);
-            min_proj_b[i] = min(min_proj_b[i],proj_b);
-            max_proj_b[i] = max(max_proj_b[i],proj_b);
-          }
-          //--- test for valid separation axis if so return
-          if (min_proj_a[i] > (max_proj_b[i]+envelope) ||   min_proj_b[i] > (max_proj_a[i]+envelope))
-            return 0;
-        }
-        //--- Compute box overlaps along all 15 separating axes, and determine
-        //--- minimum overlap
-        real_type overlap[15];
-        real_type minimum_overlap = math::detail::lowest<real_type>();
-        unsigned int minimum_axis = 15;
-        bool flip_axis[15];
-        //--- Notice that edge-edge cases are testet last, so face cases
-        //--- are favored over edge-edge cases
-        for(unsigned int i=0;i<15;++i)
-        {
-          flip_axis[i] = false;
-          overlap[i] = math::detail::highest<real_type>();
-          if(max_proj_a[i] <= min_proj_b[i])
-          {
-            overlap[i] = min( overlap[i], min_proj_b[i] - max_proj_a[i] );
-            if(overlap[i]>minimum_overlap)
-            {
-              minimum_overlap = overlap[i];
-              minimum_axis = i;
-              flip_axis[i] = false;
-            }
-          }
-          if(max_proj_b[i] <= min_proj_a[i])
-          {
-            overlap[i] = min( overlap[i], min_proj_a[i] - max_proj_b[i] );
-            if(overlap[i]>minimum_overlap)
-            {
-              minimum_overlap = overlap[i];
-              minimum_axis = i;
-              flip_axis[i] = true;
-            }
-          }
-          if(min_proj_a[i] <= min_proj_b[i] &&  min_proj_b[i] <= max_proj_a[i])
-          {
-            overlap[i] = min( overlap[i], -(max_proj_a[i] - min_proj_b[i]) );
-            if(overlap[i]>minimum_overlap)
-            {
-              minimum_overlap = overlap[i];
-              minimum_axis = i;
-              flip_axis[i] = false;
-            }
-          }
-          if(min_proj_b[i] <= min_proj_a[i] &&  min_proj_a[i] <= max_proj_b[i])
-          {
-            overlap[i] = min(overlap[i], -(max_proj_b[i] - min_proj_a[i]) );
-            if(overlap[i]>minimum_overlap)
-            {
-              minimum_overlap = overlap[i];
-              minimum_axis = i;
-              flip_axis[i] = true;
-            }
-          }
-        }
-        if(minimum_overlap>envelope)
-          return 0;
-        //--- Take care of normals, so they point in the correct direction.
-        for(unsigned int i=0;i<15;++i)
-        {
-          if(flip_axis[i])
-            axis[i] = - axis[i];
-        }
-        //--- At this point we know that a projection along axis[minimum_axis] with
-        //--- value minimum_overlap will lead to non-penetration of the two boxes. We
-        //--- just need to generate the contact points!!!
-        unsigned int corners_inside = 0;
         unsigned int corners_B_in_A = 0;
         unsigned int corners_A_in_B = 0;
-        bool AinB[8];
-        bool BinA[8];
-
-        coordsys_type WCStoB(p_b,R_b);
-        coordsys_type WCStoA(p_a,R_a);
-
-        WCStoA = inverse(WCStoA);
-        WCStoB = inverse(WCStoB);
-
-        vector3_type eps_a = ext_a + vector3_type(envelope,envelope,envelope);
-        vector3_type eps_b = ext_b + vector3_type(envelope,envelope,envelope);
         for(unsigned int i=0;i<8;++i)
         {
-          vector3_type a_in_B = a[i];
-          WCStoB.xform_point(a_in_B);
-          vector3_type abs_a = fabs(a_in_B);
-          if(abs_a <= eps_b)
-          {
-            ++corners_inside;
+          if(AinB[i])
             ++corners_A_in_B;
-            AinB[i] = true;
-          }
-          else
-            AinB[i] = false;
-          vector3_type b_in_A = b[i];
-          WCStoA.xform_point(b_in_A);
-          vector3_type abs_b = fabs(b_in_A);
-          if(abs_b <= eps_a)
-          {
-            ++corners_inside;
+          if(BinA[i])
             ++corners_B_in_A;
-            BinA[i] = true;
-          }
-          else
-            BinA[i] = false;
-        }
-        //--- This may indicate an edge-edge case
-        if(minimum_axis >= 6)
-        {
-          //--- However the edge-edge case may not be the best choice,
-          //--- so if we find a corner point of one box being inside
-          //--- the other, we fall back to use the face case with
-          //--- minimum overlap.
-          if(corners_inside)//--- Actually we only need to test end-points of edge for inclusion (4 points instead of 16!!!).
-          {
-            minimum_overlap = math::detail::lowest<real_type>();
-            minimum_axis = 15;
-            for(unsigned int i=0;i<6;++i)
-            {
-              if(overlap[i]>minimum_overlap)
-              {
-                minimum_overlap = overlap[i];
-                minimum_axis = i;
-              }
-            }
-          }
         }
-
-        //--- now we can safely pick the contact normal, since we
-        //--- know wheter we have a face-case or edge-edge case.
-        n = axis[minimum_axis];
+        unsigned int const corners_inside = corners_A_in_B + corners_B_in_A;
 
         //--- This is definitely an edge-edge case
         if(minimum_axis>=6)
@@ -342,7 +192,7 @@ namespace OpenTissue
           p_b += B[columnB]*t;
           //--- Let the contact point be given by the mean of the closest points.
           p[0] = (p_a + p_b)*.5;
-          distances[0] = overlap[minimum_axis];
+          distances[0] = minimum_overlap;
           return 1;
         }
         //--- This is a face-``something else'' case, we actually already have taken
@@ -357,10 +207,10 @@ namespace OpenTissue
         //--- use the letter 'r' or 'R' for it. The other box is named the incident box,
         //--- its closest face towards the reference face is called the incidient face, and
         //--- is denoted by the letter 'i' or 'I'.
-        vector3_type * R_r,* R_i;  //--- Box direction vectors in WCS
+        vector3_type const * R_r,* R_i;  //--- Box direction vectors in WCS
         vector3_type ext_r,ext_i;          //--- Box extents
         vector3_type p_r,p_i;              //--- Box centers in WCS
-        bool * incident_inside;    //--- corner inside state of incident box.
+        bool const * incident_inside;    //--- corner inside state of incident box.
         if (minimum_axis  < 3)
         {
           //--- This means that box A is defining the reference frame
@@ -681,6 +531,222 @@ namespace OpenTissue
         }
         //      assert(cnt<=8);//--- If not we are in serious trouble!!!
         return cnt;
+      }
+
+    } // namespace detail
+
+    /**
+    * Improved Box Box Collision Test.
+    *
+    * @param p_a       Center of box A in WCS.
+    * @param p_b       Center of box B in WCS
+    * @param R_a       Box A's orientation in WCS
+    * @param R_b       Box B's orientation in WCS
+    * @param ext_a     Extents of box A, i.e. half edge sizes.
+    * @param ext_b     Extents of box B, i.e. half edge sizes.
+    * @param envelope  The size of the collision envelope. If cloest point are separted by more than this distance then there is no contact.
+    * @param p         Pointer to array of contact points, must have room for at least eight vectors.
+    * @param n         Upon return this argument holds the contact normal pointing from box A towards box B.
+    * @param distance  Pointer to array of separation (or penetration) distances. Must have room for at least eight values.
+    *
+    * @return          If contacts exist then the return value indicates the number of contacts, if no contacts exist the return valeu is zero.
+    */
+    template<typename real_type,typename vector3_type,typename matrix3x3_type>
+    unsigned int box_box_improved(
+      vector3_type  p_a
+      , matrix3x3_type R_a
+      , vector3_type const & ext_a
+      , vector3_type  p_b
+      , matrix3x3_type R_b
+      , vector3_type const & ext_b
+      , real_type const & envelope
+      , vector3_type * p
+      , vector3_type & n
+      , real_type * distances
+      )
+    {
+      using std::fabs;
+      using std::min;
+      using std::max;
+
+      typedef          math::CoordSys<real_type>      coordsys_type;
+      typedef typename coordsys_type::quaternion_type quaternion_type;
+
+      assert(p);
+      assert(distances);
+
+      //--- extract axis of boxes in WCS
+      vector3_type A[3];
+      vector3_type B[3];
+      detail::box_box_improved_axes( R_a, A );
+      detail::box_box_improved_axes( R_b, B );
+
+        vector3_type a[8];
+        vector3_type b[8];
+        //--- corner points of boxes in WCS
+        detail::box_box_improved_corners( p_a, A, ext_a, a );
+        detail::box_box_improved_corners( p_b, B, ext_b, b );
+
+        //--- Potential separating axes in WCS
+        vector3_type axis[15];
+        for(unsigned int i=0;i<15;++i)
+          axis[i] = detail::box_box_improved_axis( A, B, i );
+
+        //--- project vertices of boxes onto separating axis
+        real_type min_proj_a[15];
+        real_type min_proj_b[15];
+        real_type max_proj_a[15];
+        real_type max_proj_b[15];
+        for(unsigned int i=0;i<15;++i)
+        {
+          min_proj_a[i] = min_proj_b[i] = math::detail::highest<real_type>();
+          max_proj_a[i] = max_proj_b[i] = math::detail::lowest<real_type>();
+        }
+        for(unsigned int i=0;i<15;++i)
+        {
+          for(unsigned int j=0;j<8;++j)
+          {
+            real_type proj_a = a[j]*axis[i];
+            real_type proj_b = b[j]*axis[i];
+            min_proj_a[i] = min(min_proj_a[i],proj_a);
+            max_proj_a[i] = max(max_proj_a[i],proj_a);
+            min_proj_b[i] = min(min_proj_b[i],proj_b);
+            max_proj_b[i] = max(max_proj_b[i],proj_b);
+          }
+          //--- test for valid separation axis if so return
+          if (min_proj_a[i] > (max_proj_b[i]+envelope) ||   min_proj_b[i] > (max_proj_a[i]+envelope))
+            return 0;
+        }
+        //--- Compute box overlaps along all 15 separating axes, and determine
+        //--- minimum overlap
+        real_type overlap[15];
+        real_type minimum_overlap = math::detail::lowest<real_type>();
+        unsigned int minimum_axis = 15;
+        bool flip_axis[15];
+        //--- Notice that edge-edge cases are testet last, so face cases
+        //--- are favored over edge-edge cases
+        for(unsigned int i=0;i<15;++i)
+        {
+          flip_axis[i] = false;
+          overlap[i] = math::detail::highest<real_type>();
+          if(max_proj_a[i] <= min_proj_b[i])
+          {
+            overlap[i] = min( overlap[i], min_proj_b[i] - max_proj_a[i] );
+            if(overlap[i]>minimum_overlap)
+            {
+              minimum_overlap = overlap[i];
+              minimum_axis = i;
+              flip_axis[i] = false;
+            }
+          }
+          if(max_proj_b[i] <= min_proj_a[i])
+          {
+            overlap[i] = min( overlap[i], min_proj_a[i] - max_proj_b[i] );
+            if(overlap[i]>minimum_overlap)
+            {
+              minimum_overlap = overlap[i];
+              minimum_axis = i;
+              flip_axis[i] = true;
+            }
+          }
+          if(min_proj_a[i] <= min_proj_b[i] &&  min_proj_b[i] <= max_proj_a[i])
+          {
+            overlap[i] = min( overlap[i], -(max_proj_a[i] - min_proj_b[i]) );
+            if(overlap[i]>minimum_overlap)
+            {
+              minimum_overlap = overlap[i];
+              minimum_axis = i;
+              flip_axis[i] = false;
+            }
+          }
+          if(min_proj_b[i] <= min_proj_a[i] &&  min_proj_a[i] <= max_proj_b[i])
+          {
+            overlap[i] = min(overlap[i], -(max_proj_b[i] - min_proj_a[i]) );
+            if(overlap[i]>minimum_overlap)
+            {
+              minimum_overlap = overlap[i];
+              minimum_axis = i;
+              flip_axis[i] = true;
+            }
+          }
+        }
+        if(minimum_overlap>envelope)
+          return 0;
+        //--- Take care of normals, so they point in the correct direction.
+        for(unsigned int i=0;i<15;++i)
+        {
+          if(flip_axis[i])
+            axis[i] = - axis[i];
+        }
+        //--- At this point we know that a projection along axis[minimum_axis] with
+        //--- value minimum_overlap will lead to non-penetration of the two boxes. We
+        //--- just need to generate the contact points!!!
+        unsigned int corners_inside = 0;
+        unsigned int corners_B_in_A = 0;
+        unsigned int corners_A_in_B = 0;
+        bool AinB[8];
+        bool BinA[8];
+
+        coordsys_type WCStoB(p_b,R_b);
+        coordsys_type WCStoA(p_a,R_a);
+
+        WCStoA = inverse(WCStoA);
+        WCStoB = inverse(WCStoB);
+
+        vector3_type eps_a = ext_a + vector3_type(envelope,envelope,envelope);
+        vector3_type eps_b = ext_b + vector3_type(envelope,envelope,envelope);
+        for(unsigned int i=0;i<8;++i)
+        {
+          vector3_type a_in_B = a[i];
+          WCStoB.xform_point(a_in_B);
+          vector3_type abs_a = fabs(a_in_B);
+          if(abs_a <= eps_b)
+          {
+            ++corners_inside;
+            ++corners_A_in_B;
+            AinB[i] = true;
+          }
+          else
+            AinB[i] = false;
+          vector3_type b_in_A = b[i];
+          WCStoA.xform_point(b_in_A);
+          vector3_type abs_b = fabs(b_in_A);
+          if(abs_b <= eps_a)
+          {
+            ++corners_inside;
+            ++corners_B_in_A;
+            BinA[i] = true;
+          }
+          else
+            BinA[i] = false;
+        }
+        //--- This may indicate an edge-edge case
+        if(minimum_axis >= 6)
+        {
+          //--- However the edge-edge case may not be the best choice,
+          //--- so if we find a corner point of one box being inside
+          //--- the other, we fall back to use the face case with
+          //--- minimum overlap.
+          if(corners_inside)//--- Actually we only need to test end-points of edge for inclusion (4 points instead of 16!!!).
+          {
+            minimum_overlap = math::detail::lowest<real_type>();
+            minimum_axis = 15;
+            for(unsigned int i=0;i<6;++i)
+            {
+              if(overlap[i]>minimum_overlap)
+              {
+                minimum_overlap = overlap[i];
+                minimum_axis = i;
+              }
+            }
+          }
+        }
+
+        //--- now we can safely pick the contact normal, since we
+        //--- know wheter we have a face-case or edge-edge case.
+        n = axis[minimum_axis];
+
+        return detail::box_box_improved_contacts( p_a, A, ext_a, a, AinB, p_b, B, ext_b, b, BinA, minimum_axis, n, overlap[minimum_axis], envelope, p, distances );
     }
 
   } //End of namespace collision
@@ -36,6 +36,31 @@ namespace OpenTissue
 
     }
 
+    /**
+    * OBB Tree Collision with Front Tracking.
+    * Same as above, but the front of the previous query of the two trees is
+    * used as the starting point, see obb_tree::FrontCollisionQuery. Keep one
+    * front for each pair of trees and pass it to every query of that pair.
+    */
+    template<typename obb_tree_types>
+    bool obb_tree_obb_tree(
+      typename obb_tree_types::coordsys_type const & Awcs
+      , typename obb_tree_types::bvh_type const & A
+      , typename obb_tree_types::coordsys_type const & Bwcs
+      , typename obb_tree_types::bvh_type const & B
+      , typename obb_tree_types::front_type & front
+      , typename obb_tree_types::result_type & results
+      )
+    {
+      typedef typename obb_tree_types::coordsys_type                coordsys_type;
+      typedef typename obb_tree_types::front_collision_query_type   query_type;
+
+      coordsys_type A2B = OpenTissue::math::model_update(Awcs,Bwcs);
+      query_type query;
+      query.run(A2B,A,B,front,results);
+      return (results.size()>0);
+    }
+
   }// namespace collision
 
 } // namespace OpenTissue
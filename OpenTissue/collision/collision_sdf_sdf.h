@@ -11,6 +11,7 @@
 
 #include <OpenTissue/collision/bvh/bvh_single_collision_query.h>
 #include <OpenTissue/collision/sdf/sdf_collision_policy.h>
+#include <OpenTissue/collision/sdf/sdf_batch_collision_query.h>
 
 namespace OpenTissue
 {
@@ -66,6 +67,56 @@ namespace OpenTissue
       return true;
     }
 
+    /**
+    * Batched Signed Distance Field Geometry Collision Query.
+    * Gives the same contact points as sdf_sdf(), but the sample points and the
+    * sphere BVHs are processed in batches, see sdf::BatchCollisionQuery.
+    *
+    * @param AtoWCS       The world location of the geometry of object A.
+    * @param A            The geometry of object A.
+    * @param BtoWCS       The world location of the geometry of object B.
+    * @param B            The geometry of object B.
+    * @param contacts     Upon return holds all the contact points between the two object. By convention contact normals alway point from object A towards object B.
+    * @param envelope     The size of the collision envelope. Whenever objects are within this distance then contact points will be generated.
+    *
+    * @return             If a collision is detected then the return value is true otherwise it is false.
+    */
+    template<typename coordsys_type,typename sdf_geometry_type,typename contact_point_container,typename real_type>
+    bool sdf_sdf_batch(
+      coordsys_type const & AtoWCS
+      , sdf_geometry_type const & A
+      , coordsys_type const & BtoWCS
+      , sdf_geometry_type const & B
+      , contact_point_container & contacts
+      , real_type const & envelope
+      )
+    {
+      typedef typename sdf_geometry_type::bvh_type                                   bvh_type;
+      typedef          OpenTissue::sdf::BatchCollisionQuery<bvh_type,coordsys_type>  collision_query_type;
+
+      coordsys_type AtoB;
+      coordsys_type BtoA;
+      AtoB = model_update(AtoWCS,BtoWCS);
+      BtoA = inverse(AtoB);
+
+      collision_query_type  query;
+      contacts.clear();
+
+      query.envelope()  = envelope;
+      query.flipped()   = false;
+      query.wcs_xform() = BtoWCS;
+      query.run(AtoB, A.m_bvh, B, contacts);
+
+      query.envelope()  = envelope;
+      query.flipped()   = true; //--- We reversed the roles of objects A and B
+      query.wcs_xform() = AtoWCS;
+      query.run(BtoA, B.m_bvh, A, contacts);
+
+      if(contacts.empty())
+        return false;
+      return true;
+    }
+
   } //End of namespace collision
 } // namespace OpenTissue
 
@@ -10,6 +10,7 @@
 #include <OpenTissue/configuration.h>
 
 #include <OpenTissue/core/containers/grid/util/grid_is_point_inside.h>
+#include <OpenTissue/core/containers/grid/util/grid_mip_pyramid.h>
 
 namespace OpenTissue
 {
@@ -54,12 +55,18 @@ namespace OpenTissue
       if ( !OpenTissue::grid::is_point_inside( geometry.m_phi, c) )
         return false;
 
+      real_type tst = boost::numeric_cast<real_type>( envelope );
+
+      //--- Cull with the coarse levels before touching the distance map
+      real_type const threshold = tst + sphere.radius();
+      if ( OpenTissue::grid::pyramid_lower_bound( geometry.m_pyramid, c, threshold ) > threshold )
+        return false;
+
       real_type distance = OpenTissue::grid::value_at_point( geometry.m_phi, c);
       if ( distance == geometry.m_phi.unused() )
         return false;
 
       distance -= sphere.radius();
-      real_type tst = boost::numeric_cast<real_type>( envelope );
       if(distance > tst)
         return false;
 
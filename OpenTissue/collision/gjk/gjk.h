@@ -10,7 +10,9 @@
 #include <OpenTissue/configuration.h>
 
 // GJK library routines
+#include <OpenTissue/collision/gjk/gjk_cache.h>
 #include <OpenTissue/collision/gjk/gjk_compute_closest_points.h>
+#include <OpenTissue/collision/gjk/gjk_compute_penetration_depth.h>
 #include <OpenTissue/collision/gjk/gjk_constants.h>
 #include <OpenTissue/collision/gjk/gjk_outside_edge_face_voronoi_plane.h>
 #include <OpenTissue/collision/gjk/gjk_outside_triangle.h>
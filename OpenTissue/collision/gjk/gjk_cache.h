@@ -0,0 +1,128 @@
+#ifndef OPENTISSUE_COLLISION_GJK_GJK_CACHE_H
+#define OPENTISSUE_COLLISION_GJK_GJK_CACHE_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/gjk/gjk_simplex.h>
+
+namespace OpenTissue
+{
+  namespace gjk
+  {
+
+    /**
+    * Per Pair GJK Cache.
+    * This class stores the final simplex of a GJK run such that it can be
+    * used to warm-start GJK on the same pair of objects in the next frame.
+    *
+    * The support points are stored in the body frames of the two objects. This
+    * way the cached simplex can be re-evaluated under the new placements of the
+    * objects. Since the re-evaluated points are still points of the convex sets
+    * the re-evaluated simplex is a valid initial simplex of the Minkowsky
+    * difference. When the motion between two frames is small the re-evaluated
+    * simplex is nearly optimal and GJK converges in one or two iterations.
+    *
+    * A cache is meant to live with a pair of objects, for instance on an
+    * edge in a contact graph. It should be cleared whenever the pair is
+    * created or the shapes of the objects are changed.
+    */
+    template<typename vector3_type>
+    class Cache
+    {
+    public:
+
+      int          m_bitmask;    ///< Bit mask of used entries, same layout as in the Simplex class.
+      vector3_type m_a[4];       ///< Support points of object A given in the body frame of A.
+      vector3_type m_b[4];       ///< Support points of object B given in the body frame of B.
+
+    public:
+
+      Cache()
+        : m_bitmask(0)
+      {}
+
+    public:
+
+      void clear() { m_bitmask = 0; }
+
+      bool empty() const { return m_bitmask == 0; }
+
+    };
+
+    /**
+    * Store Simplex in Cache.
+    *
+    * @param sigma         The simplex that should be stored.
+    * @param transform_A   The current placement of object A.
+    * @param transform_B   The current placement of object B.
+    * @param cache         Upon return this argument holds the simplex in body frame coordinates.
+    */
+    template<typename transform_type>
+    inline void store_simplex(
+      Simplex<typename transform_type::vector3_type> const & sigma
+      , transform_type const & transform_A
+      , transform_type const & transform_B
+      , Cache<typename transform_type::vector3_type> & cache
+      )
+    {
+      cache.m_bitmask = sigma.m_bitmask;
+
+      int used_bit = 1;
+      for(size_t i = 0u; i < 4u; ++i)
+      {
+        if( sigma.m_bitmask & used_bit )
+        {
+          cache.m_a[i] = conj( transform_A.Q() ).rotate( sigma.m_a[i] - transform_A.T() );
+          cache.m_b[i] = conj( transform_B.Q() ).rotate( sigma.m_b[i] - transform_B.T() );
+        }
+        used_bit <<= 1;
+      }
+    }
+
+    /**
+    * Load Simplex from Cache.
+    * Re-evaluates the cached support points under the current placements of the objects.
+    *
+    * @param cache         The cache holding the simplex from the previous frame.
+    * @param transform_A   The current placement of object A.
+    * @param transform_B   The current placement of object B.
+    * @param sigma         Upon return this argument holds the re-evaluated simplex.
+    */
+    template<typename transform_type>
+    inline void load_simplex(
+      Cache<typename transform_type::vector3_type> const & cache
+      , transform_type const & transform_A
+      , transform_type const & transform_B
+      , Simplex<typename transform_type::vector3_type> & sigma
+      )
+    {
+      typedef typename transform_type::value_traits  value_traits;
+
+      sigma.m_bitmask = cache.m_bitmask;
+
+      int used_bit = 1;
+      for(size_t i = 0u; i < 4u; ++i)
+      {
+        if( cache.m_bitmask & used_bit )
+        {
+          sigma.m_a[i] = transform_A.Q().rotate( cache.m_a[i] ) + transform_A.T();
+          sigma.m_b[i] = transform_B.Q().rotate( cache.m_b[i] ) + transform_B.T();
+          sigma.m_v[i] = sigma.m_a[i] - sigma.m_b[i];
+          sigma.m_w[i] = value_traits::zero();
+        }
+        used_bit <<= 1;
+      }
+    }
+
+  } // namespace gjk
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_GJK_GJK_CACHE_H
+#endif
@@ -12,6 +12,8 @@
 #include <OpenTissue/collision/gjk/gjk_constants.h>
 #include <OpenTissue/collision/gjk/gjk_simplex.h>
 #include <OpenTissue/collision/gjk/gjk_voronoi_simplex_solver_policy.h>
+#include <OpenTissue/collision/gjk/gjk_cache.h>
+#include <OpenTissue/core/math/math_is_number.h>
 
 #include <cmath>
 #include <stdexcept>
@@ -111,6 +113,11 @@ namespace OpenTissue
     *
     * @param iterations           Upon return this argument holds the number of iterations used.
     * @param status               The status code of the algorithm.
+    * @param sigma                Upon invocation this argument holds the initial simplex. If the simplex
+    *                             is empty the algorithm starts from scratch otherwise the closest point of
+    *                             the given simplex is used as the first iterate. Upon return the argument
+    *                             holds the final simplex. If status is INTERSECTION the final simplex is
+    *                             a tetrahedron containing the origin.
     * @param absolute_tolerance   
     * @param relative_tolerance   
     * @param stagnation_tolerance   
@@ -140,6 +147,7 @@ namespace OpenTissue
     , typename transform_type::value_type & distance
     , size_t & iterations
     , size_t & status
+    , Simplex<typename transform_type::vector3_type> & sigma
     , typename transform_type::value_type const & absolute_tolerance
     , typename transform_type::value_type const & relative_tolerance
     , typename transform_type::value_type const & stagnation_tolerance
@@ -154,7 +162,6 @@ namespace OpenTissue
       typedef typename transform_type::vector3_type  V;
       typedef typename transform_type::value_type    T;
       typedef typename transform_type::value_traits  value_traits;
-      typedef          Simplex<V>                    simplex_type;
 
       if( absolute_tolerance < value_traits::zero() ) 
         throw std::invalid_argument( "absolute tolerance must be non-negative" );
@@ -172,14 +179,39 @@ namespace OpenTissue
       T    const squared_absolute_tolerance = absolute_tolerance*absolute_tolerance;
       T          squared_distance           = value_traits::infinity();
 
-      // Simplex approximation to convex set C
-      simplex_type sigma;
-
       // Initially we use a 0-simplex corresponding to some point
       // in C. We do this by seeding the initial closest point to
       // be the zero-vector.
       V v = V( value_traits::zero(), value_traits::zero(), value_traits::zero() );
 
+      // If we were given a simplex (typically the simplex from the previous
+      // frame) then we use its closest point as the first iterate instead.
+      bool const warm_started = (sigma.m_bitmask != 0);
+      if( warm_started )
+      {
+        v = simplex_solver_policy::reduce_simplex( sigma, p_a, p_b );
+        squared_distance = dot( v, v );
+
+        if( !is_number( squared_distance ) )
+        {
+          // The re-used simplex was degenerate, fall back to a cold start
+          sigma.m_bitmask = 0;
+          v.clear();
+          squared_distance = value_traits::infinity();
+        }
+        else if( is_full_simplex( sigma ) )
+        {
+          distance = value_traits::zero();
+          status = INTERSECTION;
+          return;
+        }
+        else if( squared_distance <= squared_absolute_tolerance )
+        {
+          distance = sqrt( squared_distance );
+          status = ABSOLUTE_CONVERGENCE;
+          return;
+        }
+      }
 
       // Lower error bound on distance from origin to closest point 
       T mu = value_traits::zero();
@@ -220,7 +252,7 @@ namespace OpenTissue
         // Test if the new point is already part of the current simplex
         if ( is_point_in_simplex ( w, sigma ) )
         {
-          assert( iterations > 1u || !"compute_closest_points(): simplex should be empty in first iteration?");
+          assert( iterations > 1u || warm_started || !"compute_closest_points(): simplex should be empty in first iteration?");
           // if so it means we can not find any points in C that is
           // closer to p and we are done
           distance = sqrt( squared_distance );
@@ -319,6 +351,115 @@ namespace OpenTissue
       status = EXCEEDED_MAX_ITERATIONS_LIMIT;
     }
 
+    /**
+    * Compute Closest Points and Distance between two Convex Sets.
+    * This version always starts from an empty simplex, see the
+    * version above for details on the arguments.
+    */
+    template<
+      typename transform_type
+      , typename support_functor1
+      , typename support_functor2
+      , typename simplex_solver_policy
+    >
+    inline void compute_closest_points( 
+      transform_type const & transform_A
+    , support_functor1 const & support_function_A
+    , transform_type const & transform_B
+    , support_functor2 const & support_function_B
+    , typename transform_type::vector3_type & p_a
+    , typename transform_type::vector3_type & p_b
+    , typename transform_type::value_type & distance
+    , size_t & iterations
+    , size_t & status
+    , typename transform_type::value_type const & absolute_tolerance
+    , typename transform_type::value_type const & relative_tolerance
+    , typename transform_type::value_type const & stagnation_tolerance
+    , size_t const & max_iterations
+    , simplex_solver_policy const & solver_policy
+    )
+    {
+      Simplex<typename transform_type::vector3_type> sigma;
+
+      compute_closest_points( 
+        transform_A
+        , support_function_A
+        , transform_B
+        , support_function_B
+        , p_a
+        , p_b
+        , distance
+        , iterations
+        , status
+        , sigma
+        , absolute_tolerance
+        , relative_tolerance
+        , stagnation_tolerance
+        , max_iterations
+        , solver_policy
+        );
+    }
+
+    /**
+    * Compute Closest Points and Distance between two Convex Sets using a Per Pair Cache.
+    * The simplex stored in the cache is re-evaluated under the current placements
+    * of the objects and used to warm-start the algorithm. Upon return the final
+    * simplex is stored in the cache. For coherent motion this means that the
+    * algorithm converges in one or two iterations.
+    *
+    * @param cache   The per pair cache. An empty cache gives a cold start.
+    *
+    * See the versions above for details on the remaining arguments.
+    */
+    template<
+      typename transform_type
+      , typename support_functor1
+      , typename support_functor2
+      , typename simplex_solver_policy
+    >
+    inline void compute_closest_points( 
+      transform_type const & transform_A
+    , support_functor1 const & support_function_A
+    , transform_type const & transform_B
+    , support_functor2 const & support_function_B
+    , typename transform_type::vector3_type & p_a
+    , typename transform_type::vector3_type & p_b
+    , typename transform_type::value_type & distance
+    , size_t & iterations
+    , size_t & status
+    , Cache<typename transform_type::vector3_type> & cache
+    , typename transform_type::value_type const & absolute_tolerance
+    , typename transform_type::value_type const & relative_tolerance
+    , typename transform_type::value_type const & stagnation_tolerance
+    , size_t const & max_iterations
+    , simplex_solver_policy const & solver_policy
+    )
+    {
+      Simplex<typename transform_type::vector3_type> sigma;
+
+      load_simplex( cache, transform_A, transform_B, sigma );
+
+      compute_closest_points( 
+        transform_A
+        , support_function_A
+        , transform_B
+        , support_function_B
+        , p_a
+        , p_b
+        , distance
+        , iterations
+        , status
+        , sigma
+        , absolute_tolerance
+        , relative_tolerance
+        , stagnation_tolerance
+        , max_iterations
+        , solver_policy
+        );
+
+      store_simplex( sigma, transform_A, transform_B, cache );
+    }
+
     /**
     * Lazy Man's Version.
     * This function uses presets for parameters that control the algorithm.
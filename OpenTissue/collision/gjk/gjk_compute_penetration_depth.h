@@ -0,0 +1,685 @@
+#ifndef OPENTISSUE_COLLISION_GJK_GJK_COMPUTE_PENETRATION_DEPTH_H
+#define OPENTISSUE_COLLISION_GJK_GJK_COMPUTE_PENETRATION_DEPTH_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/gjk/gjk_constants.h>
+#include <OpenTissue/collision/gjk/gjk_simplex.h>
+#include <OpenTissue/collision/gjk/gjk_cache.h>
+#include <OpenTissue/collision/gjk/gjk_compute_closest_points.h>
+#include <OpenTissue/collision/gjk/gjk_voronoi_simplex_solver_policy.h>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace OpenTissue
+{
+  namespace gjk
+  {
+    namespace detail
+    {
+
+      /**
+      * EPA Face.
+      * A triangular face of the expanding polytope. The vertices
+      * are ordered counter clock-wise when seen from the outside.
+      */
+      template<typename V>
+      class EPAFace
+      {
+      public:
+
+        typedef typename V::value_type  T;
+
+        size_t m_i[3];     ///< Indices of the face vertices.
+        V      m_n;        ///< The outward unit normal of the face.
+        T      m_d;        ///< Signed distance from the origin to the plane of the face.
+
+      };
+
+      /**
+      * EPA Polytope.
+      * Holds the vertices of the expanding polytope together with the
+      * corresponding support points of the two objects.
+      */
+      template<typename V>
+      class EPAPolytope
+      {
+      public:
+
+        typedef typename V::value_type   T;
+        typedef typename V::value_traits value_traits;
+        typedef EPAFace<V>               face_type;
+
+        std::vector<V>          m_w;       ///< Vertices of the polytope (points in the Minkowsky difference).
+        std::vector<V>          m_a;       ///< Corresponding support points of object A.
+        std::vector<V>          m_b;       ///< Corresponding support points of object B.
+        std::vector<face_type>  m_faces;   ///< The faces of the polytope.
+
+      public:
+
+        size_t add_vertex(V const & w, V const & a, V const & b)
+        {
+          m_w.push_back(w);
+          m_a.push_back(a);
+          m_b.push_back(b);
+          return m_w.size() - 1u;
+        }
+
+        /**
+        * Make Face.
+        *
+        * @return   If the face is degenerate the return value is false otherwise it is true.
+        */
+        bool make_face(size_t i, size_t j, size_t k, face_type & face) const
+        {
+          using std::sqrt;
+
+          V   const n   = cross( m_w[j] - m_w[i], m_w[k] - m_w[i] );
+          T   const len = sqrt( dot( n, n ) );
+          if( !(len > value_traits::zero()) )
+            return false;
+
+          face.m_i[0] = i;
+          face.m_i[1] = j;
+          face.m_i[2] = k;
+          face.m_n    = n / len;
+          face.m_d    = dot( face.m_n, m_w[i] );
+          return true;
+        }
+
+        /**
+        * Initialize Polytope from Tetrahedron.
+        * Creates the four faces of the tetrahedron formed by the first
+        * four vertices. Faces are oriented such that their normals point
+        * away from the opposite vertex.
+        *
+        * @return   If the tetrahedron is degenerate the return value is false otherwise it is true.
+        */
+        bool init_faces()
+        {
+          static size_t const tetrahedron[4][4] = { {0,1,2,3}, {0,3,1,2}, {0,2,3,1}, {1,3,2,0} };
+
+          m_faces.clear();
+          for(size_t f = 0u; f < 4u; ++f)
+          {
+            size_t const i = tetrahedron[f][0];
+            size_t       j = tetrahedron[f][1];
+            size_t       k = tetrahedron[f][2];
+            size_t const o = tetrahedron[f][3];
+
+            face_type face;
+            if( !make_face( i, j, k, face ) )
+              return false;
+            if( dot( face.m_n, m_w[o] - m_w[i] ) > value_traits::zero() )
+            {
+              std::swap( j, k );
+              make_face( i, j, k, face );
+            }
+            m_faces.push_back( face );
+          }
+          return true;
+        }
+
+      };
+
+      /**
+      * Support Point of Minkowsky Difference.
+      * Computes \f$S_{A \ominus B}(s) = S_{A}(s) - S_{B}(-s)\f$ in world coordinates.
+      */
+      template<
+        typename transform_type
+        , typename support_functor1
+        , typename support_functor2
+      >
+      inline void minkowsky_support_point(
+        transform_type const & transform_A
+        , support_functor1 const & support_function_A
+        , transform_type const & transform_B
+        , support_functor2 const & support_function_B
+        , typename transform_type::vector3_type const & s
+        , typename transform_type::vector3_type & w
+        , typename transform_type::vector3_type & w_a
+        , typename transform_type::vector3_type & w_b
+        )
+      {
+        w_a = transform_A.Q().rotate( support_function_A( conj( transform_A.Q() ).rotate(   s ) ) ) + transform_A.T();
+        w_b = transform_B.Q().rotate( support_function_B( conj( transform_B.Q() ).rotate( - s ) ) ) + transform_B.T();
+        w   = w_a - w_b;
+      }
+
+      /**
+      * Blow Up Simplex to Tetrahedron.
+      * GJK may terminate with a simplex of lower dimension when the origin lies on the
+      * boundary of the simplex (touching contact or an unlucky initial support point). This
+      * function adds support points in directions orthogonal to the current simplex until
+      * the polytope is a non-degenerate tetrahedron.
+      *
+      * @return   If the Minkowsky difference is flat such that no tetrahedron could be
+      *           found then the return value is false otherwise it is true.
+      */
+      template<
+        typename transform_type
+        , typename support_functor1
+        , typename support_functor2
+      >
+      inline bool blow_up_simplex(
+        transform_type const & transform_A
+        , support_functor1 const & support_function_A
+        , transform_type const & transform_B
+        , support_functor2 const & support_function_B
+        , typename transform_type::value_type const & tolerance
+        , EPAPolytope<typename transform_type::vector3_type> & polytope
+        )
+      {
+        using std::fabs;
+        using std::sqrt;
+
+        typedef typename transform_type::vector3_type  V;
+        typedef typename transform_type::value_type    T;
+        typedef typename transform_type::value_traits  value_traits;
+
+        V w, w_a, w_b;
+
+        std::vector<V> & W = polytope.m_w;
+
+        if( W.size() == 1u )
+        {
+          V const axes[6] = {
+            V(  value_traits::one(),  value_traits::zero(), value_traits::zero() )
+            , V( -value_traits::one(),  value_traits::zero(), value_traits::zero() )
+            , V(  value_traits::zero(),  value_traits::one(), value_traits::zero() )
+            , V(  value_traits::zero(), -value_traits::one(), value_traits::zero() )
+            , V(  value_traits::zero(),  value_traits::zero(), value_traits::one() )
+            , V(  value_traits::zero(),  value_traits::zero(), -value_traits::one() )
+          };
+          for(size_t i = 0u; i < 6u && W.size() == 1u; ++i)
+          {
+            minkowsky_support_point( transform_A, support_function_A, transform_B, support_function_B, axes[i], w, w_a, w_b );
+            if( length( w - W[0] ) > tolerance )
+              polytope.add_vertex( w, w_a, w_b );
+          }
+          if( W.size() == 1u )
+            return false;
+        }
+
+        if( W.size() == 2u )
+        {
+          V const d = W[1] - W[0];
+
+          // Pick the coordinate axis that is least aligned with the edge
+          V axis( value_traits::zero(), value_traits::zero(), value_traits::zero() );
+          size_t const k = ( fabs(d(0)) < fabs(d(1)) ) ? ( fabs(d(0)) < fabs(d(2)) ? 0u : 2u ) : ( fabs(d(1)) < fabs(d(2)) ? 1u : 2u );
+          axis(k) = value_traits::one();
+
+          V const n1 = cross( d, axis );
+          V const n2 = cross( d, n1 );
+          V const directions[4] = { n1, -n1, n2, -n2 };
+          T const len = length( d );
+          for(size_t i = 0u; i < 4u && W.size() == 2u; ++i)
+          {
+            minkowsky_support_point( transform_A, support_function_A, transform_B, support_function_B, directions[i], w, w_a, w_b );
+            // Distance from w to the line through the edge
+            if( length( cross( d, w - W[0] ) ) > tolerance*len )
+              polytope.add_vertex( w, w_a, w_b );
+          }
+          if( W.size() == 2u )
+            return false;
+        }
+
+        if( W.size() == 3u )
+        {
+          V const n   = cross( W[1] - W[0], W[2] - W[0] );
+          T const len = length( n );
+          V const directions[2] = { n, -n };
+          for(size_t i = 0u; i < 2u && W.size() == 3u; ++i)
+          {
+            minkowsky_support_point( transform_A, support_function_A, transform_B, support_function_B, directions[i], w, w_a, w_b );
+            if( fabs( dot( n, w - W[0] ) ) > tolerance*len )
+              polytope.add_vertex( w, w_a, w_b );
+          }
+          if( W.size() == 3u )
+            return false;
+        }
+
+        return polytope.init_faces();
+      }
+
+      /**
+      * Normal of a Flat Polytope.
+      * Finds a unit vector orthogonal to the vertices of a polytope that
+      * blow_up_simplex() failed to expand. The Minkowsky difference is flat,
+      * so translating along this direction separates the sets by any amount
+      * larger than zero.
+      *
+      * The plane of the polytope does not tell on which side B is, so the
+      * normal is oriented to point along the given reference direction, such
+      * as the direction from the center of A towards the center of B.
+      *
+      * @param polytope    The polytope that could not be expanded.
+      * @param direction   The reference direction from A towards B.
+      *
+      * @return            A unit normal with non-negative dot product with the reference direction.
+      */
+      template<typename V>
+      inline V flat_normal( EPAPolytope<V> const & polytope, V const & direction )
+      {
+        using std::fabs;
+
+        typedef typename V::value_traits  value_traits;
+
+        std::vector<V> const & W = polytope.m_w;
+
+        V n;
+        if( W.size() >= 3u )
+          n = cross( W[1] - W[0], W[2] - W[0] );
+
+        if( !( length( n ) > value_traits::zero() ) )
+        {
+          V d( value_traits::one(), value_traits::zero(), value_traits::zero() );
+          if( W.size() >= 2u && length( W[1] - W[0] ) > value_traits::zero() )
+            d = W[1] - W[0];
+
+          // Pick the coordinate axis that is least aligned with the edge
+          V axis( value_traits::zero(), value_traits::zero(), value_traits::zero() );
+          size_t const k = ( fabs(d(0)) < fabs(d(1)) ) ? ( fabs(d(0)) < fabs(d(2)) ? 0u : 2u ) : ( fabs(d(1)) < fabs(d(2)) ? 1u : 2u );
+          axis(k) = value_traits::one();
+          n = cross( d, axis );
+        }
+
+        n = unit( n );
+        return ( dot( n, direction ) < value_traits::zero() ) ? -n : n;
+      }
+
+      /**
+      * Compute Contact Points from Face.
+      * Projects the origin onto the plane of the given face and uses the
+      * barycentric coordinates of the projection to interpolate the support
+      * points of the two objects.
+      */
+      template<typename V>
+      inline void face_closest_points( EPAPolytope<V> const & polytope, EPAFace<V> const & face, V & p_a, V & p_b )
+      {
+        typedef typename V::value_type    T;
+        typedef typename V::value_traits  value_traits;
+
+        size_t const i = face.m_i[0];
+        size_t const j = face.m_i[1];
+        size_t const k = face.m_i[2];
+
+        V const q  = face.m_d * face.m_n;
+        V const e0 = polytope.m_w[j] - polytope.m_w[i];
+        V const e1 = polytope.m_w[k] - polytope.m_w[i];
+        V const e2 = q - polytope.m_w[i];
+
+        T const d00   = dot( e0, e0 );
+        T const d01   = dot( e0, e1 );
+        T const d11   = dot( e1, e1 );
+        T const d20   = dot( e2, e0 );
+        T const d21   = dot( e2, e1 );
+        T const denom = d00*d11 - d01*d01;
+
+        T u = value_traits::zero();
+        T v = value_traits::zero();
+        if( denom > value_traits::zero() )
+        {
+          u = (d11*d20 - d01*d21) / denom;
+          v = (d00*d21 - d01*d20) / denom;
+        }
+        T const w = value_traits::one() - u - v;
+
+        p_a = w*polytope.m_a[i] + u*polytope.m_a[j] + v*polytope.m_a[k];
+        p_b = w*polytope.m_b[i] + u*polytope.m_b[j] + v*polytope.m_b[k];
+      }
+
+    } // namespace detail
+
+    /**
+    * Compute Penetration Depth between two Convex Sets.
+    * This function first runs GJK on the two convex sets. If they are separated the
+    * closest points are returned. If they overlap the Expanding Polytope Algorithm (EPA)
+    * is used to find the penetration depth. The penetration depth is the length of the
+    * shortest translation that separates the two sets, or equivalently the distance
+    * from the origin to the boundary of the Minkowsky difference \f$A \ominus B\f$.
+    *
+    * EPA starts from the tetrahedron that GJK found to contain the origin. In each
+    * iteration the face of the polytope closest to the origin is found and the
+    * polytope is expanded by the support point in the direction of the face normal.
+    * When the support point no longer lies beyond the face, the face is on the
+    * boundary of \f$A \ominus B\f$ and the distance to the face is the penetration depth.
+    *
+    * For details on EPA we refer to
+    *
+    *   Gino van den Bergen:
+    *   Proximity Queries and Penetration Depth Computation on 3D Game Objects.
+    *   Game Developers Conference (2001).
+    *
+    * @param transform_A          A coordinate (a rigid body) transformation that is used to place first convex set.
+    * @param support_function_A   A support function describing the shape of the first convex set.
+    * @param transform_B          A coordinate (a rigid body) transformation that is used to place second convex set.
+    * @param support_function_B   A support function describing the shape of the second convex set.
+    * @param p_a                  Upon return this argument holds the deepest point of the first convex set (or the closest point if separated).
+    * @param p_b                  Upon return this argument holds the deepest point of the second convex set (or the closest point if separated).
+    * @param depth                Upon return this argument holds the signed penetration depth. It is positive
+    *                             when the sets overlap and minus the distance when they are separated.
+    * @param normal               Upon return this argument holds the unit contact normal pointing from A towards B.
+    *                             One always has p_a - p_b = depth*normal, thus translating B by depth*normal
+    *                             separates the two sets.
+    * @param iterations           Upon return this argument holds the number of EPA iterations used. If the sets
+    *                             are separated it holds the number of GJK iterations instead, and if the
+    *                             Minkowsky difference is flat it is zero.
+    * @param status               The status code of the algorithm.
+    * @param sigma                The initial GJK simplex, see compute_closest_points(). Upon return it holds the final GJK simplex.
+    * @param absolute_tolerance   Absolute tolerance used by GJK and EPA.
+    * @param relative_tolerance   Relative tolerance used by GJK and EPA.
+    * @param stagnation_tolerance Stagnation tolerance used by GJK.
+    * @param max_iterations       Maximum number of iterations used by GJK and EPA respectively.
+    *
+    * @return                     If the two sets overlap then the return value is true otherwise it is false.
+    *                             If the Minkowsky difference is flat, for instance for two overlapping coplanar
+    *                             polygons, then the sets can not overlap by a positive depth. In that case the
+    *                             status is SIMPLEX_EXPANSION_FAILED, the return value is false, the depth is zero,
+    *                             p_a and p_b are the (coinciding) GJK closest points and the normal is orthogonal
+    *                             to the Minkowsky difference. Its sign is chosen such that it points from the
+    *                             origin of A towards the origin of B, if these are in the plane of the
+    *                             Minkowsky difference the sign is arbitrary.
+    */
+    template<
+      typename transform_type
+      , typename support_functor1
+      , typename support_functor2
+      , typename simplex_solver_policy
+    >
+    inline bool compute_penetration_depth(
+      transform_type const & transform_A
+    , support_functor1 const & support_function_A
+    , transform_type const & transform_B
+    , support_functor2 const & support_function_B
+    , typename transform_type::vector3_type & p_a
+    , typename transform_type::vector3_type & p_b
+    , typename transform_type::value_type & depth
+    , typename transform_type::vector3_type & normal
+    , size_t & iterations
+    , size_t & status
+    , Simplex<typename transform_type::vector3_type> & sigma
+    , typename transform_type::value_type const & absolute_tolerance
+    , typename transform_type::value_type const & relative_tolerance
+    , typename transform_type::value_type const & stagnation_tolerance
+    , size_t const & max_iterations
+    , simplex_solver_policy const & solver_policy
+    )
+    {
+      typedef typename transform_type::vector3_type  V;
+      typedef typename transform_type::value_type    T;
+      typedef typename transform_type::value_traits  value_traits;
+      typedef          detail::EPAPolytope<V>        polytope_type;
+      typedef          detail::EPAFace<V>            face_type;
+      typedef          std::pair<size_t,size_t>      edge_type;
+
+      T distance = value_traits::infinity();
+
+      compute_closest_points(
+        transform_A
+        , support_function_A
+        , transform_B
+        , support_function_B
+        , p_a
+        , p_b
+        , distance
+        , iterations
+        , status
+        , sigma
+        , absolute_tolerance
+        , relative_tolerance
+        , stagnation_tolerance
+        , max_iterations
+        , solver_policy
+        );
+
+      if( status != INTERSECTION && distance > absolute_tolerance )
+      {
+        depth  = - distance;
+        normal = (p_b - p_a) / distance;
+        return false;
+      }
+
+      // The sets overlap (or touch), expand the GJK simplex into a polytope
+      polytope_type polytope;
+
+      int used_bit = 1;
+      for(size_t i = 0u; i < 4u; ++i)
+      {
+        if( sigma.m_bitmask & used_bit )
+          polytope.add_vertex( sigma.m_v[i], sigma.m_a[i], sigma.m_b[i] );
+        used_bit <<= 1;
+      }
+
+      depth = value_traits::zero();
+      normal.clear();
+      iterations = 0u;
+
+      if( !detail::blow_up_simplex( transform_A, support_function_A, transform_B, support_function_B, absolute_tolerance, polytope ) )
+      {
+        // The Minkowsky difference is flat, so the sets are at most touching.
+        // The GJK closest points are kept, they coincide up to the tolerance.
+        normal = detail::flat_normal( polytope, V( transform_B.T() - transform_A.T() ) );
+        status = SIMPLEX_EXPANSION_FAILED;
+        return false;
+      }
+
+      std::vector<edge_type> horizon;
+      std::vector<face_type> faces;
+
+      V w, w_a, w_b;
+
+      for(iterations = 1u; iterations <= max_iterations; ++iterations)
+      {
+        // Find the face closest to the origin
+        size_t closest = 0u;
+        for(size_t f = 1u; f < polytope.m_faces.size(); ++f)
+          if( polytope.m_faces[f].m_d < polytope.m_faces[closest].m_d )
+            closest = f;
+
+        face_type const face = polytope.m_faces[closest];
+
+        depth  = face.m_d;
+        normal = face.m_n;
+        detail::face_closest_points( polytope, face, p_a, p_b );
+
+        detail::minkowsky_support_point( transform_A, support_function_A, transform_B, support_function_B, face.m_n, w, w_a, w_b );
+
+        // Test if the face is on the boundary of the Minkowsky difference
+        T const gap = dot( face.m_n, w ) - face.m_d;
+        if( gap <= absolute_tolerance )
+        {
+          status = ABSOLUTE_CONVERGENCE;
+          return true;
+        }
+        if( gap <= relative_tolerance*face.m_d )
+        {
+          status = RELATIVE_CONVERGENCE;
+          return true;
+        }
+
+        // Remove all faces visible from w and collect the horizon edges. Faces
+        // that are (nearly) coplanar with w are removed too, otherwise w could
+        // end up on the line through a horizon edge.
+        size_t const idx = polytope.add_vertex( w, w_a, w_b );
+
+        horizon.clear();
+        faces.clear();
+        for(size_t f = 0u; f < polytope.m_faces.size(); ++f)
+        {
+          face_type const & F = polytope.m_faces[f];
+          if( dot( F.m_n, w - polytope.m_w[ F.m_i[0] ] ) < - absolute_tolerance )
+          {
+            faces.push_back( F );
+            continue;
+          }
+          for(size_t e = 0u; e < 3u; ++e)
+          {
+            edge_type const edge( F.m_i[e], F.m_i[(e+1u)%3u] );
+            edge_type const twin( edge.second, edge.first );
+
+            typename std::vector<edge_type>::iterator found = std::find( horizon.begin(), horizon.end(), twin );
+            if( found != horizon.end() )
+              horizon.erase( found );
+            else
+              horizon.push_back( edge );
+          }
+        }
+
+        // Stitch the horizon to the new vertex
+        bool degenerate = false;
+        for(size_t e = 0u; e < horizon.size(); ++e)
+        {
+          face_type F;
+          if( !polytope.make_face( horizon[e].first, horizon[e].second, idx, F ) )
+          {
+            degenerate = true;
+            break;
+          }
+          faces.push_back( F );
+        }
+        if( degenerate )
+        {
+          // Numerical precision does not allow us to get any closer
+          status = STAGNATION;
+          return true;
+        }
+
+        polytope.m_faces.swap( faces );
+      }
+
+      status = EXCEEDED_MAX_ITERATIONS_LIMIT;
+      return true;
+    }
+
+    /**
+    * Compute Penetration Depth between two Convex Sets using a Per Pair Cache.
+    * The GJK stage is warm-started from the simplex stored in the cache and
+    * upon return the final GJK simplex is stored in the cache.
+    *
+    * See the version above for details on the remaining arguments.
+    */
+    template<
+      typename transform_type
+      , typename support_functor1
+      , typename support_functor2
+      , typename simplex_solver_policy
+    >
+    inline bool compute_penetration_depth(
+      transform_type const & transform_A
+    , support_functor1 const & support_function_A
+    , transform_type const & transform_B
+    , support_functor2 const & support_function_B
+    , typename transform_type::vector3_type & p_a
+    , typename transform_type::vector3_type & p_b
+    , typename transform_type::value_type & depth
+    , typename transform_type::vector3_type & normal
+    , size_t & iterations
+    , size_t & status
+    , Cache<typename transform_type::vector3_type> & cache
+    , typename transform_type::value_type const & absolute_tolerance
+    , typename transform_type::value_type const & relative_tolerance
+    , typename transform_type::value_type const & stagnation_tolerance
+    , size_t const & max_iterations
+    , simplex_solver_policy const & solver_policy
+    )
+    {
+      Simplex<typename transform_type::vector3_type> sigma;
+
+      load_simplex( cache, transform_A, transform_B, sigma );
+
+      bool const overlap = compute_penetration_depth(
+        transform_A
+        , support_function_A
+        , transform_B
+        , support_function_B
+        , p_a
+        , p_b
+        , depth
+        , normal
+        , iterations
+        , status
+        , sigma
+        , absolute_tolerance
+        , relative_tolerance
+        , stagnation_tolerance
+        , max_iterations
+        , solver_policy
+        );
+
+      store_simplex( sigma, transform_A, transform_B, cache );
+
+      return overlap;
+    }
+
+    /**
+    * Lazy Man's Version.
+    * This function uses presets for parameters that control the algorithm.
+    */
+    template<
+      typename transform_type
+      , typename support_functor1
+      , typename support_functor2
+    >
+    inline bool compute_penetration_depth(
+      transform_type const & transform_A
+    , support_functor1 const & A
+    , transform_type const & transform_B
+    , support_functor2 const & B
+    , typename transform_type::vector3_type & p_a
+    , typename transform_type::vector3_type & p_b
+    , typename transform_type::value_type & depth
+    , typename transform_type::vector3_type & normal
+    , size_t & status
+    )
+    {
+      typedef typename transform_type::value_type  T;
+
+      OpenTissue::gjk::VoronoiSimplexSolverPolicy const simplex_solver_policy  = OpenTissue::gjk::VoronoiSimplexSolverPolicy();
+
+      Simplex<typename transform_type::vector3_type> sigma;
+
+      size_t       iterations           = 0u;
+      size_t const max_iterations       = 100u;
+      T      const absolute_tolerance   = boost::numeric_cast<T>(10e-6);
+      T      const relative_tolerance   = boost::numeric_cast<T>(10e-10);
+      T      const stagnation_tolerance = boost::numeric_cast<T>(10e-16);
+
+      return compute_penetration_depth(
+        transform_A
+        , A
+        , transform_B
+        , B
+        , p_a
+        , p_b
+        , depth
+        , normal
+        , iterations
+        , status
+        , sigma
+        , absolute_tolerance
+        , relative_tolerance
+        , stagnation_tolerance
+        , max_iterations
+        , simplex_solver_policy
+        );
+    }
+
+  } // namespace gjk
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_GJK_GJK_COMPUTE_PENETRATION_DEPTH_H
+#endif
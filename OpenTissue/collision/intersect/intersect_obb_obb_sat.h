@@ -9,6 +9,10 @@
 //
 #include <OpenTissue/configuration.h>
 
+#include <OpenTissue/core/math/math_precision.h>
+
+#include <cmath>
+
 namespace OpenTissue
 {
   namespace intersect
@@ -61,9 +65,9 @@ namespace OpenTissue
       real_type Q22 = fabs(R_ba(2,2))+threshold;
 
 #define TST(expr1,expr2) if (fabs(expr1) - (expr2) > 0) return true; 
-      TST(  p_ba(0),                                                     a(0) + b(0)*Q00 + b(1)*Q10 + b(2)*Q20    );
-      TST(  p_ba(1),                                                     a(1) + b(0)*Q01 + b(1)*Q11 + b(2)*Q21    );
-      TST(  p_ba(2),                                                     a(2) + b(0)*Q02 + b(1)*Q12 + b(2)*Q22    );
+      TST(  p_ba(0),                                                     a(0) + b(0)*Q00 + b(1)*Q01 + b(2)*Q02    );
+      TST(  p_ba(1),                                                     a(1) + b(0)*Q10 + b(1)*Q11 + b(2)*Q12    );
+      TST(  p_ba(2),                                                     a(2) + b(0)*Q20 + b(1)*Q21 + b(2)*Q22    );
       TST(  p_ba(0)*R_ba(0,0) + p_ba(1)*R_ba(1,0) + p_ba(2)*R_ba(2,0),   b(0) + a(0)*Q00 + a(1)*Q10 + a(2)*Q20    );
       TST(  p_ba(0)*R_ba(0,1) + p_ba(1)*R_ba(1,1) + p_ba(2)*R_ba(2,1),   b(1) + a(0)*Q01 + a(1)*Q11 + a(2)*Q21    );
       TST(  p_ba(0)*R_ba(0,2) + p_ba(1)*R_ba(1,2) + p_ba(2)*R_ba(2,2),   b(2) + a(0)*Q02 + a(1)*Q12 + a(2)*Q22    );
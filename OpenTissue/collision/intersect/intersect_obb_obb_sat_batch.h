@@ -0,0 +1,287 @@
+#ifndef OPENTISSUE_COLLISION_INTERSECT_INTERSECT_OBB_OBB_SAT_BATCH_H
+#define OPENTISSUE_COLLISION_INTERSECT_INTERSECT_OBB_OBB_SAT_BATCH_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_precision.h>
+#include <OpenTissue/utility/utility_openmp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace intersect
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Number of OBB pairs processed together by the batched separating axis test.
+      * Each OBB pair occupies one lane, see triangle_triangle_batch_width.
+      */
+      enum { obb_obb_batch_width = 8 };
+
+      /**
+      * OBB Separating Axis Test for a Block of OBB Pairs.
+      * This is the same test as obb_obb_sat(), written such that every OBB
+      * pair occupies one lane and all fifteen axes are evaluated without
+      * branching.
+      *
+      * Besides the separation flag the largest gap between the projections
+      * of the boxes onto any of the axes is computed. The gap is measured
+      * along unit length axes, so a positive gap is a lower bound of the
+      * distance between the two boxes. Edge-edge axes of nearly parallel
+      * edges are too ill-conditioned to be normalized, and are not used for
+      * the gap.
+      *
+      * @param R          Orientation of box B in the local frame of box A, R[i][j][l] is the (i,j) entry in lane l.
+      * @param p          Center of box B in the local frame of box A.
+      * @param a          Half extents of box A.
+      * @param b          Half extents of box B.
+      * @param separated  Upon return the l'th value is non-zero if a separating axis was found in lane l.
+      * @param gap        Upon return holds the largest gap of lane l, it is
+      *                   positive if and only if the boxes were separated by a
+      *                   face axis or a well-conditioned edge-edge axis.
+      */
+      template<typename real_type>
+      inline void obb_obb_sat_block(
+        real_type const (&R)[3][3][obb_obb_batch_width]
+        , real_type const (&p)[3][obb_obb_batch_width]
+        , real_type const (&a)[3][obb_obb_batch_width]
+        , real_type const (&b)[3][obb_obb_batch_width]
+        , int (&separated)[obb_obb_batch_width]
+        , real_type (&gap)[obb_obb_batch_width]
+        )
+      {
+        using std::fabs;
+        using std::sqrt;
+        using std::max;
+
+        int const W = obb_obb_batch_width;
+        real_type const threshold = math::working_precision<real_type>();
+        real_type const parallel  = real_type(1e-6);
+
+        for(int l = 0; l < W; ++l)
+        {
+          real_type Q[3][3];
+          real_type N[3][3];      //--- Inverse lengths of the edge-edge axes, zero if ill-conditioned
+          for(int i = 0; i < 3; ++i)
+            for(int j = 0; j < 3; ++j)
+            {
+              Q[i][j] = fabs( R[i][j][l] ) + threshold;
+              real_type const sin2 = real_type(1) - R[i][j][l]*R[i][j][l];
+              N[i][j] = sin2 > parallel ? real_type(1) / sqrt( sin2 ) : real_type(0);
+            }
+
+          real_type const p0 = p[0][l];
+          real_type const p1 = p[1][l];
+          real_type const p2 = p[2][l];
+          real_type const a0 = a[0][l];
+          real_type const a1 = a[1][l];
+          real_type const a2 = a[2][l];
+          real_type const b0 = b[0][l];
+          real_type const b1 = b[1][l];
+          real_type const b2 = b[2][l];
+
+          real_type const d[15] = {
+            //--- Face axes of A
+            fabs( p0 ) - ( a0 + b0*Q[0][0] + b1*Q[0][1] + b2*Q[0][2] )
+            , fabs( p1 ) - ( a1 + b0*Q[1][0] + b1*Q[1][1] + b2*Q[1][2] )
+            , fabs( p2 ) - ( a2 + b0*Q[2][0] + b1*Q[2][1] + b2*Q[2][2] )
+            //--- Face axes of B
+            , fabs( p0*R[0][0][l] + p1*R[1][0][l] + p2*R[2][0][l] ) - ( b0 + a0*Q[0][0] + a1*Q[1][0] + a2*Q[2][0] )
+            , fabs( p0*R[0][1][l] + p1*R[1][1][l] + p2*R[2][1][l] ) - ( b1 + a0*Q[0][1] + a1*Q[1][1] + a2*Q[2][1] )
+            , fabs( p0*R[0][2][l] + p1*R[1][2][l] + p2*R[2][2][l] ) - ( b2 + a0*Q[0][2] + a1*Q[1][2] + a2*Q[2][2] )
+            //--- Edge-edge axes, A_i x B_j
+            , fabs( p2*R[1][0][l] - p1*R[2][0][l] ) - ( a1*Q[2][0] + a2*Q[1][0] + b1*Q[0][2] + b2*Q[0][1] )
+            , fabs( p2*R[1][1][l] - p1*R[2][1][l] ) - ( a1*Q[2][1] + a2*Q[1][1] + b2*Q[0][0] + b0*Q[0][2] )
+            , fabs( p2*R[1][2][l] - p1*R[2][2][l] ) - ( a1*Q[2][2] + a2*Q[1][2] + b0*Q[0][1] + b1*Q[0][0] )
+            , fabs( p0*R[2][0][l] - p2*R[0][0][l] ) - ( a2*Q[0][0] + a0*Q[2][0] + b1*Q[1][2] + b2*Q[1][1] )
+            , fabs( p0*R[2][1][l] - p2*R[0][1][l] ) - ( a2*Q[0][1] + a0*Q[2][1] + b2*Q[1][0] + b0*Q[1][2] )
+            , fabs( p0*R[2][2][l] - p2*R[0][2][l] ) - ( a2*Q[0][2] + a0*Q[2][2] + b0*Q[1][1] + b1*Q[1][0] )
+            , fabs( p1*R[0][0][l] - p0*R[1][0][l] ) - ( a0*Q[1][0] + a1*Q[0][0] + b1*Q[2][2] + b2*Q[2][1] )
+            , fabs( p1*R[0][1][l] - p0*R[1][1][l] ) - ( a0*Q[1][1] + a1*Q[0][1] + b2*Q[2][0] + b0*Q[2][2] )
+            , fabs( p1*R[0][2][l] - p0*R[1][2][l] ) - ( a0*Q[1][2] + a1*Q[0][2] + b0*Q[2][1] + b1*Q[2][0] )
+          };
+
+          int s = 0;
+          real_type g = d[0];
+          for(int k = 0; k < 15; ++k)
+            s |= d[k] > real_type(0);
+          for(int k = 1; k < 6; ++k)
+            g = max( g, d[k] );
+          for(int i = 0; i < 3; ++i)
+            for(int j = 0; j < 3; ++j)
+              g = max( g, d[6 + 3*i + j]*N[i][j] );
+          separated[l] = s;
+          gap[l]       = g;
+        }
+      }
+
+      /**
+      * Relative Placement for a Block of OBB Pairs.
+      * Box A is given in model frame A and box B in model frame B. The model
+      * transform of A into B is applied to box A, after which box A is
+      * expressed in the local frame of box B.
+      *
+      * @param M          Rotation of the model transform, M[i][j] is the (i,j) entry.
+      * @param t          Translation of the model transform.
+      * @param RA         Orientations of the A boxes, RA[i][j][l] is the (i,j) entry in lane l.
+      * @param cA         Centers of the A boxes.
+      * @param RB         Orientations of the B boxes.
+      * @param cB         Centers of the B boxes.
+      * @param R          Upon return holds the orientations of the A boxes in the local frames of the B boxes.
+      * @param p          Upon return holds the centers of the A boxes in the local frames of the B boxes.
+      */
+      template<typename real_type>
+      inline void obb_obb_relative_block(
+        real_type const (&M)[3][3]
+        , real_type const (&t)[3]
+        , real_type const (&RA)[3][3][obb_obb_batch_width]
+        , real_type const (&cA)[3][obb_obb_batch_width]
+        , real_type const (&RB)[3][3][obb_obb_batch_width]
+        , real_type const (&cB)[3][obb_obb_batch_width]
+        , real_type (&R)[3][3][obb_obb_batch_width]
+        , real_type (&p)[3][obb_obb_batch_width]
+        )
+      {
+        int const W = obb_obb_batch_width;
+
+        for(int l = 0; l < W; ++l)
+        {
+          real_type MR[3][3];
+          real_type d[3];
+          for(int i = 0; i < 3; ++i)
+          {
+            for(int j = 0; j < 3; ++j)
+              MR[i][j] = M[i][0]*RA[0][j][l] + M[i][1]*RA[1][j][l] + M[i][2]*RA[2][j][l];
+            d[i] = M[i][0]*cA[0][l] + M[i][1]*cA[1][l] + M[i][2]*cA[2][l] + t[i] - cB[i][l];
+          }
+          //--- Multiply by the transpose of the orientation of box B
+          for(int i = 0; i < 3; ++i)
+          {
+            for(int j = 0; j < 3; ++j)
+              R[i][j][l] = RB[0][i][l]*MR[0][j] + RB[1][i][l]*MR[1][j] + RB[2][i][l]*MR[2][j];
+            p[i][l] = RB[0][i][l]*d[0] + RB[1][i][l]*d[1] + RB[2][i][l]*d[2];
+          }
+        }
+      }
+
+    } // namespace detail
+
+    /**
+    * Batched OBB Separating Axis Test.
+    * Tests many pairs of boxes that live in two different model frames, as
+    * happens when two OBB trees are traversed. Blocks of box pairs are loaded
+    * into lanes, see detail::obb_obb_batch_width, and blocks are processed in
+    * parallel if OpenMP is enabled.
+    *
+    * Unlike the scalar obb_obb_sat() no box needs to be transformed up front,
+    * the model transform and the placement of both boxes are accounted for
+    * when the lanes are loaded.
+    *
+    * @param A2B        The model transform, brings model frame A into model frame B.
+    * @param count      The number of box pairs.
+    * @param A          Array of pointers to the boxes of model A.
+    * @param B          Array of pointers to the boxes of model B.
+    * @param separated  Array of flags, upon return the i'th flag is true if a
+    *                   separating axis was found for the i'th box pair.
+    * @param gap        Array of gaps, one per box pair, can be null. Upon return
+    *                   a positive gap is a lower bound of the distance between the
+    *                   two boxes, see detail::obb_obb_sat_block().
+    */
+    template<typename coordsys_type, typename obb_type, typename flag_type>
+    inline void obb_obb_sat_batch(
+      coordsys_type const & A2B
+      , size_t count
+      , obb_type const * const * A
+      , obb_type const * const * B
+      , flag_type * separated
+      , typename obb_type::real_type * gap = 0
+      )
+    {
+      typedef typename obb_type::real_type        real_type;
+      typedef typename obb_type::matrix3x3_type   matrix3x3_type;
+
+      assert(separated);
+
+      if(count == 0)
+        return;
+
+      int const W = detail::obb_obb_batch_width;
+      int const blocks = static_cast<int>( (count + W - 1) / W );
+
+      matrix3x3_type const Q( A2B.Q() );
+      real_type M[3][3];
+      real_type t[3];
+      for(int i = 0; i < 3; ++i)
+      {
+        for(int j = 0; j < 3; ++j)
+          M[i][j] = Q(i,j);
+        t[i] = A2B.T()(i);
+      }
+
+#pragma omp parallel for schedule(dynamic,16) if(blocks > 16)
+      for(int block = 0; block < blocks; ++block)
+      {
+        real_type RA[3][3][W];
+        real_type RB[3][3][W];
+        real_type cA[3][W];
+        real_type cB[3][W];
+        real_type a[3][W];
+        real_type b[3][W];
+        real_type R[3][3][W];
+        real_type p[3][W];
+        real_type g[W];
+        int       hit[W];
+
+        size_t const first = static_cast<size_t>(block)*W;
+
+        //--- Transpose box data into lanes, unused lanes of the last block replicate the last box pair.
+        for(int l = 0; l < W; ++l)
+        {
+          size_t const k = std::min( first + l, count - 1 );
+          obb_type const & boxA = *A[k];
+          obb_type const & boxB = *B[k];
+          for(int i = 0; i < 3; ++i)
+          {
+            for(int j = 0; j < 3; ++j)
+            {
+              RA[i][j][l] = boxA.orientation()(i,j);
+              RB[i][j][l] = boxB.orientation()(i,j);
+            }
+            cA[i][l] = boxA.center()(i);
+            cB[i][l] = boxB.center()(i);
+            a[i][l]  = boxA.eps()(i);
+            b[i][l]  = boxB.eps()(i);
+          }
+        }
+
+        //--- Box B is the reference box, so box A takes the place of BinA of obb_obb_sat()
+        detail::obb_obb_relative_block( M, t, RA, cA, RB, cB, R, p );
+        detail::obb_obb_sat_block( R, p, b, a, hit, g );
+
+        for(int l = 0; l < W && first + l < count; ++l)
+        {
+          separated[first + l] = ( hit[l] != 0 );
+          if(gap)
+            gap[first + l] = g[l];
+        }
+      }
+    }
+
+  } //End of namespace intersect
+
+} //End of namespace OpenTissue
+
+// OPENTISSUE_COLLISION_INTERSECT_INTERSECT_OBB_OBB_SAT_BATCH_H
+#endif
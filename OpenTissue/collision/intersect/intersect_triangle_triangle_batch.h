@@ -0,0 +1,569 @@
+#ifndef OPENTISSUE_COLLISION_INTERSECT_INTERSECT_TRIANGLE_TRIANGLE_BATCH_H
+#define OPENTISSUE_COLLISION_INTERSECT_INTERSECT_TRIANGLE_TRIANGLE_BATCH_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_precision.h>
+#include <OpenTissue/utility/utility_openmp.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace intersect
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Number of triangle pairs processed together by the batched triangle test.
+      * Each triangle pair occupies one lane and all lanes are processed by the
+      * same branch-free instructions, such that the compiler can map the lanes
+      * onto SIMD registers (4 lanes of SSE or 8 lanes of AVX in single precision).
+      */
+      enum { triangle_triangle_batch_width = 8 };
+
+      /**
+      * Interval of a Triangle on the Intersection Line.
+      * Computes the interval where a triangle crosses the plane of the other
+      * triangle, projected onto the direction of the intersection line. The
+      * candidates are the vertices lying in the plane and the crossing points
+      * of the edges whose end points lie on opposite sides of the plane.
+      *
+      * @param V        Triangle vertices, V[i][k][l] is the k'th coordinate of the i'th vertex in lane l.
+      * @param dist     Signed distances of the vertices to the plane of the other triangle.
+      * @param D        Direction of the intersection line.
+      * @param lo       Upon return holds the lower end of the interval.
+      * @param hi       Upon return holds the upper end of the interval.
+      * @param p_lo     Upon return holds the point of the triangle at the lower end.
+      * @param p_hi     Upon return holds the point of the triangle at the upper end.
+      */
+      template<typename real_type>
+      inline void triangle_line_interval_block(
+        real_type const (&V)[3][3][triangle_triangle_batch_width]
+        , real_type const (&dist)[3][triangle_triangle_batch_width]
+        , real_type const (&D)[3][triangle_triangle_batch_width]
+        , real_type (&lo)[triangle_triangle_batch_width]
+        , real_type (&hi)[triangle_triangle_batch_width]
+        , real_type (&p_lo)[3][triangle_triangle_batch_width]
+        , real_type (&p_hi)[3][triangle_triangle_batch_width]
+        )
+      {
+        int const W = triangle_triangle_batch_width;
+        real_type const huge = std::numeric_limits<real_type>::max();
+
+        for(int l = 0; l < W; ++l)
+        {
+          lo[l] =  huge;
+          hi[l] = -huge;
+        }
+        for(int k = 0; k < 3; ++k)
+          for(int l = 0; l < W; ++l)
+          {
+            p_lo[k][l] = real_type(0);
+            p_hi[k][l] = real_type(0);
+          }
+
+        //--- Vertices lying in the plane
+        for(int i = 0; i < 3; ++i)
+          for(int l = 0; l < W; ++l)
+          {
+            bool const valid = ( dist[i][l] == real_type(0) );
+            real_type const s = V[i][0][l]*D[0][l] + V[i][1][l]*D[1][l] + V[i][2][l]*D[2][l];
+            bool const is_lo = valid && s < lo[l];
+            bool const is_hi = valid && s > hi[l];
+            lo[l] = is_lo ? s : lo[l];
+            hi[l] = is_hi ? s : hi[l];
+            for(int k = 0; k < 3; ++k)
+            {
+              p_lo[k][l] = is_lo ? V[i][k][l] : p_lo[k][l];
+              p_hi[k][l] = is_hi ? V[i][k][l] : p_hi[k][l];
+            }
+          }
+
+        //--- Edges crossing the plane
+        for(int i = 0; i < 3; ++i)
+        {
+          int const j = (i+1)%3;
+          for(int l = 0; l < W; ++l)
+          {
+            bool const valid = ( dist[i][l]*dist[j][l] < real_type(0) );
+            real_type const den = dist[i][l] - dist[j][l];
+            real_type const t   = valid ? dist[i][l] / den : real_type(0);
+            real_type p[3];
+            for(int k = 0; k < 3; ++k)
+              p[k] = V[i][k][l] + t*(V[j][k][l] - V[i][k][l]);
+            real_type const s = p[0]*D[0][l] + p[1]*D[1][l] + p[2]*D[2][l];
+            bool const is_lo = valid && s < lo[l];
+            bool const is_hi = valid && s > hi[l];
+            lo[l] = is_lo ? s : lo[l];
+            hi[l] = is_hi ? s : hi[l];
+            for(int k = 0; k < 3; ++k)
+            {
+              p_lo[k][l] = is_lo ? p[k] : p_lo[k][l];
+              p_hi[k][l] = is_hi ? p[k] : p_hi[k][l];
+            }
+          }
+        }
+      }
+
+      /**
+      * Triangle Triangle Interval Overlap Test for a Block of Triangle Pairs.
+      * This is the interval overlap method of Moller, written such that every
+      * triangle pair occupies one lane. The triangle data must be given in
+      * structure-of-arrays layout.
+      *
+      * Distances of vertices to the plane of the other triangle are snapped to
+      * zero when they are within a tolerance relative to the size of the
+      * triangle. Pairs where all vertices of one triangle end up in the plane
+      * of the other are flagged as coplanar, they must be decided by
+      * coplanar_triangle_triangle(). Degenerate triangles never overlap.
+      *
+      * @param A          Vertices of triangle A, A[i][k][l] is the k'th coordinate of the i'th vertex in lane l.
+      * @param B          Vertices of triangle B, same layout as A.
+      * @param overlap    Upon return the l'th value is non-zero if the triangles in lane l intersect.
+      * @param coplanar   Upon return the l'th value is non-zero if the triangles in lane l are coplanar.
+      * @param p          Upon return holds the first end point of the intersection segment of overlapping non-coplanar lanes.
+      * @param q          Upon return holds the second end point of the intersection segment.
+      */
+      template<typename real_type>
+      inline void triangle_triangle_block(
+        real_type const (&A)[3][3][triangle_triangle_batch_width]
+        , real_type const (&B)[3][3][triangle_triangle_batch_width]
+        , int (&overlap)[triangle_triangle_batch_width]
+        , int (&coplanar)[triangle_triangle_batch_width]
+        , real_type (&p)[3][triangle_triangle_batch_width]
+        , real_type (&q)[3][triangle_triangle_batch_width]
+        )
+      {
+        using std::fabs;
+        using std::sqrt;
+
+        int const W = triangle_triangle_batch_width;
+        real_type const epsilon = OpenTissue::math::working_precision<real_type>(100u);
+
+        real_type N1[3][W];
+        real_type N2[3][W];
+        real_type D[3][W];
+        real_type du[3][W];      //--- Distances of B's vertices to the plane of A (scaled by |N1|)
+        real_type dv[3][W];      //--- Distances of A's vertices to the plane of B (scaled by |N2|)
+        int       rejected[W];
+
+        for(int l = 0; l < W; ++l)
+        {
+          real_type const e1[3] = { A[1][0][l] - A[0][0][l], A[1][1][l] - A[0][1][l], A[1][2][l] - A[0][2][l] };
+          real_type const e2[3] = { A[2][0][l] - A[0][0][l], A[2][1][l] - A[0][1][l], A[2][2][l] - A[0][2][l] };
+          real_type const f1[3] = { B[1][0][l] - B[0][0][l], B[1][1][l] - B[0][1][l], B[1][2][l] - B[0][2][l] };
+          real_type const f2[3] = { B[2][0][l] - B[0][0][l], B[2][1][l] - B[0][1][l], B[2][2][l] - B[0][2][l] };
+
+          N1[0][l] = e1[1]*e2[2] - e1[2]*e2[1];
+          N1[1][l] = e1[2]*e2[0] - e1[0]*e2[2];
+          N1[2][l] = e1[0]*e2[1] - e1[1]*e2[0];
+          N2[0][l] = f1[1]*f2[2] - f1[2]*f2[1];
+          N2[1][l] = f1[2]*f2[0] - f1[0]*f2[2];
+          N2[2][l] = f1[0]*f2[1] - f1[1]*f2[0];
+
+          //--- Tolerances are relative to the length of the longest edge
+          real_type const len_a = sqrt( std::max( std::max( e1[0]*e1[0] + e1[1]*e1[1] + e1[2]*e1[2], e2[0]*e2[0] + e2[1]*e2[1] + e2[2]*e2[2] ), f1[0]*f1[0] + f1[1]*f1[1] + f1[2]*f1[2] ) );
+          real_type const len   = std::max( len_a, sqrt( f2[0]*f2[0] + f2[1]*f2[1] + f2[2]*f2[2] ) );
+          real_type const n1    = sqrt( N1[0][l]*N1[0][l] + N1[1][l]*N1[1][l] + N1[2][l]*N1[2][l] );
+          real_type const n2    = sqrt( N2[0][l]*N2[0][l] + N2[1][l]*N2[1][l] + N2[2][l]*N2[2][l] );
+          real_type const tol1  = epsilon*len*n1;
+          real_type const tol2  = epsilon*len*n2;
+
+          real_type const w1 = N1[0][l]*A[0][0][l] + N1[1][l]*A[0][1][l] + N1[2][l]*A[0][2][l];
+          real_type const w2 = N2[0][l]*B[0][0][l] + N2[1][l]*B[0][1][l] + N2[2][l]*B[0][2][l];
+          for(int i = 0; i < 3; ++i)
+          {
+            real_type const a = N1[0][l]*B[i][0][l] + N1[1][l]*B[i][1][l] + N1[2][l]*B[i][2][l] - w1;
+            real_type const b = N2[0][l]*A[i][0][l] + N2[1][l]*A[i][1][l] + N2[2][l]*A[i][2][l] - w2;
+            du[i][l] = fabs(a) <= tol1 ? real_type(0) : a;
+            dv[i][l] = fabs(b) <= tol2 ? real_type(0) : b;
+          }
+
+          int const degenerate = ( n1 == real_type(0) ) | ( n2 == real_type(0) );
+          int const b_on_one_side = ( du[0][l]*du[1][l] > real_type(0) ) & ( du[0][l]*du[2][l] > real_type(0) );
+          int const a_on_one_side = ( dv[0][l]*dv[1][l] > real_type(0) ) & ( dv[0][l]*dv[2][l] > real_type(0) );
+          int const in_plane      = ( du[0][l] == real_type(0) ) & ( du[1][l] == real_type(0) ) & ( du[2][l] == real_type(0) );
+
+          rejected[l] = degenerate | b_on_one_side | a_on_one_side;
+          coplanar[l] = (!rejected[l]) & in_plane;
+
+          D[0][l] = N1[1][l]*N2[2][l] - N1[2][l]*N2[1][l];
+          D[1][l] = N1[2][l]*N2[0][l] - N1[0][l]*N2[2][l];
+          D[2][l] = N1[0][l]*N2[1][l] - N1[1][l]*N2[0][l];
+        }
+
+        real_type lo_a[W];
+        real_type hi_a[W];
+        real_type lo_b[W];
+        real_type hi_b[W];
+        real_type p_lo_a[3][W];
+        real_type p_hi_a[3][W];
+        real_type p_lo_b[3][W];
+        real_type p_hi_b[3][W];
+
+        triangle_line_interval_block( A, dv, D, lo_a, hi_a, p_lo_a, p_hi_a );
+        triangle_line_interval_block( B, du, D, lo_b, hi_b, p_lo_b, p_hi_b );
+
+        for(int l = 0; l < W; ++l)
+        {
+          overlap[l] = (!rejected[l]) & (!coplanar[l]) & ( lo_a[l] <= hi_b[l] ) & ( lo_b[l] <= hi_a[l] );
+
+          //--- The intersection segment is the overlap of the two intervals
+          bool const start_on_a = lo_a[l] >= lo_b[l];
+          bool const end_on_a   = hi_a[l] <= hi_b[l];
+          for(int k = 0; k < 3; ++k)
+          {
+            p[k][l] = start_on_a ? p_lo_a[k][l] : p_lo_b[k][l];
+            q[k][l] = end_on_a   ? p_hi_a[k][l] : p_hi_b[k][l];
+          }
+        }
+      }
+
+      /**
+      * Coplanar Triangle Triangle Test.
+      * The triangles are projected onto the coordinate plane most parallel to
+      * the common plane, and a separating axis test is done on the six edge
+      * normals in that plane. Touching triangles are reported as overlapping.
+      *
+      * @return    If the triangles overlap then the return value is true otherwise it is false.
+      */
+      template<typename real_type>
+      inline bool coplanar_triangle_triangle(
+        real_type const (&a)[3][3]
+        , real_type const (&b)[3][3]
+        )
+      {
+        using std::fabs;
+
+        real_type const e1[3] = { a[1][0] - a[0][0], a[1][1] - a[0][1], a[1][2] - a[0][2] };
+        real_type const e2[3] = { a[2][0] - a[0][0], a[2][1] - a[0][1], a[2][2] - a[0][2] };
+        real_type const n[3]  = {
+          fabs( e1[1]*e2[2] - e1[2]*e2[1] )
+          , fabs( e1[2]*e2[0] - e1[0]*e2[2] )
+          , fabs( e1[0]*e2[1] - e1[1]*e2[0] )
+        };
+
+        //--- Drop the dominant axis of the normal
+        int i0 = 1;
+        int i1 = 2;
+        if(n[1] >= n[0] && n[1] >= n[2])
+        {
+          i0 = 0;
+          i1 = 2;
+        }
+        else if(n[2] >= n[0] && n[2] >= n[1])
+        {
+          i0 = 0;
+          i1 = 1;
+        }
+
+        real_type const (*tri[2])[3] = { a, b };
+        for(int t = 0; t < 2; ++t)
+        {
+          for(int i = 0; i < 3; ++i)
+          {
+            int const j = (i+1)%3;
+            //--- In-plane normal of the edge from vertex i to vertex j
+            real_type const nx =   tri[t][j][i1] - tri[t][i][i1];
+            real_type const ny = -(tri[t][j][i0] - tri[t][i][i0]);
+
+            real_type min_a = std::numeric_limits<real_type>::max();
+            real_type max_a = -min_a;
+            real_type min_b = min_a;
+            real_type max_b = -min_a;
+            for(int k = 0; k < 3; ++k)
+            {
+              real_type const s_a = nx*a[k][i0] + ny*a[k][i1];
+              real_type const s_b = nx*b[k][i0] + ny*b[k][i1];
+              min_a = std::min( min_a, s_a );
+              max_a = std::max( max_a, s_a );
+              min_b = std::min( min_b, s_b );
+              max_b = std::max( max_b, s_b );
+            }
+            if(max_a < min_b || max_b < min_a)
+              return false;
+          }
+        }
+        return true;
+      }
+
+      /**
+      * Batched Triangle Triangle Test.
+      * Loads blocks of triangle pairs into lanes, runs the block test and writes
+      * back the results. Blocks are processed in parallel if OpenMP is enabled.
+      *
+      * @param count      The number of triangle pairs.
+      * @param fetch      A functor, fetch(i, a0, a1, a2, b0, b1, b2), that retrieves the vertices of the i'th triangle pair.
+      * @param overlap    Array of overlap flags, one per triangle pair.
+      * @param coplanar   Array of coplanar flags, one per triangle pair, can be null.
+      * @param p          Array of first end points of the intersection segments, one per triangle pair, can be null.
+      * @param q          Array of second end points of the intersection segments, one per triangle pair, can be null.
+      */
+      template<typename vector3_type, typename fetch_functor, typename flag_type>
+      inline void triangle_triangle_batch(
+        size_t count
+        , fetch_functor const & fetch
+        , flag_type * overlap
+        , flag_type * coplanar
+        , vector3_type * p
+        , vector3_type * q
+        )
+      {
+        typedef typename vector3_type::value_type real_type;
+
+        assert(overlap);
+
+        if(count == 0)
+          return;
+
+        int const W = triangle_triangle_batch_width;
+        int const blocks = static_cast<int>( (count + W - 1) / W );
+
+#pragma omp parallel for schedule(dynamic,16) if(blocks > 16)
+        for(int block = 0; block < blocks; ++block)
+        {
+          real_type A[3][3][W];
+          real_type B[3][3][W];
+          real_type P[3][W];
+          real_type Q[3][W];
+          int       hit[W];
+          int       flat[W];
+
+          size_t const first = static_cast<size_t>(block)*W;
+
+          //--- Transpose triangle data into lanes, unused lanes of the last block replicate the last triangle pair.
+          for(int l = 0; l < W; ++l)
+          {
+            size_t const k = std::min( first + l, count - 1 );
+            vector3_type v[6];
+            fetch( k, v[0], v[1], v[2], v[3], v[4], v[5] );
+            for(int i = 0; i < 3; ++i)
+              for(int c = 0; c < 3; ++c)
+              {
+                A[i][c][l] = v[i](c);
+                B[i][c][l] = v[i+3](c);
+              }
+          }
+
+          triangle_triangle_block( A, B, hit, flat, P, Q );
+
+          for(int l = 0; l < W && first + l < count; ++l)
+          {
+            size_t const k = first + l;
+            if(flat[l])
+            {
+              real_type a[3][3];
+              real_type b[3][3];
+              for(int i = 0; i < 3; ++i)
+                for(int c = 0; c < 3; ++c)
+                {
+                  a[i][c] = A[i][c][l];
+                  b[i][c] = B[i][c][l];
+                }
+              hit[l] = coplanar_triangle_triangle( a, b );
+            }
+            overlap[k] = ( hit[l] != 0 );
+            if(coplanar)
+              coplanar[k] = ( flat[l] != 0 );
+            if(p)
+              p[k] = vector3_type( P[0][l], P[1][l], P[2][l] );
+            if(q)
+              q[k] = vector3_type( Q[0][l], Q[1][l], Q[2][l] );
+          }
+        }
+      }
+
+      template<typename vector3_type>
+      class TriangleArrayFetch
+      {
+      public:
+
+        vector3_type const * m_a0;
+        vector3_type const * m_a1;
+        vector3_type const * m_a2;
+        vector3_type const * m_b0;
+        vector3_type const * m_b1;
+        vector3_type const * m_b2;
+
+        TriangleArrayFetch(
+          vector3_type const * a0, vector3_type const * a1, vector3_type const * a2
+          , vector3_type const * b0, vector3_type const * b1, vector3_type const * b2
+          )
+          : m_a0(a0), m_a1(a1), m_a2(a2), m_b0(b0), m_b1(b1), m_b2(b2)
+        {}
+
+        void operator()(size_t i, vector3_type & a0, vector3_type & a1, vector3_type & a2, vector3_type & b0, vector3_type & b1, vector3_type & b2) const
+        {
+          a0 = m_a0[i]; a1 = m_a1[i]; a2 = m_a2[i];
+          b0 = m_b0[i]; b1 = m_b1[i]; b2 = m_b2[i];
+        }
+      };
+
+      template<typename pair_iterator, typename triangle_accessor>
+      class TrianglePairFetch
+      {
+      public:
+
+        pair_iterator             m_pairs;
+        triangle_accessor const * m_accessor;
+
+        TrianglePairFetch(pair_iterator pairs, triangle_accessor const & accessor)
+          : m_pairs(pairs), m_accessor(&accessor)
+        {}
+
+        template<typename vector3_type>
+        void operator()(size_t i, vector3_type & a0, vector3_type & a1, vector3_type & a2, vector3_type & b0, vector3_type & b1, vector3_type & b2) const
+        {
+          pair_iterator pair = m_pairs + i;
+          (*m_accessor)( pair->first,  a0, a1, a2 );
+          (*m_accessor)( pair->second, b0, b1, b2 );
+        }
+      };
+
+    } // namespace detail
+
+    /**
+    * Batched Triangle Triangle Overlap Test.
+    * Tests many triangle pairs for intersection. The triangle pairs are
+    * processed in blocks of detail::triangle_triangle_batch_width pairs, such
+    * that the interval overlap test of Moller can be vectorized across the
+    * pairs of a block. Coplanar pairs are decided by a scalar fallback.
+    *
+    * @param count      The number of triangle pairs.
+    * @param a0         Array of first vertices of the A-triangles.
+    * @param a1         Array of second vertices of the A-triangles.
+    * @param a2         Array of third vertices of the A-triangles.
+    * @param b0         Array of first vertices of the B-triangles.
+    * @param b1         Array of second vertices of the B-triangles.
+    * @param b2         Array of third vertices of the B-triangles.
+    * @param overlap    Upon return the i'th value is true if the i'th triangle pair intersect. The flag type could
+    *                   for instance be bool or int.
+    */
+    template<typename vector3_type, typename flag_type>
+    void triangle_triangle_overlap_batch(
+      size_t count
+      , vector3_type const * a0
+      , vector3_type const * a1
+      , vector3_type const * a2
+      , vector3_type const * b0
+      , vector3_type const * b1
+      , vector3_type const * b2
+      , flag_type * overlap
+      )
+    {
+      detail::triangle_triangle_batch(
+        count
+        , detail::TriangleArrayFetch<vector3_type>( a0, a1, a2, b0, b1, b2 )
+        , overlap
+        , static_cast<flag_type*>(0)
+        , static_cast<vector3_type*>(0)
+        , static_cast<vector3_type*>(0)
+        );
+    }
+
+    /**
+    * Batched Triangle Triangle Intersection Segments.
+    * Same as triangle_triangle_overlap_batch() but additionally reports the
+    * line segment where two intersecting triangles cross each other. This is
+    * useful for cutting and for contact generation between deformable surfaces.
+    *
+    * Coplanar triangles do not intersect in a segment, for these pairs the
+    * coplanar flag is set and the segment is undefined.
+    *
+    * @param count      The number of triangle pairs.
+    * @param a0         Array of first vertices of the A-triangles.
+    * @param a1         Array of second vertices of the A-triangles.
+    * @param a2         Array of third vertices of the A-triangles.
+    * @param b0         Array of first vertices of the B-triangles.
+    * @param b1         Array of second vertices of the B-triangles.
+    * @param b2         Array of third vertices of the B-triangles.
+    * @param overlap    Upon return the i'th value is true if the i'th triangle pair intersect.
+    * @param coplanar   Upon return the i'th value is true if the i'th triangle pair is coplanar.
+    * @param p          Upon return the i'th value is the first end point of the intersection segment of the i'th triangle pair.
+    * @param q          Upon return the i'th value is the second end point of the intersection segment of the i'th triangle pair.
+    */
+    template<typename vector3_type, typename flag_type>
+    void triangle_triangle_segment_batch(
+      size_t count
+      , vector3_type const * a0
+      , vector3_type const * a1
+      , vector3_type const * a2
+      , vector3_type const * b0
+      , vector3_type const * b1
+      , vector3_type const * b2
+      , flag_type * overlap
+      , flag_type * coplanar
+      , vector3_type * p
+      , vector3_type * q
+      )
+    {
+      assert(coplanar);
+      assert(p);
+      assert(q);
+      detail::triangle_triangle_batch(
+        count
+        , detail::TriangleArrayFetch<vector3_type>( a0, a1, a2, b0, b1, b2 )
+        , overlap
+        , coplanar
+        , p
+        , q
+        );
+    }
+
+    /**
+    * Batched Triangle Triangle Test on Leaf Pairs.
+    * Tests the leaf pairs reported by a bounding volume hierarchy query, such
+    * as bvh::ModelCollisionQuery, without first copying the triangles into
+    * arrays. The vertices of a leaf are obtained from an accessor functor:
+    *
+    *   accessor( leaf, v0, v1, v2 )
+    *
+    * which must store the vertices of the triangle of the leaf in v0, v1 and
+    * v2 in a common coordinate frame.
+    *
+    * @param pairs      A random access container of leaf pairs, the elements must have members first and second.
+    * @param accessor   The triangle accessor functor.
+    * @param overlap    Array of overlap flags, must have room for one flag per leaf pair.
+    * @param coplanar   Array of coplanar flags or null if not wanted.
+    * @param p          Array of first segment end points or null if intersection segments are not wanted.
+    * @param q          Array of second segment end points or null if intersection segments are not wanted.
+    */
+    template<typename pair_container, typename triangle_accessor, typename vector3_type, typename flag_type>
+    void triangle_triangle_batch(
+      pair_container const & pairs
+      , triangle_accessor const & accessor
+      , flag_type * overlap
+      , flag_type * coplanar
+      , vector3_type * p
+      , vector3_type * q
+      )
+    {
+      typedef typename pair_container::const_iterator pair_iterator;
+      detail::triangle_triangle_batch(
+        pairs.size()
+        , detail::TrianglePairFetch<pair_iterator,triangle_accessor>( pairs.begin(), accessor )
+        , overlap
+        , coplanar
+        , p
+        , q
+        );
+    }
+
+  } //End of namespace intersect
+
+} //End of namespace OpenTissue
+
+// OPENTISSUE_COLLISION_INTERSECT_INTERSECT_TRIANGLE_TRIANGLE_BATCH_H
+#endif
@@ -121,11 +121,11 @@ namespace OpenTissue
         vector3_type n  = a10 % b21;
         real_type w = n*a0;
         real_type d = n*a2 - w;
-        real_type d2 = n*b2 - w;
+        real_type d0 = n*b0 - w;
         real_type d1 = n*b1 - w;
-        if(d > 0 && d2 < 0  && d1 < 0 )
+        if(d > 0 && d0 < 0  && d1 < 0 )
           return true;
-        if(d < 0 && d2 > 0  && d1 > 0 )
+        if(d < 0 && d0 > 0  && d1 > 0 )
           return true;
       }
       //--- SAT: a20 crossed with all edges of B
@@ -155,11 +155,11 @@ namespace OpenTissue
         vector3_type n  = a20 % b21;
         real_type w = n*a0;
         real_type d = n*a1 - w;
-        real_type d2 = n*b2 - w;
+        real_type d0 = n*b0 - w;
         real_type d1 = n*b1 - w;
-        if(d > 0 && d2 < 0  && d1 < 0 )
+        if(d > 0 && d0 < 0  && d1 < 0 )
           return true;
-        if(d < 0 && d2 > 0  && d1 > 0 )
+        if(d < 0 && d0 > 0  && d1 > 0 )
           return true;
       }
       //--- SAT: a21 crossed with all edges of B
@@ -189,11 +189,11 @@ namespace OpenTissue
         vector3_type n  = a21 % b21;
         real_type w = n*a1;
         real_type d = n*a0 - w;
-        real_type d2 = n*b2 - w;
+        real_type d0 = n*b0 - w;
         real_type d1 = n*b1 - w;
-        if(d > 0 && d2 < 0  && d1 < 0 )
+        if(d > 0 && d0 < 0  && d1 < 0 )
           return true;
-        if(d < 0 && d2 > 0  && d1 > 0 )
+        if(d < 0 && d0 > 0  && d1 > 0 )
           return true;
       }
       return false;
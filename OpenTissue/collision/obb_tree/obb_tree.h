@@ -11,6 +11,8 @@
 
 #include <OpenTissue/collision/obb_tree/obb_tree_collision_policy.h>
 #include <OpenTissue/collision/obb_tree/obb_tree_collision_query.h>
+#include <OpenTissue/collision/obb_tree/obb_tree_front.h>
+#include <OpenTissue/collision/obb_tree/obb_tree_front_collision_query.h>
 #include <OpenTissue/collision/obb_tree/obb_tree_top_down_policy.h>
 #include <OpenTissue/collision/obb_tree/obb_tree_types.h>
 #include <OpenTissue/collision/obb_tree/obb_tree_init.h>
@@ -12,6 +12,8 @@
 #include <OpenTissue/collision/intersect/intersect_obb_obb_sat.h>
 #include <OpenTissue/collision/intersect/intersect_triangle_triangle_sat.h>
 
+#include <boost/shared_ptr.hpp> // needed for boost::static_pointer_cast
+
 #include <cassert>
 
 namespace OpenTissue
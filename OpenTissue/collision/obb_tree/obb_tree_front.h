@@ -0,0 +1,232 @@
+#ifndef OPENTISSUE_COLLISION_OBB_TREE_OBB_TREE_FRONT_H
+#define OPENTISSUE_COLLISION_OBB_TREE_OBB_TREE_FRONT_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <vector>
+
+namespace OpenTissue
+{
+
+  namespace obb_tree
+  {
+
+    /**
+    * Bounding Volume Test Tree Front.
+    * A traversal of two bounding volume hierarchies A and B visits pairs of
+    * nodes, and these pairs form a tree of their own, the bounding volume
+    * test tree (BVTT). The traversal stops at pairs that are separated and at
+    * pairs of two leaves, these pairs are called the front of the BVTT.
+    *
+    * A front remembers the part of the BVTT that was visited by the last
+    * query of a model pair. When the models move a little between two
+    * queries the front moves a little as well, so the next query starts out
+    * from the old front instead of from the roots. See FrontCollisionQuery.
+    *
+    * Separated front nodes remember a lower bound of the distance between
+    * their volumes. The bound is decreased by the motion of the models
+    * between queries, and a node is only tested again once the bound is
+    * used up.
+    *
+    * A front belongs to one pair of hierarchies, it is reset by the query
+    * if it is used with another pair. It must be cleared if one of the
+    * hierarchies is rebuilt.
+    */
+    template<typename bvh_type>
+    class Front
+    {
+    public:
+
+      typedef typename bvh_type::bv_ptr                   bv_ptr;
+      typedef typename bvh_type::volume_type              volume_type;
+      typedef typename volume_type::real_type             real_type;
+      typedef typename volume_type::coordsys_type         coordsys_type;
+
+      /**
+      * Node States.
+      */
+      enum state_type
+      {
+        free_node = 0     ///< The node is unused and can be recycled.
+        , separated_node  ///< A front node where the two volumes were separated.
+        , touching_node   ///< A front node with two leaves where the two volumes overlapped.
+        , interior_node   ///< An internal node of the visited part of the BVTT.
+      };
+
+      /**
+      * BVTT Node.
+      */
+      class node_type
+      {
+      public:
+
+        bv_ptr      m_A;          ///< The bounding volume node of hierarchy A.
+        bv_ptr      m_B;          ///< The bounding volume node of hierarchy B.
+        int         m_parent;     ///< Index of parent BVTT node, or -1 at the root.
+        int         m_child;      ///< Index of first child BVTT node, or -1 at the front.
+        int         m_sibling;    ///< Index of next sibling BVTT node, or -1 at the last child.
+        int         m_state;      ///< The state of the node, see state_type.
+        size_t      m_stamp;      ///< The last query that tested the node.
+        real_type   m_slack;      ///< Lower bound of the distance between the volumes of a separated node.
+
+      public:
+
+        node_type()
+          : m_A()
+          , m_B()
+          , m_parent(-1)
+          , m_child(-1)
+          , m_sibling(-1)
+          , m_state(free_node)
+          , m_stamp(0)
+          , m_slack(0)
+        {}
+
+      };
+
+    public:
+
+      std::vector<node_type>   m_nodes;     ///< The visited BVTT nodes, the root has index zero.
+      std::vector<int>         m_free;      ///< Indices of free nodes.
+      size_t                   m_stamp;     ///< The number of queries run with this front.
+      size_t                   m_tests;     ///< The number of bounding volume tests done by the last query.
+      coordsys_type            m_A2B;       ///< The model transform of the last query.
+      bool                     m_tracked;   ///< Tells whether m_A2B is valid, slacks are relative to m_A2B.
+
+    public:
+
+      Front()
+        : m_nodes()
+        , m_free()
+        , m_stamp(0)
+        , m_tests(0)
+        , m_A2B()
+        , m_tracked(false)
+      {}
+
+    public:
+
+      void clear()
+      {
+        m_nodes.clear();
+        m_free.clear();
+        m_tests = 0;
+        m_tracked = false;
+      }
+
+      bool empty() const { return m_nodes.empty(); }
+
+      /**
+      * Get Front Size.
+      *
+      * @return  The number of node pairs in the front.
+      */
+      size_t size() const
+      {
+        size_t count = 0;
+        for(size_t i = 0; i < m_nodes.size(); ++i)
+          if(m_nodes[i].m_state == separated_node || m_nodes[i].m_state == touching_node)
+            ++count;
+        return count;
+      }
+
+      /**
+      * Get Number of Tests.
+      *
+      * @return  The number of bounding volume tests done by the last query.
+      */
+      size_t tests() const { return m_tests; }
+
+      /**
+      * Reset Front.
+      * Discards all nodes and makes the pair of roots the only node of the front.
+      */
+      void reset(bv_ptr const & root_A, bv_ptr const & root_B)
+      {
+        clear();
+        int const root = create( -1, root_A, root_B );
+        m_nodes[root].m_state = separated_node;
+      }
+
+      /**
+      * Create BVTT Node.
+      * The new node becomes the first child of its parent.
+      *
+      * @return   The index of the new node.
+      */
+      int create(int parent, bv_ptr const & A, bv_ptr const & B)
+      {
+        int index = static_cast<int>( m_nodes.size() );
+        if(m_free.empty())
+          m_nodes.push_back( node_type() );
+        else
+        {
+          index = m_free.back();
+          m_free.pop_back();
+        }
+        node_type & node = m_nodes[index];
+        node.m_A       = A;
+        node.m_B       = B;
+        node.m_parent  = parent;
+        node.m_child   = -1;
+        node.m_sibling = -1;
+        node.m_state   = interior_node;
+        node.m_stamp   = 0;
+        node.m_slack   = real_type(0);
+        if(parent >= 0)
+        {
+          node.m_sibling = m_nodes[parent].m_child;
+          m_nodes[parent].m_child = index;
+        }
+        return index;
+      }
+
+      /**
+      * Collapse BVTT Node.
+      * Frees all children of a node, such that the node becomes part of the front.
+      * The children must be front nodes themselves.
+      */
+      void collapse(int index)
+      {
+        int child = m_nodes[index].m_child;
+        while(child >= 0)
+        {
+          node_type & node = m_nodes[child];
+          int const next = node.m_sibling;
+          node = node_type();
+          m_free.push_back( child );
+          child = next;
+        }
+        m_nodes[index].m_child = -1;
+        m_nodes[index].m_state = separated_node;
+      }
+
+      /**
+      * Test if all Children are Separated.
+      *
+      * @return  If the node is an interior node where all children are separated front nodes then the return value is true otherwise it is false.
+      */
+      bool collapsible(int index) const
+      {
+        if(m_nodes[index].m_state != interior_node)
+          return false;
+        for(int child = m_nodes[index].m_child; child >= 0; child = m_nodes[child].m_sibling)
+          if(m_nodes[child].m_state != separated_node)
+            return false;
+        return true;
+      }
+
+    };
+
+  } // namespace obb_tree
+
+} // namespace OpenTissue
+
+//OPENTISSUE_COLLISION_OBB_TREE_OBB_TREE_FRONT_H
+#endif
@@ -0,0 +1,280 @@
+#ifndef OPENTISSUE_COLLISION_OBB_TREE_OBB_TREE_FRONT_COLLISION_QUERY_H
+#define OPENTISSUE_COLLISION_OBB_TREE_OBB_TREE_FRONT_COLLISION_QUERY_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/obb_tree/obb_tree_front.h>
+#include <OpenTissue/collision/intersect/intersect_obb_obb_sat_batch.h>
+
+#include <boost/shared_ptr.hpp> // needed for boost::const_pointer_cast
+
+#include <vector>
+#include <cmath>
+
+namespace OpenTissue
+{
+
+  namespace obb_tree
+  {
+
+    /**
+    * Front Tracking Collision Query.
+    * This query gives the same results as CollisionQuery, but it keeps the
+    * front of the bounding volume test tree between invocations, see Front.
+    *
+    * Every query starts by testing the pairs of the old front. Overlapping
+    * pairs are expanded just like a normal traversal would do. Afterwards
+    * interior pairs where all children are separated are tested again, and
+    * if they are separated too the front is collapsed onto them. Pairs that
+    * were tested within the last m_collapse_delay queries are not tested
+    * for collapse, since pairs in contact regions tend to keep overlapping
+    * while all their children are separated. When the
+    * models move coherently only a few pairs change, and the number of
+    * bounding volume tests is close to the size of the front rather than the
+    * size of the whole visited test tree. Separated front pairs are
+    * not even tested until the motion of the models could have closed the
+    * gap found by their last test.
+    *
+    * Pairs are tested level by level, such that all pairs of one level are
+    * given to the batched separating axis test, see intersect::obb_obb_sat_batch().
+    *
+    * Leaf pairs below a separated pair never contain intersecting triangles,
+    * so leaf pairs reached through the front are reported by the exact
+    * triangle test of the collision policy regardless of the state of their
+    * ancestors.
+    */
+    template <typename collision_policy>
+    class FrontCollisionQuery
+      : public collision_policy
+    {
+    protected:
+
+      typedef typename collision_policy::volume_type::real_type   real_type;
+
+    public:
+
+      FrontCollisionQuery()
+        : collision_policy()
+        , m_collapse_delay(4u)
+      {}
+
+    public:
+
+      /**
+      * Run Query.
+      *
+      * @param A2B       Model transform, brings bvh A into same frame as bvh B.
+      * @param bvh_A     bvh A.
+      * @param bvh_B     bvh B.
+      * @param front     The front of the model pair, it is updated by the query.
+      * @param results   Upon return this container contains any results from the
+      *                  collision query.
+      */
+      template<typename coordsys_type, typename bvh_type, typename results_container>
+      void run(
+        coordsys_type const & A2B
+        , bvh_type const & bvh_A
+        , bvh_type const & bvh_B
+        , Front<bvh_type> & front
+        , results_container & results
+        )
+      {
+        this->m_query = this->get_next_time_stamp(); //--- from collision policy
+        this->reset(results);                          //--- from collision policy
+        if(bvh_A.size()<bvh_B.size())
+          traverse(A2B,bvh_A,bvh_B,front,results);
+        else
+        {
+          coordsys_type B2A = inverse(A2B);
+          traverse(B2A,bvh_B,bvh_A,front,results);
+        }
+      }
+
+    protected:
+
+      template<typename coordsys_type, typename bvh_type, typename results_container>
+      void traverse(
+        coordsys_type const & A2B
+        , bvh_type const & bvh_A
+        , bvh_type const & bvh_B
+        , Front<bvh_type> & front
+        , results_container & results
+        )
+      {
+        typedef          Front<bvh_type>                    front_type;
+        typedef typename front_type::node_type              node_type;
+        typedef typename bvh_type::bv_type                  bv_type;
+        typedef typename bvh_type::bv_ptr                   bv_ptr;
+        typedef typename bvh_type::bv_ptr_iterator          bv_ptr_iterator;
+        typedef typename front_type::volume_type            volume_type;
+        typedef typename volume_type::vector3_type          vector3_type;
+        typedef typename volume_type::matrix3x3_type        matrix3x3_type;
+
+        using std::sqrt;
+
+        front.m_tests = 0;
+        if(!bvh_A.root() || !bvh_B.root())
+          return;
+
+        bv_ptr root_A = boost::const_pointer_cast<bv_type>( bvh_A.root() );
+        bv_ptr root_B = boost::const_pointer_cast<bv_type>( bvh_B.root() );
+        if(front.empty() || front.m_nodes[0].m_A != root_A || front.m_nodes[0].m_B != root_B)
+          front.reset( root_A, root_B );
+
+        size_t const stamp = ++front.m_stamp;
+
+        //--- Bound the motion of model A relative to model B since the last query
+        matrix3x3_type const R1( A2B.Q() );
+        matrix3x3_type const R0( front.m_A2B.Q() );
+        matrix3x3_type const D  = R1 - R0;
+        vector3_type   const dT = A2B.T() - front.m_A2B.T();
+        real_type norm_D = real_type(0);
+        for(size_t i = 0; i < 3; ++i)
+          for(size_t j = 0; j < 3; ++j)
+            norm_D += D(i,j)*D(i,j);
+        norm_D = sqrt( norm_D );
+
+        std::vector<int> current;
+        std::vector<int> next;
+        for(size_t i = 0; i < front.m_nodes.size(); ++i)
+        {
+          node_type & node = front.m_nodes[i];
+          if(node.m_state == front_type::separated_node && front.m_tracked)
+          {
+            //--- No point of box A moved farther than this, so the box is still separated if the slack is left
+            volume_type const & box = node.m_A->volume();
+            node.m_slack -= length( D*box.center() + dT ) + norm_D*length( box.eps() );
+            if(node.m_slack > real_type(0))
+              continue;
+          }
+          if(node.m_state == front_type::separated_node || node.m_state == front_type::touching_node)
+            current.push_back( static_cast<int>(i) );
+        }
+
+        //--- Test the front and expand it where pairs overlap
+        while(!current.empty())
+        {
+          test( A2B, front, current );
+          next.clear();
+          for(size_t n = 0; n < current.size(); ++n)
+          {
+            int const index = current[n];
+            node_type & node = front.m_nodes[index];
+            node.m_stamp = stamp;
+            if(m_separated[n])
+            {
+              node.m_state = front_type::separated_node;
+              node.m_slack = m_gap[n];
+              continue;
+            }
+            bv_ptr A = node.m_A;
+            bv_ptr B = node.m_B;
+            if( A->is_leaf() && B->is_leaf() )
+            {
+              node.m_state = front_type::touching_node;
+              this->report( A2B, A, B, results );  //--- collision_policy
+              continue;
+            }
+            node.m_state = front_type::interior_node;
+            //--- Same descend rule as bvh::ModelCollisionQuery, node may be invalidated by create()
+            if (  B->is_leaf()  || ( !A->is_leaf() && (   A->volume().volume() > B->volume().volume()  )  ) )
+            {
+              bv_ptr_iterator a   = A->child_ptr_begin();
+              bv_ptr_iterator end = A->child_ptr_end();
+              for(;a!=end;++a)
+                next.push_back( front.create( index, *a, B ) );
+            }
+            else
+            {
+              bv_ptr_iterator b   = B->child_ptr_begin();
+              bv_ptr_iterator end = B->child_ptr_end();
+              for(;b!=end;++b)
+                next.push_back( front.create( index, A, *b ) );
+            }
+          }
+          current.swap( next );
+        }
+
+        //--- Collapse the front onto separated parents, bottom up
+        for(size_t i = 0; i < front.m_nodes.size(); ++i)
+        {
+          int const parent = front.m_nodes[i].m_parent;
+          if(front.m_nodes[i].m_state != front_type::separated_node || parent < 0)
+            continue;
+          if(stamp - front.m_nodes[parent].m_stamp < m_collapse_delay || !front.collapsible( parent ))
+            continue;
+          front.m_nodes[parent].m_stamp = stamp;
+          current.push_back( parent );
+        }
+        while(!current.empty())
+        {
+          test( A2B, front, current );
+          next.clear();
+          for(size_t n = 0; n < current.size(); ++n)
+          {
+            if(!m_separated[n])
+              continue;
+            int const index = current[n];
+            front.collapse( index );
+            front.m_nodes[index].m_slack = m_gap[n];
+            int const parent = front.m_nodes[index].m_parent;
+            if(parent < 0 || stamp - front.m_nodes[parent].m_stamp < m_collapse_delay || !front.collapsible( parent ))
+              continue;
+            front.m_nodes[parent].m_stamp = stamp;
+            next.push_back( parent );
+          }
+          current.swap( next );
+        }
+
+        front.m_A2B     = A2B;
+        front.m_tracked = true;
+      }
+
+      /**
+      * Test BVTT Nodes.
+      * Runs the batched separating axis test on the given nodes, the
+      * results are stored in m_separated and m_gap.
+      */
+      template<typename coordsys_type, typename front_type>
+      void test(coordsys_type const & A2B, front_type & front, std::vector<int> const & nodes)
+      {
+        typedef typename front_type::bv_ptr::element_type::volume_type volume_type;
+
+        size_t const count = nodes.size();
+        std::vector<volume_type const *> A( count );
+        std::vector<volume_type const *> B( count );
+        for(size_t n = 0; n < count; ++n)
+        {
+          A[n] = &( front.m_nodes[ nodes[n] ].m_A->volume() );
+          B[n] = &( front.m_nodes[ nodes[n] ].m_B->volume() );
+        }
+        m_separated.resize( count );
+        m_gap.resize( count );
+        if(count > 0)
+          OpenTissue::intersect::obb_obb_sat_batch( A2B, count, &A[0], &B[0], &m_separated[0], &m_gap[0] );
+        front.m_tests += count;
+      }
+
+    public:
+
+      size_t                m_collapse_delay;   ///< The number of queries that must pass before a pair, that was found overlapping, is tested for collapse again.
+
+    protected:
+
+      std::vector<char>        m_separated;     ///< Results of the last batch of bounding volume tests.
+      std::vector<real_type>   m_gap;           ///< Gaps of the last batch of bounding volume tests.
+
+    };
+
+  } // namespace obb_tree
+
+} // namespace OpenTissue
+
+//OPENTISSUE_COLLISION_OBB_TREE_OBB_TREE_FRONT_COLLISION_QUERY_H
+#endif
@@ -19,6 +19,7 @@
 
 #include <OpenTissue/collision/obb_tree/obb_tree_collision_policy.h>
 #include <OpenTissue/collision/obb_tree/obb_tree_collision_query.h>
+#include <OpenTissue/collision/obb_tree/obb_tree_front_collision_query.h>
 #include <OpenTissue/collision/obb_tree/obb_tree_top_down_policy.h>
 
 #include <list>
@@ -138,6 +139,8 @@ namespace OpenTissue
 
       typedef OpenTissue::bvh::TopDownConstructor< bvh_type,  top_down_type >  construtor_type;
       typedef CollisionQuery< collision_type >                                 collision_query_type;
+      typedef FrontCollisionQuery< collision_type >                            front_collision_query_type;
+      typedef Front< bvh_type >                                                front_type;
       typedef std::list< std::pair<face_ptr_type,face_ptr_type> >              result_type;
 
     };
@@ -10,6 +10,7 @@
 #include <OpenTissue/configuration.h>
 
 #include <OpenTissue/collision/sdf/sdf_collision_policy.h>
+#include <OpenTissue/collision/sdf/sdf_batch_collision_query.h>
 
 #include <OpenTissue/collision/collision_sdf_sdf.h>
 #include <OpenTissue/collision/collision_sphere_sdf.h>
@@ -0,0 +1,469 @@
+#ifndef OPENTISSUE_COLLISION_SDF_SDF_BATCH_COLLISION_QUERY_H
+#define OPENTISSUE_COLLISION_SDF_SDF_BATCH_COLLISION_QUERY_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/sdf/sdf_collision_policy.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_gradient_at_point.h>
+
+#include <vector>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace sdf
+  {
+    namespace detail
+    {
+
+      /**
+      * The number of points processed together in one lane block. The
+      * loops over a lane block are branch free such that the compiler
+      * can map them onto SIMD registers.
+      */
+      size_t const sdf_batch_width = 8u;
+
+      /**
+      * Transform a Block of Points.
+      * Computes p' = R p + T for points stored as structure of arrays.
+      *
+      * @param R      The rotation matrix of the transform.
+      * @param T      The translation of the transform.
+      * @param n      The number of points.
+      * @param x      The x-coordinates, upon return holds the transformed x-coordinates.
+      * @param y      The y-coordinates, upon return holds the transformed y-coordinates.
+      * @param z      The z-coordinates, upon return holds the transformed z-coordinates.
+      */
+      template<typename matrix3x3_type, typename vector3_type, typename real_type>
+      inline void xform_points(
+        matrix3x3_type const & R
+        , vector3_type const & T
+        , size_t n
+        , real_type * x
+        , real_type * y
+        , real_type * z
+        )
+      {
+        real_type const r00 = R(0,0);  real_type const r01 = R(0,1);  real_type const r02 = R(0,2);
+        real_type const r10 = R(1,0);  real_type const r11 = R(1,1);  real_type const r12 = R(1,2);
+        real_type const r20 = R(2,0);  real_type const r21 = R(2,1);  real_type const r22 = R(2,2);
+        real_type const t0  = T(0);    real_type const t1  = T(1);    real_type const t2  = T(2);
+
+        for(size_t i = 0u; i < n; ++i)
+        {
+          real_type const px = x[i];
+          real_type const py = y[i];
+          real_type const pz = z[i];
+          x[i] = r00*px + r01*py + r02*pz + t0;
+          y[i] = r10*px + r11*py + r12*pz + t1;
+          z[i] = r20*px + r21*py + r22*pz + t2;
+        }
+      }
+
+      /**
+      * Gather Node Values.
+      * Looks up the eight nodes enclosing each point of a lane block. This
+      * version works for any grid type, such as a sparse grid, by using
+      * the node access operator of the grid.
+      *
+      * @param phi        The signed distance grid.
+      * @param count      The number of points in the lane block.
+      * @param i0         The i-index of the lower enclosing node of each point.
+      * @param j0         The j-index of the lower enclosing node of each point.
+      * @param k0         The k-index of the lower enclosing node of each point.
+      * @param d          Upon return holds the eight node values of each point.
+      */
+      template<typename grid_type, typename real_type>
+      inline void gather_nodes(
+        grid_type const & phi
+        , size_t count
+        , size_t const * i0
+        , size_t const * j0
+        , size_t const * k0
+        , real_type (*d)[sdf_batch_width]
+        )
+      {
+        size_t const I = phi.I();
+        size_t const J = phi.J();
+        size_t const K = phi.K();
+
+        for(size_t l = 0u; l < count; ++l)
+        {
+          size_t const i1 = ( i0[l] + 1u ) % I;
+          size_t const j1 = ( j0[l] + 1u ) % J;
+          size_t const k1 = ( k0[l] + 1u ) % K;
+
+          d[0][l] = phi( i0[l], j0[l], k0[l] );
+          d[1][l] = phi( i1,    j0[l], k0[l] );
+          d[2][l] = phi( i0[l], j1,    k0[l] );
+          d[3][l] = phi( i1,    j1,    k0[l] );
+          d[4][l] = phi( i0[l], j0[l], k1    );
+          d[5][l] = phi( i1,    j0[l], k1    );
+          d[6][l] = phi( i0[l], j1,    k1    );
+          d[7][l] = phi( i1,    j1,    k1    );
+        }
+      }
+
+      /**
+      * Gather Node Values.
+      * Specialized version for dense grids, the node values are read
+      * directly from the underlying storage.
+      */
+      template<typename T, typename math_types, typename real_type>
+      inline void gather_nodes(
+        OpenTissue::grid::Grid<T, math_types> const & phi
+        , size_t count
+        , size_t const * i0
+        , size_t const * j0
+        , size_t const * k0
+        , real_type (*d)[sdf_batch_width]
+        )
+      {
+        size_t const I = phi.I();
+        size_t const J = phi.J();
+        size_t const K = phi.K();
+
+        T const * values = phi.data();
+
+        for(size_t l = 0u; l < count; ++l)
+        {
+          size_t const i1 = ( i0[l] + 1u ) % I;
+          size_t const j1 = ( j0[l] + 1u ) % J;
+          size_t const k1 = ( k0[l] + 1u ) % K;
+
+          size_t const kj00 = ( k0[l]*J + j0[l] )*I;
+          size_t const kj01 = ( k0[l]*J + j1    )*I;
+          size_t const kj10 = ( k1   *J + j0[l] )*I;
+          size_t const kj11 = ( k1   *J + j1    )*I;
+
+          d[0][l] = values[ kj00 + i0[l] ];
+          d[1][l] = values[ kj00 + i1    ];
+          d[2][l] = values[ kj01 + i0[l] ];
+          d[3][l] = values[ kj01 + i1    ];
+          d[4][l] = values[ kj10 + i0[l] ];
+          d[5][l] = values[ kj10 + i1    ];
+          d[6][l] = values[ kj11 + i0[l] ];
+          d[7][l] = values[ kj11 + i1    ];
+        }
+      }
+
+      /**
+      * Sample a Block of Points.
+      * Looks up the eight enclosing node values of each point and computes the
+      * minimum node value and the trilinear interpolated value. The computations
+      * are the same as done by the scalar CollisionPolicy.
+      *
+      * @param phi        The signed distance grid.
+      * @param n          The number of points.
+      * @param x          The x-coordinates of the points (in the frame of phi).
+      * @param y          The y-coordinates of the points (in the frame of phi).
+      * @param z          The z-coordinates of the points (in the frame of phi).
+      * @param inside     Upon return holds a non-zero value for points inside the grid.
+      * @param d_min      Upon return holds the minimum value of the enclosing nodes.
+      * @param distance   Upon return holds the trilinear interpolated value.
+      */
+      template<typename grid_type, typename real_type>
+      inline void sample_points(
+        grid_type const & phi
+        , size_t n
+        , real_type const * x
+        , real_type const * y
+        , real_type const * z
+        , int * inside
+        , real_type * d_min
+        , real_type * distance
+        )
+      {
+        using std::min;
+        using std::max;
+        using std::floor;
+
+        size_t const W = sdf_batch_width;
+
+        real_type const min_x = phi.min_coord(0);
+        real_type const min_y = phi.min_coord(1);
+        real_type const min_z = phi.min_coord(2);
+        real_type const max_x = phi.max_coord(0);
+        real_type const max_y = phi.max_coord(1);
+        real_type const max_z = phi.max_coord(2);
+        real_type const range_x = phi.max_coord(0) - phi.min_coord(0);
+        real_type const range_y = phi.max_coord(1) - phi.min_coord(1);
+        real_type const range_z = phi.max_coord(2) - phi.min_coord(2);
+        real_type const dx = phi.dx();
+        real_type const dy = phi.dy();
+        real_type const dz = phi.dz();
+
+        for(size_t first = 0u; first < n; first += W)
+        {
+          size_t const count = min( W, n - first );
+
+          size_t    i0[W], j0[W], k0[W];
+          real_type s[W], t[W], u[W];
+
+          //--- Compute enclosing indices and interpolation weights
+          for(size_t l = 0u; l < count; ++l)
+          {
+            real_type const px = x[first+l];
+            real_type const py = y[first+l];
+            real_type const pz = z[first+l];
+
+            inside[first+l] = (min_x <= px) & (px <= max_x) & (min_y <= py) & (py <= max_y) & (min_z <= pz) & (pz <= max_z);
+
+            real_type const cx = min( max( px - min_x, real_type() ), range_x ) / dx;
+            real_type const cy = min( max( py - min_y, real_type() ), range_y ) / dy;
+            real_type const cz = min( max( pz - min_z, real_type() ), range_z ) / dz;
+
+            i0[l] = static_cast<size_t>( floor( cx ) );
+            j0[l] = static_cast<size_t>( floor( cy ) );
+            k0[l] = static_cast<size_t>( floor( cz ) );
+
+            s[l] = ( px - ( i0[l] * dx + min_x ) ) / dx;
+            t[l] = ( py - ( j0[l] * dy + min_y ) ) / dy;
+            u[l] = ( pz - ( k0[l] * dz + min_z ) ) / dz;
+          }
+
+          //--- Gather node values
+          real_type d[8][W];
+          gather_nodes( phi, count, i0, j0, k0, d );
+
+          //--- Minimum node value and trilinear interpolation
+          for(size_t l = 0u; l < count; ++l)
+          {
+            real_type m = min( d[0][l], d[1][l] );
+            m = min( m, d[2][l] );
+            m = min( m, d[3][l] );
+            m = min( m, d[4][l] );
+            m = min( m, d[5][l] );
+            m = min( m, d[6][l] );
+            m = min( m, d[7][l] );
+            d_min[first+l] = m;
+
+            real_type const x00 = ( 1 - s[l] ) * d[0][l] + s[l] * d[1][l];
+            real_type const x01 = ( 1 - s[l] ) * d[2][l] + s[l] * d[3][l];
+            real_type const x10 = ( 1 - s[l] ) * d[4][l] + s[l] * d[5][l];
+            real_type const x11 = ( 1 - s[l] ) * d[6][l] + s[l] * d[7][l];
+            real_type const y0  = ( 1 - t[l] ) * x00 + t[l] * x01;
+            real_type const y1  = ( 1 - t[l] ) * x10 + t[l] * x11;
+            distance[first+l]   = ( 1 - u[l] ) * y0 + u[l] * y1;
+          }
+        }
+      }
+
+    } // namespace detail
+
+    /**
+    * Batched Signed Distance Field Collision Query.
+    * This query gives the same contact points as running a bvh::SingleCollisionQuery
+    * with the sdf::CollisionPolicy, but it processes the sphere BVH one level at a time.
+    *
+    * All bounding volumes at the current level are gathered into structure of arrays
+    * buffers, their centers are transformed in one go and the signed distance grid is
+    * sampled for all of them in lane blocks. Leaf nodes are handled in the same pass,
+    * thus the sample points are looked up in batches too. Only the gradient of the
+    * (few) sample points that actually generate contacts is computed one at a time.
+    *
+    * If the geometry carries a lower bound pyramid then the spheres of a level are
+    * first tested against the coarse levels, using the same test as the
+    * CollisionPolicy, and only the remaining spheres are sampled in the fine grid.
+    *
+    * The level order is the same as the queue order of the single collision query,
+    * thus contacts are reported in the same order.
+    *
+    * The query keeps its working buffers between invocations, so it pays off to
+    * re-use a query object for many pairs.
+    */
+    template <typename bvh_type_, typename coordsys_type_>
+    class BatchCollisionQuery
+      : public CollisionPolicy<bvh_type_, coordsys_type_>
+    {
+    public:
+
+      typedef          bvh_type_                            bvh_type;
+      typedef          coordsys_type_                       coordsys_type;
+      typedef typename bvh_type::bv_type                    bv_type;
+      typedef typename bvh_type::bv_const_ptr_iterator      bv_const_ptr_iterator;
+      typedef typename coordsys_type::vector3_type          vector3_type;
+      typedef typename coordsys_type::value_type            real_type;
+      typedef typename coordsys_type::matrix3x3_type        matrix3x3_type;
+
+    protected:
+
+      std::vector<bv_type const *>  m_level;      ///< Bounding volumes at the current level.
+      std::vector<bv_type const *>  m_next;       ///< Bounding volumes at the next level.
+      std::vector<real_type>        m_x;          ///< Transformed x-coordinates of sphere centers.
+      std::vector<real_type>        m_y;          ///< Transformed y-coordinates of sphere centers.
+      std::vector<real_type>        m_z;          ///< Transformed z-coordinates of sphere centers.
+      std::vector<int>              m_inside;     ///< Inside grid flags.
+      std::vector<real_type>        m_d_min;      ///< Minimum enclosing node values.
+      std::vector<real_type>        m_distance;   ///< Trilinear interpolated values.
+
+    public:
+
+      /**
+      * Collision Query.
+      *
+      * @param xform     Coordinate transform, brings the bvh into the frame of the geometry.
+      * @param bvh       The sphere bvh of the sample points of one sdf geometry.
+      * @param geometry  The other sdf geometry.
+      * @param contacts  Upon return any contact points are added to this container, see
+      *                  CollisionPolicy::report() for the conventions used.
+      */
+      template<typename sdf_geometry_type, typename contact_point_container>
+      void run(
+        coordsys_type const & xform
+        , bvh_type const & bvh
+        , sdf_geometry_type const & geometry
+        , contact_point_container & contacts
+        )
+      {
+        typedef typename sdf_geometry_type::grid_type           grid_type;
+        typedef typename sdf_geometry_type::pyramid_type        pyramid_type;
+        typedef typename contact_point_container::value_type    contact_point_type;
+
+        grid_type    const & phi     = geometry.m_phi;
+        pyramid_type const & pyramid = geometry.m_pyramid;
+
+        this->reset(contacts);
+
+        if( !bvh.root() )
+          return;
+
+        matrix3x3_type const R( xform.Q() );
+        vector3_type   const ext      = geometry.ext();
+        real_type      const envelope = this->m_envelope;
+
+        m_level.clear();
+        m_level.push_back( bvh.root().get() );
+
+        while( !m_level.empty() )
+        {
+          size_t n = m_level.size();
+
+          m_x.resize(n);
+          m_y.resize(n);
+          m_z.resize(n);
+          m_inside.resize(n);
+          m_d_min.resize(n);
+          m_distance.resize(n);
+
+          for(size_t i = 0u; i < n; ++i)
+          {
+            vector3_type const & c = m_level[i]->volume().center();
+            m_x[i] = c(0);
+            m_y[i] = c(1);
+            m_z[i] = c(2);
+          }
+
+          detail::xform_points( R, xform.T(), n, &m_x[0], &m_y[0], &m_z[0] );
+
+          //--- Let the coarse levels of the pyramid remove spheres that are far
+          //--- from the zero-level set before the fine grid is sampled, the
+          //--- remaining spheres are kept in order (empty pyramids never cull)
+          if( !pyramid.empty() )
+          {
+            size_t kept = 0u;
+            for(size_t i = 0u; i < n; ++i)
+            {
+              vector3_type const center( m_x[i], m_y[i], m_z[i] );
+              real_type const tst = m_level[i]->volume().radius() + envelope;
+              if( phi.min_coord() <= center && center <= phi.max_coord() )
+                if( OpenTissue::grid::pyramid_lower_bound( pyramid, center, tst ) >= tst )
+                  continue;
+              m_level[kept] = m_level[i];
+              m_x[kept]     = m_x[i];
+              m_y[kept]     = m_y[i];
+              m_z[kept]     = m_z[i];
+              ++kept;
+            }
+            n = kept;
+            if( n == 0u )
+              break;
+          }
+
+          detail::sample_points( phi, n, &m_x[0], &m_y[0], &m_z[0], &m_inside[0], &m_d_min[0], &m_distance[0] );
+
+          m_next.clear();
+          for(size_t i = 0u; i < n; ++i)
+          {
+            bv_type const * bv = m_level[i];
+            real_type const tst = bv->volume().radius() + envelope;
+
+            bool overlap = false;
+            if( m_inside[i] )
+            {
+              overlap = m_d_min[i] < tst;
+            }
+            else
+            {
+              //--- Sphere center is outside map, see if sphere surface intersect
+              //--- minimum AABB of sampling points
+              vector3_type const center( m_x[i], m_y[i], m_z[i] );
+              vector3_type proj;
+              for(unsigned int k = 0; k < 3; ++k)
+              {
+                if(ext(k) < center(k))
+                  proj(k) = ext(k);
+                else if(center(k) < -ext(k))
+                  proj(k) = -ext(k);
+                else
+                  proj(k) = center(k);
+              }
+              vector3_type const diff = center - proj;
+              overlap = (diff*diff) < tst*tst;
+            }
+            if( !overlap )
+              continue;
+
+            if( !bv->is_leaf() )
+            {
+              for(bv_const_ptr_iterator child = bv->child_ptr_begin(); child != bv->child_ptr_end(); ++child)
+                m_next.push_back( child->get() );
+              continue;
+            }
+
+            if( !m_inside[i] || m_d_min[i] > envelope || m_distance[i] > envelope )
+              continue;
+
+            vector3_type center( m_x[i], m_y[i], m_z[i] );
+
+            if( OpenTissue::grid::pyramid_lower_bound( pyramid, center, envelope ) > envelope )
+              continue;
+
+            vector3_type n = OpenTissue::grid::gradient_at_point(phi, center);
+            if ( n(0) == phi.unused() )
+              continue;
+
+            //--- By convention we want n to point from A to B, see CollisionPolicy::report()
+            n = -unit(n);
+            if(this->m_flipped)
+              n = - n;
+
+            this->m_wcs_xform.xform_vector( n );
+            this->m_wcs_xform.xform_point( center );
+
+            contact_point_type cp;
+            cp.m_n = n;
+            cp.m_p = center;
+            cp.m_distance = m_distance[i];
+            contacts.push_back(cp);
+          }
+
+          m_level.swap( m_next );
+        }
+      }
+
+    };
+
+  } // namespace sdf
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_SDF_SDF_BATCH_COLLISION_QUERY_H
+#endif
@@ -12,6 +12,7 @@
 #include <OpenTissue/core/containers/grid/util/grid_enclosing_indices.h>
 #include <OpenTissue/core/containers/grid/util/grid_gradient_at_point.h>
 #include <OpenTissue/core/containers/grid/util/grid_value_at_point.h>
+#include <OpenTissue/core/containers/grid/util/grid_mip_pyramid.h>
 
 namespace OpenTissue
 {
@@ -132,8 +133,13 @@ namespace OpenTissue
 
         if(phi.min_coord() <= center &&  center <= phi.max_coord())
         {
-          //--- Sphere center inside map grid, test to see if sphere
-          //--- surface crosses zero-level set
+          //--- Sphere center inside map grid, first see if the coarse
+          //--- levels can prove that the sphere is far from the zero-level
+          //--- set (empty pyramids never cull)
+          if(OpenTissue::grid::pyramid_lower_bound(geometry.m_pyramid, center, tst) >= tst)
+            return false;
+
+          //--- Test to see if sphere surface crosses zero-level set
           size_t i0,j0,k0,i1,j1,k1;
           OpenTissue::grid::enclosing_indices(phi, center, i0, j0, k0, i1, j1, k1);
 
@@ -214,7 +220,11 @@ namespace OpenTissue
 
         if(phi.min_coord() <= center &&  center <= phi.max_coord())
         {
-          //--- sampling point inside map grid
+          //--- sampling point inside map grid, skip it if the coarse
+          //--- levels shows it is outside the collision envelope
+          if(OpenTissue::grid::pyramid_lower_bound(geometry.m_pyramid, center, m_envelope) > m_envelope)
+            return;
+
           size_t i0,j0,k0,i1,j1,k1;
           OpenTissue::grid::enclosing_indices(phi, center, i0, j0, k0, i1, j1, k1);
 
@@ -14,10 +14,12 @@
 #include <OpenTissue/collision/collision_geometry_interface.h>
 #include <OpenTissue/core/geometry/geometry_sphere.h>
 #include <OpenTissue/core/geometry/geometry_compute_obb_aabb.h>
+#include <OpenTissue/core/containers/grid/grid.h>
 #include <OpenTissue/utility/utility_class_id.h>
 
 
 #include <list>
+#include <vector>
 
 namespace OpenTissue
 {
@@ -38,6 +40,12 @@ namespace OpenTissue
     * signed distance value at the sample points position, the contact normal
     * is the gradient of the signed distance map the sample position, and the
     * location of the contact points is given by the sample position.
+    *
+    * Optionally the geometry can carry a pyramid of conservatively
+    * downsampled distance grids, see grid::compute_mip_pyramid(). If the
+    * pyramid is non-empty then queries use the coarse levels to cull sample
+    * points that are far from the zero level set, and only touch the fine
+    * distance map within the collision envelope.
     */
     template<typename mesh_type_,typename grid_type_>
     class Geometry
@@ -61,6 +69,9 @@ namespace OpenTissue
 
       typedef          bvh::BoundingVolumeHierarchy<sphere_type,vector3_type*>   bvh_type;
 
+      typedef          grid::Grid<typename grid_type::value_type, typename grid_type::math_types>  pyramid_level_type;
+      typedef          std::vector<pyramid_level_type>                                          pyramid_type;
+
     public: //--- kenny 20060420: Maybe these should be protected?
 
       mesh_type             m_mesh;            ///< A pointer to the mesh representing the zero-level set surface of the signed distance field.
@@ -70,6 +81,7 @@ namespace OpenTissue
       vector3_type          m_max_coord;       ///< The AABB corner node with largest coordinates (in BF coords).
       point_container       m_sampling;        ///< A point sampling, representing the zero level set surface of the signed distance map.
       bvh_type              m_bvh;             ///< Sphere BVH (of sample points), used to speed up collision queries.
+      pyramid_type          m_pyramid;         ///< Optional lower bound pyramid of m_phi ordered from fine to coarse, empty if not used.
 
     public:
 
@@ -11,6 +11,7 @@
 
 #include <OpenTissue/collision/sdf/sdf_init_geometry.h>
 #include <OpenTissue/core/containers/grid/util/grid_mesh2phi.h>
+#include <OpenTissue/core/containers/grid/util/grid_sparse_narrow_band.h>
 
 namespace OpenTissue
 {
@@ -94,6 +95,42 @@ namespace OpenTissue
       init_geometry(mesh,phi,edge_resolution,face_sampling,geometry);
     }
 
+    /**
+    * Initialize narrow band signed distance field geometry.
+    *
+    * The grid type of the geometry must be a OpenTissue::grid::SparseGrid.
+    * Only a narrow band around the surface is stored, which makes it possible
+    * to use far higher resolutions than with a dense grid. Penetrations
+    * deeper than the band size can not be resolved.
+    *
+    * @param mesh              The surface mesh (corresponds to the zero-level set of the signed distance field).
+    * @param edge_resolution   Threshold value, indicating the sampling
+    *                          resolution along edges. If zero it will be
+    *                          computed on the fly, to match the resolution
+    *                          of the signed distance field.
+    *
+    * @param face_sampling     Boolean flag indicating whether face sampling is on or off.
+    * @param geometry          Upon return this argument holds the signed distance field geometry.
+    * @param bandsize          The width of the narrow band.
+    * @param resolution        The number of grid nodes along the longest side of the signed distance field.
+    */
+    template<typename mesh_type,typename sdf_geometry_type>
+    void semiauto_init_narrow_band_geometry(
+      mesh_type /*const*/ & mesh
+      , double edge_resolution
+      , bool face_sampling
+      , sdf_geometry_type & geometry
+      , double bandsize
+      , unsigned int resolution
+      )
+    {
+      typedef typename sdf_geometry_type::grid_type                        grid_type;
+
+      grid_type phi;
+      OpenTissue::grid::mesh2phi_narrow_band(mesh,phi, bandsize, resolution);
+      init_geometry(mesh,phi,edge_resolution,face_sampling,geometry);
+    }
+
   } // namespace sdf
 
 } // namespace OpenTissue
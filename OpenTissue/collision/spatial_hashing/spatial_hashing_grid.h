@@ -321,6 +321,15 @@ namespace OpenTissue
       {
         ++m_time_stamp; //--- Lazy deallocation
       }
+
+      /**
+      * Flush Added Data.
+      * Data is stored in the hash cells immediately when added, so
+      * there is nothing to do. The method is invoked by the queries
+      * after data has been mapped, grids that defers storing data
+      * (see PackedGrid) builds their hash cells here.
+      */
+      void flush() {}
     };
 
   } // namespace spatial_hashing
@@ -0,0 +1,417 @@
+#ifndef OPENTISSUE_COLLISION_SPATIAL_HASHING_SPATIAL_HASHING_PACKED_GRID_H
+#define OPENTISSUE_COLLISION_SPATIAL_HASHING_SPATIAL_HASHING_PACKED_GRID_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/utility/utility_openmp.h>
+
+#include <boost/iterator/indirect_iterator.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace spatial_hashing
+  {
+
+    /**
+    * Packed Hash Grid.
+    * This class is a drop-in replacement for the hash grid class Grid, it
+    * has the same template arguments and supports the same interface, so it
+    * can be used with the PointDataQuery, LineDataQuery and AABBDataQuery
+    * classes.
+    *
+    * The difference lies in how data is stored. Grid keeps a growing
+    * container of data pointers in every hash cell. This grid stores all
+    * data pointers of all hash cells in one contiguous array, with the
+    * data of each hash cell being a consecutive range of this array.
+    *
+    * Data is mapped into the grid in two passes. While data is added, the
+    * hash keys and data pointers are simply appended to a staging
+    * array. When all data has been added, flush() is invoked (the queries
+    * does this automatically) and a counting sort is used to build
+    * the packed array: the number of data pointers in each hash cell is
+    * counted, a prefix sum of the counts gives the offset of each hash
+    * cell, and finally the data pointers are scattered into their
+    * hash cells. The counting and scattering is done in parallel when
+    * OpenMP is enabled.
+    *
+    * This is beneficial when the grid is rebuilt from scratch every time step,
+    * as in particle systems. Here the contiguous storage avoids per-cell
+    * memory management and gives a good memory locality when traversing
+    * hash cells during queries.
+    *
+    * Observe that data added to the grid is not visible in the hash cells
+    * before flush() has been invoked.
+    */
+    template <
+      typename real_vector3
+      , typename int_vector3
+      , typename data_type_
+      , typename hash_function_type
+    >
+    class PackedGrid
+    {
+    public:
+      typedef          data_type_                                   data_type;
+      typedef typename real_vector3::value_type                     real_type;
+      typedef          int_vector3                                  triplet_type;   ///< Type of discretized points.
+      typedef          real_vector3                                 point_type;     ///< Type of continuous points.
+
+    protected:
+
+      typedef std::vector<data_type*>                               data_ptr_container;
+      typedef typename data_ptr_container::iterator                 data_ptr_iterator;
+      typedef std::vector<size_t>                                   index_container;
+
+    protected:
+
+      class Cell
+      {
+      public:
+
+        typedef boost::indirect_iterator<data_ptr_iterator,data_type> data_iterator;
+
+      public:
+
+        PackedGrid  * m_owner;        ///< The hash table the cell belongs to.
+        size_t        m_query_stamp;  ///< Timestamp, used to guard against hash-collisions.
+
+      public:
+
+        Cell()
+          : m_owner(0)
+          , m_query_stamp(0)
+        {}
+
+        Cell( PackedGrid * owner )
+          : m_owner(owner)
+          , m_query_stamp(0)
+        {}
+
+      public:
+
+        /**
+        * Get Hash Key.
+        *
+        * @return   The index of this hash cell in the hash table.
+        */
+        size_t index() const
+        {
+          assert(m_owner);
+          return static_cast<size_t>( this - &(m_owner->m_cells[0]) );
+        }
+
+        data_iterator begin()
+        {
+          assert(m_owner);
+          return data_iterator( m_owner->m_packed.begin() + m_owner->m_offsets[ index() ] );
+        }
+
+        data_iterator end()
+        {
+          assert(m_owner);
+          size_t const key = index();
+          return data_iterator( m_owner->m_packed.begin() + m_owner->m_offsets[ key ] + m_owner->m_counts[ key ] );
+        }
+
+      public:
+
+        /**
+        * Add Data.
+        * The data is staged and will not be stored in the cell before
+        * the owner grid is flushed.
+        */
+        void add(data_type const & data)
+        {
+          assert(m_owner);
+          m_owner->m_staged_keys.push_back( index() );
+          m_owner->m_staged_data.push_back( const_cast<data_type*>(&data) );
+        }
+
+        bool remove(data_type & data)
+        {
+          assert(m_owner || !"Cell::remove(): owner was null");
+
+          data_type * tmp  = &data;
+          size_t const key = index();
+
+          //--- Swap the data pointer with the last one in the range of the cell and shrink the range.
+          size_t const first = m_owner->m_offsets[ key ];
+          size_t const last  = first + m_owner->m_counts[ key ];
+          for(size_t i = first; i < last; ++i)
+          {
+            if( m_owner->m_packed[i] == tmp )
+            {
+              m_owner->m_packed[i] = m_owner->m_packed[last-1];
+              m_owner->m_packed[last-1] = 0;
+              --(m_owner->m_counts[ key ]);
+              return true;
+            }
+          }
+
+          //--- The data may have been added but not yet flushed.
+          for(size_t i = 0; i < m_owner->m_staged_keys.size(); ++i)
+          {
+            if( m_owner->m_staged_keys[i] == key && m_owner->m_staged_data[i] == tmp )
+            {
+              m_owner->m_staged_keys[i] = m_owner->m_staged_keys.back();
+              m_owner->m_staged_data[i] = m_owner->m_staged_data.back();
+              m_owner->m_staged_keys.pop_back();
+              m_owner->m_staged_data.pop_back();
+              return true;
+            }
+          }
+          return false;
+        }
+
+        bool empty() const
+        {
+          assert(m_owner);
+          return m_owner->m_counts[ index() ] == 0;
+        }
+
+        size_t size() const
+        {
+          assert(m_owner);
+          return m_owner->m_counts[ index() ];
+        }
+      };
+
+    public:
+
+      typedef Cell                                  cell_type;
+      typedef typename std::vector< cell_type >     cell_storage;
+
+    protected:
+
+      real_type               m_delta;            ///< Grid cell spacing.
+      hash_function_type      m_hash_function;
+      cell_storage            m_cells;            ///< Hash table cells.
+      index_container         m_offsets;          ///< Index of first data pointer of each hash cell in m_packed.
+      index_container         m_counts;           ///< Number of data pointers of each hash cell.
+      data_ptr_container      m_packed;           ///< Data pointers of all hash cells, sorted by hash key.
+      index_container         m_staged_keys;      ///< Hash keys of data added since last flush.
+      data_ptr_container      m_staged_data;      ///< Data pointers added since last flush.
+      index_container         m_histograms;       ///< Per-thread hash cell counters used by the counting sort.
+
+    public:
+
+      typedef typename cell_storage::iterator cell_iterator;
+
+      cell_iterator begin(){return m_cells.begin();}
+      cell_iterator end(){return m_cells.end();}
+
+    public:
+
+      PackedGrid( )
+        : m_delta(5.0)
+      {
+        resize(1000);
+      }
+
+      PackedGrid( size_t size )
+        : m_delta(5.0)
+      {
+        resize( size );
+      }
+
+      /**
+      * Copy Constructor.
+      * Cells refer back to their owner, so they can not simply be copied.
+      */
+      PackedGrid( PackedGrid const & grid )
+        : m_delta( grid.m_delta )
+        , m_hash_function( grid.m_hash_function )
+      {
+        resize( grid.size() );
+      }
+
+      PackedGrid & operator=( PackedGrid const & grid )
+      {
+        m_delta = grid.m_delta;
+        m_hash_function = grid.m_hash_function;
+        resize( grid.size() );
+        return *this;
+      }
+
+    public:
+
+      /**
+      * Resize Hash Table.
+      * Observe that any data stored in the grid is discarded, since it
+      * is stored under hash keys that are no longer valid.
+      */
+      void resize( size_t size )
+      {
+        m_hash_function.resize(size);
+        m_cells.clear();
+        m_cells.resize( m_hash_function.size(), Cell(this) );
+        m_offsets.resize( m_hash_function.size() );
+        m_counts.resize( m_hash_function.size() );
+        clear();
+      }
+
+      size_t size( ) const  { return m_hash_function.size(); }
+
+      /**
+      * Set Grid Cell Spacing.
+      * See Grid::set_spacing for details.
+      *
+      * @param delta   The new grid cell spacing size, must be a positive number.
+      */
+      void set_spacing( real_type delta )
+      {
+        assert( delta > 0 );
+        m_delta = delta;
+      }
+
+      real_type get_spacing( ) const { return m_delta; }
+
+      /**
+      * Point Discretization.
+      *
+      * @param p   A 3D point in continious space
+      *
+      * @return    A discretized point identifying the grid
+      *            cell (not the hash cell!) which the contineous
+      *            point lies inside.
+      */
+      triplet_type get_triplet( point_type const & point )const
+      {
+        typedef typename triplet_type::value_type value_type;
+        assert( m_delta > 0 );
+        return triplet_type(
+          static_cast<value_type>( std::floor( point(0) / m_delta ) ),
+          static_cast<value_type>( std::floor( point(1) / m_delta ) ),
+          static_cast<value_type>( std::floor( point(2) / m_delta ) )
+          );
+      }
+
+      /**
+      * Find the hash cell containing the grid cell enclosing the continuous point.
+      */
+      cell_type & get_cell(point_type const & p)
+      {
+        triplet_type triplet = get_triplet(p);
+        size_t hash_key = m_hash_function( triplet(0), triplet(1), triplet(2) );
+        return m_cells[ hash_key ];
+      }
+
+      /**
+      * Find the hash cell containing the grid cell enclosing the discretized point.
+      */
+      cell_type & get_cell(triplet_type const & triplet)
+      {
+        size_t hash_key = m_hash_function( triplet(0), triplet(1), triplet(2) );
+        return m_cells[ hash_key ];
+      }
+
+      void clear()
+      {
+        m_packed.clear();
+        m_staged_keys.clear();
+        m_staged_data.clear();
+        std::fill( m_offsets.begin(), m_offsets.end(), 0u );
+        std::fill( m_counts.begin(), m_counts.end(), 0u );
+      }
+
+      /**
+      * Flush Staged Data.
+      * Builds the packed data array from all data currently stored in the
+      * grid and all data added since last flush. This is done by a
+      * counting sort on the hash keys.
+      */
+      void flush()
+      {
+        if( m_staged_keys.empty() )
+          return;
+
+        //--- Data already stored in the grid is re-staged in front of the new data, such that add_data-style incremental
+        //--- mapping keeps the order of insertion within each hash cell.
+        if( !m_packed.empty() )
+        {
+          index_container    keys;
+          data_ptr_container data;
+          keys.reserve( m_packed.size() + m_staged_keys.size() );
+          data.reserve( m_packed.size() + m_staged_keys.size() );
+          for(size_t key = 0; key < m_cells.size(); ++key)
+          {
+            for(size_t i = m_offsets[key]; i < m_offsets[key] + m_counts[key]; ++i)
+            {
+              keys.push_back( key );
+              data.push_back( m_packed[i] );
+            }
+          }
+          keys.insert( keys.end(), m_staged_keys.begin(), m_staged_keys.end() );
+          data.insert( data.end(), m_staged_data.begin(), m_staged_data.end() );
+          m_staged_keys.swap( keys );
+          m_staged_data.swap( data );
+        }
+
+        int    const N = static_cast<int>( m_staged_keys.size() );
+        size_t const C = m_cells.size();
+
+        //--- Only go parallel if each thread gets a reasonable amount of work
+        int const T = std::max( 1, std::min( utility::get_max_threads(), N / 4096 ) );
+
+        m_packed.resize( N );
+        m_histograms.resize( T*C );
+
+#pragma omp parallel num_threads(T)
+        {
+          int const t     = utility::get_thread_num();
+          int const first = static_cast<int>( (static_cast<long long>(N)*t)/T );
+          int const last  = static_cast<int>( (static_cast<long long>(N)*(t+1))/T );
+          size_t * histogram = &m_histograms[ t*C ];
+
+          //--- First pass, count number of data pointers in each hash cell
+          std::fill( histogram, histogram + C, 0u );
+          for(int i = first; i < last; ++i)
+            ++histogram[ m_staged_keys[i] ];
+
+#pragma omp barrier
+#pragma omp single
+          {
+            //--- Prefix sum over (hash cell, thread) pairs, afterwards each
+            //--- histogram entry holds the position where the thread
+            //--- should start writing data pointers of the hash cell.
+            size_t offset = 0;
+            for(size_t key = 0; key < C; ++key)
+            {
+              m_offsets[key] = offset;
+              for(int s = 0; s < T; ++s)
+              {
+                size_t const count = m_histograms[ s*C + key ];
+                m_histograms[ s*C + key ] = offset;
+                offset += count;
+              }
+              m_counts[key] = offset - m_offsets[key];
+            }
+          }
+
+          //--- Second pass, scatter data pointers into their hash cells
+          for(int i = first; i < last; ++i)
+            m_packed[ histogram[ m_staged_keys[i] ]++ ] = m_staged_data[i];
+        }
+
+        m_staged_keys.clear();
+        m_staged_data.clear();
+      }
+    };
+
+  } // namespace spatial_hashing
+
+} // namespace OpenTissue
+
+// OPENTISSUE_COLLISION_SPATIAL_HASHING_SPATIAL_HASHING_PACKED_GRID_H
+#endif
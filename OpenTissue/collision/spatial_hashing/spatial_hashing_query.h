@@ -9,10 +9,16 @@
 //
 #include <OpenTissue/configuration.h>
 
+#include <OpenTissue/utility/utility_openmp.h>
+
 #include <boost/cast.hpp> // needed for boost::numeric_cast
 
 #include <list>
 #include <map>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
 #include <cassert>
 
 namespace OpenTissue
@@ -74,6 +80,8 @@ namespace OpenTissue
     *    cell_iterator  end()
     *    triplet_point get_triplet(point_type)
     *    cell_type & get_cell(triplet_type)
+    *    clear()
+    *    flush()
     *
     *  Hash cells must support the following interface:
     *
@@ -151,6 +159,7 @@ namespace OpenTissue
         child_type & self = static_cast<child_type &>(*this);
         this->clear();
         self.first_pass(d0,d1);
+        hash_grid::flush();
 
         collision_policy::reset(results);
         init_query();
@@ -231,6 +240,7 @@ namespace OpenTissue
         child_type & self = static_cast<child_type &>(*this);
         this->clear();
         self.first_pass(d0,d1);
+        hash_grid::flush();
         init_query();
       }
 
@@ -246,6 +256,7 @@ namespace OpenTissue
       {
         child_type & self = static_cast<child_type &>(*this);
         self.first_pass(d0,d1);
+        hash_grid::flush();
       }
 
       template< typename data_iterator  >
@@ -253,6 +264,106 @@ namespace OpenTissue
       {
         child_type & self = static_cast<child_type &>(*this);
         self.remove_data(d0,d1);
+        hash_grid::flush();
+      }
+
+      /**
+      * Batched Query.
+      * This method runs all queries in one go on any previous mapped data and
+      * returns the results in compressed row storage (CSR) form. That is
+      * the data overlapping the i'th query object are given by
+      *
+      *   hits[ offsets[i] ] , ..., hits[ offsets[i+1] - 1 ]
+      *
+      * Rather than invoking collision_policy::reset and collision_policy::report,
+      * the batched query requires the collision policy to supply the method
+      *
+      *   bool overlap(data_type, query_type) const
+      *
+      * which should return true if the data and query objects collide. The
+      * method must be thread-safe, since queries are run in parallel when
+      * OpenMP is enabled. Queries are processed in the order of the hash
+      * cells they start in, such that consecutive queries tend to visit the same
+      * hash cells.
+      *
+      * Prior to invoking this method either data should have been mapped into
+      * grid by using the init_data method, or a full query should have
+      * been performed.
+      *
+      * @param q0        Iterator to position of first query object.
+      * @param q1        Iterator to position one past last query object.
+      * @param offsets   Upon return contains the offsets into hits for each query, the size is one plus number of queries.
+      * @param hits      Upon return contains pointers to the data overlapping the queries.
+      * @param type      This argument specifies the report type, possible types are all_tag or no_collisions_tag.
+      */
+      template< typename query_iterator, typename offset_container, typename hit_container, typename report_type >
+      void batch(
+        query_iterator q0
+        , query_iterator q1
+        , offset_container & offsets
+        , hit_container & hits
+        , report_type const & type
+        )
+      {
+        typedef typename std::iterator_traits<query_iterator>::value_type   query_type;
+        typedef std::pair<size_t, size_t>                                   key_type;
+
+        std::vector<query_type const *> queries;
+        for(query_iterator q=q0;q!=q1;++q)
+          queries.push_back( &(*q) );
+
+        int const N = static_cast<int>( queries.size() );
+
+        //--- Sort queries by the hash cell of their minimum corner
+        cell_type const * first_cell = &(*this->begin());
+        std::vector<key_type> order( N );
+        for(int i = 0; i < N; ++i)
+        {
+          cell_type & cell = hash_grid::get_cell( hash_grid::get_triplet( collision_policy::min_coord( *queries[i] ) ) );
+          order[i] = key_type( static_cast<size_t>( &cell - first_cell ), i );
+        }
+        std::sort( order.begin(), order.end() );
+
+        int const T = std::max( 1, std::min( utility::get_max_threads(), N / 64 ) );
+
+        std::vector<size_t> counts( N, 0u );
+        std::vector<size_t> starts( N, 0u );
+        std::vector<int>    owner( N, 0 );
+        std::vector< std::vector<data_type *> > thread_hits( T );
+
+#pragma omp parallel num_threads(T)
+        {
+          int const t     = utility::get_thread_num();
+          int const first = static_cast<int>( (static_cast<long long>(N)*t)/T );
+          int const last  = static_cast<int>( (static_cast<long long>(N)*(t+1))/T );
+
+          std::vector<data_type *> & local = thread_hits[t];
+          std::vector<size_t>        visited;
+
+          for(int s = first; s < last; ++s)
+          {
+            size_t const i = order[s].second;
+            owner[i]  = t;
+            starts[i] = local.size();
+            batch_query( *queries[i], local, visited, type );
+            counts[i] = local.size() - starts[i];
+          }
+        }
+
+        //--- Assemble results in the order of the query objects
+        offsets.resize( N + 1 );
+        offsets[0] = 0;
+        for(int i = 0; i < N; ++i)
+          offsets[i+1] = offsets[i] + counts[i];
+        hits.resize( offsets[N] );
+
+#pragma omp parallel for num_threads(T)
+        for(int i = 0; i < N; ++i)
+        {
+          std::vector<data_type *> const & local = thread_hits[ owner[i] ];
+          for(size_t j = 0; j < counts[i]; ++j)
+            hits[ offsets[i] + j ] = local[ starts[i] + j ];
+        }
       }
 
       /**
@@ -384,6 +495,62 @@ namespace OpenTissue
             }
       }
 
+      template< typename query_type >
+      void batch_query(query_type const & query, std::vector<data_type *> & hits, std::vector<size_t> & visited, no_collisions_tag )
+      {
+        size_t const start = hits.size();
+        batch_query( query, hits, visited, all_tag() );
+
+        //--- Remove data found in more than one hash cell
+        std::sort( hits.begin() + start, hits.end() );
+        hits.erase( std::unique( hits.begin() + start, hits.end() ), hits.end() );
+      }
+
+      /**
+      * Batched Query Traversal.
+      * Unlike query(), hash collisions are guarded against by keeping a list of
+      * visited hash cells rather than using the query stamps of the
+      * cells. Thereby the method does not write to the hash grid and
+      * can be invoked concurrently.
+      */
+      template< typename query_type >
+      void batch_query(query_type const & query, std::vector<data_type *> & hits, std::vector<size_t> & visited, all_tag )
+      {
+        point_type       min_corner = collision_policy::min_coord(query);  //--- by collision policy
+        point_type       max_corner = collision_policy::max_coord(query);  //--- by collision policy
+        triplet_type     m          = hash_grid::get_triplet(min_corner);
+        triplet_type     M          = hash_grid::get_triplet(max_corner);
+
+        assert( m(0) <= M(0) || !"Minimum was larger than maximum");
+        assert( m(1) <= M(1) || !"Minimum was larger than maximum");
+        assert( m(2) <= M(2) || !"Minimum was larger than maximum");
+
+        cell_type const * first_cell = &(*this->begin());
+
+        visited.clear();
+        triplet_type     triplet(m);
+        for ( triplet(0)= m(0) ; triplet(0) <= M(0); ++triplet(0) )
+          for ( triplet(1)= m(1) ; triplet(1) <= M(1); ++triplet(1) )
+            for ( triplet(2)= m(2) ; triplet(2) <= M(2); ++triplet(2) )
+            {
+              cell_type & cell = hash_grid::get_cell(triplet);
+
+              if(cell.empty())
+                continue;
+
+              size_t const key = static_cast<size_t>( &cell - first_cell );
+              if( std::find( visited.begin(), visited.end(), key ) != visited.end() )
+                continue;
+              visited.push_back( key );
+
+              typename cell_type::data_iterator Dbegin = cell.begin();
+              typename cell_type::data_iterator Dend = cell.end();
+              for(typename cell_type::data_iterator data = Dbegin;data!=Dend;++data)
+                if( collision_policy::overlap( (*data), query ) )
+                  hits.push_back( &(*data) );
+            }
+      }
+
     };
 
   } // namespace spatial_hashing
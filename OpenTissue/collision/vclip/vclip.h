@@ -10,10 +10,13 @@
 #include <OpenTissue/configuration.h>
 
 #include <OpenTissue/collision/vclip/vclip_mesh.h>
+#include <OpenTissue/collision/vclip/vclip_cache.h>
+#include <OpenTissue/collision/vclip/vclip_geometry.h>
 #include <OpenTissue/core/math/math_coordsys.h>
 
 #include <vector>
 #include <cmath>
+#include <stdexcept>
 
 namespace OpenTissue
 {
@@ -184,7 +187,8 @@ namespace OpenTissue
 
         cpA = vA->m_coord;
         cpB = vB->m_coord;
-        vector3_type diff = cpA-cpB;
+        //--- p holds vA in the model frame of B
+        vector3_type diff = p-cpB;
         m_distance = std::sqrt( diff*diff );
         //--- VA and VB could be in touching contact.
         return (m_distance>0)?DISJOINT:PENETRATION;
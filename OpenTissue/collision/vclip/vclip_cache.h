@@ -0,0 +1,122 @@
+#ifndef OPENTISSUE_COLLISION_VCLIP_VCLIP_CACHE_H
+#define OPENTISSUE_COLLISION_VCLIP_VCLIP_CACHE_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/vclip/vclip_mesh.h>
+
+namespace OpenTissue
+{
+  namespace vclip
+  {
+
+    /**
+    * Per Pair V-Clip Cache.
+    * This class stores the closest feature pair found by the v-clip algorithm,
+    * such that the features can be used to seed the algorithm on the same pair
+    * of objects in the next frame. When the objects move only a little between
+    * frames the cached features are still the closest features or they are
+    * close neighbors of these, and v-clip terminates in a few iterations.
+    *
+    * The meshes are stored together with the features. This way the cache
+    * can be queried with the objects in any order, and a cache that belongs
+    * to another pair of meshes is never used.
+    *
+    * A cache is meant to live with a pair of objects, for instance on an
+    * edge in a contact graph. It must be cleared whenever the meshes of the
+    * objects are changed, since the features are pointers into the meshes.
+    */
+    class Cache
+    {
+    public:
+
+      vclip_mesh_type const * m_mesh_A;      ///< The mesh that feature A belongs to.
+      vclip_mesh_type const * m_mesh_B;      ///< The mesh that feature B belongs to.
+      Feature               * m_feature_A;   ///< The closest feature on mesh A found in the last query.
+      Feature               * m_feature_B;   ///< The closest feature on mesh B found in the last query.
+
+    public:
+
+      Cache()
+        : m_mesh_A(0)
+        , m_mesh_B(0)
+        , m_feature_A(0)
+        , m_feature_B(0)
+      {}
+
+    public:
+
+      void clear()
+      {
+        m_mesh_A    = 0;
+        m_mesh_B    = 0;
+        m_feature_A = 0;
+        m_feature_B = 0;
+      }
+
+      bool empty() const { return m_feature_A == 0 || m_feature_B == 0; }
+
+      /**
+      * Get Seed Features.
+      *
+      * @param mesh_A   The mesh of object A.
+      * @param mesh_B   The mesh of object B.
+      * @param seed_A   Upon return holds the cached feature of mesh A, if the cache
+      *                 holds features of the two meshes. Otherwise it is unchanged.
+      * @param seed_B   Upon return holds the cached feature of mesh B, if the cache
+      *                 holds features of the two meshes. Otherwise it is unchanged.
+      *
+      * @return         If the cache held features of the two meshes then the return
+      *                 value is true otherwise it is false.
+      */
+      bool get_seeds(
+        vclip_mesh_type const * mesh_A
+        , vclip_mesh_type const * mesh_B
+        , Feature * & seed_A
+        , Feature * & seed_B
+        ) const
+      {
+        if(empty())
+          return false;
+        if(m_mesh_A == mesh_A && m_mesh_B == mesh_B)
+        {
+          seed_A = m_feature_A;
+          seed_B = m_feature_B;
+          return true;
+        }
+        if(m_mesh_A == mesh_B && m_mesh_B == mesh_A)
+        {
+          seed_A = m_feature_B;
+          seed_B = m_feature_A;
+          return true;
+        }
+        return false;
+      }
+
+      void set_seeds(
+        vclip_mesh_type const * mesh_A
+        , vclip_mesh_type const * mesh_B
+        , Feature * seed_A
+        , Feature * seed_B
+        )
+      {
+        m_mesh_A    = mesh_A;
+        m_mesh_B    = mesh_B;
+        m_feature_A = seed_A;
+        m_feature_B = seed_B;
+      }
+
+    };
+
+  } // namespace vclip
+
+} // namespace OpenTissue
+
+//OPENTISSUE_COLLISION_VCLIP_VCLIP_CACHE_H
+#endif
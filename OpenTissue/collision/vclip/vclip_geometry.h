@@ -0,0 +1,196 @@
+#ifndef OPENTISSUE_COLLISION_VCLIP_VCLIP_GEOMETRY_H
+#define OPENTISSUE_COLLISION_VCLIP_VCLIP_GEOMETRY_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/vclip/vclip_mesh.h>
+#include <OpenTissue/core/geometry/geometry_base_shape.h>
+#include <OpenTissue/utility/utility_class_id.h>
+#include <OpenTissue/core/math/math_constants.h>
+
+#include <vector>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace vclip
+  {
+
+    /**
+    * V-Clip Geometry.
+    * A convex polyhedron represented by a vclip mesh. This geometry type can be
+    * used in collision detection engines that dispatch on geometry types,
+    * such as the narrow phase of the multibody dynamics engine.
+    *
+    * The geometry also provides a support mapping, such that the same shape
+    * can be used with GJK. The support point is found by hill climbing along
+    * the edges of the polyhedron, which is exact since the polyhedron is convex.
+    */
+    template<typename math_types_>
+    class Geometry
+      : public OpenTissue::geometry::BaseShape< math_types_ >
+      , public OpenTissue::utility::ClassID< Geometry<math_types_> >
+    {
+    public:
+
+      typedef          math_types_                           math_types;
+      typedef typename math_types::real_type                 real_type;
+      typedef typename math_types::vector3_type              vector3_type;
+      typedef typename math_types::matrix3x3_type            matrix3x3_type;
+      typedef typename math_types::value_traits              value_traits;
+      typedef          vclip_mesh_type                       mesh_type;
+      typedef typename mesh_type::vertex_type                vertex_type;
+      typedef typename mesh_type::math_types::vector3_type   mesh_vector3_type;
+
+    protected:
+
+      mesh_type  m_mesh;   ///< The vclip mesh, given in the model frame of the geometry.
+
+    public:
+
+      size_t const class_id() const { return OpenTissue::utility::ClassID< Geometry<math_types_> >::class_id(); }
+
+      virtual ~Geometry() {}
+
+    public:
+
+      /**
+      * Initialize Geometry.
+      * The geometry is set to the convex hull of the vertices of the given mesh.
+      *
+      * @param mesh   Any mesh type with vertex coordinates.
+      */
+      template<typename other_mesh_type>
+      bool init(other_mesh_type const & mesh)
+      {
+        return vclip::convert( mesh, m_mesh );
+      }
+
+      mesh_type const & get_mesh() const { return m_mesh; }
+
+      /**
+      * Get Seed Feature.
+      *
+      * @return   A feature that can be used to cold start the v-clip algorithm.
+      */
+      Feature * get_seed() const
+      {
+        assert( m_mesh.size_vertices() > 0 || !"Geometry::get_seed(): mesh was empty");
+        return const_cast<vertex_type *>( &( *(m_mesh.vertex_begin()) ) );
+      }
+
+    public:
+
+      void compute_collision_aabb(
+        vector3_type const & r
+        , matrix3x3_type const & R
+        , vector3_type & min_coord
+        , vector3_type & max_coord
+        ) const
+      {
+        min_coord = vector3_type( math::detail::highest<real_type>(), math::detail::highest<real_type>(), math::detail::highest<real_type>() );
+        max_coord = vector3_type( math::detail::lowest<real_type>(), math::detail::lowest<real_type>(), math::detail::lowest<real_type>() );
+
+        typename mesh_type::const_vertex_iterator v   = m_mesh.vertex_begin();
+        typename mesh_type::const_vertex_iterator end = m_mesh.vertex_end();
+        for(;v!=end;++v)
+        {
+          vector3_type const p = R*convert_vector(v->m_coord) + r;
+          min_coord = min( min_coord, p );
+          max_coord = max( max_coord, p );
+        }
+      }
+
+      void compute_surface_points(std::vector<vector3_type> & points) const
+      {
+        typename mesh_type::const_vertex_iterator v   = m_mesh.vertex_begin();
+        typename mesh_type::const_vertex_iterator end = m_mesh.vertex_end();
+        for(;v!=end;++v)
+          points.push_back( convert_vector(v->m_coord) );
+      }
+
+      vector3_type get_support_point(vector3_type const & v) const
+      {
+        mesh_vector3_type const s = mesh_vector3_type( v(0), v(1), v(2) );
+
+        vertex_type const * best = &( *(m_mesh.vertex_begin()) );
+        typename mesh_type::math_types::real_type best_value = best->m_coord * s;
+
+        bool improved = true;
+        while(improved)
+        {
+          improved = false;
+          typename mesh_type::const_vertex_halfedge_circulator h(*best), end;
+          for(;h!=end;++h)
+          {
+            vertex_type const * w = &( *(h->get_destination_iterator()) );
+            typename mesh_type::math_types::real_type const value = w->m_coord * s;
+            if(value > best_value)
+            {
+              best       = w;
+              best_value = value;
+              improved   = true;
+            }
+          }
+        }
+        return convert_vector( best->m_coord );
+      }
+
+      /**
+      * Support Functor.
+      * This makes it possible to use the geometry directly with GJK.
+      */
+      vector3_type operator()(vector3_type const & v) const { return get_support_point(v); }
+
+      void translate(vector3_type const & T)
+      {
+        mesh_vector3_type const t = mesh_vector3_type( T(0), T(1), T(2) );
+        typename mesh_type::vertex_iterator v   = m_mesh.vertex_begin();
+        typename mesh_type::vertex_iterator end = m_mesh.vertex_end();
+        for(;v!=end;++v)
+          v->m_coord += t;
+        update_voronoi_regions( m_mesh );
+      }
+
+      void rotate(matrix3x3_type const & R)
+      {
+        typename mesh_type::vertex_iterator v   = m_mesh.vertex_begin();
+        typename mesh_type::vertex_iterator end = m_mesh.vertex_end();
+        for(;v!=end;++v)
+        {
+          vector3_type const p = R*convert_vector( v->m_coord );
+          v->m_coord = mesh_vector3_type( p(0), p(1), p(2) );
+        }
+        update_voronoi_regions( m_mesh );
+      }
+
+      void scale(real_type const & s)
+      {
+        typename mesh_type::vertex_iterator v   = m_mesh.vertex_begin();
+        typename mesh_type::vertex_iterator end = m_mesh.vertex_end();
+        for(;v!=end;++v)
+          v->m_coord *= s;
+        update_voronoi_regions( m_mesh );
+      }
+
+    protected:
+
+      static vector3_type convert_vector(mesh_vector3_type const & p)
+      {
+        return vector3_type( static_cast<real_type>( p(0) ), static_cast<real_type>( p(1) ), static_cast<real_type>( p(2) ) );
+      }
+
+    };
+
+  } // namespace vclip
+
+} // namespace OpenTissue
+
+//OPENTISSUE_COLLISION_VCLIP_VCLIP_GEOMETRY_H
+#endif
@@ -136,7 +136,7 @@ namespace OpenTissue
     *
     * @param mesh
     */
-    void update_voronoi_regions(vclip_mesh_type & mesh)
+    inline void update_voronoi_regions(vclip_mesh_type & mesh)
     {
       vclip_mesh_type::halfedge_iterator h    = mesh.halfedge_begin();
       vclip_mesh_type::halfedge_iterator hend = mesh.halfedge_end();
@@ -57,6 +57,7 @@ namespace OpenTissue
       value_type * m_value;
       value_type * m_value_end;
       value_type   m_infinity;     ///< Value specifying unused grid nodes.
+      bool         m_external;     ///< Boolean flag indicating whether the node values are owned by someone else, see wrap().
 
     public:
 
@@ -76,6 +77,7 @@ namespace OpenTissue
         , m_value(0)
         , m_value_end(0)
         , m_infinity( math::detail::highest<T>() )
+        , m_external(false)
       {}
 
       /**
@@ -92,6 +94,7 @@ namespace OpenTissue
         , m_delta(value_traits::zero(),value_traits::zero(),value_traits::zero())
         , m_value(0)
         , m_value_end(0)
+        , m_external(false)
       {
         m_infinity = unused_val;
       }
@@ -106,19 +109,30 @@ namespace OpenTissue
         , m_value(0)
         , m_value_end(0)
         , m_infinity( G.unused() )
+        , m_external(false)
       {
         *this = G;
       }
 
       ~Grid() 
       { 
-        if(m_value) 
+        if(m_value && !m_external) 
           delete [] m_value; 
       }
 
+      /**
+      * Assignment.
+      * A grid that wraps external data is always detached from it, the
+      * assigned values are copied into values owned by the grid, whatever
+      * the dimensions of the two grids are. Thus the external values are
+      * never written by an assignment.
+      */
       grid_type & operator=(grid_type const & G)
       {
-        bool should_allocate = false;
+        if(&G == this)
+          return (*this);
+
+        bool should_allocate = m_external;
 
         if(m_I != G.m_I)
           should_allocate = true;
@@ -157,6 +171,12 @@ namespace OpenTissue
       {
         size_t new_size = Ival*Jval*Kval;
 
+        if(m_external)
+        {
+          m_value     = 0;
+          m_value_end = 0;
+          m_external  = false;
+        }
         if(m_N != new_size && m_value)
         {
           delete [] m_value;
@@ -181,6 +201,54 @@ namespace OpenTissue
         clear();
       }
 
+      /**
+      * Wrap External Data.
+      * Makes the grid use the given node values without copying them. The
+      * grid never frees the values, so the caller must keep them alive for
+      * as long as the grid uses them. A later call to create(), or assigning
+      * another grid to this grid, makes the grid allocate its own values again.
+      *
+      * This is used to load grids from memory mapped files, see compact_map().
+      *
+      * @param min_coord
+      * @param max_coord
+      * @param Ival
+      * @param Jval
+      * @param Kval
+      * @param values     A pointer to Ival*Jval*Kval node values, using the same layout as data().
+      */
+      void wrap(
+        vector3_type const & min_coord
+        , vector3_type const & max_coord
+        , size_t const & Ival
+        , size_t const & Jval
+        , size_t const & Kval
+        , value_type * values
+        )
+      {
+        if(m_value && !m_external)
+          delete [] m_value;
+        m_I = Ival;
+        m_J = Jval;
+        m_K = Kval;
+        m_N = Ival*Jval*Kval;
+        m_min_coord = min_coord;
+        m_max_coord = max_coord;
+        m_delta(0) = (m_max_coord(0)-m_min_coord(0))/(m_I-1);
+        m_delta(1) = (m_max_coord(1)-m_min_coord(1))/(m_J-1);
+        m_delta(2) = (m_max_coord(2)-m_min_coord(2))/(m_K-1);
+        m_value     = values;
+        m_value_end = m_value + m_N;
+        m_external  = true;
+      }
+
+      /**
+      * Test if the grid wraps external data.
+      *
+      * @return   If the node values are owned by someone else then the return value is true otherwise it is false.
+      */
+      bool external() const { return m_external; }
+
       /**
       * Create a map with given dimensions and place it in center of world.
       *
@@ -0,0 +1,747 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_GRID_SPARSE_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_GRID_SPARSE_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_constants.h>
+#include <OpenTissue/utility/utility_memory_mapped_file.h>
+
+#include <vector>
+#include <string>
+#include <new>
+#include <iterator>
+#include <cassert>
+#include <algorithm>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Sparse Grid Iterator.
+      * Walks through all nodes of a sparse grid in the same order as the
+      * iterators of OpenTissue::grid::Grid, and keeps track of the (i,j,k)
+      * position. Dereferencing a mutable iterator activates the tile of the
+      * node, so read only traversals should use a const_iterator.
+      */
+      template <class grid_type, class reference_type, class grid_pointer>
+      class SparseIterator
+      {
+      public:
+
+        typedef std::bidirectional_iterator_tag         iterator_category;
+        typedef typename grid_type::value_type          value_type;
+        typedef std::ptrdiff_t                          difference_type;
+        typedef value_type *                            pointer;
+        typedef reference_type                          reference;
+
+        typedef typename grid_type::math_types          math_types;
+        typedef typename math_types::vector3_type       vector3_type;
+        typedef typename math_types::index_vector3_type index_vector;
+
+      private:
+
+        typedef SparseIterator<grid_type, reference_type, grid_pointer>  self_type;
+
+      protected:
+
+        grid_pointer  m_grid;
+        size_t        m_pos;    ///< The linear index of the current node.
+        size_t        m_i;
+        size_t        m_j;
+        size_t        m_k;
+
+        void update_indices()
+        {
+          if(m_grid->size() == 0)
+          {
+            m_i = m_j = m_k = 0;
+            return;
+          }
+          size_t const rest = m_pos / m_grid->I();
+          m_i = m_pos % m_grid->I();
+          m_j = rest % m_grid->J();
+          m_k = rest / m_grid->J();
+        }
+
+      public:
+
+        SparseIterator()
+          : m_grid(0)
+          , m_pos(0)
+          , m_i(0)
+          , m_j(0)
+          , m_k(0)
+        {}
+
+        SparseIterator(grid_pointer grid, size_t const & pos)
+          : m_grid(grid)
+          , m_pos(pos)
+        {
+          update_indices();
+        }
+
+      public:
+
+        grid_type const & get_grid() const { return *m_grid; }
+
+        size_t const & i() const { return m_i; }
+        size_t const & j() const { return m_j; }
+        size_t const & k() const { return m_k; }
+
+        index_vector get_index() const { return index_vector( m_i, m_j, m_k ); }
+
+        vector3_type get_coord() const
+        {
+          return vector3_type(
+            m_i * m_grid->dx() + m_grid->min_coord( 0 )
+            , m_j * m_grid->dy() + m_grid->min_coord( 1 )
+            , m_k * m_grid->dz() + m_grid->min_coord( 2 )
+            );
+        }
+
+        reference_type operator*() const { return (*m_grid)( m_i, m_j, m_k ); }
+
+        self_type & operator++()
+        {
+          ++m_pos;
+          ++m_i;
+          if ( m_i >= m_grid->I() )
+          {
+            m_i = 0u;
+            ++m_j;
+            if ( m_j >= m_grid->J() )
+            {
+              m_j = 0u;
+              ++m_k;
+            }
+          }
+          return *this;
+        }
+
+        self_type & operator--()
+        {
+          --m_pos;
+          update_indices();
+          return *this;
+        }
+
+        self_type operator++( int ) { self_type tmp = *this; ++( *this ); return tmp; }
+        self_type operator--( int ) { self_type tmp = *this; --( *this ); return tmp; }
+
+        void operator+=( size_t m ) { m_pos += m; update_indices(); }
+        void operator-=( size_t m ) { m_pos -= m; update_indices(); }
+
+        self_type operator+ ( size_t m ) const { return self_type( m_grid, m_pos + m ); }
+        self_type operator- ( size_t m ) const { return self_type( m_grid, m_pos - m ); }
+
+        difference_type operator-  ( self_type const & other ) const { return static_cast<difference_type>( m_pos ) - static_cast<difference_type>( other.m_pos ); }
+        bool operator< ( self_type const & other ) const { return m_pos <  other.m_pos; }
+        bool operator<=( self_type const & other ) const { return m_pos <= other.m_pos; }
+        bool operator> ( self_type const & other ) const { return m_pos >  other.m_pos; }
+        bool operator>=( self_type const & other ) const { return m_pos >= other.m_pos; }
+        bool operator==( self_type const & other ) const { return m_pos == other.m_pos; }
+        bool operator!=( self_type const & other ) const { return m_pos != other.m_pos; }
+      };
+
+    } // namespace detail
+
+    /**
+    * Sparse Blocked Grid.
+    *
+    * The grid nodes are grouped into tiles of 8x8x8 nodes. A dense top level
+    * table holds one entry per tile. A tile is either active, in which case
+    * its node values are stored in a brick taken from a brick pool, or it is
+    * inactive, in which case all its nodes share a single constant tile value.
+    *
+    * This is intended for narrow band signed distance fields, where only the
+    * tiles close to the zero level set need to be active. The far field is
+    * represented by inactive tiles holding plus or minus the band width, which
+    * means a 512^3 signed distance field of a closed surface only costs memory
+    * proportional to the surface area.
+    *
+    * The read interface is the same as the one of OpenTissue::grid::Grid, thus
+    * functions like value_at_point(), gradient_at_point(), enclosing_indices()
+    * and gradient() work unchanged, and the grid can be used as the grid type
+    * of an OpenTissue::sdf::Geometry.
+    *
+    * Non-const access to a node activates the tile of the node, if it was not
+    * already active. Activating a tile may grow the brick pool, which
+    * invalidates references to previously accessed node values.
+    *
+    * Volumes that do not fit in physical memory can be processed by paging
+    * the brick pool out to a memory mapped backing file, see page_out().
+    * Only the tile table stays in memory, the bricks are read from and
+    * written to the file by the operating system as they are accessed.
+    * The node values must then be plain data that can be copied bytewise.
+    *
+    * Example usage:
+    *
+    *   SparseGrid<float,math_types> phi;
+    *   phi.create( min_coord, max_coord, 2048, 2048, 2048 );
+    *   phi.page_out( "phi.bricks" );
+    *   for(...)
+    *     phi(i,j,k) = ...;
+    *   phi.page_in();   // or let the grid go out of scope and delete the file
+    */
+    template < typename T, typename math_types_  >
+    class SparseGrid
+    {
+    public:
+
+      typedef OpenTissue::grid::SparseGrid<T, math_types_>  grid_type;
+      typedef T                                             value_type;
+      typedef math_types_                                   math_types;
+
+      typedef typename math_types::index_vector3_type       index_vector;
+
+      typedef detail::SparseIterator<grid_type, value_type &, grid_type *>              iterator;
+      typedef detail::SparseIterator<grid_type, value_type const &, grid_type const *>  const_iterator;
+      typedef iterator                                                                  index_iterator;
+      typedef const_iterator                                                            const_index_iterator;
+
+      enum {
+        brick_log2   = 3                                      ///< Log2 of the number of nodes along a brick side.
+        , brick_size   = 1 << brick_log2                      ///< Number of nodes along a brick side.
+        , brick_mask   = brick_size - 1
+        , brick_volume = brick_size*brick_size*brick_size     ///< Number of nodes in a brick.
+      };
+
+    protected:
+
+      typedef typename math_types::vector3_type	     vector3_type;
+      typedef typename math_types::real_type         real_type;
+      typedef typename math_types::value_traits      value_traits;
+
+    protected:
+
+      vector3_type m_min_coord;
+      vector3_type m_max_coord;
+      size_t   m_N;            ///< Total number of nodes in grid.
+      size_t   m_I;            ///< Number of nodes along x-axis.
+      size_t   m_J;            ///< Number of nodes along y-axis.
+      size_t   m_K;            ///< Number of nodes along z-axis.
+      size_t   m_TI;           ///< Number of tiles along x-axis.
+      size_t   m_TJ;           ///< Number of tiles along y-axis.
+      size_t   m_TK;           ///< Number of tiles along z-axis.
+      vector3_type m_delta;    ///< Internode spacing along coordinate axes.
+      value_type   m_infinity; ///< Value specifying unused grid nodes.
+
+      std::vector<int>        m_tile_brick;   ///< Brick index of each tile, -1 if the tile is inactive.
+      std::vector<value_type> m_tile_value;   ///< The constant value of all nodes in an inactive tile.
+      std::vector<value_type> m_bricks;       ///< The brick pool when it is in memory, brick_volume consecutive node values per brick.
+      std::vector<int>        m_free_bricks;  ///< Indices of bricks in the pool that are not in use.
+      size_t                  m_brick_total;  ///< Number of bricks in the pool, including the free bricks.
+      value_type            * m_pool;         ///< The first node value of the brick pool, either in memory or in the backing file.
+      utility::MemoryMappedFile m_backing;    ///< The backing file of the brick pool, if the grid is paged out.
+
+    public:
+
+      SparseGrid()
+        : m_min_coord(value_traits::zero(),value_traits::zero(),value_traits::zero())
+        , m_max_coord(value_traits::zero(),value_traits::zero(),value_traits::zero())
+        , m_N(0)
+        , m_I(0)
+        , m_J(0)
+        , m_K(0)
+        , m_TI(0)
+        , m_TJ(0)
+        , m_TK(0)
+        , m_delta(value_traits::zero(),value_traits::zero(),value_traits::zero())
+        , m_infinity( math::detail::highest<T>() )
+        , m_brick_total(0)
+        , m_pool(0)
+      {}
+
+      /**
+      * Specialized Constructor.
+      * Should be used for more complex data types, which
+      * do not have a default numeric_limits
+      */
+      SparseGrid(value_type const & unused_val)
+        : m_min_coord(value_traits::zero(),value_traits::zero(),value_traits::zero())
+        , m_max_coord(value_traits::zero(),value_traits::zero(),value_traits::zero())
+        , m_N(0)
+        , m_I(0)
+        , m_J(0)
+        , m_K(0)
+        , m_TI(0)
+        , m_TJ(0)
+        , m_TK(0)
+        , m_delta(value_traits::zero(),value_traits::zero(),value_traits::zero())
+        , m_infinity( unused_val )
+        , m_brick_total(0)
+        , m_pool(0)
+      {}
+
+      /**
+      * Copy Constructor.
+      * The copy always keeps its bricks in memory, also if the original grid is paged out.
+      */
+      SparseGrid(grid_type const & G)
+        : m_brick_total(0)
+        , m_pool(0)
+      {
+        *this = G;
+      }
+
+      grid_type & operator=(grid_type const & G)
+      {
+        if(&G == this)
+          return *this;
+        m_backing.close();
+        m_min_coord   = G.m_min_coord;
+        m_max_coord   = G.m_max_coord;
+        m_N           = G.m_N;
+        m_I           = G.m_I;
+        m_J           = G.m_J;
+        m_K           = G.m_K;
+        m_TI          = G.m_TI;
+        m_TJ          = G.m_TJ;
+        m_TK          = G.m_TK;
+        m_delta       = G.m_delta;
+        m_infinity    = G.m_infinity;
+        m_tile_brick  = G.m_tile_brick;
+        m_tile_value  = G.m_tile_value;
+        m_free_bricks = G.m_free_bricks;
+        m_brick_total = G.m_brick_total;
+        std::vector<value_type>( G.m_pool, G.m_pool + G.m_brick_total*brick_volume ).swap( m_bricks );
+        update_pool();
+        return *this;
+      }
+
+    public:
+
+      /**
+      * Create Grid.
+      * This method allocates the tile table, all tiles are
+      * initially inactive and hold the unused value.
+      *
+      * @param min_coord
+      * @param max_coord
+      * @param Ival
+      * @param Jval
+      * @param Kval
+      */
+      void create(
+        vector3_type const & min_coord
+        , vector3_type const & max_coord
+        , size_t const & Ival
+        , size_t const & Jval
+        , size_t const & Kval
+        )
+      {
+        m_I = Ival;
+        m_J = Jval;
+        m_K = Kval;
+        m_N = Ival*Jval*Kval;
+        m_TI = (Ival + brick_mask) >> brick_log2;
+        m_TJ = (Jval + brick_mask) >> brick_log2;
+        m_TK = (Kval + brick_mask) >> brick_log2;
+        m_min_coord = min_coord;
+        m_max_coord = max_coord;
+        m_delta(0) = (m_max_coord(0)-m_min_coord(0))/(m_I-1);
+        m_delta(1) = (m_max_coord(1)-m_min_coord(1))/(m_J-1);
+        m_delta(2) = (m_max_coord(2)-m_min_coord(2))/(m_K-1);
+        clear();
+      }
+
+      /**
+      * Clears the grid.
+      * All tiles are made inactive with the unused value and the brick pool is released.
+      */
+      void clear()
+      {
+        std::vector<int>( m_TI*m_TJ*m_TK, -1 ).swap( m_tile_brick );
+        std::vector<value_type>( m_TI*m_TJ*m_TK, m_infinity ).swap( m_tile_value );
+        std::vector<value_type>().swap( m_bricks );
+        std::vector<int>().swap( m_free_bricks );
+        m_brick_total = 0;
+        update_pool();
+      }
+
+    public:
+
+      /**
+      * Get Tile Index.
+      *
+      * @param i   Node index along x-axis.
+      * @param j   Node index along y-axis.
+      * @param k   Node index along z-axis.
+      *
+      * @return    The index of the tile containing the node.
+      */
+      size_t tile_index(size_t const & i, size_t const & j, size_t const & k) const
+      {
+        return ( (k >> brick_log2)*m_TJ + (j >> brick_log2) )*m_TI + (i >> brick_log2);
+      }
+
+      /**
+      * Get Brick Offset.
+      *
+      * @return    The offset of the node within the brick of its tile.
+      */
+      static size_t brick_offset(size_t const & i, size_t const & j, size_t const & k)
+      {
+        return ( ( ( (k & brick_mask) << brick_log2 ) + (j & brick_mask) ) << brick_log2 ) + (i & brick_mask);
+      }
+
+      /**
+      * Get Brick Start.
+      * The offset is computed in size_t, brick indices times brick_volume
+      * do not fit in an int once the pool holds 2^22 or more bricks.
+      *
+      * @param b   A brick index.
+      *
+      * @return    The offset of the first node value of the brick in the brick pool.
+      */
+      static size_t brick_start(int const & b)
+      {
+        return static_cast<size_t>( b )*brick_volume;
+      }
+
+      size_t tile_I()     const { return m_TI; }
+      size_t tile_J()     const { return m_TJ; }
+      size_t tile_K()     const { return m_TK; }
+      size_t tile_count() const { return m_tile_brick.size(); }
+
+      bool is_active(size_t const & tile) const { return m_tile_brick[tile] >= 0; }
+
+      /**
+      * Get Brick.
+      *
+      * @param tile   A tile index.
+      *
+      * @return       A pointer to the brick_volume node values of the tile, null if the tile is inactive.
+      */
+      value_type * brick(size_t const & tile)
+      {
+        int const b = m_tile_brick[tile];
+        return b < 0 ? 0 : m_pool + brick_start(b);
+      }
+
+      value_type const * brick(size_t const & tile) const
+      {
+        int const b = m_tile_brick[tile];
+        return b < 0 ? 0 : m_pool + brick_start(b);
+      }
+
+      /**
+      * Get Tile Value.
+      * This is the value of all nodes of an inactive tile. For an active tile
+      * it is the value the tile gets if it is deactivated without a value.
+      */
+      value_type       & tile_value(size_t const & tile)       { return m_tile_value[tile]; }
+      value_type const & tile_value(size_t const & tile) const { return m_tile_value[tile]; }
+
+      /**
+      * Activate Tile.
+      * Allocates a brick for the tile and fills it with the tile value.
+      *
+      * @param tile   A tile index.
+      *
+      * @return       A pointer to the node values of the tile.
+      *
+      * @throws std::bad_alloc   If the brick pool could not be grown, the tile is left inactive.
+      */
+      value_type * activate(size_t const & tile)
+      {
+        if(m_tile_brick[tile] >= 0)
+          return brick(tile);
+
+        int b = 0;
+        if(m_free_bricks.empty())
+        {
+          b = static_cast<int>( m_brick_total );
+          grow( m_brick_total + 1 );
+          ++m_brick_total;
+        }
+        else
+        {
+          b = m_free_bricks.back();
+          m_free_bricks.pop_back();
+        }
+        m_tile_brick[tile] = b;
+        value_type * values = m_pool + brick_start(b);
+        std::fill( values, values + brick_volume, m_tile_value[tile] );
+        return values;
+      }
+
+      /**
+      * Deactivate Tile.
+      * Returns the brick of the tile to the pool, all nodes of the tile get the specified value.
+      *
+      * @param tile   A tile index.
+      * @param value  The new constant value of the tile.
+      */
+      void deactivate(size_t const & tile, value_type const & value)
+      {
+        if(m_tile_brick[tile] >= 0)
+        {
+          m_free_bricks.push_back( m_tile_brick[tile] );
+          m_tile_brick[tile] = -1;
+        }
+        m_tile_value[tile] = value;
+      }
+
+      /**
+      * Reserve Bricks.
+      * Makes room for the specified number of bricks in the brick pool, such
+      * that activating tiles do not reallocate the pool.
+      */
+      void reserve(size_t const & bricks)
+      {
+        if(is_paged())
+          grow( bricks );
+        else
+          m_bricks.reserve( bricks*brick_volume );
+        update_pool();
+      }
+
+      /**
+      * Compact Brick Pool.
+      * Moves the bricks of the active tiles to the front of the pool and
+      * releases the memory, or the file space, of unused bricks. This
+      * invalidates brick pointers.
+      */
+      void compact()
+      {
+        size_t const used = brick_count();
+
+        //--- Bricks beyond the used count are moved into the free bricks in front of it
+        std::sort( m_free_bricks.begin(), m_free_bricks.end() );
+        size_t next = 0;
+        for(size_t tile = 0; tile < m_tile_brick.size(); ++tile)
+        {
+          int const b = m_tile_brick[tile];
+          if(b < 0 || static_cast<size_t>(b) < used)
+            continue;
+          int const target = m_free_bricks[next++];
+          std::copy( m_pool + brick_start(b), m_pool + brick_start(b + 1), m_pool + brick_start(target) );
+          m_tile_brick[tile] = target;
+        }
+        std::vector<int>().swap( m_free_bricks );
+        m_brick_total = used;
+
+        if(is_paged())
+          m_backing.resize( std::max<size_t>( used, 1u )*brick_volume*sizeof(value_type) );
+        else
+          std::vector<value_type>( m_bricks.begin(), m_bricks.begin() + used*brick_volume ).swap( m_bricks );
+        update_pool();
+      }
+
+      /**
+      * @return   The number of active tiles.
+      */
+      size_t brick_count() const { return m_brick_total - m_free_bricks.size(); }
+
+      /**
+      * @return   The number of bytes of memory used by the tile table and the
+      *           brick pool. The bricks of a paged out grid are not counted,
+      *           see backing_size().
+      */
+      size_t memory_usage() const
+      {
+        return sizeof(grid_type)
+          + m_tile_brick.capacity()*sizeof(int)
+          + m_tile_value.capacity()*sizeof(value_type)
+          + m_bricks.capacity()*sizeof(value_type)
+          + m_free_bricks.capacity()*sizeof(int);
+      }
+
+      /**
+      * @return   The size in bytes of the backing file, zero if the grid is not paged out.
+      */
+      size_t backing_size() const { return m_backing.size(); }
+
+      /**
+      * Page Out.
+      * Moves the brick pool to a memory mapped backing file. From then on
+      * bricks are allocated in the file, which grows as tiles are activated,
+      * and the operating system pages the bricks in and out of memory as
+      * they are accessed. An existing file is overwritten, and the file is
+      * left on disk when the grid is paged in or destroyed.
+      *
+      * @param filename   The backing file.
+      *
+      * @return           If the pool was moved to the file then the return value is true otherwise it is false.
+      */
+      bool page_out(std::string const & filename)
+      {
+        if(is_paged())
+          return false;
+        size_t const capacity = std::max<size_t>( m_brick_total, 64u );
+        if(!m_backing.create( filename, capacity*brick_volume*sizeof(value_type) ))
+          return false;
+        std::copy( m_bricks.begin(), m_bricks.begin() + m_brick_total*brick_volume, reinterpret_cast<value_type*>( m_backing.data() ) );
+        std::vector<value_type>().swap( m_bricks );
+        update_pool();
+        return true;
+      }
+
+      /**
+      * Page In.
+      * Moves the brick pool from the backing file back into memory and
+      * closes the file. Does nothing if the grid is not paged out.
+      */
+      void page_in()
+      {
+        if(!is_paged())
+          return;
+        std::vector<value_type>( m_pool, m_pool + m_brick_total*brick_volume ).swap( m_bricks );
+        m_backing.close();
+        update_pool();
+      }
+
+      /**
+      * Flush.
+      * Writes the modified bricks of a paged out grid to the backing file.
+      */
+      void flush() { m_backing.flush(); }
+
+      /**
+      * @return   If the brick pool is in a backing file then the return value is true otherwise it is false.
+      */
+      bool is_paged() const { return m_backing.is_shared(); }
+
+    protected:
+
+      /**
+      * Grow Brick Pool.
+      * Makes sure that the pool can hold the specified number of bricks, a
+      * backing file is grown geometrically.
+      *
+      * @throws std::bad_alloc   If the backing file could not be grown, in
+      *                          which case no bricks have been added.
+      */
+      void grow(size_t const & bricks)
+      {
+        if(is_paged())
+        {
+          size_t const capacity = m_backing.size() / (brick_volume*sizeof(value_type));
+          if(bricks > capacity)
+          {
+            size_t const wanted = std::max( bricks, 2u*capacity );
+            if(!m_backing.resize( wanted*brick_volume*sizeof(value_type) ))
+            {
+              //--- The old mapping is restored, but it may have moved
+              update_pool();
+              throw std::bad_alloc();
+            }
+          }
+        }
+        else if(bricks*brick_volume > m_bricks.size())
+        {
+          m_bricks.resize( bricks*brick_volume );
+        }
+        update_pool();
+      }
+
+      void update_pool()
+      {
+        if(is_paged())
+          m_pool = reinterpret_cast<value_type*>( m_backing.data() );
+        else
+          m_pool = m_bricks.empty() ? 0 : &m_bricks[0];
+      }
+
+    public:
+
+      value_type const & get_value(size_t const & i, size_t const & j, size_t const & k) const
+      {
+        assert( i<m_I || !"SparseGrid::get_value(): i was out of range");
+        assert( j<m_J || !"SparseGrid::get_value(): j was out of range");
+        assert( k<m_K || !"SparseGrid::get_value(): k was out of range");
+        size_t const tile = tile_index(i,j,k);
+        int    const b    = m_tile_brick[tile];
+        if(b < 0)
+          return m_tile_value[tile];
+        return m_pool[ brick_start(b) + brick_offset(i,j,k) ];
+      }
+
+      value_type const & get_value(size_t const & linear_index) const
+      {
+        assert(linear_index<this->size() || !"SparseGrid::get_value(): index was out of range");
+        size_t const i    = linear_index % m_I;
+        size_t const rest = linear_index / m_I;
+        return get_value( i, rest % m_J, rest / m_J );
+      }
+
+      /**
+      * Get Node Value for Writing.
+      * Node indices wrap around the grid just like in OpenTissue::grid::Grid,
+      * the tile of the node is activated.
+      */
+      value_type & get_value(size_t const & i, size_t const & j, size_t const & k)
+      {
+        size_t const ii = i % m_I;
+        size_t const jj = j % m_J;
+        size_t const kk = k % m_K;
+        return activate( tile_index(ii,jj,kk) )[ brick_offset(ii,jj,kk) ];
+      }
+
+      value_type & get_value(size_t const & linear_index)
+      {
+        assert(linear_index<this->size() || !"SparseGrid::get_value(): index was out of range");
+        size_t const i    = linear_index % m_I;
+        size_t const rest = linear_index / m_I;
+        return get_value( i, rest % m_J, rest / m_J );
+      }
+
+      value_type       & operator() (size_t const & i,size_t const & j,size_t const & k)       {  return this->get_value(i,j,k); }
+      value_type const & operator() (size_t const & i,size_t const & j,size_t const & k) const {  return this->get_value(i,j,k); }
+
+      value_type       & operator() (size_t const & linear_index)       { return this->get_value( linear_index ); }
+      value_type const & operator() (size_t const & linear_index) const { return this->get_value( linear_index ); }
+
+      value_type       & operator() (index_vector const& iv)       { return this->get_value( iv(0), iv(1), iv(2) ); }
+      value_type const & operator() (index_vector const& iv) const { return this->get_value( iv(0), iv(1), iv(2) ); }
+
+      real_type width()  const { return m_max_coord(0) - m_min_coord(0); }
+      real_type height() const { return m_max_coord(1) - m_min_coord(1); }
+      real_type depth()  const { return m_max_coord(2) - m_min_coord(2); }
+
+      real_type const & dx() const { return m_delta(0); }
+      real_type const & dy() const { return m_delta(1); }
+      real_type const & dz() const { return m_delta(2); }
+
+      size_t I() const { return m_I; }
+      size_t J() const { return m_J; }
+      size_t K() const { return m_K; }
+      size_t size() const { return m_N; }
+
+      vector3_type const & min_coord()                       const { return m_min_coord; }
+      vector3_type const & max_coord()                       const { return m_max_coord; }
+      real_type    const & min_coord(size_t const & idx) const { return m_min_coord(idx); }
+      real_type    const & max_coord(size_t const & idx) const { return m_max_coord(idx); }
+
+      value_type unused() const { return m_infinity; }
+
+      iterator       begin()       { return iterator( this, 0u ); }
+      iterator       end()         { return iterator( this, m_N ); }
+      const_iterator begin() const { return const_iterator( this, 0u ); }
+      const_iterator end()   const { return const_iterator( this, m_N ); }
+
+      value_type infinity() const { return m_infinity; }
+
+      bool valid() const { return !m_tile_brick.empty(); }
+
+      bool empty() const { return ( size()==0 ); }
+
+    };
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_GRID_SPARSE_H
+#endif
@@ -49,7 +49,7 @@ namespace OpenTissue
       vector3_type min_coord = grid.min_coord();
       real_type min_x = min_coord(0);
       real_type min_y = min_coord(1);
-      real_type min_z = min_coord(0);
+      real_type min_z = min_coord(2);
       fwrite( &min_x, sizeof( real_type ), 1, stream );
       fwrite( &min_y, sizeof( real_type ), 1, stream );
       fwrite( &min_z, sizeof( real_type ), 1, stream );
@@ -57,7 +57,7 @@ namespace OpenTissue
       vector3_type max_coord = grid.max_coord();
       real_type max_x = max_coord(0);
       real_type max_y = max_coord(1);
-      real_type max_z = max_coord(0);
+      real_type max_z = max_coord(2);
       fwrite( &max_x, sizeof( real_type ), 1, stream );
       fwrite( &max_y, sizeof( real_type ), 1, stream );
       fwrite( &max_z, sizeof( real_type ), 1, stream );
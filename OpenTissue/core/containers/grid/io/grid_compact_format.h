@@ -0,0 +1,375 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_FORMAT_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_FORMAT_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <boost/cstdint.hpp>
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    /**
+    * Compact Grid File Format.
+    *
+    * A file starts with a CompactHeader, the node values follows at the
+    * data offset given in the header. All offsets are multiples of 64 bytes,
+    * so a memory mapped file can be used directly as an array of node values.
+    *
+    * The node values are stored using one of the encodings
+    *
+    *   compact_float32      32 bit floats, the largest float marks unused nodes. A
+    *                        dense file can be wrapped by a grid::Grid<float>
+    *                        without copying, see compact_map().
+    *   compact_quantized16  16 bit unsigned integers q, the value is
+    *                        offset + scale*q. The largest integer marks unused nodes.
+    *   compact_half16       16 bit IEEE half floats. Infinity marks unused nodes.
+    *
+    * and one of the layouts
+    *
+    *   compact_dense        All nodes in the order of grid::Grid::data().
+    *   compact_bricked      The grid is divided into tiles of 2^brick_log2 nodes
+    *                        along each side, using the same tile and brick
+    *                        ordering as grid::SparseGrid. Tiles where all nodes
+    *                        have the same value are stored as a single value, so
+    *                        a clamped narrow band field only stores the bricks
+    *                        close to the surface. The data offset points to a
+    *                        table of tile_count 32 bit brick indices (the
+    *                        largest integer marks a constant tile), followed by
+    *                        tile_count 32 bit float tile values (the largest
+    *                        float marks unused nodes). The bricks
+    *                        follows at the brick offset.
+    */
+    enum compact_encoding
+    {
+      compact_float32      = 0
+      , compact_quantized16  = 1
+      , compact_half16       = 2
+    };
+
+    enum compact_layout
+    {
+      compact_dense    = 0
+      , compact_bricked  = 1
+    };
+
+    /**
+    * Compact Grid File Header.
+    */
+    struct CompactHeader
+    {
+      char              m_magic[8];       ///< Must be "OTGRID" followed by two zero bytes.
+      boost::uint32_t   m_version;        ///< File format version.
+      boost::uint32_t   m_byte_order;     ///< Must be 0x01020304 when read on a machine with the same byte order as the writer.
+      boost::uint32_t   m_encoding;       ///< One of the compact_encoding values.
+      boost::uint32_t   m_layout;         ///< One of the compact_layout values.
+      boost::uint64_t   m_I;              ///< Number of nodes along x-axis.
+      boost::uint64_t   m_J;              ///< Number of nodes along y-axis.
+      boost::uint64_t   m_K;              ///< Number of nodes along z-axis.
+      double            m_min_coord[3];   ///< The minimum corner of the grid.
+      double            m_max_coord[3];   ///< The maximum corner of the grid.
+      double            m_offset;         ///< Quantization offset.
+      double            m_scale;          ///< Quantization scale.
+      boost::uint32_t   m_brick_log2;     ///< Log2 of the number of nodes along a brick side (bricked layout only).
+      boost::uint32_t   m_reserved;       ///< Unused, always zero.
+      boost::uint64_t   m_tile_count;     ///< Number of tiles (bricked layout only).
+      boost::uint64_t   m_brick_count;    ///< Number of stored bricks (bricked layout only).
+      boost::uint64_t   m_data_offset;    ///< Byte offset of the node values (dense) or the tile table (bricked).
+      boost::uint64_t   m_brick_offset;   ///< Byte offset of the first brick (bricked layout only).
+      boost::uint64_t   m_file_size;      ///< The total size of the file in bytes.
+    };
+
+    namespace detail
+    {
+
+      static boost::uint32_t const compact_version     = 1u;
+      static boost::uint32_t const compact_byte_order  = 0x01020304u;
+      static boost::uint32_t const compact_constant    = 0xFFFFFFFFu;
+      static boost::uint16_t const compact_unused16    = 0xFFFFu;
+      static boost::uint16_t const compact_half_inf    = 0x7C00u;
+
+      inline char const * compact_magic() { return "OTGRID\0\0"; }
+
+      /**
+      * Round Up Offset.
+      *
+      * @return   The smallest multiple of 64 that is no less than the offset.
+      */
+      inline boost::uint64_t compact_align(boost::uint64_t const & offset)
+      {
+        return (offset + 63u) & ~boost::uint64_t(63u);
+      }
+
+      inline size_t compact_value_size(boost::uint32_t const & encoding)
+      {
+        return encoding == compact_float32 ? 4u : 2u;
+      }
+
+      /**
+      * Convert Float to Half.
+      * Rounds to nearest even, too large values become infinity.
+      */
+      inline boost::uint16_t float_to_half(float const & value)
+      {
+        boost::uint32_t x;
+        std::memcpy( &x, &value, sizeof(x) );
+
+        boost::uint32_t const sign     = (x >> 16) & 0x8000u;
+        boost::uint32_t const biased   = (x >> 23) & 0xFFu;
+        boost::uint32_t       mantissa = x & 0x7FFFFFu;
+        int             const exponent = static_cast<int>( biased ) - 127 + 15;
+
+        if(biased == 0xFFu)
+          return static_cast<boost::uint16_t>( sign | 0x7C00u | (mantissa ? 0x200u : 0u) );
+        if(exponent >= 31)
+          return static_cast<boost::uint16_t>( sign | 0x7C00u );
+        if(exponent <= 0)
+        {
+          //--- Subnormal half or zero
+          if(exponent < -10)
+            return static_cast<boost::uint16_t>( sign );
+          mantissa |= 0x800000u;
+          int             const shift     = 14 - exponent;
+          boost::uint32_t       half      = mantissa >> shift;
+          boost::uint32_t const remainder = mantissa & ((1u << shift) - 1u);
+          boost::uint32_t const halfway   = 1u << (shift - 1);
+          if(remainder > halfway || (remainder == halfway && (half & 1u)))
+            ++half;
+          return static_cast<boost::uint16_t>( sign | half );
+        }
+        boost::uint32_t       half      = sign | (static_cast<boost::uint32_t>( exponent ) << 10) | (mantissa >> 13);
+        boost::uint32_t const remainder = mantissa & 0x1FFFu;
+        //--- A carry out of the mantissa correctly bumps the exponent
+        if(remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+          ++half;
+        return static_cast<boost::uint16_t>( half );
+      }
+
+      /**
+      * Convert Half to Float.
+      */
+      inline float half_to_float(boost::uint16_t const & half)
+      {
+        boost::uint32_t const sign     = (static_cast<boost::uint32_t>( half ) & 0x8000u) << 16;
+        boost::uint32_t       exponent = (half >> 10) & 0x1Fu;
+        boost::uint32_t       mantissa = half & 0x3FFu;
+        boost::uint32_t       x        = sign;
+
+        if(exponent == 0)
+        {
+          if(mantissa != 0)
+          {
+            //--- Normalize the subnormal half
+            exponent = 1;
+            while(!(mantissa & 0x400u))
+            {
+              mantissa <<= 1;
+              --exponent;
+            }
+            mantissa &= 0x3FFu;
+            x |= ((exponent + 112u) << 23) | (mantissa << 13);
+          }
+        }
+        else if(exponent == 31)
+          x |= 0x7F800000u | (mantissa << 13);
+        else
+          x |= ((exponent + 112u) << 23) | (mantissa << 13);
+
+        float value;
+        std::memcpy( &value, &x, sizeof(value) );
+        return value;
+      }
+
+      /**
+      * Convert Node Value to 32 Bit Float.
+      * Unused nodes become the largest float.
+      */
+      template<typename value_type>
+      inline float compact_float(value_type const & value, value_type const & unused)
+      {
+        float const largest = std::numeric_limits<float>::max();
+        if(value == unused)
+          return largest;
+        double const v = static_cast<double>( value );
+        return static_cast<float>( v > largest ? largest : (v < -largest ? -largest : v) );
+      }
+
+      /**
+      * Convert 32 Bit Float to Node Value.
+      */
+      template<typename value_type>
+      inline value_type compact_value(float const & value, value_type const & unused)
+      {
+        return value == std::numeric_limits<float>::max() ? unused : static_cast<value_type>( value );
+      }
+
+      /**
+      * Encode Node Values.
+      *
+      * @param header   The header of the file, gives the encoding and quantization.
+      * @param values   The node values.
+      * @param count    The number of node values.
+      * @param unused   The value of unused nodes.
+      * @param dst      Upon return holds count encoded values.
+      */
+      template<typename value_type>
+      inline void compact_encode(
+        CompactHeader const & header
+        , value_type const * values
+        , size_t const & count
+        , value_type const & unused
+        , void * dst
+        )
+      {
+        using std::floor;
+
+        switch(header.m_encoding)
+        {
+        case compact_float32:
+          {
+            float * out = static_cast<float*>( dst );
+            for(size_t n = 0; n < count; ++n)
+              out[n] = compact_float( values[n], unused );
+          }
+          break;
+        case compact_quantized16:
+          {
+            boost::uint16_t * out = static_cast<boost::uint16_t*>( dst );
+            for(size_t n = 0; n < count; ++n)
+            {
+              if(values[n] == unused)
+              {
+                out[n] = compact_unused16;
+                continue;
+              }
+              double q = floor( (static_cast<double>( values[n] ) - header.m_offset) / header.m_scale + 0.5 );
+              q = q < 0.0 ? 0.0 : q;
+              q = q > compact_unused16 - 1.0 ? compact_unused16 - 1.0 : q;
+              out[n] = static_cast<boost::uint16_t>( q );
+            }
+          }
+          break;
+        case compact_half16:
+          {
+            boost::uint16_t * out = static_cast<boost::uint16_t*>( dst );
+            for(size_t n = 0; n < count; ++n)
+            {
+              if(values[n] == unused)
+              {
+                out[n] = compact_half_inf;
+                continue;
+              }
+              //--- Clamp to the largest finite half, such that only unused nodes become infinity
+              double v = static_cast<double>( values[n] );
+              v = v >  65504.0 ?  65504.0 : v;
+              v = v < -65504.0 ? -65504.0 : v;
+              out[n] = float_to_half( static_cast<float>( v ) );
+            }
+          }
+          break;
+        }
+      }
+
+      /**
+      * Decode Node Values.
+      *
+      * @param header   The header of the file, gives the encoding and quantization.
+      * @param src      The encoded values.
+      * @param count    The number of node values.
+      * @param unused   The value given to unused nodes.
+      * @param values   Upon return holds count decoded node values.
+      */
+      template<typename value_type>
+      inline void compact_decode(
+        CompactHeader const & header
+        , void const * src
+        , size_t const & count
+        , value_type const & unused
+        , value_type * values
+        )
+      {
+        switch(header.m_encoding)
+        {
+        case compact_float32:
+          {
+            float const * in = static_cast<float const*>( src );
+            for(size_t n = 0; n < count; ++n)
+              values[n] = compact_value( in[n], unused );
+          }
+          break;
+        case compact_quantized16:
+          {
+            boost::uint16_t const * in = static_cast<boost::uint16_t const*>( src );
+            for(size_t n = 0; n < count; ++n)
+              values[n] = (in[n] == compact_unused16) ? unused : static_cast<value_type>( header.m_offset + header.m_scale*in[n] );
+          }
+          break;
+        case compact_half16:
+          {
+            boost::uint16_t const * in = static_cast<boost::uint16_t const*>( src );
+            for(size_t n = 0; n < count; ++n)
+              values[n] = (in[n] == compact_half_inf) ? unused : static_cast<value_type>( half_to_float( in[n] ) );
+          }
+          break;
+        }
+      }
+
+      /**
+      * Validate Header.
+      *
+      * @param header   The header.
+      * @param size     The size of the file in bytes.
+      *
+      * @return         If the header describes a file of this version that fits the size then the return value is true otherwise it is false.
+      */
+      inline bool compact_valid(CompactHeader const & header, size_t const & size)
+      {
+        if(size < sizeof(CompactHeader))
+          return false;
+        if(std::memcmp( header.m_magic, compact_magic(), 8 ) != 0)
+          return false;
+        if(header.m_version != compact_version || header.m_byte_order != compact_byte_order)
+          return false;
+        if(header.m_encoding > compact_half16 || header.m_layout > compact_bricked)
+          return false;
+        if(header.m_file_size != size)
+          return false;
+        if(header.m_I < 2 || header.m_J < 2 || header.m_K < 2)
+          return false;
+
+        boost::uint64_t const value_size = compact_value_size( header.m_encoding );
+        if(header.m_layout == compact_dense)
+          return header.m_data_offset + header.m_I*header.m_J*header.m_K*value_size <= size;
+
+        if(header.m_brick_log2 == 0 || header.m_brick_log2 > 8)
+          return false;
+        boost::uint64_t const brick_size = boost::uint64_t(1) << header.m_brick_log2;
+        boost::uint64_t const tiles      =
+          ((header.m_I + brick_size - 1) >> header.m_brick_log2)
+          * ((header.m_J + brick_size - 1) >> header.m_brick_log2)
+          * ((header.m_K + brick_size - 1) >> header.m_brick_log2);
+        if(header.m_tile_count != tiles)
+          return false;
+        if(header.m_data_offset + tiles*8u > header.m_brick_offset)
+          return false;
+        return header.m_brick_offset + header.m_brick_count*brick_size*brick_size*brick_size*value_size <= size;
+      }
+
+    } // namespace detail
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_FORMAT_H
+#endif
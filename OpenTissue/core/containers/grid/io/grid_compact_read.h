@@ -0,0 +1,276 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_READ_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_READ_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/io/grid_compact_format.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/grid_sparse.h>
+#include <OpenTissue/utility/utility_memory_mapped_file.h>
+
+#include <boost/type_traits/is_same.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Open Compact File.
+      *
+      * @param filename   The name of the file.
+      * @param file       Upon return holds the mapped file.
+      * @param header     Upon return holds a copy of the file header.
+      *
+      * @return           If the file is a valid compact grid file then the return value is true otherwise it is false.
+      */
+      inline bool compact_open(std::string const & filename, OpenTissue::utility::MemoryMappedFile & file, CompactHeader & header)
+      {
+        if(!file.open( filename ))
+        {
+          std::cerr << "compact_read(): unable to open file " << filename << std::endl;
+          return false;
+        }
+        if(file.size() >= sizeof(CompactHeader))
+          std::memcpy( &header, file.data(), sizeof(CompactHeader) );
+        if(!compact_valid( header, file.size() ))
+        {
+          std::cerr << "compact_read(): " << filename << " is not a compact grid file of version " << compact_version << std::endl;
+          file.close();
+          return false;
+        }
+        return true;
+      }
+
+      template<typename grid_type>
+      inline void compact_create(CompactHeader const & header, grid_type & grid)
+      {
+        typedef typename grid_type::math_types     math_types;
+        typedef typename math_types::vector3_type  vector3_type;
+        typedef typename math_types::real_type     real_type;
+
+        vector3_type const min_coord(
+          static_cast<real_type>( header.m_min_coord[0] )
+          , static_cast<real_type>( header.m_min_coord[1] )
+          , static_cast<real_type>( header.m_min_coord[2] )
+          );
+        vector3_type const max_coord(
+          static_cast<real_type>( header.m_max_coord[0] )
+          , static_cast<real_type>( header.m_max_coord[1] )
+          , static_cast<real_type>( header.m_max_coord[2] )
+          );
+        grid.create( min_coord, max_coord, header.m_I, header.m_J, header.m_K );
+      }
+
+      /**
+      * Decode Compact Grid into Dense Grid.
+      */
+      template<typename T, typename math_types>
+      inline bool compact_decode_grid(CompactHeader const & header, char const * bytes, OpenTissue::grid::Grid<T,math_types> & grid)
+      {
+        compact_create( header, grid );
+
+        size_t const value_size = compact_value_size( header.m_encoding );
+        T const unused = grid.unused();
+
+        if(header.m_layout == compact_dense)
+        {
+          compact_decode( header, bytes + header.m_data_offset, grid.size(), unused, grid.data() );
+          return true;
+        }
+
+        size_t const log2   = header.m_brick_log2;
+        size_t const size   = size_t(1) << log2;
+        size_t const volume = size*size*size;
+        size_t const I = grid.I();
+        size_t const J = grid.J();
+        size_t const K = grid.K();
+        size_t const TI = (I + size - 1) >> log2;
+        size_t const TJ = (J + size - 1) >> log2;
+        size_t const TK = (K + size - 1) >> log2;
+
+        boost::uint32_t const * tile_brick = reinterpret_cast<boost::uint32_t const *>( bytes + header.m_data_offset );
+        float           const * tile_value = reinterpret_cast<float const *>( tile_brick + header.m_tile_count );
+        char            const * bricks     = bytes + header.m_brick_offset;
+
+        std::vector<T> brick( volume );
+        T * values = grid.data();
+        for(size_t tk = 0; tk < TK; ++tk)
+          for(size_t tj = 0; tj < TJ; ++tj)
+            for(size_t ti = 0; ti < TI; ++ti)
+            {
+              size_t const tile = (tk*TJ + tj)*TI + ti;
+              if(tile_brick[tile] != compact_constant && tile_brick[tile] >= header.m_brick_count)
+                return false;
+              if(tile_brick[tile] == compact_constant)
+                std::fill( brick.begin(), brick.end(), compact_value( tile_value[tile], unused ) );
+              else
+                compact_decode( header, bricks + tile_brick[tile]*volume*value_size, volume, unused, &brick[0] );
+
+              size_t const i0 = ti << log2;
+              size_t const j0 = tj << log2;
+              size_t const k0 = tk << log2;
+              for(size_t k = k0; k < k0 + size && k < K; ++k)
+                for(size_t j = j0; j < j0 + size && j < J; ++j)
+                  for(size_t i = i0; i < i0 + size && i < I; ++i)
+                    values[(k*J + j)*I + i] = brick[ ((((k - k0) << log2) + (j - j0)) << log2) + (i - i0) ];
+            }
+        return true;
+      }
+
+      /**
+      * Decode Compact Grid into Sparse Grid.
+      * Constant tiles of bricked files become inactive tiles.
+      */
+      template<typename T, typename math_types>
+      inline bool compact_decode_grid(CompactHeader const & header, char const * bytes, OpenTissue::grid::SparseGrid<T,math_types> & grid)
+      {
+        typedef OpenTissue::grid::SparseGrid<T,math_types>  grid_type;
+
+        compact_create( header, grid );
+
+        size_t const value_size = compact_value_size( header.m_encoding );
+        T const unused = grid.unused();
+        size_t const I = grid.I();
+        size_t const J = grid.J();
+        size_t const K = grid.K();
+
+        if(header.m_layout == compact_dense)
+        {
+          std::vector<T> row( I );
+          for(size_t k = 0; k < K; ++k)
+            for(size_t j = 0; j < J; ++j)
+            {
+              compact_decode( header, bytes + header.m_data_offset + (k*J + j)*I*value_size, I, unused, &row[0] );
+              for(size_t i = 0; i < I; ++i)
+                grid(i,j,k) = row[i];
+            }
+          return true;
+        }
+
+        if(header.m_brick_log2 != static_cast<boost::uint32_t>( grid_type::brick_log2 ) || header.m_tile_count != grid.tile_count())
+        {
+          std::cerr << "compact_read(): brick size of file does not match the sparse grid" << std::endl;
+          return false;
+        }
+
+        size_t const volume = grid_type::brick_volume;
+
+        boost::uint32_t const * tile_brick = reinterpret_cast<boost::uint32_t const *>( bytes + header.m_data_offset );
+        float           const * tile_value = reinterpret_cast<float const *>( tile_brick + header.m_tile_count );
+        char            const * bricks     = bytes + header.m_brick_offset;
+
+        grid.reserve( header.m_brick_count );
+        for(size_t tile = 0; tile < grid.tile_count(); ++tile)
+        {
+          if(tile_brick[tile] != compact_constant && tile_brick[tile] >= header.m_brick_count)
+            return false;
+          if(tile_brick[tile] == compact_constant)
+          {
+            grid.deactivate( tile, compact_value( tile_value[tile], unused ) );
+            continue;
+          }
+          grid.tile_value(tile) = compact_value( tile_value[tile], unused );
+          compact_decode( header, bricks + tile_brick[tile]*volume*value_size, volume, unused, grid.activate( tile ) );
+        }
+        return true;
+      }
+
+    } // namespace detail
+
+    /**
+    * Read Grid in Compact Format.
+    * See CompactHeader for a description of the file format. The file is
+    * memory mapped while it is decoded.
+    *
+    * @param filename    The name of the file.
+    * @param grid        Upon return holds the grid, either a grid::Grid or a grid::SparseGrid.
+    *
+    * @return            If the file was read then the return value is true otherwise it is false.
+    */
+    template <typename grid_type>
+    inline bool compact_read(std::string const & filename, grid_type & grid)
+    {
+      OpenTissue::utility::MemoryMappedFile file;
+      CompactHeader header;
+      if(!detail::compact_open( filename, file, header ))
+        return false;
+      return detail::compact_decode_grid( header, file.data(), grid );
+    }
+
+    /**
+    * Memory Map Grid in Compact Format.
+    * A dense file with 32 bit float values is wrapped by a grid::Grid<float>
+    * without copying any node values, see Grid::wrap(). Pages of the file are
+    * only read from disk when the nodes are accessed, and pages of the same
+    * file are shared between processes. Writing to the grid does not change
+    * the file.
+    *
+    * Other files are decoded into memory owned by the grid, like compact_read() does.
+    *
+    * @param filename    The name of the file.
+    * @param file        Upon return holds the memory mapping. The file must be kept
+    *                    open for as long as the grid is used.
+    * @param grid        Upon return holds the grid.
+    *
+    * @return            If the file was mapped or read then the return value is true otherwise it is false.
+    */
+    template <typename T, typename math_types>
+    inline bool compact_map(
+      std::string const & filename
+      , OpenTissue::utility::MemoryMappedFile & file
+      , OpenTissue::grid::Grid<T,math_types> & grid
+      )
+    {
+      typedef typename math_types::vector3_type  vector3_type;
+      typedef typename math_types::real_type     real_type;
+
+      CompactHeader header;
+      if(!detail::compact_open( filename, file, header ))
+        return false;
+
+      bool const zero_copy = boost::is_same<T,float>::value
+        && header.m_encoding == compact_float32
+        && header.m_layout   == compact_dense
+        && grid.unused()     == static_cast<T>( std::numeric_limits<float>::max() );
+
+      if(!zero_copy)
+      {
+        bool const ok = detail::compact_decode_grid( header, file.data(), grid );
+        file.close();
+        return ok;
+      }
+
+      vector3_type const min_coord(
+        static_cast<real_type>( header.m_min_coord[0] )
+        , static_cast<real_type>( header.m_min_coord[1] )
+        , static_cast<real_type>( header.m_min_coord[2] )
+        );
+      vector3_type const max_coord(
+        static_cast<real_type>( header.m_max_coord[0] )
+        , static_cast<real_type>( header.m_max_coord[1] )
+        , static_cast<real_type>( header.m_max_coord[2] )
+        );
+      grid.wrap( min_coord, max_coord, header.m_I, header.m_J, header.m_K, reinterpret_cast<T*>( file.data() + header.m_data_offset ) );
+      return true;
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_READ_H
+#endif
@@ -0,0 +1,223 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_WRITE_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_WRITE_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/io/grid_compact_format.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      inline bool compact_pad(FILE * stream, boost::uint64_t const & from, boost::uint64_t const & to)
+      {
+        static char const zeros[64] = { 0 };
+        return to == from || fwrite( zeros, 1, static_cast<size_t>( to - from ), stream ) == to - from;
+      }
+
+    } // namespace detail
+
+    /**
+    * Write Grid in Compact Format.
+    * See CompactHeader for a description of the file format.
+    *
+    * @param filename    The name of the file.
+    * @param grid        The grid to write, either a grid::Grid or a grid::SparseGrid.
+    * @param encoding    The encoding of the node values, default is compact_float32.
+    * @param layout      The layout of the node values, default is compact_dense. Use
+    *                    compact_bricked for narrow band fields that are clamped away from
+    *                    the surface.
+    *
+    * @return            If the file was written then the return value is true otherwise it is false.
+    */
+    template <typename grid_type>
+    inline bool compact_write(
+      std::string const & filename
+      , grid_type const & grid
+      , compact_encoding const & encoding = compact_float32
+      , compact_layout const & layout = compact_dense
+      )
+    {
+      typedef typename grid_type::value_type    value_type;
+
+      using std::min;
+      using std::max;
+
+      size_t const I = grid.I();
+      size_t const J = grid.J();
+      size_t const K = grid.K();
+      value_type const unused = grid.unused();
+
+      CompactHeader header;
+      std::memset( &header, 0, sizeof(header) );
+      std::memcpy( header.m_magic, detail::compact_magic(), 8 );
+      header.m_version    = detail::compact_version;
+      header.m_byte_order = detail::compact_byte_order;
+      header.m_encoding   = encoding;
+      header.m_layout     = layout;
+      header.m_I          = I;
+      header.m_J          = J;
+      header.m_K          = K;
+      for(size_t m = 0; m < 3; ++m)
+      {
+        header.m_min_coord[m] = grid.min_coord(m);
+        header.m_max_coord[m] = grid.max_coord(m);
+      }
+      header.m_offset     = 0.0;
+      header.m_scale      = 1.0;
+
+      //--- Quantization maps the range of used values onto the 16 bit integers
+      if(encoding == compact_quantized16)
+      {
+        bool any = false;
+        double lo = 0.0;
+        double hi = 0.0;
+        for(size_t k = 0; k < K; ++k)
+          for(size_t j = 0; j < J; ++j)
+            for(size_t i = 0; i < I; ++i)
+            {
+              value_type const v = grid(i,j,k);
+              if(v == unused)
+                continue;
+              lo  = any ? min( lo, static_cast<double>( v ) ) : static_cast<double>( v );
+              hi  = any ? max( hi, static_cast<double>( v ) ) : static_cast<double>( v );
+              any = true;
+            }
+        header.m_offset = lo;
+        header.m_scale  = (hi > lo) ? (hi - lo) / (detail::compact_unused16 - 1.0) : 1.0;
+      }
+
+      size_t const value_size = detail::compact_value_size( encoding );
+
+      FILE *stream;
+      if( (stream = fopen( filename.c_str(), "wb" )) == NULL )
+      {
+        std::cerr << "compact_write(): unable to open file " << filename << std::endl;
+        return false;
+      }
+
+      bool ok = true;
+      header.m_data_offset = detail::compact_align( sizeof(CompactHeader) );
+
+      if(layout == compact_dense)
+      {
+        header.m_file_size = header.m_data_offset + I*J*K*value_size;
+
+        ok = ok && fwrite( &header, sizeof(CompactHeader), 1, stream ) == 1;
+        ok = ok && detail::compact_pad( stream, sizeof(CompactHeader), header.m_data_offset );
+
+        std::vector<value_type> slice( I*J );
+        std::vector<char>       encoded( I*J*value_size );
+        for(size_t k = 0; k < K && ok; ++k)
+        {
+          for(size_t j = 0; j < J; ++j)
+            for(size_t i = 0; i < I; ++i)
+              slice[j*I + i] = grid(i,j,k);
+          detail::compact_encode( header, &slice[0], slice.size(), unused, &encoded[0] );
+          ok = fwrite( &encoded[0], 1, encoded.size(), stream ) == encoded.size();
+        }
+      }
+      else
+      {
+        size_t const brick_log2   = 3u;
+        size_t const brick_size   = 1u << brick_log2;
+        size_t const brick_volume = brick_size*brick_size*brick_size;
+        size_t const TI = (I + brick_size - 1) >> brick_log2;
+        size_t const TJ = (J + brick_size - 1) >> brick_log2;
+        size_t const TK = (K + brick_size - 1) >> brick_log2;
+        size_t const tile_count = TI*TJ*TK;
+
+        std::vector<boost::uint32_t> tile_brick( tile_count );
+        std::vector<float>           tile_value( tile_count );
+        std::vector<value_type>      brick( brick_volume );
+
+        //--- Gathers the nodes of a tile in brick order, nodes outside the grid
+        //--- are given the value of the first node of the tile
+        struct gather
+        {
+          static bool run(grid_type const & G, size_t ti, size_t tj, size_t tk, size_t log2, value_type * values)
+          {
+            size_t const size = 1u << log2;
+            size_t const i0 = ti << log2;
+            size_t const j0 = tj << log2;
+            size_t const k0 = tk << log2;
+            value_type const first = G(i0,j0,k0);
+            bool constant = true;
+            for(size_t k = 0; k < size; ++k)
+              for(size_t j = 0; j < size; ++j)
+                for(size_t i = 0; i < size; ++i)
+                {
+                  bool const inside = (i0 + i < G.I()) && (j0 + j < G.J()) && (k0 + k < G.K());
+                  value_type const v = inside ? G(i0 + i, j0 + j, k0 + k) : first;
+                  values[ (((k << log2) + j) << log2) + i ] = v;
+                  constant = constant && (v == first);
+                }
+            return constant;
+          }
+        };
+
+        boost::uint32_t brick_count = 0u;
+        for(size_t tk = 0; tk < TK; ++tk)
+          for(size_t tj = 0; tj < TJ; ++tj)
+            for(size_t ti = 0; ti < TI; ++ti)
+            {
+              size_t const tile = (tk*TJ + tj)*TI + ti;
+              bool const constant = gather::run( grid, ti, tj, tk, brick_log2, &brick[0] );
+              tile_value[tile] = detail::compact_float( brick[0], unused );
+              tile_brick[tile] = constant ? detail::compact_constant : brick_count++;
+            }
+
+        boost::uint64_t const table_end = header.m_data_offset + tile_count*( sizeof(boost::uint32_t) + sizeof(float) );
+        header.m_brick_log2   = brick_log2;
+        header.m_tile_count   = tile_count;
+        header.m_brick_count  = brick_count;
+        header.m_brick_offset = detail::compact_align( table_end );
+        header.m_file_size    = header.m_brick_offset + brick_count*brick_volume*value_size;
+
+        ok = ok && fwrite( &header, sizeof(CompactHeader), 1, stream ) == 1;
+        ok = ok && detail::compact_pad( stream, sizeof(CompactHeader), header.m_data_offset );
+        ok = ok && fwrite( &tile_brick[0], sizeof(boost::uint32_t), tile_count, stream ) == tile_count;
+        ok = ok && fwrite( &tile_value[0], sizeof(float), tile_count, stream ) == tile_count;
+        ok = ok && detail::compact_pad( stream, table_end, header.m_brick_offset );
+
+        std::vector<char> encoded( brick_volume*value_size );
+        for(size_t tk = 0; tk < TK && ok; ++tk)
+          for(size_t tj = 0; tj < TJ && ok; ++tj)
+            for(size_t ti = 0; ti < TI && ok; ++ti)
+            {
+              size_t const tile = (tk*TJ + tj)*TI + ti;
+              if(tile_brick[tile] == detail::compact_constant)
+                continue;
+              gather::run( grid, ti, tj, tk, brick_log2, &brick[0] );
+              detail::compact_encode( header, &brick[0], brick_volume, unused, &encoded[0] );
+              ok = fwrite( &encoded[0], 1, encoded.size(), stream ) == encoded.size();
+            }
+      }
+
+      fclose( stream );
+      if(!ok)
+        std::cerr << "compact_write(): failed writing file " << filename << std::endl;
+      return ok;
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_IO_GRID_COMPACT_WRITE_H
+#endif
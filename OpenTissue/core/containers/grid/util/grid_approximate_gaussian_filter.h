@@ -10,7 +10,8 @@
 #include <OpenTissue/configuration.h>
 
 #include <OpenTissue/core/containers/grid/util/grid_box_filter.h>
-#include <OpenTissue/core/containers/grid/util/grid_translate.h>
+
+#include <cmath>
 
 namespace OpenTissue
 {
@@ -21,7 +22,8 @@ namespace OpenTissue
     * This just applies several box_filter's (boxsize=size and order times),
     * and is only efficient for low orders.
     * If size is even, the order must also be even for the resulting image to lay on the same grid
-    * (else translated 0.5 voxel towards (0,0,0) ).
+    * (else translated 0.5 voxel towards (0,0,0) ). The filtering is done by
+    * separable_pass() with BoxLineFilter's.
     * @param src   Source grid to be convolved.
     * @param order Order of filter. Corresponds to the number of times the boxfilter is applied.
     * @param size  Size of filter.
@@ -30,17 +32,23 @@ namespace OpenTissue
     template <class grid_type>
     inline void approximate_gaussian_filter(grid_type const& src, size_t order, size_t size, grid_type& dst)
     {
-      typedef typename grid_type::index_vector index_vector;
-      dst=src;
+      using std::pow;
+
+      if(&dst != &src)
+        dst = src;
+
+      int const dims[3] = { static_cast<int>( dst.I() ), static_cast<int>( dst.J() ), static_cast<int>( dst.K() ) };
+      int const width   = static_cast<int>( size );
       for(size_t i=0; i<order; ++i)
       {
-        box_filter(dst,size,dst);
-        // recenter image by 1 voxel for every second application of the box_filter when the size is odd
-        if (i>0 && (i%2) && !(size%2))
-        {
-          std::cout << "--calling translate()" << std::endl;
-          translate(dst, index_vector(1,1,1), dst);
-        }
+        // an even sized box shifts the image half a voxel, so every second
+        // application shifts it back by using the window on the other side
+        int const center = (size%2 || i%2 == 0) ? width/2 : width/2 - 1;
+        BoxLineFilter<double> const sum( width, 1.0, center );
+        BoxLineFilter<double> const average( width, 1.0/pow(static_cast<double>(size),3), center );
+        separable_pass( dst.data(), dst.data(), dims, 2, sum );
+        separable_pass( dst.data(), dst.data(), dims, 1, sum );
+        separable_pass( dst.data(), dst.data(), dims, 0, average );
       }
     }
 
@@ -9,7 +9,8 @@
 //
 #include <OpenTissue/configuration.h>
 
-#include <boost/lambda/lambda.hpp>
+#include <OpenTissue/core/containers/grid/util/grid_separable_filter.h>
+
 #include <cmath> // for pow()
 
 namespace OpenTissue
@@ -20,69 +21,32 @@ namespace OpenTissue
     * Fast convolution by an integer sized box signal.
     * Variance of the filter is 1/12*(size*size-1).
     *
+    * Each axis is filtered with a running sum by a BoxLineFilter, values
+    * outside the grid are zero. See separable_pass() for how the passes are
+    * blocked and multithreaded.
+    *
     * @param src   Source grid to be convolved.
     * @param size  Size of box filter.
-    * @param dst   Upon return, contains the filtered grid.
+    * @param dst   Upon return, contains the filtered grid. May be the same as src.
     */
     template <typename grid_type>
     inline void box_filter(grid_type const& src, size_t size, grid_type & dst)
     {
-      typedef typename grid_type::value_type value_type;
+      using std::pow;
 
-      grid_type tmp=src;
+      if(&dst != &src)
+        dst = src;
 
-      size_t center=size/2;
-      for(size_t x=0; x<src.I(); ++x)
-        for(size_t y=0; y<src.J(); ++y)
-        {
-          value_type sum= value_type(0);
+      int const dims[3] = { static_cast<int>( dst.I() ), static_cast<int>( dst.J() ), static_cast<int>( dst.K() ) };
+      int const width   = static_cast<int>( size );
 
-          for(size_t z=0; z<src.K()+center; ++z)
-          {
-            if(z<src.K())
-              sum+=tmp(x,y,z);
-            if(z>=size)
-              sum-=tmp(x,y,z-size);
-            if(z>=center)
-              dst(x,y,z-center)=sum;
-          }
-        }
-        tmp = dst;
-        for(size_t x=0; x<src.I(); ++x)
-          for(size_t z=0; z<src.K(); ++z)
-          {
-            value_type sum= value_type(0);
-            for(size_t y=0; y<src.J()+center; ++y)
-            {
-              if(y<src.J())
-                sum+=tmp(x,y,z);
-              if(y>=size)
-                sum-=tmp(x,y-size,z);
-              if(y>=center)
-                dst(x,y-center,z)=sum;
-            }
-          }
-          tmp=dst;
-          for(size_t y=0; y<src.J(); ++y)
-            for(size_t z=0; z<src.K(); ++z)
-            {
-              value_type sum= value_type(0);
-              for(size_t x=0; x<src.I()+center; ++x)
-              {
-                if(x<src.I())
-                  sum+=tmp(x,y,z);
-                if(x>=size)
-                  sum-=tmp(x-size,y,z);
-                if(x>=center)
-                  dst(x-center,y,z)=sum;
-              }
-            }
+      //--- The sums are normalized in the last pass only, so integral grids are not rounded in between
+      BoxLineFilter<double> const sum( width, 1.0 );
+      BoxLineFilter<double> const average( width, 1.0/pow(static_cast<double>(size),3) );
 
-            std::for_each( 
-              dst.begin()
-              , dst.end()
-              , boost::lambda::_1 *=  boost::lambda::make_const(  1.0/pow(static_cast<double>(size),3) ) 
-              );
+      separable_pass( dst.data(), dst.data(), dims, 2, sum );
+      separable_pass( dst.data(), dst.data(), dims, 1, sum );
+      separable_pass( dst.data(), dst.data(), dims, 0, average );
     }
 
   } // namespace grid
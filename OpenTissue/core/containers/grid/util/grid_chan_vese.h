@@ -12,12 +12,16 @@
 #include <OpenTissue/core/math/math_vector3.h>
 #include <OpenTissue/core/math/math_matrix3x3.h>
 #include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_mean_curvature.h>
+#include <OpenTissue/core/containers/grid/util/grid_derivative_fields.h>
+#include <OpenTissue/core/containers/grid/util/grid_narrow_band.h>
 
 #include <boost/cast.hpp> //--- needed for numeric_cast
 
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 namespace OpenTissue
 {
@@ -95,6 +99,11 @@ namespace OpenTissue
 
         input_type unused = phi.unused();
 
+        //--- The curvature of all nodes is computed in a single sweep
+        grid_type_in kappa;
+        if(mu)
+          mean_curvature_field( phi, kappa );
+
         for(;input!=input_end;++input,++output)
         {
           if(*input!=unused)
@@ -105,8 +114,7 @@ namespace OpenTissue
             output_type speed  = output_type(0);
             if(mu)
             {
-              input_type H = input_type(0);
-              mean_curvature( input, H );
+              input_type H = kappa( input.get_index() );
               speed -= mu*H;
             }
             speed += nu;
@@ -120,6 +128,144 @@ namespace OpenTissue
         return max_delta;
       }
 
+      /**
+      * Update Phi level set in a narrow band.
+      * Applies the ``Chan-Vese'' speed-function to the nodes in the band of
+      * phi. The result overwrites phi, the nodes outside the band are frozen.
+      *
+      * @param phi      Input/output level set.
+      * @param U        Input image, must have the same dimensions as phi.
+      * @param C_in     Mean value of inside region.
+      * @param C_out    Mean value of outside region.
+      * @param lambda   Weight of input/output regions (legal values 0..1) 0.5 means input and output are weighted equally.
+      * @param mu       Mean Curvature regularization.
+      * @param nu       Area regularization.
+      * @param dt       Time-step to use in update.
+      * @param band     A narrow band that has been initialized with phi.
+      *
+      * @return         Maximum change in value of level set during update.
+      */
+      template<
+        typename grid_type_in
+        , typename image_grid_type
+        , typename real_type
+      >
+      inline real_type update(
+        grid_type_in & phi
+      , image_grid_type const & U
+      , typename image_grid_type::value_type const & C_in
+      , typename image_grid_type::value_type const & C_out
+      , real_type const & lambda
+      , real_type const & mu
+      , real_type const & nu
+      , real_type const & dt
+      , NarrowBand<grid_type_in> & band
+      )
+      {
+        using std::max;
+        using std::fabs;
+
+        typedef typename grid_type_in::value_type            input_type;
+
+        assert(mu>=0     || !"update(): curvature coefficient must be non-negative");
+        assert(nu>=0     || !"update(): area coefficient must be non-negative");
+        assert(dt>0      || !"update(): time-step must be positive");
+        assert(lambda>=0 || !"update(): region weight must be non-negative");
+        assert(lambda<=1 || !"update(): region weight must be less than or equal to one");
+        assert(phi.size() == U.size() || !"update(): incompatible grid dimensions");
+
+        real_type lambda_in   = lambda;
+        real_type lambda_out  = real_type(1.0) - lambda;
+
+        size_t const I = phi.I();
+        size_t const J = phi.J();
+
+        std::vector<size_t> const & active = band.active();
+        int const count = static_cast<int>( active.size() );
+
+        //--- All new values are computed before any are written, the curvature depends on the neighbors
+        std::vector<real_type> speed( count );
+
+#pragma omp parallel for schedule(static) if(count > 4096)
+        for(int n = 0; n < count; ++n)
+        {
+          size_t const idx = active[n];
+          real_type const u0 = static_cast<real_type>( U(idx) );
+          real_type value = real_type(0);
+          if(mu)
+          {
+            real_type H = real_type(0);
+            mean_curvature( phi, idx % I, (idx / I) % J, idx / (I*J), H );
+            value -= mu*H;
+          }
+          value += nu;
+          value -= lambda_in*(u0-C_in)*(u0-C_in);
+          value += lambda_out*(u0-C_out)*(u0-C_out);
+          speed[n] = value;
+        }
+
+        real_type max_delta   = real_type(0.0);//--- maximum change in level set update
+        input_type * values = phi.data();
+        for(int n = 0; n < count; ++n)
+        {
+          input_type const old_val = values[ active[n] ];
+          values[ active[n] ] = static_cast<input_type>( old_val - dt*speed[n] );
+          max_delta = max( max_delta, static_cast<real_type>( fabs( values[ active[n] ] - old_val ) ) );
+        }
+        return max_delta;
+      }
+
+      /**
+      * Compute Region Sums in a Narrow Band.
+      * Adds the image values and node counts of the inside and outside
+      * regions of the nodes in the band, weighted by the given sign. This is
+      * used to keep C_in and C_out up to date without visiting the nodes
+      * outside the band, whose signs do not change.
+      *
+      * @param phi          Level set.
+      * @param U            An image.
+      * @param band         A narrow band of phi.
+      * @param weight       Plus or minus one, to add or subtract the sums.
+      * @param sum_in       The sum of image values inside.
+      * @param count_in     The number of nodes inside.
+      * @param sum_out      The sum of image values outside.
+      * @param count_out    The number of nodes outside.
+      */
+      template<typename grid_type,typename image_grid_type>
+      inline void band_sums(
+        grid_type const & phi
+        , image_grid_type const & U
+        , NarrowBand<grid_type> const & band
+        , double const & weight
+        , double & sum_in
+        , double & count_in
+        , double & sum_out
+        , double & count_out
+        )
+      {
+        typedef typename grid_type::value_type           input_type;
+
+        std::vector<size_t> const & active = band.active();
+        input_type const unused = phi.unused();
+        for(size_t n = 0; n < active.size(); ++n)
+        {
+          input_type const value = phi( active[n] );
+          if(value == unused)
+            continue;
+          double const u = static_cast<double>( U( active[n] ) );
+          if(value < 0)
+          {
+            sum_in   += weight*u;
+            count_in += weight;
+          }
+          else
+          {
+            sum_out   += weight*u;
+            count_out += weight;
+          }
+        }
+      }
+
       /**
       * Compute C_in
       *
@@ -358,6 +504,116 @@ namespace OpenTissue
       std::cout << "Chan-Vese: Maximum iterations reached minimum" << std::endl;
     }
 
+    /**
+    * Chan-Vese segmentation in a narrow band.
+    * Does the same as chan_vese_auto_in_out(), but only the nodes in the band
+    * are updated, and the mean values of the inside and outside regions are
+    * kept up to date from the changes in the band. Thus the cost of an
+    * iteration is proportional to the area of the zero level set. The band
+    * is rebuilt whenever the zero level set comes close to the edge of the
+    * band, see NarrowBand::needs_rebuild().
+    *
+    * @param phi      Input/output level set.
+    * @param U        Input image, must have the same dimensions as phi.
+    * @param lambda   Weight of input/output regions (legal values 0..1) 0.5 means input and output are weighted equally.
+    * @param mu       Mean Curvature regularization.
+    * @param nu       Area (Well, it is really volume:-) regularization.
+    * @param dt       Time-step to use in update.
+    * @param band     A narrow band that has been initialized with phi.
+    *
+    * @param epsilon          Steady state threshold testing.
+    * @param max_iterations   Maximum number of iterations allowed to reach steady state.
+    *
+    * @return                 The number of iterations that were done.
+    */
+    template<
+      typename grid_type_in
+      , typename image_grid_type
+      , typename real_type
+    >
+    inline size_t chan_vese_auto_in_out(
+    grid_type_in  & phi
+    , image_grid_type const & U
+    , real_type const & lambda
+    , real_type const & mu
+    , real_type const & nu
+    , real_type const & dt
+    , NarrowBand<grid_type_in> & band
+    , real_type const & epsilon = 10e-7
+    , size_t const & max_iterations = 10
+    )
+    {
+      typedef typename image_grid_type::value_type       image_type;
+      typedef typename grid_type_in::value_type          input_type;
+
+      assert(mu>=0     || !"chan_vese_auto_in_out(): curvature coefficient must be non-negative");
+      assert(nu>=0     || !"chan_vese_auto_in_out(): area coefficient must be non-negative");
+      assert(dt>0      || !"chan_vese_auto_in_out(): time-step must be positive");
+      assert(lambda>=0 || !"chan_vese_auto_in_out(): region weight must be non-negative");
+      assert(lambda<=1 || !"chan_vese_auto_in_out(): region weight must be less than or equal to one");
+
+      //--- The region sums are computed once over the whole grid, nodes outside the band never change sign
+      double sum_in    = 0.0;
+      double count_in  = 0.0;
+      double sum_out   = 0.0;
+      double count_out = 0.0;
+      input_type const unused = phi.unused();
+      for(size_t idx = 0; idx < phi.size(); ++idx)
+      {
+        if(phi(idx) == unused)
+          continue;
+        if(phi(idx) < 0)
+        {
+          sum_in += U(idx);
+          count_in += 1.0;
+        }
+        else
+        {
+          sum_out += U(idx);
+          count_out += 1.0;
+        }
+      }
+
+      image_type   C_in           = image_type( sum_in / count_in );
+      image_type   C_out          = image_type( sum_out / count_out );
+      size_t unchanged = 0;
+      for(size_t iteration = 0;iteration<max_iterations;++iteration)
+      {
+        if (C_in == C_out)
+        {
+          const real_type upper = boost::numeric_cast<real_type>( 1.1 );
+          const real_type lower = boost::numeric_cast<real_type>( 0.9 );
+          C_in  = boost::numeric_cast<image_type>( C_in* upper   );
+          C_out = boost::numeric_cast<image_type>( C_out * lower );
+        }
+
+        chan_vese::band_sums( phi, U, band, -1.0, sum_in, count_in, sum_out, count_out );
+        real_type max_delta = chan_vese::update(phi,U,C_in,C_out,lambda,mu,nu,dt,band);
+        chan_vese::band_sums( phi, U, band, 1.0, sum_in, count_in, sum_out, count_out );
+        if(max_delta < epsilon )
+          return iteration + 1;
+
+        if(band.needs_rebuild( phi ))
+          band.rebuild( phi );
+
+        image_type   C_in_new  = image_type( sum_in / count_in );
+        image_type   C_out_new = image_type( sum_out / count_out );
+
+        if((C_in == C_in_new)&&(C_out == C_out_new))
+        {
+          ++unchanged;
+          if(unchanged >= 3)
+            return iteration + 1;
+        }
+        else if(unchanged>0)
+          --unchanged;
+
+        C_in = C_in_new;
+        C_out = C_out_new;
+      }
+      return max_iterations;
+    }
+
     /**
     *
     * @param phi      Input level set.
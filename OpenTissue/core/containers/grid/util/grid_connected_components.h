@@ -9,171 +9,353 @@
 //
 #include <OpenTissue/configuration.h>
 
-#include <boost/multi_array.hpp>
+#include <OpenTissue/utility/utility_openmp.h>
 
 #include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <cassert>
 
 namespace OpenTissue
 {
   namespace grid
   {
 
+    /**
+    * Connected Component Statistics.
+    */
+    template<typename math_types>
+    class ComponentStatistics
+    {
+    public:
+
+      typedef typename math_types::vector3_type   vector3_type;
+
+    public:
+
+      size_t        m_count;       ///< Number of voxels in the component.
+      size_t        m_min[3];      ///< Smallest node indices of the voxels in the component.
+      size_t        m_max[3];      ///< Largest node indices of the voxels in the component.
+      vector3_type  m_centroid;    ///< Mean world coordinate of the voxels in the component.
+
+    public:
+
+      ComponentStatistics()
+        : m_count(0)
+        , m_centroid(0,0,0)
+      {
+        m_min[0] = m_min[1] = m_min[2] = std::numeric_limits<size_t>::max();
+        m_max[0] = m_max[1] = m_max[2] = 0;
+      }
+
+    };
+
     namespace detail
     {
+
       /**
-      * Associate two adjacent components so that they represent the same component.
-      * @param i Component label value of a pixel under consideration.
-      * @param j Component label value of an adjacent pixel.
-      * @param assoc Array containing associations of component label values.
+      * Find Root.
+      * Finds the root of a node in a union-find forest, the path to the root
+      * is halved on the way.
+      *
+      * @param parent   The parent of each node.
+      * @param x        The node.
+      *
+      * @return         The root of the node.
       */
-      template< typename unsigned_int_container>
-      inline void associate(size_t i, size_t j, unsigned_int_container & assoc)
+      inline size_t find_root(std::vector<size_t> & parent, size_t x)
       {
-        if ( j == 0 || j == i )
-          return;
-
-        size_t search = j;
-        do
+        while(parent[x] != x)
         {
-          search = assoc[search];
+          parent[x] = parent[ parent[x] ];
+          x = parent[x];
         }
-        while ( search != j && search != i );
+        return x;
+      }
 
-        if ( search == j )
-        {
-          std::swap(assoc[i],assoc[j]);
-        }
+      /**
+      * Unite.
+      * Merges the sets of two nodes. The root with the largest index is linked
+      * below the other root, thus the root of a set is always its smallest
+      * node and a parent never has a larger index than its child.
+      *
+      * @param parent   The parent of each node.
+      * @param a        A node.
+      * @param b        Another node.
+      */
+      inline void unite(std::vector<size_t> & parent, size_t a, size_t b)
+      {
+        a = find_root( parent, a );
+        b = find_root( parent, b );
+        if(a < b)
+          parent[b] = a;
+        else if(b < a)
+          parent[a] = b;
+      }
+
+      /**
+      * Get Previous Neighbors.
+      * Computes the offsets of the neighbors that precede a voxel in
+      * memory order.
+      *
+      * @param connectivity   The connectivity, 6, 18 or 26.
+      * @param only_below     If true only neighbors in the previous z-layer are returned.
+      * @param offsets        Upon return holds the (i,j,k) offsets of the neighbors.
+      *
+      * @return               The number of neighbors.
+      */
+      inline size_t previous_neighbors(size_t const & connectivity, bool const & only_below, int offsets[13][3])
+      {
+        size_t count = 0;
+        for(int dk = -1; dk <= 0; ++dk)
+          for(int dj = -1; dj <= 1; ++dj)
+            for(int di = -1; di <= 1; ++di)
+            {
+              if(dk == 0 && (only_below || dj > 0 || (dj == 0 && di >= 0)))
+                continue;
+              int const order = std::abs(di) + std::abs(dj) + std::abs(dk);
+              if( (connectivity == 6 && order > 1) || (connectivity == 18 && order > 2) )
+                continue;
+              offsets[count][0] = di;
+              offsets[count][1] = dj;
+              offsets[count][2] = dk;
+              ++count;
+            }
+        return count;
       }
+
+      /**
+      * Unite Layer.
+      * Merges the foreground voxels in a z-layer with their foreground neighbors.
+      *
+      * @param values     The image values, non-zero values are foreground.
+      * @param parent     The union-find forest.
+      * @param I
+      * @param J
+      * @param k          The z-layer.
+      * @param k_low      Neighbors below this layer are ignored.
+      * @param offsets    The neighbor offsets.
+      * @param count      The number of neighbor offsets.
+      */
+      template<typename value_type>
+      inline void unite_layer(
+        value_type const * values
+        , std::vector<size_t> & parent
+        , size_t const & I
+        , size_t const & J
+        , size_t const & k
+        , size_t const & k_low
+        , int const offsets[13][3]
+        , size_t const & count
+        )
+      {
+        value_type const zero = value_type(0);
+        for(size_t j = 0; j < J; ++j)
+          for(size_t i = 0; i < I; ++i)
+          {
+            size_t const idx = (k*J + j)*I + i;
+            if(values[idx] == zero)
+              continue;
+            for(size_t n = 0; n < count; ++n)
+            {
+              int const ni = static_cast<int>(i) + offsets[n][0];
+              int const nj = static_cast<int>(j) + offsets[n][1];
+              int const nk = static_cast<int>(k) + offsets[n][2];
+              if(ni < 0 || ni >= static_cast<int>(I) || nj < 0 || nj >= static_cast<int>(J) || nk < static_cast<int>(k_low))
+                continue;
+              size_t const nidx = (static_cast<size_t>(nk)*J + nj)*I + ni;
+              if(values[nidx] != zero)
+                unite( parent, idx, nidx );
+            }
+          }
+      }
+
     } // namespace detail
 
     /**
-    * Compute the 8-connected components of a binary image.
-    * The components in the returned image are labeled with positive integer values.
-    * If the image is identically zero, then the components image is identically
-    * zero and the returned quantity is zero.
+    * Compute the connected components of a binary image.
     *
-    * @see    grid/util/connected_components2D.h for details.
+    * The image is split into slabs of z-layers that are labeled in parallel
+    * with a union-find forest over the voxel indices, the roots are merged
+    * such that the root of a component is its first voxel in memory order.
+    * Afterwards the slab borders are merged in rounds, where each round
+    * merges neighboring groups of slabs pairwise. The groups of a round
+    * touch disjoint parts of the forest, so no locking is needed. The labels
+    * and the statistics are computed in a single parallel pass.
     *
-    * @param  image      Input image. Should be binary, with 1 representing data.
-    * @param  components Output image. Each components is labelled with an unique identifier.
-    * @return Number of components found.
+    * The components are labeled 1, 2, ... in the order of their first voxel
+    * in memory order, thus the result does not depend on the number of
+    * threads. Background voxels are labeled zero.
+    *
+    * @param  image         Input image. Non-zero values are foreground.
+    * @param  components    Output image. Each component is labelled with a unique identifier.
+    * @param  connectivity  The connectivity of neighboring voxels, 6 (faces), 18 (faces
+    *                       and edges) or 26 (faces, edges and corners).
+    * @param  statistics    Upon return statistics[c-1] holds the statistics of the component with label c.
+    *
+    * @return               Number of components found.
     */
-    template < typename grid_type >
-    inline size_t connected_components(grid_type const & image, grid_type & components)
+    template < typename grid_type, typename label_grid_type >
+    inline size_t connected_components(
+      grid_type const & image
+      , label_grid_type & components
+      , size_t const & connectivity
+      , std::vector< ComponentStatistics<typename grid_type::math_types> > & statistics
+      )
     {
-      components.create(image.I(), image.J(), image.K(), 1,1,1);
-
-      // Create a temporary copy of image to store intermediate information during boundary extraction.
-      // The original image is embedded in an image with two more rows, two more columns and two more slices
-      // so that the image boundary pixels are properly handled.
-      typedef boost::multi_array<size_t, 3> array_type;
-      typedef array_type::index array_index;
-
-      size_t width = image.I()+2;
-      size_t height = image.J()+2;
-      size_t depth = image.K()+2;
-      
-      array_type tmp(boost::extents[width][height][depth]);
+      typedef typename grid_type::value_type                    value_type;
+      typedef typename grid_type::math_types                    math_types;
+      typedef typename math_types::real_type                    real_type;
+      typedef typename math_types::vector3_type                 vector3_type;
+      typedef typename label_grid_type::value_type              label_type;
+      typedef ComponentStatistics<math_types>                   statistics_type;
+
+      assert( (connectivity == 6 || connectivity == 18 || connectivity == 26) || !"connected_components(): connectivity must be 6, 18 or 26");
+
+      size_t const I  = image.I();
+      size_t const J  = image.J();
+      size_t const K  = image.K();
+      size_t const IJ = I*J;
+      size_t const N  = IJ*K;
+
+      components.create( image.min_coord(), image.max_coord(), I, J, K );
+      statistics.clear();
+      if(N == 0)
+        return 0;
+
+      value_type const * values = image.data();
+      value_type const   zero   = value_type(0);
+
+      int offsets[13][3];
+      int below[13][3];
+      size_t const count_offsets = detail::previous_neighbors( connectivity, false, offsets );
+      size_t const count_below   = detail::previous_neighbors( connectivity, true, below );
+
+      size_t const slab_size = 8u;
+      int    const slabs     = static_cast<int>( (K + slab_size - 1)/slab_size );
+
+      std::vector<size_t> parent( N );
+
+      //--- Label each slab on its own
+#pragma omp parallel for schedule(dynamic) if(slabs > 1)
+      for(int s = 0; s < slabs; ++s)
       {
-        array_index xp1, yp1, zp1;
-        size_t x0,y0, z0;
-        for (z0 = 0, zp1 = 1; z0 < image.K(); ++z0, ++zp1)
-          for (y0 = 0, yp1 = 1; y0 < image.J(); ++y0, ++yp1)
-            for (x0 = 0, xp1 = 1; x0 < image.I(); ++x0, ++xp1)
-              tmp[xp1][yp1][zp1] = ( image(x0,y0,z0) ? 1 : 0 );
+        size_t const k0 = s*slab_size;
+        size_t const k1 = std::min( k0 + slab_size, K );
+        for(size_t idx = k0*IJ; idx < k1*IJ; ++idx)
+          parent[idx] = idx;
+        for(size_t k = k0; k < k1; ++k)
+          detail::unite_layer( values, parent, I, J, k, k0, offsets, count_offsets );
       }
 
-      // label connected components in 1D array
-      size_t initial_component_count = 0;
-
-      size_t * val = tmp.data();
-      for (size_t i = 0; i < tmp.num_elements(); ++i, ++val)
+      //--- Merge groups of slabs pairwise across their common border
+      for(int width = 1; width < slabs; width *= 2)
       {
-        if ( *val )
+        int const pairs = (slabs + 2*width - 1)/(2*width);
+
+#pragma omp parallel for schedule(dynamic) if(pairs > 1)
+        for(int p = 0; p < pairs; ++p)
         {
-          initial_component_count++;
-          while ( *val > 0 )
-          {
-            // loop terminates since tmp is zero on its boundaries
-            *val = initial_component_count;
-            ++i;
-            ++val;
-          }
+          int const s = (2*p + 1)*width;
+          if(s >= slabs)
+            continue;
+          size_t const k = s*slab_size;
+          detail::unite_layer( values, parent, I, J, k, k - 1, below, count_below );
         }
       }
 
-      if ( initial_component_count == 0 )
+      //--- Parents never come after their children, so a single sweep links every voxel directly to its root
+      std::vector<size_t> roots;
+      for(size_t idx = 0; idx < N; ++idx)
       {
-        // input image is identically zero
-        std::fill(components.begin(), components.end(), 0);
-        return 0;
+        if(values[idx] == zero)
+          continue;
+        parent[idx] = parent[ parent[idx] ];
+        if(parent[idx] == idx)
+          roots.push_back( idx );
       }
 
-      // associative memory for merging
-      std::vector<size_t> assoc(initial_component_count+1,0);
-      for (size_t i = 0; i < initial_component_count + 1; ++i)
-        assoc[i] = i;
-
-      // Merge equivalent components.
-      // Voxel (x,y,z) has previous neighbors:
-      // (x-1,y-1,z-1), (x,y-1,z-1), (x+1,y-1,z-1),
-      // (x-1,y,z-1), (x,y,z-1), (x+1,y,z-1),
-      // (x-1,y+1,z-1), (x,y+1,z-1), (x+1,y+1,z-1),
-      // (x-1,y-1,z), (x,y-1,z), (x+1,y-1,z),
-      // (x-1,y,z)
-      // [13 of 26 voxels visited before (x,y,z) is visited, get component labels from them].
-      for (array_index z = 1; z < depth-1; ++z)
-        for (array_index y = 1; y < height-1; ++y)
-          for (array_index x = 1; x < width-1; ++x)
-          {
-            size_t value = tmp[x][y][z];
-            if ( value > 0 )
-            {
-              detail::associate(value, tmp[x-1][y-1][z-1], assoc);
-              detail::associate(value, tmp[x  ][y-1][z-1], assoc);
-              detail::associate(value, tmp[x+1][y-1][z-1], assoc);
-              detail::associate(value, tmp[x-1][y  ][z-1], assoc);
-              detail::associate(value, tmp[x  ][y  ][z-1], assoc);
-              detail::associate(value, tmp[x+1][y  ][z-1], assoc);
-              detail::associate(value, tmp[x-1][y+1][z-1], assoc);
-              detail::associate(value, tmp[x  ][y+1][z-1], assoc);
-              detail::associate(value, tmp[x+1][y+1][z-1], assoc);
-              detail::associate(value, tmp[x-1][y-1][z  ], assoc);
-              detail::associate(value, tmp[x  ][y-1][z  ], assoc);
-              detail::associate(value, tmp[x+1][y-1][z  ], assoc);
-              detail::associate(value, tmp[x-1][y  ][z  ], assoc);
-            }
-          }
+      size_t const C = roots.size();
+      int    const T = std::max( 1, std::min( utility::get_max_threads(), slabs ) );
+      std::vector< std::vector<statistics_type> > thread_statistics( T );
 
-          // replace each cycle of equivalent labels by a single label
-          size_t component_count = 0;
-          for (size_t i = 1; i <= initial_component_count; ++i)
-          {
-            if ( i <= assoc[i] )
-            {
-              component_count++;
-              size_t current = i;
-              while ( assoc[current] != i )
+#pragma omp parallel num_threads(T)
+      {
+        std::vector<statistics_type> & local = thread_statistics[ utility::get_thread_num() ];
+        local.resize( C );
+
+#pragma omp for schedule(static)
+        for(int s = 0; s < slabs; ++s)
+        {
+          size_t const k0 = s*slab_size;
+          size_t const k1 = std::min( k0 + slab_size, K );
+          for(size_t k = k0; k < k1; ++k)
+            for(size_t j = 0; j < J; ++j)
+              for(size_t i = 0; i < I; ++i)
               {
-                size_t next = assoc[current];
-                assoc[current] = component_count;
-                current = next;
+                size_t const idx = (k*J + j)*I + i;
+                if(values[idx] == zero)
+                {
+                  components(idx) = label_type(0);
+                  continue;
+                }
+                size_t const label = std::lower_bound( roots.begin(), roots.end(), parent[idx] ) - roots.begin();
+                components(idx) = static_cast<label_type>( label + 1 );
+
+                statistics_type & stats = local[label];
+                size_t const index[3] = { i, j, k };
+                for(size_t m = 0; m < 3u; ++m)
+                {
+                  stats.m_min[m] = std::min( stats.m_min[m], index[m] );
+                  stats.m_max[m] = std::max( stats.m_max[m], index[m] );
+                  stats.m_centroid(m) += static_cast<real_type>( index[m] );
+                }
+                ++stats.m_count;
               }
-              assoc[current] = component_count;
-            }
-          }
+        }
+      }
 
-          // pack a relabeled image in smaller size output
+      //--- Combine the statistics of the threads
+      statistics.resize( C );
+      real_type const spacing[3] = { image.dx(), image.dy(), image.dz() };
+      for(size_t c = 0; c < C; ++c)
+      {
+        statistics_type & stats = statistics[c];
+        for(int t = 0; t < T; ++t)
+        {
+          statistics_type const & local = thread_statistics[t][c];
+          stats.m_count    += local.m_count;
+          stats.m_centroid += local.m_centroid;
+          for(size_t m = 0; m < 3u; ++m)
           {
-            array_index xp1, yp1, zp1;
-            size_t x0,y0,z0;
-            for (z0 = 0, zp1 = 1; z0 < components.K(); ++z0, ++zp1)
-              for (y0 = 0, yp1 = 1; y0 < components.J(); ++y0, ++yp1)
-                for (x0 = 0, xp1 = 1; x0 < components.I(); ++x0, ++xp1)
-                  components(x0,y0,z0) = assoc[ tmp[xp1][yp1][zp1] ];
+            stats.m_min[m] = std::min( stats.m_min[m], local.m_min[m] );
+            stats.m_max[m] = std::max( stats.m_max[m], local.m_max[m] );
           }
+        }
+        vector3_type centroid = image.min_coord();
+        for(size_t m = 0; m < 3u; ++m)
+          centroid(m) += spacing[m]*stats.m_centroid(m)/stats.m_count;
+        stats.m_centroid = centroid;
+      }
+      return C;
+    }
 
-          return component_count;
+    /**
+    * Compute the 26-connected components of a binary image.
+    * The components in the returned image are labeled with positive integer values.
+    * If the image is identically zero, then the components image is identically
+    * zero and the returned quantity is zero.
+    *
+    * @param  image      Input image. Should be binary, with 1 representing data.
+    * @param  components Output image. Each components is labelled with an unique identifier.
+    * @return Number of components found.
+    */
+    template < typename grid_type >
+    inline size_t connected_components(grid_type const & image, grid_type & components)
+    {
+      std::vector< ComponentStatistics<typename grid_type::math_types> > statistics;
+      return connected_components( image, components, 26u, statistics );
     }
 
   } // namespace grid
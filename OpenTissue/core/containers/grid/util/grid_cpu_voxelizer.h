@@ -0,0 +1,688 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_CPU_VOXELIZER_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_CPU_VOXELIZER_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/utility/utility_openmp.h>
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    /**
+    * Surface Voxelization Types.
+    *
+    *   voxelization_conservative   All voxels overlapped by a triangle are set, a triangle
+    *                               without area sets the voxels overlapped by its segment or
+    *                               point. The voxels of a surface are 26-separating, no path
+    *                               through face, edge or corner neighbors passes the surface.
+    *   voxelization_6_separating   Thin voxelization, a voxel is set if the triangle crosses
+    *                               its center line along the dominant axis of the triangle
+    *                               normal. The voxels of a surface are 6-separating, no path
+    *                               through face neighbors passes the surface. Triangles without
+    *                               area have no normal and set no voxels.
+    *
+    * See M. Schwarz and H.-P. Seidel, "Fast Parallel Surface and Solid Voxelization on GPUs", 2010.
+    */
+    enum voxelization_type { voxelization_conservative, voxelization_6_separating };
+
+    namespace detail
+    {
+
+      /**
+      * Gather the triangles of a mesh. Faces with more than three vertices
+      * are split into a fan of triangles.
+      *
+      * @param mesh       The mesh.
+      * @param corners    Upon return holds three corners for each triangle.
+      */
+      template<typename mesh_type, typename vector3_type>
+      inline void get_voxelizer_triangles(mesh_type & mesh, std::vector<vector3_type> & corners)
+      {
+        typedef typename mesh_type::face_iterator            face_iterator;
+        typedef typename mesh_type::face_vertex_circulator   face_vertex_circulator;
+
+        corners.clear();
+        corners.reserve( 3*mesh.size_faces() );
+        for(face_iterator f = mesh.face_begin(); f != mesh.face_end(); ++f)
+        {
+          face_vertex_circulator v( *f ), vend;
+          vector3_type const first = v->m_coord;
+          ++v;
+          if(v == vend)
+            continue;
+          vector3_type previous = v->m_coord;
+          for(++v; v != vend; ++v)
+          {
+            corners.push_back( first );
+            corners.push_back( previous );
+            corners.push_back( v->m_coord );
+            previous = v->m_coord;
+          }
+        }
+      }
+
+      /**
+      * Triangle Voxel Overlap Test.
+      * Precomputes the separating axis tests of a triangle, such that each
+      * voxel is tested by a few dot products with its center. A voxel is the
+      * box of one node spacing around a node.
+      *
+      * The triangle plane is tested against the voxel, and the triangle
+      * projections onto the coordinate planes are tested against the voxel
+      * projections with edge functions. In the conservative mode all three
+      * projections are tested against the projected squares, which together
+      * with the bounding box test is the separating axis test of a triangle
+      * and a box. In the 6-separating mode the plane test only accepts the
+      * voxels whose center line along the dominant axis is crossed by the
+      * plane, and only the projection along the dominant axis is tested
+      * against the projected diamond inscribed in the square.
+      *
+      * A triangle without area has a zero normal, so the plane test accepts
+      * every voxel. The corners are collinear and the projected edges run in
+      * both directions along the segment, so in the conservative mode the
+      * edge functions become the separating axis tests of the segment and
+      * the voxel, and for a single point only the bounding box test is left.
+      */
+      template<typename vector3_type>
+      class TriangleVoxelTest
+      {
+      public:
+
+        typedef typename vector3_type::value_type  real_type;
+
+      protected:
+
+        vector3_type  m_n;                  ///< The triangle normal, not normalized.
+        real_type     m_d;                  ///< The plane offset, the dot product of the normal and a vertex.
+        real_type     m_plane_radius;       ///< The largest accepted distance of a voxel center from the plane, in normal lengths.
+        int           m_projections;        ///< The number of projections to test.
+        int           m_axis[3];            ///< The axes of the projections.
+        real_type     m_edge[3][3][2];      ///< Inward normals of the projected edges.
+        real_type     m_offset[3][3];       ///< The smallest accepted edge function values.
+        bool          m_empty;              ///< True if the triangle sets no voxels.
+
+      public:
+
+        /**
+        * Specialized Constructor.
+        *
+        * @param a, b, c    The corners of the triangle.
+        * @param h          The node spacing along each axis.
+        * @param type       The type of voxelization.
+        */
+        TriangleVoxelTest(
+          vector3_type const & a
+          , vector3_type const & b
+          , vector3_type const & c
+          , vector3_type const & h
+          , voxelization_type const & type
+          )
+        {
+          using std::fabs;
+          using std::max;
+
+          vector3_type const v[3] = { a, b, c };
+
+          m_n = cross( b - a, c - a );
+          m_d = m_n * a;
+          m_empty = ( type != voxelization_conservative && m_n(0) == 0 && m_n(1) == 0 && m_n(2) == 0 );
+
+          real_type const extent[3] = { fabs( m_n(0) )*h(0), fabs( m_n(1) )*h(1), fabs( m_n(2) )*h(2) };
+          int dominant = 0;
+          for(int m = 1; m < 3; ++m)
+            if(extent[m] > extent[dominant])
+              dominant = m;
+
+          if(type == voxelization_conservative)
+          {
+            m_plane_radius = ( extent[0] + extent[1] + extent[2] )/real_type(2);
+            m_projections  = 3;
+            m_axis[0] = 0;
+            m_axis[1] = 1;
+            m_axis[2] = 2;
+          }
+          else
+          {
+            m_plane_radius = extent[dominant]/real_type(2);
+            m_projections  = 1;
+            m_axis[0] = dominant;
+          }
+
+          for(int p = 0; p < m_projections; ++p)
+          {
+            int const q = m_axis[p];
+            int const u = (q + 1) % 3;
+            int const w = (q + 2) % 3;
+            real_type const s = ( m_n(q) < 0 ) ? real_type(-1) : real_type(1);
+            for(int e = 0; e < 3; ++e)
+            {
+              vector3_type const & start = v[e];
+              vector3_type const & end   = v[(e + 1) % 3];
+              real_type const nu = -s*( end(w) - start(w) );
+              real_type const nw =  s*( end(u) - start(u) );
+              real_type const radius = (type == voxelization_conservative)
+                ? ( fabs( nu )*h(u) + fabs( nw )*h(w) )/real_type(2)
+                : max( fabs( nu )*h(u), fabs( nw )*h(w) )/real_type(2);
+              m_edge[p][e][0] = nu;
+              m_edge[p][e][1] = nw;
+              m_offset[p][e]  = nu*start(u) + nw*start(w) - radius;
+            }
+          }
+        }
+
+      public:
+
+        /**
+        * Test if the triangle sets no voxels at all, this is the case for a
+        * triangle without area in the 6-separating mode.
+        */
+        bool empty() const { return m_empty; }
+
+        /**
+        * Test Voxel.
+        *
+        * @param center   The center of the voxel.
+        *
+        * @return         True if the voxel belongs to the voxelization of the triangle.
+        */
+        bool overlaps(vector3_type const & center) const
+        {
+          real_type const distance = m_n*center - m_d;
+          if(distance > m_plane_radius || distance < -m_plane_radius)
+            return false;
+          for(int p = 0; p < m_projections; ++p)
+          {
+            int const q = m_axis[p];
+            real_type const cu = center( (q + 1) % 3 );
+            real_type const cw = center( (q + 2) % 3 );
+            for(int e = 0; e < 3; ++e)
+              if(m_edge[p][e][0]*cu + m_edge[p][e][1]*cw < m_offset[p][e])
+                return false;
+          }
+          return true;
+        }
+
+      };
+
+      /**
+      * Range of node indices along an axis covered by an interval.
+      *
+      * @param lo       The lower end of the interval.
+      * @param hi       The upper end of the interval.
+      * @param origin   The coordinate of the first node.
+      * @param h        The node spacing.
+      * @param n        The number of nodes.
+      * @param first    Upon return holds the first node inside the interval.
+      * @param last     Upon return holds the last node inside the interval, less than first if there are none.
+      */
+      template<typename real_type>
+      inline void voxelizer_range(
+        real_type const & lo
+        , real_type const & hi
+        , real_type const & origin
+        , real_type const & h
+        , int const & n
+        , int & first
+        , int & last
+        )
+      {
+        using std::min;
+        using std::max;
+        using std::ceil;
+        using std::floor;
+
+        real_type const a = ceil(  (lo - origin)/h );
+        real_type const b = floor( (hi - origin)/h );
+        if(!(a <= static_cast<real_type>( n - 1 )) || !(b >= real_type(0)))
+        {
+          first = 0;
+          last  = -1;
+          return;
+        }
+        first = static_cast<int>( max( a, real_type(0) ) );
+        last  = static_cast<int>( min( b, static_cast<real_type>( n - 1 ) ) );
+      }
+
+      /**
+      * Cut the z-slices of a grid into slabs, a few slabs per thread for load balancing.
+      */
+      inline void voxelizer_slabs(int const & K, std::vector<int> & slab_of, std::vector<int> & k_begin, std::vector<int> & k_end)
+      {
+        using std::min;
+
+        int const slabs = min( K, 4*OpenTissue::utility::get_max_threads() );
+        slab_of.resize( K );
+        k_begin.resize( slabs );
+        k_end.resize( slabs );
+        for(int s = 0; s < slabs; ++s)
+        {
+          k_begin[s] = (s*K)/slabs;
+          k_end[s]   = ((s + 1)*K)/slabs;
+          for(int k = k_begin[s]; k < k_end[s]; ++k)
+            slab_of[k] = s;
+        }
+      }
+
+      /**
+      * Bin the triangles into the slabs overlapped by their ranges of z-slices.
+      */
+      inline void voxelizer_bins(
+        std::vector<int> const & range
+        , std::vector<int> const & slab_of
+        , std::vector< std::vector<int> > & bins
+        )
+      {
+        int const T = static_cast<int>( range.size() / 6 );
+        for(int t = 0; t < T; ++t)
+        {
+          int const * r = &range[6*t];
+          if(r[0] > r[1] || r[2] > r[3] || r[4] > r[5])
+            continue;
+          for(int s = slab_of[r[4]]; s <= slab_of[r[5]]; ++s)
+            bins[s].push_back( t );
+        }
+      }
+
+      /**
+      * Partition the triangles for a parallel voxelization. The grid is cut
+      * into slabs of z-slices, see voxelizer_slabs(), and each triangle is
+      * binned into the slabs overlapped by its ranges of nodes.
+      *
+      * @param corners    The corners of the triangles.
+      * @param size       The number of nodes along each axis.
+      * @param origin     The coordinates of the first node.
+      * @param h          The node spacing along each axis.
+      * @param rows       If true the ranges hold the rows of nodes along the x-axis that
+      *                   pass the box of a triangle and the x-range is left empty, otherwise
+      *                   they hold the nodes whose voxels overlap the box of a triangle.
+      * @param range      Upon return holds the first and last node along each axis for each triangle.
+      * @param k_begin    Upon return holds the first z-slice of each slab.
+      * @param k_end      Upon return holds the z-slice after the last one of each slab.
+      * @param bins       Upon return holds the triangles of each slab.
+      */
+      template<typename vector3_type>
+      inline void voxelizer_partition(
+        std::vector<vector3_type> const & corners
+        , int const * size
+        , vector3_type const & origin
+        , vector3_type const & h
+        , bool const & rows
+        , std::vector<int> & range
+        , std::vector<int> & k_begin
+        , std::vector<int> & k_end
+        , std::vector< std::vector<int> > & bins
+        )
+      {
+        using std::min;
+        using std::max;
+
+        typedef typename vector3_type::value_type   real_type;
+
+        int const T = static_cast<int>( corners.size() / 3 );
+        range.resize( 6*T );
+        for(int t = 0; t < T; ++t)
+        {
+          vector3_type const & a = corners[3*t];
+          vector3_type const & b = corners[3*t + 1];
+          vector3_type const & c = corners[3*t + 2];
+          range[6*t]     = 0;
+          range[6*t + 1] = 0;
+          for(int m = rows ? 1 : 0; m < 3; ++m)
+          {
+            real_type const margin = rows ? real_type(0) : h(m)/real_type(2);
+            real_type const lo = min( a(m), min( b(m), c(m) ) ) - margin;
+            real_type const hi = max( a(m), max( b(m), c(m) ) ) + margin;
+            voxelizer_range( lo, hi, origin(m), h(m), size[m], range[6*t + 2*m], range[6*t + 2*m + 1] );
+          }
+        }
+
+        std::vector<int> slab_of;
+        voxelizer_slabs( size[2], slab_of, k_begin, k_end );
+        bins.clear();
+        bins.resize( k_begin.size() );
+        voxelizer_bins( range, slab_of, bins );
+      }
+
+      /**
+      * Set the voxels of the triangles in a grid. The grid is cut into slabs
+      * of z-slices that are voxelized in parallel, each thread only writes
+      * to the slices of its own slab.
+      */
+      template<typename vector3_type, typename grid_type>
+      inline void voxelize_triangles(
+        std::vector<vector3_type> const & corners
+        , grid_type & voxels
+        , voxelization_type const & type
+        )
+      {
+        using std::min;
+        using std::max;
+
+        typedef typename grid_type::value_type      value_type;
+
+        int const size[3] = {
+          static_cast<int>( voxels.I() )
+          , static_cast<int>( voxels.J() )
+          , static_cast<int>( voxels.K() )
+        };
+        int const T = static_cast<int>( corners.size() / 3 );
+        if(T == 0 || voxels.size() == 0)
+          return;
+
+        vector3_type const origin = voxels.min_coord();
+        vector3_type const h( voxels.dx(), voxels.dy(), voxels.dz() );
+
+        std::vector<int>                range;
+        std::vector<int>                k_begin;
+        std::vector<int>                k_end;
+        std::vector< std::vector<int> > bins;
+        voxelizer_partition( corners, size, origin, h, false, range, k_begin, k_end, bins );
+        int const slabs = static_cast<int>( k_begin.size() );
+
+        value_type * data = voxels.data();
+
+#pragma omp parallel for schedule(dynamic,1)
+        for(int s = 0; s < slabs; ++s)
+        {
+          std::vector<int> const & bin = bins[s];
+          for(size_t n = 0; n < bin.size(); ++n)
+          {
+            int const t = bin[n];
+            TriangleVoxelTest<vector3_type> const test( corners[3*t], corners[3*t + 1], corners[3*t + 2], h, type );
+            if(test.empty())
+              continue;
+            int const * r = &range[6*t];
+            int const k0 = max( r[4], k_begin[s] );
+            int const k1 = min( r[5], k_end[s] - 1 );
+            for(int k = k0; k <= k1; ++k)
+              for(int j = r[2]; j <= r[3]; ++j)
+                for(int i = r[0]; i <= r[1]; ++i)
+                {
+                  vector3_type const center( origin(0) + i*h(0), origin(1) + j*h(1), origin(2) + k*h(2) );
+                  if(test.overlaps( center ))
+                    data[ (static_cast<size_t>(k)*size[1] + j)*size[0] + i ] = value_type(1);
+                }
+          }
+        }
+      }
+
+      /**
+      * Edge function of a projected edge in the yz-plane. The end points are
+      * always used in the same order, so the two triangles sharing an edge
+      * get exactly opposite values.
+      */
+      template<typename vector3_type>
+      inline typename vector3_type::value_type yz_edge_function(
+        vector3_type const & p
+        , vector3_type const & q
+        , typename vector3_type::value_type const & y
+        , typename vector3_type::value_type const & z
+        )
+      {
+        if(q(1) < p(1) || (q(1) == p(1) && q(2) < p(2)))
+          return -yz_edge_function( q, p, y, z );
+        return (q(1) - p(1))*(z - p(2)) - (q(2) - p(2))*(y - p(1));
+      }
+
+      /**
+      * Top-left fill rule, tells if points on a counter clockwise oriented
+      * edge from p to q belong to the triangle.
+      */
+      template<typename vector3_type>
+      inline bool yz_top_left(vector3_type const & p, vector3_type const & q)
+      {
+        return q(2) < p(2) || (q(2) == p(2) && q(1) < p(1));
+      }
+
+      /**
+      * Intersect a triangle with a ray along the x-axis. Rays through edges
+      * and vertices are resolved with the top-left fill rule, so a ray hits
+      * exactly one of the triangles that meet at the point where it passes a
+      * closed surface.
+      *
+      * @param a, b, c    The corners of the triangle.
+      * @param y, z       The coordinates of the ray.
+      * @param x          Upon return holds the x-coordinate of the intersection.
+      *
+      * @return           True if the ray hits the triangle.
+      */
+      template<typename vector3_type>
+      inline bool ray_x_triangle(
+        vector3_type const & a
+        , vector3_type const & b
+        , vector3_type const & c
+        , typename vector3_type::value_type const & y
+        , typename vector3_type::value_type const & z
+        , typename vector3_type::value_type & x
+        )
+      {
+        typedef typename vector3_type::value_type  real_type;
+
+        real_type const area = yz_edge_function( a, b, c(1), c(2) );
+        if(area == 0)
+          return false;
+        bool const flip = area < 0;
+
+        //--- The weights of the corners, positive inside
+        real_type wa = yz_edge_function( b, c, y, z );
+        real_type wb = yz_edge_function( c, a, y, z );
+        real_type wc = yz_edge_function( a, b, y, z );
+        if(flip)
+        {
+          wa = -wa;
+          wb = -wb;
+          wc = -wc;
+        }
+        if(wa < 0 || wb < 0 || wc < 0)
+          return false;
+        if(wa == 0 && !( flip ? yz_top_left( c, b ) : yz_top_left( b, c ) ))
+          return false;
+        if(wb == 0 && !( flip ? yz_top_left( a, c ) : yz_top_left( c, a ) ))
+          return false;
+        if(wc == 0 && !( flip ? yz_top_left( b, a ) : yz_top_left( a, b ) ))
+          return false;
+
+        real_type const sum = wa + wb + wc;
+        if(sum <= 0)
+          return false;
+        x = ( wa*a(0) + wb*b(0) + wc*c(0) ) / sum;
+        return true;
+      }
+
+      /**
+      * Parity Scan.
+      * Shoots a ray along the x-axis through every row of nodes, and counts
+      * the surface crossings in front of each node. Nodes with an odd count
+      * are inside. The grid is cut into slabs of z-slices that are scanned in
+      * parallel.
+      *
+      * @param corners          The corners of the triangles of a closed surface.
+      * @param grid             The grid to write.
+      * @param inside           The value written at inside nodes.
+      * @param outside          The value written at outside nodes.
+      * @param write_outside    If false then outside nodes are left unchanged.
+      */
+      template<typename vector3_type, typename grid_type>
+      inline void parity_scan(
+        std::vector<vector3_type> const & corners
+        , grid_type & grid
+        , typename grid_type::value_type const & inside
+        , typename grid_type::value_type const & outside
+        , bool const & write_outside
+        )
+      {
+        typedef typename vector3_type::value_type   real_type;
+        typedef typename grid_type::value_type      value_type;
+
+        int const size[3] = {
+          static_cast<int>( grid.I() )
+          , static_cast<int>( grid.J() )
+          , static_cast<int>( grid.K() )
+        };
+        if(grid.size() == 0)
+          return;
+
+        vector3_type const origin = grid.min_coord();
+        vector3_type const h( grid.dx(), grid.dy(), grid.dz() );
+
+        //--- The ranges of rows crossed by each triangle
+        std::vector<int>                range;
+        std::vector<int>                k_begin;
+        std::vector<int>                k_end;
+        std::vector< std::vector<int> > bins;
+        voxelizer_partition( corners, size, origin, h, true, range, k_begin, k_end, bins );
+        int const slabs = static_cast<int>( k_begin.size() );
+
+        value_type * data = grid.data();
+
+#pragma omp parallel for schedule(dynamic,1)
+        for(int s = 0; s < slabs; ++s)
+        {
+          std::vector<int> const &        bin = bins[s];
+          std::vector< std::vector<int> > rows( size[1] );
+          std::vector<real_type>          hits;
+
+          for(int k = k_begin[s]; k < k_end[s]; ++k)
+          {
+            for(int j = 0; j < size[1]; ++j)
+              rows[j].clear();
+            for(size_t n = 0; n < bin.size(); ++n)
+            {
+              int const * r = &range[6*bin[n]];
+              if(k < r[4] || k > r[5])
+                continue;
+              for(int j = r[2]; j <= r[3]; ++j)
+                rows[j].push_back( bin[n] );
+            }
+
+            real_type const z = origin(2) + k*h(2);
+            for(int j = 0; j < size[1]; ++j)
+            {
+              real_type const y = origin(1) + j*h(1);
+              hits.clear();
+              for(size_t n = 0; n < rows[j].size(); ++n)
+              {
+                int const t = rows[j][n];
+                real_type x;
+                if(ray_x_triangle( corners[3*t], corners[3*t + 1], corners[3*t + 2], y, z, x ))
+                  hits.push_back( x );
+              }
+              std::sort( hits.begin(), hits.end() );
+
+              value_type * row = data + (static_cast<size_t>(k)*size[1] + j)*size[0];
+              size_t crossed = 0;
+              for(int i = 0; i < size[0]; ++i)
+              {
+                real_type const x = origin(0) + i*h(0);
+                while(crossed < hits.size() && hits[crossed] < x)
+                  ++crossed;
+                if(crossed % 2)
+                  row[i] = inside;
+                else if(write_outside)
+                  row[i] = outside;
+              }
+            }
+          }
+        }
+      }
+
+    } // namespace detail
+
+    /**
+    * Surface Voxelizer.
+    * Sets the voxels that are overlapped by the faces of a mesh, the voxel
+    * of a node is the box of one node spacing around it. The triangles are
+    * tested against the voxels by precomputed separating axis tests, and
+    * the grid is voxelized in parallel slabs of z-slices. Faces with more
+    * than three vertices are split into triangles.
+    *
+    * Unlike voxelizer() this does not need an OpenGL context.
+    *
+    * @param mesh     The mesh.
+    * @param voxels   Upon return this grid holds the voxels (1: voxel, 0: no voxel).
+    * @param type     The type of voxelization, default is conservative.
+    */
+    template<typename mesh_type, typename grid_type>
+    inline void voxelize_surface(
+      mesh_type & mesh
+      , grid_type & voxels
+      , voxelization_type const & type = voxelization_conservative
+      )
+    {
+      typedef typename mesh_type::math_types::vector3_type  vector3_type;
+      typedef typename grid_type::value_type                value_type;
+
+      std::vector<vector3_type> corners;
+      detail::get_voxelizer_triangles( mesh, corners );
+      std::fill( voxels.begin(), voxels.end(), value_type(0) );
+      detail::voxelize_triangles( corners, voxels, type );
+    }
+
+    /**
+    * Solid Voxelizer.
+    * Sets the voxels of a surface voxelization, see voxelize_surface(), and
+    * fills the inside of the mesh. The inside nodes are found by a parity
+    * scan along the x-axis, which is done in parallel over rows of nodes.
+    * The mesh must be closed.
+    *
+    * @param mesh     The mesh, must be a closed surface.
+    * @param voxels   Upon return this grid holds the voxels (1: voxel, 0: no voxel).
+    * @param type     The type of surface voxelization, default is conservative.
+    */
+    template<typename mesh_type, typename grid_type>
+    inline void voxelize_solid(
+      mesh_type & mesh
+      , grid_type & voxels
+      , voxelization_type const & type = voxelization_conservative
+      )
+    {
+      typedef typename mesh_type::math_types::vector3_type  vector3_type;
+      typedef typename grid_type::value_type                value_type;
+
+      std::vector<vector3_type> corners;
+      detail::get_voxelizer_triangles( mesh, corners );
+      std::fill( voxels.begin(), voxels.end(), value_type(0) );
+      detail::voxelize_triangles( corners, voxels, type );
+      detail::parity_scan( corners, voxels, value_type(1), value_type(0), false );
+    }
+
+    /**
+    * Inside-Outside Sign.
+    * Computes the sign of the nodes with respect to a closed mesh by a
+    * parity scan, see voxelize_solid(). The sign follows the convention of
+    * the signed distance fields of mesh2phi(), negative inside and positive
+    * outside, so it can be used to sign unsigned distances.
+    *
+    * @param mesh     The mesh, must be a closed surface.
+    * @param sign     Upon return this grid holds the signs (-1: inside, 1: outside).
+    */
+    template<typename mesh_type, typename grid_type>
+    inline void voxelize_sign(mesh_type & mesh, grid_type & sign)
+    {
+      typedef typename mesh_type::math_types::vector3_type  vector3_type;
+      typedef typename grid_type::value_type                value_type;
+
+      std::vector<vector3_type> corners;
+      detail::get_voxelizer_triangles( mesh, corners );
+      detail::parity_scan( corners, sign, value_type(-1), value_type(1), true );
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_CPU_VOXELIZER_H
+#endif
@@ -0,0 +1,586 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_DERIVATIVE_FIELDS_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_DERIVATIVE_FIELDS_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/util/grid_gradient.h>
+#include <OpenTissue/core/containers/grid/util/grid_upwind_gradient.h>
+#include <OpenTissue/core/containers/grid/util/grid_hessian.h>
+#include <OpenTissue/core/containers/grid/util/grid_mean_curvature.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Finite difference weights of a grid, computed once for all nodes.
+      */
+      template<typename real_type>
+      struct StencilWeights
+      {
+        real_type m_inv_d[3];     ///< 1/dx, 1/dy and 1/dz, used by one sided first differences.
+        real_type m_inv_2d[3];    ///< 1/(2 dx), 1/(2 dy) and 1/(2 dz), used by central first differences.
+        real_type m_inv_d2[3];    ///< 1/dx^2, 1/dy^2 and 1/dz^2, used by second differences.
+        real_type m_inv_4dxy;     ///< 1/(4 dx dy), used by the mixed xy difference.
+        real_type m_inv_4dxz;     ///< 1/(4 dx dz), used by the mixed xz difference.
+        real_type m_inv_4dyz;     ///< 1/(4 dy dz), used by the mixed yz difference.
+        real_type m_limit;        ///< The largest curvature that the grid resolves.
+
+        template<typename grid_type>
+        explicit StencilWeights(grid_type const & grid)
+        {
+          using std::min;
+
+          real_type const dx = static_cast<real_type>( grid.dx() );
+          real_type const dy = static_cast<real_type>( grid.dy() );
+          real_type const dz = static_cast<real_type>( grid.dz() );
+          m_inv_d[0]  = real_type(1) / dx;
+          m_inv_d[1]  = real_type(1) / dy;
+          m_inv_d[2]  = real_type(1) / dz;
+          m_inv_2d[0] = real_type(0.5) / dx;
+          m_inv_2d[1] = real_type(0.5) / dy;
+          m_inv_2d[2] = real_type(0.5) / dz;
+          m_inv_d2[0] = real_type(1) / (dx*dx);
+          m_inv_d2[1] = real_type(1) / (dy*dy);
+          m_inv_d2[2] = real_type(1) / (dz*dz);
+          m_inv_4dxy  = real_type(0.25) / (dx*dy);
+          m_inv_4dxz  = real_type(0.25) / (dx*dz);
+          m_inv_4dyz  = real_type(0.25) / (dy*dz);
+          m_limit     = real_type(1) / min( dx, min( dy, dz ) );
+        }
+      };
+
+      /**
+      * Derivatives along a run of interior nodes of an x-row.
+      * All neighbors of the nodes exist, so the stencil is the same for
+      * every node and the loop body has no branches, which lets the compiler
+      * vectorize the loop over the contiguous nodes of the row. The results
+      * are the same as those of gradient() and mean_curvature().
+      *
+      * @param phi        The node values.
+      * @param offset     The index of the first node of the run.
+      * @param n          The number of nodes in the run.
+      * @param sy         The distance between neighbors along the y-axis.
+      * @param sz         The distance between neighbors along the z-axis.
+      * @param w          The finite difference weights.
+      * @param unused     The value of unused nodes.
+      * @param gx         The x-components of the gradients, written if store_gradient is true.
+      * @param gy         The y-components of the gradients, written if store_gradient is true.
+      * @param gz         The z-components of the gradients, written if store_gradient is true.
+      * @param kappa      The mean curvatures, written if store_curvature is true.
+      */
+      template<bool store_gradient, bool store_curvature, typename value_type, typename real_type>
+      inline void derivative_row(
+        value_type const * phi
+        , size_t const & offset
+        , int const & n
+        , std::ptrdiff_t const & sy
+        , std::ptrdiff_t const & sz
+        , StencilWeights<real_type> const & w
+        , value_type const & unused
+        , value_type * gx
+        , value_type * gy
+        , value_type * gz
+        , value_type * kappa
+        )
+      {
+        real_type const u = static_cast<real_type>( unused );
+
+        for(int i = 0; i < n; ++i)
+        {
+          size_t     const   idx = offset + i;
+          value_type const * p   = phi + idx;
+
+          bool const bad =
+            (p[0]  == unused) | (p[-1]  == unused) | (p[1]  == unused) |
+            (p[-sy] == unused) | (p[sy] == unused) |
+            (p[-sz] == unused) | (p[sz] == unused);
+
+          real_type const v000 = static_cast<real_type>( p[0] );
+          real_type const vm00 = static_cast<real_type>( p[-1] );
+          real_type const vp00 = static_cast<real_type>( p[1] );
+          real_type const v0m0 = static_cast<real_type>( p[-sy] );
+          real_type const v0p0 = static_cast<real_type>( p[sy] );
+          real_type const v00m = static_cast<real_type>( p[-sz] );
+          real_type const v00p = static_cast<real_type>( p[sz] );
+
+          real_type const g0 = bad ? u : (vp00 - vm00)*w.m_inv_2d[0];
+          real_type const g1 = bad ? u : (v0p0 - v0m0)*w.m_inv_2d[1];
+          real_type const g2 = bad ? u : (v00p - v00m)*w.m_inv_2d[2];
+
+          if(store_gradient)
+          {
+            gx[idx] = static_cast<value_type>( g0 );
+            gy[idx] = static_cast<value_type>( g1 );
+            gz[idx] = static_cast<value_type>( g2 );
+          }
+
+          if(store_curvature)
+          {
+            real_type const d000 = real_type(2)*v000;
+            real_type const H00 = (vp00 + vm00 - d000)*w.m_inv_d2[0];
+            real_type const H11 = (v0p0 + v0m0 - d000)*w.m_inv_d2[1];
+            real_type const H22 = (v00p + v00m - d000)*w.m_inv_d2[2];
+            real_type const H01 = ( static_cast<real_type>( p[sy + 1] ) - static_cast<real_type>( p[sy - 1] )
+                                  - static_cast<real_type>( p[1 - sy] ) + static_cast<real_type>( p[-1 - sy] ) )*w.m_inv_4dxy;
+            real_type const H02 = ( static_cast<real_type>( p[sz + 1] ) - static_cast<real_type>( p[sz - 1] )
+                                  - static_cast<real_type>( p[1 - sz] ) + static_cast<real_type>( p[-1 - sz] ) )*w.m_inv_4dxz;
+            real_type const H12 = ( static_cast<real_type>( p[sz + sy] ) - static_cast<real_type>( p[sz - sy] )
+                                  - static_cast<real_type>( p[sy - sz] ) + static_cast<real_type>( p[-sy - sz] ) )*w.m_inv_4dyz;
+
+            real_type h = g0*g0 + g1*g1 + g2*g2;
+            h = (h == real_type(0)) ? real_type(1) : h;
+
+            real_type K = (
+              g0*g0*(H11 + H22) - real_type(2)*g1*g2*H12 +
+              g1*g1*(H00 + H22) - real_type(2)*g0*g2*H02 +
+              g2*g2*(H00 + H11) - real_type(2)*g0*g1*H01
+              ) / ( h*std::sqrt( h ) );
+            K = (K < w.m_limit)  ? K :  w.m_limit;
+            K = (K > -w.m_limit) ? K : -w.m_limit;
+            kappa[idx] = static_cast<value_type>( K );
+          }
+        }
+      }
+
+      /**
+      * Derivatives at a node on the boundary of the grid, where the stencil
+      * is clamped. These nodes are few, so they are handled one at a time by
+      * gradient() and mean_curvature().
+      */
+      template<bool store_gradient, bool store_curvature, typename grid_type, typename value_type>
+      inline void derivative_node(
+        grid_type const & phi
+        , size_t const & i
+        , size_t const & j
+        , size_t const & k
+        , size_t const & idx
+        , value_type * gx
+        , value_type * gy
+        , value_type * gz
+        , value_type * kappa
+        )
+      {
+        typedef typename grid_type::math_types::real_type    real_type;
+        typedef OpenTissue::math::Vector3<real_type>         vector3_type;
+
+        if(store_gradient)
+        {
+          vector3_type g;
+          gradient( phi, i, j, k, g );
+          gx[idx] = static_cast<value_type>( g(0) );
+          gy[idx] = static_cast<value_type>( g(1) );
+          gz[idx] = static_cast<value_type>( g(2) );
+        }
+        if(store_curvature)
+        {
+          real_type K = real_type(0);
+          mean_curvature( phi, i, j, k, K );
+          kappa[idx] = static_cast<value_type>( K );
+        }
+      }
+
+      /**
+      * Hessians along a run of interior nodes of an x-row, see
+      * derivative_row(). The results are the same as those of hessian().
+      * The Hessian is symmetric, so only the six distinct entries are stored.
+      *
+      * @param phi        The node values.
+      * @param offset     The index of the first node of the run.
+      * @param n          The number of nodes in the run.
+      * @param sy         The distance between neighbors along the y-axis.
+      * @param sz         The distance between neighbors along the z-axis.
+      * @param w          The finite difference weights.
+      * @param H          The entries H00, H11, H22, H01, H02 and H12 of the Hessians.
+      */
+      template<typename value_type, typename real_type>
+      inline void hessian_row(
+        value_type const * phi
+        , size_t const & offset
+        , int const & n
+        , std::ptrdiff_t const & sy
+        , std::ptrdiff_t const & sz
+        , StencilWeights<real_type> const & w
+        , value_type * const * H
+        )
+      {
+        for(int i = 0; i < n; ++i)
+        {
+          size_t     const   idx = offset + i;
+          value_type const * p   = phi + idx;
+
+          real_type const d000 = real_type(2)*static_cast<real_type>( p[0] );
+
+          H[0][idx] = static_cast<value_type>( ( static_cast<real_type>( p[1] )  + static_cast<real_type>( p[-1] )  - d000 )*w.m_inv_d2[0] );
+          H[1][idx] = static_cast<value_type>( ( static_cast<real_type>( p[sy] ) + static_cast<real_type>( p[-sy] ) - d000 )*w.m_inv_d2[1] );
+          H[2][idx] = static_cast<value_type>( ( static_cast<real_type>( p[sz] ) + static_cast<real_type>( p[-sz] ) - d000 )*w.m_inv_d2[2] );
+          H[3][idx] = static_cast<value_type>( ( static_cast<real_type>( p[sy + 1] ) - static_cast<real_type>( p[sy - 1] )
+                                               - static_cast<real_type>( p[1 - sy] ) + static_cast<real_type>( p[-1 - sy] ) )*w.m_inv_4dxy );
+          H[4][idx] = static_cast<value_type>( ( static_cast<real_type>( p[sz + 1] ) - static_cast<real_type>( p[sz - 1] )
+                                               - static_cast<real_type>( p[1 - sz] ) + static_cast<real_type>( p[-1 - sz] ) )*w.m_inv_4dxz );
+          H[5][idx] = static_cast<value_type>( ( static_cast<real_type>( p[sz + sy] ) - static_cast<real_type>( p[sz - sy] )
+                                               - static_cast<real_type>( p[sy - sz] ) + static_cast<real_type>( p[-sy - sz] ) )*w.m_inv_4dyz );
+        }
+      }
+
+      /**
+      * Upwind gradients along a run of interior nodes of an x-row, see
+      * derivative_row(). The difference direction is picked by selects
+      * rather than branches. The results are the same as those of
+      * upwind_gradient().
+      *
+      * @param phi        The node values.
+      * @param F          The speed function values.
+      * @param offset     The index of the first node of the run.
+      * @param n          The number of nodes in the run.
+      * @param sy         The distance between neighbors along the y-axis.
+      * @param sz         The distance between neighbors along the z-axis.
+      * @param w          The finite difference weights.
+      * @param gx         Upon return holds the x-components of the gradients.
+      * @param gy         Upon return holds the y-components of the gradients.
+      * @param gz         Upon return holds the z-components of the gradients.
+      */
+      template<typename value_type, typename real_type>
+      inline void upwind_gradient_row(
+        value_type const * phi
+        , value_type const * F
+        , size_t const & offset
+        , int const & n
+        , std::ptrdiff_t const & sy
+        , std::ptrdiff_t const & sz
+        , StencilWeights<real_type> const & w
+        , value_type * gx
+        , value_type * gy
+        , value_type * gz
+        )
+      {
+        for(int i = 0; i < n; ++i)
+        {
+          size_t     const   idx = offset + i;
+          value_type const * p   = phi + idx;
+
+          real_type const f    = static_cast<real_type>( F[idx] );
+          real_type const v000 = static_cast<real_type>( p[0] );
+          real_type const vm00 = static_cast<real_type>( p[-1] );
+          real_type const vp00 = static_cast<real_type>( p[1] );
+          real_type const v0m0 = static_cast<real_type>( p[-sy] );
+          real_type const v0p0 = static_cast<real_type>( p[sy] );
+          real_type const v00m = static_cast<real_type>( p[-sz] );
+          real_type const v00p = static_cast<real_type>( p[sz] );
+
+          //--- F > 0 use forward diffs, F < 0 use backward diffs
+          real_type const c0 = (vp00 - vm00)*w.m_inv_2d[0];
+          real_type const c1 = (v0p0 - v0m0)*w.m_inv_2d[1];
+          real_type const c2 = (v00p - v00m)*w.m_inv_2d[2];
+          real_type const b0 = (f < 0) ? (v000 - vm00)*w.m_inv_d[0] : c0;
+          real_type const b1 = (f < 0) ? (v000 - v0m0)*w.m_inv_d[1] : c1;
+          real_type const b2 = (f < 0) ? (v000 - v00m)*w.m_inv_d[2] : c2;
+          gx[idx] = static_cast<value_type>( (f > 0) ? (vp00 - v000)*w.m_inv_d[0] : b0 );
+          gy[idx] = static_cast<value_type>( (f > 0) ? (v0p0 - v000)*w.m_inv_d[1] : b1 );
+          gz[idx] = static_cast<value_type>( (f > 0) ? (v00p - v000)*w.m_inv_d[2] : b2 );
+        }
+      }
+
+      /**
+      * Row kernel of gradient_field(), mean_curvature_field() and
+      * gradient_and_mean_curvature_field(), see sweep_rows().
+      */
+      template<bool store_gradient, bool store_curvature, typename grid_type>
+      struct DerivativeKernel
+      {
+        typedef typename grid_type::value_type               value_type;
+        typedef typename grid_type::math_types::real_type    real_type;
+
+        grid_type const &                m_phi;
+        StencilWeights<real_type> const  m_w;
+        value_type * const               m_gx;
+        value_type * const               m_gy;
+        value_type * const               m_gz;
+        value_type * const               m_kappa;
+
+        DerivativeKernel(grid_type const & phi, value_type * gx, value_type * gy, value_type * gz, value_type * kappa)
+          : m_phi(phi)
+          , m_w(phi)
+          , m_gx(gx)
+          , m_gy(gy)
+          , m_gz(gz)
+          , m_kappa(kappa)
+        {}
+
+        void row(size_t const & offset, int const & n, std::ptrdiff_t const & sy, std::ptrdiff_t const & sz) const
+        {
+          derivative_row<store_gradient, store_curvature>( m_phi.data(), offset, n, sy, sz, m_w, m_phi.unused(), m_gx, m_gy, m_gz, m_kappa );
+        }
+
+        void node(size_t const & i, size_t const & j, size_t const & k, size_t const & idx) const
+        {
+          derivative_node<store_gradient, store_curvature>( m_phi, i, j, k, idx, m_gx, m_gy, m_gz, m_kappa );
+        }
+      };
+
+      /**
+      * Row kernel of hessian_field(), the boundary nodes are handled by hessian().
+      */
+      template<typename grid_type>
+      struct HessianKernel
+      {
+        typedef typename grid_type::value_type               value_type;
+        typedef typename grid_type::math_types::real_type    real_type;
+        typedef OpenTissue::math::Matrix3x3<real_type>       matrix3x3_type;
+
+        grid_type const &                m_phi;
+        StencilWeights<real_type> const  m_w;
+        value_type *                     m_H[6];
+
+        HessianKernel(grid_type const & phi, value_type * const * H)
+          : m_phi(phi)
+          , m_w(phi)
+        {
+          for(int e = 0; e < 6; ++e)
+            m_H[e] = H[e];
+        }
+
+        void row(size_t const & offset, int const & n, std::ptrdiff_t const & sy, std::ptrdiff_t const & sz) const
+        {
+          hessian_row( m_phi.data(), offset, n, sy, sz, m_w, m_H );
+        }
+
+        void node(size_t const & i, size_t const & j, size_t const & k, size_t const & idx) const
+        {
+          matrix3x3_type H;
+          hessian( m_phi, i, j, k, H );
+          m_H[0][idx] = static_cast<value_type>( H(0,0) );
+          m_H[1][idx] = static_cast<value_type>( H(1,1) );
+          m_H[2][idx] = static_cast<value_type>( H(2,2) );
+          m_H[3][idx] = static_cast<value_type>( H(0,1) );
+          m_H[4][idx] = static_cast<value_type>( H(0,2) );
+          m_H[5][idx] = static_cast<value_type>( H(1,2) );
+        }
+      };
+
+      /**
+      * Row kernel of upwind_gradient_field(), the boundary nodes are handled by upwind_gradient().
+      */
+      template<typename grid_type>
+      struct UpwindGradientKernel
+      {
+        typedef typename grid_type::value_type               value_type;
+        typedef typename grid_type::math_types::real_type    real_type;
+        typedef OpenTissue::math::Vector3<real_type>         vector3_type;
+
+        grid_type const &                m_phi;
+        grid_type const &                m_F;
+        StencilWeights<real_type> const  m_w;
+        value_type * const               m_gx;
+        value_type * const               m_gy;
+        value_type * const               m_gz;
+
+        UpwindGradientKernel(grid_type const & phi, grid_type const & F, value_type * gx, value_type * gy, value_type * gz)
+          : m_phi(phi)
+          , m_F(F)
+          , m_w(phi)
+          , m_gx(gx)
+          , m_gy(gy)
+          , m_gz(gz)
+        {}
+
+        void row(size_t const & offset, int const & n, std::ptrdiff_t const & sy, std::ptrdiff_t const & sz) const
+        {
+          upwind_gradient_row( m_phi.data(), m_F.data(), offset, n, sy, sz, m_w, m_gx, m_gy, m_gz );
+        }
+
+        void node(size_t const & i, size_t const & j, size_t const & k, size_t const & idx) const
+        {
+          vector3_type g;
+          upwind_gradient( m_phi, m_F, i, j, k, g );
+          m_gx[idx] = static_cast<value_type>( g(0) );
+          m_gy[idx] = static_cast<value_type>( g(1) );
+          m_gz[idx] = static_cast<value_type>( g(2) );
+        }
+      };
+
+      template<typename grid_type>
+      inline void match_grid(grid_type const & phi, grid_type & field)
+      {
+        assert(&phi != &field || !"match_grid(): output can not be the same grid as the input");
+        if(field.I() != phi.I() || field.J() != phi.J() || field.K() != phi.K())
+          field.create( phi.min_coord(), phi.max_coord(), phi.I(), phi.J(), phi.K() );
+      }
+
+      /**
+      * Sweep all x-rows of a grid. The interior nodes of each row are handed
+      * to the row() method of the kernel in one run, the end nodes of the row
+      * and the rows on the boundary faces of the grid are peeled off and
+      * handed to the node() method one at a time. The rows are distributed
+      * over threads.
+      */
+      template<typename grid_type, typename kernel_type>
+      inline void sweep_rows(grid_type const & phi, kernel_type const & kernel)
+      {
+        size_t const I = phi.I();
+        size_t const J = phi.J();
+        size_t const K = phi.K();
+        int const rows = static_cast<int>( J*K );
+        int const n    = (I > 2) ? static_cast<int>( I - 2 ) : 0;
+
+        std::ptrdiff_t const sy = static_cast<std::ptrdiff_t>( I );
+        std::ptrdiff_t const sz = static_cast<std::ptrdiff_t>( I*J );
+
+#pragma omp parallel for schedule(static) if(phi.size() > 32768)
+        for(int row = 0; row < rows; ++row)
+        {
+          size_t const j     = row % J;
+          size_t const k     = row / J;
+          size_t const first = static_cast<size_t>( row )*I;
+
+          bool const interior = n > 0 && j > 0 && j + 1 < J && k > 0 && k + 1 < K;
+          if(!interior)
+          {
+            for(size_t i = 0; i < I; ++i)
+              kernel.node( i, j, k, first + i );
+            continue;
+          }
+
+          kernel.node( 0, j, k, first );
+          kernel.row( first + 1, n, sy, sz );
+          kernel.node( I - 1, j, k, first + I - 1 );
+        }
+      }
+
+    } // namespace detail
+
+    /**
+    * Gradient Field.
+    * Computes the gradient of all nodes in a single sweep over the grid,
+    * with the same central differences as gradient(). The interior of every
+    * x-row is processed by a branch free loop over contiguous nodes, which
+    * the compiler can vectorize, and the nodes on the boundary of the grid
+    * are handled separately. This is much faster than calling gradient()
+    * through an index iterator.
+    *
+    * @param phi      The input grid.
+    * @param Nx       Upon return holds the x-components of the gradients.
+    * @param Ny       Upon return holds the y-components of the gradients.
+    * @param Nz       Upon return holds the z-components of the gradients.
+    */
+    template<typename grid_type>
+    inline void gradient_field(
+      grid_type const & phi
+      , grid_type & Nx
+      , grid_type & Ny
+      , grid_type & Nz
+      )
+    {
+      detail::match_grid( phi, Nx );
+      detail::match_grid( phi, Ny );
+      detail::match_grid( phi, Nz );
+      typedef typename grid_type::value_type  value_type;
+
+      value_type * none = 0;
+      detail::sweep_rows( phi, detail::DerivativeKernel<true, false, grid_type>( phi, Nx.data(), Ny.data(), Nz.data(), none ) );
+    }
+
+    /**
+    * Mean Curvature Field.
+    * Computes the mean curvature of all nodes in a single sweep over the
+    * grid, with the same differences and clamping as mean_curvature(), see
+    * gradient_field() for details.
+    *
+    * @param phi      The input level set.
+    * @param kappa    Upon return holds the mean curvatures.
+    */
+    template<typename grid_type>
+    inline void mean_curvature_field(grid_type const & phi, grid_type & kappa)
+    {
+      typedef typename grid_type::value_type  value_type;
+
+      detail::match_grid( phi, kappa );
+      value_type * none = 0;
+      detail::sweep_rows( phi, detail::DerivativeKernel<false, true, grid_type>( phi, none, none, none, kappa.data() ) );
+    }
+
+    /**
+    * Gradient and Mean Curvature Field.
+    * Computes both the gradient and the mean curvature of all nodes in the
+    * same sweep, so the stencil of each node is only loaded once. The
+    * results are the same as those of gradient_field() and
+    * mean_curvature_field().
+    *
+    * @param phi      The input level set.
+    * @param Nx       Upon return holds the x-components of the gradients.
+    * @param Ny       Upon return holds the y-components of the gradients.
+    * @param Nz       Upon return holds the z-components of the gradients.
+    * @param kappa    Upon return holds the mean curvatures.
+    */
+    template<typename grid_type>
+    inline void gradient_and_mean_curvature_field(
+      grid_type const & phi
+      , grid_type & Nx
+      , grid_type & Ny
+      , grid_type & Nz
+      , grid_type & kappa
+      )
+    {
+      detail::match_grid( phi, Nx );
+      detail::match_grid( phi, Ny );
+      detail::match_grid( phi, Nz );
+      detail::match_grid( phi, kappa );
+      detail::sweep_rows( phi, detail::DerivativeKernel<true, true, grid_type>( phi, Nx.data(), Ny.data(), Nz.data(), kappa.data() ) );
+    }
+
+    /**
+    * Hessian Field.
+    * Computes the Hessian of all nodes in a single sweep over the grid, with
+    * the same differences as hessian(), see gradient_field() for details.
+    * The Hessian is symmetric, so only the six distinct entries are stored.
+    *
+    * @param phi      The input grid.
+    * @param Hxx      Upon return holds the second derivatives along the x-axis.
+    * @param Hyy      Upon return holds the second derivatives along the y-axis.
+    * @param Hzz      Upon return holds the second derivatives along the z-axis.
+    * @param Hxy      Upon return holds the mixed xy derivatives.
+    * @param Hxz      Upon return holds the mixed xz derivatives.
+    * @param Hyz      Upon return holds the mixed yz derivatives.
+    */
+    template<typename grid_type>
+    inline void hessian_field(
+      grid_type const & phi
+      , grid_type & Hxx
+      , grid_type & Hyy
+      , grid_type & Hzz
+      , grid_type & Hxy
+      , grid_type & Hxz
+      , grid_type & Hyz
+      )
+    {
+      typedef typename grid_type::value_type  value_type;
+
+      detail::match_grid( phi, Hxx );
+      detail::match_grid( phi, Hyy );
+      detail::match_grid( phi, Hzz );
+      detail::match_grid( phi, Hxy );
+      detail::match_grid( phi, Hxz );
+      detail::match_grid( phi, Hyz );
+      value_type * const H[6] = { Hxx.data(), Hyy.data(), Hzz.data(), Hxy.data(), Hxz.data(), Hyz.data() };
+      detail::sweep_rows( phi, detail::HessianKernel<grid_type>( phi, H ) );
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_DERIVATIVE_FIELDS_H
+#endif
@@ -9,6 +9,8 @@
 //
 #include <OpenTissue/configuration.h>
 
+#include <OpenTissue/core/containers/grid/util/grid_distance_transform.h>
+
 namespace OpenTissue
 {
   namespace grid
@@ -49,6 +51,31 @@ namespace OpenTissue
           psi(input.get_index()) = *input - dt*radius;
     }
 
+    /**
+    * Dilate binary image.
+    * A node is set in the output if it is within distance radius of a nonzero
+    * node of the input, that is, the foreground is dilated by a ball.
+    * The distances are found with an exact Euclidean distance transform, so
+    * the cost is linear in the number of nodes for any radius.
+    *
+    * @param image    Input image, nonzero nodes are foreground.
+    * @param radius   Radius of spherical structural element, in world units.
+    * @param result   Upon return foreground nodes are one and background nodes are zero. May be the same grid as the image.
+    */
+    template<
+      typename grid_type_in
+      , typename real_type
+      , typename grid_type_out
+    >
+    inline void dilation(
+    grid_type_in const & image
+    , real_type const & radius
+    , grid_type_out & result
+    )
+    {
+      detail::ball_morphology( image, radius, result, false );
+    }
+
   } // namespace grid
 
 } // namespace OpenTissue
@@ -0,0 +1,267 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_DISTANCE_TRANSFORM_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_DISTANCE_TRANSFORM_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_separable_filter.h>
+
+#include <vector>
+#include <limits>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    /**
+    * Distance Line Filter.
+    * Computes the exact one dimensional squared distance transform of lines,
+    *
+    *   out(t) = min_q  ( (t - q)^2 h^2 + in(q) )
+    *
+    * as the lower envelope of the parabolas rooted at the samples, see
+    *
+    *   P. Felzenszwalb and D. Huttenlocher, "Distance Transforms of Sampled Functions", 2004.
+    *
+    * The cost is linear in the length of the lines. Samples that are infinite
+    * do not contribute, and lines without finite samples stay infinite.
+    */
+    template<typename real_type_>
+    class DistanceLineFilter
+    {
+    public:
+
+      typedef real_type_  real_type;
+
+    protected:
+
+      real_type  m_spacing;    ///< The distance between two neighboring samples.
+
+    public:
+
+      DistanceLineFilter()
+        : m_spacing(1)
+      {}
+
+      /**
+      * Specialized Constructor.
+      *
+      * @param spacing    The distance between two neighboring samples.
+      */
+      explicit DistanceLineFilter(real_type const & spacing)
+        : m_spacing(spacing)
+      {
+        assert(spacing > 0 || !"DistanceLineFilter(): spacing must be positive");
+      }
+
+    public:
+
+      int left()  const { return 0; }
+      int right() const { return 0; }
+      boundary_type boundary() const { return boundary_zero; }
+
+      void operator()(real_type const * in, real_type * out, int const & n, int const & lanes) const
+      {
+        real_type const infinity = std::numeric_limits<real_type>::infinity();
+
+        std::vector<int>       v( n );       //--- The samples of the parabolas in the lower envelope
+        std::vector<real_type> z( n + 1 );   //--- The positions where the parabolas of the envelope start
+
+        for(int b = 0; b < lanes; ++b)
+        {
+          int k = -1;
+          for(int q = 0; q < n; ++q)
+          {
+            real_type const fq = in[q*lanes + b];
+            if(!(fq < infinity))
+              continue;
+            real_type const xq = q*m_spacing;
+            real_type s = -infinity;
+            while(k >= 0)
+            {
+              real_type const xp = v[k]*m_spacing;
+              s = ( (fq + xq*xq) - (in[v[k]*lanes + b] + xp*xp) ) / ( real_type(2)*(xq - xp) );
+              if(s > z[k])
+                break;
+              --k;
+            }
+            if(k < 0)
+              s = -infinity;
+            ++k;
+            v[k]     = q;
+            z[k]     = s;
+            z[k + 1] = infinity;
+          }
+
+          if(k < 0)
+          {
+            for(int t = 0; t < n; ++t)
+              out[t*lanes + b] = infinity;
+            continue;
+          }
+
+          int j = 0;
+          for(int t = 0; t < n; ++t)
+          {
+            real_type const xt = t*m_spacing;
+            while(z[j + 1] < xt)
+              ++j;
+            real_type const d = xt - v[j]*m_spacing;
+            out[t*lanes + b] = d*d + in[v[j]*lanes + b];
+          }
+        }
+      }
+
+    };
+
+    namespace detail
+    {
+
+      /**
+      * Squared distances to the nodes of an image that are nonzero, or to
+      * the nodes that are zero if inside is true.
+      */
+      template<typename grid_type_in, typename grid_type_out>
+      inline void squared_distance_transform(
+        grid_type_in const & image
+        , grid_type_out & distance
+        , bool const & inside
+        )
+      {
+        typedef typename grid_type_in::value_type                input_type;
+        typedef typename grid_type_out::value_type               output_type;
+        typedef typename grid_type_out::math_types::real_type    real_type;
+
+        assert(std::numeric_limits<output_type>::has_infinity || !"squared_distance_transform(): output must be able to hold infinite distances");
+
+        if(static_cast<void const *>(&distance) != static_cast<void const *>(&image))
+          distance.create( image.min_coord(), image.max_coord(), image.I(), image.J(), image.K() );
+
+        int const size[3] = {
+          static_cast<int>( image.I() )
+          , static_cast<int>( image.J() )
+          , static_cast<int>( image.K() )
+        };
+        int const N = static_cast<int>( image.size() );
+
+        input_type  const * src = image.data();
+        output_type       * dst = distance.data();
+        output_type const   infinity = std::numeric_limits<output_type>::infinity();
+
+#pragma omp parallel for schedule(static) if(N > 32768)
+        for(int idx = 0; idx < N; ++idx)
+          dst[idx] = ( (src[idx] != input_type(0)) != inside ) ? output_type(0) : infinity;
+
+        real_type const spacing[3] = {
+          static_cast<real_type>( image.dx() )
+          , static_cast<real_type>( image.dy() )
+          , static_cast<real_type>( image.dz() )
+        };
+        for(int axis = 0; axis < 3; ++axis)
+          if(size[axis] > 1)
+            separable_pass( dst, dst, size, axis, DistanceLineFilter<real_type>( spacing[axis] ) );
+      }
+
+      /**
+      * Binary morphology with a ball. Nodes within distance radius of a
+      * nonzero node are set when dilating, and nodes farther than radius
+      * from a zero node are set when eroding.
+      */
+      template<typename grid_type_in, typename real_type, typename grid_type_out>
+      inline void ball_morphology(
+        grid_type_in const & image
+        , real_type const & radius
+        , grid_type_out & result
+        , bool const & erode
+        )
+      {
+        typedef typename grid_type_in::math_types           math_types;
+        typedef typename math_types::real_type              distance_type;
+        typedef typename grid_type_out::value_type          output_type;
+
+        assert(radius >= 0 || !"ball_morphology(): radius must be non-negative");
+
+        Grid<distance_type, math_types> distance;
+        squared_distance_transform( image, distance, erode );
+
+        if(static_cast<void const *>(&result) != static_cast<void const *>(&image))
+          result.create( image.min_coord(), image.max_coord(), image.I(), image.J(), image.K() );
+
+        //--- Nodes at exactly the distance radius are included, the tolerance makes
+        //--- sure that round-off treats them the same way in the dilation and
+        //--- the erosion, so openings and closings stay inside and outside the image.
+        distance_type const   tolerance = std::numeric_limits<distance_type>::epsilon()*distance_type(1024);
+        distance_type const   r2  = static_cast<distance_type>( radius*radius )*( distance_type(1) + tolerance );
+        distance_type const * src = distance.data();
+        output_type         * dst = result.data();
+        int const N = static_cast<int>( distance.size() );
+
+#pragma omp parallel for schedule(static) if(N > 32768)
+        for(int idx = 0; idx < N; ++idx)
+          dst[idx] = ( (src[idx] <= r2) != erode ) ? output_type(1) : output_type(0);
+      }
+
+    } // namespace detail
+
+    /**
+    * Squared Euclidean Distance Transform.
+    * Computes the exact squared distance from every node to the nearest
+    * nonzero node of an image, measured in world units. The transform is
+    * separable, the lines along each axis are processed with
+    * DistanceLineFilter in parallel, so the cost is linear in the number of
+    * nodes.
+    *
+    * Nodes outside the image are ignored, so if the image has no nonzero
+    * nodes then all distances are infinite.
+    *
+    * @param image       The input image, nonzero nodes are the feature nodes.
+    * @param distance    Upon return holds the squared distances. The value type
+    *                    must be a floating point type. May be the same grid as
+    *                    the image.
+    */
+    template<typename grid_type_in, typename grid_type_out>
+    inline void squared_distance_transform(grid_type_in const & image, grid_type_out & distance)
+    {
+      detail::squared_distance_transform( image, distance, false );
+    }
+
+    /**
+    * Euclidean Distance Transform.
+    * Computes the unsigned distance from every node to the nearest nonzero
+    * node of an image. Combined with a voxelization of a shape this gives an
+    * unsigned distance field of the shape, without computing distances to the
+    * triangles of a mesh as mesh2phi does. The distances are exact with respect
+    * to the node centers, so they are off by up to half the node spacing with
+    * respect to the surface of the shape.
+    *
+    * @param image       The input image, nonzero nodes are the feature nodes.
+    * @param distance    Upon return holds the distances. The value type must be
+    *                    a floating point type. May be the same grid as the image.
+    */
+    template<typename grid_type_in, typename grid_type_out>
+    inline void distance_transform(grid_type_in const & image, grid_type_out & distance)
+    {
+      typedef typename grid_type_out::value_type   output_type;
+
+      detail::squared_distance_transform( image, distance, false );
+
+      int const N = static_cast<int>( distance.size() );
+      output_type * dst = distance.data();
+#pragma omp parallel for schedule(static) if(N > 32768)
+      for(int idx = 0; idx < N; ++idx)
+        dst[idx] = static_cast<output_type>( std::sqrt( dst[idx] ) );
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_DISTANCE_TRANSFORM_H
+#endif
@@ -0,0 +1,225 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_FAST_MARCHING_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_FAST_MARCHING_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/util/grid_fast_sweeping.h>  // needed for detail::eikonal_update
+#include <OpenTissue/core/math/math_constants.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Fast Marching Heap Entry.
+      */
+      template<typename real_type>
+      class MarchingEntry
+      {
+      public:
+
+        real_type  m_distance;    ///< Tentative unsigned distance of the node.
+        size_t     m_idx;         ///< Linear index of the node.
+
+        bool operator<(MarchingEntry const & entry) const { return m_distance > entry.m_distance; }   //--- Closest node on top of the heap
+
+      };
+
+      /**
+      * Fast Marching Node Update.
+      * Computes the tentative distance of a node from its accepted neighbors,
+      * and pushes the node onto the heap if the distance was decreased.
+      */
+      template<typename value_type, typename real_type>
+      inline void marching_update(
+        size_t const idx
+        , value_type const * values
+        , std::vector<char> const & accepted
+        , std::vector<real_type> & tentative
+        , std::vector<real_type> & sign
+        , std::vector< MarchingEntry<real_type> > & heap
+        , int const size[3]
+        , int const stride[3]
+        , real_type const spacing[3]
+        )
+      {
+        using std::fabs;
+
+        real_type const infinity = math::detail::highest<real_type>();
+        int index[3];
+        index[0] = static_cast<int>( idx % size[0] );
+        index[1] = static_cast<int>( (idx / size[0]) % size[1] );
+        index[2] = static_cast<int>( idx / (static_cast<size_t>(size[0])*size[1]) );
+
+        real_type a[3];
+        real_type h[3]    = { spacing[0], spacing[1], spacing[2] };
+        real_type closest = infinity;
+        real_type s       = real_type(1);
+        for(int m = 0; m < 3; ++m)
+        {
+          a[m] = infinity;
+          for(int side = -1; side <= 1; side += 2)
+          {
+            if( (side < 0 && index[m] == 0) || (side > 0 && index[m] == size[m] - 1) )
+              continue;
+            size_t const n = side < 0 ? idx - stride[m] : idx + stride[m];
+            if(!accepted[n])
+              continue;
+            real_type const value = static_cast<real_type>( values[n] );
+            if(fabs( value ) < a[m])
+              a[m] = fabs( value );
+            if(a[m] < closest)
+            {
+              closest = a[m];
+              s       = value < real_type(0) ? real_type(-1) : real_type(1);
+            }
+          }
+        }
+        if(closest == infinity)
+          return;
+
+        real_type const u = eikonal_update( a, h );
+        if(u < tentative[idx])
+        {
+          tentative[idx] = u;
+          sign[idx]      = s;
+          MarchingEntry<real_type> entry;
+          entry.m_distance = u;
+          entry.m_idx      = idx;
+          heap.push_back( entry );
+          std::push_heap( heap.begin(), heap.end() );
+        }
+      }
+
+    } // namespace detail
+
+    /**
+    * Fast Marching.
+    * Extends a signed distance field from the nodes with known values into
+    * the unused nodes, by solving the Eikonal equation |grad phi| = 1 in
+    * order of increasing distance, see
+    *
+    *   J.A. Sethian, "A fast marching level set method for monotonically
+    *   advancing fronts", PNAS 1996.
+    *
+    * Nodes with known values are kept fixed. Unused nodes are accepted one
+    * at a time in order of increasing distance, and their values are computed
+    * by the upwind update from accepted neighbors only. Unused nodes get the
+    * sign of the neighbor their distance is computed from, so the known nodes
+    * should form a band around the zero level set, just like for fast_sweeping().
+    *
+    * The tentative distances are kept in a binary heap where outdated entries
+    * are skipped when popped, so the cost is O(N log N) for N visited nodes.
+    * Marching stops at the given band width, and nodes farther away are left
+    * unused. Thus a narrow band costs only in proportion to the number of
+    * nodes in the band.
+    *
+    * @param phi      A dense grid, unused nodes are filled in upon return.
+    * @param band     The band width. Default is the largest value, which
+    *                 means that the whole grid is computed.
+    *
+    * @return         The number of nodes that were accepted by the marching.
+    */
+    template<typename grid_type>
+    inline size_t fast_marching(
+      grid_type & phi
+      , typename grid_type::math_types::real_type const & band = math::detail::highest<typename grid_type::math_types::real_type>()
+      )
+    {
+      typedef typename grid_type::value_type             value_type;
+      typedef typename grid_type::math_types             math_types;
+      typedef typename math_types::real_type             real_type;
+      typedef detail::MarchingEntry<real_type>           entry_type;
+
+      int const I = static_cast<int>( phi.I() );
+      int const J = static_cast<int>( phi.J() );
+      int const K = static_cast<int>( phi.K() );
+      if(I==0 || J==0 || K==0)
+        return 0;
+
+      value_type const unused = phi.unused();
+      value_type     * values = phi.data();
+      size_t   const   N      = phi.size();
+
+      real_type const infinity   = math::detail::highest<real_type>();
+      int       const size[3]    = { I, J, K };
+      int       const stride[3]  = { 1, I, I*J };
+      real_type const spacing[3] = { phi.dx(), phi.dy(), phi.dz() };
+
+      //--- Known nodes are accepted from the start
+      std::vector<char>       accepted( N );
+      std::vector<real_type>  tentative( N, infinity );
+      std::vector<real_type>  sign( N, real_type(1) );
+      std::vector<entry_type> heap;
+      for(size_t idx = 0; idx < N; ++idx)
+        accepted[idx] = (values[idx] != unused) ? 1 : 0;
+
+      //--- Initialize the heap with all unused neighbors of known nodes
+      for(size_t idx = 0; idx < N; ++idx)
+      {
+        if(accepted[idx])
+          continue;
+        bool near = false;
+        int const i = static_cast<int>( idx % I );
+        int const j = static_cast<int>( (idx / I) % J );
+        int const k = static_cast<int>( idx / (static_cast<size_t>(I)*J) );
+        near = near || (i > 0     && accepted[idx - 1]);
+        near = near || (i < I - 1 && accepted[idx + 1]);
+        near = near || (j > 0     && accepted[idx - I]);
+        near = near || (j < J - 1 && accepted[idx + I]);
+        near = near || (k > 0     && accepted[idx - I*J]);
+        near = near || (k < K - 1 && accepted[idx + I*J]);
+        if(near)
+          detail::marching_update( idx, values, accepted, tentative, sign, heap, size, stride, spacing );
+      }
+
+      size_t count = 0;
+      while(!heap.empty())
+      {
+        std::pop_heap( heap.begin(), heap.end() );
+        entry_type const entry = heap.back();
+        heap.pop_back();
+
+        size_t const idx = entry.m_idx;
+        if(accepted[idx] || entry.m_distance > tentative[idx])
+          continue;
+        if(entry.m_distance > band)
+          break;
+
+        accepted[idx] = 1;
+        values[idx]   = static_cast<value_type>( sign[idx]*entry.m_distance );
+        ++count;
+
+        int const i = static_cast<int>( idx % I );
+        int const j = static_cast<int>( (idx / I) % J );
+        int const k = static_cast<int>( idx / (static_cast<size_t>(I)*J) );
+        if(i > 0     && !accepted[idx - 1])   detail::marching_update( idx - 1,   values, accepted, tentative, sign, heap, size, stride, spacing );
+        if(i < I - 1 && !accepted[idx + 1])   detail::marching_update( idx + 1,   values, accepted, tentative, sign, heap, size, stride, spacing );
+        if(j > 0     && !accepted[idx - I])   detail::marching_update( idx - I,   values, accepted, tentative, sign, heap, size, stride, spacing );
+        if(j < J - 1 && !accepted[idx + I])   detail::marching_update( idx + I,   values, accepted, tentative, sign, heap, size, stride, spacing );
+        if(k > 0     && !accepted[idx - I*J]) detail::marching_update( idx - I*J, values, accepted, tentative, sign, heap, size, stride, spacing );
+        if(k < K - 1 && !accepted[idx + I*J]) detail::marching_update( idx + I*J, values, accepted, tentative, sign, heap, size, stride, spacing );
+      }
+
+      return count;
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_FAST_MARCHING_H
+#endif
@@ -0,0 +1,291 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_FAST_SWEEPING_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_FAST_SWEEPING_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Godunov Upwind Eikonal Update.
+      * Solves sum_m ( max(u - a_m, 0) / h_m )^2 = 1 for u, where a_m is
+      * the smallest neighbor distance along axis m and h_m is the grid
+      * spacing along axis m.
+      *
+      * @param a   The smallest neighbor distances along the three axes.
+      * @param h   The grid spacings along the three axes.
+      *
+      * @return    The solution u.
+      */
+      template<typename real_type>
+      inline real_type eikonal_update(real_type a[3], real_type h[3])
+      {
+        using std::sqrt;
+        using std::swap;
+
+        //--- Sort the axes by increasing neighbor distance
+        if(a[1] < a[0]) { swap(a[0],a[1]); swap(h[0],h[1]); }
+        if(a[2] < a[1]) { swap(a[1],a[2]); swap(h[1],h[2]); }
+        if(a[1] < a[0]) { swap(a[0],a[1]); swap(h[0],h[1]); }
+
+        real_type u = a[0] + h[0];
+        if(u <= a[1])
+          return u;
+
+        real_type A = real_type(0);
+        real_type B = real_type(0);
+        real_type C = real_type(-1);
+        for(int m = 0; m < 3; ++m)
+        {
+          real_type const w = real_type(1)/(h[m]*h[m]);
+          A += w;
+          B += w*a[m];
+          C += w*a[m]*a[m];
+          real_type const discriminant = B*B - A*C;
+          if(m == 0)
+            continue;
+          u = ( B + sqrt( discriminant > real_type(0) ? discriminant : real_type(0) ) ) / A;
+          if(m == 2 || u <= a[m+1])
+            return u;
+        }
+        return u;
+      }
+
+      /**
+      * Fast Sweeping Node Update.
+      * Computes the upwind distance of a node from its neighbors with known
+      * values, and keeps it if it is smaller than the current value.
+      *
+      * @return   If the node value was changed then the return value is true otherwise it is false.
+      */
+      template<typename value_type, typename real_type>
+      inline bool sweep_node(
+        value_type * values
+        , size_t const idx
+        , int const index[3]
+        , int const size[3]
+        , int const stride[3]
+        , real_type const spacing[3]
+        , value_type const unused
+        )
+      {
+        using std::fabs;
+
+        real_type const infinity = static_cast<real_type>( unused );
+
+        real_type a[3];
+        real_type h[3]     = { spacing[0], spacing[1], spacing[2] };
+        real_type closest  = infinity;
+        real_type sign     = real_type(1);
+        for(int m = 0; m < 3; ++m)
+        {
+          a[m] = infinity;
+          if(index[m] > 0 && values[idx - stride[m]] != unused)
+          {
+            real_type const value = static_cast<real_type>( values[idx - stride[m]] );
+            a[m] = fabs( value );
+            if(a[m] < closest)
+            {
+              closest = a[m];
+              sign    = value < real_type(0) ? real_type(-1) : real_type(1);
+            }
+          }
+          if(index[m] < size[m] - 1 && values[idx + stride[m]] != unused)
+          {
+            real_type const value = static_cast<real_type>( values[idx + stride[m]] );
+            if(fabs( value ) < a[m])
+              a[m] = fabs( value );
+            if(a[m] < closest)
+            {
+              closest = a[m];
+              sign    = value < real_type(0) ? real_type(-1) : real_type(1);
+            }
+          }
+        }
+        if(closest == infinity)
+          return false;
+
+        real_type const u = eikonal_update( a, h );
+        if(values[idx] == unused || u < fabs( static_cast<real_type>( values[idx] ) ))
+        {
+          values[idx] = static_cast<value_type>( sign*u );
+          return true;
+        }
+        return false;
+      }
+
+      /**
+      * Parallel Fast Sweep.
+      * Does one Gauss-Seidel sweep in one of the eight sweep orderings. The
+      * grid is split into blocks. A node only depends on its upwind neighbors,
+      * so a block only depends on the upwind blocks sharing a face with it.
+      * Thus all blocks on a diagonal plane of blocks, orthogonal to the sweep
+      * direction, can be swept concurrently, and the planes are swept one
+      * after the other as a wavefront.
+      *
+      * @param values      The node values.
+      * @param fixed       Flags for nodes that must not be changed.
+      * @param size        The number of nodes along each axis.
+      * @param spacing     The grid spacing along each axis.
+      * @param unused      The value of nodes with no known value.
+      * @param sweep       The sweep ordering, bit m tells whether axis m is swept backwards.
+      *
+      * @return            If any node value was changed then the return value is true otherwise it is false.
+      */
+      template<typename value_type, typename real_type>
+      inline bool parallel_sweep(
+        value_type * values
+        , std::vector<char> const & fixed
+        , int const size[3]
+        , real_type const spacing[3]
+        , value_type const unused
+        , int const sweep
+        )
+      {
+        int const block     = 16;
+        int const stride[3] = { 1, size[0], size[0]*size[1] };
+        int const blocks[3] = { (size[0] + block - 1)/block, (size[1] + block - 1)/block, (size[2] + block - 1)/block };
+        int const dir[3]    = { (sweep & 1) ? -1 : 1, (sweep & 2) ? -1 : 1, (sweep & 4) ? -1 : 1 };
+
+        int changed = 0;
+        std::vector<int> front;
+        for(int level = 0; level < blocks[0] + blocks[1] + blocks[2] - 2; ++level)
+        {
+          //--- Collect the blocks of the wavefront, counted along the sweep direction
+          front.clear();
+          for(int bk = 0; bk < blocks[2] && bk <= level; ++bk)
+            for(int bj = 0; bj < blocks[1] && bk + bj <= level; ++bj)
+            {
+              int const bi = level - bk - bj;
+              if(bi < blocks[0])
+                front.push_back( (bk*blocks[1] + bj)*blocks[0] + bi );
+            }
+
+          int const count = static_cast<int>( front.size() );
+#pragma omp parallel for schedule(dynamic,1) reduction(+:changed) if(count > 1)
+          for(int b = 0; b < count; ++b)
+          {
+            int const bi = front[b] % blocks[0];
+            int const bj = (front[b] / blocks[0]) % blocks[1];
+            int const bk = front[b] / (blocks[0]*blocks[1]);
+            int const B[3] = { bi, bj, bk };
+
+            //--- Node ranges of the block, in sweep order
+            int begin[3];
+            int end[3];
+            for(int m = 0; m < 3; ++m)
+            {
+              int const lo = (dir[m] > 0 ? B[m] : blocks[m] - 1 - B[m])*block;
+              int const hi = lo + block < size[m] ? lo + block : size[m];
+              begin[m] = dir[m] > 0 ? lo : hi - 1;
+              end[m]   = dir[m] > 0 ? hi : lo - 1;
+            }
+
+            int index[3];
+            for(index[2] = begin[2]; index[2] != end[2]; index[2] += dir[2])
+              for(index[1] = begin[1]; index[1] != end[1]; index[1] += dir[1])
+                for(index[0] = begin[0]; index[0] != end[0]; index[0] += dir[0])
+                {
+                  size_t const idx = (static_cast<size_t>(index[2])*size[1] + index[1])*size[0] + index[0];
+                  if(fixed[idx])
+                    continue;
+                  if(sweep_node( values, idx, index, size, stride, spacing, unused ))
+                    changed = 1;
+                }
+          }
+        }
+        return changed > 0;
+      }
+
+    } // namespace detail
+
+    /**
+    * Fast Sweeping.
+    * Extends a signed distance field from the nodes with known values into
+    * the unused nodes, by solving the Eikonal equation |grad phi| = 1 with
+    * Gauss-Seidel iterations over the eight alternating sweep orderings, see
+    *
+    *   H. Zhao, "A fast sweeping method for Eikonal equations",
+    *   Mathematics of Computation, 2005.
+    *
+    * Nodes with known values are kept fixed, and unused nodes get the sign of
+    * the neighbor their distance is computed from. Thus the known nodes should
+    * form a band around the zero level set that is wider than the grid
+    * spacing, like the one computed by a t4 scan with a small thickness.
+    *
+    * The cost is a few passes over the grid, independent of how the known
+    * values were computed. Away from the known band the distances are first
+    * order accurate. Each sweep runs in parallel over blocks of nodes, see
+    * detail::parallel_sweep().
+    *
+    * @param phi              A dense grid, unused nodes are filled in upon return.
+    * @param max_iterations   The maximum number of rounds of eight sweeps. The
+    *                         sweeping stops early when a round does not change
+    *                         any values. Default is 4.
+    *
+    * @return                 The number of rounds that were done.
+    */
+    template<typename grid_type>
+    inline size_t fast_sweeping(grid_type & phi, size_t max_iterations = 4)
+    {
+      typedef typename grid_type::value_type             value_type;
+      typedef typename grid_type::math_types             math_types;
+      typedef typename math_types::real_type             real_type;
+
+      int const I = static_cast<int>( phi.I() );
+      int const J = static_cast<int>( phi.J() );
+      int const K = static_cast<int>( phi.K() );
+      if(I==0 || J==0 || K==0)
+        return 0;
+
+      value_type const unused = phi.unused();
+      value_type     * values = phi.data();
+      size_t   const   N      = phi.size();
+
+      //--- Known nodes are never changed, unused nodes act as infinitely far away
+      std::vector<char> fixed( N );
+      bool any_fixed = false;
+      for(size_t idx = 0; idx < N; ++idx)
+      {
+        fixed[idx] = (values[idx] != unused) ? 1 : 0;
+        any_fixed  = any_fixed || fixed[idx];
+      }
+      if(!any_fixed)
+        return 0;
+
+      int       const size[3]    = { I, J, K };
+      real_type const spacing[3] = { phi.dx(), phi.dy(), phi.dz() };
+
+      size_t iteration = 0;
+      bool changed = true;
+      while(changed && iteration < max_iterations)
+      {
+        changed = false;
+        ++iteration;
+        for(int sweep = 0; sweep < 8; ++sweep)
+          if( detail::parallel_sweep( values, fixed, size, spacing, unused, sweep ) )
+            changed = true;
+      }
+      return iteration;
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_FAST_SWEEPING_H
+#endif
@@ -10,12 +10,13 @@
 #include <OpenTissue/configuration.h>
 
 #include <OpenTissue/core/math/math_constants.h>
+#include <OpenTissue/core/containers/grid/util/grid_separable_filter.h>
 
 
 #include <boost/cast.hpp> //--- Needed for boost::numeric_cast 
 
-#include <valarray>
 #include <vector>
+#include <cmath>
 #include <iostream>
 #include <algorithm>
 
@@ -53,7 +54,7 @@ namespace OpenTissue
           std::cout << "compute_gaussian_kernel(): Oups, size of gaussian kernel was even!!!" << std::endl;
         }
 
-        real_type center = boost::numeric_cast<real_type>(   floor( size / 2.0 )  );
+        real_type center = boost::numeric_cast<real_type>(   std::floor( size / 2.0 )  );
 
         //--- We calculate the unnormalized Gaussian in the interval -ms:ms,
         //--- where m = (G.size()-1)/2;  We assume G.size() is uneven.
@@ -69,8 +70,31 @@ namespace OpenTissue
           G[i] = G[i] / sum;
       }
 
+      /**
+      * Create Gaussian Line Filter.
+      * The kernel covers the interval -2s:2s and the image is mirrored at
+      * the boundaries (Neumann boundary condition).
+      *
+      * @param s      The standard deviation of the Gaussian.
+      *
+      * @return       The line filter.
+      */
+      template <typename real_type>
+      inline ConvolutionLineFilter<real_type> gaussian_line_filter( real_type const & s )
+      {
+        using std::ceil;
+
+        //--- Allocate space for a gaussian on the interval -2s:2s, the kernel must have uneven length
+        int N_half = boost::numeric_cast<int>( ceil( 2 * s ) );
+        std::vector<real_type> G( 2*N_half + 1 );
+        compute_gaussian_kernel( G, s );
+        return ConvolutionLineFilter<real_type>( G, N_half, boundary_mirror );
+      }
+
       /**
       * One-dimensional convolution with a Gaussian kernel.
+      * Nodes with the highest value are in the ``void'' of the image, they do
+      * not affect the convolution and are left unchanged.
       *
       * @param output      The resulting image.
       * @param input      The original image.
@@ -96,81 +120,21 @@ namespace OpenTissue
         //--- First take care of trivial case
         if ( s <= 0 )
         {
-          std::copy( input, input+size, output );
+          if(output != input)
+            std::copy( input, input+size, output );
           return;
         }
 
-        //--- Now we allocate space for a gaussian on the interval -2s:2s.
-        int N = boost::numeric_cast<int>( ceil( 4 * s ) + 1 );
-        int N_half = boost::numeric_cast<int>( N/2.0);
-        std::valarray<real_type> G( N );
-        compute_gaussian_kernel( G, s );
-
-        for ( int k = 0; k < zdim; ++k )
-        {
-          for ( int j = 0; j < ydim; ++j )
-          {
-            for ( int i = 0; i < xdim; ++i )
-            {
-              //--- Check if we should happen to be in the ``void'' of the image.
-              //--- In this case we simply choose to ignore the gaussian bluring.
-              int idx = ( i * ydim + j ) * zdim + k;
-              if ( input[ idx ] == OpenTissue::math::detail::highest<value_type>() )
-              {
-                continue;
-              }
-              //--- Now we perform the convolution
-              real_type sum = real_type();  //--- default constructed integral types are zero!!!
-              for (int a = 0; a < N; ++a )
-              {
-                //--- We implement Neuman boundary condition: -1,-2,... -> 1,2,... (mirror)
-                //--- We assume that G has uneven length!
-                int newi = i;
-                int newj = j;
-                int newk = k;
-                switch ( dim )
-                {
-                case 0:
-                  newi -= a - N_half;
-                  if ( newi < 0 )
-                    newi = -newi;
-                  if ( newi >= xdim )
-                    newi = 2 * xdim - newi - 1; //--- zdim - (ind - zdim) = 2*zdim - ind;
-                  break;
-                case 1:
-                  newj -= a - N_half;
-                  if ( newj < 0 )
-                    newj = -newj;
-                  if ( newj >= ydim )
-                    newj = 2 * ydim - newj - 1; //--- zdim - (ind - zdim) = 2*zdim - ind;
-                  break;
-                default:  //2 or higher
-                  newk -= a - N_half;
-                  if ( newk < 0 )
-                    newk = -newk;
-                  if ( newk >= zdim )
-                    newk = 2 * zdim - newk - 1; //--- zdim - (ind - zdim) = 2*zdim - ind;
-                  break;
-                }
-
-                //--- sum += J[newi*size[0]*size[1] +newj*size[0] +newk]*G[a];
-                int idx2 = ( newi * ydim + newj ) * zdim + newk;
-
-                //--- Void-values should not effect the convolution!!!
-                if ( input[ idx2 ] != OpenTissue::math::detail::highest<value_type>() )
-                  sum += boost::numeric_cast<real_type>(   input[ idx2 ] * G[ a ]  );
-              }
-              //--- Finally we update the destination image with the result of the convolution.
-              output[ idx ] = boost::numeric_cast<value_type>(sum);
-            }
-          }
-        }
+        //--- The image is stored with the last dimension varying fastest
+        int const dims[3] = { zdim, ydim, xdim };
+        int const axis    = dim < 2 ? 2 - dim : 0;
+        separable_pass( input, output, dims, axis, gaussian_line_filter( s ), OpenTissue::math::detail::highest<value_type>() );
       }
 
       /**
       * Three-dimensional convolution with a Gaussian kernel.
       *
-      * @param output The resulting image.  Should be preallocated to same size as I.
+      * @param output The resulting image.  Should be preallocated to same size as I, may be the same as input.
       * @param input  The original image.
       * @param xdim   The size of I along the first dimenison.
       * @param ydim   The size of I along the second dimenison.
@@ -193,26 +157,21 @@ namespace OpenTissue
       {
         int size = xdim * ydim * zdim;
 
-        //--- Temporary workspace
-        std::vector<value_type> tmp( size );
-
-        //--- First the z-dimension:
-        std::copy( input, input+size, tmp.begin() );
-        convolution1D( output, &(tmp[0]), xdim, ydim, zdim, 2, sz );
-
-        //--- Then the y-dimension:
-        std::copy( output, output+size, tmp.begin() );
-        convolution1D( output, &(tmp[0]), xdim, ydim, zdim, 1, sy );
+        if(output != input)
+          std::copy( input, input+size, output );
 
-        //--- Finally the x-dimension:
-        std::copy( output, output+size, tmp.begin() );
-        convolution1D( output, &(tmp[0]) , xdim, ydim, zdim, 0, sx );
+        //--- The passes are done in place, first the z-dimension, then the y-dimension and finally the x-dimension
+        convolution1D( output, output, xdim, ydim, zdim, 2, sz );
+        convolution1D( output, output, xdim, ydim, zdim, 1, sy );
+        convolution1D( output, output, xdim, ydim, zdim, 0, sx );
       }
 
     }//namespace detail
 
     /**
     * Gaussian Convolution.
+    * The separable convolution is done by detail::convolution3D(), see
+    * separable_pass() for how the passes are blocked and multithreaded.
     *
     * @param src    Input image
     * @param dst    Upon return holds the resulting output image.
@@ -234,10 +193,11 @@ namespace OpenTissue
       assert( dst.I() == src.I() || !"gaussian_convolution(): dst and src have differnet I dimension");
       assert( dst.J() == src.J() || !"gaussian_convolution(): dst and src have differnet I dimension");
       assert( dst.K() == src.K() || !"gaussian_convolution(): dst and src have differnet I dimension");
-      int xdim = boost::numeric_cast< int>( src.I() );
+      //--- The grid is stored with the i index varying fastest, that is the last dimension of convolution3D()
+      int xdim = boost::numeric_cast< int>( src.K() );
       int ydim = boost::numeric_cast< int>( src.J() );
-      int zdim = boost::numeric_cast< int>( src.K() );
-      detail::convolution3D( dst.data(), src.data(), xdim, ydim, zdim, sx, sy, sz );
+      int zdim = boost::numeric_cast< int>( src.I() );
+      detail::convolution3D( dst.data(), src.data(), xdim, ydim, zdim, sz, sy, sx );
     }
 
   } // namespace grid
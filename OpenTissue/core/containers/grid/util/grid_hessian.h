@@ -27,24 +27,13 @@ namespace OpenTissue
 
       typedef typename matrix3x3_type::value_type real_type;
 
-      static grid_type * old_grid = 0;
-      static real_type m_inv_dx2 = 0;        ///< Pre-computed value of 1./grid.dx()*grid.dx()
-      static real_type m_inv_dy2 = 0;        ///< Pre-computed value of 1./grid.dy()*grid.dy()
-      static real_type m_inv_dz2 = 0;        ///< Pre-computed value of 1./grid.dz()*grid.dz()
-      static real_type m_inv_4dxy = 0;       ///< Pre-computed value of 1./4*grid.dx()*grid.dy()
-      static real_type m_inv_4dxz = 0;       ///< Pre-computed value of 1./4*grid.dx()*grid.dz()
-      static real_type m_inv_4dyz = 0;       ///< Pre-computed value of 1./4*grid.dy()*grid.dz()
-
-      if(old_grid!=&grid)
-      {
-        old_grid = const_cast<grid_type*>(&grid);
-        m_inv_dx2 = 1.0 / grid.dx() * grid.dx();
-        m_inv_dy2 = 1.0 / grid.dy() * grid.dy();
-        m_inv_dz2 = 1.0 / grid.dz() * grid.dz();
-        m_inv_4dxy = 0.25 / grid.dx() * grid.dy();
-        m_inv_4dxz = 0.25 / grid.dx() * grid.dz();
-        m_inv_4dyz = 0.25 / grid.dy() * grid.dz();
-      }
+      //--- Computed for every call, caching them in static variables is not thread safe
+      real_type const m_inv_dx2  = static_cast<real_type>( 1.0 / (grid.dx() * grid.dx()) );   // 1/(dx*dx)
+      real_type const m_inv_dy2  = static_cast<real_type>( 1.0 / (grid.dy() * grid.dy()) );   // 1/(dy*dy)
+      real_type const m_inv_dz2  = static_cast<real_type>( 1.0 / (grid.dz() * grid.dz()) );   // 1/(dz*dz)
+      real_type const m_inv_4dxy = static_cast<real_type>( 0.25 / (grid.dx() * grid.dy()) );  // 1/(4*dx*dy)
+      real_type const m_inv_4dxz = static_cast<real_type>( 0.25 / (grid.dx() * grid.dz()) );  // 1/(4*dx*dz)
+      real_type const m_inv_4dyz = static_cast<real_type>( 0.25 / (grid.dy() * grid.dz()) );  // 1/(4*dy*dz)
 
       size_t I = grid.I();
       size_t J = grid.J();
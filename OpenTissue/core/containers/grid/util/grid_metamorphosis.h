@@ -9,59 +9,54 @@
 //
 #include <OpenTissue/configuration.h>
 
+#include <OpenTissue/core/containers/grid/util/grid_narrow_band.h>
+
+#include <vector>
+#include <cmath>
+
 namespace OpenTissue
 {
   namespace grid
   {
 
-    /**
-    * Auxilliary function used by metamorphosis().
-    *
-    * This function compute the normal velocity flow.
-    *
-    *
-    *
-    * @param phi    The current surface
-    * @param gamma  The inside-outside function of target surface
-    * @param F      Upon return contains the normal velocity flow field.
-    */
-    template<
-      typename grid_type
-    >
-    inline void metamorphosis_speed_function(
-    grid_type const & phi
-    , grid_type const & gamma
-    , grid_type  & F
-    )
+    namespace detail
     {
-      using std::min;
-      using std::max;
-      using std::sqrt;
 
-      typedef typename grid_type::value_type            value_type;
-      typedef typename grid_type::iterator              iterator;
-      typedef typename grid_type::index_iterator        index_iterator;
-      typedef typename grid_type::const_index_iterator  const_index_iterator;
-      typedef typename grid_type::math_types            math_types;
-      typedef typename math_types::real_type            real_type;
-
-      size_t I = phi.I();
-      size_t J = phi.J();
-      size_t K = phi.K();
-      real_type dx = phi.dx();
-      real_type dy = phi.dy();
-      real_type dz = phi.dz();
+      /**
+      * Metamorphosis Speed at a Node.
+      * Computes the upwind (Godunov) approximation of |grad phi| times gamma.
+      *
+      * @param phi    The current surface
+      * @param g      The value of the inside-outside function of target surface at the node.
+      * @param i      The i'th index of the node.
+      * @param j      The j'th index of the node.
+      * @param k      The k'th index of the node.
+      *
+      * @return       The normal velocity of the node.
+      */
+      template<typename grid_type>
+      inline typename grid_type::math_types::real_type metamorphosis_speed(
+        grid_type const & phi
+        , typename grid_type::math_types::real_type const & g
+        , size_t i
+        , size_t j
+        , size_t k
+        )
+      {
+        using std::min;
+        using std::max;
+        using std::sqrt;
 
-      const_index_iterator end = phi.end();
-      const_index_iterator   u = phi.begin();
-      index_iterator         f = F.begin();
-      const_index_iterator   g = gamma.begin();
+        typedef typename grid_type::math_types            math_types;
+        typedef typename math_types::real_type            real_type;
 
-      for(;u!=end; ++u,++g,++f)
-      {
-        size_t i = u.i();
-        size_t j = u.j();
-        size_t k = u.k();
+        size_t I = phi.I();
+        size_t J = phi.J();
+        size_t K = phi.K();
+        real_type dx = phi.dx();
+        real_type dy = phi.dy();
+        real_type dz = phi.dz();
+        real_type const zero = real_type(0);
 
         size_t im1         = ( i ) ?  i - 1 : 0;
         size_t jm1         = ( j ) ?  j - 1 : 0;
@@ -91,23 +86,23 @@ namespace OpenTissue
         real_type  Umy        = (u_idx     - u_idx_jm1)/ dy;
         real_type  Umz        = (u_idx     - u_idx_km1)/ dz;
 
-        real_type Upx_min = min( Upx, 0.0);
-        real_type Upx_max = max( Upx, 0.0);
-        real_type Umx_min = min( Umx, 0.0);
-        real_type Umx_max = max( Umx, 0.0);
+        real_type Upx_min = min( Upx, zero);
+        real_type Upx_max = max( Upx, zero);
+        real_type Umx_min = min( Umx, zero);
+        real_type Umx_max = max( Umx, zero);
 
-        real_type Upy_min = min( Upy, 0.0);
-        real_type Upy_max = max( Upy, 0.0);
-        real_type Umy_min = min( Umy, 0.0);
-        real_type Umy_max = max( Umy, 0.0);
+        real_type Upy_min = min( Upy, zero);
+        real_type Upy_max = max( Upy, zero);
+        real_type Umy_min = min( Umy, zero);
+        real_type Umy_max = max( Umy, zero);
 
-        real_type Upz_min = min( Upz, 0.0);
-        real_type Upz_max = max( Upz, 0.0);
-        real_type Umz_min = min( Umz, 0.0);
-        real_type Umz_max = max( Umz, 0.0);
+        real_type Upz_min = min( Upz, zero);
+        real_type Upz_max = max( Upz, zero);
+        real_type Umz_min = min( Umz, zero);
+        real_type Umz_max = max( Umz, zero);
 
-        if(-(*g)>=0)
-          *f = (*g)*sqrt(
+        if(-g>=0)
+          return g*sqrt(
           Upx_min*Upx_min
           + Umx_max*Umx_max
           + Upy_min*Upy_min
@@ -115,8 +110,7 @@ namespace OpenTissue
           + Upz_min*Upz_min
           + Umz_max*Umz_max
           );
-        else
-          *f = (*g)*sqrt(
+        return g*sqrt(
           Upx_max*Upx_max
           + Umx_min*Umx_min
           + Upy_max*Upy_max
@@ -125,6 +119,40 @@ namespace OpenTissue
           + Umz_min*Umz_min
           );
       }
+
+    } // namespace detail
+
+    /**
+    * Auxilliary function used by metamorphosis().
+    *
+    * This function compute the normal velocity flow.
+    *
+    *
+    *
+    * @param phi    The current surface
+    * @param gamma  The inside-outside function of target surface
+    * @param F      Upon return contains the normal velocity flow field.
+    */
+    template<
+      typename grid_type
+    >
+    inline void metamorphosis_speed_function(
+    grid_type const & phi
+    , grid_type const & gamma
+    , grid_type  & F
+    )
+    {
+      typedef typename grid_type::value_type            value_type;
+      typedef typename grid_type::index_iterator        index_iterator;
+      typedef typename grid_type::const_index_iterator  const_index_iterator;
+
+      const_index_iterator end = phi.end();
+      const_index_iterator   u = phi.begin();
+      index_iterator         f = F.begin();
+      const_index_iterator   g = gamma.begin();
+
+      for(;u!=end; ++u,++g,++f)
+        *f = static_cast<value_type>( detail::metamorphosis_speed( phi, *g, u.i(), u.j(), u.k() ) );
       //std::cout << "metamorphosis_speed_function(): done..." << std::endl;
     }
 
@@ -232,6 +260,82 @@ namespace OpenTissue
       std::cout << "metamorphosis(): done..." << std::endl;
     }
 
+    /**
+    * Solid Shape Metamorphosis in a Narrow Band.
+    * Solves the same PDE as metamorphosis(), but only the nodes in the band
+    * are updated, so the cost of a time step is proportional to the area of
+    * the zero level set. The band is rebuilt whenever the zero level set comes
+    * close to the edge of the band, see NarrowBand::needs_rebuild().
+    *
+    * @param phi      Input/output level set.
+    * @param gamma    The inside/outside function of the target object.
+    * @param dt       The time to advance the level set.
+    * @param band     A narrow band that has been initialized with phi.
+    *
+    * @return         The number of time-steps that were taken.
+    */
+    template<
+      typename grid_type
+    >
+    inline size_t metamorphosis(
+    grid_type & phi
+    , grid_type const & gamma
+    , typename grid_type::math_types::real_type const & dt
+    , NarrowBand<grid_type> & band
+    )
+    {
+      typedef typename grid_type::value_type            value_type;
+      typedef typename grid_type::math_types            math_types;
+      typedef typename math_types::real_type            real_type;
+
+      using std::min;
+      using std::max;
+      using std::fabs;
+
+      size_t const I = phi.I();
+      size_t const J = phi.J();
+
+      real_type min_delta  = min ( phi.dx(), min( phi.dy(), phi.dz() ) );
+      assert(min_delta>0 || !"metamorphosis(): minimum spacing was non-positive!");
+
+      std::vector<real_type> F;
+      value_type * values = phi.data();
+
+      size_t steps = 0;
+      real_type time = static_cast<real_type>(0.0);
+      while (time < dt)
+      {
+        std::vector<size_t> const & active = band.active();
+        int const count = static_cast<int>( active.size() );
+        F.resize( count );
+
+#pragma omp parallel for schedule(static) if(count > 4096)
+        for(int n = 0; n < count; ++n)
+        {
+          size_t const idx = active[n];
+          F[n] = detail::metamorphosis_speed( phi, static_cast<real_type>( gamma(idx) ), idx % I, (idx / I) % J, idx / (I*J) );
+        }
+
+        //--- Only the target values inside the band matter for the time-step
+        real_type max_gamma = real_type(0);
+        for(int n = 0; n < count; ++n)
+          max_gamma = max( max_gamma, static_cast<real_type>( fabs( gamma( active[n] ) ) ) );
+        if(max_gamma <= real_type(0))
+          break;
+
+        real_type  time_step = min( dt - time,  min_delta / (3.0*max_gamma) );
+        for(int n = 0; n < count; ++n)
+          values[ active[n] ] = static_cast<value_type>( values[ active[n] ] + time_step*F[n] );
+        time += time_step;
+        ++steps;
+
+        if(band.needs_rebuild( phi ))
+          band.rebuild( phi );
+      }
+      return steps;
+    }
+
+
   } // namespace grid
 } // namespace OpenTissue
 
@@ -0,0 +1,276 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_MIP_PYRAMID_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_MIP_PYRAMID_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_constants.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Compute Min Filter Windows.
+      * For each coarse node along one axis, find the range of fine nodes that
+      * lie within one coarse plus one fine spacing of the coarse node. The
+      * ranges are padded by one node to be robust towards round off.
+      *
+      * @param N        The number of fine nodes.
+      * @param h        The fine spacing.
+      * @param M        The number of coarse nodes.
+      * @param H        The coarse spacing.
+      * @param lo       Upon return holds the first fine node of each window.
+      * @param hi       Upon return holds the last fine node of each window.
+      */
+      template<typename real_type>
+      inline void min_filter_windows(
+        size_t const N
+        , real_type const h
+        , size_t const M
+        , real_type const H
+        , std::vector<size_t> & lo
+        , std::vector<size_t> & hi
+        )
+      {
+        using std::floor;
+        using std::ceil;
+
+        lo.resize(M);
+        hi.resize(M);
+        for(size_t m = 0; m < M; ++m)
+        {
+          real_type const x     = m*H;
+          int       const first = static_cast<int>( floor( (x - H - h)/h ) ) - 1;
+          int       const last  = static_cast<int>( ceil(  (x + H + h)/h ) ) + 1;
+          lo[m] = static_cast<size_t>( first < 0 ? 0 : first );
+          hi[m] = static_cast<size_t>( last  < static_cast<int>(N) ? last : static_cast<int>(N) - 1 );
+        }
+      }
+
+    } // namespace detail
+
+    /**
+    * Conservative Min Downsampling.
+    * Creates a grid with half the resolution of the fine grid, spanning the
+    * same box. Each coarse node holds the minimum of the fine nodes within one
+    * coarse spacing (plus one fine spacing) of it. Thus the value of any corner
+    * node of a coarse cell is a lower bound of the values of all fine nodes
+    * in that cell, and so of any trilinear interpolation of the fine grid
+    * inside the cell.
+    *
+    * Unused fine nodes are taken to be zero, just like value_at_point() does.
+    *
+    * The minimum is taken over a box, so it is computed as three separable
+    * one dimensional min filters.
+    *
+    * @param fine      The fine grid, must have at least two nodes along each axis.
+    * @param coarse    Upon return holds the downsampled grid.
+    */
+    template<typename grid_type, typename coarse_grid_type>
+    inline void min_downsample( grid_type const & fine, coarse_grid_type & coarse )
+    {
+      using std::min;
+      using std::max;
+
+      typedef typename coarse_grid_type::value_type     value_type;
+      typedef typename coarse_grid_type::math_types     math_types;
+      typedef typename math_types::real_type            real_type;
+
+      size_t const I  = fine.I();
+      size_t const J  = fine.J();
+      size_t const K  = fine.K();
+      size_t const Ic = max( size_t(2), I/2 + 1 );
+      size_t const Jc = max( size_t(2), J/2 + 1 );
+      size_t const Kc = max( size_t(2), K/2 + 1 );
+
+      coarse.create( fine.min_coord(), fine.max_coord(), Ic, Jc, Kc );
+
+      std::vector<size_t> lo_i, hi_i, lo_j, hi_j, lo_k, hi_k;
+      detail::min_filter_windows( I, static_cast<real_type>( fine.dx() ), Ic, coarse.dx(), lo_i, hi_i );
+      detail::min_filter_windows( J, static_cast<real_type>( fine.dy() ), Jc, coarse.dy(), lo_j, hi_j );
+      detail::min_filter_windows( K, static_cast<real_type>( fine.dz() ), Kc, coarse.dz(), lo_k, hi_k );
+
+      typename grid_type::value_type const unused = fine.unused();
+      value_type const zero = value_type();
+
+      //--- Along the x-axis: (I,J,K) -> (Ic,J,K)
+      std::vector<value_type> x_pass( Ic*J*K );
+      for(size_t k = 0; k < K; ++k)
+        for(size_t j = 0; j < J; ++j)
+          for(size_t ic = 0; ic < Ic; ++ic)
+          {
+            value_type value = math::detail::highest<value_type>();
+            for(size_t i = lo_i[ic]; i <= hi_i[ic]; ++i)
+            {
+              typename grid_type::value_type const v = fine(i,j,k);
+              value = min( value, v == unused ? zero : static_cast<value_type>( v ) );
+            }
+            x_pass[(k*J + j)*Ic + ic] = value;
+          }
+
+      //--- Along the y-axis: (Ic,J,K) -> (Ic,Jc,K)
+      std::vector<value_type> y_pass( Ic*Jc*K );
+      for(size_t k = 0; k < K; ++k)
+        for(size_t jc = 0; jc < Jc; ++jc)
+          for(size_t ic = 0; ic < Ic; ++ic)
+          {
+            value_type value = math::detail::highest<value_type>();
+            for(size_t j = lo_j[jc]; j <= hi_j[jc]; ++j)
+              value = min( value, x_pass[(k*J + j)*Ic + ic] );
+            y_pass[(k*Jc + jc)*Ic + ic] = value;
+          }
+
+      //--- Along the z-axis: (Ic,Jc,K) -> (Ic,Jc,Kc)
+      for(size_t kc = 0; kc < Kc; ++kc)
+        for(size_t jc = 0; jc < Jc; ++jc)
+          for(size_t ic = 0; ic < Ic; ++ic)
+          {
+            value_type value = math::detail::highest<value_type>();
+            for(size_t k = lo_k[kc]; k <= hi_k[kc]; ++k)
+              value = min( value, y_pass[(k*Jc + jc)*Ic + ic] );
+            coarse(ic,jc,kc) = value;
+          }
+    }
+
+    /**
+    * Compute Mip Pyramid.
+    * Builds a sequence of conservatively downsampled grids, see min_downsample().
+    * Level zero has half the resolution of phi, and each following level
+    * halves the resolution of the previous one. Building stops when the
+    * requested number of levels is reached, or when a level has two nodes
+    * along every axis.
+    *
+    * If phi is a signed distance field, then phi is 1-Lipschitz, and a sphere
+    * with center c and radius r can only touch the zero level set if
+    * phi(c) < r. Any level of the pyramid gives a lower bound of phi(c) by a
+    * single node lookup, see pyramid_lower_bound(), so the coarse levels can
+    * cull queries before the fine grid is touched.
+    *
+    * @param phi         The fine grid.
+    * @param levels      The maximum number of levels to compute.
+    * @param pyramid     Upon return holds the pyramid levels ordered from fine to coarse.
+    *
+    * @return            The number of levels that were computed.
+    */
+    template<typename grid_type, typename level_type>
+    inline size_t compute_mip_pyramid( grid_type const & phi, size_t levels, std::vector<level_type> & pyramid )
+    {
+      pyramid.clear();
+      if(phi.I() < 2 || phi.J() < 2 || phi.K() < 2)
+        return 0;
+
+      //--- Make sure push_back does not invalidate the previous level
+      pyramid.reserve( levels );
+
+      if(levels > 0 && (phi.I() > 2 || phi.J() > 2 || phi.K() > 2))
+      {
+        pyramid.push_back( level_type() );
+        min_downsample( phi, pyramid.back() );
+      }
+      while(!pyramid.empty() && pyramid.size() < levels)
+      {
+        level_type const & previous = pyramid.back();
+        if(previous.I() <= 2 && previous.J() <= 2 && previous.K() <= 2)
+          break;
+        pyramid.push_back( level_type() );
+        min_downsample( pyramid[pyramid.size() - 2], pyramid.back() );
+      }
+      return pyramid.size();
+    }
+
+    /**
+    * Lower Bound At Point.
+    * Looks up the lower corner node of the cell containing the point. For a
+    * level computed by min_downsample() this is a lower bound of the
+    * trilinear interpolation of the finer grid at the point.
+    *
+    * Points outside the grid, or within half a cell of the upper sides of the
+    * grid (where the enclosing indices of the finer grid wrap around), gets
+    * no bound.
+    *
+    * @param level     A pyramid level.
+    * @param point     The point.
+    *
+    * @return          The lower bound, or the lowest real value if there is no bound.
+    */
+    template<typename level_type, typename vector3_type>
+    inline typename vector3_type::value_type lower_bound_at_point( level_type const & level, vector3_type const & point )
+    {
+      typedef typename vector3_type::value_type  real_type;
+
+      real_type const dx = level.dx();
+      real_type const dy = level.dy();
+      real_type const dz = level.dz();
+      real_type const x  = point(0) - level.min_coord(0);
+      real_type const y  = point(1) - level.min_coord(1);
+      real_type const z  = point(2) - level.min_coord(2);
+
+      if( x < 0 || y < 0 || z < 0 )
+        return math::detail::lowest<real_type>();
+      if( x > level.max_coord(0) - level.min_coord(0) - dx/2 )
+        return math::detail::lowest<real_type>();
+      if( y > level.max_coord(1) - level.min_coord(1) - dy/2 )
+        return math::detail::lowest<real_type>();
+      if( z > level.max_coord(2) - level.min_coord(2) - dz/2 )
+        return math::detail::lowest<real_type>();
+
+      size_t const i = static_cast<size_t>( x / dx );
+      size_t const j = static_cast<size_t>( y / dy );
+      size_t const k = static_cast<size_t>( z / dz );
+      return static_cast<real_type>( level( i, j, k ) );
+    }
+
+    /**
+    * Pyramid Lower Bound.
+    * Walks the pyramid from the coarsest to the finest level, and stops as
+    * soon as a level proves that the value at the point is no less than the
+    * threshold. Thus far away points only touch the small coarse levels.
+    *
+    * @param pyramid     The pyramid levels ordered from fine to coarse, see compute_mip_pyramid().
+    * @param point       The point.
+    * @param threshold   The threshold value.
+    *
+    * @return            The largest lower bound found. If this is less than the
+    *                    threshold then all levels were visited. If the pyramid is
+    *                    empty the lowest real value is returned.
+    */
+    template<typename level_type, typename vector3_type>
+    inline typename vector3_type::value_type pyramid_lower_bound(
+      std::vector<level_type> const & pyramid
+      , vector3_type const & point
+      , typename vector3_type::value_type const & threshold
+      )
+    {
+      using std::max;
+
+      typedef typename vector3_type::value_type  real_type;
+
+      real_type bound = math::detail::lowest<real_type>();
+      for(size_t l = pyramid.size(); l > 0; --l)
+      {
+        bound = max( bound, lower_bound_at_point( pyramid[l-1], point ) );
+        if(bound >= threshold)
+          break;
+      }
+      return bound;
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_MIP_PYRAMID_H
+#endif
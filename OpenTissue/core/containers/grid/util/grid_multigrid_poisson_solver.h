@@ -0,0 +1,666 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_MULTIGRID_POISSON_SOLVER_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_MULTIGRID_POISSON_SOLVER_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Poisson Row Stencil.
+      * The seven point Laplacian stencil of one row of nodes along the
+      * x-axis. The neighbor rows along the y- and z-axes are found once per
+      * row, so only the first and last node of a row need special treatment.
+      *
+      * Neighbors outside the grid are mirrored, u_{-1} = u_1, which gives a
+      * zero normal derivative at boundary nodes. Axes with a single node get
+      * zero weights.
+      */
+      template<typename real_type>
+      class PoissonRow
+      {
+      public:
+
+        size_t     m_offset;      ///< Linear index of the first node of the row.
+        size_t     m_I;           ///< Number of nodes in the row.
+        real_type  m_cx;          ///< Weight of x-neighbors, 1/dx^2.
+        real_type  m_cyz[2];      ///< Weights of the y- and z-neighbors.
+        long       m_o[4];        ///< Offsets to the y-, y+, z- and z+ neighbors.
+        real_type  m_diag;        ///< Sum of all neighbor weights.
+        bool       m_boundary;    ///< True if the row lies on the boundary of the grid.
+
+      public:
+
+        PoissonRow(size_t I, size_t J, size_t K, size_t j, size_t k, real_type const c[3])
+          : m_offset( (k*J + j)*I )
+          , m_I(I)
+          , m_cx( I > 1 ? c[0] : real_type(0) )
+          , m_diag(0)
+          , m_boundary( (J > 1 && (j == 0 || j + 1 == J)) || (K > 1 && (k == 0 || k + 1 == K)) )
+        {
+          long const sy = static_cast<long>( I );
+          long const sz = static_cast<long>( I*J );
+          m_cyz[0] = J > 1 ? c[1] : real_type(0);
+          m_cyz[1] = K > 1 ? c[2] : real_type(0);
+          m_o[0] = J > 1 ? ( j > 0     ? -sy :  sy ) : 0;
+          m_o[1] = J > 1 ? ( j + 1 < J ?  sy : -sy ) : 0;
+          m_o[2] = K > 1 ? ( k > 0     ? -sz :  sz ) : 0;
+          m_o[3] = K > 1 ? ( k + 1 < K ?  sz : -sz ) : 0;
+          m_diag = 2*( m_cx + m_cyz[0] + m_cyz[1] );
+        }
+
+        /**
+        * Weighted Neighbor Sum.
+        *
+        * @param u     The node values.
+        * @param i     The node index within the row.
+        *
+        * @return      The weighted sum of the neighbor values, thus the Laplacian of u at the node is the return value minus m_diag*u.
+        */
+        template<typename value_type>
+        real_type sum(value_type const * u, size_t i) const
+        {
+          value_type const * v = u + m_offset + i;
+          real_type s = m_cyz[0]*( v[m_o[0]] + v[m_o[1]] ) + m_cyz[1]*( v[m_o[2]] + v[m_o[3]] );
+          if(i > 0 && i + 1 < m_I)
+            s += m_cx*( v[-1] + v[1] );
+          else if(m_I > 1)
+            s += 2*m_cx*( i > 0 ? v[-1] : v[1] );
+          return s;
+        }
+
+        /**
+        * Test for Fixed Node.
+        * With Dirichlet boundary conditions the nodes on the boundary keep their values.
+        */
+        bool fixed(size_t i, bool dirichlet) const
+        {
+          return dirichlet && ( m_boundary || (m_I > 1 && (i == 0 || i + 1 == m_I)) );
+        }
+
+      };
+
+      /**
+      * Multigrid Level.
+      */
+      template<typename grid_type>
+      class MultigridLevel
+      {
+      public:
+
+        typedef typename grid_type::math_types::real_type   real_type;
+
+        grid_type   m_u;      ///< The solution (the error on coarse levels). Unused on the finest level, where the solution is updated in place.
+        grid_type   m_f;      ///< The right hand side.
+        grid_type   m_r;      ///< The residual.
+        real_type   m_c[3];   ///< Stencil weights along each axis, 1/h^2 or zero along axes with a single node.
+
+      };
+
+      /**
+      * Setup Stencil Weights.
+      */
+      template<typename grid_type, typename real_type>
+      inline void multigrid_weights(grid_type const & grid, real_type c[3])
+      {
+        c[0] = grid.I() > 1 ? real_type(1)/(grid.dx()*grid.dx()) : real_type(0);
+        c[1] = grid.J() > 1 ? real_type(1)/(grid.dy()*grid.dy()) : real_type(0);
+        c[2] = grid.K() > 1 ? real_type(1)/(grid.dz()*grid.dz()) : real_type(0);
+      }
+
+      /**
+      * Red-Black Gauss-Seidel Smoothing.
+      * All nodes of one color only depend on nodes of the other color, so
+      * each half sweep is run in parallel over z-slabs.
+      *
+      * @param u           The solution.
+      * @param f           The right hand side.
+      * @param c           The stencil weights.
+      * @param sweeps      The number of sweeps.
+      * @param dirichlet   Boundary condition flag.
+      */
+      template<typename grid_type, typename real_type>
+      inline void multigrid_smooth(
+        grid_type & u
+        , grid_type const & f
+        , real_type const c[3]
+        , size_t sweeps
+        , bool dirichlet
+        )
+      {
+        typedef typename grid_type::value_type  value_type;
+
+        size_t const I = u.I();
+        size_t const J = u.J();
+        size_t const K = u.K();
+        value_type       * U = u.data();
+        value_type const * F = f.data();
+
+        for(size_t sweep = 0; sweep < sweeps; ++sweep)
+        {
+          for(size_t color = 0; color < 2; ++color)
+          {
+#pragma omp parallel for schedule(static) if(I*J*K > 32768)
+            for(int k = 0; k < static_cast<int>(K); ++k)
+            {
+              for(size_t j = 0; j < J; ++j)
+              {
+                PoissonRow<real_type> const row( I, J, K, j, k, c );
+                if(dirichlet && row.m_boundary)
+                  continue;
+                for(size_t i = (color + j + k) & 1u; i < I; i += 2)
+                {
+                  if(row.fixed( i, dirichlet ))
+                    continue;
+                  if(row.m_diag > real_type(0))
+                    U[row.m_offset + i] = static_cast<value_type>( (row.sum( U, i ) - F[row.m_offset + i]) / row.m_diag );
+                }
+              }
+            }
+          }
+        }
+      }
+
+      /**
+      * Compute Residual.
+      * Computes r = f - L u, where L is the discrete Laplacian.
+      *
+      * @return   The sum of the squared residuals.
+      */
+      template<typename grid_type, typename real_type>
+      inline real_type multigrid_residual(
+        grid_type const & u
+        , grid_type const & f
+        , grid_type & r
+        , real_type const c[3]
+        , bool dirichlet
+        )
+      {
+        typedef typename grid_type::value_type  value_type;
+
+        size_t const I = u.I();
+        size_t const J = u.J();
+        size_t const K = u.K();
+        value_type const * U = u.data();
+        value_type const * F = f.data();
+        value_type       * R = r.data();
+
+        real_type norm2 = real_type(0);
+#pragma omp parallel for schedule(static) reduction(+:norm2) if(I*J*K > 32768)
+        for(int k = 0; k < static_cast<int>(K); ++k)
+        {
+          for(size_t j = 0; j < J; ++j)
+          {
+            PoissonRow<real_type> const row( I, J, K, j, k, c );
+            for(size_t i = 0; i < I; ++i)
+            {
+              size_t const idx = row.m_offset + i;
+              if(row.fixed( i, dirichlet ))
+              {
+                R[idx] = value_type(0);
+                continue;
+              }
+              real_type const res = F[idx] - ( row.sum( U, i ) - row.m_diag*U[idx] );
+              R[idx] = static_cast<value_type>( res );
+              norm2 += res*res;
+            }
+          }
+        }
+        return norm2;
+      }
+
+      /**
+      * Interpolation Table.
+      * The coarse grid spans the same box as the fine grid, so fine node n
+      * lies at x = n (M-1)/(N-1) in coarse index space. It is interpolated
+      * from coarse nodes c0 and c1 with weights 1-w and w.
+      */
+      template<typename real_type>
+      class MultigridTable
+      {
+      public:
+
+        std::vector<size_t>     m_c0;   ///< Lower coarse node of each fine node.
+        std::vector<size_t>     m_c1;   ///< Upper coarse node of each fine node.
+        std::vector<real_type>  m_w;    ///< Weight of the upper coarse node of each fine node.
+        std::vector<size_t>     m_lo;   ///< First fine node interpolated from each coarse node.
+        std::vector<size_t>     m_hi;   ///< One past the last fine node interpolated from each coarse node.
+
+      public:
+
+        MultigridTable(size_t N, size_t M)
+          : m_c0(N), m_c1(N), m_w(N), m_lo(M, N), m_hi(M, 0)
+        {
+          using std::floor;
+          using std::min;
+
+          real_type const scale = N > 1 ? real_type(M - 1)/real_type(N - 1) : real_type(0);
+          for(size_t n = 0; n < N; ++n)
+          {
+            real_type const x = n*scale;
+            size_t c0 = static_cast<size_t>( floor( x ) );
+            if(M > 1)
+              c0 = min( c0, M - 2 );
+            m_c0[n] = c0;
+            m_c1[n] = min( c0 + 1, M - 1 );
+            m_w[n]  = M > 1 ? x - c0 : real_type(0);
+
+            m_lo[m_c0[n]] = min( m_lo[m_c0[n]], n );
+            m_lo[m_c1[n]] = min( m_lo[m_c1[n]], n );
+            m_hi[m_c0[n]] = n + 1;
+            m_hi[m_c1[n]] = n + 1;
+          }
+        }
+
+        /**
+        * Get Interpolation Weight.
+        *
+        * @return   The weight of coarse node m in the interpolation of fine node n.
+        */
+        real_type weight(size_t n, size_t m) const
+        {
+          real_type w = real_type(0);
+          if(m_c0[n] == m)
+            w += real_type(1) - m_w[n];
+          if(m_c1[n] == m)
+            w += m_w[n];
+          return w;
+        }
+
+      };
+
+      /**
+      * Restriction.
+      * The transpose of trilinear interpolation, normalized such that
+      * the weights of every coarse node add up to one. On a grid with
+      * 2^n+1 nodes this is the usual full weighting operator. The
+      * restriction is separable, so it is done as three one dimensional
+      * passes, each parallel over its outermost axis.
+      */
+      template<typename grid_type, typename real_type>
+      inline void multigrid_restrict(grid_type const & fine, grid_type & coarse)
+      {
+        typedef typename grid_type::value_type  value_type;
+
+        size_t const I  = fine.I();
+        size_t const J  = fine.J();
+        size_t const K  = fine.K();
+        size_t const Ic = coarse.I();
+        size_t const Jc = coarse.J();
+        size_t const Kc = coarse.K();
+
+        MultigridTable<real_type> const ti( I, Ic );
+        MultigridTable<real_type> const tj( J, Jc );
+        MultigridTable<real_type> const tk( K, Kc );
+
+        value_type const * F = fine.data();
+        value_type       * C = coarse.data();
+
+        //--- Along the x-axis: (I,J,K) -> (Ic,J,K)
+        std::vector<real_type> x_pass( Ic*J*K );
+#pragma omp parallel for schedule(static) if(I*J*K > 32768)
+        for(int k = 0; k < static_cast<int>(K); ++k)
+          for(size_t j = 0; j < J; ++j)
+            for(size_t ic = 0; ic < Ic; ++ic)
+            {
+              real_type sum   = real_type(0);
+              real_type total = real_type(0);
+              for(size_t i = ti.m_lo[ic]; i < ti.m_hi[ic]; ++i)
+              {
+                real_type const w = ti.weight( i, ic );
+                sum   += w*F[(k*J + j)*I + i];
+                total += w;
+              }
+              x_pass[(k*J + j)*Ic + ic] = total > real_type(0) ? sum/total : real_type(0);
+            }
+
+        //--- Along the y-axis: (Ic,J,K) -> (Ic,Jc,K)
+        std::vector<real_type> y_pass( Ic*Jc*K );
+#pragma omp parallel for schedule(static) if(I*J*K > 32768)
+        for(int k = 0; k < static_cast<int>(K); ++k)
+          for(size_t jc = 0; jc < Jc; ++jc)
+            for(size_t ic = 0; ic < Ic; ++ic)
+            {
+              real_type sum   = real_type(0);
+              real_type total = real_type(0);
+              for(size_t j = tj.m_lo[jc]; j < tj.m_hi[jc]; ++j)
+              {
+                real_type const w = tj.weight( j, jc );
+                sum   += w*x_pass[(k*J + j)*Ic + ic];
+                total += w;
+              }
+              y_pass[(k*Jc + jc)*Ic + ic] = total > real_type(0) ? sum/total : real_type(0);
+            }
+
+        //--- Along the z-axis: (Ic,Jc,K) -> (Ic,Jc,Kc)
+#pragma omp parallel for schedule(static) if(I*J*K > 32768)
+        for(int kc = 0; kc < static_cast<int>(Kc); ++kc)
+          for(size_t jc = 0; jc < Jc; ++jc)
+            for(size_t ic = 0; ic < Ic; ++ic)
+            {
+              real_type sum   = real_type(0);
+              real_type total = real_type(0);
+              for(size_t k = tk.m_lo[kc]; k < tk.m_hi[kc]; ++k)
+              {
+                real_type const w = tk.weight( k, kc );
+                sum   += w*y_pass[(k*Jc + jc)*Ic + ic];
+                total += w;
+              }
+              C[(kc*Jc + jc)*Ic + ic] = static_cast<value_type>( total > real_type(0) ? sum/total : real_type(0) );
+            }
+      }
+
+      /**
+      * Prolongation.
+      * Adds the trilinear interpolation of the coarse grid to the fine grid.
+      */
+      template<typename grid_type, typename real_type>
+      inline void multigrid_prolong(grid_type const & coarse, grid_type & fine, bool dirichlet)
+      {
+        typedef typename grid_type::value_type  value_type;
+
+        size_t const I  = fine.I();
+        size_t const J  = fine.J();
+        size_t const K  = fine.K();
+        size_t const Ic = coarse.I();
+        size_t const Jc = coarse.J();
+
+        MultigridTable<real_type> const ti( I, coarse.I() );
+        MultigridTable<real_type> const tj( J, coarse.J() );
+        MultigridTable<real_type> const tk( K, coarse.K() );
+
+        real_type const zero[3] = { real_type(0), real_type(0), real_type(0) };
+
+        value_type const * C = coarse.data();
+        value_type       * U = fine.data();
+
+#pragma omp parallel for schedule(static) if(I*J*K > 32768)
+        for(int k = 0; k < static_cast<int>(K); ++k)
+        {
+          size_t    const k0 = tk.m_c0[k];
+          size_t    const k1 = tk.m_c1[k];
+          real_type const wk = tk.m_w[k];
+          for(size_t j = 0; j < J; ++j)
+          {
+            PoissonRow<real_type> const row( I, J, K, j, k, zero );
+            if(dirichlet && row.m_boundary)
+              continue;
+            size_t    const j0 = tj.m_c0[j];
+            size_t    const j1 = tj.m_c1[j];
+            real_type const wj = tj.m_w[j];
+            value_type const * C00 = C + (k0*Jc + j0)*Ic;
+            value_type const * C10 = C + (k0*Jc + j1)*Ic;
+            value_type const * C01 = C + (k1*Jc + j0)*Ic;
+            value_type const * C11 = C + (k1*Jc + j1)*Ic;
+            for(size_t i = 0; i < I; ++i)
+            {
+              if(row.fixed( i, dirichlet ))
+                continue;
+              size_t    const i0 = ti.m_c0[i];
+              size_t    const i1 = ti.m_c1[i];
+              real_type const wi = ti.m_w[i];
+              real_type const v00 = (real_type(1) - wi)*C00[i0] + wi*C00[i1];
+              real_type const v10 = (real_type(1) - wi)*C10[i0] + wi*C10[i1];
+              real_type const v01 = (real_type(1) - wi)*C01[i0] + wi*C01[i1];
+              real_type const v11 = (real_type(1) - wi)*C11[i0] + wi*C11[i1];
+              real_type const v0  = (real_type(1) - wj)*v00 + wj*v10;
+              real_type const v1  = (real_type(1) - wj)*v01 + wj*v11;
+              U[row.m_offset + i] += static_cast<value_type>( (real_type(1) - wk)*v0 + wk*v1 );
+            }
+          }
+        }
+      }
+
+      /**
+      * Remove Mean Value.
+      * With pure Neumann boundary conditions constants lie in the null space
+      * of the Laplacian, and a right hand side is only compatible if its
+      * mean value is zero. The mean value is weighted like the trapezoidal
+      * rule, boundary nodes get half weight along each axis, since these are
+      * the weights that make the mirrored boundary stencil symmetric.
+      *
+      * @return   The mean value that was subtracted.
+      */
+      template<typename grid_type, typename real_type>
+      inline real_type multigrid_remove_mean(grid_type & g)
+      {
+        typedef typename grid_type::value_type  value_type;
+
+        size_t const I = g.I();
+        size_t const J = g.J();
+        size_t const K = g.K();
+        value_type * G = g.data();
+
+        real_type sum   = real_type(0);
+        real_type total = real_type(0);
+#pragma omp parallel for schedule(static) reduction(+:sum,total) if(I*J*K > 32768)
+        for(int k = 0; k < static_cast<int>(K); ++k)
+          for(size_t j = 0; j < J; ++j)
+          {
+            real_type const wk  = ( K > 1 && (k == 0 || k + 1 == static_cast<int>(K)) ) ? real_type(0.5) : real_type(1);
+            real_type const wjk = ( J > 1 && (j == 0 || j + 1 == J) ) ? wk*real_type(0.5) : wk;
+            value_type const * row = G + (k*J + j)*I;
+            real_type row_sum = real_type(0);
+            for(size_t i = 0; i < I; ++i)
+              row_sum += ( I > 1 && (i == 0 || i + 1 == I) ) ? real_type(0.5)*row[i] : real_type(row[i]);
+            sum   += wjk*row_sum;
+            total += wjk*( I > 1 ? I - 1 : 1 );
+          }
+        real_type const mean = total > real_type(0) ? sum/total : real_type(0);
+
+        int const N = static_cast<int>( g.size() );
+#pragma omp parallel for schedule(static) if(N > 32768)
+        for(int n = 0; n < N; ++n)
+          G[n] = static_cast<value_type>( G[n] - mean );
+        return mean;
+      }
+
+      /**
+      * Multigrid Cycle.
+      * Recursively solves for the error of level l. With gamma = 1 this is
+      * a V-cycle, with gamma = 2 a W-cycle.
+      */
+      template<typename grid_type, typename real_type>
+      inline void multigrid_cycle(
+        std::vector< MultigridLevel<grid_type> > & levels
+        , grid_type & phi
+        , size_t l
+        , size_t gamma
+        , size_t smoothing
+        , size_t coarse_sweeps
+        , bool dirichlet
+        )
+      {
+        MultigridLevel<grid_type> & level = levels[l];
+        grid_type & u = l ? level.m_u : phi;
+
+        if(l + 1 == levels.size())
+        {
+          multigrid_smooth( u, level.m_f, level.m_c, coarse_sweeps, dirichlet );
+          return;
+        }
+
+        MultigridLevel<grid_type> & next = levels[l + 1];
+
+        multigrid_smooth( u, level.m_f, level.m_c, smoothing, dirichlet );
+        multigrid_residual( u, level.m_f, level.m_r, level.m_c, dirichlet );
+        multigrid_restrict<grid_type, real_type>( level.m_r, next.m_f );
+        if(!dirichlet)
+          multigrid_remove_mean<grid_type, real_type>( next.m_f );
+
+        std::fill( next.m_u.begin(), next.m_u.end(), typename grid_type::value_type(0) );
+        for(size_t g = 0; g < gamma; ++g)
+        {
+          multigrid_cycle<grid_type, real_type>( levels, phi, l + 1, gamma, smoothing, coarse_sweeps, dirichlet );
+          if(l + 2 == levels.size())
+            break;
+        }
+
+        multigrid_prolong<grid_type, real_type>( next.m_u, u, dirichlet );
+        multigrid_smooth( u, level.m_f, level.m_c, smoothing, dirichlet );
+      }
+
+    } // namespace detail
+
+    /**
+    * Geometric Multigrid Poisson Solver.
+    * Solves the PDE
+    *
+    *   \nabla^2 \phi = W
+    *
+    * using the usual seven point finite difference Laplacian, just like
+    * poisson_solver(), but converges in a few cycles independently of the
+    * grid resolution.
+    *
+    * The grid hierarchy is built by halving the number of nodes along the
+    * axes with at least five nodes, coarse grids span the same box as phi.
+    * On grids with very different spacings along the axes only the axes with
+    * the smallest spacings are halved (semi-coarsening), until the spacings
+    * are about the same.
+    * Residuals are restricted by full weighting and errors are prolongated
+    * by trilinear interpolation. The smoother is red-black Gauss-Seidel, and
+    * the coarsest grid (at most four nodes along any axis) is solved by
+    * repeated smoothing. All operations run in parallel over z-slabs when
+    * OpenMP is enabled.
+    *
+    * Two kinds of boundary conditions are supported:
+    *
+    *   Dirichlet: The nodes on the boundary of phi keep their values.
+    *
+    *   Neumann:   The normal derivative of phi is zero on the boundary, this
+    *              is done by mirroring phi across the boundary. The problem
+    *              is only solvable if W has zero mean, so the mean value of
+    *              W is ignored. The solution is only unique up to a
+    *              constant, which is chosen such that the mean value of phi
+    *              is not changed.
+    *
+    * Cycles are run until the root mean square of the residual has been
+    * reduced by the given tolerance, relative to the residual of the initial
+    * guess, or until the maximum number of cycles is reached.
+    *
+    * @param phi              Contains initial guess for solution (and the
+    *                         boundary values in case of Dirichlet boundary
+    *                         conditions), and upon return contains the solution.
+    * @param W                The right hand side of the poisson equation.
+    * @param dirichlet        If true Dirichlet boundary conditions are used, otherwise
+    *                         Neumann boundary conditions are used. Default is false.
+    * @param tolerance        The relative residual reduction. Default is 1e-6.
+    * @param max_cycles       The maximum number of cycles. Default is 30.
+    * @param gamma            The cycle type, 1 gives V-cycles and 2 gives W-cycles. Default is 1.
+    * @param smoothing        The number of pre- and post-smoothing sweeps. Default is 2.
+    *
+    * @return                 The number of cycles used.
+    */
+    template < typename grid_type >
+    inline size_t multigrid_poisson_solver(
+      grid_type & phi
+      , grid_type const & W
+      , bool const dirichlet = false
+      , typename grid_type::math_types::real_type const & tolerance = 1e-6
+      , size_t const max_cycles = 30
+      , size_t const gamma = 1
+      , size_t const smoothing = 2
+      )
+    {
+      using std::sqrt;
+      using std::max;
+
+      typedef typename grid_type::value_type            value_type;
+      typedef typename grid_type::math_types            math_types;
+      typedef typename math_types::real_type            real_type;
+      typedef typename math_types::vector3_type         vector3_type;
+      typedef detail::MultigridLevel<grid_type>         level_type;
+
+      if(phi.size() == 0)
+        return 0;
+
+      //--- Build the hierarchy, level zero solves for phi directly
+      std::vector<level_type> levels;
+      levels.push_back( level_type() );
+      levels[0].m_f = W;
+      levels[0].m_r = W;
+      detail::multigrid_weights( phi, levels[0].m_c );
+      for(;;)
+      {
+        size_t N[3] = { levels.back().m_f.I(), levels.back().m_f.J(), levels.back().m_f.K() };
+        real_type const * c = levels.back().m_c;
+
+        //--- Only coarsen axes that are strongly coupled, a point smoother does not smooth the error along weakly coupled axes
+        real_type c_max = real_type(0);
+        for(size_t m = 0; m < 3; ++m)
+          if(N[m] >= 5)
+            c_max = max( c_max, c[m] );
+        if(c_max <= real_type(0))
+          break;
+        for(size_t m = 0; m < 3; ++m)
+          if(N[m] >= 5 && 2*c[m] >= c_max)
+            N[m] = N[m]/2 + 1;
+
+        vector3_type const min_coord = phi.min_coord();
+        vector3_type const max_coord = phi.max_coord();
+        levels.push_back( level_type() );
+        level_type & coarse = levels.back();
+        coarse.m_u.create( min_coord, max_coord, N[0], N[1], N[2] );
+        coarse.m_f.create( min_coord, max_coord, N[0], N[1], N[2] );
+        coarse.m_r.create( min_coord, max_coord, N[0], N[1], N[2] );
+        detail::multigrid_weights( coarse.m_u, coarse.m_c );
+      }
+
+      //--- The coarsest grid has at most four nodes along any axis, smoothing it this many times solves it to high accuracy
+      size_t const coarse_sweeps = 4u*levels.back().m_f.size() + 16u;
+
+      real_type mean = real_type(0);
+      value_type * P = phi.data();
+      if(!dirichlet)
+      {
+        detail::multigrid_remove_mean<grid_type, real_type>( levels[0].m_f );
+        for(size_t idx = 0; idx < phi.size(); ++idx)
+          mean += P[idx];
+      }
+
+      real_type const initial = detail::multigrid_residual( phi, levels[0].m_f, levels[0].m_r, levels[0].m_c, dirichlet );
+      real_type const goal    = tolerance*tolerance*initial;
+
+      size_t cycles = 0;
+      if(initial > real_type(0))
+      {
+        while(cycles < max_cycles)
+        {
+          detail::multigrid_cycle<grid_type, real_type>( levels, phi, 0u, gamma, smoothing, coarse_sweeps, dirichlet );
+          ++cycles;
+          if( detail::multigrid_residual( phi, levels[0].m_f, levels[0].m_r, levels[0].m_c, dirichlet ) <= goal )
+            break;
+        }
+      }
+
+      if(!dirichlet)
+      {
+        for(size_t idx = 0; idx < phi.size(); ++idx)
+          mean -= P[idx];
+        mean /= phi.size();
+        for(size_t idx = 0; idx < phi.size(); ++idx)
+          P[idx] = static_cast<value_type>( P[idx] + mean );
+      }
+      return cycles;
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_MULTIGRID_POISSON_SOLVER_H
+#endif
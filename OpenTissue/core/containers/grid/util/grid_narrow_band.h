@@ -0,0 +1,324 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_NARROW_BAND_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_NARROW_BAND_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/util/grid_redistance.h>         // needed for detail::interface_distance
+#include <OpenTissue/core/containers/grid/util/grid_fast_marching.h>      // needed for detail::MarchingEntry
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    /**
+    * Narrow Band.
+    * Keeps track of the nodes of a dense level set grid that lie within a
+    * given distance of the zero level set. Level set evolutions only need
+    * to update these active nodes, so the cost of a time step is proportional
+    * to the area of the interface rather than to the volume of the grid.
+    *
+    * When the band is built the active nodes are redistanced by fast marching
+    * from the zero level set, and all nodes outside the band are clamped to
+    * plus or minus the band width. Thus the frozen nodes are consistent with
+    * the active nodes, and upwind differences at the edge of the band stay
+    * bounded.
+    *
+    * As the interface moves it eventually comes close to the edge of the band,
+    * which is tested by needs_rebuild(). The band is then rebuilt around the
+    * current zero level set by rebuild(), which only visits the nodes of the
+    * old and new band. Only init() visits every node of the grid.
+    *
+    * Example usage:
+    *
+    *   NarrowBand<grid_type> band;
+    *   band.init( phi, 3*phi.dx() );
+    *   for(...)
+    *   {
+    *     curvature_flow( phi, mu, dt, band );
+    *   }
+    */
+    template<typename grid_type>
+    class NarrowBand
+    {
+    public:
+
+      typedef typename grid_type::value_type     value_type;
+      typedef typename grid_type::math_types     math_types;
+      typedef typename math_types::real_type     real_type;
+      typedef std::vector<size_t>                index_container;
+
+    protected:
+
+      enum { in_band = 1, accepted = 2 };
+
+      real_type                   m_width;      ///< The band width.
+      index_container             m_active;     ///< Linear indices of the nodes in the band, in increasing order.
+      index_container             m_boundary;   ///< Nodes in the band that have a neighbor outside the band.
+      std::vector<unsigned char>  m_state;      ///< Per node flags.
+      int                         m_size[3];    ///< The grid dimensions.
+
+    public:
+
+      NarrowBand()
+        : m_width( real_type(0) )
+      {
+        m_size[0] = m_size[1] = m_size[2] = 0;
+      }
+
+    public:
+
+      real_type const & width() const { return m_width; }
+      index_container const & active() const { return m_active; }
+      size_t size() const { return m_active.size(); }
+      bool contains(size_t const & idx) const { return idx < m_state.size() && (m_state[idx] & in_band); }
+
+      /**
+      * Initialize Narrow Band.
+      * Redistances the nodes within the band width of the zero level set of
+      * phi, and clamps all other nodes to plus or minus the band width. This
+      * is the only operation that visits every node of the grid.
+      *
+      * @param phi     The level set. Upon return the nodes are changed as described above.
+      * @param width   The band width, should be a few times the grid spacing.
+      */
+      void init(grid_type & phi, real_type const & width)
+      {
+        assert(width > real_type(0) || !"NarrowBand::init(): band width must be positive");
+
+        m_width   = width;
+        m_size[0] = static_cast<int>( phi.I() );
+        m_size[1] = static_cast<int>( phi.J() );
+        m_size[2] = static_cast<int>( phi.K() );
+        m_state.assign( phi.size(), 0 );
+        m_active.clear();
+        m_boundary.clear();
+
+        index_container all( phi.size() );
+        for(size_t idx = 0; idx < all.size(); ++idx)
+          all[idx] = idx;
+        build( phi, all );
+      }
+
+      /**
+      * Rebuild Narrow Band.
+      * The band is rebuilt around the current zero level set, the nodes in
+      * the new band are redistanced and nodes that leave the band are clamped
+      * to plus or minus the band width. The signs of the nodes are unchanged.
+      *
+      * @param phi     The level set, must be the grid that the band was initialized with.
+      */
+      void rebuild(grid_type & phi)
+      {
+        assert(m_state.size() == phi.size() || !"NarrowBand::rebuild(): band was not initialized for this grid");
+
+        index_container old;
+        old.swap( m_active );
+        build( phi, old );
+      }
+
+      /**
+      * Test if Rebuild is Needed.
+      * The band must be rebuilt when the zero level set has moved more than
+      * half the band width towards the edge of the band. This is detected by
+      * looking at the nodes at the edge of the band only.
+      *
+      * @param phi     The level set.
+      *
+      * @return        If the band should be rebuilt then the return value is true otherwise it is false.
+      */
+      bool needs_rebuild(grid_type const & phi) const
+      {
+        using std::fabs;
+
+        real_type const limit = m_width / real_type(2);
+        value_type const * values = phi.data();
+        for(size_t n = 0; n < m_boundary.size(); ++n)
+          if(fabs( static_cast<real_type>( values[ m_boundary[n] ] ) ) < limit)
+            return true;
+        return false;
+      }
+
+    protected:
+
+      /**
+      * Build Band.
+      * Finds the interface nodes among the candidates and marches outwards
+      * from them until the band width is reached.
+      *
+      * @param phi          The level set.
+      * @param candidates   The nodes that may be next to the zero level set. All
+      *                     nodes that are not reached by the marching and that
+      *                     are in the old band are clamped.
+      */
+      void build(grid_type & phi, index_container const & candidates)
+      {
+        using std::fabs;
+
+        typedef detail::MarchingEntry<real_type>  entry_type;
+
+        int       const I          = m_size[0];
+        int       const J          = m_size[1];
+        int       const stride[3]  = { 1, I, I*J };
+        real_type const spacing[3] = { phi.dx(), phi.dy(), phi.dz() };
+
+        value_type const unused = phi.unused();
+        value_type     * values = phi.data();
+
+        //--- Estimate the distances of the interface nodes before any value is changed
+        int const count = static_cast<int>( candidates.size() );
+        std::vector<real_type> distance( count );
+        std::vector<char>      crossing( count, 0 );
+
+#pragma omp parallel for schedule(static) if(count > 4096)
+        for(int n = 0; n < count; ++n)
+        {
+          size_t const idx = candidates[n];
+          if(values[idx] == unused)
+            continue;
+          int index[3];
+          index_of( idx, index );
+          crossing[n] = detail::interface_distance( values, idx, index, m_size, stride, spacing, unused, distance[n] ) ? 1 : 0;
+        }
+
+        //--- The interface nodes are accepted as they are, and their neighbors are queued
+        std::vector<entry_type> heap;
+        index_container         band;
+        for(int n = 0; n < count; ++n)
+          m_state[ candidates[n] ] = 0;
+        for(int n = 0; n < count; ++n)
+        {
+          if(!crossing[n])
+            continue;
+          size_t const idx = candidates[n];
+          values[idx]   = static_cast<value_type>( distance[n] );
+          m_state[idx]  = accepted;
+          band.push_back( idx );
+        }
+        for(size_t n = 0; n < band.size(); ++n)
+          queue_neighbors( band[n], values, unused, spacing, stride, heap );
+
+        //--- March outwards, a node may be queued several times and the closest entry wins
+        while(!heap.empty())
+        {
+          std::pop_heap( heap.begin(), heap.end() );
+          entry_type const entry = heap.back();
+          heap.pop_back();
+
+          size_t const idx = entry.m_idx;
+          if(m_state[idx] & accepted)
+            continue;
+          if(entry.m_distance > m_width)
+            break;
+
+          values[idx]  = static_cast<value_type>( values[idx] < value_type(0) ? -entry.m_distance : entry.m_distance );
+          m_state[idx] = accepted;
+          band.push_back( idx );
+          queue_neighbors( idx, values, unused, spacing, stride, heap );
+        }
+
+        //--- Nodes of the old band that were not reached are frozen at the band width
+        value_type const outside = static_cast<value_type>( m_width );
+        for(int n = 0; n < count; ++n)
+        {
+          size_t const idx = candidates[n];
+          if( (m_state[idx] & accepted) || values[idx] == unused)
+            continue;
+          values[idx] = values[idx] < value_type(0) ? -outside : outside;
+        }
+
+        std::sort( band.begin(), band.end() );
+        for(size_t n = 0; n < band.size(); ++n)
+          m_state[ band[n] ] = in_band;
+        m_active.swap( band );
+
+        m_boundary.clear();
+        for(size_t n = 0; n < m_active.size(); ++n)
+        {
+          size_t const idx = m_active[n];
+          int index[3];
+          index_of( idx, index );
+          for(int m = 0; m < 3; ++m)
+          {
+            if( (index[m] > 0 && !(m_state[idx - stride[m]] & in_band)) || (index[m] < m_size[m] - 1 && !(m_state[idx + stride[m]] & in_band)) )
+            {
+              m_boundary.push_back( idx );
+              break;
+            }
+          }
+        }
+      }
+
+      void index_of(size_t const & idx, int index[3]) const
+      {
+        index[0] = static_cast<int>( idx % m_size[0] );
+        index[1] = static_cast<int>( (idx / m_size[0]) % m_size[1] );
+        index[2] = static_cast<int>( idx / (static_cast<size_t>(m_size[0])*m_size[1]) );
+      }
+
+      /**
+      * Queue Neighbors.
+      * Computes the tentative distances of the neighbors of a newly accepted
+      * node from their accepted neighbors, and pushes them onto the heap.
+      */
+      void queue_neighbors(
+        size_t const & idx
+        , value_type const * values
+        , value_type const unused
+        , real_type const spacing[3]
+        , int const stride[3]
+        , std::vector< detail::MarchingEntry<real_type> > & heap
+        ) const
+      {
+        using std::fabs;
+
+        int center[3];
+        index_of( idx, center );
+        for(int m = 0; m < 3; ++m)
+          for(int side = -1; side <= 1; side += 2)
+          {
+            if( (side < 0 && center[m] == 0) || (side > 0 && center[m] == m_size[m] - 1) )
+              continue;
+            size_t const nb = side < 0 ? idx - stride[m] : idx + stride[m];
+            if( (m_state[nb] & accepted) || values[nb] == unused)
+              continue;
+
+            int index[3];
+            index_of( nb, index );
+            real_type a[3];
+            real_type h[3] = { spacing[0], spacing[1], spacing[2] };
+            for(int e = 0; e < 3; ++e)
+            {
+              a[e] = math::detail::highest<real_type>();
+              if(index[e] > 0 && (m_state[nb - stride[e]] & accepted))
+                a[e] = fabs( static_cast<real_type>( values[nb - stride[e]] ) );
+              if(index[e] < m_size[e] - 1 && (m_state[nb + stride[e]] & accepted))
+                a[e] = std::min( a[e], static_cast<real_type>( fabs( static_cast<real_type>( values[nb + stride[e]] ) ) ) );
+            }
+
+            detail::MarchingEntry<real_type> entry;
+            entry.m_distance = detail::eikonal_update( a, h );
+            entry.m_idx      = nb;
+            heap.push_back( entry );
+            std::push_heap( heap.begin(), heap.end() );
+          }
+      }
+
+    };
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_NARROW_BAND_H
+#endif
@@ -41,6 +41,32 @@ namespace OpenTissue
       erosion(psi,radius,dt,psi);
     }
 
+    /**
+    * Opening of binary image.
+    * Erodes and then dilates the image by a ball, which removes the parts
+    * of the foreground that a ball of the given radius does not fit into.
+    * The cost is linear in the number of nodes for any radius.
+    *
+    * @param image    Input image, nonzero nodes are foreground.
+    * @param radius   Radius of spherical structural element, in world units.
+    * @param result   Upon return foreground nodes are one and background nodes are zero. May be the same grid as the image.
+    */
+    template<
+      typename grid_type_in
+      , typename real_type
+      , typename grid_type_out
+    >
+    inline void opening(
+    grid_type_in const & image
+    , real_type const & radius
+    , grid_type_out & result
+    )
+    {
+      grid_type_out tmp;
+      erosion(image,radius,tmp);
+      dilation(tmp,radius,result);
+    }
+
   } // namespace grid
 } // namespace OpenTissue
 
@@ -57,6 +57,10 @@ namespace OpenTissue
     * on any boundary. This means that values outside boundary are copied from
     * nearest boundary voxel => claming out-of-bound indices onto boundary.
     *
+    * Each iteration only smooths the error locally, so the number of
+    * iterations needed grows with the grid resolution. For large grids or
+    * accurate solutions use multigrid_poisson_solver() instead.
+    *
     * @param phi              Contains initial guess for solution, and upon
     *                         return contains the solution.
     * @param b                The right hand side of the poisson equation.
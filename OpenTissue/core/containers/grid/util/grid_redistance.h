@@ -13,7 +13,10 @@
 
 #include <OpenTissue/core/math/math_is_finite.h>
 #include <OpenTissue/core/math/math_vector3.h>
+#include <OpenTissue/core/math/math_constants.h>
 #include <OpenTissue/core/containers/grid/util/grid_compute_sign_function.h>
+#include <OpenTissue/core/containers/grid/util/grid_fast_marching.h>
+#include <OpenTissue/core/containers/grid/util/grid_fast_sweeping.h>
 
 namespace OpenTissue
 {
@@ -329,6 +332,144 @@ namespace OpenTissue
         }
       };
 
+      /**
+      * Interface Distance.
+      * Estimates the distance from a node to the zero level set by linear
+      * interpolation of the values along each axis. The distances d_m along
+      * the axes are combined as the distance to the plane through the
+      * crossings, 1/d^2 = sum_m 1/d_m^2.
+      *
+      * @param values     The node values.
+      * @param idx        The linear index of the node.
+      * @param index      The (i,j,k) index of the node.
+      * @param size       The number of nodes along each axis.
+      * @param stride     The linear index offsets along each axis.
+      * @param spacing    The grid spacing along each axis.
+      * @param unused     The value of nodes with no known value.
+      * @param distance   Upon return holds the signed distance of the node, if it is next to a sign change.
+      *
+      * @return           If the node is next to a sign change then the return value is true otherwise it is false.
+      */
+      template < typename value_type, typename real_type >
+      inline bool interface_distance(
+        value_type const * values
+        , size_t const idx
+        , int const index[3]
+        , int const size[3]
+        , int const stride[3]
+        , real_type const spacing[3]
+        , value_type const unused
+        , real_type & distance
+        )
+      {
+        using std::sqrt;
+
+        real_type const p        = static_cast<real_type>( values[idx] );
+        bool            crossing = p == real_type(0);
+        real_type       inv_d2   = real_type(0);
+        for(int m = 0; m < 3 && p != real_type(0); ++m)
+        {
+          real_type d = math::detail::highest<real_type>();
+          for(int side = -1; side <= 1; side += 2)
+          {
+            if( (side < 0 && index[m] == 0) || (side > 0 && index[m] == size[m] - 1) )
+              continue;
+            size_t const n = side < 0 ? idx - stride[m] : idx + stride[m];
+            if(values[n] == unused)
+              continue;
+            real_type const q = static_cast<real_type>( values[n] );
+            if( (p < real_type(0)) == (q < real_type(0)) )
+              continue;
+            real_type const theta = p / (p - q);
+            if(theta*spacing[m] < d)
+              d = theta*spacing[m];
+          }
+          if(d == math::detail::highest<real_type>())
+            continue;
+          crossing = true;
+          if(d <= real_type(0))
+          {
+            inv_d2 = math::detail::highest<real_type>();
+            break;
+          }
+          inv_d2 += real_type(1)/(d*d);
+        }
+        if(!crossing)
+          return false;
+        distance = (p == real_type(0) || inv_d2 == math::detail::highest<real_type>()) ? real_type(0) : real_type(1)/sqrt( inv_d2 );
+        if(p < real_type(0))
+          distance = -distance;
+        return true;
+      }
+
+      /**
+      * Initialize Interface Nodes.
+      * Nodes next to a sign change of phi get their distance to the zero
+      * level set estimated by interface_distance(). All other nodes are set
+      * to unused.
+      *
+      * @param phi    The level set.
+      * @param psi    Upon return holds the signed distances of the interface nodes.
+      *
+      * @return       The number of interface nodes.
+      */
+      template < typename grid_type >
+      inline size_t redistance_interface( grid_type const & phi, grid_type & psi )
+      {
+        typedef typename grid_type::value_type             value_type;
+        typedef typename grid_type::math_types             math_types;
+        typedef typename math_types::real_type             real_type;
+
+        int const I = static_cast<int>( phi.I() );
+        int const J = static_cast<int>( phi.J() );
+        int const K = static_cast<int>( phi.K() );
+
+        value_type const   unused = phi.unused();
+        value_type const * in     = phi.data();
+        value_type       * out    = psi.data();
+
+        int       const size[3]    = { I, J, K };
+        int       const stride[3]  = { 1, I, I*J };
+        real_type const spacing[3] = { phi.dx(), phi.dy(), phi.dz() };
+
+        int count = 0;
+#pragma omp parallel for schedule(static) reduction(+:count) if(K > 16)
+        for(int k = 0; k < K; ++k)
+          for(int j = 0; j < J; ++j)
+            for(int i = 0; i < I; ++i)
+            {
+              size_t const idx = (static_cast<size_t>(k)*J + j)*I + i;
+              out[idx] = unused;
+              if(in[idx] == unused)
+                continue;
+
+              int const index[3] = { i, j, k };
+              real_type distance = real_type(0);
+              if(!interface_distance( in, idx, index, size, stride, spacing, unused, distance ))
+                continue;
+              out[idx] = static_cast<value_type>( distance );
+              ++count;
+            }
+        return static_cast<size_t>( count );
+      }
+
+      /**
+      * Finish Redistancing.
+      * Nodes that were not reached get the sign of phi times the given distance.
+      */
+      template < typename grid_type, typename real_type >
+      inline void redistance_fill( grid_type const & phi, grid_type & psi, real_type const & distance )
+      {
+        typedef typename grid_type::value_type             value_type;
+
+        value_type const   unused = phi.unused();
+        value_type const * in     = phi.data();
+        value_type       * out    = psi.data();
+        for(size_t idx = 0; idx < phi.size(); ++idx)
+          if(out[idx] == unused && in[idx] != unused)
+            out[idx] = static_cast<value_type>( in[idx] < value_type(0) ? -distance : distance );
+      }
+
     }// namespace detail
 
     /**
@@ -344,6 +485,11 @@ namespace OpenTissue
     * Calculates gradient magnitude of phi using upwind-scheme.
     * Performs PDE update using forward Euler time discretization.
     *
+    * Every iteration is a pass over the full grid, and information only
+    * travels a few nodes per iteration. The overloads taking a
+    * FastMarchingRedistance or FastSweepingRedistance argument compute the
+    * whole signed distance field directly and are much faster.
+    *
     * @param phi              Input level set that should be redistanced into a signed distance grid.
     * @param psi              Output level set. That is the redistanced phi.
     * @param max_iterations   The maximum number of iterations allowed to do re-initialization.
@@ -361,6 +507,123 @@ namespace OpenTissue
       redistance_class(phi,psi,max_iterations,steady_threshold);
     }
 
+    /**
+    * Fast Marching Redistance Method.
+    * Selects the fast marching method in redistance(), see fast_marching().
+    */
+    class FastMarchingRedistance
+    {
+    public:
+
+      double m_band;    ///< Only nodes within this distance of the zero level set are computed.
+
+    public:
+
+      explicit FastMarchingRedistance( double band = math::detail::highest<double>() )
+        : m_band(band)
+      {}
+
+    };
+
+    /**
+    * Fast Sweeping Redistance Method.
+    * Selects the fast sweeping method in redistance(), see fast_sweeping().
+    */
+    class FastSweepingRedistance
+    {
+    public:
+
+      size_t m_max_iterations;    ///< The maximum number of rounds of eight sweeps.
+
+    public:
+
+      explicit FastSweepingRedistance( size_t max_iterations = 4 )
+        : m_max_iterations(max_iterations)
+      {}
+
+    };
+
+    /**
+    * Signed Distance Map Reinitialization by Fast Marching.
+    *
+    * Rather than integrating the reinitialization PDE, the distances of the
+    * nodes next to the zero level set are estimated directly from phi,
+    * see detail::redistance_interface(), and the Eikonal equation is solved
+    * from these by the fast marching method in O(N log N) time, where N is
+    * the number of nodes in the band. The zero level set does not move.
+    *
+    * Nodes farther away than the band width get plus or minus the band width.
+    *
+    * @param phi              Input level set that should be redistanced into a
+    *                         signed distance grid. Unused nodes have unknown sign.
+    * @param psi              Output level set. That is the redistanced phi, psi can be the same grid as phi.
+    * @param method           The fast marching settings.
+    */
+    template < typename grid_type >
+    inline void redistance(
+      grid_type const & phi
+      , grid_type & psi
+      , FastMarchingRedistance const & method
+      )
+    {
+      typedef typename grid_type::math_types::real_type  real_type;
+
+      //--- Make a copy of phi if the result overwrites it
+      grid_type copy;
+      if(&psi == &phi)
+        copy = phi;
+      else
+        psi = phi;
+      grid_type const & input = (&psi == &phi) ? copy : phi;
+
+      if(detail::redistance_interface( input, psi ) == 0)
+      {
+        psi = input;
+        return;
+      }
+      fast_marching( psi, static_cast<real_type>( method.m_band ) );
+      detail::redistance_fill( input, psi, static_cast<real_type>( method.m_band ) );
+    }
+
+    /**
+    * Signed Distance Map Reinitialization by Fast Sweeping.
+    *
+    * Just like the fast marching version, except that the Eikonal equation
+    * is solved by rounds of sweeps in the eight diagonal directions, where
+    * each sweep runs in parallel over blocks of nodes. Usually two rounds
+    * are enough, and the result is the same as that of fast marching.
+    *
+    * Nodes that can not be reached from the zero level set, because they are
+    * cut off by unused nodes, are left unused.
+    *
+    * @param phi              Input level set that should be redistanced into a
+    *                         signed distance grid. Unused nodes have unknown sign.
+    * @param psi              Output level set. That is the redistanced phi, psi can be the same grid as phi.
+    * @param method           The fast sweeping settings.
+    */
+    template < typename grid_type >
+    inline void redistance(
+      grid_type const & phi
+      , grid_type & psi
+      , FastSweepingRedistance const & method
+      )
+    {
+      //--- Make a copy of phi if the result overwrites it
+      grid_type copy;
+      if(&psi == &phi)
+        copy = phi;
+      else
+        psi = phi;
+      grid_type const & input = (&psi == &phi) ? copy : phi;
+
+      if(detail::redistance_interface( input, psi ) == 0)
+      {
+        psi = input;
+        return;
+      }
+      fast_sweeping( psi, method.m_max_iterations );
+    }
+
   } // namespace grid
 } // namespace OpenTissue
 
@@ -0,0 +1,442 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_SEPARABLE_FILTER_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_SEPARABLE_FILTER_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    /**
+    * Boundary Conditions of Line Filters.
+    * Tells how samples outside a line are obtained.
+    *
+    *   boundary_zero     Samples outside the line are zero.
+    *   boundary_clamp    Samples outside the line repeat the end values.
+    *   boundary_mirror   Samples are mirrored, -1,-2,... maps to 1,2,... and n,n+1,... maps to n-1,n-2,...
+    */
+    enum boundary_type { boundary_zero, boundary_clamp, boundary_mirror };
+
+    /**
+    * Convolution Line Filter.
+    * Convolves lines with a kernel of arbitrary taps,
+    *
+    *   out(t) = sum_a  w(a) in(t + a - origin)
+    *
+    * The taps are applied one at a time to all lines of a bundle, so the
+    * innermost loop runs over contiguous memory and is vectorized by the
+    * compiler.
+    */
+    template<typename real_type_>
+    class ConvolutionLineFilter
+    {
+    public:
+
+      typedef real_type_  real_type;
+
+    protected:
+
+      std::vector<real_type>  m_weights;    ///< The kernel taps.
+      int                     m_origin;     ///< The index of the tap that is applied to the output position.
+      boundary_type           m_boundary;   ///< The boundary condition.
+
+    public:
+
+      ConvolutionLineFilter()
+        : m_origin(0)
+        , m_boundary(boundary_clamp)
+      {}
+
+      /**
+      * Specialized Constructor.
+      *
+      * @param weights    The kernel taps.
+      * @param origin     The index of the tap that is applied to the output position.
+      * @param boundary   The boundary condition.
+      */
+      ConvolutionLineFilter(std::vector<real_type> const & weights, int const & origin, boundary_type const & boundary)
+        : m_weights(weights)
+        , m_origin(origin)
+        , m_boundary(boundary)
+      {
+        assert(!m_weights.empty() || !"ConvolutionLineFilter(): kernel was empty");
+        assert((origin >= 0 && origin < static_cast<int>( weights.size() )) || !"ConvolutionLineFilter(): origin was outside kernel");
+      }
+
+    public:
+
+      int left()  const { return m_origin; }
+      int right() const { return static_cast<int>( m_weights.size() ) - 1 - m_origin; }
+      boundary_type boundary() const { return m_boundary; }
+
+      /**
+      * Filter a Bundle of Lines.
+      *
+      * @param in       The padded input lines, sample t of line b is stored at in[(t + left())*lanes + b].
+      * @param out      Upon return holds the output lines, sample t of line b is stored at out[t*lanes + b].
+      * @param n        The number of samples in each line.
+      * @param lanes    The number of lines in the bundle.
+      */
+      void operator()(real_type const * in, real_type * out, int const & n, int const & lanes) const
+      {
+        int const count = n*lanes;
+        std::fill( out, out + count, real_type(0) );
+        for(size_t a = 0; a < m_weights.size(); ++a)
+        {
+          real_type const   w   = m_weights[a];
+          real_type const * src = in + a*lanes;
+          if(w == real_type(0))
+            continue;
+          for(int s = 0; s < count; ++s)
+            out[s] += w*src[s];
+        }
+      }
+
+    };
+
+    /**
+    * Box Line Filter.
+    * Sums a window of samples with a running sum, so the cost is independent
+    * of the window size. The window of output position t covers the samples
+    * t - left() to t + right(). All lines of a bundle are summed together, so
+    * the innermost loop runs over the lanes.
+    */
+    template<typename real_type_>
+    class BoxLineFilter
+    {
+    public:
+
+      typedef real_type_  real_type;
+
+    protected:
+
+      int        m_size;       ///< The number of samples in the window.
+      int        m_center;     ///< The offset of the output position from the end of the window.
+      real_type  m_scale;      ///< The sums are multiplied by this value.
+
+    public:
+
+      BoxLineFilter()
+        : m_size(1)
+        , m_center(0)
+        , m_scale(1)
+      {}
+
+      /**
+      * Specialized Constructor.
+      *
+      * @param size     The number of samples in the window.
+      * @param scale    The sums are multiplied by this value.
+      * @param center   The number of samples in the window after the output position,
+      *                 default is size/2. For even sizes the window is then shifted
+      *                 half a sample forward, and size/2 - 1 shifts it half a sample back.
+      */
+      BoxLineFilter(int const & size, real_type const & scale, int const & center = -1)
+        : m_size(size)
+        , m_center(center < 0 ? size/2 : center)
+        , m_scale(scale)
+      {
+        assert(size > 0         || !"BoxLineFilter(): window size must be positive");
+        assert(m_center < size  || !"BoxLineFilter(): center must be inside window");
+      }
+
+    public:
+
+      int left()  const { return m_size - 1 - m_center; }
+      int right() const { return m_center; }
+      boundary_type boundary() const { return boundary_zero; }
+
+      void operator()(real_type const * in, real_type * out, int const & n, int const & lanes) const
+      {
+        std::vector<real_type> sum( lanes, real_type(0) );
+        for(int a = 0; a < m_size - 1; ++a)
+          for(int b = 0; b < lanes; ++b)
+            sum[b] += in[a*lanes + b];
+        for(int t = 0; t < n; ++t)
+        {
+          real_type const * add = in + (t + m_size - 1)*lanes;
+          real_type const * sub = in + t*lanes;
+          real_type       * dst = out + t*lanes;
+          for(int b = 0; b < lanes; ++b)
+          {
+            sum[b] += add[b];
+            dst[b]  = m_scale*sum[b];
+            sum[b] -= sub[b];
+          }
+        }
+      }
+
+    };
+
+    namespace detail
+    {
+
+      /**
+      * Map a sample position outside a line to a position inside.
+      *
+      * @return    The position of the sample, or -1 if the sample is zero.
+      */
+      inline int boundary_index(int q, int const & n, boundary_type const & boundary)
+      {
+        if(q >= 0 && q < n)
+          return q;
+        switch(boundary)
+        {
+        case boundary_zero:
+          return -1;
+        case boundary_clamp:
+          return q < 0 ? 0 : n - 1;
+        default:
+          if(n == 1)
+            return 0;
+          while(q < 0 || q >= n)
+          {
+            if(q < 0)
+              q = -q;
+            if(q >= n)
+              q = 2*n - q - 1;
+          }
+          return q;
+        }
+      }
+
+      /**
+      * Filter all lines of a grid along one axis.
+      *
+      * @param input            The node values.
+      * @param output           The filtered node values. May be the same as input unless accumulate is true.
+      * @param size             The number of nodes along each axis.
+      * @param axis             The axis to filter along.
+      * @param filter           The line filter.
+      * @param ignore_unused    If true then nodes with the unused value act as zero and are left unchanged.
+      * @param unused           The unused value.
+      * @param accumulate       If true then the filtered values are added to the output.
+      */
+      template<typename value_type, typename line_filter>
+      inline void separable_pass(
+        value_type const * input
+        , value_type * output
+        , int const size[3]
+        , int const & axis
+        , line_filter const & filter
+        , bool const & ignore_unused
+        , value_type const & unused
+        , bool const & accumulate
+        )
+      {
+        typedef typename line_filter::real_type  real_type;
+
+        assert((axis >= 0 && axis < 3)          || !"separable_pass(): illegal axis");
+        assert(!accumulate || input != output   || !"separable_pass(): accumulation can not be done in place");
+
+        int const lanes_max = 16;   //--- 16 floats fill a cache line
+
+        int const stride[3] = { 1, size[0], size[0]*size[1] };
+        int const n         = size[axis];
+        int const left      = filter.left();
+        int const right     = filter.right();
+
+        //--- Lines along x are contiguous and filtered one at a time, lines
+        //--- along y or z are gathered in bundles of neighboring lines, so every
+        //--- read and write touches a run of contiguous nodes.
+        int const lanes     = (axis == 0) ? 1 : lanes_max;
+        int const other     = (axis == 2) ? 1 : 2;
+        int const blocks    = (axis == 0) ? size[1] : (size[0] + lanes - 1)/lanes;
+        int const tasks     = blocks*size[other];
+
+        if(n == 0 || tasks == 0)
+          return;
+
+        //--- Precompute where the padding samples come from
+        std::vector<int> source( n + left + right );
+        for(int t = 0; t < n + left + right; ++t)
+          source[t] = boundary_index( t - left, n, filter.boundary() );
+
+#pragma omp parallel if(tasks > 1 && static_cast<long>(n)*tasks*lanes > 32768)
+        {
+          std::vector<real_type> in( (n + left + right)*lanes );
+          std::vector<real_type> out( n*lanes );
+
+#pragma omp for schedule(dynamic,1)
+          for(int task = 0; task < tasks; ++task)
+          {
+            int const block = task % blocks;
+            int const outer = task / blocks;
+
+            //--- The first node of the bundle and the number of lines in it
+            size_t first = 0;
+            int    count = 1;
+            if(axis == 0)
+              first = static_cast<size_t>(outer)*stride[2] + static_cast<size_t>(block)*stride[1];
+            else
+            {
+              int const i0 = block*lanes;
+              count = std::min( lanes, size[0] - i0 );
+              first = static_cast<size_t>(outer)*stride[other] + i0;
+            }
+
+            //--- Gather the bundle, line b sample t goes to in[(t + left)*lanes + b]
+            for(int t = 0; t < n + left + right; ++t)
+            {
+              real_type * dst = &in[t*lanes];
+              int const q = source[t];
+              if(q < 0)
+              {
+                std::fill( dst, dst + lanes, real_type(0) );
+                continue;
+              }
+              value_type const * src = input + first + static_cast<size_t>(q)*stride[axis];
+              for(int b = 0; b < count; ++b)
+                dst[b] = (ignore_unused && src[b] == unused) ? real_type(0) : static_cast<real_type>( src[b] );
+              for(int b = count; b < lanes; ++b)
+                dst[b] = real_type(0);
+            }
+
+            filter( &in[0], &out[0], n, lanes );
+
+            //--- Scatter the bundle back
+            for(int t = 0; t < n; ++t)
+            {
+              size_t const offset = first + static_cast<size_t>(t)*stride[axis];
+              real_type const * src = &out[t*lanes];
+              for(int b = 0; b < count; ++b)
+              {
+                if(ignore_unused && input[offset + b] == unused)
+                  continue;
+                if(accumulate)
+                  output[offset + b] = static_cast<value_type>( output[offset + b] + src[b] );
+                else
+                  output[offset + b] = static_cast<value_type>( src[b] );
+              }
+            }
+          }
+        }
+      }
+
+    } // namespace detail
+
+    /**
+    * Separable Filter Pass.
+    * Filters all lines of a grid along one axis with a line filter, such as
+    * ConvolutionLineFilter or BoxLineFilter.
+    *
+    * The lines are processed in bundles of up to 16 neighboring lines. Lines
+    * along the strided y and z axes are gathered into a contiguous scratch
+    * buffer, where the samples of the lines are interleaved, so the grid is
+    * only read and written in runs of contiguous nodes and the line filters
+    * work on contiguous memory. The bundles are distributed over threads.
+    *
+    * Each bundle is read completely before it is written, so the input and
+    * the output may be the same grid.
+    *
+    * @param input        The input node values.
+    * @param output       The output node values, may be the same as the input.
+    * @param size         The number of nodes along each axis, with the first axis varying fastest.
+    * @param axis         The axis to filter along.
+    * @param filter       The line filter.
+    */
+    template<typename value_type, typename line_filter>
+    inline void separable_pass(
+      value_type const * input
+      , value_type * output
+      , int const size[3]
+      , int const & axis
+      , line_filter const & filter
+      )
+    {
+      detail::separable_pass( input, output, size, axis, filter, false, value_type(), false );
+    }
+
+    /**
+    * Separable Filter Pass Ignoring Unused Nodes.
+    * Same as separable_pass(), except that nodes with the unused value act
+    * as zero in the filter and are left unchanged in the output.
+    *
+    * @param input        The input node values.
+    * @param output       The output node values, may be the same as the input.
+    * @param size         The number of nodes along each axis, with the first axis varying fastest.
+    * @param axis         The axis to filter along.
+    * @param filter       The line filter.
+    * @param unused       The value of unused nodes.
+    */
+    template<typename value_type, typename line_filter>
+    inline void separable_pass(
+      value_type const * input
+      , value_type * output
+      , int const size[3]
+      , int const & axis
+      , line_filter const & filter
+      , value_type const & unused
+      )
+    {
+      detail::separable_pass( input, output, size, axis, filter, true, unused, false );
+    }
+
+    /**
+    * Accumulating Filter Pass.
+    * Same as separable_pass(), except that the filtered values are added to
+    * the output. This is used for operators that are a sum of one dimensional
+    * operators, such as the Laplacian. The input and output must be different.
+    *
+    * @param input        The input node values.
+    * @param output       The output node values, the filtered values are added to these.
+    * @param size         The number of nodes along each axis, with the first axis varying fastest.
+    * @param axis         The axis to filter along.
+    * @param filter       The line filter.
+    */
+    template<typename value_type, typename line_filter>
+    inline void separable_accumulate(
+      value_type const * input
+      , value_type * output
+      , int const size[3]
+      , int const & axis
+      , line_filter const & filter
+      )
+    {
+      detail::separable_pass( input, output, size, axis, filter, false, value_type(), true );
+    }
+
+    /**
+    * Separable Filter.
+    * Applies a line filter along each axis of a grid in turn, the result is
+    * the product of the three one dimensional filters.
+    *
+    * @param src      The input grid.
+    * @param dst      Upon return holds the filtered grid, may be the same as src.
+    * @param fx       The line filter along the x axis.
+    * @param fy       The line filter along the y axis.
+    * @param fz       The line filter along the z axis.
+    */
+    template<typename grid_type, typename line_filter>
+    inline void separable_filter(
+      grid_type const & src
+      , grid_type & dst
+      , line_filter const & fx
+      , line_filter const & fy
+      , line_filter const & fz
+      )
+    {
+      if(&dst != &src)
+        dst = src;
+      int const size[3] = { static_cast<int>( dst.I() ), static_cast<int>( dst.J() ), static_cast<int>( dst.K() ) };
+      separable_pass( dst.data(), dst.data(), size, 2, fz );
+      separable_pass( dst.data(), dst.data(), size, 1, fy );
+      separable_pass( dst.data(), dst.data(), size, 0, fx );
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_SEPARABLE_FILTER_H
+#endif
@@ -0,0 +1,359 @@
+#ifndef OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_SPARSE_NARROW_BAND_H
+#define OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_SPARSE_NARROW_BAND_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/containers/grid/grid_sparse.h>
+#include <OpenTissue/core/geometry/t4_cpu_scan/t4_cpu_scan.h>
+#include <OpenTissue/core/containers/mesh/common/util/mesh_compute_mesh_minimum_coord.h>
+#include <OpenTissue/core/containers/mesh/common/util/mesh_compute_mesh_maximum_coord.h>
+
+#include <boost/cast.hpp>
+
+#include <vector>
+#include <stdexcept>
+#include <cmath>
+
+namespace OpenTissue
+{
+  namespace grid
+  {
+
+    namespace detail
+    {
+
+      /**
+      * Get Neighbor Tile.
+      *
+      * @param phi     A sparse grid.
+      * @param tile    A tile index.
+      * @param n       The neighbor direction, 0 to 5 for -x, +x, -y, +y, -z and +z.
+      * @param nb      Upon return holds the tile index of the neighbor.
+      *
+      * @return        If the neighbor exists then the return value is true otherwise it is false.
+      */
+      template<typename grid_type>
+      inline bool neighbor_tile(grid_type const & phi, size_t const & tile, int const & n, size_t & nb)
+      {
+        size_t const TI = phi.tile_I();
+        size_t const TJ = phi.tile_J();
+        size_t const TK = phi.tile_K();
+        size_t const ti = tile % TI;
+        size_t const tj = (tile / TI) % TJ;
+        size_t const tk = tile / (TI*TJ);
+        switch(n)
+        {
+        case 0: if(ti == 0)      return false; nb = tile - 1;     return true;
+        case 1: if(ti + 1 == TI) return false; nb = tile + 1;     return true;
+        case 2: if(tj == 0)      return false; nb = tile - TI;    return true;
+        case 3: if(tj + 1 == TJ) return false; nb = tile + TI;    return true;
+        case 4: if(tk == 0)      return false; nb = tile - TI*TJ; return true;
+        case 5: if(tk + 1 == TK) return false; nb = tile + TI*TJ; return true;
+        }
+        return false;
+      }
+
+    } // namespace detail
+
+    /**
+    * Signed Flood Fill.
+    * Closes a narrow band signed distance field, such as the one produced by
+    * scan converting a closed surface into a sparse grid.
+    *
+    * Unused nodes in active tiles are given the sign of the nearest used node
+    * in the same tile, inactive tiles are given the sign of the adjacent
+    * active tiles and the remaining inactive tiles get the sign of the
+    * inactive tiles they are connected to. Magnitudes are clamped to the
+    * background value, and tiles that end up with all nodes at plus or minus
+    * the background value are made inactive.
+    *
+    * The signs are only correct if the used nodes form a band that is wider
+    * than the grid spacing and that separates the inside from the outside.
+    *
+    * @param phi          A sparse signed distance field.
+    * @param background   The magnitude of the value of nodes outside the narrow band, typically the band width.
+    */
+    template<typename T, typename M>
+    inline void signed_flood_fill(SparseGrid<T,M> & phi, T const & background)
+    {
+      typedef SparseGrid<T,M>  grid_type;
+
+      int const S    = grid_type::brick_size;
+      int const V    = grid_type::brick_volume;
+      int const log2 = grid_type::brick_log2;
+      int const mask = grid_type::brick_mask;
+
+      T const unused = phi.unused();
+      int const tiles = boost::numeric_cast<int>( phi.tile_count() );
+
+      //--- Propagate signs from the used nodes to the unused nodes of each active tile,
+      //--- tiles that have no used nodes at all are marked for deactivation
+      std::vector<char> empty( tiles, 0 );
+
+#pragma omp parallel for schedule(dynamic,16) if(tiles > 64)
+      for(int t = 0; t < tiles; ++t)
+      {
+        T * values = phi.brick( t );
+        if(!values)
+          continue;
+
+        std::vector<int> queue( V );
+        int head = 0;
+        int tail = 0;
+        for(int n = 0; n < V; ++n)
+        {
+          if(values[n] == unused)
+            continue;
+          if(values[n] > background)
+            values[n] = background;
+          else if(values[n] < -background)
+            values[n] = -background;
+          queue[tail++] = n;
+        }
+        if(tail == 0)
+        {
+          empty[t] = 1;
+          continue;
+        }
+        while(head < tail)
+        {
+          int const n = queue[head++];
+          int const i = n & mask;
+          int const j = (n >> log2) & mask;
+          int const k = n >> (2*log2);
+          T const value = values[n] < T(0) ? -background : background;
+
+          int neighbors[6];
+          int count = 0;
+          if(i > 0)     neighbors[count++] = n - 1;
+          if(i < S - 1) neighbors[count++] = n + 1;
+          if(j > 0)     neighbors[count++] = n - S;
+          if(j < S - 1) neighbors[count++] = n + S;
+          if(k > 0)     neighbors[count++] = n - S*S;
+          if(k < S - 1) neighbors[count++] = n + S*S;
+          for(int m = 0; m < count; ++m)
+          {
+            if(values[ neighbors[m] ] != unused)
+              continue;
+            values[ neighbors[m] ] = value;
+            queue[tail++] = neighbors[m];
+          }
+        }
+      }
+      for(int t = 0; t < tiles; ++t)
+        if(empty[t])
+          phi.deactivate( t, unused );
+
+      //--- Seed the inactive tiles from the face of an adjacent active tile,
+      //--- the node at the center of the face is one grid spacing away from
+      //--- the inactive tile, so it has the same sign
+      std::vector<size_t> queue;
+      queue.reserve( tiles );
+      for(int t = 0; t < tiles; ++t)
+      {
+        if(phi.is_active( t ))
+          continue;
+        if(phi.tile_value( t ) != unused)
+        {
+          queue.push_back( t );
+          continue;
+        }
+        for(int n = 0; n < 6; ++n)
+        {
+          size_t nb = 0;
+          if(!detail::neighbor_tile( phi, t, n, nb ) || !phi.is_active( nb ))
+            continue;
+          int const axis = n / 2;
+          int const side = (n % 2 == 0) ? S - 1 : 0;
+          int idx[3] = { S/2, S/2, S/2 };
+          idx[axis]  = side;
+          T const value = phi.brick( nb )[ grid_type::brick_offset( idx[0], idx[1], idx[2] ) ];
+          phi.tile_value( t ) = value < T(0) ? -background : background;
+          queue.push_back( t );
+          break;
+        }
+      }
+
+      //--- Grow the signs through the connected inactive tiles
+      for(size_t head = 0; head < queue.size(); ++head)
+      {
+        size_t const t = queue[head];
+        for(int n = 0; n < 6; ++n)
+        {
+          size_t nb = 0;
+          if(!detail::neighbor_tile( phi, t, n, nb ) || phi.is_active( nb ) || phi.tile_value( nb ) != unused)
+            continue;
+          phi.tile_value( nb ) = phi.tile_value( t );
+          queue.push_back( nb );
+        }
+      }
+
+      //--- Tiles not connected to anything are outside, and constant active tiles are pruned
+      std::vector<char> constant( tiles, 0 );
+
+#pragma omp parallel for schedule(dynamic,16) if(tiles > 64)
+      for(int t = 0; t < tiles; ++t)
+      {
+        T const * values = phi.brick( t );
+        if(!values)
+          continue;
+        T const value = values[0];
+        if(value != background && value != -background)
+          continue;
+        int n = 1;
+        while(n < V && values[n] == value)
+          ++n;
+        constant[t] = (n == V) ? 1 : 0;
+      }
+      for(int t = 0; t < tiles; ++t)
+      {
+        if(constant[t])
+          phi.deactivate( t, phi.brick( t )[0] );
+        else if(!phi.is_active( t ) && phi.tile_value( t ) == unused)
+          phi.tile_value( t ) = background;
+      }
+      phi.compact();
+    }
+
+    /**
+    * Dense to Sparse Conversion.
+    * Only tiles containing a node with an absolute value less than the band
+    * width are kept active, all other tiles become inactive with plus or minus
+    * the band width, depending on the sign of the nodes in the tile.
+    *
+    * @param dense    A dense signed distance field.
+    * @param band     The band width.
+    * @param sparse   Upon return holds the narrow band of the signed distance field.
+    */
+    template<typename dense_grid_type, typename T, typename M>
+    inline void dense2sparse(dense_grid_type const & dense, T const & band, SparseGrid<T,M> & sparse)
+    {
+      using std::fabs;
+
+      typedef SparseGrid<T,M>  grid_type;
+
+      int const S = grid_type::brick_size;
+
+      sparse.create( dense.min_coord(), dense.max_coord(), dense.I(), dense.J(), dense.K() );
+
+      size_t const I = dense.I();
+      size_t const J = dense.J();
+      size_t const K = dense.K();
+
+      int const tiles = boost::numeric_cast<int>( sparse.tile_count() );
+      std::vector<char> active( tiles, 0 );
+      std::vector<T>    value( tiles, band );
+
+#pragma omp parallel for schedule(dynamic,16) if(tiles > 64)
+      for(int t = 0; t < tiles; ++t)
+      {
+        size_t const i0 = (t % sparse.tile_I())*S;
+        size_t const j0 = ((t / sparse.tile_I()) % sparse.tile_J())*S;
+        size_t const k0 = (t / (sparse.tile_I()*sparse.tile_J()))*S;
+        bool inside = false;
+        for(size_t k = k0; k < k0 + S && k < K; ++k)
+          for(size_t j = j0; j < j0 + S && j < J; ++j)
+            for(size_t i = i0; i < i0 + S && i < I; ++i)
+            {
+              T const phi = static_cast<T>( dense(i,j,k) );
+              if(phi == dense.unused())
+                continue;
+              if(fabs(phi) < band)
+                active[t] = 1;
+              if(phi < T(0))
+                inside = true;
+            }
+        value[t] = inside ? -band : band;
+      }
+
+      size_t count = 0;
+      for(int t = 0; t < tiles; ++t)
+        count += active[t];
+      sparse.reserve( count );
+
+      for(int t = 0; t < tiles; ++t)
+      {
+        sparse.tile_value( t ) = value[t];
+        if(!active[t])
+          continue;
+        T * values = sparse.activate( t );
+        size_t const i0 = (t % sparse.tile_I())*S;
+        size_t const j0 = ((t / sparse.tile_I()) % sparse.tile_J())*S;
+        size_t const k0 = (t / (sparse.tile_I()*sparse.tile_J()))*S;
+        for(size_t k = k0; k < k0 + S && k < K; ++k)
+          for(size_t j = j0; j < j0 + S && j < J; ++j)
+            for(size_t i = i0; i < i0 + S && i < I; ++i)
+              values[ grid_type::brick_offset(i,j,k) ] = static_cast<T>( dense(i,j,k) );
+      }
+    }
+
+    /**
+    * Mesh to Narrow Band Signed Distance Field Conversion.
+    * The signed distance field is scan converted directly into the sparse
+    * grid, thus the memory usage is proportional to the surface area of the
+    * mesh rather than to the cube of the resolution.
+    *
+    * The grid spacing is the same along all axes, the resolution is the
+    * number of nodes along the longest side of the bounding box of the mesh
+    * and the narrow band. Penetrations deeper than the band width can not be
+    * resolved from the resulting signed distance field.
+    *
+    * @param mesh         A closed triangular surface mesh.
+    * @param phi          Upon return this argument contains the narrow band signed distance field of the specified mesh.
+    * @param bandsize     The width of the narrow band, should be a few times the grid spacing.
+    * @param resolution   The wanted resolution of the signed distance field.
+    */
+    template<typename mesh_type, typename T, typename M>
+    inline void mesh2phi_narrow_band(mesh_type & mesh, SparseGrid<T,M> & phi, double bandsize, size_t resolution)
+    {
+      using std::max;
+      using std::ceil;
+
+      typedef typename mesh_type::math_types                        math_types;
+      typedef typename math_types::value_traits                     value_traits;
+      typedef typename math_types::vector3_type                     vector3_type;
+      typedef typename math_types::real_type                        real_type;
+
+      real_type const band = boost::numeric_cast<real_type>(bandsize);
+      if(band<=value_traits::zero())
+        throw std::invalid_argument("mesh2phi_narrow_band() bandsize must be positive");
+      if(resolution<2)
+        throw std::invalid_argument("mesh2phi_narrow_band() resolution must be at least two");
+
+      vector3_type min_coord;
+      vector3_type max_coord;
+      mesh::compute_mesh_minimum_coord(mesh,min_coord);
+      mesh::compute_mesh_maximum_coord(mesh,max_coord);
+
+      //--- The band must fit inside the grid with room for the
+      //--- one sided differences at the grid boundary
+      vector3_type const extent = max_coord - min_coord;
+      real_type const longest = max( extent(0), max( extent(1), extent(2) ) ) + value_traits::two()*band;
+      real_type const delta = longest / (resolution - 1);
+      vector3_type const safety_band( band + value_traits::two()*delta, band + value_traits::two()*delta, band + value_traits::two()*delta);
+      min_coord -= safety_band;
+      max_coord += safety_band;
+
+      size_t const I = boost::numeric_cast<size_t>( ceil( (max_coord(0) - min_coord(0))/delta ) ) + 1;
+      size_t const J = boost::numeric_cast<size_t>( ceil( (max_coord(1) - min_coord(1))/delta ) ) + 1;
+      size_t const K = boost::numeric_cast<size_t>( ceil( (max_coord(2) - min_coord(2))/delta ) ) + 1;
+      max_coord = min_coord + vector3_type( (I-1)*delta, (J-1)*delta, (K-1)*delta );
+
+      phi.create( min_coord, max_coord, I, J, K );
+
+      t4_cpu_scan( mesh, band, phi, t4_cpu_signed() );
+
+      signed_flood_fill( phi, boost::numeric_cast<T>( band ) );
+    }
+
+  } // namespace grid
+} // namespace OpenTissue
+
+// OPENTISSUE_CORE_CONTAINERS_GRID_UTIL_GRID_SPARSE_NARROW_BAND_H
+#endif
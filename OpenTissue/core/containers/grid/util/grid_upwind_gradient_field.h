@@ -9,7 +9,9 @@
 //
 #include <OpenTissue/configuration.h>
 
-#include <cmath>
+#include <OpenTissue/core/containers/grid/util/grid_derivative_fields.h>
+
+#include <cassert>
 
 namespace OpenTissue
 {
@@ -18,6 +20,14 @@ namespace OpenTissue
 
     /**
     * Picks upwind direction of gradient according to the speed function (F).
+    * The field is computed in a single sweep over the x-rows of the grid,
+    * with the same differences as upwind_gradient(), see gradient_field().
+    *
+    * @param phi      The input grid.
+    * @param F        The speed function, must have the same dimensions as phi.
+    * @param Nx       Upon return holds the x-components of the upwind gradients.
+    * @param Ny       Upon return holds the y-components of the upwind gradients.
+    * @param Nz       Upon return holds the z-components of the upwind gradients.
     */
     template < typename grid_type >
     inline void upwind_gradient_field(
@@ -28,84 +38,12 @@ namespace OpenTissue
       , grid_type & Nz
       )
     {
-      using std::min;
-
-      typedef OpenTissue::math::Vector3< typename grid_type::value_type>  vector3_type;
-
-      typedef typename grid_type::value_type            value_type;
-      typedef typename grid_type::iterator              iterator;
-      typedef typename grid_type::const_iterator        const_iterator;
-      typedef typename grid_type::const_index_iterator  const_index_iterator;
-      typedef typename grid_type::math_types            math_types;
-      typedef typename math_types::real_type            real_type;
-
-      size_t I = phi.I();
-      size_t J = phi.J();
-      size_t K = phi.K();
-      real_type inv_dx = 1.0/phi.dx();
-      real_type inv_dy = 1.0/phi.dy();
-      real_type inv_dz = 1.0/phi.dz();
-
-      real_type inv_2dx = 0.5/phi.dx();
-      real_type inv_2dy = 0.5/phi.dy();
-      real_type inv_2dz = 0.5/phi.dz();
-
-      iterator              nx      = Nx.begin();
-      iterator              ny      = Ny.begin();
-      iterator              nz      = Nz.begin();
-      const_iterator        f       = F.begin();
-      const_index_iterator  pbegin  = phi.begin();
-      const_index_iterator  pend    = phi.end();
-      const_index_iterator  p       = pbegin;
-
-      for(;p!=pend; ++f,++p,++nx,++ny,++nz)
-      {
-        size_t i = p.i();
-        size_t j = p.j();
-        size_t k = p.k();
+      assert(F.size() == phi.size() || !"upwind_gradient_field(): speed function must have the same dimensions as phi");
 
-        size_t im1   = ( i ) ?  i - 1 : 0;
-        size_t jm1   = ( j ) ?  j - 1 : 0;
-        size_t km1   = ( k ) ?  k - 1 : 0;
-        size_t ip1   = min( i + 1u, I - 1u );
-        size_t jp1   = min( j + 1u, J - 1u );
-        size_t kp1   = min( k + 1u, K - 1u );
-        size_t i000  = ( k   * J + j )   * I + i;
-        size_t im00  = ( k   * J + j )   * I + im1;
-        size_t ip00  = ( k   * J + j )   * I + ip1;
-        size_t i0m0  = ( k   * J + jm1 ) * I + i;
-        size_t i0p0  = ( k   * J + jp1 ) * I + i;
-        size_t i00m  = ( km1 * J + j )   * I + i;
-        size_t i00p  = ( kp1 * J + j )   * I + i;
-        real_type  v000  = phi(i000);
-        real_type  vp00  = phi(ip00);
-        real_type  vm00  = phi(im00);
-        real_type  v0p0  = phi(i0p0);
-        real_type  v0m0  = phi(i0m0);
-        real_type  v00p  = phi(i00p);
-        real_type  v00m  = phi(i00m);
-        // phi^t+1  =   phi_t + dt*F
-        //  F > 0 use forward diffs
-        //  F < 0 use backward diffs
-        if((*f)>0)
-        {
-          *nx = (vp00 - v000 ) * inv_dx;
-          *ny = (v0p0 - v000 ) * inv_dy;
-          *nz = (v00p - v000 ) * inv_dz;
-        }
-        else if((*f)<0)
-        {
-          *nx = (v000 - vm00) * inv_dx;
-          *ny = (v000 - v0m0) * inv_dy;
-          *nz = (v000 - v00m) * inv_dz;
-        }
-        else
-        {
-          *nx = (vp00 - vm00) * inv_2dx;
-          *ny = (v0p0 - v0m0) * inv_2dy;
-          *nz = (v00p - v00m) * inv_2dz;
-        }
-      }
+      detail::match_grid( phi, Nx );
+      detail::match_grid( phi, Ny );
+      detail::match_grid( phi, Nz );
+      detail::sweep_rows( phi, detail::UpwindGradientKernel<grid_type>( phi, F, Nx.data(), Ny.data(), Nz.data() ) );
     }
 
   } // namespace grid
@@ -273,6 +273,8 @@ namespace OpenTissue
 
     /**
     * Voxelizer.
+    * Scan converts the mesh on the GPU, see voxelize_solid() in
+    * grid_cpu_voxelizer.h for a multithreaded version that needs no OpenGL context.
     *
     * @param mesh   The mesh that should be converted into a voxel grid.
     * @param phi    Upon return this grid holds the voxels (1: voxel, 0: no voxel).
@@ -14,6 +14,10 @@
 #include <OpenTissue/core/containers/mesh/common/util/mesh_compute_mesh_maximum_coord.h>
 #include <OpenTissue/core/containers/mesh/common/util/mesh_deformation_modifiers.h>
 
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <cassert>
 #include <cmath>
 
@@ -29,136 +33,107 @@ namespace OpenTissue
       /**
       * Iso Surface Generator Class.
       *
+      * A marching cubes implementation that splits the grid into slabs of
+      * cell layers along the z-axis. The slabs are triangulated in parallel,
+      * each slab emits its triangles as triples of edge keys, where the key
+      * of a grid edge is three times the linear index of its lower end-point
+      * plus the axis of the edge. Since all slabs compute the key of a shared
+      * edge in the same way, the vertices are welded by sorting the keys
+      * rather than through a per-node lookup table, and only the edges on
+      * the boundary planes between slabs need to be merged. The vertices are
+      * stored in increasing key order, so the output does not depend on the
+      * slab size or the number of threads.
       *
-      * Optimizations:
-      *   1) change for-loops to use iterators
-      *   2) avoid calling edge_table and triangle_table functions (use array lookup)
-      *   3) unroll the calculate_intersection function
-      *   4) minimize number of argumts passed to get_edge_id
+      * Instead of visiting every cell of the grid, the generator can be given
+      * a set of nodes, e.g. the active nodes of a narrow band, in which case
+      * only the cells incident to a crossing edge of these nodes are visited.
       */
       class IsoSurfaceGenerator
       {
       protected:
 
-        typedef int identifier_type;
+        typedef int                  identifier_type;
+        typedef std::vector<size_t>  key_container;
+
+      protected:
+
+        size_t m_slab_size;   ///< The number of cell layers in a slab.
+
+      public:
+
+        IsoSurfaceGenerator(size_t const & slab_size = 8u)
+          : m_slab_size( slab_size > 0u ? slab_size : 1u )
+        {}
 
       protected:
 
         /**
+        * Get Edge Key.
         *
-        * @param i
-        * @param j
-        * @param k
+        * @param idx            The linear index of the lower corner of a cell.
+        * @param edge_number    The cell edge number, as used by the triangle table.
         * @param I
         * @param J
         *
-        * @return
+        * @return               The key of the edge, three times the linear index of the
+        *                       lower end-point of the edge plus the axis of the edge.
         */
-        identifier_type compute_vertex_id(size_t i, size_t j, size_t k,size_t I, size_t J)
+        static size_t edge_key(size_t const & idx, identifier_type const & edge_number, size_t const & I, size_t const & J)
         {
-          return 3*(k*J*I + j*I + i);
+          //--- offset of lower end-point (i,j,k) and the axis of the edge
+          static identifier_type const table[12][4] = {
+            {0, 0, 0, 1}, {0, 1, 0, 0}, {1, 0, 0, 1}, {0, 0, 0, 0},
+            {0, 0, 1, 1}, {0, 1, 1, 0}, {1, 0, 1, 1}, {0, 0, 1, 0},
+            {0, 0, 0, 2}, {0, 1, 0, 2}, {1, 1, 0, 2}, {1, 0, 0, 2}
+          };
+          identifier_type const * e = table[edge_number];
+          return 3u*( idx + e[0] + e[1]*I + e[2]*I*J ) + e[3];
         }
 
         /**
+        * March Cell.
+        * Appends the edge keys of the triangles in the cell to a container.
+        * Cells with an unknown corner value are skipped.
         *
-        * @param i
-        * @param j
-        * @param k
-        * @param edge_number
+        * @param values     The grid values.
+        * @param idx        The linear index of the lower corner of the cell.
         * @param I
         * @param J
-        *
-        * @return
+        * @param isolevel
+        * @param unknown    The value of unused grid nodes.
+        * @param keys       Upon return the triangles of the cell have been appended.
         */
-        identifier_type get_edge_id(size_t i, size_t j, size_t k, identifier_type edge_number,size_t I,size_t J)
+        template<typename value_type>
+        static void march_cell(
+          value_type const * values
+          , size_t const & idx
+          , size_t const & I
+          , size_t const & J
+          , value_type const & isolevel
+          , value_type const & unknown
+          , key_container & keys
+          )
         {
-          //switch (edge_number)
-          //{
-          //  case 0:        return compute_vertex_id(    i,     j,     k, I, J) + 1;
-          //  case 1:        return compute_vertex_id(    i, j + 1,     k, I, J);
-          //  case 2:        return compute_vertex_id(i + 1,     j,     k, I, J) + 1;
-          //  case 3:        return compute_vertex_id(    i,     j,     k, I, J);
-          //  case 4:        return compute_vertex_id(    i,     j, k + 1, I, J) + 1;
-          //  case 5:        return compute_vertex_id(    i, j + 1, k + 1, I, J);
-          //  case 6:        return compute_vertex_id(i + 1,     j, k + 1, I, J) + 1;
-          //  case 7:        return compute_vertex_id(    i,     j, k + 1, I, J);
-          //  case 8:        return compute_vertex_id(    i,     j,     k, I, J) + 2;
-          //  case 9:        return compute_vertex_id(    i, j + 1,     k, I, J) + 2;
-          //  case 10:       return compute_vertex_id(i + 1, j + 1,     k, I, J) + 2;
-          //  case 11:       return compute_vertex_id(i + 1,     j,     k, I, J) + 2;
-          //  default:       return -1;// Invalid edge no.
-          //}
-          switch (edge_number)
-          {
-          case 0:        return 3*(    k*J*I +     j*I + i  ) + 1;
-          case 1:        return 3*(    k*J*I + (j+1)*I + i  );
-          case 2:        return 3*(    k*J*I +     j*I + i+1) + 1;
-          case 3:        return 3*(    k*J*I +     j*I + i  );
-          case 4:        return 3*((k+1)*J*I +     j*I + i  ) + 1;
-          case 5:        return 3*((k+1)*J*I + (j+1)*I + i  );
-          case 6:        return 3*((k+1)*J*I +     j*I + i+1) + 1;
-          case 7:        return 3*((k+1)*J*I +     j*I + i  );
-          case 8:        return 3*(    k*J*I +     j*I + i  ) + 2;
-          case 9:        return 3*(    k*J*I + (j+1)*I + i  ) + 2;
-          case 10:       return 3*(    k*J*I + (j+1)*I + i+1) + 2;
-          case 11:       return 3*(    k*J*I +     j*I + i+1) + 2;
-          default:       return -1;// Invalid edge no.
-          }
-        }
-
-        /**
-        *
-        * @param phi
-        * @param isovalue
-        * @param i
-        * @param j
-        * @param k
-        *
-        * @return
-        */
-        template<
-          typename grid_type
-          , typename size_t
-        >
-        typename grid_type::math_types::vector3_type
-        calculate_intersection(
-        grid_type const & phi
-        , typename grid_type::value_type const & isovalue
-        , size_t  i
-        , size_t  j
-        , size_t  k
-        , identifier_type edge_number
-        )
-        {
-          typedef typename grid_type::value_type       value_type;
-          typedef typename grid_type::math_types       math_types;
-          typedef typename math_types::vector3_type    vector3_type;
-          typedef typename math_types::real_type       real_type;
+          size_t const IJ = I*J;
+          value_type const corner[8] = {
+            values[idx],      values[idx + I],      values[idx + I + 1],      values[idx + 1],
+            values[idx + IJ], values[idx + IJ + I], values[idx + IJ + I + 1], values[idx + IJ + 1]
+          };
 
-          size_t i1 = i, j1 = j, k1 = k;
-          size_t i2 = i, j2 = j, k2 = k;
-          switch (edge_number)
+          identifier_type table_index = static_cast<identifier_type>(0);
+          for(identifier_type c = 0; c < 8; ++c)
           {
-          case 0:        j2 += 1;        break;
-          case 1:        j1 += 1;        i2 += 1;        j2 += 1;        break;
-          case 2:        i1 += 1;        j1 += 1;        i2 += 1;        break;
-          case 3:        i1 += 1;        break;
-          case 4:        k1 += 1;        j2 += 1;        k2 += 1;        break;
-          case 5:        j1 += 1;        k1 += 1;        i2 += 1;        j2 += 1;        k2 += 1;        break;
-          case 6:        i1 += 1;        j1 += 1;        k1 += 1;        i2 += 1;        k2 += 1;        break;
-          case 7:        i1 += 1;        k1 += 1;        k2 += 1;        break;
-          case 8:        k2 += 1;        break;
-          case 9:        j1 += 1;        j2 += 1;        k2 += 1;        break;
-          case 10:       i1 += 1;        j1 += 1;        i2 += 1;        j2 += 1;        k2 += 1;        break;
-          case 11:       i1 += 1;        i2 += 1;        k2 += 1;        break;
+            // Part of current cell was unknown so we just skip it
+            if( corner[c] == unknown )
+              return;
+            if( corner[c] < isolevel )
+              table_index |= (1 << c);
           }
-          vector3_type p1 = vector3_type( i1*phi.dx(), j1*phi.dy(), k1*phi.dz()) + phi.min_coord();
-          vector3_type p2 = vector3_type( i2*phi.dx(), j2*phi.dy(), k2*phi.dz()) + phi.min_coord();
-          value_type  value1 = phi(i1,j1,k1);
-          value_type  value2 = phi(i2,j2,k2);
-          real_type mu = static_cast<real_type>(((isovalue - value1))/(value2 - value1));
-          vector3_type p = p1 + mu*(p2-p1);
-          return p;
+          if (table_index==0 || table_index==255)  //--- if (edge_table(table_index) == 0)
+            return;
+
+          for (identifier_type t = 0; triangle_table(table_index,t) != -1; ++t)
+            keys.push_back( edge_key( idx, triangle_table(table_index,t), I, J ) );
         }
 
       protected:
@@ -478,202 +453,284 @@ namespace OpenTissue
           return table[idx1][idx2];
         };
 
-      public:
 
         /**
+        * Get Slab Range.
         *
-        * @param phi
-        * @param isovalue
-        * @param mesh
+        * @param s     The slab number.
+        * @param K     The number of grid nodes along the z-axis.
+        * @param k0    Upon return the first cell layer of the slab.
+        * @param k1    Upon return one past the last cell layer of the slab.
+        */
+        void slab_range(size_t const & s, size_t const & K, size_t & k0, size_t & k1) const
+        {
+          k0 = s*m_slab_size;
+          k1 = std::min( k0 + m_slab_size, K - 1 );
+        }
+
+        /**
+        * Weld Slabs.
+        * Turns the edge keys of the triangles of all slabs into a mesh with
+        * shared vertices.
+        *
+        * @param phi         The grid.
+        * @param isolevel
+        * @param triangles   The edge keys of the triangles of each slab, the
+        *                    keys are overwritten with vertex numbers.
+        * @param mesh        Upon return holds the welded mesh.
         */
         template<typename grid_type,typename mesh_type>
-        void operator()(grid_type const & phi, typename grid_type::value_type const & isolevel, mesh_type & mesh)
+        void weld(
+          grid_type const & phi
+          , typename grid_type::value_type const & isolevel
+          , std::vector<key_container> & triangles
+          , mesh_type & mesh
+          ) const
         {
-          typedef typename mesh_type::face_handle     face_handle;
           typedef typename mesh_type::vertex_handle   vertex_handle;
           typedef typename mesh_type::math_types      math_types;
-          typedef typename math_types::value_traits   value_traits;
           typedef typename math_types::vector3_type   vector3_type;
           typedef typename math_types::real_type      real_type;
 
-          typedef typename grid_type::iterator         iterator;
-          typedef typename grid_type::value_type       value_type;
+          typedef typename grid_type::value_type      value_type;
 
-          mesh.clear();
+          size_t const I  = phi.I();
+          size_t const J  = phi.J();
+          size_t const K  = phi.K();
+          size_t const IJ = I*J;
+          int    const count = static_cast<int>( triangles.size() );
 
-          size_t I = phi.I();
-          size_t J = phi.J();
-          size_t K = phi.K();
+          //--- Keys on the upper boundary plane of a slab are owned by the next slab
+          std::vector<size_t> limit( count );
+          for(int s = 0; s < count; ++s)
+          {
+            size_t k0, k1;
+            slab_range( s, K, k0, k1 );
+            limit[s] = (s + 1 < count) ? 3u*k1*IJ : std::numeric_limits<size_t>::max();
+          }
 
-          //typedef std::map<identifier_type,vertex_handle> lut_type;
-          //lut_type lut;
-          typedef std::vector<vertex_handle> lut_type;
-          lut_type lut(3*I*J*K);
+          std::vector<key_container> referenced( count );
+
+#pragma omp parallel for schedule(dynamic) if(count > 1)
+          for(int s = 0; s < count; ++s)
+          {
+            referenced[s] = triangles[s];
+            std::sort( referenced[s].begin(), referenced[s].end() );
+            referenced[s].erase( std::unique( referenced[s].begin(), referenced[s].end() ), referenced[s].end() );
+          }
 
-          static value_type const unknown = phi.unused();// Convenience for better readability
+          std::vector<key_container> owned( count );
 
-          for (size_t k = 0; k < K-1; ++k)
+#pragma omp parallel for schedule(dynamic) if(count > 1)
+          for(int s = 0; s < count; ++s)
           {
-            for (size_t j = 0; j < J-1; ++j)
+            key_container const & mine = referenced[s];
+            key_container::const_iterator end = std::lower_bound( mine.begin(), mine.end(), limit[s] );
+            if(s == 0)
             {
-              value_type const *  i0j0k0 = &(phi(0,j,k));
-              value_type const *  i1j0k0 = &(phi(1,j,k));
-              value_type const *  i0j1k0 = &(phi(0,j+1,k));
-              value_type const *  i1j1k0 = &(phi(1,j+1,k));
-              value_type const *  i0j0k1 = &(phi(0,j,k+1));
-              value_type const *  i1j0k1 = &(phi(1,j,k+1));
-              value_type const *  i0j1k1 = &(phi(0,j+1,k+1));
-              value_type const *  i1j1k1 = &(phi(1,j+1,k+1));
-              for (size_t i = 0; i < I-1; ++i)
-              {
-                identifier_type table_index = static_cast<identifier_type>(0);
-
-                assert( phi(i  ,  j,  k)  == *i0j0k0);
-                assert( phi(i+1,  j,  k)  == *i1j0k0);
-                assert( phi(i  ,j+1,  k)  == *i0j1k0);
-                assert( phi(i+1,j+1,  k)  == *i1j1k0);
-                assert( phi(i  ,  j,k+1)  == *i0j0k1);
-                assert( phi(i+1,  j,k+1)  == *i1j0k1);
-                assert( phi(i  ,j+1,k+1)  == *i0j1k1);
-                assert( phi(i+1,j+1,k+1)  == *i1j1k1);
-
-
-                if( *i0j0k0 < isolevel ) table_index |= 1;
-                if( *i0j1k0 < isolevel ) table_index |= 2;
-                if( *i1j1k0 < isolevel ) table_index |= 4;
-                if( *i1j0k0 < isolevel ) table_index |= 8;
-                if( *i0j0k1 < isolevel ) table_index |= 16;
-                if( *i0j1k1 < isolevel ) table_index |= 32;
-                if( *i1j1k1 < isolevel ) table_index |= 64;
-                if( *i1j0k1 < isolevel ) table_index |= 128;
-
-                // Part of current cell was unknown so we just skip
-                // ahead to next cell
-                bool goto_next = ( ( *i0j0k0 == unknown )||( *i0j1k0 == unknown )||( *i1j1k0 == unknown )||( *i1j0k0 == unknown )||( *i0j0k1 == unknown )||( *i0j1k1 == unknown )||( *i1j1k1 == unknown )||( *i1j0k1 == unknown )  );
-
-                ++i0j0k0;
-                ++i1j0k0;
-                ++i0j1k0;
-                ++i1j1k0;
-                ++i0j0k1;
-                ++i1j0k1;
-                ++i0j1k1;
-                ++i1j1k1;
-
-                if(goto_next) continue;
-
-                assert(table_index >= 0  || !"table idx out of range");
-                assert(table_index < 256 || !"table idx out of range");
-                identifier_type  cell_case = edge_table(table_index);
-
-                // Now create a triangulation of the isosurface in this cell.
-                if (cell_case == 0)
-                  continue;
-
-                //--- unrolling calculate_intersection may speed up things???
-
-#define test_edge(binary_edge_code,edge_number) \
-  if (cell_case & binary_edge_code) \
-                {\
-                identifier_type  id = get_edge_id(i, j, k, edge_number, I, J);\
-                vector3_type p = calculate_intersection(phi,isolevel,i, j, k, edge_number);\
-                vertex_handle h = mesh.add_vertex( p ); \
-                assert(!h.is_null() || !"could not create vertex");\
-                lut[id] = h; \
-                }
+              owned[s].assign( mine.begin(), end );
+              continue;
+            }
+            key_container const & previous = referenced[s-1];
+            key_container::const_iterator tail = std::lower_bound( previous.begin(), previous.end(), limit[s-1] );
+            std::set_union( mine.begin(), end, tail, previous.end(), std::back_inserter( owned[s] ) );
+          }
 
-                test_edge(8,3);
-                test_edge(1,0);
-                test_edge(256,8);
-                if (i == I - 2)
-                {
-                  test_edge(4,2);
-                  test_edge(2048,11);
-                }
-                if (j == J - 2)
-                {
-                  test_edge(2,1);
-                  test_edge(512,9);
-                }
-                if (k == K - 2)
-                {
-                  test_edge(16,4);
-                  test_edge(128,7);
-                }
-                if ((i==I - 2) && (j==J - 2))
-                {
-                  test_edge(1024,10);
-                }
-                if ((i==I - 2) && (k==K - 2))
-                {
-                  test_edge(64,6);
-                }
-                if ((j==J - 2) && (k==K - 2))
-                {
-                  test_edge(32,5);
-                }
-#undef test_edge \
+          std::vector<size_t> offset( count + 1, 0u );
+          for(int s = 0; s < count; ++s)
+            offset[s+1] = offset[s] + owned[s].size();
 
-              }
+          key_container             keys( offset[count] );
+          std::vector<vector3_type> coords( offset[count] );
+
+          value_type const * values    = phi.data();
+          size_t     const   stride[3] = { 1u, I, IJ };
+          real_type  const   spacing[3] = { static_cast<real_type>( phi.dx() ), static_cast<real_type>( phi.dy() ), static_cast<real_type>( phi.dz() ) };
+          real_type  const   origin[3]  = { static_cast<real_type>( phi.min_coord()(0) ), static_cast<real_type>( phi.min_coord()(1) ), static_cast<real_type>( phi.min_coord()(2) ) };
+
+#pragma omp parallel for schedule(dynamic) if(count > 1)
+          for(int s = 0; s < count; ++s)
+          {
+            std::copy( owned[s].begin(), owned[s].end(), keys.begin() + offset[s] );
+            for(size_t n = offset[s]; n < offset[s+1]; ++n)
+            {
+              size_t const node  = keys[n] / 3u;
+              size_t const axis  = keys[n] % 3u;
+              size_t const index[3] = { node % I, (node / I) % J, node / IJ };
+
+              real_type const value1 = static_cast<real_type>( values[node] );
+              real_type const value2 = static_cast<real_type>( values[node + stride[axis]] );
+              real_type const mu     = ( static_cast<real_type>(isolevel) - value1 ) / ( value2 - value1 );
+
+              vector3_type p;
+              for(size_t m = 0; m < 3u; ++m)
+                p(m) = origin[m] + index[m]*spacing[m];
+              p(axis) += mu*spacing[axis];
+              coords[n] = p;
             }
           }
 
-          for (size_t k = 0; k < (K-1); ++k)
+#pragma omp parallel for schedule(dynamic) if(count > 1)
+          for(int s = 0; s < count; ++s)
           {
-            for (size_t j = 0; j < (J-1); ++j)
+            //--- The triangles of a slab only use vertices of the slab itself or of the next slab
+            key_container::const_iterator first = keys.begin() + offset[s];
+            key_container::const_iterator last  = keys.begin() + offset[ std::min( s + 2, count ) ];
+            for(size_t n = 0; n < triangles[s].size(); ++n)
             {
-              value_type const *  i0j0k0 = &(phi(0,j,k));
-              value_type const *  i1j0k0 = &(phi(1,j,k));
-              value_type const *  i0j1k0 = &(phi(0,j+1,k));
-              value_type const *  i1j1k0 = &(phi(1,j+1,k));
-              value_type const *  i0j0k1 = &(phi(0,j,k+1));
-              value_type const *  i1j0k1 = &(phi(1,j,k+1));
-              value_type const *  i0j1k1 = &(phi(0,j+1,k+1));
-              value_type const *  i1j1k1 = &(phi(1,j+1,k+1));
-              for (size_t i = 0; i < (I-1); ++i)
+              key_container::const_iterator v = std::lower_bound( first, last, triangles[s][n] );
+              assert( (v != last && *v == triangles[s][n]) || !"IsoSurfaceGenerator::weld(): missing vertex");
+              triangles[s][n] = static_cast<size_t>( v - keys.begin() );
+            }
+          }
+
+          std::vector<vertex_handle> handles( coords.size() );
+          for(size_t n = 0; n < coords.size(); ++n)
+          {
+            handles[n] = mesh.add_vertex( coords[n] );
+            assert(!handles[n].is_null() || !"could not create vertex");
+          }
+          for(int s = 0; s < count; ++s)
+          {
+            key_container const & tris = triangles[s];
+            for(size_t n = 0; n + 2 < tris.size(); n += 3)
+              mesh.add_face( handles[ tris[n] ], handles[ tris[n+1] ], handles[ tris[n+2] ] );
+          }
+        }
+
+      public:
+
+        /**
+        * Extract Iso Surface from all cells of a grid.
+        *
+        * @param phi
+        * @param isolevel
+        * @param mesh
+        */
+        template<typename grid_type,typename mesh_type>
+        void operator()(grid_type const & phi, typename grid_type::value_type const & isolevel, mesh_type & mesh) const
+        {
+          typedef typename grid_type::value_type       value_type;
+
+          mesh.clear();
+
+          size_t const I = phi.I();
+          size_t const J = phi.J();
+          size_t const K = phi.K();
+          if(I < 2 || J < 2 || K < 2)
+            return;
+
+          value_type const   unknown = phi.unused();   // Convenience for better readability
+          value_type const * values  = phi.data();
+
+          int const count = static_cast<int>( (K - 2)/m_slab_size + 1 );
+          std::vector<key_container> triangles( count );
+
+#pragma omp parallel for schedule(dynamic) if(count > 1)
+          for(int s = 0; s < count; ++s)
+          {
+            size_t k0, k1;
+            slab_range( s, K, k0, k1 );
+            for (size_t k = k0; k < k1; ++k)
+              for (size_t j = 0; j < J-1; ++j)
               {
-                identifier_type table_index = static_cast<identifier_type>(0);
-
-                if( *i0j0k0 < isolevel ) table_index |= 1;
-                if( *i0j1k0 < isolevel ) table_index |= 2;
-                if( *i1j1k0 < isolevel ) table_index |= 4;
-                if( *i1j0k0 < isolevel ) table_index |= 8;
-                if( *i0j0k1 < isolevel ) table_index |= 16;
-                if( *i0j1k1 < isolevel ) table_index |= 32;
-                if( *i1j1k1 < isolevel ) table_index |= 64;
-                if( *i1j0k1 < isolevel ) table_index |= 128;
-
-                // Part of current cell was unknown so we just skip
-                // ahead to next cell
-                bool goto_next = ( ( *i0j0k0 == unknown )||( *i0j1k0 == unknown )||( *i1j1k0 == unknown )||( *i1j0k0 == unknown )||( *i0j0k1 == unknown )||( *i0j1k1 == unknown )||( *i1j1k1 == unknown )||( *i1j0k1 == unknown )  );
-
-                ++i0j0k0;
-                ++i1j0k0;
-                ++i0j1k0;
-                ++i1j1k0;
-                ++i0j0k1;
-                ++i1j0k1;
-                ++i0j1k1;
-                ++i1j1k1;
-
-                if(goto_next) continue;
-
-                assert(table_index >= 0  || !"table idx out of range");
-                assert(table_index < 256 || !"table idx out of range");
-                if (table_index==0 || table_index==255)  //--- if (edge_table(table_index) == 0)
-                  continue;
-                //--- It may be a bit expensive to actually use a function call to look up in the triangle table??
-                for (identifier_type t = 0; triangle_table(table_index,t) != -1; t += 3)
+                size_t idx = (k*J + j)*I;
+                for (size_t i = 0; i < I-1; ++i, ++idx)
+                  march_cell( values, idx, I, J, isolevel, unknown, triangles[s] );
+              }
+          }
+
+          weld( phi, isolevel, triangles, mesh );
+        }
+
+        /**
+        * Extract Iso Surface from the cells around a set of nodes.
+        * Only the cells that are incident to an edge that crosses the iso
+        * level, and whose lower end-point is one of the given nodes, are
+        * visited. Thus the node set should contain all nodes next to the
+        * iso surface, the active nodes of a narrow band around the zero
+        * level set is a natural choice.
+        *
+        * @param phi
+        * @param isolevel
+        * @param nodes      Linear indices of the grid nodes to look at.
+        * @param mesh
+        */
+        template<typename grid_type,typename mesh_type>
+        void operator()(
+          grid_type const & phi
+          , typename grid_type::value_type const & isolevel
+          , std::vector<size_t> const & nodes
+          , mesh_type & mesh
+          ) const
+        {
+          typedef typename grid_type::value_type       value_type;
+
+          mesh.clear();
+
+          size_t const I = phi.I();
+          size_t const J = phi.J();
+          size_t const K = phi.K();
+          if(I < 2 || J < 2 || K < 2)
+            return;
+
+          size_t const IJ = I*J;
+          value_type const   unknown = phi.unused();
+          value_type const * values  = phi.data();
+          size_t     const   stride[3] = { 1u, I, IJ };
+          size_t     const   dims[3]   = { I, J, K };
+
+          //--- Find the lower corners of the cells around the crossing edges
+          key_container cells;
+          for(size_t n = 0; n < nodes.size(); ++n)
+          {
+            size_t const idx = nodes[n];
+            if( values[idx] == unknown )
+              continue;
+            bool const below = values[idx] < isolevel;
+            size_t const index[3] = { idx % I, (idx / I) % J, idx / IJ };
+            for(size_t a = 0; a < 3u; ++a)
+            {
+              if( index[a] + 1 >= dims[a] )
+                continue;
+              value_type const other = values[idx + stride[a]];
+              if( other == unknown || (other < isolevel) == below )
+                continue;
+
+              //--- The four cells sharing the edge
+              size_t const b = (a + 1) % 3u;
+              size_t const c = (a + 2) % 3u;
+              for(size_t db = 0; db < 2u; ++db)
+                for(size_t dc = 0; dc < 2u; ++dc)
                 {
-                  identifier_type id0 = get_edge_id(i, j, k, triangle_table(table_index,t  ), I, J);
-                  identifier_type id1 = get_edge_id(i, j, k, triangle_table(table_index,t+1), I, J);
-                  identifier_type id2 = get_edge_id(i, j, k, triangle_table(table_index,t+2), I, J);
-                  mesh.add_face(lut[id0],lut[id1],lut[id2]);
+                  if( index[b] < db || index[b] - db + 1 >= dims[b] )
+                    continue;
+                  if( index[c] < dc || index[c] - dc + 1 >= dims[c] )
+                    continue;
+                  cells.push_back( idx - db*stride[b] - dc*stride[c] );
                 }
-              }
             }
           }
+          std::sort( cells.begin(), cells.end() );
+          cells.erase( std::unique( cells.begin(), cells.end() ), cells.end() );
+
+          int const count = static_cast<int>( (K - 2)/m_slab_size + 1 );
+          std::vector<key_container> triangles( count );
+
+#pragma omp parallel for schedule(dynamic) if(count > 1)
+          for(int s = 0; s < count; ++s)
+          {
+            size_t k0, k1;
+            slab_range( s, K, k0, k1 );
+            key_container::const_iterator begin = cells.begin();
+            key_container::const_iterator end   = cells.end();
+            begin = std::lower_bound( begin, end, k0*IJ );
+            end   = std::lower_bound( begin, end, k1*IJ );
+            for(key_container::const_iterator cell = begin; cell != end; ++cell)
+              march_cell( values, *cell, I, J, isolevel, unknown, triangles[s] );
+          }
 
+          weld( phi, isolevel, triangles, mesh );
         }
 
       };
@@ -697,6 +754,38 @@ namespace OpenTissue
       std::cout << "isosurface() : extracted " << mesh.size_vertices() << " vertices " << mesh.size_faces() << " faces" << std::endl;
     }
 
+    /**
+    * Extract Iso Surface in a Narrow Band.
+    * Only the cells around the given nodes are visited, so the cost is
+    * proportional to the size of the node set rather than to the size of
+    * the grid. The resulting mesh is the same as the one produced by
+    * visiting all cells, as long as the node set contains every node next
+    * to the iso surface.
+    *
+    * Example usage:
+    *
+    *   grid::NarrowBand<grid_type> band;
+    *   band.init( phi, 3*phi.dx() );
+    *   ...
+    *   mesh::isosurface( phi, 0, band.active(), mesh );
+    *
+    * @param phi
+    * @param isolevel
+    * @param nodes       Linear indices of the grid nodes around the iso surface.
+    * @param mesh
+    */
+    template<typename grid_type,typename mesh_type>
+    void isosurface(
+      grid_type const & phi
+      , typename grid_type::value_type const & isolevel
+      , std::vector<size_t> const & nodes
+      , mesh_type & mesh
+      )
+    {
+      detail::IsoSurfaceGenerator iso;
+      iso(phi,isolevel,nodes,mesh);
+    }
+
   } // namespace mesh
 } // namespace OpenTissue
 
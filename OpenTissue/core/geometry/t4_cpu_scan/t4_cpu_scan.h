@@ -17,9 +17,14 @@
 #include <OpenTissue/core/geometry/geometry_compute_distance_to_triangle.h>
 #include <OpenTissue/core/geometry/geometry_compute_signed_distance_to_triangle.h>
 #include <OpenTissue/core/containers/mesh/common/util/mesh_compute_angle_weighted_vertex_normals.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/utility/utility_openmp.h>
 
 #include <boost/cast.hpp>
 
+#include <vector>
+#include <limits>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -30,141 +35,221 @@ namespace OpenTissue
   struct t4_cpu_unsigned {};
   struct t4_cpu_signed {};
 
-  /**
-  * CPU Signed Distance Field Computation.
-  *
-  * @param surface             A surface mesh, used to generate the
-  *                         distance field from.
-  * @param thickness        An offset parameter, describing the extent
-  *                         of the generated distance field along vertex normals
-  *                         (not the same as face normals!).
-  * @param phi              Upon return holds the generated distance field.
-  *
-  */
-  template<typename surface_mesh, typename grid_type>
-  inline void t4_cpu_scan(
-      surface_mesh /*const*/ & surface
-    , double const & thickness
-    , grid_type & phi
-    , t4_cpu_signed const & /*tag*/
-    )
+  namespace detail
   {
-    using std::ceil;
-    using std::floor;
-    using std::fabs;
-
-    assert(thickness>0 || "t4_cpu_scan(): thickness was non-positive");
-
-    typedef typename surface_mesh::math_types                math_types;
-    typedef typename math_types::vector3_type                vector3_type;
-    typedef typename math_types::real_type                   real_type;
-    typedef typename surface_mesh::face_iterator             face_iterator;
-    typedef typename surface_mesh::face_halfedge_circulator  face_halfedge_circulator;
-    typedef typename grid_type::value_type                    value_type;
-
-    typedef          OpenTissue::geometry::ZTetrahedronSlicer<vector3_type>               slicer_type;
-    typedef          OpenTissue::geometry::LocalTriangleFrame<vector3_type>               local_frame_type;
-    typedef          OpenTissue::geometry::Tetrahedron<math_types>                        tetrahedron_type;
-    typedef          OpenTissue::scan_conversion::FragmentIterator<vector3_type>          fragment_iterator;
-
-
-    local_frame_type  local_frame;
-    tetrahedron_type  tetrahedra[5];
-    vector3_type      vertices[4];
-
-    real_type const min_x = phi.min_coord(0);
-    real_type const min_y = phi.min_coord(1);
-    real_type const min_z = phi.min_coord(2);
-    real_type const dx = phi.dx();   //--- space between grid nodes along x-axis
-    real_type const dy = phi.dy();   //--- space between grid nodes along y-axis
-    real_type const dz = phi.dz();   //--- space between grid nodes along z-axis
-
-    mesh::compute_angle_weighted_vertex_normals(surface);
 
-    face_iterator end    = surface.face_end();
-    face_iterator face   = surface.face_begin();
-    for(;face!=end;++face)
+    /**
+    * T4 Face.
+    * The geometry of a single surface triangle that is needed for
+    * scan converting the distance field of the triangle.
+    */
+    template<typename math_types>
+    class T4Face
     {
-      assert(valency( *face )==3 || !"t4_cpu_scan(): Only triangular faces are supported!");
+    public:
+
+      typedef typename math_types::vector3_type  vector3_type;
+
+      vector3_type m_p_i;    ///< Triangle vertices.
+      vector3_type m_p_j;
+      vector3_type m_p_k;
+      vector3_type m_nv_i;   ///< Angle weighted vertex pseudo normals, only used by signed scans.
+      vector3_type m_nv_j;
+      vector3_type m_nv_k;
+      vector3_type m_ne_i;   ///< Edge pseudo normals, only used by signed scans.
+      vector3_type m_ne_j;
+      vector3_type m_ne_k;
+    };
+
+    template<typename face_type, typename math_types>
+    inline void t4_get_face(face_type & face, T4Face<math_types> & f, t4_cpu_signed const & /*tag*/)
+    {
+      typedef typename math_types::vector3_type              vector3_type;
+      typedef typename face_type::mesh_type                  mesh_type;
+      typedef typename mesh_type::face_halfedge_circulator   face_halfedge_circulator;
 
       vector3_type nf;
-      vector3_type ne_i;
-      vector3_type ne_j;
-      vector3_type ne_k;
 
-      ne_i.clear();
-      ne_j.clear();
-      ne_k.clear();
+      f.m_ne_i.clear();
+      f.m_ne_j.clear();
+      f.m_ne_k.clear();
 
       // get face normal
-      compute_face_normal( *face ,nf);
+      compute_face_normal( face ,nf);
 
-      face_halfedge_circulator h(*face);
-      vector3_type const & p_i  = h->get_origin_iterator()->m_coord;
-      vector3_type const & nv_i  = h->get_origin_iterator()->m_normal;
+      face_halfedge_circulator h(face);
+      f.m_p_i  = h->get_origin_iterator()->m_coord;
+      f.m_nv_i = h->get_origin_iterator()->m_normal;
       if(!h->get_twin_iterator()->get_face_handle().is_null())
-        compute_face_normal( *(h->get_twin_iterator()->get_face_iterator()),ne_k);
+        compute_face_normal( *(h->get_twin_iterator()->get_face_iterator()),f.m_ne_k);
       ++h;
 
-      vector3_type const & p_j  = h->get_origin_iterator()->m_coord;  
-      vector3_type const & nv_j  = h->get_origin_iterator()->m_normal;
+      f.m_p_j  = h->get_origin_iterator()->m_coord;
+      f.m_nv_j = h->get_origin_iterator()->m_normal;
       if(!h->get_twin_iterator()->get_face_handle().is_null())
-        compute_face_normal( *(h->get_twin_iterator()->get_face_iterator()),ne_i);
+        compute_face_normal( *(h->get_twin_iterator()->get_face_iterator()),f.m_ne_i);
       ++h;
 
-      vector3_type const & p_k  = h->get_origin_iterator()->m_coord;
-      vector3_type const & nv_k  = h->get_origin_iterator()->m_normal;
+      f.m_p_k  = h->get_origin_iterator()->m_coord;
+      f.m_nv_k = h->get_origin_iterator()->m_normal;
       if(!h->get_twin_iterator()->get_face_handle().is_null())
-        compute_face_normal( *(h->get_twin_iterator()->get_face_iterator()),ne_j);
+        compute_face_normal( *(h->get_twin_iterator()->get_face_iterator()),f.m_ne_j);
 
       //--- compute edge pseudo normals
-      ne_i = unit(nf + ne_i);
-      ne_j = unit(nf + ne_j);
-      ne_k = unit(nf + ne_k);
-
-      local_frame.init( p_i, p_j, p_k);
-      // For each OBB, the 8 corners are numerated as:
-      //
-      //     2*-----*3        y
-      //     /|    /|         ^
-      //    / |   / |         |
-      //  6*-----*7 |         |
-      //   | 0*--|--*1        +--->x
-      //   | /   | /         /
-      //   |/    |/        |/_
-      //  4*-----5         z
-      //
-      vector3_type c0 = local_frame.v0() - local_frame.unit_a()*thickness - local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c1 = local_frame.v1() + local_frame.unit_a()*thickness - local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c2 = local_frame.v0() - local_frame.unit_a()*thickness + local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c3 = local_frame.v1() + local_frame.unit_a()*thickness + local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c4 = local_frame.v0() - local_frame.unit_a()*thickness - local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-      vector3_type c5 = local_frame.v1() + local_frame.unit_a()*thickness - local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-      vector3_type c6 = local_frame.v0() - local_frame.unit_a()*thickness + local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-      vector3_type c7 = local_frame.v1() + local_frame.unit_a()*thickness + local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-
-      tetrahedra[0].set( c0, c4, c5, c6 );
-      tetrahedra[1].set( c0, c5, c1, c3 );
-      tetrahedra[2].set( c6, c2, c3, c0 );
-      tetrahedra[3].set( c7, c6, c3, c5 );
-      tetrahedra[4].set( c6, c5, c0, c3 );
+      f.m_ne_i = unit(nf + f.m_ne_i);
+      f.m_ne_j = unit(nf + f.m_ne_j);
+      f.m_ne_k = unit(nf + f.m_ne_k);
+    }
+
+    template<typename face_type, typename math_types>
+    inline void t4_get_face(face_type & face, T4Face<math_types> & f, t4_cpu_unsigned const & /*tag*/)
+    {
+      typedef typename face_type::mesh_type                  mesh_type;
+      typedef typename mesh_type::face_halfedge_circulator   face_halfedge_circulator;
+
+      face_halfedge_circulator h(face);
+      f.m_p_i  = h->get_origin_iterator()->m_coord;
+      ++h;
+      f.m_p_j  = h->get_origin_iterator()->m_coord;
+      ++h;
+      f.m_p_k  = h->get_origin_iterator()->m_coord;
+    }
+
+    template<typename math_types>
+    inline typename math_types::real_type t4_distance(typename math_types::vector3_type const & p, T4Face<math_types> const & f, t4_cpu_signed const & /*tag*/)
+    {
+      return OpenTissue::geometry::compute_signed_distance_to_triangle( p, f.m_p_i, f.m_p_j, f.m_p_k, f.m_nv_i, f.m_nv_j, f.m_nv_k, f.m_ne_i, f.m_ne_j, f.m_ne_k);
+    }
+
+    template<typename math_types>
+    inline typename math_types::real_type t4_distance(typename math_types::vector3_type const & p, T4Face<math_types> const & f, t4_cpu_unsigned const & /*tag*/)
+    {
+      return OpenTissue::geometry::compute_distance_to_triangle(p,f.m_p_i,f.m_p_j,f.m_p_k);
+    }
+
+    template<typename value_type, typename real_type>
+    inline void t4_update(value_type & phi, real_type const & value, double const & thickness, t4_cpu_signed const & /*tag*/)
+    {
+      using std::fabs;
+
+      if(
+        ( fabs(value) <= thickness )
+        &&
+        ( fabs(value) < fabs( phi ) )
+        )
+        phi = boost::numeric_cast<value_type>( value );
+    }
+
+    template<typename value_type, typename real_type>
+    inline void t4_update(value_type & phi, real_type const & value, double const & thickness, t4_cpu_unsigned const & /*tag*/)
+    {
+      if(
+        ( value <= thickness ) && ( value < phi )
+        )
+        phi = boost::numeric_cast<value_type>( value );
+    }
+
+    /**
+    * Compute the corners of the box around a triangle that is scan converted.
+    *
+    * For each OBB, the 8 corners are numerated as:
+    *
+    *     2*-----*3        y
+    *     /|    /|         ^
+    *    / |   / |         |
+    *  6*-----*7 |         |
+    *   | 0*--|--*1        +--->x
+    *   | /   | /         /
+    *   |/    |/        |/_
+    *  4*-----5         z
+    *
+    */
+    template<typename math_types>
+    inline void t4_get_corners(T4Face<math_types> const & f, double const & thickness, typename math_types::vector3_type * c)
+    {
+      typedef typename math_types::vector3_type                              vector3_type;
+      typedef          OpenTissue::geometry::LocalTriangleFrame<vector3_type>  local_frame_type;
+
+      local_frame_type  local_frame;
+      local_frame.init( f.m_p_i, f.m_p_j, f.m_p_k);
+
+      c[0] = local_frame.v0() - local_frame.unit_a()*thickness - local_frame.n()*thickness - local_frame.unit_h()*thickness;
+      c[1] = local_frame.v1() + local_frame.unit_a()*thickness - local_frame.n()*thickness - local_frame.unit_h()*thickness;
+      c[2] = local_frame.v0() - local_frame.unit_a()*thickness + local_frame.n()*thickness - local_frame.unit_h()*thickness;
+      c[3] = local_frame.v1() + local_frame.unit_a()*thickness + local_frame.n()*thickness - local_frame.unit_h()*thickness;
+      c[4] = local_frame.v0() - local_frame.unit_a()*thickness - local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
+      c[5] = local_frame.v1() + local_frame.unit_a()*thickness - local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
+      c[6] = local_frame.v0() - local_frame.unit_a()*thickness + local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
+      c[7] = local_frame.v1() + local_frame.unit_a()*thickness + local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
+    }
+
+    /**
+    * Scan convert the distance field of a single triangle.
+    *
+    * @param f          The triangle.
+    * @param thickness  The extent of the generated distance field.
+    * @param k_begin    The first z-slice of phi that may be written.
+    * @param k_end      One past the last z-slice of phi that may be written.
+    * @param phi        The distance field.
+    */
+    template<typename math_types, typename grid_type, typename tag_type>
+    inline void t4_scan_face(
+      T4Face<math_types> const & f
+      , double const & thickness
+      , int const & k_begin
+      , int const & k_end
+      , grid_type & phi
+      , tag_type const & tag
+      )
+    {
+      using std::ceil;
+      using std::floor;
+      using std::min;
+      using std::max;
+
+      typedef typename math_types::vector3_type                                     vector3_type;
+      typedef typename math_types::real_type                                        real_type;
+      typedef          OpenTissue::geometry::ZTetrahedronSlicer<vector3_type>       slicer_type;
+      typedef          OpenTissue::geometry::Tetrahedron<math_types>                tetrahedron_type;
+      typedef          OpenTissue::scan_conversion::FragmentIterator<vector3_type>  fragment_iterator;
+
+      real_type const min_x = phi.min_coord(0);
+      real_type const min_y = phi.min_coord(1);
+      real_type const min_z = phi.min_coord(2);
+      real_type const dx = phi.dx();   //--- space between grid nodes along x-axis
+      real_type const dy = phi.dy();   //--- space between grid nodes along y-axis
+      real_type const dz = phi.dz();   //--- space between grid nodes along z-axis
+
+      tetrahedron_type  tetrahedra[5];
+      vector3_type      vertices[4];
+      vector3_type      corners[8];
+
+      t4_get_corners( f, thickness, corners );
+
+      tetrahedra[0].set( corners[0], corners[4], corners[5], corners[6] );
+      tetrahedra[1].set( corners[0], corners[5], corners[1], corners[3] );
+      tetrahedra[2].set( corners[6], corners[2], corners[3], corners[0] );
+      tetrahedra[3].set( corners[7], corners[6], corners[3], corners[5] );
+      tetrahedra[4].set( corners[6], corners[5], corners[0], corners[3] );
 
       for(int n=0;n<5;++n)
       {
-        slicer_type slicer( 
+        slicer_type slicer(
             tetrahedra[n].p0()
           , tetrahedra[n].p1()
           , tetrahedra[n].p2()
-          , tetrahedra[n].p3() 
+          , tetrahedra[n].p3()
           );
 
-        vector3_type min_coord; 
-        vector3_type max_coord; 
+        vector3_type min_coord;
+        vector3_type max_coord;
         OpenTissue::geometry::compute_tetrahedron_aabb(tetrahedra[n],min_coord,max_coord);
 
         //--- Determine the z value to start slicing (min) and the z-value to stop slicing (max)
         int k_min = boost::numeric_cast<int>(ceil(  (min_coord(2) - min_z)/dz ));
         int k_max = boost::numeric_cast<int>(floor( (max_coord(2) - min_z)/dz ));
+        k_min = max( k_min, k_begin );
+        k_max = min( k_max, k_end - 1 );
 
         for(int k = k_min;k<=k_max;++k)
         {
@@ -201,23 +286,15 @@ namespace OpenTissue
               int i = pixel.x();
               int j = pixel.y();
               //--- compute corresponding world coordinates of pixel
-              vector3_type p ( 
+              vector3_type p (
                   i*dx + min_x
                 , j*dy + min_y
                 , k*dz + min_z
                 );
 
-              //--- compute closest signed distance to triangle
-              //real_type value = OpenTissue::geometry::compute_distance_to_triangle(p,p_i,p_j,p_k);
-              real_type value = OpenTissue::geometry::compute_signed_distance_to_triangle( p, p_i, p_j, p_k, nv_i, nv_j, nv_k, ne_i, ne_j, ne_k);
-
-              // store signed distance into phi at location  (i,j,k)
-              if(
-                ( fabs(value) <= thickness ) 
-                && 
-                ( fabs(value) < fabs( phi(i,j,k) ) ) 
-                )
-                phi(i,j,k) = boost::numeric_cast<value_type>( value );
+              //--- compute closest (signed) distance to triangle and store it into phi at location  (i,j,k)
+              real_type value = t4_distance( p, f, tag );
+              t4_update( phi(i,j,k), value, thickness, tag );
               ++pixel;
             }
           }
@@ -225,11 +302,143 @@ namespace OpenTissue
         }
       }
     }
-  }
 
+    /**
+    * Serial scan conversion, one face at a time.
+    */
+    template<typename surface_mesh, typename grid_type, typename tag_type>
+    inline void t4_cpu_scan_serial(
+        surface_mesh /*const*/ & surface
+      , double const & thickness
+      , grid_type & phi
+      , tag_type const & tag
+      )
+    {
+      typedef typename surface_mesh::math_types                math_types;
+      typedef typename surface_mesh::face_iterator             face_iterator;
+
+      assert(thickness>0 || "t4_cpu_scan(): thickness was non-positive");
+
+      mesh::compute_angle_weighted_vertex_normals(surface);
+
+      T4Face<math_types> f;
+
+      face_iterator end    = surface.face_end();
+      face_iterator face   = surface.face_begin();
+      for(;face!=end;++face)
+      {
+        assert(valency( *face )==3 || !"t4_cpu_scan(): Only triangular faces are supported!");
+
+        t4_get_face( *face, f, tag );
+        t4_scan_face( f, thickness, (std::numeric_limits<int>::min)(), (std::numeric_limits<int>::max)(), phi, tag );
+      }
+    }
+
+    /**
+    * Parallel scan conversion.
+    * The grid is cut into slabs of z-slices. Each face is binned into the
+    * slabs overlapped by its box, and the slabs are processed in parallel
+    * with each thread writing only to the z-slices of its own slab. Thus no
+    * locking is needed, and the result is the same as for the serial scan
+    * because each slab visits its faces in mesh order.
+    *
+    * Nodes outside the range of z-slices of the grid are never written.
+    */
+    template<typename surface_mesh, typename grid_type, typename tag_type>
+    inline void t4_cpu_scan_slabs(
+        surface_mesh /*const*/ & surface
+      , double const & thickness
+      , grid_type & phi
+      , tag_type const & tag
+      )
+    {
+      using std::ceil;
+      using std::floor;
+      using std::min;
+      using std::max;
+
+      typedef typename surface_mesh::math_types                math_types;
+      typedef typename math_types::vector3_type                vector3_type;
+      typedef typename math_types::real_type                   real_type;
+      typedef typename surface_mesh::face_iterator             face_iterator;
+
+      assert(thickness>0 || "t4_cpu_scan(): thickness was non-positive");
+
+      int const K = boost::numeric_cast<int>( phi.K() );
+      if(K==0)
+        return;
+
+      real_type const min_z = phi.min_coord(2);
+      real_type const dz    = phi.dz();
+
+      mesh::compute_angle_weighted_vertex_normals(surface);
+
+      //--- Gather the faces and their ranges of z-slices
+      std::vector< T4Face<math_types> > faces;
+      std::vector<int>                  k_min;
+      std::vector<int>                  k_max;
+      faces.reserve( surface.size_faces() );
+      k_min.reserve( surface.size_faces() );
+      k_max.reserve( surface.size_faces() );
+
+      vector3_type c[8];
+      face_iterator end    = surface.face_end();
+      face_iterator face   = surface.face_begin();
+      for(;face!=end;++face)
+      {
+        assert(valency( *face )==3 || !"t4_cpu_scan(): Only triangular faces are supported!");
+
+        faces.push_back( T4Face<math_types>() );
+        t4_get_face( *face, faces.back(), tag );
+        t4_get_corners( faces.back(), thickness, c );
+
+        real_type z_min = c[0](2);
+        real_type z_max = c[0](2);
+        for(int m=1;m<8;++m)
+        {
+          z_min = min( z_min, c[m](2) );
+          z_max = max( z_max, c[m](2) );
+        }
+        k_min.push_back( max( 0,     boost::numeric_cast<int>( ceil(  (z_min - min_z)/dz ) ) ) );
+        k_max.push_back( min( K - 1, boost::numeric_cast<int>( floor( (z_max - min_z)/dz ) ) ) );
+      }
+
+      //--- Bin the faces into slabs, a few slabs per thread for load balancing
+      int const slabs = min( K, 4*OpenTissue::utility::get_max_threads() );
+      std::vector<int> slab_of( K );
+      std::vector<int> k_begin( slabs );
+      std::vector<int> k_end( slabs );
+      for(int s=0;s<slabs;++s)
+      {
+        k_begin[s] = (s*K)/slabs;
+        k_end[s]   = ((s+1)*K)/slabs;
+        for(int k=k_begin[s];k<k_end[s];++k)
+          slab_of[k] = s;
+      }
+
+      std::vector< std::vector<int> > bins( slabs );
+      int const F = boost::numeric_cast<int>( faces.size() );
+      for(int f=0;f<F;++f)
+      {
+        if(k_min[f] > k_max[f])
+          continue;
+        for(int s=slab_of[k_min[f]];s<=slab_of[k_max[f]];++s)
+          bins[s].push_back( f );
+      }
+
+#pragma omp parallel for schedule(dynamic,1)
+      for(int s=0;s<slabs;++s)
+      {
+        std::vector<int> const & bin = bins[s];
+        for(size_t b=0;b<bin.size();++b)
+          t4_scan_face( faces[ bin[b] ], thickness, k_begin[s], k_end[s], phi, tag );
+      }
+    }
+
+  } // namespace detail
 
   /**
-  * CPU Unsgined Distance Field Computation.
+  * CPU Signed Distance Field Computation.
   *
   * @param surface             A surface mesh, used to generate the
   *                         distance field from.
@@ -244,156 +453,74 @@ namespace OpenTissue
       surface_mesh /*const*/ & surface
     , double const & thickness
     , grid_type & phi
-    , t4_cpu_unsigned const & /*tag*/
+    , t4_cpu_signed const & tag
     )
   {
-    using std::ceil;
-    using std::floor;
-    using std::fabs;
-
-    assert(thickness>0 || "t4_cpu_scan(): thickness was non-positive");
-
-    typedef typename surface_mesh::math_types                math_types;
-    typedef typename math_types::vector3_type                vector3_type;
-    typedef typename math_types::real_type                   real_type;
-    typedef typename surface_mesh::face_iterator             face_iterator;
-    typedef typename surface_mesh::face_halfedge_circulator  face_halfedge_circulator;
-    typedef typename grid_type::value_type                    value_type;
-
-    typedef          OpenTissue::geometry::ZTetrahedronSlicer<vector3_type>        slicer_type;
-    typedef          OpenTissue::geometry::LocalTriangleFrame<vector3_type>        local_frame_type;
-    typedef          OpenTissue::geometry::Tetrahedron<math_types>                 tetrahedron_type;
-    typedef          OpenTissue::scan_conversion::FragmentIterator<vector3_type>   fragment_iterator;
-
-    local_frame_type  local_frame;
-    tetrahedron_type  tetrahedra[5];
-    vector3_type      vertices[4];
-
-    real_type const min_x = phi.min_coord(0);
-    real_type const min_y = phi.min_coord(1);
-    real_type const min_z = phi.min_coord(2);
-    real_type const max_x = phi.max_coord(0);
-    real_type const max_y = phi.max_coord(1);
-    real_type const max_z = phi.max_coord(2);
-    real_type const dx = phi.dx();   //--- space between grid nodes along x-axis
-    real_type const dy = phi.dy();   //--- space between grid nodes along y-axis
-    real_type const dz = phi.dz();   //--- space between grid nodes along z-axis
-
-    mesh::compute_angle_weighted_vertex_normals(surface);
-
-    face_iterator end    = surface.face_end();
-    face_iterator face   = surface.face_begin();
-    for(;face!=end;++face)
-    {
-      assert(valency( *face )==3 || !"t4_cpu_scan(): Only triangular faces are supported!");
-
-      face_halfedge_circulator h(*face);
-      vector3_type const & p_i  = h->get_origin_iterator()->m_coord;
-      ++h;
-      vector3_type const & p_j  = h->get_origin_iterator()->m_coord;  
-      ++h;
-      vector3_type const & p_k  = h->get_origin_iterator()->m_coord;
-
-      local_frame.init( p_i, p_j, p_k);
-      // For each OBB, the 8 corners are numerated as:
-      //
-      //     2*-----*3        y
-      //     /|    /|         ^
-      //    / |   / |         |
-      //  6*-----*7 |         |
-      //   | 0*--|--*1        +--->x
-      //   | /   | /         /
-      //   |/    |/        |/_
-      //  4*-----5         z
-      //
-      vector3_type c0 = local_frame.v0() - local_frame.unit_a()*thickness - local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c1 = local_frame.v1() + local_frame.unit_a()*thickness - local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c2 = local_frame.v0() - local_frame.unit_a()*thickness + local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c3 = local_frame.v1() + local_frame.unit_a()*thickness + local_frame.n()*thickness - local_frame.unit_h()*thickness;
-      vector3_type c4 = local_frame.v0() - local_frame.unit_a()*thickness - local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-      vector3_type c5 = local_frame.v1() + local_frame.unit_a()*thickness - local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-      vector3_type c6 = local_frame.v0() - local_frame.unit_a()*thickness + local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-      vector3_type c7 = local_frame.v1() + local_frame.unit_a()*thickness + local_frame.n()*thickness + local_frame.unit_h()*(thickness+local_frame.h());
-
-      tetrahedra[0].set( c0, c4, c5, c6 );
-      tetrahedra[1].set( c0, c5, c1, c3 );
-      tetrahedra[2].set( c6, c2, c3, c0 );
-      tetrahedra[3].set( c7, c6, c3, c5 );
-      tetrahedra[4].set( c6, c5, c0, c3 );
-
-      for(int n=0;n<5;++n)
-      {
-        slicer_type slicer( 
-            tetrahedra[n].p0()
-          , tetrahedra[n].p1()
-          , tetrahedra[n].p2()
-          , tetrahedra[n].p3() 
-          );
-
-        vector3_type min_coord; 
-        vector3_type max_coord; 
-        compute_tetrahedron_aabb(tetrahedra[n],min_coord,max_coord);
-
-        //--- Determine the z value to start slicing (min) and the z-value to stop slicing (max)
-        int k_min = boost::numeric_cast<int>(ceil(  (min_coord(2) - min_z)/dz ));
-        int k_max = boost::numeric_cast<int>(floor( (max_coord(2) - min_z)/dz ));
-
-        for(int k = k_min;k<=k_max;++k)
-        {
-          real_type z = k*dz + min_z;
-
-          int number_of_vertices = slicer.intersect(z,vertices);
-
-          if(number_of_vertices<3)
-            continue;
-
-          //--- transform vertices into ``screen space'', that is make a parallel projection onto the I and J axes of phi
-          //--- In openGL one would do it like
-          //--- real_type left   = min_x - dx/2;
-          //--- real_type right  = max_x + dx/2;
-          //--- real_type bottom = min_y - dy/2;
-          //--- real_type top    = max_y + dy/2;
-          //--- gluOrtho2D( left, right, bottom, top);
-          //--- glViewport(0,0,phi.I(),phi.J());
-          //---
-          //--- However, we can just do it straightforward,...
-          for(int m=0;m<number_of_vertices;++m)
-          {
-            vertices[m](0) = (vertices[m](0) - min_x)/dx;
-            vertices[m](1) = (vertices[m](1) - min_y)/dy;
-          }
-
-          int number_of_triangles = (number_of_vertices==3)? 1 : 2;
-
-          for(int c=1;c<=number_of_triangles;++c)
-          {
-            fragment_iterator pixel(vertices[0],vertices[c],vertices[c+1]);
-            while(pixel())
-            {
-              int i = pixel.x();
-              int j = pixel.y();
-              //--- compute corresponding world coordinates of pixel
-              vector3_type p ( 
-                  i*dx + min_x
-                , j*dy + min_y
-                , k*dz + min_z
-                );
+    detail::t4_cpu_scan_serial( surface, thickness, phi, tag );
+  }
 
-              //--- compute closest signed distance to triangle
-              real_type value = OpenTissue::geometry::compute_distance_to_triangle(p,p_i,p_j,p_k);
+  /**
+  * CPU Unsgined Distance Field Computation.
+  *
+  * @param surface             A surface mesh, used to generate the
+  *                         distance field from.
+  * @param thickness        An offset parameter, describing the extent
+  *                         of the generated distance field along vertex normals
+  *                         (not the same as face normals!).
+  * @param phi              Upon return holds the generated distance field.
+  *
+  */
+  template<typename surface_mesh, typename grid_type>
+  inline void t4_cpu_scan(
+      surface_mesh /*const*/ & surface
+    , double const & thickness
+    , grid_type & phi
+    , t4_cpu_unsigned const & tag
+    )
+  {
+    detail::t4_cpu_scan_serial( surface, thickness, phi, tag );
+  }
 
-              // store signed distance into phi at location  (i,j,k)
-              if(
-                ( value <= thickness ) && ( value < phi(i,j,k) ) 
-                )
-                  phi(i,j,k) = boost::numeric_cast<value_type>( value );
-              ++pixel;
-            }
-          }
+  /**
+  * Multithreaded CPU Signed Distance Field Computation.
+  * Dense grids are scan converted in parallel slabs of z-slices.
+  *
+  * @param surface          A surface mesh, used to generate the distance field from.
+  * @param thickness        An offset parameter, describing the extent
+  *                         of the generated distance field along vertex normals
+  *                         (not the same as face normals!).
+  * @param phi              Upon return holds the generated distance field.
+  */
+  template<typename surface_mesh, typename T, typename M>
+  inline void t4_cpu_scan(
+      surface_mesh /*const*/ & surface
+    , double const & thickness
+    , OpenTissue::grid::Grid<T,M> & phi
+    , t4_cpu_signed const & tag
+    )
+  {
+    detail::t4_cpu_scan_slabs( surface, thickness, phi, tag );
+  }
 
-        }
-      }
-    }
+  /**
+  * Multithreaded CPU Unsigned Distance Field Computation.
+  * Dense grids are scan converted in parallel slabs of z-slices.
+  *
+  * @param surface          A surface mesh, used to generate the distance field from.
+  * @param thickness        An offset parameter, describing the extent
+  *                         of the generated distance field along vertex normals
+  *                         (not the same as face normals!).
+  * @param phi              Upon return holds the generated distance field.
+  */
+  template<typename surface_mesh, typename T, typename M>
+  inline void t4_cpu_scan(
+      surface_mesh /*const*/ & surface
+    , double const & thickness
+    , OpenTissue::grid::Grid<T,M> & phi
+    , t4_cpu_unsigned const & tag
+    )
+  {
+    detail::t4_cpu_scan_slabs( surface, thickness, phi, tag );
   }
 
 } // namespace OpenTissue
@@ -10,7 +10,7 @@
 #include <OpenTissue/configuration.h>
 
 #include <OpenTissue/core/geometry/geometry_obb.h>
-#include <OpenTissue/collision/collision_box_box_improved.h>
+#include <OpenTissue/collision/collision_box_box_batch.h>
 
 namespace OpenTissue
 {
@@ -58,19 +58,28 @@ namespace OpenTissue
           BtoWCS = coordsys_type( r_b, Q_b );
           AtoWCS = coordsys_type( r_a, Q_a );
           
-          vector3_type p[16];
+          vector3_type p[OpenTissue::collision::detail::box_box_max_contacts];
           vector3_type n;
-          real_type distance[16];
+          real_type distance[OpenTissue::collision::detail::box_box_max_contacts];
 
           matrix3x3_type RA(AtoWCS.Q());
           matrix3x3_type RB(BtoWCS.Q());
-          
-          size_t cnt = OpenTissue::collision::box_box_improved(AtoWCS.T(),RA,boxA.ext(),BtoWCS.T(),RB,boxB.ext(),info.get_envelope(),p,n,distance);                 
+
+          //--- A batch of one box pair, the contacts are those of box_box_improved
+          unsigned int cnt = 0;
+          OpenTissue::collision::box_box_batch(
+            1u
+            , &AtoWCS.T(), &RA, &boxA.ext()
+            , &BtoWCS.T(), &RB, &boxB.ext()
+            , info.get_envelope()
+            , OpenTissue::collision::detail::box_box_max_contacts
+            , p, &n, distance, &cnt
+            );
           
           info.get_contacts()->clear();          
           if(cnt>0)
           {
-            for(size_t i=0;i<cnt;++i)
+            for(unsigned int i=0;i<cnt;++i)
             {
               contact_type contact;
               contact.init( info.get_body_A(), info.get_body_B(), p[i], n, distance[i], info.get_material() );
@@ -61,7 +61,7 @@ namespace OpenTissue
 
           info.get_contacts()->clear();
 
-          bool collision = OpenTissue::collision::sdf_sdf(AtoWCS,sdfA,BtoWCS,sdfB, *(info.get_contacts()) ,info.get_envelope() );
+          bool collision = OpenTissue::collision::sdf_sdf_batch(AtoWCS,sdfA,BtoWCS,sdfB, *(info.get_contacts()) ,info.get_envelope() );
 
           for(typename contact_container::iterator cp = info.get_contacts()->begin();cp!=info.get_contacts()->end();++cp)
           {
@@ -0,0 +1,287 @@
+#ifndef OPENTISSUE_DYNAMICS_MBD_COLLISION_DETECTION_COLLISION_HANDLERS_MBD_VCLIP_HANDLER_H
+#define OPENTISSUE_DYNAMICS_MBD_COLLISION_DETECTION_COLLISION_HANDLERS_MBD_VCLIP_HANDLER_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/vclip/vclip.h>
+#include <OpenTissue/collision/gjk/gjk_compute_penetration_depth.h>
+
+#include <boost/cast.hpp>  // needed for boost::numeric_cast
+
+namespace OpenTissue
+{
+  namespace mbd
+  {
+    namespace collision_detection
+    {
+
+      /**
+      * V-Clip Collision Handler.
+      * Handles collisions between two convex polyhedra. The closest features found
+      * by v-clip are stored on the edge of the body pair and used to seed v-clip in
+      * the next invocation. For slowly moving bodies this makes the query almost
+      * constant time.
+      *
+      * If one of the closest features is a face then contacts are generated for all
+      * vertices of the other polyhedron that lie in the voronoi region of the face
+      * and within the collision envelope. This gives a contact manifold for resting
+      * contacts. Otherwise a single contact is generated at the closest points. If
+      * the polyhedra penetrate and no face is among the closest features, then the
+      * contact normal and penetration depth are computed with GJK and EPA.
+      */
+      template<typename mbd_types>
+      struct VClipHandler
+      {
+        typedef typename mbd_types::collision_info_type   collision_info_type;
+        typedef typename mbd_types::math_policy           math_policy;
+        typedef typename math_policy::real_type           real_type;
+        typedef typename math_policy::vector3_type        vector3_type;
+        typedef typename math_policy::quaternion_type     quaternion_type;
+        typedef typename math_policy::coordsys_type       coordsys_type;
+        typedef typename math_policy::value_traits        value_traits;
+
+        typedef typename mbd_types::body_type                    body_type;
+        typedef typename mbd_types::edge_type                    edge_type;
+        typedef typename mbd_types::contact_type                 contact_type;
+
+        typedef OpenTissue::vclip::Geometry<math_policy>         vclip_geometry_type;
+        typedef OpenTissue::vclip::VClip                         vclip_type;
+        typedef OpenTissue::vclip::vclip_mesh_type               vclip_mesh_type;
+        typedef OpenTissue::vclip::Feature                       feature_type;
+        typedef vclip_type::coordsys_type                        vclip_coordsys_type;
+        typedef vclip_type::vector3_type                         vclip_vector3_type;
+        typedef vclip_type::real_type                            vclip_real_type;
+        typedef vclip_coordsys_type::quaternion_type             vclip_quaternion_type;
+
+        static bool test(
+          vclip_geometry_type & geometryA
+          , vclip_geometry_type & geometryB
+          , collision_info_type & info
+          )
+        {
+          vector3_type r_a;
+          vector3_type r_b;
+          quaternion_type Q_a;
+          quaternion_type Q_b;
+          info.get_body_A()->get_position( r_a );
+          info.get_body_A()->get_orientation( Q_a );
+          info.get_body_B()->get_position( r_b );
+          info.get_body_B()->get_orientation( Q_b );
+
+          vclip_coordsys_type const AtoWCS = vclip_coordsys_type( to_vclip(r_a), to_vclip(Q_a) );
+          vclip_coordsys_type const BtoWCS = vclip_coordsys_type( to_vclip(r_b), to_vclip(Q_b) );
+          vclip_coordsys_type const AtoB   = model_update( AtoWCS, BtoWCS );
+          vclip_coordsys_type const BtoA   = inverse( AtoB );
+
+          vclip_mesh_type const & meshA = geometryA.get_mesh();
+          vclip_mesh_type const & meshB = geometryB.get_mesh();
+
+          //--- Seed with the closest features from the last invocation if possible
+          feature_type * seedA = geometryA.get_seed();
+          feature_type * seedB = geometryB.get_seed();
+          edge_type * edge = info.get_edge();
+          if(edge)
+            edge->m_vclip_cache.get_seeds( &meshA, &meshB, seedA, seedB );
+          if(seedA->m_type == feature_type::FACE && seedB->m_type == feature_type::FACE)
+            seedA = geometryA.get_seed();
+
+          vclip_type vclip;
+          vclip_vector3_type cpA;
+          vclip_vector3_type cpB;
+          vclip_real_type const distance = vclip.run( meshA, meshB, AtoB, BtoA, &seedA, &seedB, cpA, cpB );
+
+          if(edge)
+            edge->m_vclip_cache.set_seeds( &meshA, &meshB, seedA, seedB );
+
+          info.get_contacts()->clear();
+
+          vclip_real_type const envelope = info.get_envelope();
+          if(distance > envelope)
+            return false;
+
+          //--- Contact manifold from a face among the closest features
+          vclip_real_type min_distance = distance;
+          if(seedA->m_type == feature_type::FACE)
+            add_face_contacts( info, geometryB, BtoWCS, BtoA, static_cast<face_pointer>(seedA), AtoWCS, envelope, false, min_distance );
+          else if(seedB->m_type == feature_type::FACE)
+            add_face_contacts( info, geometryA, AtoWCS, AtoB, static_cast<face_pointer>(seedB), BtoWCS, envelope, true, min_distance );
+
+          if(!info.get_contacts()->empty())
+            return ( min_distance < -envelope );
+
+          //--- Single contact at the closest points
+          vclip_vector3_type p_a = cpA;
+          vclip_vector3_type p_b = cpB;
+          AtoWCS.xform_point( p_a );
+          BtoWCS.xform_point( p_b );
+
+          vclip_vector3_type n;
+          vclip_real_type    d = distance;
+          if(distance > OpenTissue::math::working_precision<vclip_real_type>())
+          {
+            n = unit( p_b - p_a );
+          }
+          else
+          {
+            OpenTissue::gjk::VoronoiSimplexSolverPolicy const simplex_solver_policy = OpenTissue::gjk::VoronoiSimplexSolverPolicy();
+            OpenTissue::gjk::Simplex<vclip_vector3_type> sigma;
+            size_t iterations = 0u;
+            size_t status     = 0u;
+            vclip_real_type depth = vclip_real_type();
+            bool const overlapping = OpenTissue::gjk::compute_penetration_depth(
+              AtoWCS, Support( meshA ), BtoWCS, Support( meshB )
+              , p_a, p_b, depth, n, iterations, status, sigma
+              , boost::numeric_cast<vclip_real_type>(10e-6)
+              , boost::numeric_cast<vclip_real_type>(10e-6)
+              , boost::numeric_cast<vclip_real_type>(10e-15)
+              , 100u
+              , simplex_solver_policy
+              );
+            d = -depth;
+            //--- EPA gives no reliable normal if the polyhedra are only touching, fall back on the direction between the centers
+            if(!overlapping || n*n < OpenTissue::math::working_precision<vclip_real_type>())
+              n = unit( to_vclip(r_b) - to_vclip(r_a) );
+          }
+
+          contact_type contact;
+          contact.init(
+            info.get_body_A()
+            , info.get_body_B()
+            , from_vclip( (p_a + p_b)*0.5 )
+            , from_vclip( n )
+            , boost::numeric_cast<real_type>( d )
+            , info.get_material()
+            );
+          info.get_contacts()->push_back( contact );
+          return ( d < -envelope );
+        }
+
+      protected:
+
+        typedef vclip_mesh_type::face_type                         face_type;
+        typedef face_type *                                        face_pointer;
+        typedef vclip_mesh_type::const_face_halfedge_circulator    face_halfedge_circulator;
+        typedef vclip_mesh_type::const_vertex_iterator             vertex_iterator;
+
+        /**
+        * Support functor for the mesh of a v-clip geometry, used by GJK and EPA.
+        */
+        class Support
+        {
+        public:
+
+          vclip_mesh_type const * m_mesh;
+
+          explicit Support(vclip_mesh_type const & mesh) : m_mesh( &mesh ) {}
+
+          vclip_vector3_type operator()(vclip_vector3_type const & v) const
+          {
+            vertex_iterator best = m_mesh->vertex_begin();
+            vclip_real_type best_value = best->m_coord * v;
+            for(vertex_iterator w = m_mesh->vertex_begin();w!=m_mesh->vertex_end();++w)
+            {
+              vclip_real_type const value = w->m_coord * v;
+              if(value > best_value)
+              {
+                best_value = value;
+                best       = w;
+              }
+            }
+            return best->m_coord;
+          }
+        };
+
+        /**
+        * Add Face Contacts.
+        * Generates a contact for every vertex of the other polyhedron that lies in the
+        * voronoi region of the face and whose distance to the face plane is at most the
+        * collision envelope. Vertices below the face plane are kept however deep they are,
+        * such that deeply penetrating vertices still give contacts.
+        *
+        * @param info          The collision info where contacts are added.
+        * @param other         The polyhedron that do not own the face.
+        * @param OtoWCS        Transform from the model frame of the other polyhedron to the world.
+        * @param OtoF          Transform from the model frame of the other polyhedron to the model frame of the face.
+        * @param face          The face.
+        * @param FtoWCS        Transform from the model frame of the face to the world.
+        * @param envelope      The collision envelope.
+        * @param face_on_B     Boolean flag telling whether the face belongs to body B.
+        * @param min_distance  Upon return holds the minimum distance of all contacts generated.
+        */
+        static void add_face_contacts(
+          collision_info_type & info
+          , vclip_geometry_type const & other
+          , vclip_coordsys_type const & OtoWCS
+          , vclip_coordsys_type const & OtoF
+          , face_pointer face
+          , vclip_coordsys_type const & FtoWCS
+          , vclip_real_type const & envelope
+          , bool const & face_on_B
+          , vclip_real_type & min_distance
+          )
+        {
+          vclip_vector3_type n = face->m_plane.n();
+          FtoWCS.xform_vector( n );
+          if(face_on_B)
+            n = -n;
+          vector3_type const normal = from_vclip( n );
+
+          for(vertex_iterator v = other.get_mesh().vertex_begin();v!=other.get_mesh().vertex_end();++v)
+          {
+            vclip_vector3_type q = v->m_coord;
+            OtoF.xform_point( q );
+
+            vclip_real_type const d = face->m_plane.signed_distance( q );
+            if(d > envelope)
+              continue;
+
+            bool inside = true;
+            face_halfedge_circulator h(*face), end;
+            for(;h!=end && inside;++h)
+              inside = ( h->m_voronoi_plane_EF.signed_distance( q ) >= vclip_real_type() );
+            if(!inside)
+              continue;
+
+            //--- Contact point midway between the vertex and its projection onto the face
+            vclip_vector3_type p = v->m_coord;
+            OtoWCS.xform_point( p );
+            p += (face_on_B ? n : -n) * (d*0.5);
+
+            contact_type contact;
+            contact.init( info.get_body_A(), info.get_body_B(), from_vclip( p ), normal, boost::numeric_cast<real_type>( d ), info.get_material() );
+            info.get_contacts()->push_back( contact );
+
+            if(d < min_distance)
+              min_distance = d;
+          }
+        }
+
+        static vclip_vector3_type to_vclip(vector3_type const & v)
+        {
+          return vclip_vector3_type( v(0), v(1), v(2) );
+        }
+
+        static vclip_quaternion_type to_vclip(quaternion_type const & Q)
+        {
+          return vclip_quaternion_type( Q.s(), Q.v()(0), Q.v()(1), Q.v()(2) );
+        }
+
+        static vector3_type from_vclip(vclip_vector3_type const & v)
+        {
+          return vector3_type( static_cast<real_type>( v(0) ), static_cast<real_type>( v(1) ), static_cast<real_type>( v(2) ) );
+        }
+
+      };
+
+    } // namespace collision_detection
+  } // namespace mbd
+} // namespace OpenTissue
+
+// OPENTISSUE_DYNAMICS_MBD_COLLISION_DETECTION_COLLISION_HANDLERS_MBD_VCLIP_HANDLER_H
+#endif
@@ -0,0 +1,552 @@
+#ifndef OPENTISSUE_DYNAMICS_MBD_COLLISION_DETECTION_MBD_CONTINUOUS_COLLISION_DETECTION_H
+#define OPENTISSUE_DYNAMICS_MBD_COLLISION_DETECTION_MBD_CONTINUOUS_COLLISION_DETECTION_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/geometry/geometry_base_shape.h>
+#include <OpenTissue/core/geometry/geometry_plane.h>
+#include <OpenTissue/collision/continuous/continuous_conservative_advancement.h>
+#include <OpenTissue/collision/continuous/continuous_default_motion_policy.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+namespace OpenTissue
+{
+  namespace mbd
+  {
+    namespace detail
+    {
+
+      /**
+      * Shape Support Functor.
+      * Adapts the geometry of a body to the support functor interface used by
+      * GJK and conservative advancement. Planes have no support mapping and
+      * are kept aside such that the motion policy can treat them analytically.
+      */
+      template<typename math_policy>
+      class ShapeSupport
+      {
+      public:
+
+        typedef typename math_policy::vector3_type         vector3_type;
+        typedef OpenTissue::geometry::BaseShape<math_policy>  shape_type;
+        typedef OpenTissue::geometry::Plane<math_policy>      plane_type;
+
+      public:
+
+        shape_type const * m_shape;   ///< Pointer to the shape of the body, null if the body has no support mapping.
+        plane_type const * m_plane;   ///< Pointer to the plane of the body, null if the body is not a plane.
+
+      public:
+
+        ShapeSupport()
+          : m_shape(0)
+          , m_plane(0)
+        {}
+
+        template<typename geometry_type>
+        void init(geometry_type const * geometry)
+        {
+          m_shape = dynamic_cast<shape_type const *>( geometry );
+          m_plane = dynamic_cast<plane_type const *>( geometry );
+        }
+
+        bool is_supported() const { return m_shape != 0; }
+
+        vector3_type operator()(vector3_type const & v) const
+        {
+          assert( m_shape || !"ShapeSupport::operator(): no shape");
+          return m_shape->get_support_point( v );
+        }
+
+      };
+
+      /**
+      * Continuous Motion Policy.
+      * Extends the default motion policy used by conservative advancement with an
+      * analytical closest point computation between planes and convex shapes.
+      */
+      class ContinuousMotionPolicy
+        : public OpenTissue::collision::continuous::DefaultMotionPolicy
+      {
+      public:
+
+        template< typename transform_type, typename support_type>
+        static void compute_closest_points(
+          transform_type const & X_a
+          , support_type const & A
+          , transform_type const & X_b
+          , support_type const & B
+          , typename transform_type::vector3_type & p_a
+          , typename transform_type::vector3_type & p_b
+          )
+        {
+          if(A.m_plane)
+          {
+            plane_closest_points( X_a, A, X_b, B, p_a, p_b );
+            return;
+          }
+          if(B.m_plane)
+          {
+            plane_closest_points( X_b, B, X_a, A, p_b, p_a );
+            return;
+          }
+          DefaultMotionPolicy::compute_closest_points( X_a, A, X_b, B, p_a, p_b );
+        }
+
+      protected:
+
+        template< typename transform_type, typename support_type>
+        static void plane_closest_points(
+          transform_type const & X_plane
+          , support_type const & plane
+          , transform_type const & X_b
+          , support_type const & B
+          , typename transform_type::vector3_type & p_plane
+          , typename transform_type::vector3_type & p_b
+          )
+        {
+          typedef typename transform_type::vector3_type    V;
+          typedef typename transform_type::value_type      T;
+          typedef typename transform_type::value_traits    value_traits;
+
+          V const n = X_plane.Q().rotate( plane.m_plane->n() );
+          T const w = plane.m_plane->w() + dot( n, X_plane.T() );
+
+          //--- Deepest point of B in the direction of the plane normal
+          p_b = B( conj( X_b.Q() ).rotate( -n ) );
+          X_b.xform_point( p_b );
+
+          T const d = dot( n, p_b ) - w;
+          p_plane = (d > value_traits::zero()) ? V( p_b - n*d ) : p_b;
+        }
+
+      };
+
+    } // namespace detail
+
+    /**
+    * Continuous Collision Detection.
+    * This class finds the first time of impact between fast moving bodies during
+    * a time step. It is intended to be run after the discrete collision detection
+    * and before the stepper, such that simulators can sub-step the islands that
+    * would otherwise tunnel through each other.
+    *
+    * The algorithm has three phases:
+    *
+    *  1) All active bodies are extrapolated with their current velocities over the time
+    *     step and a swept AABB is computed. Bodies moving more than a fraction of their
+    *     smallest half-extent during the time step are flagged as fast.
+    *  2) A sort-and-sweep on the swept AABBs finds all pairs involving a fast body.
+    *  3) For each pair the time of impact is computed by conservative advancement.
+    *
+    * Bodies must have geometries deriving from geometry::BaseShape, since the
+    * conservative advancement relies on support mappings. Pairs of bodies without
+    * support mappings are ignored and left to the discrete collision detection.
+    */
+    template< typename mbd_types >
+    class ContinuousCollisionDetection
+    {
+    protected:
+
+      typedef typename mbd_types::math_policy                    math_policy;
+      typedef typename math_policy::real_type                    real_type;
+      typedef typename math_policy::vector3_type                 vector3_type;
+      typedef typename math_policy::matrix3x3_type               matrix3x3_type;
+      typedef typename math_policy::quaternion_type              quaternion_type;
+      typedef typename math_policy::coordsys_type                coordsys_type;
+      typedef typename math_policy::value_traits                 value_traits;
+      typedef typename mbd_types::body_type                      body_type;
+      typedef typename mbd_types::group_type                     group_type;
+      typedef typename mbd_types::group_ptr_container            group_ptr_container;
+      typedef typename mbd_types::configuration_type             configuration_type;
+      typedef detail::ShapeSupport<math_policy>                  support_type;
+      typedef detail::ContinuousMotionPolicy                     motion_policy;
+
+    public:
+
+      class node_traits
+      {
+      public:
+
+        bool m_ccd_affected;   ///< Boolean flag indicating whether the body is part of an island that needs sub-stepping.
+
+        node_traits()
+          : m_ccd_affected(false)
+        {}
+      };
+
+      /**
+      * Impact.
+      * Describes the first time of impact between two bodies.
+      */
+      class Impact
+      {
+      public:
+
+        body_type *   m_A;       ///< The first body.
+        body_type *   m_B;       ///< The second body.
+        real_type     m_time;    ///< The time of impact, measured from the beginning of the time step.
+        vector3_type  m_p_a;     ///< The closest point on body A at the time of impact.
+        vector3_type  m_p_b;     ///< The closest point on body B at the time of impact.
+
+        bool operator<(Impact const & impact) const { return m_time < impact.m_time; }
+      };
+
+      typedef std::vector<Impact>                                impact_container;
+
+    protected:
+
+      /**
+      * Swept Body Record.
+      */
+      class Record
+      {
+      public:
+
+        body_type *     m_body;
+        support_type    m_support;
+        coordsys_type   m_X;
+        vector3_type    m_v;
+        vector3_type    m_w;
+        vector3_type    m_min;       ///< Minimum corner of the swept AABB.
+        vector3_type    m_max;       ///< Maximum corner of the swept AABB.
+        real_type       m_r_max;     ///< Radius of bounding sphere around the body frame origin.
+        bool            m_fast;
+        bool            m_moving;
+      };
+
+      class MinCoordLess
+      {
+      public:
+        bool operator()(Record const & a, Record const & b) const { return a.m_min(0) < b.m_min(0); }
+      };
+
+      class Pair
+      {
+      public:
+        size_t m_a;
+        size_t m_b;
+      };
+
+    protected:
+
+      real_type            m_fast_fraction;     ///< A body is fast if it moves more than this fraction of its smallest half-extent during a time step.
+      size_t               m_max_iterations;    ///< The maximum number of conservative advancement iterations per pair.
+      std::vector<Record>  m_records;
+      std::vector<Pair>    m_pairs;
+
+    public:
+
+      ContinuousCollisionDetection()
+        : m_fast_fraction( value_traits::one() / value_traits::two() )
+        , m_max_iterations( 50u )
+      {}
+
+    public:
+
+      real_type const & fast_fraction() const { return m_fast_fraction; }
+      real_type       & fast_fraction()       { return m_fast_fraction; }
+
+      size_t const & max_iterations() const { return m_max_iterations; }
+      size_t       & max_iterations()       { return m_max_iterations; }
+
+    public:
+
+      /**
+      * Run Continuous Collision Detection.
+      *
+      * @param configuration     The configuration of bodies.
+      * @param time_step         The duration of the time step.
+      * @param impacts           Upon return holds all impacts found during the time step sorted by increasing time of impact.
+      * @param affected_only     If true then only pairs involving bodies tagged as affected are
+      *                          tested, and all other bodies are treated as if they were at rest.
+      *                          This is used by simulators when sub-stepping islands.
+      *
+      * @return                  The number of bodies flagged as fast.
+      */
+      size_t run(
+        configuration_type & configuration
+        , real_type const & time_step
+        , impact_container & impacts
+        , bool const & affected_only = false
+        )
+      {
+        impacts.clear();
+        m_records.clear();
+        m_pairs.clear();
+
+        if(time_step <= value_traits::zero())
+          return 0u;
+
+        real_type const envelope = configuration.get_collision_envelope();
+        size_t fast = 0u;
+
+        //--- Compute swept AABBs and fast flags
+        for(typename configuration_type::body_iterator body = configuration.body_begin();body!=configuration.body_end();++body)
+        {
+          if(!body->is_active() || !body->get_geometry())
+            continue;
+
+          Record record;
+          record.m_body = &(*body);
+          record.m_support.init( body->get_geometry() );
+          if(!record.m_support.is_supported())
+            continue;
+
+          compute_record( record, time_step, envelope, affected_only );
+          if(record.m_fast)
+            ++fast;
+          m_records.push_back( record );
+        }
+
+        if(fast==0u)
+          return 0u;
+
+        //--- Sort and sweep along the x-axis
+        std::sort( m_records.begin(), m_records.end(), MinCoordLess() );
+
+        size_t const N = m_records.size();
+        for(size_t i=0u;i<N;++i)
+        {
+          Record const & a = m_records[i];
+          for(size_t j=i+1u;j<N && m_records[j].m_min(0) <= a.m_max(0);++j)
+          {
+            Record const & b = m_records[j];
+            if(!a.m_fast && !b.m_fast)
+              continue;
+            if(!a.m_moving && !b.m_moving)
+              continue;
+            if(a.m_support.m_plane && b.m_support.m_plane)
+              continue;
+            if(affected_only && !a.m_body->m_ccd_affected && !b.m_body->m_ccd_affected)
+              continue;
+            if(a.m_max(1) < b.m_min(1) || b.m_max(1) < a.m_min(1))
+              continue;
+            if(a.m_max(2) < b.m_min(2) || b.m_max(2) < a.m_min(2))
+              continue;
+            if(a.m_body->has_joint_to(b.m_body))
+              continue;
+            Pair pair;
+            pair.m_a = i;
+            pair.m_b = j;
+            m_pairs.push_back( pair );
+          }
+        }
+
+        //--- Time of impact of all candidate pairs, the pairs are independent of each other
+        int const P = static_cast<int>( m_pairs.size() );
+        std::vector<Impact> candidates( m_pairs.size() );
+        std::vector<char>   found( m_pairs.size(), 0 );
+
+        #pragma omp parallel for schedule(dynamic,4) if(P > 16)
+        for(int k=0;k<P;++k)
+          found[k] = compute_time_of_impact( m_records[ m_pairs[k].m_a ], m_records[ m_pairs[k].m_b ], time_step, envelope, candidates[k] ) ? 1 : 0;
+
+        for(int k=0;k<P;++k)
+          if(found[k])
+            impacts.push_back( candidates[k] );
+
+        std::sort( impacts.begin(), impacts.end() );
+        return fast;
+      }
+
+      /**
+      * Mark Affected Bodies.
+      * Tags all bodies in the groups containing an impacting body as affected,
+      * all other bodies in the configuration are untagged.
+      *
+      * @param configuration     The configuration of bodies.
+      * @param groups            The groups (islands) found by the discrete collision detection.
+      * @param impacts           The impacts found by the continuous collision detection.
+      *
+      * @return                  The number of affected bodies.
+      */
+      size_t mark_affected(
+        configuration_type & configuration
+        , group_ptr_container & groups
+        , impact_container const & impacts
+        )
+      {
+        for(typename configuration_type::body_iterator body = configuration.body_begin();body!=configuration.body_end();++body)
+          body->m_ccd_affected = false;
+
+        for(typename impact_container::const_iterator impact = impacts.begin();impact!=impacts.end();++impact)
+        {
+          impact->m_A->m_ccd_affected = true;
+          impact->m_B->m_ccd_affected = true;
+        }
+
+        size_t affected = 0u;
+        for(typename group_ptr_container::iterator tmp=groups.begin();tmp!=groups.end();++tmp)
+        {
+          group_type * group = (*tmp);
+          if(!is_affected(*group))
+            continue;
+          for(typename group_type::indirect_body_iterator body = group->body_begin();body!=group->body_end();++body)
+            body->m_ccd_affected = true;
+        }
+
+        //--- Fixed and scripted bodies do not belong to any island, their motion is prescribed
+        for(typename configuration_type::body_iterator body = configuration.body_begin();body!=configuration.body_end();++body)
+        {
+          if(body->is_fixed() || body->is_scripted())
+            body->m_ccd_affected = false;
+          if(body->m_ccd_affected)
+            ++affected;
+        }
+        return affected;
+      }
+
+      /**
+      * Test if group contains an affected body.
+      */
+      bool is_affected(group_type const & group) const
+      {
+        for(typename group_type::const_indirect_body_iterator body = group.body_begin();body!=group.body_end();++body)
+          if(body->m_ccd_affected && !body->is_fixed() && !body->is_scripted())
+            return true;
+        return false;
+      }
+
+    protected:
+
+      void compute_record(
+        Record & record
+        , real_type const & time_step
+        , real_type const & envelope
+        , bool const & affected_only
+        ) const
+      {
+        using std::fabs;
+        using std::max;
+        using std::min;
+
+        body_type const * body = record.m_body;
+
+        vector3_type r;
+        quaternion_type Q;
+        body->get_position( r );
+        body->get_orientation( Q );
+        record.m_X = coordsys_type( r, Q );
+
+        record.m_v.clear();
+        record.m_w.clear();
+        bool const frozen = affected_only && !body->m_ccd_affected;
+        if(!body->is_fixed() && !frozen)
+        {
+          body->get_velocity( record.m_v );
+          body->get_spin( record.m_w );
+        }
+        record.m_moving = (sqr_length(record.m_v) > value_traits::zero() || sqr_length(record.m_w) > value_traits::zero());
+
+        //--- Extent of the body in its own frame
+        vector3_type const zero = vector3_type( value_traits::zero(), value_traits::zero(), value_traits::zero() );
+        matrix3x3_type const I = OpenTissue::math::diag( value_traits::one() );
+        vector3_type local_min;
+        vector3_type local_max;
+        body->compute_collision_aabb( zero, I, local_min, local_max, value_traits::zero() );
+
+        if(record.m_support.m_plane)
+        {
+          //--- Planes have no finite extent, they are only allowed to translate
+          record.m_r_max = max( envelope, math::working_precision<real_type>() );
+          record.m_w.clear();
+          record.m_fast  = false;
+        }
+        else
+        {
+          vector3_type const far_corner(
+            max( fabs(local_min(0)), fabs(local_max(0)) )
+            , max( fabs(local_min(1)), fabs(local_max(1)) )
+            , max( fabs(local_min(2)), fabs(local_max(2)) )
+            );
+          record.m_r_max = max( length(far_corner), math::working_precision<real_type>() );
+
+          real_type const r_min = min( min( local_max(0) - local_min(0), local_max(1) - local_min(1) ), local_max(2) - local_min(2) ) / value_traits::two();
+          real_type const motion = ( length(record.m_v) + length(record.m_w)*record.m_r_max )*time_step;
+          record.m_fast = record.m_moving && motion > m_fast_fraction*r_min;
+        }
+
+        //--- Swept AABB, the union of the start and end boxes. A rotating body may leave
+        //--- both boxes during the motion, so we use the bounding sphere along the path instead.
+        matrix3x3_type R;
+        body->get_orientation( R );
+        body->compute_collision_aabb( r, R, record.m_min, record.m_max, envelope );
+        if(!record.m_moving)
+          return;
+
+        coordsys_type const X_end = motion_policy::integrate_motion( record.m_X, time_step, record.m_v, record.m_w );
+        vector3_type end_min;
+        vector3_type end_max;
+        if(sqr_length(record.m_w) > value_traits::zero())
+        {
+          vector3_type const radius = vector3_type( record.m_r_max + envelope, record.m_r_max + envelope, record.m_r_max + envelope );
+          record.m_min = min( record.m_min, r - radius );
+          record.m_max = max( record.m_max, r + radius );
+          end_min = X_end.T() - radius;
+          end_max = X_end.T() + radius;
+        }
+        else
+        {
+          R = X_end.Q();
+          body->compute_collision_aabb( X_end.T(), R, end_min, end_max, envelope );
+        }
+        record.m_min = min( record.m_min, end_min );
+        record.m_max = max( record.m_max, end_max );
+      }
+
+      bool compute_time_of_impact(
+        Record const & a
+        , Record const & b
+        , real_type const & time_step
+        , real_type const & envelope
+        , Impact & impact
+        ) const
+      {
+        real_type const epsilon = ( envelope > value_traits::zero() ) ? envelope : math::working_precision<real_type>();
+
+        size_t iterations = 0u;
+        real_type toi = value_traits::zero();
+        vector3_type p_a;
+        vector3_type p_b;
+
+        support_type A = a.m_support;
+        support_type B = b.m_support;
+
+        bool const hit = OpenTissue::collision::continuous::conservative_advancement(
+          a.m_X, a.m_v, a.m_w, A, a.m_r_max
+          , b.m_X, b.m_v, b.m_w, B, b.m_r_max
+          , p_a, p_b, toi, iterations
+          , epsilon, time_step, m_max_iterations
+          , motion_policy()
+          );
+
+        //--- Pairs already touching at the beginning of the step are handled by the discrete collision detection
+        if(!hit || toi <= value_traits::zero())
+          return false;
+
+        impact.m_A    = a.m_body;
+        impact.m_B    = b.m_body;
+        impact.m_time = toi;
+        impact.m_p_a  = p_a;
+        impact.m_p_b  = p_b;
+        return true;
+      }
+
+    };
+
+  } // namespace mbd
+} // namespace OpenTissue
+
+// OPENTISSUE_DYNAMICS_MBD_COLLISION_DETECTION_MBD_CONTINUOUS_COLLISION_DETECTION_H
+#endif
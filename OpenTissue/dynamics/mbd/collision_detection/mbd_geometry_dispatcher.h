@@ -12,6 +12,7 @@
 #include <OpenTissue/core/math/math_constants.h>
 
 #include <OpenTissue/utility/dispatchers/dispatchers_dynamic_table_dispatcher.h>
+#include <OpenTissue/collision/vclip/vclip_cache.h>
 
 namespace OpenTissue
 {
@@ -37,7 +38,14 @@ namespace OpenTissue
     public:
 
       class node_traits { };
-      class edge_traits { };
+
+      class edge_traits
+      {
+      public:
+
+        OpenTissue::vclip::Cache m_vclip_cache;   ///< Closest features of the last v-clip query on this edge, used for seeding the next query.
+      };
+
       class constraint_traits {};
 
     protected:
@@ -88,7 +96,7 @@ namespace OpenTissue
         assert(m_configuration || !"GeometryDispatcher::run(): configuration was NULL");
         assert(edge            || !"GeometryDispatcher::run(): edge was NULL");
 
-        collision_info_type info( edge->get_body_A(), edge->get_body_B(), m_configuration->get_collision_envelope(), edge->get_material(), edge->get_contacts() );
+        collision_info_type info( edge->get_body_A(), edge->get_body_B(), m_configuration->get_collision_envelope(), edge->get_material(), edge->get_contacts(), edge );
 
         geometry_type & geometry_A = *(edge->get_body_A()->get_geometry());
         geometry_type & geometry_B = *(edge->get_body_B()->get_geometry());
@@ -13,9 +13,11 @@
 #include <OpenTissue/dynamics/mbd/collision_detection/mbd_exhaustive_search.h>
 #include <OpenTissue/dynamics/mbd/collision_detection/mbd_geometry_dispatcher.h>
 #include <OpenTissue/dynamics/mbd/collision_detection/mbd_setup_default_geometry_dispatcher.h>
+#include <OpenTissue/dynamics/mbd/collision_detection/collision_handlers/mbd_vclip_handler.h>
 #include <OpenTissue/dynamics/mbd/collision_detection/mbd_caching_contact_graph_analysis.h>
 #include <OpenTissue/dynamics/mbd/collision_detection/mbd_single_group_analysis.h>
 #include <OpenTissue/dynamics/mbd/collision_detection/mbd_collision_detection.h>
+#include <OpenTissue/dynamics/mbd/collision_detection/mbd_continuous_collision_detection.h>
 // <<<<<<
 
 #include <OpenTissue/dynamics/mbd/joints/mbd_hinge_joint.h>
@@ -49,6 +51,7 @@
 #include <OpenTissue/dynamics/mbd/steppers/mbd_first_order_stepper.h>
 
 #include <OpenTissue/dynamics/mbd/simulators/mbd_bisection_step_simulator.h>
+#include <OpenTissue/dynamics/mbd/simulators/mbd_continuous_fixed_step_simulator.h>
 #include <OpenTissue/dynamics/mbd/simulators/mbd_explicit_fixed_step_simulator.h>
 #include <OpenTissue/dynamics/mbd/simulators/mbd_explicit_separate_error_correction_fixed_step_simulator.h>
 #include <OpenTissue/dynamics/mbd/simulators/mbd_fix_point_step_simulator.h>
@@ -37,6 +37,7 @@ namespace OpenTissue
 
       typedef typename mbd_types::geometry_type                geometry_type;
       typedef typename mbd_types::body_type                    body_type;
+      typedef typename mbd_types::edge_type                    edge_type;
       typedef typename mbd_types::material_type                material_type;
       typedef typename mbd_types::contact_container            contact_container;
       typedef typename mbd_types::contact_type                 contact_type;
@@ -48,6 +49,7 @@ namespace OpenTissue
       real_type           m_envelope;   ///<
       material_type     * m_material;   ///<
       contact_container * m_contacts;   ///<
+      edge_type         * m_edge;       ///< The edge of the body pair, can be used by collision handlers to cache information between invocations. Can be null.
 
     public:
 
@@ -60,12 +62,14 @@ namespace OpenTissue
         , real_type const & envelope
         , material_type * material
         , contact_container * contacts        
+        , edge_type * edge = 0
         )
         : m_A(A)
         , m_B(B)
         , m_envelope(envelope)
         , m_material(material)
         , m_contacts( contacts )
+        , m_edge( edge )
       {}
 
     public:
@@ -87,6 +91,7 @@ namespace OpenTissue
       real_type const     get_envelope() const { return m_envelope; }
       material_type     * get_material() const { return m_material; }
       contact_container * get_contacts() const { return m_contacts; }
+      edge_type         * get_edge()     const { return m_edge;     }
 
     };
 
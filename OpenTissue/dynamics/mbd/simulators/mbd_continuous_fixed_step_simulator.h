@@ -0,0 +1,195 @@
+#ifndef OPENTISSUE_DYNAMICS_MBD_UTIL_SIMULATORS_MBD_CONTINUOUS_FIXED_STEP_SIMULATOR_H
+#define OPENTISSUE_DYNAMICS_MBD_UTIL_SIMULATORS_MBD_CONTINUOUS_FIXED_STEP_SIMULATOR_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/dynamics/mbd/interfaces/mbd_simulator_interface.h>
+#include <OpenTissue/dynamics/mbd/collision_detection/mbd_continuous_collision_detection.h>
+
+#include <vector>
+#include <algorithm>
+
+namespace OpenTissue
+{
+  namespace mbd
+  {
+    /**
+    * A Continuous Fixed Time Step Simulator.
+    * This simulator works like the explicit fixed time step simulator, but
+    * adds a continuous collision detection stage to the pipeline. After the
+    * discrete collision detection the time of impact of all fast moving
+    * bodies is computed. If no impacts are found then the whole time step is
+    * taken at once.
+    *
+    * Otherwise the groups (islands) that do not contain an impacting body are
+    * stepped the full time step, after which they are kept frozen. The affected
+    * groups are then sub-stepped from one time of impact to the next, running
+    * the discrete and continuous collision detection in between sub-steps, until
+    * the end of the time step is reached.
+    *
+    * The islands are the groups reported by the analyzer policy of the collision
+    * detection, so use a contact graph analysis to get true island sub-stepping.
+    */
+    template< typename mbd_types >
+    class ContinuousFixedStepSimulator
+      : public SimulatorInterface<mbd_types>
+    {
+    protected:
+
+      typedef typename mbd_types::math_policy::real_type         real_type;
+      typedef typename mbd_types::math_policy::value_traits      value_traits;
+      typedef typename mbd_types::group_type                     group_type;
+      typedef typename mbd_types::group_ptr_container            group_ptr_container;
+      typedef typename mbd_types::body_type                      body_type;
+      typedef typename mbd_types::configuration_type             configuration_type;
+      typedef ContinuousCollisionDetection<mbd_types>            continuous_collision_detection_type;
+      typedef typename continuous_collision_detection_type::impact_container  impact_container;
+
+    public:
+
+      class node_traits
+        : public continuous_collision_detection_type::node_traits
+      {};
+      class edge_traits{};
+      class constraint_traits{};
+
+    protected:
+
+      group_ptr_container                  m_groups;
+      continuous_collision_detection_type  m_ccd;
+      impact_container                     m_impacts;
+      size_t                               m_max_substeps;    ///< Maximum number of sub-steps of affected groups in one time step.
+      size_t                               m_substeps;        ///< The number of sub-steps taken in the last time step.
+      std::vector<body_type*>              m_frozen;
+
+    public:
+
+      ContinuousFixedStepSimulator()
+        : m_max_substeps(8u)
+        , m_substeps(0u)
+      {}
+
+      virtual ~ContinuousFixedStepSimulator(){}
+
+    public:
+
+      continuous_collision_detection_type       * get_continuous_collision_detection()       { return &m_ccd; }
+      continuous_collision_detection_type const * get_continuous_collision_detection() const { return &m_ccd; }
+
+      size_t const & max_substeps() const { return m_max_substeps; }
+      size_t       & max_substeps()       { return m_max_substeps; }
+
+      /**
+      * Get Number of Sub-steps.
+      *
+      * @return   The number of sub-steps used on the affected groups in the last
+      *           time step. Zero means that no impacts were found.
+      */
+      size_t const & get_substeps() const { return m_substeps; }
+
+      impact_container const & get_impacts() const { return m_impacts; }
+
+    public:
+
+      void run(real_type const & time_step)
+      {
+        configuration_type * configuration = this->get_configuration();
+
+        mbd::compute_scripted_motions(*(configuration->get_all_body_group()),this->time());
+
+        this->get_collision_detection()->run( m_groups );
+
+        m_substeps = 0u;
+        m_ccd.run( *configuration, time_step, m_impacts );
+        m_ccd.mark_affected( *configuration, m_groups, m_impacts );
+
+        //--- Step all unaffected groups the full time step
+        for(typename group_ptr_container::iterator tmp=m_groups.begin();tmp!=m_groups.end();++tmp)
+        {
+          group_type * group = (*tmp);
+          if(!m_impacts.empty() && m_ccd.is_affected(*group))
+            continue;
+          step( *group, time_step );
+        }
+
+        //--- Sub-step affected groups from one time of impact to the next, unaffected bodies stay frozen
+        if(!m_impacts.empty())
+        {
+          freeze( *configuration );
+
+          real_type const min_substep = time_step / (m_max_substeps>0u ? m_max_substeps : 1u);
+          real_type t = value_traits::zero();
+          while(true)
+          {
+            real_type h = time_step - t;
+            if(!m_impacts.empty() && m_substeps + 1u < m_max_substeps)
+              h = std::min( h, std::max( m_impacts.front().m_time, min_substep ) );
+
+            for(typename group_ptr_container::iterator tmp=m_groups.begin();tmp!=m_groups.end();++tmp)
+            {
+              group_type * group = (*tmp);
+              if(m_ccd.is_affected(*group))
+                step( *group, h );
+            }
+            ++m_substeps;
+            t += h;
+
+            if(t >= time_step)
+              break;
+
+            this->get_collision_detection()->run( m_groups );
+            m_ccd.run( *configuration, time_step - t, m_impacts, true );
+          }
+
+          unfreeze();
+        }
+
+        SimulatorInterface<mbd_types>::update_time(time_step);
+      }
+
+    protected:
+
+      void step(group_type & group, real_type const & h)
+      {
+        this->get_sleepy()->evaluate(group.body_begin(),group.body_end());
+
+        if(!mbd::is_all_bodies_sleepy(group))
+          this->get_stepper()->run(group,h);
+      }
+
+      /**
+      * Unaffected bodies have already been stepped to the end of the time step, so
+      * they are temporarily fixed such that they only act as obstacles for the
+      * affected bodies during sub-stepping.
+      */
+      void freeze(configuration_type & configuration)
+      {
+        m_frozen.clear();
+        for(typename configuration_type::body_iterator body = configuration.body_begin();body!=configuration.body_end();++body)
+        {
+          if(body->m_ccd_affected || body->is_fixed() || body->is_scripted())
+            continue;
+          body->set_fixed(true);
+          m_frozen.push_back( &(*body) );
+        }
+      }
+
+      void unfreeze()
+      {
+        for(typename std::vector<body_type*>::iterator body = m_frozen.begin();body!=m_frozen.end();++body)
+          (*body)->set_fixed(false);
+        m_frozen.clear();
+      }
+
+    };
+
+  } // namespace mbd
+} // namespace OpenTissue
+// OPENTISSUE_DYNAMICS_MBD_UTIL_SIMULATORS_MBD_CONTINUOUS_FIXED_STEP_SIMULATOR_H
+#endif
@@ -11,6 +11,7 @@
 
 #include <OpenTissue/core/containers/grid/util/grid_gradient_at_point.h>
 #include <OpenTissue/core/containers/grid/util/grid_value_at_point.h>
+#include <OpenTissue/core/containers/grid/util/grid_mip_pyramid.h>
 #include <cassert>
 
 namespace OpenTissue
@@ -46,6 +47,10 @@ namespace OpenTissue
         if(!OpenTissue::grid::is_point_inside(sdf.m_phi, pos))
           continue;
 
+        //--- Particles far outside are culled by the coarse levels
+        if(OpenTissue::grid::pyramid_lower_bound(sdf.m_pyramid, pos, real_type(0)) > 0)
+          continue;
+
         real_type dist = OpenTissue::grid::value_at_point(sdf.m_phi, pos);
         if ( dist == sdf.m_phi.unused() )
           continue;
@@ -0,0 +1,306 @@
+#ifndef OPENTISSUE_UTILITY_UTILITY_MEMORY_MAPPED_FILE_H
+#define OPENTISSUE_UTILITY_UTILITY_MEMORY_MAPPED_FILE_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#ifdef WIN32
+# define NOMINMAX
+# define WIN32_LEAN_AND_MEAN
+# include <windows.h>
+# undef WIN32_LEAN_AND_MEAN
+# undef NOMINMAX
+#else
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+#include <boost/noncopyable.hpp>
+
+#include <string>
+#include <cstddef>
+
+namespace OpenTissue
+{
+  namespace utility
+  {
+
+    /**
+    * Memory Mapped File.
+    * Maps a whole file into memory. Pages are read from disk on first
+    * access. A file mapped with open() is private to the process (copy on
+    * write), so the file on disk is never changed.
+    *
+    * Example usage:
+    *
+    *  MemoryMappedFile file;
+    *  if(file.open("phi.grid"))
+    *    do_something( file.data(), file.size() );
+    *
+    * A file mapped with create() is shared with the file on disk, it is
+    * intended as backing storage for data that does not fit in memory. The
+    * operating system writes modified pages back to the file and drops
+    * them from memory when it runs short of physical memory.
+    *
+    * The mapping is released by close() or when the object is destroyed,
+    * after which pointers into the data are no longer valid.
+    */
+    class MemoryMappedFile
+      : private boost::noncopyable
+    {
+    protected:
+
+      char   * m_data;      ///< Pointer to first byte of the mapped file, null if nothing is mapped.
+      size_t   m_size;      ///< The size of the mapped file in bytes.
+      bool     m_shared;    ///< If true writes to the memory go to the file.
+#ifdef WIN32
+      HANDLE   m_file;      ///< The file handle.
+      HANDLE   m_mapping;   ///< The file mapping handle.
+#else
+      int      m_fd;        ///< The file descriptor of a shared mapping, it is needed for resizing.
+#endif
+
+    public:
+
+      MemoryMappedFile()
+        : m_data(0)
+        , m_size(0)
+        , m_shared(false)
+#ifdef WIN32
+        , m_file(INVALID_HANDLE_VALUE)
+        , m_mapping(0)
+#else
+        , m_fd(-1)
+#endif
+      {}
+
+      ~MemoryMappedFile() { close(); }
+
+    public:
+
+      /**
+      * Open File.
+      *
+      * @param filename   The file to map.
+      *
+      * @return           If the file was mapped then the return value is true otherwise it is false.
+      */
+      bool open(std::string const & filename)
+      {
+        close();
+#ifdef WIN32
+        m_file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+        if(m_file == INVALID_HANDLE_VALUE)
+          return false;
+        LARGE_INTEGER size;
+        if(!GetFileSizeEx( m_file, &size ) || size.QuadPart == 0)
+        {
+          close();
+          return false;
+        }
+        m_mapping = CreateFileMappingA( m_file, 0, PAGE_WRITECOPY, 0, 0, 0 );
+        if(!m_mapping)
+        {
+          close();
+          return false;
+        }
+        m_data = static_cast<char*>( MapViewOfFile( m_mapping, FILE_MAP_COPY, 0, 0, 0 ) );
+        if(!m_data)
+        {
+          close();
+          return false;
+        }
+        m_size = static_cast<size_t>( size.QuadPart );
+#else
+        int const fd = ::open( filename.c_str(), O_RDONLY );
+        if(fd < 0)
+          return false;
+        struct stat info;
+        if(fstat( fd, &info ) != 0 || info.st_size == 0)
+        {
+          ::close( fd );
+          return false;
+        }
+        void * address = mmap( 0, static_cast<size_t>( info.st_size ), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+        //--- The mapping keeps its own reference to the file
+        ::close( fd );
+        if(address == MAP_FAILED)
+          return false;
+        m_data = static_cast<char*>( address );
+        m_size = static_cast<size_t>( info.st_size );
+#endif
+        return true;
+      }
+
+      /**
+      * Create File.
+      * Creates a file of the given size, or truncates an existing file, and
+      * maps it for reading and writing. Writes to the memory go to the file.
+      *
+      * @param filename   The file to create.
+      * @param size       The size of the file in bytes, must be positive.
+      *
+      * @return           If the file was mapped then the return value is true otherwise it is false.
+      */
+      bool create(std::string const & filename, size_t const & size)
+      {
+        close();
+        if(size == 0)
+          return false;
+#ifdef WIN32
+        m_file = CreateFileA( filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0 );
+        if(m_file == INVALID_HANDLE_VALUE)
+          return false;
+#else
+        m_fd = ::open( filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if(m_fd < 0)
+          return false;
+#endif
+        m_shared = true;
+        if(!map_shared( size ))
+        {
+          close();
+          return false;
+        }
+        return true;
+      }
+
+      /**
+      * Resize File.
+      * Changes the size of a file mapped with create(), the contents up to
+      * the smallest of the old and new size are kept. The file is mapped
+      * again, so pointers into the old data are no longer valid.
+      *
+      * @param size       The new size in bytes, must be positive.
+      *
+      * @return           If the file was resized then the return value is true
+      *                   otherwise it is false, in which case the old mapping is kept.
+      */
+      bool resize(size_t const & size)
+      {
+        if(!m_shared || !m_data || size == 0)
+          return false;
+        if(size == m_size)
+          return true;
+        size_t const old_size = m_size;
+        unmap();
+        if(map_shared( size ))
+          return true;
+        return map_shared( old_size );
+      }
+
+      /**
+      * Flush File.
+      * Writes modified pages of a file mapped with create() to disk.
+      */
+      void flush()
+      {
+        if(!m_shared || !m_data)
+          return;
+#ifdef WIN32
+        FlushViewOfFile( m_data, 0 );
+#else
+        msync( m_data, m_size, MS_SYNC );
+#endif
+      }
+
+      /**
+      * Close File.
+      * Releases the mapping, does nothing if no file is mapped.
+      */
+      void close()
+      {
+        unmap();
+#ifdef WIN32
+        if(m_file != INVALID_HANDLE_VALUE)
+          CloseHandle( m_file );
+        m_file    = INVALID_HANDLE_VALUE;
+#else
+        if(m_fd >= 0)
+          ::close( m_fd );
+        m_fd = -1;
+#endif
+        m_shared = false;
+      }
+
+      bool is_open() const { return m_data != 0; }
+
+      /**
+      * @return   If the file was mapped with create() then the return value is true otherwise it is false.
+      */
+      bool is_shared() const { return m_shared && m_data != 0; }
+
+      char       * data()       { return m_data; }
+      char const * data() const { return m_data; }
+
+      size_t size() const { return m_size; }
+
+    protected:
+
+      /**
+      * Unmap.
+      * Releases the mapping but keeps the file open.
+      */
+      void unmap()
+      {
+#ifdef WIN32
+        if(m_data)
+          UnmapViewOfFile( m_data );
+        if(m_mapping)
+          CloseHandle( m_mapping );
+        m_mapping = 0;
+#else
+        if(m_data)
+          munmap( m_data, m_size );
+#endif
+        m_data = 0;
+        m_size = 0;
+      }
+
+      /**
+      * Map Shared.
+      * Sets the size of the open file and maps it for reading and writing.
+      */
+      bool map_shared(size_t const & size)
+      {
+#ifdef WIN32
+        LARGE_INTEGER length;
+        length.QuadPart = static_cast<LONGLONG>( size );
+        if(!SetFilePointerEx( m_file, length, 0, FILE_BEGIN ) || !SetEndOfFile( m_file ))
+          return false;
+        m_mapping = CreateFileMappingA( m_file, 0, PAGE_READWRITE, 0, 0, 0 );
+        if(!m_mapping)
+          return false;
+        m_data = static_cast<char*>( MapViewOfFile( m_mapping, FILE_MAP_WRITE, 0, 0, 0 ) );
+        if(!m_data)
+        {
+          CloseHandle( m_mapping );
+          m_mapping = 0;
+          return false;
+        }
+#else
+        if(ftruncate( m_fd, static_cast<off_t>( size ) ) != 0)
+          return false;
+        void * address = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+        if(address == MAP_FAILED)
+          return false;
+        m_data = static_cast<char*>( address );
+#endif
+        m_size = size;
+        return true;
+      }
+
+    };
+
+  } // namespace utility
+} // namespace OpenTissue
+
+// OPENTISSUE_UTILITY_UTILITY_MEMORY_MAPPED_FILE_H
+#endif
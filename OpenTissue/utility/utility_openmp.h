@@ -0,0 +1,56 @@
+#ifndef OPENTISSUE_UTILITY_UTILITY_OPENMP_H
+#define OPENTISSUE_UTILITY_UTILITY_OPENMP_H
+//
+// OpenTissue Template Library
+// - A generic toolbox for physics-based modeling and simulation.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL is licensed under zlib: http://opensource.org/licenses/zlib-license.php
+//
+#include <OpenTissue/configuration.h>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+namespace OpenTissue
+{
+  namespace utility
+  {
+
+    /**
+    * OpenMP Thread Queries.
+    * Parallel OpenTissue code is written with OpenMP pragmas, these are
+    * simply ignored when the compiler is not invoked with OpenMP support
+    * (see the OPENTISSUE_ENABLE_OPENMP cmake option). The functions below
+    * wraps the OpenMP runtime such that the same code compiles and runs
+    * serially when OpenMP is not available.
+    *
+    * @return   The maximum number of threads a parallel region would use.
+    */
+    inline int get_max_threads()
+    {
+#ifdef _OPENMP
+      return omp_get_max_threads();
+#else
+      return 1;
+#endif
+    }
+
+    /**
+    * @return   The index of the calling thread within the current team, zero if outside a parallel region.
+    */
+    inline int get_thread_num()
+    {
+#ifdef _OPENMP
+      return omp_get_thread_num();
+#else
+      return 0;
+#endif
+    }
+
+  } // namespace utility
+} // namespace OpenTissue
+
+// OPENTISSUE_UTILITY_UTILITY_OPENMP_H
+#endif
@@ -15,6 +15,8 @@
 
 /**
 @file   This file contains a benchmark test comparing our old GJK implementation with our new GJK implementation.
+        It also measures the gain of warm-starting GJK from a per pair cache on coherent
+        motion and the cost of computing penetration depths with EPA.
 */
 
 
@@ -115,11 +117,187 @@ void new_implementation()
   std::cout << "new impl 10000 random test runs: " << duration() << " seconds" << std::endl;
 }
 
+void warm_started_implementation()
+{
+  typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+
+  typedef math_types::vector3_type                         vector3_type;
+  typedef math_types::real_type                            real_type;
+  typedef math_types::coordsys_type                        transformation_type;
+  typedef math_types::value_traits                         value_traits;
+
+  OpenTissue::gjk::VoronoiSimplexSolverPolicy const simplex_solver_policy = OpenTissue::gjk::VoronoiSimplexSolverPolicy();
+
+  OpenTissue::gjk::Box<math_types> supportA;
+  OpenTissue::gjk::Box<math_types> supportB;
+
+  supportA.half_extent() = vector3_type(1.0,1.0,1.0);
+  supportB.half_extent() = vector3_type(1.0,0.5,0.25);
+
+  size_t    const max_iterations       = 100u;
+  real_type const absolute_tolerance   = boost::numeric_cast<real_type>(10e-6);
+  real_type const relative_tolerance   = boost::numeric_cast<real_type>(10e-6);
+  real_type const stagnation_tolerance = boost::numeric_cast<real_type>(10e-15);
+
+  transformation_type transformA;
+  transformation_type transformB;
+
+  vector3_type a;
+  vector3_type b;
+  size_t iterations     = 0u;
+  size_t status         = 0u;
+  real_type distance    = value_traits::infinity();
+
+  transformA.T().clear();
+  transformA.Q().identity();
+
+  // Box B orbits box A in small steps, this mimics a simulation with coherent frames
+  size_t cold_iterations = 0u;
+  OpenTissue::utility::Timer<double> cold_duration;
+  cold_duration.start();
+  for(int i=0;i<10000;++i)
+  {
+    real_type const t = 0.001*i;
+    transformB.T() = vector3_type( 3.0*std::cos(t), 3.0*std::sin(t), std::sin(5.0*t) );
+    transformB.Q().Ru( 3.0*t, vector3_type(0.0,0.0,1.0) );
+
+    OpenTissue::gjk::compute_closest_points(
+      transformA
+      , supportA
+      , transformB
+      , supportB
+      , a
+      , b
+      , distance
+      , iterations
+      , status
+      , absolute_tolerance
+      , relative_tolerance
+      , stagnation_tolerance
+      , max_iterations
+      , simplex_solver_policy
+      );
+    cold_iterations += iterations;
+  }
+  cold_duration.stop();
+
+  OpenTissue::gjk::Cache<vector3_type> cache;
+
+  size_t warm_iterations = 0u;
+  OpenTissue::utility::Timer<double> warm_duration;
+  warm_duration.start();
+  for(int i=0;i<10000;++i)
+  {
+    real_type const t = 0.001*i;
+    transformB.T() = vector3_type( 3.0*std::cos(t), 3.0*std::sin(t), std::sin(5.0*t) );
+    transformB.Q().Ru( 3.0*t, vector3_type(0.0,0.0,1.0) );
+
+    OpenTissue::gjk::compute_closest_points(
+      transformA
+      , supportA
+      , transformB
+      , supportB
+      , a
+      , b
+      , distance
+      , iterations
+      , status
+      , cache
+      , absolute_tolerance
+      , relative_tolerance
+      , stagnation_tolerance
+      , max_iterations
+      , simplex_solver_policy
+      );
+    warm_iterations += iterations;
+  }
+  warm_duration.stop();
+
+  std::cout << "cold started 10000 coherent test runs: " << cold_duration() << " seconds, " << (cold_iterations/10000.0) << " iterations on average" << std::endl;
+  std::cout << "warm started 10000 coherent test runs: " << warm_duration() << " seconds, " << (warm_iterations/10000.0) << " iterations on average" << std::endl;
+}
+
+void penetration_depth_implementation()
+{
+  typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+
+  typedef math_types::vector3_type                         vector3_type;
+  typedef math_types::real_type                            real_type;
+  typedef math_types::coordsys_type                        transformation_type;
+
+  OpenTissue::gjk::VoronoiSimplexSolverPolicy const simplex_solver_policy = OpenTissue::gjk::VoronoiSimplexSolverPolicy();
+
+  OpenTissue::gjk::Box<math_types> supportA;
+  OpenTissue::gjk::Box<math_types> supportB;
+
+  supportA.half_extent() = vector3_type(1.0,1.0,1.0);
+  supportB.half_extent() = vector3_type(1.0,1.0,1.0);
+
+  size_t    const max_iterations       = 100u;
+  real_type const absolute_tolerance   = boost::numeric_cast<real_type>(10e-6);
+  real_type const relative_tolerance   = boost::numeric_cast<real_type>(10e-6);
+  real_type const stagnation_tolerance = boost::numeric_cast<real_type>(10e-15);
+
+  transformation_type transformA;
+  transformation_type transformB;
+
+  vector3_type a;
+  vector3_type b;
+  vector3_type normal;
+  real_type    depth;
+  size_t iterations     = 0u;
+  size_t status         = 0u;
+
+  transformA.Q().identity();
+  transformB.Q().identity();
+
+  size_t overlaps        = 0u;
+  size_t epa_iterations  = 0u;
+  OpenTissue::utility::Timer<double> duration;
+  duration.start();
+  for(int i=0;i<10000;++i)
+  {
+    // Random placements inside the unit cube, most of the boxes overlap
+    OpenTissue::math::random( transformA.T() );
+    OpenTissue::math::random( transformB.T() );
+    transformB.Q().random( -1.0, 1.0 );
+    transformB.Q() = unit( transformB.Q() );
+
+    OpenTissue::gjk::Simplex<vector3_type> sigma;
+
+    if( OpenTissue::gjk::compute_penetration_depth(
+      transformA
+      , supportA
+      , transformB
+      , supportB
+      , a
+      , b
+      , depth
+      , normal
+      , iterations
+      , status
+      , sigma
+      , absolute_tolerance
+      , relative_tolerance
+      , stagnation_tolerance
+      , max_iterations
+      , simplex_solver_policy
+      ) )
+    {
+      ++overlaps;
+      epa_iterations += iterations;
+    }
+  }
+  duration.stop();
+  std::cout << "gjk+epa 10000 random test runs: " << duration() << " seconds, " << overlaps << " overlaps, " << (overlaps ? epa_iterations/double(overlaps) : 0.0) << " epa iterations on average" << std::endl;
+}
 
 int main( int argc, char **argv )
 {
   old_implementation();
   new_implementation();
+  warm_started_implementation();
+  penetration_depth_implementation();
 
   return 0;
 }
@@ -0,0 +1,206 @@
+//
+// OpenTissue Template Library Demo
+// - A specific demonstration of the flexibility of OTTL.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL and OTTL Demos are licensed under zlib.
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/math/math_random.h>
+#include <OpenTissue/core/containers/mesh/mesh.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_geometry.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_init.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_refit.h>
+#include <OpenTissue/collision/aabb_tree/policies/aabb_tree_ray_policy.h>
+#include <OpenTissue/collision/bvh/bvh_ray_query.h>
+#include <OpenTissue/utility/utility_timer.h>
+
+#include <vector>
+#include <map>
+#include <cmath>
+#include <iostream>
+
+/**
+@file   This file contains a throughput benchmark of the BVH ray query. It casts
+        coherent camera rays and incoherent random rays against a triangle mesh and
+        reports the number of rays per second for single rays, ray packets and
+        multithreaded batches.
+*/
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>  math_types;
+typedef math_types::real_type                             real_type;
+typedef math_types::vector3_type                          vector3_type;
+typedef OpenTissue::polymesh::PolyMesh<math_types>        mesh_type;
+
+class Vertex
+{
+public:
+
+  vector3_type m_x;
+
+  vector3_type const & position() const { return m_x; }
+
+};
+
+typedef OpenTissue::aabb_tree::Geometry<real_type, Vertex>                   aabb_tree_geometry;
+typedef aabb_tree_geometry::bvh_type                                         bvh_type;
+typedef OpenTissue::aabb_tree::RayPolicy<aabb_tree_geometry>                 ray_policy;
+typedef OpenTissue::bvh::RayQuery<bvh_type, ray_policy, 4>                   ray_query4_type;
+typedef OpenTissue::bvh::RayQuery<bvh_type, ray_policy, 8>                   ray_query8_type;
+typedef ray_query8_type::hit_type                                            hit_type;
+
+class Binder
+{
+public:
+
+  std::vector<Vertex>                          m_vertices;
+  std::map<mesh_type::vertex_type *, Vertex *> m_lut;
+
+  Vertex * operator()(mesh_type::vertex_type * v) { return m_lut[v]; }
+
+};
+
+void make_bumpy_sphere(unsigned int slices, unsigned int segments, mesh_type & mesh, Binder & binder)
+{
+  using std::cos;
+  using std::sin;
+
+  real_type const pi = OpenTissue::math::detail::pi<real_type>();
+
+  mesh.clear();
+  std::vector<mesh_type::vertex_handle> grid;
+  mesh_type::vertex_handle south = mesh.add_vertex( vector3_type(0.0, 0.0, -1.0) );
+  mesh_type::vertex_handle north = mesh.add_vertex( vector3_type(0.0, 0.0,  1.0) );
+  for(unsigned int k = 1; k < segments; ++k)
+  {
+    real_type const theta = pi*k/segments;
+    for(unsigned int i = 0; i < slices; ++i)
+    {
+      real_type const phi    = 2.0*pi*i/slices;
+      real_type const radius = 1.0 + 0.2*sin(7.0*phi)*sin(5.0*theta);
+      grid.push_back( mesh.add_vertex( vector3_type( radius*sin(theta)*cos(phi), radius*sin(theta)*sin(phi), -radius*cos(theta) ) ) );
+    }
+  }
+  for(unsigned int i = 0; i < slices; ++i)
+  {
+    unsigned int const j = (i + 1) % slices;
+    mesh.add_face( south, grid[j], grid[i] );
+    mesh.add_face( north, grid[(segments-2)*slices + i], grid[(segments-2)*slices + j] );
+    for(unsigned int k = 0; k + 2 < segments; ++k)
+    {
+      mesh.add_face( grid[k*slices + i], grid[k*slices + j], grid[(k+1)*slices + j] );
+      mesh.add_face( grid[k*slices + i], grid[(k+1)*slices + j], grid[(k+1)*slices + i] );
+    }
+  }
+
+  binder.m_vertices.resize( mesh.size_vertices() );
+  size_t n = 0;
+  for(mesh_type::vertex_iterator v = mesh.vertex_begin(); v != mesh.vertex_end(); ++v, ++n)
+  {
+    binder.m_vertices[n].m_x = v->m_coord;
+    binder.m_lut[ &(*v) ] = &binder.m_vertices[n];
+  }
+}
+
+/**
+ * Generates the rays of a pinhole camera in scan-line order, these are highly coherent.
+ */
+void make_camera_rays(size_t width, size_t height, std::vector<vector3_type> & p, std::vector<vector3_type> & r)
+{
+  p.resize(width*height);
+  r.resize(width*height);
+  for(size_t y = 0; y < height; ++y)
+    for(size_t x = 0; x < width; ++x)
+    {
+      p[y*width + x] = vector3_type( 0.0, 0.0, 4.0 );
+      r[y*width + x] = vector3_type( (x + 0.5)/width - 0.5, (y + 0.5)/height - 0.5, -1.0 );
+    }
+}
+
+/**
+ * Generates random rays, these are incoherent.
+ */
+void make_random_rays(size_t count, std::vector<vector3_type> & p, std::vector<vector3_type> & r)
+{
+  OpenTissue::math::Random<real_type> random(-1.0,1.0);
+  p.resize(count);
+  r.resize(count);
+  for(size_t i = 0; i < count; ++i)
+  {
+    p[i] = vector3_type( 3.0*random(), 3.0*random(), 3.0*random() );
+    r[i] = vector3_type( 0.5*random(), 0.5*random(), 0.5*random() ) - p[i];
+  }
+}
+
+void run(char const * name, ray_query4_type const & query4, ray_query8_type const & query8, std::vector<vector3_type> const & p, std::vector<vector3_type> const & r)
+{
+  size_t const count = p.size();
+  real_type const t_max = 100.0;
+  std::vector<hit_type> hits( count );
+  std::vector<int>      any( count );
+
+  OpenTissue::utility::Timer<double> duration;
+  size_t found = 0;
+
+  duration.start();
+  for(size_t i = 0; i < count; ++i)
+    found += query8.closest_hit( p[i], r[i], t_max, hits[i] );
+  duration.stop();
+  std::cout << name << " single rays closest hit: " << count/duration()*1e-6 << " Mrays/sec (" << found << " hits)" << std::endl;
+
+  duration.start();
+  for(size_t i = 0; i < count; i += 4)
+    query4.closest_hit_packet( std::min<size_t>( 4, count - i ), &p[i], &r[i], t_max, &hits[i] );
+  duration.stop();
+  std::cout << name << " 4-ray packets closest hit: " << count/duration()*1e-6 << " Mrays/sec" << std::endl;
+
+  duration.start();
+  for(size_t i = 0; i < count; i += 8)
+    query8.closest_hit_packet( std::min<size_t>( 8, count - i ), &p[i], &r[i], t_max, &hits[i] );
+  duration.stop();
+  std::cout << name << " 8-ray packets closest hit: " << count/duration()*1e-6 << " Mrays/sec" << std::endl;
+
+  duration.start();
+  query8.closest_hit( count, &p[0], &r[0], t_max, &hits[0] );
+  duration.stop();
+  std::cout << name << " batch closest hit: " << count/duration()*1e-6 << " Mrays/sec" << std::endl;
+
+  duration.start();
+  query8.any_hit( count, &p[0], &r[0], t_max, &any[0] );
+  duration.stop();
+  std::cout << name << " batch any hit: " << count/duration()*1e-6 << " Mrays/sec" << std::endl;
+}
+
+int main( int argc, char **argv )
+{
+  mesh_type mesh;
+  Binder binder;
+  make_bumpy_sphere( 128, 64, mesh, binder );
+
+  aabb_tree_geometry tree;
+  OpenTissue::aabb_tree::init( mesh, tree, binder );
+  OpenTissue::aabb_tree::refit( tree );
+
+  ray_query4_type query4;
+  ray_query8_type query8;
+
+  OpenTissue::utility::Timer<double> duration;
+  duration.start();
+  query8.init( tree.m_bvh );
+  duration.stop();
+  query4.init( tree.m_bvh );
+  std::cout << "flattening BVH with " << mesh.size_faces() << " triangles: " << duration() << " seconds" << std::endl;
+
+  std::vector<vector3_type> p;
+  std::vector<vector3_type> r;
+
+  make_camera_rays( 1024, 1024, p, r );
+  run( "camera", query4, query8, p, r );
+
+  make_random_rays( 1024*1024, p, r );
+  run( "random", query4, query8, p, r );
+
+  return 0;
+}
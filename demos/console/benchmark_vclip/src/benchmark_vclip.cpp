@@ -0,0 +1,204 @@
+//
+// OpenTissue Template Library Demo
+// - A specific demonstration of the flexibility of OTTL.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL and OTTL Demos are licensed under zlib.
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/math/math_random.h>
+#include <OpenTissue/collision/vclip/vclip.h>
+#include <OpenTissue/collision/gjk/gjk.h>
+#include <OpenTissue/utility/utility_timer.h>
+
+#include <iostream>
+#include <cmath>
+
+/**
+@file   This file contains a benchmark test comparing v-clip with GJK on the same convex polyhedra.
+        Both algorithms are run cold started and warm started from a per pair cache on
+        coherent motion, as it occurs in a simulation where the same pairs are tested
+        in every frame.
+*/
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+typedef math_types::vector3_type                         vector3_type;
+typedef math_types::quaternion_type                      quaternion_type;
+typedef math_types::coordsys_type                        coordsys_type;
+typedef math_types::real_type                            real_type;
+typedef OpenTissue::vclip::Geometry<math_types>          geometry_type;
+
+size_t const frames = 10000u;
+
+/**
+* Make a polyhedron that is the convex hull of random points on a sphere.
+*/
+void make_polyhedron(size_t const & N, real_type const & radius, geometry_type & geometry)
+{
+  OpenTissue::polymesh::PolyMesh<> points;
+  for(size_t i=0u;i<N;++i)
+  {
+    vector3_type p;
+    OpenTissue::math::random( p, -1.0, 1.0 );
+    while( p*p < 0.01 )
+      OpenTissue::math::random( p, -1.0, 1.0 );
+    points.add_vertex( unit(p)*radius );
+  }
+  geometry.init( points );
+}
+
+/**
+* Box B orbits box A in small steps, this mimics a simulation with coherent frames.
+*/
+void place(size_t const & i, coordsys_type & Awcs, coordsys_type & Bwcs)
+{
+  real_type const t = 0.001*i;
+  Awcs.T().clear();
+  Awcs.Q().identity();
+  Bwcs.T() = vector3_type( 3.0*std::cos(t), 3.0*std::sin(t), std::sin(5.0*t) );
+  Bwcs.Q().Ru( 3.0*t, vector3_type(0.0,0.0,1.0) );
+}
+
+void vclip_implementation(geometry_type const & A, geometry_type const & B, size_t const & N)
+{
+  OpenTissue::vclip::VClip vclip;
+  vector3_type p_a;
+  vector3_type p_b;
+  coordsys_type Awcs;
+  coordsys_type Bwcs;
+
+  real_type cold_distance = 0.0;
+  OpenTissue::utility::Timer<double> cold_duration;
+  cold_duration.start();
+  for(size_t i=0u;i<frames;++i)
+  {
+    place( i, Awcs, Bwcs );
+    coordsys_type const AtoB = model_update( Awcs, Bwcs );
+    coordsys_type const BtoA = inverse( AtoB );
+
+    OpenTissue::vclip::Feature * seed_a = A.get_seed();
+    OpenTissue::vclip::Feature * seed_b = B.get_seed();
+    cold_distance += vclip.run( A.get_mesh(), B.get_mesh(), AtoB, BtoA, &seed_a, &seed_b, p_a, p_b );
+  }
+  cold_duration.stop();
+
+  OpenTissue::vclip::Cache cache;
+
+  real_type warm_distance = 0.0;
+  OpenTissue::utility::Timer<double> warm_duration;
+  warm_duration.start();
+  for(size_t i=0u;i<frames;++i)
+  {
+    place( i, Awcs, Bwcs );
+    coordsys_type const AtoB = model_update( Awcs, Bwcs );
+    coordsys_type const BtoA = inverse( AtoB );
+
+    OpenTissue::vclip::Feature * seed_a = A.get_seed();
+    OpenTissue::vclip::Feature * seed_b = B.get_seed();
+    cache.get_seeds( &A.get_mesh(), &B.get_mesh(), seed_a, seed_b );
+    warm_distance += vclip.run( A.get_mesh(), B.get_mesh(), AtoB, BtoA, &seed_a, &seed_b, p_a, p_b );
+    cache.set_seeds( &A.get_mesh(), &B.get_mesh(), seed_a, seed_b );
+  }
+  warm_duration.stop();
+
+  std::cout << "vclip cold started " << frames << " coherent test runs (" << N << " points): " << cold_duration() << " seconds, mean distance " << cold_distance/frames << std::endl;
+  std::cout << "vclip warm started " << frames << " coherent test runs (" << N << " points): " << warm_duration() << " seconds, mean distance " << warm_distance/frames << std::endl;
+}
+
+void gjk_implementation(geometry_type const & A, geometry_type const & B, size_t const & N)
+{
+  OpenTissue::gjk::VoronoiSimplexSolverPolicy const simplex_solver_policy = OpenTissue::gjk::VoronoiSimplexSolverPolicy();
+
+  size_t    const max_iterations       = 100u;
+  real_type const absolute_tolerance   = boost::numeric_cast<real_type>(10e-6);
+  real_type const relative_tolerance   = boost::numeric_cast<real_type>(10e-6);
+  real_type const stagnation_tolerance = boost::numeric_cast<real_type>(10e-15);
+
+  vector3_type a;
+  vector3_type b;
+  size_t iterations     = 0u;
+  size_t status         = 0u;
+  real_type distance    = 0.0;
+  coordsys_type Awcs;
+  coordsys_type Bwcs;
+
+  real_type cold_distance = 0.0;
+  size_t cold_iterations = 0u;
+  OpenTissue::utility::Timer<double> cold_duration;
+  cold_duration.start();
+  for(size_t i=0u;i<frames;++i)
+  {
+    place( i, Awcs, Bwcs );
+    OpenTissue::gjk::compute_closest_points(
+      Awcs
+      , A
+      , Bwcs
+      , B
+      , a
+      , b
+      , distance
+      , iterations
+      , status
+      , absolute_tolerance
+      , relative_tolerance
+      , stagnation_tolerance
+      , max_iterations
+      , simplex_solver_policy
+      );
+    cold_distance   += distance;
+    cold_iterations += iterations;
+  }
+  cold_duration.stop();
+
+  OpenTissue::gjk::Cache<vector3_type> cache;
+
+  real_type warm_distance = 0.0;
+  size_t warm_iterations = 0u;
+  OpenTissue::utility::Timer<double> warm_duration;
+  warm_duration.start();
+  for(size_t i=0u;i<frames;++i)
+  {
+    place( i, Awcs, Bwcs );
+    OpenTissue::gjk::compute_closest_points(
+      Awcs
+      , A
+      , Bwcs
+      , B
+      , a
+      , b
+      , distance
+      , iterations
+      , status
+      , cache
+      , absolute_tolerance
+      , relative_tolerance
+      , stagnation_tolerance
+      , max_iterations
+      , simplex_solver_policy
+      );
+    warm_distance   += distance;
+    warm_iterations += iterations;
+  }
+  warm_duration.stop();
+
+  std::cout << "gjk cold started " << frames << " coherent test runs (" << N << " points): " << cold_duration() << " seconds, mean distance " << cold_distance/frames << ", " << (cold_iterations/double(frames)) << " iterations on average" << std::endl;
+  std::cout << "gjk warm started " << frames << " coherent test runs (" << N << " points): " << warm_duration() << " seconds, mean distance " << warm_distance/frames << ", " << (warm_iterations/double(frames)) << " iterations on average" << std::endl;
+}
+
+int main( int argc, char **argv )
+{
+  size_t const sizes[] = { 16u, 64u, 256u };
+  for(size_t i=0u;i<3u;++i)
+  {
+    geometry_type A;
+    geometry_type B;
+    make_polyhedron( sizes[i], 1.0, A );
+    make_polyhedron( sizes[i], 1.0, B );
+
+    vclip_implementation( A, B, sizes[i] );
+    gjk_implementation( A, B, sizes[i] );
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+//
+// OpenTissue Template Library Demo
+// - A specific demonstration of the flexibility of OTTL.
+// Copyright (C) 2008 Department of Computer Science, University of Copenhagen.
+//
+// OTTL and OTTL Demos are licensed under zlib.
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/io/grid_binary_read.h>
+#include <OpenTissue/core/containers/grid/io/grid_compact_write.h>
+#include <OpenTissue/core/containers/grid/io/grid_compact_read.h>
+#include <OpenTissue/utility/utility_memory_mapped_file.h>
+
+#include <iostream>
+#include <string>
+#include <cstring>
+
+/**
+@file   This file contains a tool that converts grids written by grid::binary_write()
+        into the compact grid format, see grid::CompactHeader. Usage:
+
+          grid_compact_convert input output [float32|quantized16|half16] [dense|bricked]
+
+        The value type of the input grid (float or double) is found from the file size.
+*/
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+typedef math_types::real_type                            real_type;
+
+template<typename grid_type>
+int convert(
+  std::string const & input
+  , std::string const & output
+  , OpenTissue::grid::compact_encoding const & encoding
+  , OpenTissue::grid::compact_layout const & layout
+  )
+{
+  grid_type phi;
+  if(!OpenTissue::grid::binary_read( input, phi ))
+    return 1;
+  if(!OpenTissue::grid::compact_write( output, phi, encoding, layout ))
+    return 1;
+
+  OpenTissue::utility::MemoryMappedFile file;
+  if(!file.open( output ))
+    return 1;
+  std::cout << "wrote " << output << ": " << file.size() << " bytes, "
+    << phi.size()*sizeof(typename grid_type::value_type) << " bytes of node values in the input" << std::endl;
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 3)
+  {
+    std::cerr << "usage: " << argv[0] << " input output [float32|quantized16|half16] [dense|bricked]" << std::endl;
+    return 1;
+  }
+  std::string const input  = argv[1];
+  std::string const output = argv[2];
+  std::string const encoding_name = argc > 3 ? argv[3] : "float32";
+  std::string const layout_name   = argc > 4 ? argv[4] : "dense";
+
+  OpenTissue::grid::compact_encoding encoding = OpenTissue::grid::compact_float32;
+  if(encoding_name == "quantized16")
+    encoding = OpenTissue::grid::compact_quantized16;
+  else if(encoding_name == "half16")
+    encoding = OpenTissue::grid::compact_half16;
+  else if(encoding_name != "float32")
+  {
+    std::cerr << "unknown encoding " << encoding_name << std::endl;
+    return 1;
+  }
+
+  OpenTissue::grid::compact_layout layout = OpenTissue::grid::compact_dense;
+  if(layout_name == "bricked")
+    layout = OpenTissue::grid::compact_bricked;
+  else if(layout_name != "dense")
+  {
+    std::cerr << "unknown layout " << layout_name << std::endl;
+    return 1;
+  }
+
+  //--- The binary format does not store the value type, so deduce it from the
+  //--- size of the node values following the header
+  size_t value_size = 0;
+  {
+    OpenTissue::utility::MemoryMappedFile file;
+    size_t const header_size = 4*sizeof(size_t) + 9*sizeof(real_type);
+    if(!file.open( input ) || file.size() < header_size)
+    {
+      std::cerr << "unable to open " << input << std::endl;
+      return 1;
+    }
+    size_t N = 0;
+    std::memcpy( &N, file.data() + 3*sizeof(size_t), sizeof(size_t) );
+    if(N > 0)
+      value_size = (file.size() - header_size) / N;
+  }
+
+  if(value_size == sizeof(float))
+    return convert< OpenTissue::grid::Grid<float,math_types> >( input, output, encoding, layout );
+  if(value_size == sizeof(double))
+    return convert< OpenTissue::grid::Grid<double,math_types> >( input, output, encoding, layout );
+
+  std::cerr << input << " is not a binary grid file with float or double values" << std::endl;
+  return 1;
+}
@@ -0,0 +1,248 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/math/math_random.h>
+#include <OpenTissue/collision/collision_box_box_improved.h>
+#include <OpenTissue/collision/collision_box_box_batch.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <vector>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>  math_types;
+typedef math_types::real_type                             real_type;
+typedef math_types::vector3_type                          vector3_type;
+typedef math_types::matrix3x3_type                        matrix3x3_type;
+
+/**
+ * Generates box pairs with random extents, orientations and positions. The
+ * positions are chosen such that roughly half of the box pairs overlap.
+ */
+void make_box_pairs(
+  size_t count
+  , std::vector<vector3_type> & p_a
+  , std::vector<matrix3x3_type> & R_a
+  , std::vector<vector3_type> & ext_a
+  , std::vector<vector3_type> & p_b
+  , std::vector<matrix3x3_type> & R_b
+  , std::vector<vector3_type> & ext_b
+  )
+{
+  OpenTissue::math::Random<real_type> random(0.0,1.0);
+
+  p_a.resize(count);
+  R_a.resize(count);
+  ext_a.resize(count);
+  p_b.resize(count);
+  R_b.resize(count);
+  ext_b.resize(count);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    ext_a[i] = vector3_type( 0.2 + random(), 0.2 + random(), 0.2 + random() );
+    ext_b[i] = vector3_type( 0.2 + random(), 0.2 + random(), 0.2 + random() );
+    p_a[i]   = vector3_type( 4.0*(random() - 0.5), 4.0*(random() - 0.5), 4.0*(random() - 0.5) );
+    p_b[i]   = p_a[i] + vector3_type( 3.0*(random() - 0.5), 3.0*(random() - 0.5), 3.0*(random() - 0.5) );
+    R_a[i]   = OpenTissue::math::Rx( 6.0*random() ) * OpenTissue::math::Ry( 6.0*random() ) * OpenTissue::math::Rz( 6.0*random() );
+    R_b[i]   = OpenTissue::math::Rx( 6.0*random() ) * OpenTissue::math::Ry( 6.0*random() ) * OpenTissue::math::Rz( 6.0*random() );
+  }
+}
+
+/**
+ * Generates resting box pairs, box B lies on top of box A with a small
+ * penetration, a small tilt and a random offset within the top face of A.
+ */
+void make_stacked_box_pairs(
+  size_t count
+  , std::vector<vector3_type> & p_a
+  , std::vector<matrix3x3_type> & R_a
+  , std::vector<vector3_type> & ext_a
+  , std::vector<vector3_type> & p_b
+  , std::vector<matrix3x3_type> & R_b
+  , std::vector<vector3_type> & ext_b
+  )
+{
+  OpenTissue::math::Random<real_type> random(0.0,1.0);
+
+  p_a.resize(count);
+  R_a.resize(count);
+  ext_a.resize(count);
+  p_b.resize(count);
+  R_b.resize(count);
+  ext_b.resize(count);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    ext_a[i] = vector3_type( 0.5 + random(), 0.5 + random(), 0.2 + random() );
+    ext_b[i] = vector3_type( 0.5 + random(), 0.5 + random(), 0.2 + random() );
+    p_a[i]   = vector3_type( 10.0*(random() - 0.5), 10.0*(random() - 0.5), 10.0*random() );
+    //--- Every other stack is axis aligned, which exercises the truncation of the box axes
+    R_a[i]   = (i%2) ? OpenTissue::math::Rz( 6.0*random() ) : OpenTissue::math::Rz( 0.0 );
+    R_b[i]   = R_a[i] * OpenTissue::math::Rz( (i%2) ? 0.5*(random() - 0.5) : 0.0 ) * OpenTissue::math::Rx( 0.002*(random() - 0.5) );
+    real_type const penetration = 0.001 + 0.01*random();
+    vector3_type const offset( 0.5*(random() - 0.5), 0.5*(random() - 0.5), ext_a[i](2) + ext_b[i](2) - penetration );
+    p_b[i]   = p_a[i] + R_a[i]*offset;
+  }
+}
+
+/**
+ * Runs box_box_batch() on the box pairs and compares the contacts with
+ * box_box_improved().
+ */
+void check_batch_matches_box_box_improved(
+  std::vector<vector3_type> const & p_a
+  , std::vector<matrix3x3_type> const & R_a
+  , std::vector<vector3_type> const & ext_a
+  , std::vector<vector3_type> const & p_b
+  , std::vector<matrix3x3_type> const & R_b
+  , std::vector<vector3_type> const & ext_b
+  , real_type const & envelope
+  , size_t & colliding
+  , size_t & single_contacts
+  )
+{
+  size_t const count = p_a.size();
+  unsigned int const stride = OpenTissue::collision::detail::box_box_max_contacts;
+
+  std::vector<vector3_type> p( stride*count );
+  std::vector<vector3_type> n( count );
+  std::vector<real_type>    distances( stride*count );
+  std::vector<unsigned int> contacts( count );
+
+  size_t total = OpenTissue::collision::box_box_batch(
+    count
+    , &p_a[0], &R_a[0], &ext_a[0]
+    , &p_b[0], &R_b[0], &ext_b[0]
+    , envelope
+    , stride
+    , &p[0], &n[0], &distances[0], &contacts[0]
+    );
+
+  size_t expected_total = 0;
+  colliding = 0;
+  single_contacts = 0;
+  for(size_t i = 0; i < count; ++i)
+  {
+    vector3_type p_expected[OpenTissue::collision::detail::box_box_max_contacts];
+    vector3_type n_expected;
+    real_type    distances_expected[OpenTissue::collision::detail::box_box_max_contacts];
+
+    unsigned int const expected = OpenTissue::collision::box_box_improved(
+      p_a[i], R_a[i], ext_a[i]
+      , p_b[i], R_b[i], ext_b[i]
+      , envelope
+      , p_expected, n_expected, distances_expected
+      );
+
+    expected_total += expected;
+    if(expected > 0)
+      ++colliding;
+    if(expected == 1)
+      ++single_contacts;
+
+    BOOST_CHECK_EQUAL( contacts[i], expected );
+    if( contacts[i] != expected )
+      continue;
+
+    if( expected > 0 )
+      BOOST_CHECK( n[i].is_equal( n_expected, 1e-10 ) );
+
+    for(unsigned int j = 0; j < expected; ++j)
+    {
+      BOOST_CHECK( p[stride*i+j].is_equal( p_expected[j], 1e-10 ) );
+      BOOST_CHECK_CLOSE( distances[stride*i+j], distances_expected[j], 1e-6 );
+      BOOST_CHECK( distances[stride*i+j] < envelope );
+    }
+  }
+
+  BOOST_CHECK_EQUAL( total, expected_total );
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_box_box);
+
+BOOST_AUTO_TEST_CASE(batch_matches_box_box_improved)
+{
+  std::vector<vector3_type>   p_a;
+  std::vector<matrix3x3_type> R_a;
+  std::vector<vector3_type>   ext_a;
+  std::vector<vector3_type>   p_b;
+  std::vector<matrix3x3_type> R_b;
+  std::vector<vector3_type>   ext_b;
+
+  size_t const count = 4003;
+  make_box_pairs( count, p_a, R_a, ext_a, p_b, R_b, ext_b );
+
+  size_t colliding = 0;
+  size_t edge_cases = 0;
+  check_batch_matches_box_box_improved( p_a, R_a, ext_a, p_b, R_b, ext_b, 0.01, colliding, edge_cases );
+
+  //--- Make sure the test actually exercises separated, face and edge-edge cases
+  BOOST_CHECK( colliding > count/4 );
+  BOOST_CHECK( colliding < count );
+  BOOST_CHECK( edge_cases > 0 );
+  BOOST_CHECK( edge_cases < colliding );
+}
+
+BOOST_AUTO_TEST_CASE(batch_matches_box_box_improved_on_stacks)
+{
+  std::vector<vector3_type>   p_a;
+  std::vector<matrix3x3_type> R_a;
+  std::vector<vector3_type>   ext_a;
+  std::vector<vector3_type>   p_b;
+  std::vector<matrix3x3_type> R_b;
+  std::vector<vector3_type>   ext_b;
+
+  size_t const count = 1001;
+  make_stacked_box_pairs( count, p_a, R_a, ext_a, p_b, R_b, ext_b );
+
+  size_t colliding = 0;
+  size_t single_contacts = 0;
+  check_batch_matches_box_box_improved( p_a, R_a, ext_a, p_b, R_b, ext_b, 0.01, colliding, single_contacts );
+
+  BOOST_CHECK_EQUAL( colliding, count );
+  BOOST_CHECK( single_contacts < count/4 );
+}
+
+BOOST_AUTO_TEST_CASE(overlap_batch_is_conservative)
+{
+  size_t const count = 2000;
+  real_type const envelope = 0.0;
+
+  std::vector<vector3_type>   p_a;
+  std::vector<matrix3x3_type> R_a;
+  std::vector<vector3_type>   ext_a;
+  std::vector<vector3_type>   p_b;
+  std::vector<matrix3x3_type> R_b;
+  std::vector<vector3_type>   ext_b;
+
+  make_box_pairs( count, p_a, R_a, ext_a, p_b, R_b, ext_b );
+
+  std::vector<int> overlap( count );
+  OpenTissue::collision::box_box_overlap_batch( count, &p_a[0], &R_a[0], &ext_a[0], &p_b[0], &R_b[0], &ext_b[0], envelope, &overlap[0] );
+
+  size_t culled = 0;
+  for(size_t i = 0; i < count; ++i)
+  {
+    vector3_type p[OpenTissue::collision::detail::box_box_max_contacts];
+    vector3_type n;
+    real_type    distances[OpenTissue::collision::detail::box_box_max_contacts];
+    unsigned int contacts = OpenTissue::collision::box_box_improved( p_a[i], R_a[i], ext_a[i], p_b[i], R_b[i], ext_b[i], envelope, p, n, distances );
+    if(contacts > 0)
+      BOOST_CHECK( overlap[i] );
+    if(!overlap[i])
+      ++culled;
+  }
+  BOOST_CHECK( culled > 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,458 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/math/math_random.h>
+#include <OpenTissue/core/containers/mesh/mesh.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_geometry.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_init.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_refit.h>
+#include <OpenTissue/collision/aabb_tree/policies/aabb_tree_distance_policy.h>
+#include <OpenTissue/collision/bvh/bvh_distance_query.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <vector>
+#include <list>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>  math_types;
+typedef math_types::real_type                             real_type;
+typedef math_types::vector3_type                          vector3_type;
+typedef OpenTissue::polymesh::PolyMesh<math_types>        mesh_type;
+
+class Vertex
+{
+public:
+
+  vector3_type m_x;
+
+  vector3_type const & position() const { return m_x; }
+
+};
+
+typedef OpenTissue::aabb_tree::Geometry<real_type, Vertex>                   aabb_tree_geometry;
+typedef aabb_tree_geometry::bvh_type                                         bvh_type;
+typedef aabb_tree_geometry::geometry_type                                    triangle_type;
+typedef OpenTissue::aabb_tree::DistancePolicy<aabb_tree_geometry>            distance_policy;
+typedef OpenTissue::bvh::DistanceQuery<bvh_type, distance_policy>            distance_query_type;
+typedef distance_query_type::hit_type                                        hit_type;
+
+/**
+ * Binds the vertices of the mesh to the vertex data used by the AABB tree.
+ */
+class Binder
+{
+public:
+
+  std::vector<Vertex>                          m_vertices;
+  std::map<mesh_type::vertex_type *, Vertex *> m_lut;
+
+  Vertex * operator()(mesh_type::vertex_type * v) { return m_lut[v]; }
+
+};
+
+/**
+ * Creates a triangulated bumpy sphere, the bumps makes sure that
+ * closest points are found on all kinds of features.
+ */
+void make_bumpy_sphere(unsigned int slices, unsigned int segments, mesh_type & mesh, Binder & binder)
+{
+  using std::cos;
+  using std::sin;
+
+  real_type const pi = OpenTissue::math::detail::pi<real_type>();
+
+  mesh.clear();
+  std::vector<mesh_type::vertex_handle> grid;
+  mesh_type::vertex_handle south = mesh.add_vertex( vector3_type(0.0, 0.0, -1.0) );
+  mesh_type::vertex_handle north = mesh.add_vertex( vector3_type(0.0, 0.0,  1.0) );
+  for(unsigned int k = 1; k < segments; ++k)
+  {
+    real_type const theta = pi*k/segments;
+    for(unsigned int i = 0; i < slices; ++i)
+    {
+      real_type const phi    = 2.0*pi*i/slices;
+      real_type const radius = 1.0 + 0.2*sin(5.0*phi)*sin(3.0*theta);
+      grid.push_back( mesh.add_vertex( vector3_type( radius*sin(theta)*cos(phi), radius*sin(theta)*sin(phi), -radius*cos(theta) ) ) );
+    }
+  }
+  for(unsigned int i = 0; i < slices; ++i)
+  {
+    unsigned int const j = (i + 1) % slices;
+    mesh.add_face( south, grid[j], grid[i] );
+    mesh.add_face( north, grid[(segments-2)*slices + i], grid[(segments-2)*slices + j] );
+    for(unsigned int k = 0; k + 2 < segments; ++k)
+    {
+      mesh.add_face( grid[k*slices + i], grid[k*slices + j], grid[(k+1)*slices + j] );
+      mesh.add_face( grid[k*slices + i], grid[(k+1)*slices + j], grid[(k+1)*slices + i] );
+    }
+  }
+
+  binder.m_vertices.resize( mesh.size_vertices() );
+  size_t n = 0;
+  for(mesh_type::vertex_iterator v = mesh.vertex_begin(); v != mesh.vertex_end(); ++v, ++n)
+  {
+    binder.m_vertices[n].m_x = v->m_coord;
+    binder.m_lut[ &(*v) ] = &binder.m_vertices[n];
+  }
+}
+
+void make_points(size_t count, std::vector<vector3_type> & p)
+{
+  OpenTissue::math::Random<real_type> random(-1.0,1.0);
+
+  p.resize(count);
+  for(size_t i = 0; i < count; ++i)
+  {
+    //--- Mix points from the inside, near the surface and far away
+    real_type const scale = (i%3 == 0) ? 0.5 : ( (i%3 == 1) ? 1.3 : 4.0 );
+    p[i] = vector3_type( scale*random(), scale*random(), scale*random() );
+  }
+}
+
+void collect_triangles(aabb_tree_geometry const & tree, std::list<triangle_type> & triangles)
+{
+  bvh_type::bv_ptr_container leaves;
+  OpenTissue::bvh::get_leaf_nodes( tree.m_bvh, leaves );
+  for(bvh_type::bv_ptr_iterator leaf = leaves.begin(); leaf != leaves.end(); ++leaf)
+  {
+    bvh_type::annotated_bv_ptr annotated = boost::static_pointer_cast<bvh_type::annotated_bv_type>( *leaf );
+    triangles.insert( triangles.end(), annotated->geometry_begin(), annotated->geometry_end() );
+  }
+}
+
+/**
+ * Computes the distances from a point to all triangles, sorted increasingly.
+ */
+std::vector<real_type> brute_force(std::list<triangle_type> const & triangles, vector3_type const & p)
+{
+  distance_policy policy;
+  std::vector<real_type> distances;
+  for(std::list<triangle_type>::const_iterator tri = triangles.begin(); tri != triangles.end(); ++tri)
+  {
+    vector3_type q;
+    distances.push_back( std::sqrt( policy.closest_point( *tri, p, q ) ) );
+  }
+  std::sort( distances.begin(), distances.end() );
+  return distances;
+}
+
+/**
+ * Collects the corners of the triangles, scaled and translated.
+ */
+void make_corners(std::list<triangle_type> const & triangles, real_type const & scale, vector3_type const & offset, std::vector<vector3_type> & corners)
+{
+  corners.clear();
+  for(std::list<triangle_type>::const_iterator tri = triangles.begin(); tri != triangles.end(); ++tri)
+  {
+    corners.push_back( tri->m_p0->position()*scale + offset );
+    corners.push_back( tri->m_p1->position()*scale + offset );
+    corners.push_back( tri->m_p2->position()*scale + offset );
+  }
+}
+
+/**
+ * Computes the smallest distance from a triangle to all triangles.
+ */
+real_type brute_force(std::list<triangle_type> const & triangles, vector3_type const & a, vector3_type const & b, vector3_type const & c)
+{
+  distance_policy policy;
+  real_type best = -1.0;
+  for(std::list<triangle_type>::const_iterator tri = triangles.begin(); tri != triangles.end(); ++tri)
+  {
+    vector3_type p;
+    vector3_type q;
+    real_type const d = std::sqrt( policy.closest_points( *tri, a, b, c, p, q ) );
+    if( best < 0.0 || d < best )
+      best = d;
+  }
+  return best;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_distance_query);
+
+BOOST_AUTO_TEST_CASE(closest_point_on_triangle)
+{
+  OpenTissue::math::Random<real_type> random(-1.0,1.0);
+
+  Vertex v0, v1, v2;
+  triangle_type triangle;
+  triangle.m_p0 = &v0;
+  triangle.m_p1 = &v1;
+  triangle.m_p2 = &v2;
+
+  distance_policy policy;
+  for(size_t i = 0; i < 1000; ++i)
+  {
+    v0.m_x = vector3_type( random(), random(), random() );
+    v1.m_x = vector3_type( random(), random(), random() );
+    v2.m_x = (i%10 == 0) ? (v0.m_x + v1.m_x)*0.5 : vector3_type( random(), random(), random() );
+    vector3_type const p( 2.0*random(), 2.0*random(), 2.0*random() );
+
+    vector3_type q;
+    real_type const d2 = policy.closest_point( triangle, p, q );
+    BOOST_CHECK_CLOSE( d2, inner_prod( p - q, p - q ), 1e-8 );
+
+    //--- No sampled point of the triangle is closer than the closest point
+    for(size_t a = 0; a <= 20; ++a)
+      for(size_t b = 0; a + b <= 20; ++b)
+      {
+        vector3_type const x = v0.m_x + (v1.m_x - v0.m_x)*(a/20.0) + (v2.m_x - v0.m_x)*(b/20.0);
+        BOOST_CHECK( d2 <= inner_prod( p - x, p - x ) + 1e-12 );
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(closest_points_between_triangles)
+{
+  OpenTissue::math::Random<real_type> random(-1.0,1.0);
+
+  Vertex v0, v1, v2;
+  triangle_type triangle;
+  triangle.m_p0 = &v0;
+  triangle.m_p1 = &v1;
+  triangle.m_p2 = &v2;
+
+  distance_policy policy;
+  size_t intersecting = 0;
+  for(size_t i = 0; i < 300; ++i)
+  {
+    v0.m_x = vector3_type( random(), random(), random() );
+    v1.m_x = vector3_type( random(), random(), random() );
+    v2.m_x = (i%10 == 0) ? (v0.m_x + v1.m_x)*0.5 : vector3_type( random(), random(), random() );
+    vector3_type const offset( random(), random(), random() );
+    vector3_type const a = vector3_type( random(), random(), random() ) + offset;
+    vector3_type const b = vector3_type( random(), random(), random() ) + offset;
+    vector3_type const c = (i%10 == 5) ? (a + b)*0.5 : vector3_type( random(), random(), random() ) + offset;
+
+    vector3_type p;
+    vector3_type q;
+    real_type const d2 = policy.closest_points( triangle, a, b, c, p, q );
+    BOOST_CHECK_CLOSE( d2 + 1.0, inner_prod( p - q, p - q ) + 1.0, 1e-8 );
+    if( d2 == 0.0 )
+      ++intersecting;
+
+    //--- The closest points lie on the triangles
+    vector3_type x;
+    BOOST_CHECK( policy.closest_point( triangle, p, x ) < 1e-20 );
+    BOOST_CHECK( policy.closest_point( triangle, q, x ) <= d2 + 1e-12 );
+
+    //--- No sampled pair of points of the triangles is closer than the closest points
+    std::vector<vector3_type> samples;
+    for(size_t s = 0; s <= 10; ++s)
+      for(size_t t = 0; s + t <= 10; ++t)
+        samples.push_back( a + (b - a)*(s/10.0) + (c - a)*(t/10.0) );
+    for(size_t s = 0; s <= 10; ++s)
+      for(size_t t = 0; s + t <= 10; ++t)
+      {
+        vector3_type const y = v0.m_x + (v1.m_x - v0.m_x)*(s/10.0) + (v2.m_x - v0.m_x)*(t/10.0);
+        for(size_t k = 0; k < samples.size(); ++k)
+          BOOST_CHECK( d2 <= inner_prod( y - samples[k], y - samples[k] ) + 1e-12 );
+      }
+  }
+  BOOST_CHECK( intersecting > 0 );
+
+  //--- A triangle piercing the interior of another triangle
+  v0.m_x = vector3_type( 0.0, 0.0, 0.0 );
+  v1.m_x = vector3_type( 1.0, 0.0, 0.0 );
+  v2.m_x = vector3_type( 0.0, 1.0, 0.0 );
+  vector3_type p;
+  vector3_type q;
+  BOOST_CHECK_EQUAL( policy.closest_points( triangle, vector3_type( 0.2, 0.2, -1.0 ), vector3_type( 0.3, 0.2, 1.0 ), vector3_type( 0.2, 0.3, 1.0 ), p, q ), 0.0 );
+  BOOST_CHECK( std::fabs( p(2) ) < 1e-12 && p(0) >= 0.2 && p(1) >= 0.2 && p(0) + p(1) <= 0.5 );
+  BOOST_CHECK_EQUAL( policy.closest_points( triangle, vector3_type( 0.2, 0.2, 0.5 ), vector3_type( 0.3, 0.2, 0.5 ), vector3_type( 0.2, 0.3, 0.5 ), p, q ), 0.25 );
+}
+
+BOOST_AUTO_TEST_CASE(closest_k_nearest_and_radius)
+{
+  mesh_type mesh;
+  Binder binder;
+  make_bumpy_sphere( 24, 12, mesh, binder );
+
+  aabb_tree_geometry tree;
+  OpenTissue::aabb_tree::init( mesh, tree, binder );
+  OpenTissue::aabb_tree::refit( tree );
+
+  std::list<triangle_type> triangles;
+  collect_triangles( tree, triangles );
+  BOOST_CHECK_EQUAL( triangles.size(), mesh.size_faces() );
+
+  distance_query_type query;
+  query.init( tree.m_bvh );
+
+  std::vector<vector3_type> p;
+  make_points( 300, p );
+
+  real_type const max_distance = 2.0;
+  size_t const    k            = 5;
+  real_type const radius       = 0.3;
+  size_t found  = 0;
+  size_t missed = 0;
+  for(size_t i = 0; i < p.size(); ++i)
+  {
+    std::vector<real_type> const expected = brute_force( triangles, p[i] );
+
+    hit_type hit;
+    bool const closest = query.closest_point( p[i], max_distance, hit );
+    BOOST_CHECK_EQUAL( closest, expected[0] <= max_distance );
+    if(closest)
+    {
+      BOOST_CHECK_CLOSE( hit.m_distance, expected[0], 1e-8 );
+      BOOST_CHECK_CLOSE( length( p[i] - hit.m_point ), expected[0], 1e-8 );
+      ++found;
+    }
+    else
+      ++missed;
+
+    std::vector<hit_type> hits;
+    size_t const expected_k = std::upper_bound( expected.begin(), expected.begin() + k, max_distance ) - expected.begin();
+    BOOST_CHECK_EQUAL( query.k_nearest( p[i], k, max_distance, hits ), expected_k );
+    for(size_t j = 0; j < hits.size() && j < expected_k; ++j)
+      BOOST_CHECK_CLOSE( hits[j].m_distance, expected[j], 1e-8 );
+
+    size_t const expected_r = std::upper_bound( expected.begin(), expected.end(), radius ) - expected.begin();
+    BOOST_CHECK_EQUAL( query.within_radius( p[i], radius, hits ), expected_r );
+    for(size_t j = 0; j < hits.size() && j < expected_r; ++j)
+      BOOST_CHECK_CLOSE( hits[j].m_distance, expected[j], 1e-8 );
+  }
+  BOOST_CHECK( found > 0 );
+  BOOST_CHECK( missed > 0 );
+}
+
+BOOST_AUTO_TEST_CASE(guesses_and_batches)
+{
+  mesh_type mesh;
+  Binder binder;
+  make_bumpy_sphere( 32, 16, mesh, binder );
+
+  aabb_tree_geometry tree;
+  OpenTissue::aabb_tree::init( mesh, tree, binder );
+  OpenTissue::aabb_tree::refit( tree );
+
+  std::list<triangle_type> triangles;
+  collect_triangles( tree, triangles );
+
+  distance_query_type query;
+  query.init( tree.m_bvh );
+
+  size_t const count = 1000;
+  std::vector<vector3_type> p;
+  make_points( count, p );
+
+  real_type const max_distance = 10.0;
+  std::vector<hit_type> batch( count );
+  query.closest_point( count, &p[0], max_distance, &batch[0] );
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    hit_type hit;
+    BOOST_CHECK( query.closest_point( p[i], max_distance, hit ) );
+    BOOST_CHECK_EQUAL( batch[i].m_distance, hit.m_distance );
+
+    //--- Any guess, good or bad, gives the same distance
+    hit_type guessed;
+    BOOST_CHECK( query.closest_point( p[i], max_distance, guessed, &triangles.front() ) );
+    BOOST_CHECK_EQUAL( guessed.m_distance, hit.m_distance );
+  }
+
+  //--- Move the points a little and reuse the previous results as starting guesses
+  for(size_t i = 0; i < count; ++i)
+    p[i] += vector3_type( 0.01, -0.02, 0.01 );
+  query.closest_point( count, &p[0], max_distance, &batch[0], true );
+  for(size_t i = 0; i < count; ++i)
+  {
+    hit_type hit;
+    query.closest_point( p[i], max_distance, hit );
+    BOOST_CHECK_EQUAL( batch[i].m_distance, hit.m_distance );
+  }
+
+  //--- Nothing is found within a too small distance
+  hit_type hit;
+  BOOST_CHECK( !query.closest_point( vector3_type( 5.0, 5.0, 5.0 ), 1.0, hit ) );
+  BOOST_CHECK( !hit.m_geometry );
+}
+
+BOOST_AUTO_TEST_CASE(triangle_and_mesh_distance)
+{
+  mesh_type mesh;
+  Binder binder;
+  make_bumpy_sphere( 24, 12, mesh, binder );
+
+  aabb_tree_geometry tree;
+  OpenTissue::aabb_tree::init( mesh, tree, binder );
+  OpenTissue::aabb_tree::refit( tree );
+
+  std::list<triangle_type> triangles;
+  collect_triangles( tree, triangles );
+
+  distance_query_type query;
+  query.init( tree.m_bvh );
+
+  //--- A smaller bumpy sphere inside, crossing, near and far away from the tree
+  mesh_type other;
+  Binder other_binder;
+  make_bumpy_sphere( 16, 8, other, other_binder );
+  aabb_tree_geometry other_tree;
+  OpenTissue::aabb_tree::init( other, other_tree, other_binder );
+  std::list<triangle_type> other_triangles;
+  collect_triangles( other_tree, other_triangles );
+
+  vector3_type const offsets[4] = { vector3_type( 0.1, 0.0, -0.1 ), vector3_type( 1.0, 0.2, 0.0 ), vector3_type( 0.0, 1.6, 0.3 ), vector3_type( 4.0, 4.0, 4.0 ) };
+  real_type const max_distance = 3.0;
+  for(size_t o = 0; o < 4; ++o)
+  {
+    std::vector<vector3_type> corners;
+    make_corners( other_triangles, 0.3, offsets[o], corners );
+    size_t const count = corners.size() / 3;
+
+    real_type expected = -1.0;
+    for(size_t i = 0; i < count; ++i)
+    {
+      real_type const d = brute_force( triangles, corners[3*i], corners[3*i+1], corners[3*i+2] );
+      if( expected < 0.0 || d < expected )
+        expected = d;
+
+      hit_type hit;
+      vector3_type q;
+      bool const found = query.triangle_distance( corners[3*i], corners[3*i+1], corners[3*i+2], max_distance, hit, q );
+      BOOST_CHECK_EQUAL( found, d <= max_distance );
+      if( found )
+      {
+        BOOST_CHECK_CLOSE( hit.m_distance + 1.0, d + 1.0, 1e-8 );
+        BOOST_CHECK_CLOSE( length( hit.m_point - q ) + 1.0, d + 1.0, 1e-8 );
+      }
+    }
+
+    hit_type hit;
+    vector3_type q;
+    size_t triangle = count;
+    bool const found = query.mesh_distance( count, &corners[0], max_distance, hit, q, triangle );
+    BOOST_CHECK_EQUAL( found, expected <= max_distance );
+    if( found )
+    {
+      BOOST_CHECK_CLOSE( hit.m_distance + 1.0, expected + 1.0, 1e-8 );
+      BOOST_CHECK( triangle < count );
+      BOOST_CHECK_CLOSE( brute_force( triangles, corners[3*triangle], corners[3*triangle+1], corners[3*triangle+2] ) + 1.0, expected + 1.0, 1e-8 );
+    }
+    else
+      BOOST_CHECK_EQUAL( triangle, count );
+    if( o == 1 )
+      BOOST_CHECK_EQUAL( expected, 0.0 );
+    if( o == 2 )
+      BOOST_CHECK( expected > 0.0 );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
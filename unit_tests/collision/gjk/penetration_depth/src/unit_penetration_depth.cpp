@@ -0,0 +1,350 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/collision/gjk/gjk_compute_penetration_depth.h>
+#include <OpenTissue/collision/gjk/gjk_support_functors.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <cmath>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+
+typedef math_types::vector3_type                         vector3_type;
+typedef math_types::quaternion_type                      quaternion_type;
+typedef math_types::real_type                            real_type;
+typedef math_types::coordsys_type                        transformation_type;
+typedef math_types::value_traits                         value_traits;
+
+OpenTissue::gjk::VoronoiSimplexSolverPolicy const simplex_solver_policy = OpenTissue::gjk::VoronoiSimplexSolverPolicy();
+
+size_t    const max_iterations       = 250u;
+real_type const absolute_tolerance   = boost::numeric_cast<real_type>(10e-7);
+real_type const relative_tolerance   = boost::numeric_cast<real_type>(10e-10);
+real_type const stagnation_tolerance = boost::numeric_cast<real_type>(10e-15);
+
+template<typename support_functor1, typename support_functor2>
+bool penetration_depth(
+  transformation_type const & transformA
+  , support_functor1 const & supportA
+  , transformation_type const & transformB
+  , support_functor2 const & supportB
+  , real_type & depth
+  , vector3_type & normal
+  )
+{
+  vector3_type a;
+  vector3_type b;
+  size_t iterations = 0u;
+  size_t status     = 0u;
+  OpenTissue::gjk::Simplex<vector3_type> sigma;
+
+  bool const overlap = OpenTissue::gjk::compute_penetration_depth(
+    transformA, supportA, transformB, supportB
+    , a, b, depth, normal, iterations, status, sigma
+    , absolute_tolerance, relative_tolerance, stagnation_tolerance, max_iterations
+    , simplex_solver_policy
+    );
+
+  // The contact points and normal must always agree with the depth
+  BOOST_CHECK( (a - b).is_equal( depth*normal, 10e-6 ) );
+  return overlap;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_gjk_compute_penetration_depth);
+
+BOOST_AUTO_TEST_CASE(overlapping_boxes)
+{
+  OpenTissue::gjk::Box<math_types> supportA;
+  OpenTissue::gjk::Box<math_types> supportB;
+  supportA.half_extent() = vector3_type(1.0,1.0,1.0);
+  supportB.half_extent() = vector3_type(1.0,1.0,1.0);
+
+  transformation_type transformA;
+  transformation_type transformB;
+  transformA.T().clear();
+  transformA.Q().identity();
+  transformB.T() = vector3_type(1.5,0.1,0.2);
+  transformB.Q().identity();
+
+  real_type    depth;
+  vector3_type normal;
+
+  BOOST_CHECK( penetration_depth( transformA, supportA, transformB, supportB, depth, normal ) );
+  BOOST_CHECK_CLOSE( depth, 0.5, 10e-4 );
+  BOOST_CHECK( normal.is_equal( vector3_type(1.0,0.0,0.0), 10e-6 ) );
+
+  // Swapping the objects must flip the normal
+  BOOST_CHECK( penetration_depth( transformB, supportB, transformA, supportA, depth, normal ) );
+  BOOST_CHECK_CLOSE( depth, 0.5, 10e-4 );
+  BOOST_CHECK( normal.is_equal( vector3_type(-1.0,0.0,0.0), 10e-6 ) );
+
+  // Coincident boxes, GJK terminates with the origin on a vertex of the simplex
+  transformB.T().clear();
+  BOOST_CHECK( penetration_depth( transformA, supportA, transformB, supportB, depth, normal ) );
+  BOOST_CHECK_CLOSE( depth, 2.0, 10e-4 );
+}
+
+BOOST_AUTO_TEST_CASE(overlapping_spheres)
+{
+  OpenTissue::gjk::Sphere<math_types> supportA;
+  OpenTissue::gjk::Sphere<math_types> supportB;
+
+  transformation_type transformA;
+  transformation_type transformB;
+  transformA.T() = vector3_type(0.2,-0.3,0.1);
+  transformA.Q().identity();
+  transformB.Q().identity();
+
+  vector3_type const d = unit( vector3_type(1.0,2.0,-0.5) );
+  for(int i = 1; i < 10; ++i)
+  {
+    real_type const separation = 0.2*i;
+    transformB.T() = transformA.T() + separation*d;
+
+    real_type    depth;
+    vector3_type normal;
+    BOOST_CHECK( penetration_depth( transformA, supportA, transformB, supportB, depth, normal ) );
+    BOOST_CHECK_CLOSE( depth, 2.0 - separation, 0.1 );
+    BOOST_CHECK( length( normal - d ) < 0.01 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(separated_objects)
+{
+  OpenTissue::gjk::Box<math_types>    supportA;
+  OpenTissue::gjk::Sphere<math_types> supportB;
+  supportA.half_extent() = vector3_type(1.0,1.0,1.0);
+
+  transformation_type transformA;
+  transformation_type transformB;
+  transformA.T().clear();
+  transformA.Q().identity();
+  transformB.T() = vector3_type(0.0,0.0,3.0);
+  transformB.Q().identity();
+
+  real_type    depth;
+  vector3_type normal;
+  BOOST_CHECK( !penetration_depth( transformA, supportA, transformB, supportB, depth, normal ) );
+  BOOST_CHECK_CLOSE( depth, -1.0, 10e-4 );
+  BOOST_CHECK( normal.is_equal( vector3_type(0.0,0.0,1.0), 10e-6 ) );
+}
+
+BOOST_AUTO_TEST_CASE(flat_objects)
+{
+  // Two overlapping squares in the same plane, the Minkowsky difference is flat
+  OpenTissue::gjk::Box<math_types> supportA;
+  OpenTissue::gjk::Box<math_types> supportB;
+  supportA.half_extent() = vector3_type(1.0,1.0,0.0);
+  supportB.half_extent() = vector3_type(0.5,0.5,0.0);
+
+  transformation_type transformA;
+  transformation_type transformB;
+  transformA.T().clear();
+  transformA.Q().identity();
+  transformB.T() = vector3_type(0.3,-0.2,0.0);
+  transformB.Q().Rz( 0.4 );
+
+  vector3_type a;
+  vector3_type b;
+  real_type    depth;
+  vector3_type normal;
+  size_t iterations = 0u;
+  size_t status     = 0u;
+  OpenTissue::gjk::Simplex<vector3_type> sigma;
+
+  BOOST_CHECK( !OpenTissue::gjk::compute_penetration_depth(
+    transformA, supportA, transformB, supportB
+    , a, b, depth, normal, iterations, status, sigma
+    , absolute_tolerance, relative_tolerance, stagnation_tolerance, max_iterations
+    , simplex_solver_policy
+    ) );
+  BOOST_CHECK_EQUAL( status, OpenTissue::gjk::SIMPLEX_EXPANSION_FAILED );
+  BOOST_CHECK_SMALL( depth, 10e-6 );
+  // The normal must be a real direction, orthogonal to the plane of the squares
+  BOOST_CHECK_CLOSE( std::fabs( normal(2) ), 1.0, 10e-4 );
+  BOOST_CHECK( a.is_equal( b, 10e-6 ) );
+}
+
+/**
+* Box support functor with a box center that is offset from the origin of
+* the local frame.
+*/
+class OffsetBox
+{
+public:
+
+  OpenTissue::gjk::Box<math_types> m_box;
+  vector3_type                     m_offset;
+
+  vector3_type operator()(vector3_type const & v) const { return m_box( v ) + m_offset; }
+};
+
+void check_flat_orientation( real_type const & side )
+{
+  // Two overlapping squares in the plane z = 0, placed by frames on either side of the plane
+  OffsetBox supportA;
+  OffsetBox supportB;
+  supportA.m_box.half_extent() = vector3_type(1.0,1.0,0.0);
+  supportB.m_box.half_extent() = vector3_type(0.5,0.5,0.0);
+  supportA.m_offset = vector3_type(0.0,0.0,  side);
+  supportB.m_offset = vector3_type(0.0,0.0, -side);
+
+  transformation_type transformA;
+  transformation_type transformB;
+  transformA.T() = vector3_type(0.0,0.0, -side);
+  transformA.Q().identity();
+  transformB.T() = vector3_type(0.3,-0.2, side);
+  transformB.Q().Rz( 0.4 );
+
+  vector3_type a;
+  vector3_type b;
+  real_type    depth;
+  vector3_type normal;
+  size_t iterations = 0u;
+  size_t status     = 0u;
+  OpenTissue::gjk::Simplex<vector3_type> sigma;
+
+  BOOST_CHECK( !OpenTissue::gjk::compute_penetration_depth(
+    transformA, supportA, transformB, supportB
+    , a, b, depth, normal, iterations, status, sigma
+    , absolute_tolerance, relative_tolerance, stagnation_tolerance, max_iterations
+    , simplex_solver_policy
+    ) );
+  BOOST_CHECK_EQUAL( status, OpenTissue::gjk::SIMPLEX_EXPANSION_FAILED );
+  BOOST_CHECK_EQUAL( iterations, 0u );
+  BOOST_CHECK_SMALL( a(2), 10e-6 );
+  // The normal points from the origin of A towards the origin of B
+  BOOST_CHECK_CLOSE( normal(2), side, 10e-4 );
+}
+
+BOOST_AUTO_TEST_CASE(flat_objects_orientation)
+{
+  check_flat_orientation(  1.0 );
+  check_flat_orientation( -1.0 );
+}
+
+template<typename support_functor>
+void run_coherent_frames( support_functor const & supportB, size_t const & frames, size_t & cold_total, size_t & warm_total )
+{
+  OpenTissue::gjk::Box<math_types> supportA;
+  supportA.half_extent() = vector3_type(1.0,0.5,0.75);
+
+  transformation_type transformA;
+  transformation_type transformB;
+  transformA.T().clear();
+  transformA.Q().identity();
+
+  OpenTissue::gjk::Cache<vector3_type> cache;
+
+  cold_total = 0u;
+  warm_total = 0u;
+  for(size_t frame = 0u; frame < frames; ++frame)
+  {
+    real_type const t = 0.01*frame;
+    transformB.T() = vector3_type( 3.0*std::cos(t), 3.0*std::sin(t), 0.5*std::sin(3.0*t) );
+    transformB.Q().Ru( t, unit( vector3_type(1.0,1.0,0.0) ) );
+
+    vector3_type a_cold;
+    vector3_type b_cold;
+    real_type    distance_cold;
+    size_t       iterations_cold = 0u;
+    size_t       status_cold     = 0u;
+    OpenTissue::gjk::compute_closest_points(
+      transformA, supportA, transformB, supportB
+      , a_cold, b_cold, distance_cold, iterations_cold, status_cold
+      , absolute_tolerance, relative_tolerance, stagnation_tolerance, max_iterations
+      , simplex_solver_policy
+      );
+
+    vector3_type a_warm;
+    vector3_type b_warm;
+    real_type    distance_warm;
+    size_t       iterations_warm = 0u;
+    size_t       status_warm     = 0u;
+    OpenTissue::gjk::compute_closest_points(
+      transformA, supportA, transformB, supportB
+      , a_warm, b_warm, distance_warm, iterations_warm, status_warm
+      , cache
+      , absolute_tolerance, relative_tolerance, stagnation_tolerance, max_iterations
+      , simplex_solver_policy
+      );
+
+    BOOST_CHECK( !cache.empty() );
+    BOOST_CHECK_CLOSE( distance_warm, distance_cold, 10e-3 );
+    BOOST_CHECK( a_warm.is_equal( a_cold, 10e-4 ) );
+    BOOST_CHECK( b_warm.is_equal( b_cold, 10e-4 ) );
+
+    cold_total += iterations_cold;
+    warm_total += iterations_warm;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(warm_started_gjk)
+{
+  size_t const frames = 200u;
+  size_t cold_total = 0u;
+  size_t warm_total = 0u;
+
+  // Polytopes, coherent frames should on average converge within two iterations
+  OpenTissue::gjk::Box<math_types> box;
+  box.half_extent() = vector3_type(0.5,0.25,1.0);
+  run_coherent_frames( box, frames, cold_total, warm_total );
+  BOOST_CHECK( warm_total < cold_total );
+  BOOST_CHECK( warm_total <= 2u*frames );
+
+  // Curved shapes, the support point moves continuously so more iterations are needed
+  OpenTissue::gjk::Cylinder<math_types> cylinder;
+  run_coherent_frames( cylinder, frames, cold_total, warm_total );
+  BOOST_CHECK( warm_total < cold_total );
+}
+
+BOOST_AUTO_TEST_CASE(warm_started_penetration_depth)
+{
+  OpenTissue::gjk::Box<math_types> supportA;
+  OpenTissue::gjk::Box<math_types> supportB;
+  supportA.half_extent() = vector3_type(1.0,1.0,1.0);
+  supportB.half_extent() = vector3_type(0.5,0.5,0.5);
+
+  transformation_type transformA;
+  transformation_type transformB;
+  transformA.T().clear();
+  transformA.Q().identity();
+  transformB.Q().identity();
+
+  OpenTissue::gjk::Cache<vector3_type> cache;
+
+  for(size_t frame = 0u; frame < 50u; ++frame)
+  {
+    // Box B is sinking into the top face of box A
+    transformB.T() = vector3_type( 0.1, -0.2, 1.45 - 0.002*frame );
+
+    vector3_type a;
+    vector3_type b;
+    vector3_type normal;
+    real_type    depth;
+    size_t       iterations = 0u;
+    size_t       status     = 0u;
+    BOOST_CHECK( OpenTissue::gjk::compute_penetration_depth(
+      transformA, supportA, transformB, supportB
+      , a, b, depth, normal, iterations, status, cache
+      , absolute_tolerance, relative_tolerance, stagnation_tolerance, max_iterations
+      , simplex_solver_policy
+      ) );
+
+    BOOST_CHECK_CLOSE( depth, 0.05 + 0.002*frame, 10e-4 );
+    BOOST_CHECK( normal.is_equal( vector3_type(0.0,0.0,1.0), 10e-6 ) );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
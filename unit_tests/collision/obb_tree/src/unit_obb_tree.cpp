@@ -0,0 +1,268 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/collision/obb_tree/obb_tree.h>
+#include <OpenTissue/collision/collision_obb_tree_obb_tree.h>
+#include <OpenTissue/collision/intersect/intersect_obb_obb_sat.h>
+#include <OpenTissue/collision/intersect/intersect_obb_obb_sat_batch.h>
+#include <OpenTissue/core/math/math_random.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+typedef OpenTissue::obb_tree::OBBTreeTypes<>   types;
+typedef types::real_type                       real_type;
+typedef types::vector3_type                    vector3_type;
+typedef types::matrix3x3_type                  matrix3x3_type;
+typedef types::quaternion_type                 quaternion_type;
+typedef types::coordsys_type                   coordsys_type;
+typedef types::obb_type                        obb_type;
+typedef types::mesh_type                       mesh_type;
+typedef types::bvh_type                        bvh_type;
+typedef types::face_ptr_type                   face_ptr_type;
+typedef types::result_type                     result_type;
+typedef types::front_type                      front_type;
+
+/**
+ * Separating axis test by projecting the corners of both boxes onto all
+ * fifteen axes. Returns the largest gap found, positive if separated.
+ */
+real_type projection_gap(obb_type const & A, obb_type const & B)
+{
+  using std::max;
+  using std::min;
+
+  std::vector<vector3_type> PA;
+  std::vector<vector3_type> PB;
+  A.compute_surface_points(PA);
+  B.compute_surface_points(PB);
+
+  std::vector<vector3_type> axes;
+  for(size_t i = 0; i < 3; ++i)
+  {
+    vector3_type const u = A.orientation().column(i);
+    vector3_type const v = B.orientation().column(i);
+    axes.push_back( u );
+    axes.push_back( v );
+    for(size_t j = 0; j < 3; ++j)
+    {
+      vector3_type const w = cross( u, B.orientation().column(j) );
+      if(length(w) > 1e-6)
+        axes.push_back( unit(w) );
+    }
+  }
+
+  real_type gap = -1e30;
+  for(size_t k = 0; k < axes.size(); ++k)
+  {
+    real_type min_a = 1e30, max_a = -1e30, min_b = 1e30, max_b = -1e30;
+    for(size_t i = 0; i < PA.size(); ++i)
+    {
+      min_a = min( min_a, inner_prod( PA[i], axes[k] ) );
+      max_a = max( max_a, inner_prod( PA[i], axes[k] ) );
+    }
+    for(size_t i = 0; i < PB.size(); ++i)
+    {
+      min_b = min( min_b, inner_prod( PB[i], axes[k] ) );
+      max_b = max( max_b, inner_prod( PB[i], axes[k] ) );
+    }
+    gap = max( gap, max( min_b - max_a, min_a - max_b ) );
+  }
+  return gap;
+}
+
+/**
+ * Creates a sphere where every face is a triangle.
+ */
+void make_triangle_sphere(real_type radius, size_t slices, size_t segments, mesh_type & mesh)
+{
+  typedef mesh_type::vertex_handle vertex_handle;
+
+  mesh.clear();
+  vertex_handle const south = mesh.add_vertex( vector3_type( 0, 0, -radius ) );
+  vertex_handle const north = mesh.add_vertex( vector3_type( 0, 0,  radius ) );
+  std::vector<vertex_handle> rings;
+  for(size_t j = 1; j < segments; ++j)
+  {
+    real_type const theta = M_PI*j/segments;
+    for(size_t i = 0; i < slices; ++i)
+    {
+      real_type const phi = 2.0*M_PI*i/slices;
+      rings.push_back( mesh.add_vertex( vector3_type( radius*sin(theta)*cos(phi), radius*sin(theta)*sin(phi), -radius*cos(theta) ) ) );
+    }
+  }
+  for(size_t i = 0; i < slices; ++i)
+  {
+    size_t const n = (i + 1) % slices;
+    mesh.add_face( south, rings[n], rings[i] );
+    mesh.add_face( north, rings[(segments - 2)*slices + i], rings[(segments - 2)*slices + n] );
+    for(size_t j = 0; j + 2 < segments; ++j)
+    {
+      mesh.add_face( rings[j*slices + i], rings[j*slices + n], rings[(j + 1)*slices + n] );
+      mesh.add_face( rings[j*slices + i], rings[(j + 1)*slices + n], rings[(j + 1)*slices + i] );
+    }
+  }
+}
+
+std::vector< std::pair<face_ptr_type,face_ptr_type> > sorted(result_type const & results)
+{
+  std::vector< std::pair<face_ptr_type,face_ptr_type> > pairs( results.begin(), results.end() );
+  std::sort( pairs.begin(), pairs.end() );
+  return pairs;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_obb_tree);
+
+BOOST_AUTO_TEST_CASE(batch_sat_matches_projection)
+{
+  OpenTissue::math::Random<real_type> random(0.0,1.0);
+
+  size_t const count = 1000;
+  std::vector<obb_type> A( count );
+  std::vector<obb_type> B( count );
+  std::vector<obb_type const *> ptr_A( count );
+  std::vector<obb_type const *> ptr_B( count );
+
+  quaternion_type Q;
+  Q.Ru( 0.7, unit( vector3_type( 1.0, 2.0, 3.0 ) ) );
+  coordsys_type const A2B( vector3_type( 0.3, -0.2, 0.1 ), Q );
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    quaternion_type qa;
+    quaternion_type qb;
+    qa.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+    qb.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+    A[i].set( vector3_type( random(), random(), random() ), matrix3x3_type( qa ), vector3_type( 0.1 + random(), 0.1 + random(), 0.1 + random() )*0.5 );
+    B[i].set( vector3_type( random(), random(), random() )*2.0, matrix3x3_type( qb ), vector3_type( 0.1 + random(), 0.1 + random(), 0.1 + random() )*0.5 );
+    ptr_A[i] = &A[i];
+    ptr_B[i] = &B[i];
+  }
+
+  std::vector<char>      separated( count );
+  std::vector<real_type> lower( count );
+  OpenTissue::intersect::obb_obb_sat_batch( A2B, count, &ptr_A[0], &ptr_B[0], &separated[0], &lower[0] );
+
+  size_t tested = 0;
+  size_t hits   = 0;
+  for(size_t i = 0; i < count; ++i)
+  {
+    obb_type AinB = A[i];
+    AinB.xform( A2B );
+    real_type const gap = projection_gap( AinB, B[i] );
+
+    //--- The scalar test wants box A given in the local frame of box B
+    matrix3x3_type const RB = B[i].orientation();
+    obb_type local;
+    local.set( trans(RB)*(AinB.center() - B[i].center()), trans(RB)*AinB.orientation(), AinB.eps() );
+    obb_type reference;
+    reference.set( vector3_type(0,0,0), matrix3x3_type( 1,0,0, 0,1,0, 0,0,1 ), B[i].eps() );
+    bool const scalar = OpenTissue::intersect::obb_obb_sat( reference, local );
+
+    BOOST_CHECK_EQUAL( scalar, separated[i] != 0 );
+    BOOST_CHECK( lower[i] <= gap + 1e-9 );
+    if(lower[i] > 0)
+      BOOST_CHECK( separated[i] );
+    if(gap > 1e-6 || gap < -1e-6)
+    {
+      BOOST_CHECK_EQUAL( gap > 0, separated[i] != 0 );
+      ++tested;
+    }
+    if(!separated[i])
+      ++hits;
+  }
+  BOOST_CHECK( tested > count - 10 );
+  BOOST_CHECK( hits > 10 );
+  BOOST_CHECK( hits < count - 10 );
+}
+
+BOOST_AUTO_TEST_CASE(front_query_matches_fresh_query)
+{
+  mesh_type mesh_A;
+  mesh_type mesh_B;
+  make_triangle_sphere( 1.0, 12, 12, mesh_A );
+  make_triangle_sphere( 0.8, 16, 16, mesh_B );
+
+  bvh_type tree_A;
+  bvh_type tree_B;
+  OpenTissue::obb_tree::init<types>( mesh_A, tree_A );
+  OpenTissue::obb_tree::init<types>( mesh_B, tree_B );
+
+  types::front_collision_query_type query;
+  front_type front;
+  front_type fresh;
+
+  size_t front_tests = 0;
+  size_t fresh_tests = 0;
+  size_t contacts    = 0;
+
+  coordsys_type const Bwcs( vector3_type( 0, 0, 0 ), quaternion_type() );
+  size_t const frames = 100;
+  for(size_t frame = 0; frame < frames; ++frame)
+  {
+    real_type const t = static_cast<real_type>( frame ) / frames;
+    quaternion_type Q;
+    Q.Ru( 2.0*t, unit( vector3_type( 0.0, 1.0, 1.0 ) ) );
+    coordsys_type const Awcs( vector3_type( 1.75*cos( t ), 1.75*sin( t ), 0.1 ), Q );
+    coordsys_type const A2B = OpenTissue::math::model_update( Awcs, Bwcs );
+
+    result_type results_front;
+    result_type results_fresh;
+    query.run( A2B, tree_A, tree_B, front, results_front );
+    fresh.clear();
+    query.run( A2B, tree_A, tree_B, fresh, results_fresh );
+
+    front_tests += front.tests();
+    fresh_tests += fresh.tests();
+    contacts    += results_fresh.size();
+
+    BOOST_CHECK( sorted( results_front ) == sorted( results_fresh ) );
+
+    //--- Compare against all triangle pairs once in a while
+    if(frame % 20 == 10)
+    {
+      result_type results_brute;
+      mesh_type::face_iterator a = mesh_A.face_begin();
+      for(;a != mesh_A.face_end(); ++a)
+      {
+        vector3_type a0 = *(a->m_v0);
+        vector3_type a1 = *(a->m_v1);
+        vector3_type a2 = *(a->m_v2);
+        A2B.xform_point( a0 );
+        A2B.xform_point( a1 );
+        A2B.xform_point( a2 );
+        mesh_type::face_iterator b = mesh_B.face_begin();
+        for(;b != mesh_B.face_end(); ++b)
+          if(OpenTissue::intersect::triangle_triangle_sat( a0, a1, a2, *(b->m_v0), *(b->m_v1), *(b->m_v2) ))
+            results_brute.push_back( std::make_pair( &(*a), &(*b) ) );
+      }
+      //--- Tree A is the smaller tree, so pairs are not swapped by the query
+      BOOST_CHECK( sorted( results_fresh ) == sorted( results_brute ) );
+    }
+  }
+  BOOST_CHECK( contacts > 0 );
+  BOOST_CHECK( 2*front_tests < fresh_tests );
+
+  //--- The front of separated trees collapses onto the roots, which are not even tested when nothing moves
+  coordsys_type const far_away( vector3_type( 10, 0, 0 ), quaternion_type() );
+  result_type results;
+  for(size_t i = 0; i < 10; ++i)
+    query.run( far_away, tree_A, tree_B, front, results );
+  BOOST_CHECK( results.empty() );
+  BOOST_CHECK_EQUAL( front.size(), 1u );
+  BOOST_CHECK_EQUAL( front.tests(), 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
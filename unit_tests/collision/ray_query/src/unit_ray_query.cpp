@@ -0,0 +1,265 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/math/math_random.h>
+#include <OpenTissue/core/containers/mesh/mesh.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_geometry.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_init.h>
+#include <OpenTissue/collision/aabb_tree/aabb_tree_refit.h>
+#include <OpenTissue/collision/aabb_tree/policies/aabb_tree_ray_policy.h>
+#include <OpenTissue/collision/bvh/bvh_ray_query.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <vector>
+#include <list>
+#include <map>
+#include <cmath>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>  math_types;
+typedef math_types::real_type                             real_type;
+typedef math_types::vector3_type                          vector3_type;
+typedef OpenTissue::polymesh::PolyMesh<math_types>        mesh_type;
+
+class Vertex
+{
+public:
+
+  vector3_type m_x;
+
+  vector3_type const & position() const { return m_x; }
+
+};
+
+typedef OpenTissue::aabb_tree::Geometry<real_type, Vertex>                   aabb_tree_geometry;
+typedef aabb_tree_geometry::bvh_type                                         bvh_type;
+typedef aabb_tree_geometry::geometry_type                                    triangle_type;
+typedef OpenTissue::aabb_tree::RayPolicy<aabb_tree_geometry>                 ray_policy;
+typedef OpenTissue::bvh::RayQuery<bvh_type, ray_policy, 8>                   ray_query_type;
+typedef OpenTissue::bvh::RayQuery<bvh_type, ray_policy, 4>                   ray_query4_type;
+typedef ray_query_type::hit_type                                             hit_type;
+
+/**
+ * Binds the vertices of the mesh to the vertex data used by the AABB tree.
+ */
+class Binder
+{
+public:
+
+  std::vector<Vertex>                          m_vertices;
+  std::map<mesh_type::vertex_type *, Vertex *> m_lut;
+
+  Vertex * operator()(mesh_type::vertex_type * v) { return m_lut[v]; }
+
+};
+
+/**
+ * Creates a triangulated bumpy sphere, the bumps makes sure that
+ * rays from inside the sphere may hit the surface several times.
+ */
+void make_bumpy_sphere(unsigned int slices, unsigned int segments, mesh_type & mesh, Binder & binder)
+{
+  using std::cos;
+  using std::sin;
+
+  real_type const pi = OpenTissue::math::detail::pi<real_type>();
+
+  mesh.clear();
+  std::vector<mesh_type::vertex_handle> grid;
+  mesh_type::vertex_handle south = mesh.add_vertex( vector3_type(0.0, 0.0, -1.0) );
+  mesh_type::vertex_handle north = mesh.add_vertex( vector3_type(0.0, 0.0,  1.0) );
+  for(unsigned int k = 1; k < segments; ++k)
+  {
+    real_type const theta = pi*k/segments;
+    for(unsigned int i = 0; i < slices; ++i)
+    {
+      real_type const phi    = 2.0*pi*i/slices;
+      real_type const radius = 1.0 + 0.2*sin(5.0*phi)*sin(3.0*theta);
+      grid.push_back( mesh.add_vertex( vector3_type( radius*sin(theta)*cos(phi), radius*sin(theta)*sin(phi), -radius*cos(theta) ) ) );
+    }
+  }
+  for(unsigned int i = 0; i < slices; ++i)
+  {
+    unsigned int const j = (i + 1) % slices;
+    mesh.add_face( south, grid[j], grid[i] );
+    mesh.add_face( north, grid[(segments-2)*slices + i], grid[(segments-2)*slices + j] );
+    for(unsigned int k = 0; k + 2 < segments; ++k)
+    {
+      mesh.add_face( grid[k*slices + i], grid[k*slices + j], grid[(k+1)*slices + j] );
+      mesh.add_face( grid[k*slices + i], grid[(k+1)*slices + j], grid[(k+1)*slices + i] );
+    }
+  }
+
+  binder.m_vertices.resize( mesh.size_vertices() );
+  size_t n = 0;
+  for(mesh_type::vertex_iterator v = mesh.vertex_begin(); v != mesh.vertex_end(); ++v, ++n)
+  {
+    binder.m_vertices[n].m_x = v->m_coord;
+    binder.m_lut[ &(*v) ] = &binder.m_vertices[n];
+  }
+}
+
+void make_rays(size_t count, std::vector<vector3_type> & p, std::vector<vector3_type> & r)
+{
+  OpenTissue::math::Random<real_type> random(-1.0,1.0);
+
+  p.resize(count);
+  r.resize(count);
+  for(size_t i = 0; i < count; ++i)
+  {
+    //--- Mix rays from the inside and the outside and a few rays missing everything
+    real_type const scale = (i%3 == 0) ? 0.5 : 3.0;
+    p[i] = vector3_type( scale*random(), scale*random(), scale*random() );
+    vector3_type target = vector3_type( 0.5*random(), 0.5*random(), 0.5*random() );
+    if(i%7 == 0)
+      target = p[i]*2.0;
+    r[i] = target - p[i];
+    if(i%5 == 0)
+      r[i] = unit(r[i]);
+  }
+}
+
+bool brute_force(std::list<triangle_type> const & triangles, vector3_type const & p, vector3_type const & r, real_type t_max, real_type & t)
+{
+  ray_policy policy;
+  bool found = false;
+  t = t_max;
+  for(std::list<triangle_type>::const_iterator tri = triangles.begin(); tri != triangles.end(); ++tri)
+  {
+    real_type s;
+    if( policy.intersect( *tri, p, r, t, s ) )
+    {
+      t     = s;
+      found = true;
+    }
+  }
+  return found;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_ray_query);
+
+BOOST_AUTO_TEST_CASE(closest_and_any_hit)
+{
+  mesh_type mesh;
+  Binder binder;
+  make_bumpy_sphere( 24, 12, mesh, binder );
+
+  aabb_tree_geometry tree;
+  OpenTissue::aabb_tree::init( mesh, tree, binder );
+  OpenTissue::aabb_tree::refit( tree );
+
+  //--- Collect all triangles for brute force testing
+  std::list<triangle_type> triangles;
+  bvh_type::bv_ptr_container leaves;
+  OpenTissue::bvh::get_leaf_nodes( tree.m_bvh, leaves );
+  for(bvh_type::bv_ptr_iterator leaf = leaves.begin(); leaf != leaves.end(); ++leaf)
+  {
+    bvh_type::annotated_bv_ptr annotated = boost::static_pointer_cast<bvh_type::annotated_bv_type>( *leaf );
+    triangles.insert( triangles.end(), annotated->geometry_begin(), annotated->geometry_end() );
+  }
+  BOOST_CHECK_EQUAL( triangles.size(), mesh.size_faces() );
+
+  ray_query_type query;
+  query.init( tree.m_bvh );
+
+  std::vector<vector3_type> p;
+  std::vector<vector3_type> r;
+  make_rays( 1000, p, r );
+
+  real_type const t_max = 10.0;
+  size_t hits   = 0;
+  size_t misses = 0;
+  for(size_t i = 0; i < p.size(); ++i)
+  {
+    real_type t;
+    bool const expected = brute_force( triangles, p[i], r[i], t_max, t );
+
+    hit_type hit;
+    bool const found = query.closest_hit( p[i], r[i], t_max, hit );
+
+    BOOST_CHECK_EQUAL( found, expected );
+    BOOST_CHECK_EQUAL( query.any_hit( p[i], r[i], t_max ), expected );
+    if(found && expected)
+    {
+      BOOST_CHECK_CLOSE( hit.m_t, t, 1e-8 );
+      BOOST_CHECK( hit.m_geometry );
+      ++hits;
+    }
+    else
+      ++misses;
+
+    //--- A ray cut short before the closest hit should not hit anything
+    if(expected)
+      BOOST_CHECK( !query.any_hit( p[i], r[i], 0.99*t ) );
+  }
+  BOOST_CHECK( hits > 0 );
+  BOOST_CHECK( misses > 0 );
+}
+
+BOOST_AUTO_TEST_CASE(packets_and_batches)
+{
+  mesh_type mesh;
+  Binder binder;
+  make_bumpy_sphere( 32, 16, mesh, binder );
+
+  aabb_tree_geometry tree;
+  OpenTissue::aabb_tree::init( mesh, tree, binder );
+  OpenTissue::aabb_tree::refit( tree );
+
+  ray_query_type  query;
+  ray_query4_type query4;
+  query.init( tree.m_bvh );
+  query4.init( tree.m_bvh );
+
+  //--- Odd count makes sure the last packet is only partially filled
+  size_t const count = 2005;
+  std::vector<vector3_type> p;
+  std::vector<vector3_type> r;
+  make_rays( count, p, r );
+
+  real_type const t_max = 10.0;
+
+  std::vector<hit_type> batch( count );
+  std::vector<hit_type> batch4( count );
+  std::vector<int>      any( count );
+  query.closest_hit( count, &p[0], &r[0], t_max, &batch[0] );
+  query4.closest_hit( count, &p[0], &r[0], t_max, &batch4[0] );
+  query.any_hit( count, &p[0], &r[0], t_max, &any[0] );
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    hit_type hit;
+    bool const found = query.closest_hit( p[i], r[i], t_max, hit );
+
+    BOOST_CHECK_EQUAL( batch[i].m_geometry, hit.m_geometry );
+    BOOST_CHECK_EQUAL( batch4[i].m_geometry, hit.m_geometry );
+    BOOST_CHECK_EQUAL( any[i] != 0, found );
+    if(found)
+    {
+      BOOST_CHECK_EQUAL( batch[i].m_t, hit.m_t );
+      BOOST_CHECK_EQUAL( batch4[i].m_t, hit.m_t );
+    }
+  }
+
+  //--- Moving the vertices and refitting requires the query to be re-initialized
+  for(size_t i = 0; i < binder.m_vertices.size(); ++i)
+    binder.m_vertices[i].m_x += vector3_type( 10.0, 0.0, 0.0 );
+  OpenTissue::aabb_tree::refit( tree );
+  query.init( tree.m_bvh );
+
+  query.any_hit( count, &p[0], &r[0], t_max, &any[0] );
+  for(size_t i = 0; i < count; ++i)
+    BOOST_CHECK_EQUAL( any[i] != 0, query.any_hit( p[i], r[i], t_max ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
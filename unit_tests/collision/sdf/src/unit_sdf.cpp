@@ -0,0 +1,369 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/math/math_random.h>
+#include <OpenTissue/core/containers/mesh/polymesh/polymesh.h>
+#include <OpenTissue/core/containers/mesh/polymesh/util/polymesh_make_sphere.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/grid_sparse.h>
+#include <OpenTissue/core/containers/grid/util/grid_sparse_narrow_band.h>
+#include <OpenTissue/core/containers/grid/util/grid_mip_pyramid.h>
+#include <OpenTissue/core/geometry/geometry_sphere.h>
+#include <OpenTissue/collision/sdf/sdf_geometry.h>
+#include <OpenTissue/collision/sdf/sdf_top_down_policy.h>
+#include <OpenTissue/collision/sdf/sdf_semiauto_init_geometry.h>
+#include <OpenTissue/collision/collision_sdf_sdf.h>
+#include <OpenTissue/collision/collision_sphere_sdf.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <vector>
+#include <cmath>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>    math_types;
+typedef math_types::real_type                               real_type;
+typedef math_types::vector3_type                            vector3_type;
+typedef math_types::quaternion_type                         quaternion_type;
+typedef math_types::coordsys_type                           coordsys_type;
+
+typedef OpenTissue::polymesh::PolyMesh<math_types>          mesh_type;
+typedef OpenTissue::grid::Grid<float,math_types>            grid_type;
+typedef OpenTissue::sdf::Geometry<mesh_type,grid_type>      sdf_geometry_type;
+typedef OpenTissue::grid::SparseGrid<float,math_types>      sparse_grid_type;
+typedef OpenTissue::sdf::Geometry<mesh_type,sparse_grid_type> sparse_sdf_geometry_type;
+
+class ContactPoint
+{
+public:
+  vector3_type m_p;
+  vector3_type m_n;
+  real_type    m_distance;
+};
+
+/**
+ * Fills a dense grid with the signed distance field of a unit sphere.
+ */
+void make_sphere_phi( grid_type & phi )
+{
+  size_t const N = 33;
+  phi.create( vector3_type(-1.6,-1.6,-1.6), vector3_type(1.6,1.6,1.6), N, N, N );
+  for(size_t k = 0; k < N; ++k)
+    for(size_t j = 0; j < N; ++j)
+      for(size_t i = 0; i < N; ++i)
+      {
+        vector3_type const p = phi.min_coord() + vector3_type( i*phi.dx(), j*phi.dy(), k*phi.dz() );
+        phi(i,j,k) = static_cast<float>( length(p) - 1.0 );
+      }
+}
+
+void assign_phi( grid_type const & phi, grid_type & target )
+{
+  target = phi;
+}
+
+/**
+ * The narrow band is wide enough to hold all grid nodes used by the
+ * collision queries of the tests below.
+ */
+void assign_phi( grid_type const & phi, sparse_grid_type & target )
+{
+  OpenTissue::grid::dense2sparse( phi, 0.6f, target );
+}
+
+/**
+ * Initializes a sdf geometry of a unit sphere. The sample points are spread
+ * evenly over the sphere surface.
+ */
+template<typename geometry_type>
+void make_sphere_geometry( geometry_type & geometry )
+{
+  typedef typename geometry_type::bvh_type                                bvh_type;
+  typedef OpenTissue::sdf::TopDownPolicy<bvh_type>                        top_down_policy;
+  typedef OpenTissue::bvh::TopDownConstructor<bvh_type, top_down_policy>  constructor_type;
+
+  grid_type phi;
+  make_sphere_phi( phi );
+  assign_phi( phi, geometry.m_phi );
+
+  size_t const M = 600;
+  real_type const golden = M_PI*(3.0 - std::sqrt(5.0));
+  geometry.m_sampling.clear();
+  for(size_t m = 0; m < M; ++m)
+  {
+    real_type const z = 1.0 - (2.0*m + 1.0)/M;
+    real_type const r = std::sqrt(1.0 - z*z);
+    geometry.m_sampling.push_back( vector3_type( r*std::cos(golden*m), r*std::sin(golden*m), z ) );
+  }
+  geometry.m_min_coord = vector3_type(-1.0,-1.0,-1.0);
+  geometry.m_max_coord = vector3_type( 1.0, 1.0, 1.0);
+  geometry.m_max_radius = 1.0;
+
+  geometry.m_bvh.clear();
+  constructor_type constructor;
+  constructor.run( geometry.m_sampling.begin(), geometry.m_sampling.end(), geometry.m_bvh );
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_sdf);
+
+BOOST_AUTO_TEST_CASE(batch_query_matches_single_query)
+{
+  sdf_geometry_type A;
+  sdf_geometry_type B;
+  make_sphere_geometry( A );
+  make_sphere_geometry( B );
+
+  OpenTissue::math::Random<real_type> random(0.0,1.0);
+
+  real_type const envelope = 0.05;
+  size_t colliding = 0;
+  for(size_t test = 0; test < 200; ++test)
+  {
+    vector3_type direction( random() - 0.5, random() - 0.5, random() - 0.5 );
+    direction = unit( direction );
+
+    quaternion_type Q_a;
+    quaternion_type Q_b;
+    Q_a.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+    Q_b.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+
+    coordsys_type const AtoWCS( vector3_type( random(), random(), random() ), Q_a );
+    coordsys_type const BtoWCS( AtoWCS.T() + (1.7 + 0.5*random())*direction, Q_b );
+
+    std::vector<ContactPoint> expected;
+    std::vector<ContactPoint> contacts;
+
+    bool const expected_collision = OpenTissue::collision::sdf_sdf( AtoWCS, A, BtoWCS, B, expected, envelope );
+    bool const collision          = OpenTissue::collision::sdf_sdf_batch( AtoWCS, A, BtoWCS, B, contacts, envelope );
+
+    BOOST_CHECK_EQUAL( collision, expected_collision );
+    BOOST_REQUIRE_EQUAL( contacts.size(), expected.size() );
+    if(collision)
+      ++colliding;
+
+    //--- Both queries visit the BVH nodes in the same order
+    for(size_t i = 0; i < contacts.size(); ++i)
+    {
+      BOOST_CHECK( contacts[i].m_p.is_equal( expected[i].m_p, 1e-10 ) );
+      BOOST_CHECK( contacts[i].m_n.is_equal( expected[i].m_n, 1e-8 ) );
+      BOOST_CHECK_SMALL( contacts[i].m_distance - expected[i].m_distance, 1e-10 );
+    }
+  }
+  BOOST_CHECK( colliding > 0 );
+  BOOST_CHECK( colliding < 200 );
+}
+
+BOOST_AUTO_TEST_CASE(sparse_query_matches_dense_query)
+{
+  sdf_geometry_type A;
+  sdf_geometry_type B;
+  make_sphere_geometry( A );
+  make_sphere_geometry( B );
+
+  sparse_sdf_geometry_type sparse_A;
+  sparse_sdf_geometry_type sparse_B;
+  make_sphere_geometry( sparse_A );
+  make_sphere_geometry( sparse_B );
+  BOOST_CHECK( sparse_A.m_phi.brick_count() < sparse_A.m_phi.tile_count() );
+
+  OpenTissue::math::Random<real_type> random(0.0,1.0);
+
+  real_type const envelope = 0.05;
+  size_t colliding = 0;
+  for(size_t test = 0; test < 200; ++test)
+  {
+    vector3_type direction( random() - 0.5, random() - 0.5, random() - 0.5 );
+    direction = unit( direction );
+
+    quaternion_type Q_a;
+    quaternion_type Q_b;
+    Q_a.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+    Q_b.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+
+    coordsys_type const AtoWCS( vector3_type( random(), random(), random() ), Q_a );
+    coordsys_type const BtoWCS( AtoWCS.T() + (1.7 + 0.5*random())*direction, Q_b );
+
+    std::vector<ContactPoint> expected;
+    std::vector<ContactPoint> contacts;
+
+    bool const expected_collision = OpenTissue::collision::sdf_sdf( AtoWCS, A, BtoWCS, B, expected, envelope );
+    bool const collision          = OpenTissue::collision::sdf_sdf( AtoWCS, sparse_A, BtoWCS, sparse_B, contacts, envelope );
+
+    BOOST_CHECK_EQUAL( collision, expected_collision );
+    BOOST_REQUIRE_EQUAL( contacts.size(), expected.size() );
+    if(collision)
+      ++colliding;
+
+    for(size_t i = 0; i < contacts.size(); ++i)
+    {
+      BOOST_CHECK( contacts[i].m_p.is_equal( expected[i].m_p, 1e-10 ) );
+      BOOST_CHECK( contacts[i].m_n.is_equal( expected[i].m_n, 1e-10 ) );
+      BOOST_CHECK_SMALL( contacts[i].m_distance - expected[i].m_distance, 1e-10 );
+    }
+  }
+  BOOST_CHECK( colliding > 0 );
+}
+
+BOOST_AUTO_TEST_CASE(batch_query_on_narrow_band_geometry)
+{
+  mesh_type surface;
+  OpenTissue::polymesh::make_sphere( 1.0, 3, surface );
+
+  sparse_sdf_geometry_type A;
+  sparse_sdf_geometry_type B;
+  OpenTissue::sdf::semiauto_init_narrow_band_geometry( surface, 0.0, false, A, 0.3, 64 );
+  OpenTissue::sdf::semiauto_init_narrow_band_geometry( surface, 0.0, false, B, 0.3, 64 );
+  BOOST_CHECK( A.m_phi.brick_count() < A.m_phi.tile_count() );
+
+  OpenTissue::math::Random<real_type> random(0.0,1.0);
+
+  real_type const envelope = 0.05;
+  size_t colliding = 0;
+  for(size_t test = 0; test < 200; ++test)
+  {
+    vector3_type direction( random() - 0.5, random() - 0.5, random() - 0.5 );
+    direction = unit( direction );
+
+    quaternion_type Q_a;
+    quaternion_type Q_b;
+    Q_a.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+    Q_b.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+
+    coordsys_type const AtoWCS( vector3_type( random(), random(), random() ), Q_a );
+    coordsys_type const BtoWCS( AtoWCS.T() + (1.8 + 0.4*random())*direction, Q_b );
+
+    std::vector<ContactPoint> expected;
+    std::vector<ContactPoint> contacts;
+
+    bool const expected_collision = OpenTissue::collision::sdf_sdf( AtoWCS, A, BtoWCS, B, expected, envelope );
+    bool const collision          = OpenTissue::collision::sdf_sdf_batch( AtoWCS, A, BtoWCS, B, contacts, envelope );
+
+    BOOST_CHECK_EQUAL( collision, expected_collision );
+    BOOST_REQUIRE_EQUAL( contacts.size(), expected.size() );
+    if(collision)
+      ++colliding;
+
+    for(size_t i = 0; i < contacts.size(); ++i)
+    {
+      BOOST_CHECK( contacts[i].m_p.is_equal( expected[i].m_p, 1e-10 ) );
+      BOOST_CHECK( contacts[i].m_n.is_equal( expected[i].m_n, 1e-8 ) );
+      BOOST_CHECK_SMALL( contacts[i].m_distance - expected[i].m_distance, 1e-10 );
+    }
+  }
+  BOOST_CHECK( colliding > 0 );
+  BOOST_CHECK( colliding < 200 );
+}
+
+BOOST_AUTO_TEST_CASE(pyramid_is_conservative)
+{
+  sdf_geometry_type A;
+  make_sphere_geometry( A );
+
+  size_t const levels = OpenTissue::grid::compute_mip_pyramid( A.m_phi, 8, A.m_pyramid );
+  BOOST_CHECK_EQUAL( levels, 5u );
+  BOOST_CHECK_EQUAL( A.m_pyramid[0].I(), 17u );
+  BOOST_CHECK_EQUAL( A.m_pyramid[3].I(), 3u );
+  BOOST_CHECK_EQUAL( A.m_pyramid[4].I(), 2u );
+
+  OpenTissue::math::Random<real_type> random(-1.6,1.6);
+  for(size_t test = 0; test < 10000; ++test)
+  {
+    vector3_type const p( random(), random(), random() );
+    real_type const value = OpenTissue::grid::value_at_point( A.m_phi, p );
+    for(size_t l = 0; l < levels; ++l)
+      BOOST_CHECK( OpenTissue::grid::lower_bound_at_point( A.m_pyramid[l], p ) <= value );
+  }
+
+  // Far from the surface the coarsest levels give useful bounds
+  real_type const bound = OpenTissue::grid::pyramid_lower_bound( A.m_pyramid, vector3_type(0.0,0.0,0.0), real_type(0) );
+  BOOST_CHECK( bound < 0.0 );
+}
+
+BOOST_AUTO_TEST_CASE(pyramid_query_matches_plain_query)
+{
+  sdf_geometry_type A;
+  sdf_geometry_type B;
+  make_sphere_geometry( A );
+  make_sphere_geometry( B );
+
+  sdf_geometry_type pyramid_A;
+  sdf_geometry_type pyramid_B;
+  make_sphere_geometry( pyramid_A );
+  make_sphere_geometry( pyramid_B );
+  OpenTissue::grid::compute_mip_pyramid( pyramid_A.m_phi, 3, pyramid_A.m_pyramid );
+  OpenTissue::grid::compute_mip_pyramid( pyramid_B.m_phi, 3, pyramid_B.m_pyramid );
+
+  OpenTissue::math::Random<real_type> random(0.0,1.0);
+
+  real_type const envelope = 0.05;
+  size_t colliding = 0;
+  for(size_t test = 0; test < 200; ++test)
+  {
+    vector3_type direction( random() - 0.5, random() - 0.5, random() - 0.5 );
+    direction = unit( direction );
+
+    quaternion_type Q_a;
+    quaternion_type Q_b;
+    Q_a.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+    Q_b.Ru( 6.0*random(), unit( vector3_type( random() - 0.5, random() - 0.5, random() - 0.5 ) ) );
+
+    coordsys_type AtoWCS( vector3_type( random(), random(), random() ), Q_a );
+    coordsys_type BtoWCS( AtoWCS.T() + (1.7 + 0.5*random())*direction, Q_b );
+
+    std::vector<ContactPoint> expected;
+    std::vector<ContactPoint> contacts;
+
+    bool const expected_collision = OpenTissue::collision::sdf_sdf( AtoWCS, A, BtoWCS, B, expected, envelope );
+    bool const collision          = OpenTissue::collision::sdf_sdf( AtoWCS, pyramid_A, BtoWCS, pyramid_B, contacts, envelope );
+
+    BOOST_CHECK_EQUAL( collision, expected_collision );
+    BOOST_REQUIRE_EQUAL( contacts.size(), expected.size() );
+    if(collision)
+      ++colliding;
+
+    for(size_t i = 0; i < contacts.size(); ++i)
+    {
+      BOOST_CHECK( contacts[i].m_p.is_equal( expected[i].m_p, 1e-10 ) );
+      BOOST_CHECK( contacts[i].m_n.is_equal( expected[i].m_n, 1e-10 ) );
+      BOOST_CHECK_SMALL( contacts[i].m_distance - expected[i].m_distance, 1e-10 );
+    }
+
+    // The batched query culls with the pyramid too
+    std::vector<ContactPoint> batch_contacts;
+    bool const batch_collision = OpenTissue::collision::sdf_sdf_batch( AtoWCS, pyramid_A, BtoWCS, pyramid_B, batch_contacts, envelope );
+    BOOST_CHECK_EQUAL( batch_collision, collision );
+    BOOST_REQUIRE_EQUAL( batch_contacts.size(), contacts.size() );
+    for(size_t i = 0; i < batch_contacts.size(); ++i)
+    {
+      BOOST_CHECK( batch_contacts[i].m_p.is_equal( contacts[i].m_p, 1e-10 ) );
+      BOOST_CHECK( batch_contacts[i].m_n.is_equal( contacts[i].m_n, 1e-8 ) );
+      BOOST_CHECK_SMALL( batch_contacts[i].m_distance - contacts[i].m_distance, 1e-10 );
+    }
+
+    // A sphere placed where object B is gives the same contact with and without the pyramid
+    OpenTissue::geometry::Sphere<math_types> sphere( vector3_type(0.0,0.0,0.0), 0.2 + 0.8*random() );
+    expected.clear();
+    contacts.clear();
+    bool const expected_sphere_collision = OpenTissue::collision::sphere_sdf( BtoWCS, sphere, AtoWCS, A, expected, envelope );
+    bool const sphere_collision          = OpenTissue::collision::sphere_sdf( BtoWCS, sphere, AtoWCS, pyramid_A, contacts, envelope );
+    BOOST_CHECK_EQUAL( sphere_collision, expected_sphere_collision );
+    BOOST_REQUIRE_EQUAL( contacts.size(), expected.size() );
+    for(size_t i = 0; i < contacts.size(); ++i)
+    {
+      BOOST_CHECK( contacts[i].m_p.is_equal( expected[i].m_p, 1e-10 ) );
+      BOOST_CHECK_SMALL( contacts[i].m_distance - expected[i].m_distance, 1e-10 );
+    }
+  }
+  BOOST_CHECK( colliding > 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
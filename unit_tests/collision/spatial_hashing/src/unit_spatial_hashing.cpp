@@ -0,0 +1,195 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/collision/spatial_hashing/spatial_hashing.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>  math_types;
+typedef math_types::vector3_type                          vector3_type;
+typedef math_types::real_type                             real_type;
+
+class Particle
+{
+public:
+  vector3_type m_x;
+};
+
+template< template<typename,typename,typename,typename> class grid_template >
+class PointPolicy
+{
+public:
+
+  typedef Particle                                                     data_type;
+  typedef Particle                                                     query_type;
+  typedef std::pair<Particle const *, Particle const *>                result_type;
+  typedef std::vector<result_type>                                     result_container;
+  typedef OpenTissue::spatial_hashing::PrimeNumberHashFunction         hash_function;
+  typedef grid_template< vector3_type, OpenTissue::math::Vector3<int>, data_type, hash_function>  hash_grid;
+
+  real_type m_radius;
+
+  vector3_type position(data_type const & data) const { return data.m_x; }
+  vector3_type min_coord(query_type const & query) const { return query.m_x - vector3_type(m_radius,m_radius,m_radius); }
+  vector3_type max_coord(query_type const & query) const { return query.m_x + vector3_type(m_radius,m_radius,m_radius); }
+
+  void reset(result_container & results) { results.clear(); }
+
+  bool overlap(data_type const & data, query_type const & query) const
+  {
+    return &data != &query && length(data.m_x - query.m_x) < m_radius;
+  }
+
+  void report(data_type const & data, query_type const & query, result_container & results)
+  {
+    if( overlap(data, query) )
+      results.push_back( result_type(&data,&query) );
+  }
+};
+
+void make_particles(std::vector<Particle> & particles, size_t N)
+{
+  std::srand(42);
+  particles.resize(N);
+  for(size_t i = 0; i < N; ++i)
+  {
+    particles[i].m_x(0) = (10.0*std::rand())/RAND_MAX;
+    particles[i].m_x(1) = (10.0*std::rand())/RAND_MAX;
+    particles[i].m_x(2) = (10.0*std::rand())/RAND_MAX;
+  }
+}
+
+template<typename query_type>
+void run_query(query_type & query, std::vector<Particle> & particles, typename query_type::result_container & results)
+{
+  query.m_radius = 0.5;
+  query.resize( particles.size() );
+  query.set_spacing( 1.0 );
+  query( particles.begin(), particles.end(), particles.begin(), particles.end(), results, typename query_type::all_tag() );
+  std::sort( results.begin(), results.end() );
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_spatial_hashing);
+
+BOOST_AUTO_TEST_CASE(packed_grid_point_data_query)
+{
+  typedef OpenTissue::spatial_hashing::PointDataQuery< PointPolicy<OpenTissue::spatial_hashing::Grid>::hash_grid, PointPolicy<OpenTissue::spatial_hashing::Grid> >              grid_query_type;
+  typedef OpenTissue::spatial_hashing::PointDataQuery< PointPolicy<OpenTissue::spatial_hashing::PackedGrid>::hash_grid, PointPolicy<OpenTissue::spatial_hashing::PackedGrid> >  packed_query_type;
+
+  std::vector<Particle> particles;
+  make_particles(particles, 20000);
+
+  grid_query_type   grid_query;
+  packed_query_type packed_query;
+  grid_query_type::result_container    expected;
+  packed_query_type::result_container  results;
+
+  run_query( grid_query, particles, expected );
+  run_query( packed_query, particles, results );
+
+  BOOST_CHECK( !expected.empty() );
+  BOOST_CHECK( expected == results );
+
+  // Remove half of the particles and re-run the queries
+  grid_query.remove_data( particles.begin(), particles.begin() + particles.size()/2 );
+  packed_query.remove_data( particles.begin(), particles.begin() + particles.size()/2 );
+  grid_query( particles.begin(), particles.end(), expected, grid_query_type::all_tag() );
+  packed_query( particles.begin(), particles.end(), results, packed_query_type::all_tag() );
+  std::sort( expected.begin(), expected.end() );
+  std::sort( results.begin(), results.end() );
+
+  BOOST_CHECK( !expected.empty() );
+  BOOST_CHECK( expected == results );
+
+  // Add them back again
+  packed_query.add_data( particles.begin(), particles.begin() + particles.size()/2 );
+  packed_query( particles.begin(), particles.end(), results, packed_query_type::all_tag() );
+  std::sort( results.begin(), results.end() );
+  run_query( grid_query, particles, expected );
+
+  BOOST_CHECK( expected == results );
+}
+
+BOOST_AUTO_TEST_CASE(packed_grid_aabb_data_query)
+{
+  typedef OpenTissue::spatial_hashing::AABBDataQuery< PointPolicy<OpenTissue::spatial_hashing::Grid>::hash_grid, PointPolicy<OpenTissue::spatial_hashing::Grid> >              grid_query_type;
+  typedef OpenTissue::spatial_hashing::AABBDataQuery< PointPolicy<OpenTissue::spatial_hashing::PackedGrid>::hash_grid, PointPolicy<OpenTissue::spatial_hashing::PackedGrid> >  packed_query_type;
+
+  std::vector<Particle> particles;
+  make_particles(particles, 5000);
+
+  grid_query_type   grid_query;
+  packed_query_type packed_query;
+  grid_query_type::result_container    expected;
+  packed_query_type::result_container  results;
+
+  run_query( grid_query, particles, expected );
+  run_query( packed_query, particles, results );
+
+  BOOST_CHECK( !expected.empty() );
+  BOOST_CHECK( expected == results );
+}
+
+template<typename query_type>
+void run_batch_query(query_type & query, std::vector<Particle> & particles, typename query_type::result_container & results)
+{
+  typedef typename query_type::result_type result_type;
+
+  std::vector<size_t>     offsets;
+  std::vector<Particle*>  hits;
+
+  query.batch( particles.begin(), particles.end(), offsets, hits, typename query_type::no_collisions_tag() );
+
+  BOOST_CHECK( offsets.size() == particles.size() + 1 );
+  BOOST_CHECK( offsets.back() == hits.size() );
+
+  results.clear();
+  for(size_t i = 0; i < particles.size(); ++i)
+    for(size_t j = offsets[i]; j < offsets[i+1]; ++j)
+      results.push_back( result_type( hits[j], &particles[i] ) );
+  std::sort( results.begin(), results.end() );
+}
+
+BOOST_AUTO_TEST_CASE(batched_query)
+{
+  typedef OpenTissue::spatial_hashing::PointDataQuery< PointPolicy<OpenTissue::spatial_hashing::Grid>::hash_grid, PointPolicy<OpenTissue::spatial_hashing::Grid> >              grid_query_type;
+  typedef OpenTissue::spatial_hashing::AABBDataQuery< PointPolicy<OpenTissue::spatial_hashing::PackedGrid>::hash_grid, PointPolicy<OpenTissue::spatial_hashing::PackedGrid> >  packed_query_type;
+
+  std::vector<Particle> particles;
+  make_particles(particles, 20000);
+
+  grid_query_type   grid_query;
+  packed_query_type packed_query;
+  grid_query_type::result_container    expected;
+  grid_query_type::result_container    results;
+
+  run_query( grid_query, particles, expected );
+
+  run_batch_query( grid_query, particles, results );
+  BOOST_CHECK( !expected.empty() );
+  BOOST_CHECK( expected == results );
+
+  packed_query.m_radius = 0.5;
+  packed_query.resize( particles.size() );
+  packed_query.set_spacing( 1.0 );
+  packed_query.init_data( particles.begin(), particles.end() );
+  run_batch_query( packed_query, particles, results );
+  BOOST_CHECK( expected == results );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,232 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/math/math_random.h>
+#include <OpenTissue/collision/intersect/intersect_triangle_triangle_sat.h>
+#include <OpenTissue/collision/intersect/intersect_triangle_triangle_batch.h>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+#include <vector>
+#include <utility>
+#include <cmath>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>  math_types;
+typedef math_types::real_type                             real_type;
+typedef math_types::vector3_type                          vector3_type;
+
+/**
+ * Generates random triangle pairs of unit size placed such that a good share of the pairs intersect.
+ */
+void make_triangle_pairs(
+  size_t count
+  , std::vector<vector3_type> & a0
+  , std::vector<vector3_type> & a1
+  , std::vector<vector3_type> & a2
+  , std::vector<vector3_type> & b0
+  , std::vector<vector3_type> & b1
+  , std::vector<vector3_type> & b2
+  )
+{
+  a0.resize(count); a1.resize(count); a2.resize(count);
+  b0.resize(count); b1.resize(count); b2.resize(count);
+  for(size_t i=0;i<count;++i)
+  {
+    vector3_type c;
+    OpenTissue::math::random( c, -0.25, 0.25 );
+    OpenTissue::math::random( a0[i], -0.5, 0.5 );
+    OpenTissue::math::random( a1[i], -0.5, 0.5 );
+    OpenTissue::math::random( a2[i], -0.5, 0.5 );
+    OpenTissue::math::random( b0[i], -0.5, 0.5 );
+    OpenTissue::math::random( b1[i], -0.5, 0.5 );
+    OpenTissue::math::random( b2[i], -0.5, 0.5 );
+    b0[i] += c;
+    b1[i] += c;
+    b2[i] += c;
+  }
+}
+
+/**
+ * Tests whether a point lies on a triangle, within a tolerance.
+ */
+bool on_triangle(vector3_type const & p, vector3_type const & v0, vector3_type const & v1, vector3_type const & v2, real_type const & tol)
+{
+  vector3_type const n = unit( cross( v1 - v0, v2 - v0 ) );
+  if( std::fabs( n*(p - v0) ) > tol )
+    return false;
+  if( cross( v1 - v0, p - v0 )*n < -tol )
+    return false;
+  if( cross( v2 - v1, p - v1 )*n < -tol )
+    return false;
+  if( cross( v0 - v2, p - v2 )*n < -tol )
+    return false;
+  return true;
+}
+
+class TriangleAccessor
+{
+public:
+
+  std::vector<vector3_type> const * m_vertices;
+
+  TriangleAccessor(std::vector<vector3_type> const & vertices) : m_vertices(&vertices) {}
+
+  void operator()(size_t const & triangle, vector3_type & v0, vector3_type & v1, vector3_type & v2) const
+  {
+    v0 = (*m_vertices)[3*triangle];
+    v1 = (*m_vertices)[3*triangle+1];
+    v2 = (*m_vertices)[3*triangle+2];
+  }
+};
+
+BOOST_AUTO_TEST_SUITE(opentissue_collision_triangle_triangle);
+
+BOOST_AUTO_TEST_CASE(batch_matches_separating_axis_test)
+{
+  size_t const count = 2003;  // Not a multiple of the batch width
+  std::vector<vector3_type> a0, a1, a2, b0, b1, b2;
+  make_triangle_pairs( count, a0, a1, a2, b0, b1, b2 );
+
+  std::vector<int> overlap( count );
+  OpenTissue::intersect::triangle_triangle_overlap_batch( count, &a0[0], &a1[0], &a2[0], &b0[0], &b1[0], &b2[0], &overlap[0] );
+
+  size_t hits = 0;
+  for(size_t i=0;i<count;++i)
+  {
+    bool const expected = OpenTissue::intersect::triangle_triangle_sat( a0[i], a1[i], a2[i], b0[i], b1[i], b2[i] );
+    BOOST_CHECK_EQUAL( overlap[i] != 0, expected );
+    if(expected)
+      ++hits;
+  }
+  BOOST_CHECK( hits > count/10 );
+  BOOST_CHECK( hits < count - count/10 );
+}
+
+BOOST_AUTO_TEST_CASE(segments_lie_on_both_triangles)
+{
+  size_t const count = 1000;
+  std::vector<vector3_type> a0, a1, a2, b0, b1, b2;
+  make_triangle_pairs( count, a0, a1, a2, b0, b1, b2 );
+
+  std::vector<int> overlap( count );
+  std::vector<int> coplanar( count );
+  std::vector<vector3_type> p( count );
+  std::vector<vector3_type> q( count );
+  OpenTissue::intersect::triangle_triangle_segment_batch( count, &a0[0], &a1[0], &a2[0], &b0[0], &b1[0], &b2[0], &overlap[0], &coplanar[0], &p[0], &q[0] );
+
+  real_type const tol = 10e-7;
+  for(size_t i=0;i<count;++i)
+  {
+    BOOST_CHECK( !coplanar[i] );
+    if(!overlap[i])
+      continue;
+    BOOST_CHECK( on_triangle( p[i], a0[i], a1[i], a2[i], tol ) );
+    BOOST_CHECK( on_triangle( q[i], a0[i], a1[i], a2[i], tol ) );
+    BOOST_CHECK( on_triangle( p[i], b0[i], b1[i], b2[i], tol ) );
+    BOOST_CHECK( on_triangle( q[i], b0[i], b1[i], b2[i], tol ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(known_segment)
+{
+  // Triangle B pierces triangle A, the intersection is the segment from (0,0,0) to (0.5,0,0)
+  vector3_type const a0( -1.0, -1.0, 0.0 );
+  vector3_type const a1(  1.0, -1.0, 0.0 );
+  vector3_type const a2(  0.0,  1.0, 0.0 );
+  vector3_type const b0(  0.0,  0.0, -1.0 );
+  vector3_type const b1(  0.0,  0.0,  1.0 );
+  vector3_type const b2(  0.5,  0.0,  0.0 );
+
+  int overlap  = 0;
+  int coplanar = 0;
+  vector3_type p;
+  vector3_type q;
+  OpenTissue::intersect::triangle_triangle_segment_batch( 1u, &a0, &a1, &a2, &b0, &b1, &b2, &overlap, &coplanar, &p, &q );
+
+  BOOST_CHECK( overlap );
+  BOOST_CHECK( !coplanar );
+  real_type const d0 = length( p ) + length( q - vector3_type(0.5,0.0,0.0) );
+  real_type const d1 = length( q ) + length( p - vector3_type(0.5,0.0,0.0) );
+  BOOST_CHECK_SMALL( std::min(d0,d1), 10e-10 );
+}
+
+BOOST_AUTO_TEST_CASE(coplanar_triangles)
+{
+  vector3_type const a0( 0.0, 0.0, 0.0 );
+  vector3_type const a1( 1.0, 0.0, 0.0 );
+  vector3_type const a2( 0.0, 1.0, 0.0 );
+
+  // Overlapping, separated only in the plane, and separated by a small offset along the normal
+  vector3_type b0[3] = { vector3_type( 0.2, 0.2, 0.0 ), vector3_type( 0.6, 0.6, 0.0 ), vector3_type( 0.2, 0.2, 0.1 ) };
+  vector3_type b1[3] = { vector3_type( 1.2, 0.2, 0.0 ), vector3_type( 1.6, 0.6, 0.0 ), vector3_type( 1.2, 0.2, 0.1 ) };
+  vector3_type b2[3] = { vector3_type( 0.2, 1.2, 0.0 ), vector3_type( 0.6, 1.6, 0.0 ), vector3_type( 0.2, 1.2, 0.1 ) };
+  vector3_type A0[3] = { a0, a0, a0 };
+  vector3_type A1[3] = { a1, a1, a1 };
+  vector3_type A2[3] = { a2, a2, a2 };
+
+  bool overlap[3];
+  bool coplanar[3];
+  vector3_type p[3];
+  vector3_type q[3];
+  OpenTissue::intersect::triangle_triangle_segment_batch( 3u, A0, A1, A2, b0, b1, b2, overlap, coplanar, p, q );
+
+  BOOST_CHECK( overlap[0] );
+  BOOST_CHECK( coplanar[0] );
+  BOOST_CHECK( !overlap[1] );
+  BOOST_CHECK( coplanar[1] );
+  BOOST_CHECK( !overlap[2] );
+  BOOST_CHECK( !coplanar[2] );
+}
+
+BOOST_AUTO_TEST_CASE(leaf_pairs_match_arrays)
+{
+  size_t const triangles = 200;
+  std::vector<vector3_type> vertices( 3*triangles );
+  for(size_t i=0;i<vertices.size();++i)
+    OpenTissue::math::random( vertices[i], -1.0, 1.0 );
+
+  std::vector< std::pair<size_t,size_t> > pairs;
+  std::vector<vector3_type> a0, a1, a2, b0, b1, b2;
+  for(size_t i=0;i<triangles;++i)
+    for(size_t j=i+1;j<triangles;j+=7)
+    {
+      pairs.push_back( std::make_pair( i, j ) );
+      a0.push_back( vertices[3*i] ); a1.push_back( vertices[3*i+1] ); a2.push_back( vertices[3*i+2] );
+      b0.push_back( vertices[3*j] ); b1.push_back( vertices[3*j+1] ); b2.push_back( vertices[3*j+2] );
+    }
+
+  size_t const count = pairs.size();
+  std::vector<int> overlap_pairs( count );
+  std::vector<int> coplanar_pairs( count );
+  std::vector<vector3_type> p_pairs( count );
+  std::vector<vector3_type> q_pairs( count );
+  OpenTissue::intersect::triangle_triangle_batch( pairs, TriangleAccessor( vertices ), &overlap_pairs[0], &coplanar_pairs[0], &p_pairs[0], &q_pairs[0] );
+
+  std::vector<int> overlap( count );
+  std::vector<int> coplanar( count );
+  std::vector<vector3_type> p( count );
+  std::vector<vector3_type> q( count );
+  OpenTissue::intersect::triangle_triangle_segment_batch( count, &a0[0], &a1[0], &a2[0], &b0[0], &b1[0], &b2[0], &overlap[0], &coplanar[0], &p[0], &q[0] );
+
+  for(size_t i=0;i<count;++i)
+  {
+    BOOST_CHECK_EQUAL( overlap_pairs[i], overlap[i] );
+    if(overlap[i])
+    {
+      BOOST_CHECK_SMALL( length( p_pairs[i] - p[i] ), 10e-12 );
+      BOOST_CHECK_SMALL( length( q_pairs[i] - q[i] ), 10e-12 );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -364,4 +364,182 @@ BOOST_AUTO_TEST_CASE(penetrating_cases)
   vclip_test_all_feature_pairs(A,B,AtoB,BtoA, -1.0);
 }
 
+BOOST_AUTO_TEST_CASE(cache_seeds_are_swapped_with_object_order)
+{
+  OpenTissue::vclip::vclip_mesh_type A;
+  OpenTissue::vclip::vclip_mesh_type B;
+  OpenTissue::vclip::vclip_mesh_type C;
+
+  OpenTissue::polymesh::PolyMesh<> tmp;
+  OpenTissue::mesh::make_box(1.0,1.0,1.0, tmp);
+  OpenTissue::vclip::convert(tmp,A);
+  OpenTissue::vclip::convert(tmp,B);
+  OpenTissue::vclip::convert(tmp,C);
+
+  OpenTissue::vclip::Feature * feature_a = &( *A.face_begin() );
+  OpenTissue::vclip::Feature * feature_b = &( *B.vertex_begin() );
+
+  OpenTissue::vclip::Cache cache;
+  BOOST_CHECK( cache.empty() );
+
+  OpenTissue::vclip::Feature * seed_a = 0;
+  OpenTissue::vclip::Feature * seed_b = 0;
+  BOOST_CHECK( !cache.get_seeds(&A,&B,seed_a,seed_b) );
+  BOOST_CHECK( seed_a == 0 );
+  BOOST_CHECK( seed_b == 0 );
+
+  cache.set_seeds(&A,&B,feature_a,feature_b);
+  BOOST_CHECK( !cache.empty() );
+
+  BOOST_CHECK( cache.get_seeds(&A,&B,seed_a,seed_b) );
+  BOOST_CHECK( seed_a == feature_a );
+  BOOST_CHECK( seed_b == feature_b );
+
+  BOOST_CHECK( cache.get_seeds(&B,&A,seed_a,seed_b) );
+  BOOST_CHECK( seed_a == feature_b );
+  BOOST_CHECK( seed_b == feature_a );
+
+  seed_a = 0;
+  seed_b = 0;
+  BOOST_CHECK( !cache.get_seeds(&A,&C,seed_a,seed_b) );
+  BOOST_CHECK( seed_a == 0 );
+  BOOST_CHECK( seed_b == 0 );
+
+  cache.clear();
+  BOOST_CHECK( cache.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(warm_started_runs_match_cold_started_runs)
+{
+  typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+  typedef math_types::vector3_type                         vector3_type;
+  typedef math_types::quaternion_type                      quaternion_type;
+  typedef math_types::coordsys_type                        coordsys_type;
+  typedef math_types::real_type                            real_type;
+
+  OpenTissue::vclip::vclip_mesh_type A;
+  OpenTissue::vclip::vclip_mesh_type B;
+
+  OpenTissue::polymesh::PolyMesh<> tmp;
+  OpenTissue::mesh::make_box(1.0,1.0,1.0, tmp);
+  OpenTissue::vclip::convert(tmp,A);
+  OpenTissue::mesh::make_box(1.0,0.5,0.25, tmp);
+  OpenTissue::vclip::convert(tmp,B);
+
+  OpenTissue::vclip::VClip vclip;
+  OpenTissue::vclip::Cache cache;
+
+  vector3_type p_a;
+  vector3_type p_b;
+
+  coordsys_type Awcs = coordsys_type( vector3_type(0.0,0.0,0.0), quaternion_type() );
+  for(int i=0;i<200;++i)
+  {
+    real_type const t = 0.01*i;
+    quaternion_type Q;
+    Q.Ru( 3.0*t, vector3_type(0.0,0.0,1.0) );
+    coordsys_type Bwcs = coordsys_type( vector3_type( 3.0*std::cos(t), 3.0*std::sin(t), std::sin(5.0*t) ), Q );
+    coordsys_type AtoB = model_update(Awcs,Bwcs);
+    coordsys_type BtoA = inverse(AtoB);
+
+    OpenTissue::vclip::Feature * cold_a = &( *A.vertex_begin() );
+    OpenTissue::vclip::Feature * cold_b = &( *B.vertex_begin() );
+    real_type const cold = vclip.run(A,B,AtoB,BtoA,&cold_a,&cold_b,p_a,p_b);
+
+    OpenTissue::vclip::Feature * warm_a = &( *A.vertex_begin() );
+    OpenTissue::vclip::Feature * warm_b = &( *B.vertex_begin() );
+    cache.get_seeds(&A,&B,warm_a,warm_b);
+    real_type const warm = vclip.run(A,B,AtoB,BtoA,&warm_a,&warm_b,p_a,p_b);
+    cache.set_seeds(&A,&B,warm_a,warm_b);
+
+    BOOST_CHECK( cold > 0.0 );
+    BOOST_CHECK_CLOSE( warm, cold, 0.01 );
+
+    // Witness points must realize the returned distance
+    coordsys_type BtoWCS = Bwcs;
+    coordsys_type AtoWCS = Awcs;
+    AtoWCS.xform_point(p_a);
+    BtoWCS.xform_point(p_b);
+    BOOST_CHECK_CLOSE( length(p_b - p_a), warm, 0.01 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(vertex_vertex_distance)
+{
+  typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+  typedef math_types::vector3_type                         vector3_type;
+  typedef math_types::quaternion_type                      quaternion_type;
+  typedef math_types::coordsys_type                        coordsys_type;
+  typedef math_types::value_traits                         value_traits;
+  typedef math_types::real_type                            real_type;
+
+  OpenTissue::vclip::vclip_mesh_type A;
+  OpenTissue::vclip::vclip_mesh_type B;
+
+  OpenTissue::polymesh::PolyMesh<> tmp;
+  OpenTissue::mesh::make_box(1.0,1.0,1.0, tmp);
+  OpenTissue::vclip::convert(tmp,A);
+  OpenTissue::vclip::convert(tmp,B);
+
+  // Boxes are turned such that the closest features are two corners facing each other
+  quaternion_type Qz;
+  quaternion_type Qy;
+  Qz.Rz( -value_traits::pi()/4.0 );
+  Qy.Ry( std::atan( std::sqrt(0.5) ) );
+  quaternion_type const Q = unit( prod( Qy, Qz ) );
+
+  real_type const half_diagonal = std::sqrt(3.0)*0.5;
+  coordsys_type  Awcs = coordsys_type( vector3_type(-2.0,0.0,0.0), Q );
+  coordsys_type  Bwcs = coordsys_type( vector3_type( 2.0,0.0,0.0), Q );
+  coordsys_type AtoB = model_update(Awcs,Bwcs);
+  coordsys_type BtoA = inverse(AtoB);
+
+  vector3_type p_a;
+  vector3_type p_b;
+  OpenTissue::vclip::VClip vclip;
+  OpenTissue::vclip::Feature * seed_a = &( *A.vertex_begin() );
+  OpenTissue::vclip::Feature * seed_b = &( *B.vertex_begin() );
+  real_type const distance = vclip.run(A,B,AtoB,BtoA,&seed_a,&seed_b,p_a,p_b);
+  BOOST_CHECK_CLOSE( distance, 4.0 - 2.0*half_diagonal, 0.01 );
+  BOOST_CHECK( seed_a->m_type == OpenTissue::vclip::Feature::VERTEX );
+  BOOST_CHECK( seed_b->m_type == OpenTissue::vclip::Feature::VERTEX );
+}
+
+BOOST_AUTO_TEST_CASE(geometry_support_point)
+{
+  typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+  typedef math_types::vector3_type                         vector3_type;
+  typedef math_types::real_type                            real_type;
+
+  OpenTissue::polymesh::PolyMesh<> tmp;
+  OpenTissue::mesh::make_box(2.0,1.0,0.5, tmp);
+
+  OpenTissue::vclip::Geometry<math_types> geometry;
+  geometry.init(tmp);
+
+  BOOST_CHECK( geometry.get_seed()->m_type == OpenTissue::vclip::Feature::VERTEX );
+
+  for(int i=0;i<100;++i)
+  {
+    vector3_type v;
+    OpenTissue::math::random( v, -1.0, 1.0 );
+    vector3_type const s = geometry( v );
+
+    real_type best = -1.0e30;
+    OpenTissue::vclip::vclip_mesh_type::const_vertex_iterator w   = geometry.get_mesh().vertex_begin();
+    OpenTissue::vclip::vclip_mesh_type::const_vertex_iterator end = geometry.get_mesh().vertex_end();
+    for(;w!=end;++w)
+      best = std::max( best, w->m_coord * v );
+    BOOST_CHECK_CLOSE( s * v, best, 0.0001 );
+  }
+
+  vector3_type min_coord;
+  vector3_type max_coord;
+  geometry.compute_collision_aabb( vector3_type(1.0,0.0,0.0), OpenTissue::math::diag(1.0), min_coord, max_coord );
+  BOOST_CHECK_SMALL( min_coord(0), 10e-7 );
+  BOOST_CHECK_CLOSE( max_coord(0), 2.0, 0.01 );
+  BOOST_CHECK_CLOSE( max_coord(1), 0.5, 0.01 );
+  BOOST_CHECK_CLOSE( max_coord(2), 0.25, 0.01 );
+}
+
 BOOST_AUTO_TEST_SUITE_END();
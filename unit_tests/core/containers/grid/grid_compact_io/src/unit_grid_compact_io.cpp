@@ -0,0 +1,246 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/grid_sparse.h>
+#include <OpenTissue/core/containers/grid/io/grid_compact_write.h>
+#include <OpenTissue/core/containers/grid/io/grid_compact_read.h>
+#include <OpenTissue/core/containers/grid/util/grid_sparse_narrow_band.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+typedef OpenTissue::grid::SparseGrid<float,math_types>     sparse_grid_type;
+
+/**
+ * Fills a grid with the signed distance field of a sphere, a few nodes are left unused.
+ */
+void make_sphere_phi(size_t I, size_t J, size_t K, grid_type & phi)
+{
+  phi.create( vector3_type(-1.5,-1.6,-1.7), vector3_type(1.5,1.6,1.7), I, J, K );
+  for(size_t k = 0; k < K; ++k)
+    for(size_t j = 0; j < J; ++j)
+      for(size_t i = 0; i < I; ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( phi, i, j, k, p );
+        phi(i,j,k) = static_cast<float>( length(p) - 1.0 );
+      }
+  phi(0,0,0) = phi.unused();
+  phi(I-1,J-1,K-1) = phi.unused();
+}
+
+void check_same_box(grid_type const & A, grid_type const & B)
+{
+  BOOST_REQUIRE_EQUAL( A.I(), B.I() );
+  BOOST_REQUIRE_EQUAL( A.J(), B.J() );
+  BOOST_REQUIRE_EQUAL( A.K(), B.K() );
+  for(size_t m = 0; m < 3; ++m)
+  {
+    BOOST_CHECK_EQUAL( A.min_coord(m), B.min_coord(m) );
+    BOOST_CHECK_EQUAL( A.max_coord(m), B.max_coord(m) );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_compact_io);
+
+BOOST_AUTO_TEST_CASE(half_conversion)
+{
+  using OpenTissue::grid::detail::float_to_half;
+  using OpenTissue::grid::detail::half_to_float;
+
+  BOOST_CHECK_EQUAL( float_to_half( 0.0f ), 0x0000u );
+  BOOST_CHECK_EQUAL( float_to_half( 1.0f ), 0x3C00u );
+  BOOST_CHECK_EQUAL( float_to_half( -2.0f ), 0xC000u );
+  BOOST_CHECK_EQUAL( float_to_half( 65504.0f ), 0x7BFFu );
+  BOOST_CHECK_EQUAL( float_to_half( 1e6f ), 0x7C00u );
+  BOOST_CHECK_EQUAL( float_to_half( 5.9604645e-8f ), 0x0001u );
+
+  // All finite halfs survive a round trip
+  for(unsigned int h = 0; h < 0x10000u; ++h)
+  {
+    if( (h & 0x7C00u) == 0x7C00u )
+      continue;
+    boost::uint16_t const half = static_cast<boost::uint16_t>( h );
+    BOOST_CHECK_EQUAL( float_to_half( half_to_float( half ) ), half );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(dense_round_trips)
+{
+  grid_type phi;
+  make_sphere_phi( 21, 19, 17, phi );
+  std::string const filename = "unit_grid_compact_io_dense.grid";
+
+  // 32 bit floats are exact
+  BOOST_REQUIRE( OpenTissue::grid::compact_write( filename, phi ) );
+  grid_type G;
+  BOOST_REQUIRE( OpenTissue::grid::compact_read( filename, G ) );
+  check_same_box( phi, G );
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    BOOST_CHECK_EQUAL( G(idx), phi(idx) );
+
+  // 16 bit values are within the quantization error
+  real_type const range = 1.0 + std::sqrt( 1.5*1.5 + 1.6*1.6 + 1.7*1.7 );
+  OpenTissue::grid::compact_encoding const encodings[2] = { OpenTissue::grid::compact_quantized16, OpenTissue::grid::compact_half16 };
+  real_type const tolerances[2] = { range/65534.0, 0.001 };
+  for(size_t e = 0; e < 2; ++e)
+  {
+    BOOST_REQUIRE( OpenTissue::grid::compact_write( filename, phi, encodings[e] ) );
+    grid_type H;
+    BOOST_REQUIRE( OpenTissue::grid::compact_read( filename, H ) );
+    check_same_box( phi, H );
+    for(size_t idx = 0; idx < phi.size(); ++idx)
+    {
+      if( phi(idx) == phi.unused() )
+        BOOST_CHECK_EQUAL( H(idx), H.unused() );
+      else
+        BOOST_CHECK_SMALL( real_type( H(idx) - phi(idx) ), tolerances[e] );
+    }
+  }
+  std::remove( filename.c_str() );
+}
+
+BOOST_AUTO_TEST_CASE(memory_mapped_grid_is_not_copied)
+{
+  grid_type phi;
+  make_sphere_phi( 21, 19, 17, phi );
+  std::string const filename = "unit_grid_compact_io_map.grid";
+  BOOST_REQUIRE( OpenTissue::grid::compact_write( filename, phi ) );
+
+  {
+    OpenTissue::utility::MemoryMappedFile file;
+    grid_type G;
+    BOOST_REQUIRE( OpenTissue::grid::compact_map( filename, file, G ) );
+    BOOST_CHECK( G.external() );
+    BOOST_CHECK( reinterpret_cast<char const *>( G.data() ) >= file.data() );
+    BOOST_CHECK( reinterpret_cast<char const *>( G.data() + G.size() ) <= file.data() + file.size() );
+    check_same_box( phi, G );
+    for(size_t idx = 0; idx < phi.size(); ++idx)
+      BOOST_CHECK_EQUAL( G(idx), phi(idx) );
+
+    // Writes are private to the process
+    G(5,5,5) = 42.0f;
+    BOOST_CHECK_EQUAL( G(5,5,5), 42.0f );
+
+    // Creating the grid again makes it own its values
+    G.create( phi.min_coord(), phi.max_coord(), 4, 4, 4 );
+    BOOST_CHECK( !G.external() );
+  }
+
+  grid_type H;
+  BOOST_REQUIRE( OpenTissue::grid::compact_read( filename, H ) );
+  BOOST_CHECK_EQUAL( H(5,5,5), phi(5,5,5) );
+
+  // Other encodings are decoded into memory owned by the grid
+  BOOST_REQUIRE( OpenTissue::grid::compact_write( filename, phi, OpenTissue::grid::compact_half16 ) );
+  {
+    OpenTissue::utility::MemoryMappedFile file;
+    grid_type G;
+    BOOST_REQUIRE( OpenTissue::grid::compact_map( filename, file, G ) );
+    BOOST_CHECK( !G.external() );
+    BOOST_CHECK_SMALL( real_type( G(5,5,5) - phi(5,5,5) ), 0.001 );
+  }
+  std::remove( filename.c_str() );
+
+  // Assigning to a wrapping grid detaches it, for equal and other dimensions
+  {
+    std::vector<float> values( phi.size(), 7.0f );
+    grid_type G;
+    G.wrap( phi.min_coord(), phi.max_coord(), phi.I(), phi.J(), phi.K(), &values[0] );
+    BOOST_CHECK( G.external() );
+    G = phi;
+    BOOST_CHECK( !G.external() );
+    BOOST_CHECK( G.data() != &values[0] );
+    BOOST_CHECK_EQUAL( G(5,5,5), phi(5,5,5) );
+    BOOST_CHECK_EQUAL( std::count( values.begin(), values.end(), 7.0f ), static_cast<std::ptrdiff_t>( values.size() ) );
+
+    grid_type small;
+    small.create( phi.min_coord(), phi.max_coord(), 4, 4, 4 );
+    G.wrap( phi.min_coord(), phi.max_coord(), phi.I(), phi.J(), phi.K(), &values[0] );
+    G = small;
+    BOOST_CHECK( !G.external() );
+    BOOST_CHECK_EQUAL( G.size(), small.size() );
+    BOOST_CHECK_EQUAL( std::count( values.begin(), values.end(), 7.0f ), static_cast<std::ptrdiff_t>( values.size() ) );
+  }
+
+  // Invalid files are rejected
+  OpenTissue::utility::MemoryMappedFile file;
+  grid_type G;
+  BOOST_CHECK( !OpenTissue::grid::compact_map( "no_such_file.grid", file, G ) );
+}
+
+BOOST_AUTO_TEST_CASE(bricked_narrow_band)
+{
+  grid_type phi;
+  make_sphere_phi( 129, 129, 129, phi );
+  float const band = static_cast<float>( 3.0*phi.dx() );
+  sparse_grid_type sparse;
+  OpenTissue::grid::dense2sparse( phi, band, sparse );
+
+  std::string const dense_filename   = "unit_grid_compact_io_dense.grid";
+  std::string const bricked_filename = "unit_grid_compact_io_bricked.grid";
+  BOOST_REQUIRE( OpenTissue::grid::compact_write( dense_filename, sparse, OpenTissue::grid::compact_quantized16 ) );
+  BOOST_REQUIRE( OpenTissue::grid::compact_write( bricked_filename, sparse, OpenTissue::grid::compact_quantized16, OpenTissue::grid::compact_bricked ) );
+
+  OpenTissue::utility::MemoryMappedFile dense_file;
+  OpenTissue::utility::MemoryMappedFile bricked_file;
+  BOOST_REQUIRE( dense_file.open( dense_filename ) );
+  BOOST_REQUIRE( bricked_file.open( bricked_filename ) );
+  BOOST_CHECK( bricked_file.size() < dense_file.size() / 4 );
+  dense_file.close();
+  bricked_file.close();
+
+  // The quantization error is at most one step of the range of the used values
+  sparse_grid_type const & expected = sparse;
+  real_type lo = 0.0;
+  real_type hi = 0.0;
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    if( expected(idx) == expected.unused() )
+      continue;
+    lo = std::min( lo, real_type( expected(idx) ) );
+    hi = std::max( hi, real_type( expected(idx) ) );
+  }
+  real_type const tolerance = (hi - lo)/65534.0;
+
+  sparse_grid_type S;
+  BOOST_REQUIRE( OpenTissue::grid::compact_read( bricked_filename, S ) );
+  BOOST_CHECK_EQUAL( S.brick_count(), sparse.brick_count() );
+
+  grid_type G;
+  BOOST_REQUIRE( OpenTissue::grid::compact_read( bricked_filename, G ) );
+
+  grid_type D;
+  BOOST_REQUIRE( OpenTissue::grid::compact_read( dense_filename, D ) );
+
+  sparse_grid_type const & S_const  = S;
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    BOOST_CHECK_SMALL( real_type( S_const(idx) - expected(idx) ), tolerance );
+    BOOST_CHECK_SMALL( real_type( G(idx) - expected(idx) ), tolerance );
+    BOOST_CHECK_SMALL( real_type( D(idx) - expected(idx) ), tolerance );
+  }
+  std::remove( dense_filename.c_str() );
+  std::remove( bricked_filename.c_str() );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,165 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_connected_components.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+typedef OpenTissue::grid::Grid<unsigned int,math_types>    label_grid_type;
+typedef OpenTissue::grid::ComponentStatistics<math_types>  statistics_type;
+
+/**
+ * Reference labeling by flood filling from each unlabeled voxel in memory order.
+ */
+size_t flood_fill(grid_type const & image, size_t connectivity, std::vector<size_t> & labels)
+{
+  int const I = static_cast<int>( image.I() );
+  int const J = static_cast<int>( image.J() );
+  int const K = static_cast<int>( image.K() );
+  labels.assign( image.size(), 0 );
+
+  size_t count = 0;
+  std::vector<int> stack;
+  for(int idx = 0; idx < static_cast<int>( image.size() ); ++idx)
+  {
+    if(image(idx) == 0 || labels[idx])
+      continue;
+    labels[idx] = ++count;
+    stack.push_back( idx );
+    while(!stack.empty())
+    {
+      int const cur = stack.back();
+      stack.pop_back();
+      int const i = cur % I;
+      int const j = (cur / I) % J;
+      int const k = cur / (I*J);
+      for(int dk = -1; dk <= 1; ++dk)
+        for(int dj = -1; dj <= 1; ++dj)
+          for(int di = -1; di <= 1; ++di)
+          {
+            size_t const order = std::abs(di) + std::abs(dj) + std::abs(dk);
+            if(order == 0 || (connectivity == 6 && order > 1) || (connectivity == 18 && order > 2))
+              continue;
+            if(i+di < 0 || i+di >= I || j+dj < 0 || j+dj >= J || k+dk < 0 || k+dk >= K)
+              continue;
+            int const nb = ((k+dk)*J + (j+dj))*I + (i+di);
+            if(image(nb) != 0 && !labels[nb])
+            {
+              labels[nb] = count;
+              stack.push_back( nb );
+            }
+          }
+    }
+  }
+  return count;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_connected_components);
+
+BOOST_AUTO_TEST_CASE(random_image)
+{
+  grid_type image;
+  image.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), 23, 19, 37 );
+  std::srand( 7 );
+  for(size_t idx = 0; idx < image.size(); ++idx)
+    image(idx) = (std::rand() % 100 < 30) ? 1.0f : 0.0f;
+
+  size_t const connectivities[3] = { 6, 18, 26 };
+  for(size_t n = 0; n < 3; ++n)
+  {
+    std::vector<size_t> expected;
+    size_t const count = flood_fill( image, connectivities[n], expected );
+
+    label_grid_type components;
+    std::vector<statistics_type> statistics;
+    size_t const found = OpenTissue::grid::connected_components( image, components, connectivities[n], statistics );
+    BOOST_CHECK_EQUAL( found, count );
+    BOOST_CHECK_EQUAL( statistics.size(), count );
+    for(size_t idx = 0; idx < image.size(); ++idx)
+      BOOST_CHECK_EQUAL( components(idx), expected[idx] );
+
+    //--- Brute force statistics
+    std::vector<statistics_type> reference( count );
+    for(size_t k = 0; k < image.K(); ++k)
+      for(size_t j = 0; j < image.J(); ++j)
+        for(size_t i = 0; i < image.I(); ++i)
+        {
+          size_t const label = expected[(k*image.J() + j)*image.I() + i];
+          if(!label)
+            continue;
+          statistics_type & stats = reference[label-1];
+          size_t const index[3] = { i, j, k };
+          for(size_t m = 0; m < 3; ++m)
+          {
+            stats.m_min[m] = std::min( stats.m_min[m], index[m] );
+            stats.m_max[m] = std::max( stats.m_max[m], index[m] );
+          }
+          vector3_type p;
+          OpenTissue::grid::idx2coord( image, i, j, k, p );
+          stats.m_centroid += p;
+          ++stats.m_count;
+        }
+    for(size_t c = 0; c < count && c < statistics.size(); ++c)
+    {
+      BOOST_CHECK_EQUAL( statistics[c].m_count, reference[c].m_count );
+      for(size_t m = 0; m < 3; ++m)
+      {
+        BOOST_CHECK_EQUAL( statistics[c].m_min[m], reference[c].m_min[m] );
+        BOOST_CHECK_EQUAL( statistics[c].m_max[m], reference[c].m_max[m] );
+        BOOST_CHECK_CLOSE( statistics[c].m_centroid(m) + 2.0, reference[c].m_centroid(m)/reference[c].m_count + 2.0, 1e-9 );
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(connectivity)
+{
+  grid_type image;
+  image.create( vector3_type(0.0,0.0,0.0), vector3_type(1.0,1.0,1.0), 5, 5, 20 );
+  std::fill( image.begin(), image.end(), 0.0f );
+  image( 1, 1,  2 ) = 1.0f;   //--- face neighbors
+  image( 1, 1,  3 ) = 1.0f;
+  image( 2, 2,  8 ) = 1.0f;   //--- edge neighbors across a slab border
+  image( 3, 2,  7 ) = 1.0f;
+  image( 2, 2, 16 ) = 1.0f;   //--- corner neighbors across a slab border
+  image( 3, 3, 15 ) = 1.0f;
+
+  label_grid_type components;
+  std::vector<statistics_type> statistics;
+  BOOST_CHECK_EQUAL( OpenTissue::grid::connected_components( image, components,  6, statistics ), 5u );
+  BOOST_CHECK_EQUAL( OpenTissue::grid::connected_components( image, components, 18, statistics ), 4u );
+  BOOST_CHECK_EQUAL( OpenTissue::grid::connected_components( image, components, 26, statistics ), 3u );
+  BOOST_CHECK_EQUAL( statistics[0].m_count, 2u );
+  BOOST_CHECK_EQUAL( components( 3, 2, 7 ), 2u );
+  BOOST_CHECK_EQUAL( components( 2, 2, 8 ), 2u );
+  BOOST_CHECK_EQUAL( statistics[2].m_min[2], 15u );
+  BOOST_CHECK_EQUAL( statistics[2].m_max[2], 16u );
+
+  //--- The old interface is 26-connected
+  grid_type labels;
+  BOOST_CHECK_EQUAL( OpenTissue::grid::connected_components( image, labels ), 3u );
+
+  grid_type empty = image;
+  std::fill( empty.begin(), empty.end(), 0.0f );
+  BOOST_CHECK_EQUAL( OpenTissue::grid::connected_components( empty, labels ), 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,226 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_cpu_voxelizer.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <OpenTissue/core/containers/mesh/polymesh/polymesh.h>
+#include <OpenTissue/core/containers/mesh/trimesh/trimesh.h>
+#include <OpenTissue/core/containers/mesh/common/util/mesh_make_box.h>
+#include <OpenTissue/core/containers/mesh/common/util/mesh_make_sphere.h>
+#include <OpenTissue/core/containers/mesh/common/util/mesh_convert.h>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+typedef OpenTissue::polymesh::PolyMesh<math_types>         polymesh_type;
+typedef OpenTissue::trimesh::TriMesh<math_types>           trimesh_type;
+
+/**
+ * Tests that no path of face neighbors, or of any neighbors if the
+ * voxelization is conservative, leads from the inside to the outside
+ * without passing a voxel of the surface.
+ */
+void check_separating(grid_type const & surface, grid_type const & sign, bool conservative)
+{
+  int const I = static_cast<int>( surface.I() );
+  int const J = static_cast<int>( surface.J() );
+  int const K = static_cast<int>( surface.K() );
+  size_t leaks = 0;
+  for(int k = 0; k < K; ++k)
+    for(int j = 0; j < J; ++j)
+      for(int i = 0; i < I; ++i)
+      {
+        if(surface(i,j,k) || sign(i,j,k) > 0)
+          continue;
+        for(int dk = -1; dk <= 1; ++dk)
+          for(int dj = -1; dj <= 1; ++dj)
+            for(int di = -1; di <= 1; ++di)
+            {
+              if(!conservative && std::abs(di) + std::abs(dj) + std::abs(dk) != 1)
+                continue;
+              if(i+di < 0 || i+di >= I || j+dj < 0 || j+dj >= J || k+dk < 0 || k+dk >= K)
+                continue;
+              if(!surface(i+di,j+dj,k+dk) && sign(i+di,j+dj,k+dk) > 0)
+                ++leaks;
+            }
+      }
+  BOOST_CHECK_EQUAL( leaks, 0u );
+}
+
+/**
+ * Tests if a segment overlaps a box, by clipping the segment against the slabs of the box.
+ */
+bool segment_overlaps_box(vector3_type const & a, vector3_type const & b, vector3_type const & center, real_type const * h)
+{
+  real_type t0 = 0.0;
+  real_type t1 = 1.0;
+  for(int m = 0; m < 3; ++m)
+  {
+    real_type const lo = center(m) - h[m]/2 - a(m);
+    real_type const hi = center(m) + h[m]/2 - a(m);
+    real_type const d  = b(m) - a(m);
+    if(d == 0)
+    {
+      if(lo > 0 || hi < 0)
+        return false;
+      continue;
+    }
+    real_type const s = std::min( lo/d, hi/d );
+    real_type const t = std::max( lo/d, hi/d );
+    t0 = std::max( t0, s );
+    t1 = std::min( t1, t );
+  }
+  return t0 <= t1;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_cpu_voxelizer);
+
+BOOST_AUTO_TEST_CASE(box)
+{
+  real_type const e[3] = { 0.43, 0.37, 0.52 };
+  polymesh_type mesh;
+  OpenTissue::mesh::make_box( 2*e[0], 2*e[1], 2*e[2], mesh );
+
+  grid_type voxels;
+  voxels.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), 21, 21, 21 );
+  grid_type surface = voxels;
+  grid_type sign    = voxels;
+  OpenTissue::grid::voxelize_solid( mesh, voxels );
+  OpenTissue::grid::voxelize_surface( mesh, surface );
+  OpenTissue::grid::voxelize_sign( mesh, sign );
+
+  real_type const h = voxels.dx()/2;
+  for(size_t k = 0; k < voxels.K(); ++k)
+    for(size_t j = 0; j < voxels.J(); ++j)
+      for(size_t i = 0; i < voxels.I(); ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( voxels, i, j, k, p );
+        bool overlap = true;
+        bool contained = true;
+        bool inside = true;
+        for(int m = 0; m < 3; ++m)
+        {
+          overlap   = overlap   && std::fabs( p(m) ) - h <= e[m];
+          contained = contained && std::fabs( p(m) ) + h <  e[m];
+          inside    = inside    && std::fabs( p(m) ) < e[m];
+        }
+        BOOST_CHECK_EQUAL( voxels(i,j,k),  overlap ? 1.0f : 0.0f );
+        BOOST_CHECK_EQUAL( surface(i,j,k), (overlap && !contained) ? 1.0f : 0.0f );
+        BOOST_CHECK_EQUAL( sign(i,j,k),    inside ? -1.0f : 1.0f );
+      }
+}
+
+BOOST_AUTO_TEST_CASE(sphere)
+{
+  polymesh_type sphere;
+  OpenTissue::mesh::make_sphere( 0.6, 17, 13, sphere );
+  trimesh_type mesh;
+  OpenTissue::mesh::convert( sphere, mesh );
+
+  grid_type conservative;
+  conservative.create( vector3_type(-0.9,-0.8,-1.0), vector3_type(0.9,1.0,0.8), 37, 41, 35 );
+  grid_type thin = conservative;
+  grid_type sign = conservative;
+  OpenTissue::grid::voxelize_surface( mesh, conservative, OpenTissue::grid::voxelization_conservative );
+  OpenTissue::grid::voxelize_surface( mesh, thin, OpenTissue::grid::voxelization_6_separating );
+  OpenTissue::grid::voxelize_sign( mesh, sign );
+
+  size_t count_conservative = 0;
+  size_t count_thin         = 0;
+  for(size_t idx = 0; idx < sign.size(); ++idx)
+  {
+    vector3_type p;
+    OpenTissue::grid::idx2coord( sign, idx % sign.I(), (idx / sign.I()) % sign.J(), idx / (sign.I()*sign.J()), p );
+    if(length( p ) < 0.5)
+      BOOST_CHECK_EQUAL( sign(idx), -1.0f );
+    if(length( p ) > 0.61)
+      BOOST_CHECK_EQUAL( sign(idx), 1.0f );
+
+    //--- The thin voxels are a subset of the conservative voxels
+    BOOST_CHECK( thin(idx) <= conservative(idx) );
+    count_conservative += conservative(idx) ? 1 : 0;
+    count_thin         += thin(idx) ? 1 : 0;
+  }
+  BOOST_CHECK( count_thin < count_conservative );
+  BOOST_CHECK( count_thin > 0 );
+
+  //--- The voxels of the mesh vertices are set
+  for(trimesh_type::vertex_iterator v = mesh.vertex_begin(); v != mesh.vertex_end(); ++v)
+  {
+    vector3_type const q = (v->m_coord - conservative.min_coord());
+    size_t const i = static_cast<size_t>( std::floor( q(0)/conservative.dx() + 0.5 ) );
+    size_t const j = static_cast<size_t>( std::floor( q(1)/conservative.dy() + 0.5 ) );
+    size_t const k = static_cast<size_t>( std::floor( q(2)/conservative.dz() + 0.5 ) );
+    BOOST_CHECK_EQUAL( conservative(i,j,k), 1.0f );
+  }
+
+  check_separating( conservative, sign, true );
+  check_separating( thin, sign, false );
+
+  //--- The solid voxelization is the surface and the inside
+  grid_type solid = sign;
+  OpenTissue::grid::voxelize_solid( mesh, solid, OpenTissue::grid::voxelization_6_separating );
+  for(size_t idx = 0; idx < sign.size(); ++idx)
+    BOOST_CHECK_EQUAL( solid(idx), (thin(idx) || sign(idx) < 0) ? 1.0f : 0.0f );
+}
+
+BOOST_AUTO_TEST_CASE(degenerate_triangles)
+{
+  grid_type voxels;
+  voxels.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), 21, 21, 21 );
+  real_type const h[3] = { voxels.dx(), voxels.dy(), voxels.dz() };
+
+  //--- Segments with their middle point as third corner, segments with a repeated corner and a point
+  vector3_type const a( -0.73, -0.41, 0.12 );
+  vector3_type const b(  0.58,  0.29, -0.66 );
+  vector3_type const c(  0.13, -0.62, 0.47 );
+  std::vector<vector3_type> corners;
+  corners.push_back( a );  corners.push_back( b );  corners.push_back( (a + b)*0.5 );
+  corners.push_back( (b + c)*0.5 );  corners.push_back( b );  corners.push_back( c );
+  corners.push_back( c );  corners.push_back( c );  corners.push_back( vector3_type( c(0), c(1), 0.88 ) );
+  corners.push_back( a );  corners.push_back( a );  corners.push_back( a );
+
+  std::fill( voxels.begin(), voxels.end(), 0.0f );
+  OpenTissue::grid::detail::voxelize_triangles( corners, voxels, OpenTissue::grid::voxelization_conservative );
+
+  size_t count = 0;
+  for(size_t k = 0; k < voxels.K(); ++k)
+    for(size_t j = 0; j < voxels.J(); ++j)
+      for(size_t i = 0; i < voxels.I(); ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( voxels, i, j, k, p );
+        bool const overlap =
+          segment_overlaps_box( a, b, p, h )
+          || segment_overlaps_box( b, c, p, h )
+          || segment_overlaps_box( c, vector3_type( c(0), c(1), 0.88 ), p, h )
+          || segment_overlaps_box( a, a, p, h );
+        BOOST_CHECK_EQUAL( voxels(i,j,k), overlap ? 1.0f : 0.0f );
+        count += overlap ? 1 : 0;
+      }
+  BOOST_CHECK( count > 0 );
+
+  //--- Triangles without area have no normal, and set no voxels in a thin voxelization
+  std::fill( voxels.begin(), voxels.end(), 0.0f );
+  OpenTissue::grid::detail::voxelize_triangles( corners, voxels, OpenTissue::grid::voxelization_6_separating );
+  for(size_t idx = 0; idx < voxels.size(); ++idx)
+    BOOST_CHECK_EQUAL( voxels(idx), 0.0f );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
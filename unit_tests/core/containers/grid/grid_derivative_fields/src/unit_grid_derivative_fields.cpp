@@ -0,0 +1,172 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_derivative_fields.h>
+#include <OpenTissue/core/containers/grid/util/grid_upwind_gradient_field.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <cstdlib>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::matrix3x3_type                         matrix3x3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+
+/**
+ * A noisy signed distance field of an ellipsoid on a grid with anisotropic spacing.
+ */
+void make_level_set(grid_type & phi)
+{
+  phi.create( vector3_type(-1.0,-0.8,-1.2), vector3_type(1.0,0.9,1.1), 23, 17, 29 );
+  std::srand( 3 );
+  for(size_t k = 0; k < phi.K(); ++k)
+    for(size_t j = 0; j < phi.J(); ++j)
+      for(size_t i = 0; i < phi.I(); ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( phi, i, j, k, p );
+        p(1) *= 1.5;
+        real_type const noise = 0.01*(std::rand() % 100)/100.0;
+        phi(i,j,k) = static_cast<float>( length( p ) - 0.6 + noise );
+      }
+}
+
+void check_close(float a, float b)
+{
+  BOOST_CHECK( std::fabs( a - b ) <= 1e-4*(1.0 + std::fabs( b )) );
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_derivative_fields);
+
+BOOST_AUTO_TEST_CASE(same_as_pointwise)
+{
+  grid_type phi;
+  make_level_set( phi );
+
+  //--- Unused nodes inside, on the boundary and next to the boundary
+  phi( 11, 8, 14 ) = phi.unused();
+  phi(  0, 5,  7 ) = phi.unused();
+  phi( 21, 1,  3 ) = phi.unused();
+
+  grid_type Nx, Ny, Nz, kappa;
+  OpenTissue::grid::gradient_field( phi, Nx, Ny, Nz );
+  OpenTissue::grid::mean_curvature_field( phi, kappa );
+  BOOST_CHECK_EQUAL( Nx.size(), phi.size() );
+  BOOST_CHECK_EQUAL( kappa.size(), phi.size() );
+
+  for(size_t k = 0; k < phi.K(); ++k)
+    for(size_t j = 0; j < phi.J(); ++j)
+      for(size_t i = 0; i < phi.I(); ++i)
+      {
+        vector3_type g;
+        OpenTissue::grid::gradient( phi, i, j, k, g );
+        check_close( Nx(i,j,k), static_cast<float>( g(0) ) );
+        check_close( Ny(i,j,k), static_cast<float>( g(1) ) );
+        check_close( Nz(i,j,k), static_cast<float>( g(2) ) );
+
+        real_type K = 0;
+        OpenTissue::grid::mean_curvature( phi, i, j, k, K );
+        check_close( kappa(i,j,k), static_cast<float>( K ) );
+      }
+}
+
+BOOST_AUTO_TEST_CASE(fused)
+{
+  grid_type phi;
+  make_level_set( phi );
+
+  grid_type Nx, Ny, Nz, kappa;
+  OpenTissue::grid::gradient_field( phi, Nx, Ny, Nz );
+  OpenTissue::grid::mean_curvature_field( phi, kappa );
+
+  grid_type Mx, My, Mz, curvature;
+  OpenTissue::grid::gradient_and_mean_curvature_field( phi, Mx, My, Mz, curvature );
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    BOOST_CHECK_EQUAL( Mx(idx), Nx(idx) );
+    BOOST_CHECK_EQUAL( My(idx), Ny(idx) );
+    BOOST_CHECK_EQUAL( Mz(idx), Nz(idx) );
+    BOOST_CHECK_EQUAL( curvature(idx), kappa(idx) );
+  }
+
+  //--- The curvature of a sphere is 2/r away from the noise
+  grid_type sphere;
+  sphere.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), 41, 41, 41 );
+  for(size_t k = 0; k < sphere.K(); ++k)
+    for(size_t j = 0; j < sphere.J(); ++j)
+      for(size_t i = 0; i < sphere.I(); ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( sphere, i, j, k, p );
+        sphere(i,j,k) = static_cast<float>( length( p ) );
+      }
+  OpenTissue::grid::mean_curvature_field( sphere, kappa );
+  BOOST_CHECK_CLOSE( kappa( 30, 20, 20 ), 2.0f/0.5f, 1.0 );
+  BOOST_CHECK_CLOSE( kappa( 20, 28, 28 ), 2.0f/static_cast<float>( std::sqrt(2.0)*0.4 ), 1.0 );
+}
+
+BOOST_AUTO_TEST_CASE(hessian_same_as_pointwise)
+{
+  grid_type phi;
+  make_level_set( phi );
+
+  grid_type Hxx, Hyy, Hzz, Hxy, Hxz, Hyz;
+  OpenTissue::grid::hessian_field( phi, Hxx, Hyy, Hzz, Hxy, Hxz, Hyz );
+  BOOST_CHECK_EQUAL( Hxx.size(), phi.size() );
+
+  for(size_t k = 0; k < phi.K(); ++k)
+    for(size_t j = 0; j < phi.J(); ++j)
+      for(size_t i = 0; i < phi.I(); ++i)
+      {
+        matrix3x3_type H;
+        OpenTissue::grid::hessian( phi, i, j, k, H );
+        check_close( Hxx(i,j,k), static_cast<float>( H(0,0) ) );
+        check_close( Hyy(i,j,k), static_cast<float>( H(1,1) ) );
+        check_close( Hzz(i,j,k), static_cast<float>( H(2,2) ) );
+        check_close( Hxy(i,j,k), static_cast<float>( H(0,1) ) );
+        check_close( Hxz(i,j,k), static_cast<float>( H(0,2) ) );
+        check_close( Hyz(i,j,k), static_cast<float>( H(1,2) ) );
+      }
+}
+
+BOOST_AUTO_TEST_CASE(upwind_same_as_pointwise)
+{
+  grid_type phi;
+  make_level_set( phi );
+
+  //--- Positive, negative and zero speeds
+  grid_type F = phi;
+  for(size_t idx = 0; idx < F.size(); ++idx)
+    F(idx) = static_cast<float>( static_cast<int>( std::rand() % 3 ) - 1 );
+
+  grid_type Nx, Ny, Nz;
+  OpenTissue::grid::upwind_gradient_field( phi, F, Nx, Ny, Nz );
+  BOOST_CHECK_EQUAL( Nx.size(), phi.size() );
+
+  for(size_t k = 0; k < phi.K(); ++k)
+    for(size_t j = 0; j < phi.J(); ++j)
+      for(size_t i = 0; i < phi.I(); ++i)
+      {
+        vector3_type g;
+        OpenTissue::grid::upwind_gradient( phi, F, i, j, k, g );
+        check_close( Nx(i,j,k), static_cast<float>( g(0) ) );
+        check_close( Ny(i,j,k), static_cast<float>( g(1) ) );
+        check_close( Nz(i,j,k), static_cast<float>( g(2) ) );
+      }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
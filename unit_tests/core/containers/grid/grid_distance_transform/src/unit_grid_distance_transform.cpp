@@ -0,0 +1,159 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_distance_transform.h>
+#include <OpenTissue/core/containers/grid/util/grid_opening.h>
+#include <OpenTissue/core/containers/grid/util/grid_closing.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <vector>
+#include <limits>
+#include <cstdlib>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+typedef OpenTissue::grid::Grid<double,math_types>          distance_grid_type;
+
+vector3_type coord(grid_type const & image, size_t idx)
+{
+  vector3_type p;
+  OpenTissue::grid::idx2coord( image, idx % image.I(), (idx / image.I()) % image.J(), idx / (image.I()*image.J()), p );
+  return p;
+}
+
+/**
+ * Reference squared distances by testing all pairs of nodes.
+ */
+void brute_force(grid_type const & image, bool foreground, std::vector<real_type> & distance)
+{
+  distance.assign( image.size(), std::numeric_limits<real_type>::infinity() );
+  for(size_t a = 0; a < image.size(); ++a)
+  {
+    if((image(a) != 0) != foreground)
+      continue;
+    vector3_type const p = coord( image, a );
+    for(size_t b = 0; b < image.size(); ++b)
+      distance[b] = std::min( distance[b], sqr_length( coord( image, b ) - p ) );
+  }
+}
+
+void make_image(grid_type & image, int percent)
+{
+  image.create( vector3_type(0.0,0.0,0.0), vector3_type(1.2,1.3,2.4), 13, 11, 17 );
+  for(size_t idx = 0; idx < image.size(); ++idx)
+    image(idx) = (std::rand() % 100 < percent) ? 1.0f : 0.0f;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_distance_transform);
+
+BOOST_AUTO_TEST_CASE(exact_distances)
+{
+  std::srand( 11 );
+  int const percents[3] = { 1, 10, 60 };
+  for(int n = 0; n < 3; ++n)
+  {
+    grid_type image;
+    make_image( image, percents[n] );
+
+    std::vector<real_type> expected;
+    brute_force( image, true, expected );
+
+    distance_grid_type squared;
+    OpenTissue::grid::squared_distance_transform( image, squared );
+    BOOST_CHECK_EQUAL( squared.size(), image.size() );
+    for(size_t idx = 0; idx < image.size(); ++idx)
+      BOOST_CHECK_CLOSE( squared(idx) + 1.0, expected[idx] + 1.0, 1e-9 );
+
+    //--- In place with float distances
+    grid_type distance = image;
+    OpenTissue::grid::distance_transform( distance, distance );
+    for(size_t idx = 0; idx < image.size(); ++idx)
+      BOOST_CHECK_CLOSE( distance(idx) + 1.0, std::sqrt( expected[idx] ) + 1.0, 1e-4 );
+  }
+
+  //--- Without feature nodes all distances are infinite
+  grid_type empty;
+  make_image( empty, 0 );
+  grid_type distance;
+  OpenTissue::grid::distance_transform( empty, distance );
+  for(size_t idx = 0; idx < distance.size(); ++idx)
+    BOOST_CHECK( !(distance(idx) < std::numeric_limits<float>::infinity()) );
+}
+
+BOOST_AUTO_TEST_CASE(morphology)
+{
+  std::srand( 5 );
+  grid_type image;
+  make_image( image, 20 );
+
+  std::vector<real_type> outside;
+  std::vector<real_type> inside;
+  brute_force( image, true, outside );
+  brute_force( image, false, inside );
+
+  real_type const radii[3] = { 0.0, 0.17, 0.43 };
+  for(int n = 0; n < 3; ++n)
+  {
+    real_type const r2 = radii[n]*radii[n];
+
+    grid_type dilated;
+    grid_type eroded;
+    OpenTissue::grid::dilation( image, radii[n], dilated );
+    OpenTissue::grid::erosion( image, radii[n], eroded );
+    for(size_t idx = 0; idx < image.size(); ++idx)
+    {
+      BOOST_CHECK_EQUAL( dilated(idx), outside[idx] <= r2 ? 1.0f : 0.0f );
+      BOOST_CHECK_EQUAL( eroded(idx), inside[idx] > r2 ? 1.0f : 0.0f );
+    }
+
+    //--- The opening is inside the image and the closing contains it
+    grid_type opened;
+    grid_type closed = image;
+    OpenTissue::grid::opening( image, radii[n], opened );
+    OpenTissue::grid::closing( closed, radii[n], closed );
+    for(size_t idx = 0; idx < image.size(); ++idx)
+    {
+      BOOST_CHECK( opened(idx) <= image(idx) );
+      BOOST_CHECK( closed(idx) >= image(idx) );
+      if(n == 0)
+      {
+        BOOST_CHECK_EQUAL( opened(idx), image(idx) );
+        BOOST_CHECK_EQUAL( closed(idx), image(idx) );
+      }
+    }
+  }
+
+  //--- A ball keeps its core when opened by a smaller ball but vanishes by a larger one
+  grid_type ball;
+  ball.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), 41, 41, 41 );
+  for(size_t idx = 0; idx < ball.size(); ++idx)
+    ball(idx) = length( coord( ball, idx ) ) < 0.5 ? 1.0f : 0.0f;
+  grid_type opened;
+  OpenTissue::grid::opening( ball, 0.3, opened );
+  for(size_t idx = 0; idx < ball.size(); ++idx)
+  {
+    BOOST_CHECK( opened(idx) <= ball(idx) );
+    if(length( coord( ball, idx ) ) <= 0.3)
+      BOOST_CHECK_EQUAL( opened(idx), 1.0f );
+  }
+  OpenTissue::grid::opening( ball, 0.55, opened );
+  for(size_t idx = 0; idx < ball.size(); ++idx)
+    BOOST_CHECK_EQUAL( opened(idx), 0.0f );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,192 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_narrow_band.h>
+#include <OpenTissue/core/containers/grid/util/grid_curvature_flow.h>
+#include <OpenTissue/core/containers/grid/util/grid_chan_vese.h>
+#include <OpenTissue/core/containers/grid/util/grid_metamorphosis.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+typedef OpenTissue::grid::NarrowBand<grid_type>            band_type;
+
+vector3_type node_coord(grid_type const & phi, size_t idx)
+{
+  size_t const i = idx % phi.I();
+  size_t const j = (idx / phi.I()) % phi.J();
+  size_t const k = idx / (phi.I()*phi.J());
+  vector3_type p;
+  OpenTissue::grid::idx2coord( phi, i, j, k, p );
+  return p;
+}
+
+/**
+ * Fills a grid with a level set function of a sphere, which is not a signed distance field.
+ */
+void make_sphere(size_t N, vector3_type const & center, real_type radius, grid_type & phi)
+{
+  phi.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), N, N, N );
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    vector3_type const p = node_coord( phi, idx ) - center;
+    phi(idx) = static_cast<float>( inner_prod(p,p) - radius*radius );
+  }
+}
+
+real_type inside_volume(grid_type const & phi)
+{
+  size_t count = 0;
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    if(phi(idx) < 0)
+      ++count;
+  return count*phi.dx()*phi.dy()*phi.dz();
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_narrow_band);
+
+BOOST_AUTO_TEST_CASE(init_and_rebuild)
+{
+  grid_type phi;
+  make_sphere( 48, vector3_type(0,0,0), 0.5, phi );
+  real_type const h     = phi.dx();
+  real_type const width = 3.0*h;
+
+  band_type band;
+  band.init( phi, width );
+  BOOST_CHECK( band.size() > 0 );
+  BOOST_CHECK( band.size() < phi.size()/5 );
+  BOOST_CHECK( !band.needs_rebuild( phi ) );
+
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    real_type const exact = length( node_coord( phi, idx ) ) - 0.5;
+    if(band.contains( idx ))
+      BOOST_CHECK( std::fabs( phi(idx) - exact ) < 0.5*h );
+    else
+      BOOST_CHECK_EQUAL( std::fabs( phi(idx) ), static_cast<float>( width ) );
+  }
+
+  //--- Grow the sphere by moving the values in the band only
+  std::vector<size_t> const & active = band.active();
+  for(size_t n = 0; n < active.size(); ++n)
+    phi( active[n] ) -= static_cast<float>( 2.0*h );
+  BOOST_CHECK( band.needs_rebuild( phi ) );
+
+  band.rebuild( phi );
+  BOOST_CHECK( !band.needs_rebuild( phi ) );
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    real_type const exact = length( node_coord( phi, idx ) ) - (0.5 + 2.0*h);
+    if(band.contains( idx ))
+      BOOST_CHECK( std::fabs( phi(idx) - exact ) < 0.5*h );
+    else
+      BOOST_CHECK_EQUAL( std::fabs( phi(idx) ), static_cast<float>( width ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(curvature_flow)
+{
+  grid_type phi;
+  make_sphere( 48, vector3_type(0,0,0), 0.6, phi );
+
+  band_type band;
+  band.init( phi, 3.0*phi.dx() );
+
+  //--- A sphere shrinks under mean curvature flow as r^2 = r0^2 - 4 mu t
+  real_type const mu   = 1.0;
+  real_type const time = 0.02;
+  size_t const steps = OpenTissue::grid::curvature_flow( phi, mu, time, band );
+  BOOST_CHECK( steps > 0 );
+
+  real_type const expected = std::sqrt( 0.36 - 4.0*mu*time );
+  real_type const radius   = std::pow( 3.0*inside_volume( phi )/(4.0*M_PI), 1.0/3.0 );
+  BOOST_CHECK( std::fabs( radius - expected ) < 0.5*phi.dx() );
+}
+
+BOOST_AUTO_TEST_CASE(full_grid_curvature_flow)
+{
+  grid_type phi;
+  make_sphere( 48, vector3_type(0,0,0), 0.6, phi );
+
+  //--- The full grid update gives the same shrinking sphere as the narrow band update
+  real_type const mu   = 1.0;
+  real_type const time = 0.02;
+  grid_type psi;
+  OpenTissue::grid::curvature_flow( phi, mu, time, psi );
+
+  real_type const expected = std::sqrt( 0.36 - 4.0*mu*time );
+  real_type const radius   = std::pow( 3.0*inside_volume( psi )/(4.0*M_PI), 1.0/3.0 );
+  BOOST_CHECK( std::fabs( radius - expected ) < 0.5*phi.dx() );
+
+  //--- Input and output may be the same grid
+  OpenTissue::grid::curvature_flow( phi, mu, time, phi );
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    BOOST_CHECK_EQUAL( phi(idx), psi(idx) );
+}
+
+BOOST_AUTO_TEST_CASE(chan_vese)
+{
+  grid_type phi;
+  make_sphere( 40, vector3_type(0,0,0), 0.3, phi );
+  real_type const h = phi.dx();
+
+  //--- A bright box on a dark background
+  grid_type U = phi;
+  for(size_t idx = 0; idx < U.size(); ++idx)
+  {
+    vector3_type const p = node_coord( U, idx );
+    bool const inside = std::fabs( p(0) ) < 0.4 && std::fabs( p(1) ) < 0.4 && std::fabs( p(2) ) < 0.4;
+    U(idx) = inside ? 1.0f : 0.0f;
+  }
+
+  band_type band;
+  band.init( phi, 3.0*h );
+  OpenTissue::grid::chan_vese_auto_in_out( phi, U, 0.5, 0.0, 0.0, 0.02, band, 10e-7, 200 );
+
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    vector3_type const p = node_coord( phi, idx );
+    real_type const distance = std::max( std::fabs( p(0) ), std::max( std::fabs( p(1) ), std::fabs( p(2) ) ) ) - 0.4;
+    if(std::fabs( distance ) > h)
+      BOOST_CHECK_EQUAL( phi(idx) < 0, distance < 0 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(metamorphosis)
+{
+  grid_type phi;
+  grid_type gamma;
+  make_sphere( 40, vector3_type(0,0,0), 0.5, phi );
+  make_sphere( 40, vector3_type(0.25,0,0), 0.5, gamma );
+  real_type const h = phi.dx();
+
+  band_type target;
+  target.init( gamma, 1.0 );   //--- turns gamma into a signed distance field
+
+  band_type band;
+  band.init( phi, 3.0*h );
+  OpenTissue::grid::metamorphosis( phi, gamma, 2.0, band );
+
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    if(std::fabs( gamma(idx) ) > h)
+      BOOST_CHECK_EQUAL( phi(idx) < 0, gamma(idx) < 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,154 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_multigrid_poisson_solver.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<double,math_types>          grid_type;
+
+/**
+ * Creates a grid holding a smooth function.
+ */
+void make_solution(size_t I, size_t J, size_t K, grid_type & u)
+{
+  u.create( vector3_type(-1.0,-0.5,-0.25), vector3_type(1.0,0.5,0.25), I, J, K );
+  for(size_t k = 0; k < K; ++k)
+    for(size_t j = 0; j < J; ++j)
+      for(size_t i = 0; i < I; ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( u, i, j, k, p );
+        u(i,j,k) = std::sin( 2.0*p(0) )*std::cos( 3.0*p(1) ) + p(2)*p(2) + 0.5*p(0)*p(1);
+      }
+}
+
+/**
+ * Mirrors an index at the boundary of an axis with N nodes.
+ */
+size_t mirror(long const n, size_t const N)
+{
+  if(n < 0)
+    return 1;
+  if(n >= static_cast<long>(N))
+    return N - 2;
+  return n;
+}
+
+/**
+ * Applies the seven point Laplacian, neighbors outside the grid
+ * are mirrored (Neumann boundary conditions).
+ */
+void laplacian(grid_type const & u, grid_type & W)
+{
+  W = u;
+  size_t const I = u.I();
+  size_t const J = u.J();
+  size_t const K = u.K();
+  for(size_t k = 0; k < K; ++k)
+    for(size_t j = 0; j < J; ++j)
+      for(size_t i = 0; i < I; ++i)
+      {
+        real_type const c = u(i,j,k);
+        real_type const xx = u( mirror( i - 1, I ), j, k ) + u( mirror( i + 1, I ), j, k ) - 2*c;
+        real_type const yy = u( i, mirror( j - 1, J ), k ) + u( i, mirror( j + 1, J ), k ) - 2*c;
+        real_type const zz = u( i, j, mirror( k - 1, K ) ) + u( i, j, mirror( k + 1, K ) ) - 2*c;
+        W(i,j,k) = xx/(u.dx()*u.dx()) + yy/(u.dy()*u.dy()) + zz/(u.dz()*u.dz());
+      }
+}
+
+real_type max_difference(grid_type const & A, grid_type const & B)
+{
+  real_type diff = 0;
+  for(size_t idx = 0; idx < A.size(); ++idx)
+    diff = std::max( diff, std::fabs( A(idx) - B(idx) ) );
+  return diff;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_poisson);
+
+BOOST_AUTO_TEST_CASE(dirichlet_boundary)
+{
+  size_t const sizes[][3] = { {33,33,33}, {40,17,9} };
+  for(size_t s = 0; s < 2; ++s)
+  {
+    grid_type solution;
+    grid_type W;
+    make_solution( sizes[s][0], sizes[s][1], sizes[s][2], solution );
+    laplacian( solution, W );
+
+    //--- Boundary values are taken from the solution, the interior starts at zero
+    grid_type phi = solution;
+    for(size_t k = 1; k + 1 < phi.K(); ++k)
+      for(size_t j = 1; j + 1 < phi.J(); ++j)
+        for(size_t i = 1; i + 1 < phi.I(); ++i)
+          phi(i,j,k) = 0;
+
+    size_t const cycles = OpenTissue::grid::multigrid_poisson_solver( phi, W, true, 1e-10 );
+    BOOST_CHECK( cycles > 0 );
+    BOOST_CHECK( cycles < 20 );
+    BOOST_CHECK( max_difference( phi, solution ) < 1e-7 );
+
+    //--- W-cycles converge at least as fast
+    for(size_t k = 1; k + 1 < phi.K(); ++k)
+      for(size_t j = 1; j + 1 < phi.J(); ++j)
+        for(size_t i = 1; i + 1 < phi.I(); ++i)
+          phi(i,j,k) = 0;
+    BOOST_CHECK( OpenTissue::grid::multigrid_poisson_solver( phi, W, true, 1e-10, 30, 2 ) <= cycles );
+    BOOST_CHECK( max_difference( phi, solution ) < 1e-7 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(neumann_boundary)
+{
+  grid_type solution;
+  grid_type W;
+  make_solution( 48, 25, 13, solution );
+  laplacian( solution, W );
+
+  real_type mean = 0;
+  for(size_t idx = 0; idx < solution.size(); ++idx)
+    mean += solution(idx);
+  mean /= solution.size();
+
+  //--- The solution is unique up to a constant, which keeps the mean of the initial guess
+  grid_type phi = solution;
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    phi(idx) = 1.0;
+
+  size_t const cycles = OpenTissue::grid::multigrid_poisson_solver( phi, W, false, 1e-10 );
+  BOOST_CHECK( cycles > 0 );
+  BOOST_CHECK( cycles < 20 );
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    phi(idx) -= 1.0 - mean;
+  BOOST_CHECK( max_difference( phi, solution ) < 1e-6 );
+
+  //--- An incompatible right hand side has its mean value ignored
+  for(size_t idx = 0; idx < W.size(); ++idx)
+    W(idx) += 3.0;
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    phi(idx) = mean;
+  BOOST_CHECK( OpenTissue::grid::multigrid_poisson_solver( phi, W, false, 1e-10 ) < 20 );
+  BOOST_CHECK( max_difference( phi, solution ) < 1e-6 );
+
+  //--- A converged solution needs no cycles
+  BOOST_CHECK_EQUAL( OpenTissue::grid::multigrid_poisson_solver( solution, W, false, 1.0 ), 1u );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,135 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_redistance.h>
+#include <OpenTissue/core/containers/grid/util/grid_gradient_at_point.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+
+real_type const radius = 0.6;
+
+/**
+ * Fills a grid with a level set function of a sphere that is far from a signed distance field.
+ */
+void make_level_set(size_t N, grid_type & phi)
+{
+  phi.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), N, N, N );
+  for(size_t k = 0; k < N; ++k)
+    for(size_t j = 0; j < N; ++j)
+      for(size_t i = 0; i < N; ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( phi, i, j, k, p );
+        phi(i,j,k) = static_cast<float>( (inner_prod(p,p) - radius*radius)*(2.0 + p(0)) );
+      }
+}
+
+real_type exact_distance(grid_type const & phi, size_t idx)
+{
+  size_t const i = idx % phi.I();
+  size_t const j = (idx / phi.I()) % phi.J();
+  size_t const k = idx / (phi.I()*phi.J());
+  vector3_type p;
+  OpenTissue::grid::idx2coord( phi, i, j, k, p );
+  return length(p) - radius;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_redistance);
+
+BOOST_AUTO_TEST_CASE(marching_and_sweeping)
+{
+  grid_type phi;
+  make_level_set( 41, phi );
+  real_type const h = phi.dx();
+
+  grid_type marched;
+  grid_type swept;
+  OpenTissue::grid::redistance( phi, marched, OpenTissue::grid::FastMarchingRedistance() );
+  OpenTissue::grid::redistance( phi, swept, OpenTissue::grid::FastSweepingRedistance() );
+
+  //--- First order accurate, so the error grows slowly away from the interface
+  real_type max_error           = 0;
+  real_type max_interface_error = 0;
+  real_type max_diff            = 0;
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    BOOST_CHECK( marched(idx) != marched.unused() );
+    BOOST_CHECK( swept(idx) != swept.unused() );
+    BOOST_CHECK_EQUAL( marched(idx) < 0, phi(idx) < 0 );
+    real_type const exact = exact_distance( phi, idx );
+    real_type const error = std::fabs( marched(idx) - exact );
+    max_error = std::max( max_error, error );
+    if(std::fabs( exact ) < 2.0*h)
+      max_interface_error = std::max( max_interface_error, error );
+    max_diff  = std::max( max_diff,  std::fabs( static_cast<real_type>( marched(idx) - swept(idx) ) ) );
+  }
+  BOOST_CHECK( max_error < 1.5*h );
+  BOOST_CHECK( max_interface_error < 0.5*h );
+  BOOST_CHECK( max_diff < 1e-4 );
+
+  //--- Normals computed from the redistanced grid point away from the center
+  for(size_t n = 0; n < 100; ++n)
+  {
+    real_type const theta = 3.0*n/100.0;
+    real_type const phi_angle = 0.7*n;
+    vector3_type const direction( std::sin(theta)*std::cos(phi_angle), std::sin(theta)*std::sin(phi_angle), std::cos(theta) );
+    vector3_type const normal = unit( OpenTissue::grid::gradient_at_point( marched, direction*radius ) );
+    BOOST_CHECK( inner_prod( normal, direction ) > 0.995 );
+  }
+
+  //--- The result may overwrite the input
+  grid_type in_place = phi;
+  OpenTissue::grid::redistance( in_place, in_place, OpenTissue::grid::FastMarchingRedistance() );
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    BOOST_CHECK_EQUAL( in_place(idx), marched(idx) );
+}
+
+BOOST_AUTO_TEST_CASE(narrow_band)
+{
+  grid_type phi;
+  make_level_set( 41, phi );
+  real_type const band = 0.2;
+
+  grid_type full;
+  grid_type narrow;
+  OpenTissue::grid::redistance( phi, full, OpenTissue::grid::FastMarchingRedistance() );
+  OpenTissue::grid::redistance( phi, narrow, OpenTissue::grid::FastMarchingRedistance( band ) );
+
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+  {
+    if(std::fabs( full(idx) ) <= band)
+      BOOST_CHECK_EQUAL( narrow(idx), full(idx) );
+    else
+      BOOST_CHECK_EQUAL( std::fabs( narrow(idx) ), static_cast<float>( band ) );
+    BOOST_CHECK_EQUAL( narrow(idx) < 0, phi(idx) < 0 );
+  }
+
+  //--- Without any zero level set nothing is changed
+  grid_type positive = phi;
+  for(size_t idx = 0; idx < positive.size(); ++idx)
+    positive(idx) = 1.0f;
+  grid_type result;
+  OpenTissue::grid::redistance( positive, result, OpenTissue::grid::FastSweepingRedistance() );
+  for(size_t idx = 0; idx < positive.size(); ++idx)
+    BOOST_CHECK_EQUAL( result(idx), 1.0f );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
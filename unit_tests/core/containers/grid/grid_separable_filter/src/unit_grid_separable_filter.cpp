@@ -0,0 +1,179 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_gaussian_convolution.h>
+#include <OpenTissue/core/containers/grid/util/grid_box_filter.h>
+#include <OpenTissue/core/containers/grid/util/grid_approximate_gaussian_filter.h>
+#include <OpenTissue/core/containers/grid/util/grid_fast_blur.h>
+#include <cmath>
+#include <cstdlib>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+typedef OpenTissue::grid::Grid<double,math_types>          reference_type;
+
+/**
+ * Fills a grid of odd dimensions with random values.
+ */
+void make_grid(grid_type & G)
+{
+  G.create( vector3_type(0,0,0), vector3_type(1,1,1), 37, 19, 23 );
+  std::srand( 1 );
+  for(size_t idx = 0; idx < G.size(); ++idx)
+    G(idx) = static_cast<float>( std::rand() ) / RAND_MAX;
+}
+
+/**
+ * Straightforward convolution of a grid along one axis.
+ */
+void convolve(reference_type & G, int axis, std::vector<double> const & w, int origin, OpenTissue::grid::boundary_type boundary)
+{
+  reference_type const src = G;
+  int const n[3] = { (int)G.I(), (int)G.J(), (int)G.K() };
+  for(int k = 0; k < n[2]; ++k)
+    for(int j = 0; j < n[1]; ++j)
+      for(int i = 0; i < n[0]; ++i)
+      {
+        double sum = 0.0;
+        for(int a = 0; a < (int)w.size(); ++a)
+        {
+          int index[3] = { i, j, k };
+          int const q = OpenTissue::grid::detail::boundary_index( index[axis] + a - origin, n[axis], boundary );
+          if(q < 0)
+            continue;
+          index[axis] = q;
+          sum += w[a]*src( index[0], index[1], index[2] );
+        }
+        G(i,j,k) = sum;
+      }
+}
+
+template<typename grid_a, typename grid_b>
+double max_difference(grid_a const & A, grid_b const & B)
+{
+  double diff = 0.0;
+  for(size_t idx = 0; idx < A.size(); ++idx)
+    diff = std::max( diff, std::fabs( static_cast<double>( A(idx) ) - static_cast<double>( B(idx) ) ) );
+  return diff;
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_separable_filter);
+
+BOOST_AUTO_TEST_CASE(gaussian_convolution)
+{
+  grid_type src;
+  make_grid( src );
+  src(5,6,7) = OpenTissue::math::detail::highest<float>();
+
+  grid_type dst = src;
+  OpenTissue::grid::gaussian_convolution( src, dst, 1.0, 1.5, 0.5 );
+
+  reference_type R;
+  R.create( src.min_coord(), src.max_coord(), src.I(), src.J(), src.K() );
+  for(size_t idx = 0; idx < src.size(); ++idx)
+    R(idx) = src(idx);
+  R(5,6,7) = 0.0;
+  double const sigma[3] = { 1.0, 1.5, 0.5 };
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    int const half = static_cast<int>( std::ceil( 2.0*sigma[axis] ) );
+    std::vector<double> G( 2*half + 1 );
+    OpenTissue::grid::detail::compute_gaussian_kernel( G, sigma[axis] );
+    convolve( R, axis, G, half, OpenTissue::grid::boundary_mirror );
+    R(5,6,7) = 0.0;
+  }
+  R(5,6,7) = OpenTissue::math::detail::highest<float>();
+  BOOST_CHECK( max_difference( dst, R ) < 1e-5 );
+
+  //--- In place gives the same result
+  grid_type in_place = src;
+  OpenTissue::grid::gaussian_convolution( in_place, in_place, 1.0, 1.5, 0.5 );
+  BOOST_CHECK( max_difference( dst, in_place ) == 0.0 );
+}
+
+BOOST_AUTO_TEST_CASE(box_filter)
+{
+  grid_type src;
+  make_grid( src );
+
+  for(size_t size = 2; size <= 5; ++size)
+  {
+    grid_type dst = src;
+    OpenTissue::grid::box_filter( src, size, dst );
+
+    reference_type R;
+    R.create( src.min_coord(), src.max_coord(), src.I(), src.J(), src.K() );
+    for(size_t idx = 0; idx < src.size(); ++idx)
+      R(idx) = src(idx);
+    std::vector<double> w( size, 1.0/size );
+    for(int axis = 0; axis < 3; ++axis)
+      convolve( R, axis, w, static_cast<int>( size - 1 - size/2 ), OpenTissue::grid::boundary_zero );
+    BOOST_CHECK( max_difference( dst, R ) < 1e-5 );
+  }
+
+  //--- Two even sized boxes are centered
+  grid_type dst;
+  OpenTissue::grid::approximate_gaussian_filter( src, 2, 4, dst );
+  reference_type R;
+  R.create( src.min_coord(), src.max_coord(), src.I(), src.J(), src.K() );
+  for(size_t idx = 0; idx < src.size(); ++idx)
+    R(idx) = src(idx);
+  std::vector<double> w( 4, 0.25 );
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    convolve( R, axis, w, 1, OpenTissue::grid::boundary_zero );
+    convolve( R, axis, w, 2, OpenTissue::grid::boundary_zero );
+  }
+  BOOST_CHECK( max_difference( dst, R ) < 1e-5 );
+}
+
+BOOST_AUTO_TEST_CASE(fast_blur)
+{
+  grid_type src;
+  make_grid( src );
+
+  grid_type dst = src;
+  OpenTissue::grid::fast_blur( dst, 1.3, 0.125, 1 );
+
+  //--- Second differences with linearly interpolated samples at distance 1.3
+  reference_type R;
+  R.create( src.min_coord(), src.max_coord(), src.I(), src.J(), src.K() );
+  int const n[3] = { (int)src.I(), (int)src.J(), (int)src.K() };
+  for(int k = 0; k < n[2]; ++k)
+    for(int j = 0; j < n[1]; ++j)
+      for(int i = 0; i < n[0]; ++i)
+      {
+        double laplace = 0.0;
+        for(int axis = 0; axis < 3; ++axis)
+          for(int side = -1; side <= 1; side += 2)
+          {
+            int index[3] = { i, j, k };
+            double const x = index[axis] + side*1.3;
+            int const q = static_cast<int>( std::floor( x ) );
+            double const t = x - q;
+            index[axis] = std::min( std::max( q, 0 ), n[axis] - 1 );
+            double const a = src( index[0], index[1], index[2] );
+            index[axis] = std::min( std::max( q + 1, 0 ), n[axis] - 1 );
+            double const b = src( index[0], index[1], index[2] );
+            laplace += (1.0 - t)*a + t*b - src(i,j,k);
+          }
+        R(i,j,k) = src(i,j,k) + 0.125*laplace;
+      }
+  BOOST_CHECK( max_difference( dst, R ) < 1e-5 );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,284 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/grid_sparse.h>
+#include <OpenTissue/core/containers/grid/util/grid_sparse_narrow_band.h>
+#include <OpenTissue/core/containers/grid/util/grid_value_at_point.h>
+#include <OpenTissue/core/containers/grid/util/grid_gradient_at_point.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <OpenTissue/core/containers/mesh/polymesh/polymesh.h>
+#include <OpenTissue/core/containers/mesh/polymesh/util/polymesh_make_sphere.h>
+#include <OpenTissue/core/containers/mesh/polymesh/util/polymesh_compute_face_normal.h>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           dense_grid_type;
+typedef OpenTissue::grid::SparseGrid<float,math_types>     sparse_grid_type;
+typedef OpenTissue::polymesh::PolyMesh<math_types>         mesh_type;
+
+/**
+ * Fills a dense grid with the signed distance field of a sphere centered at the origin.
+ */
+void make_sphere_phi(size_t N, real_type radius, dense_grid_type & phi)
+{
+  phi.create( vector3_type(-1.6,-1.6,-1.6), vector3_type(1.6,1.6,1.6), N, N, N );
+  for(size_t k = 0; k < N; ++k)
+    for(size_t j = 0; j < N; ++j)
+      for(size_t i = 0; i < N; ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( phi, i, j, k, p );
+        phi(i,j,k) = static_cast<float>( length(p) - radius );
+      }
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_grid_sparse);
+
+BOOST_AUTO_TEST_CASE(read_write_access)
+{
+  sparse_grid_type G;
+  size_t const I = 20;
+  size_t const J = 17;
+  size_t const K = 9;
+  G.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), I, J, K );
+
+  BOOST_CHECK_EQUAL( G.size(), I*J*K );
+  BOOST_CHECK_EQUAL( G.tile_count(), 3u*3u*2u );
+  BOOST_CHECK_EQUAL( G.brick_count(), 0u );
+
+  sparse_grid_type const & H = G;
+  for(size_t k = 0; k < K; ++k)
+    for(size_t j = 0; j < J; ++j)
+      for(size_t i = 0; i < I; ++i)
+        BOOST_CHECK_EQUAL( H(i,j,k), G.unused() );
+
+  // Writing a single node activates exactly one tile
+  G(9,16,8) = 1.0f;
+  BOOST_CHECK_EQUAL( G.brick_count(), 1u );
+  BOOST_CHECK_EQUAL( H(9,16,8), 1.0f );
+  BOOST_CHECK_EQUAL( H(10,16,8), G.unused() );
+  BOOST_CHECK_EQUAL( H(8,16,8), G.unused() );
+
+  // Linear indices follow the layout of the dense grid
+  size_t linear_index = 0;
+  for(size_t k = 0; k < K; ++k)
+    for(size_t j = 0; j < J; ++j)
+      for(size_t i = 0; i < I; ++i, ++linear_index)
+        G(i,j,k) = static_cast<float>( linear_index );
+  BOOST_CHECK_EQUAL( G.brick_count(), G.tile_count() );
+  for(size_t idx = 0; idx < G.size(); ++idx)
+    BOOST_CHECK_EQUAL( H(idx), static_cast<float>( idx ) );
+
+  // Deactivated bricks are reused
+  G.deactivate( 0, -2.0f );
+  BOOST_CHECK_EQUAL( G.brick_count(), G.tile_count() - 1 );
+  BOOST_CHECK_EQUAL( H(3,3,3), -2.0f );
+  G.activate( 0 );
+  BOOST_CHECK_EQUAL( G.brick_count(), G.tile_count() );
+  BOOST_CHECK_EQUAL( H(3,3,3), -2.0f );
+}
+
+BOOST_AUTO_TEST_CASE(dense_to_sparse_lookups_match_dense)
+{
+  size_t const N = 129;
+  real_type const radius = 1.0;
+  dense_grid_type dense;
+  make_sphere_phi( N, radius, dense );
+
+  float const band = static_cast<float>( 4.0*dense.dx() );
+  sparse_grid_type sparse;
+  OpenTissue::grid::dense2sparse( dense, band, sparse );
+
+  BOOST_CHECK( sparse.brick_count() > 0u );
+  BOOST_CHECK( sparse.brick_count() < sparse.tile_count() / 4 );
+  BOOST_CHECK( sparse.memory_usage() < N*N*N*sizeof(float) / 4 );
+
+  // Far field tiles carry the sign of the distance field
+  BOOST_CHECK_EQUAL( sparse(N/2,N/2,N/2), -band );
+  BOOST_CHECK_EQUAL( sparse(0,0,0), band );
+
+  // Close to the surface all stencil nodes are in active tiles, so lookups are exact
+  OpenTissue::math::Random<real_type> random(-1.0,1.0);
+  for(size_t test = 0; test < 1000; ++test)
+  {
+    vector3_type direction( random(), random(), random() );
+    if( length(direction) < 0.01 )
+      continue;
+    vector3_type const p = unit( direction )*( radius + dense.dx()*random() );
+
+    real_type const expected_value = OpenTissue::grid::value_at_point( dense, p );
+    real_type const value          = OpenTissue::grid::value_at_point( sparse, p );
+    BOOST_CHECK_EQUAL( value, expected_value );
+
+    vector3_type const expected_gradient = OpenTissue::grid::gradient_at_point( dense, p );
+    vector3_type const gradient          = OpenTissue::grid::gradient_at_point( sparse, p );
+    BOOST_CHECK_SMALL( length( gradient - expected_gradient ), 1e-10 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mesh2phi_narrow_band)
+{
+  real_type const radius = 1.0;
+  mesh_type surface;
+  OpenTissue::polymesh::make_sphere( radius, 4, surface );
+
+  size_t const resolution = 256;
+  real_type const band = 0.05;
+  sparse_grid_type phi;
+  OpenTissue::grid::mesh2phi_narrow_band( surface, phi, band, resolution );
+
+  BOOST_CHECK( phi.I() >= resolution );
+  BOOST_CHECK_CLOSE( phi.dx(), phi.dy(), 1e-6 );
+  BOOST_CHECK_CLOSE( phi.dx(), phi.dz(), 1e-6 );
+  BOOST_CHECK( 4.0*phi.dx() < band );
+
+  // A dense float grid of the same resolution needs about 70MB
+  BOOST_CHECK( phi.memory_usage() < phi.size()*sizeof(float) / 4 );
+
+  for(size_t k = 0; k < phi.K(); k += 3)
+    for(size_t j = 0; j < phi.J(); j += 3)
+      for(size_t i = 0; i < phi.I(); i += 3)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( phi, i, j, k, p );
+        real_type const expected = length(p) - radius;
+        real_type const value    = phi(i,j,k);
+        if( std::fabs(expected) < band/2 )
+          BOOST_CHECK_SMALL( value - expected, 0.005 );
+        else
+          BOOST_CHECK( value*expected > 0.0 );
+        BOOST_CHECK( std::fabs(value) <= band + 1e-6 );
+      }
+
+  // Lookups away from the grid nodes agree with the analytic distance and normal
+  OpenTissue::math::Random<real_type> random(-1.0,1.0);
+  for(size_t test = 0; test < 1000; ++test)
+  {
+    vector3_type direction( random(), random(), random() );
+    if( length(direction) < 0.01 )
+      continue;
+    direction = unit( direction );
+    vector3_type const p = direction*( radius + 0.01*random() );
+
+    real_type const value = OpenTissue::grid::value_at_point( phi, p );
+    BOOST_CHECK_SMALL( value - (length(p) - radius), 0.005 );
+
+    vector3_type const gradient = OpenTissue::grid::gradient_at_point( phi, p );
+    BOOST_CHECK( unit( gradient )*direction > 0.99 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(iterators)
+{
+  sparse_grid_type G;
+  G.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), 11, 10, 9 );
+  G(5,5,5) = 2.0f;
+
+  //--- Read only traversal does not activate tiles
+  sparse_grid_type const & H = G;
+  size_t idx = 0;
+  for(sparse_grid_type::const_index_iterator it = H.begin(); it != H.end(); ++it, ++idx)
+  {
+    BOOST_CHECK_EQUAL( (it.k()*H.J() + it.j())*H.I() + it.i(), idx );
+    BOOST_CHECK_EQUAL( *it, H(idx) );
+  }
+  BOOST_CHECK_EQUAL( idx, G.size() );
+  BOOST_CHECK_EQUAL( G.brick_count(), 1u );
+
+  for(sparse_grid_type::iterator it = G.begin(); it != G.end(); ++it)
+    *it = static_cast<float>( it.i() + 100*it.j() + 10000*it.k() );
+  BOOST_CHECK_EQUAL( G.brick_count(), G.tile_count() );
+  BOOST_CHECK_EQUAL( H(3,7,8), 80703.0f );
+
+  sparse_grid_type::const_iterator last = H.end();
+  --last;
+  BOOST_CHECK_EQUAL( *last, H(10,9,8) );
+  BOOST_CHECK_EQUAL( H.end() - H.begin(), static_cast<std::ptrdiff_t>( H.size() ) );
+}
+
+BOOST_AUTO_TEST_CASE(brick_start_beyond_int_range)
+{
+  // From 2^22 bricks on the pool offsets do not fit in an int
+  int const b = (1 << 22) + 5;
+  BOOST_CHECK_EQUAL( sparse_grid_type::brick_start( 0 ), 0u );
+  BOOST_CHECK_EQUAL( sparse_grid_type::brick_start( 3 ), 3u*sparse_grid_type::brick_volume );
+  if(sizeof(size_t) > 4)
+  {
+    size_t const expected = static_cast<size_t>( b )*512u;
+    BOOST_CHECK_EQUAL( sparse_grid_type::brick_start( b ), expected );
+    BOOST_CHECK( sparse_grid_type::brick_start( b ) > static_cast<size_t>( 2147483647 ) );
+    BOOST_CHECK_EQUAL( sparse_grid_type::brick_start( b + 1 ) - sparse_grid_type::brick_start( b ), 512u );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(paged_backing_file)
+{
+  std::string const filename = "unit_grid_sparse_backing.bricks";
+
+  sparse_grid_type G;
+  G.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), 70, 65, 60 );
+  G(1,2,3) = 5.0f;
+  BOOST_REQUIRE( G.page_out( filename ) );
+  BOOST_CHECK( G.is_paged() );
+  BOOST_CHECK( G.backing_size() > 0u );
+  BOOST_CHECK_EQUAL( G(1,2,3), 5.0f );
+
+  //--- Activating every tile grows the backing file, not the memory
+  size_t const memory = G.memory_usage();
+  for(size_t k = 0; k < G.K(); ++k)
+    for(size_t j = 0; j < G.J(); ++j)
+      for(size_t i = 0; i < G.I(); ++i)
+        G(i,j,k) = static_cast<float>( (k*G.J() + j)*G.I() + i );
+  BOOST_CHECK_EQUAL( G.brick_count(), G.tile_count() );
+  BOOST_CHECK_EQUAL( G.memory_usage(), memory );
+  BOOST_CHECK( G.backing_size() >= G.tile_count()*sparse_grid_type::brick_volume*sizeof(float) );
+
+  sparse_grid_type const & H = G;
+  for(size_t idx = 0; idx < G.size(); ++idx)
+    BOOST_CHECK_EQUAL( H(idx), static_cast<float>( idx ) );
+
+  //--- Compacting shrinks the backing file
+  for(size_t tile = 1; tile < G.tile_count(); tile += 2)
+    G.deactivate( tile, -1.0f );
+  size_t const used = G.brick_count();
+  G.compact();
+  BOOST_CHECK_EQUAL( G.brick_count(), used );
+  BOOST_CHECK_EQUAL( G.backing_size(), used*sparse_grid_type::brick_volume*sizeof(float) );
+
+  //--- Copies and paged in grids keep the values
+  sparse_grid_type copy = G;
+  BOOST_CHECK( !copy.is_paged() );
+  G.flush();
+  G.page_in();
+  BOOST_CHECK( !G.is_paged() );
+  for(size_t k = 0; k < G.K(); ++k)
+    for(size_t j = 0; j < G.J(); ++j)
+      for(size_t i = 0; i < G.I(); ++i)
+      {
+        size_t const tile = G.tile_index(i,j,k);
+        float const expected = (tile % 2) ? -1.0f : static_cast<float>( (k*G.J() + j)*G.I() + i );
+        BOOST_CHECK_EQUAL( H(i,j,k), expected );
+        BOOST_CHECK_EQUAL( static_cast<sparse_grid_type const &>( copy )(i,j,k), expected );
+      }
+
+  std::remove( filename.c_str() );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
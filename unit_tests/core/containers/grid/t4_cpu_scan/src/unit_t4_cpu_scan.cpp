@@ -9,6 +9,8 @@
 #include <OpenTissue/core/containers/grid/grid.h>
 #include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
 #include <OpenTissue/core/geometry/t4_cpu_scan/t4_cpu_scan.h>
+#include <OpenTissue/core/containers/grid/util/grid_mesh2phi.h>
+#include <OpenTissue/core/containers/grid/util/grid_fast_sweeping.h>
 #include <OpenTissue/core/containers/mesh/polymesh/polymesh.h>
 #include <OpenTissue/core/containers/mesh/polymesh/util/polymesh_make_sphere.h>
 #include <OpenTissue/core/containers/mesh/polymesh/util/polymesh_compute_face_normal.h>
@@ -98,5 +100,73 @@ BOOST_AUTO_TEST_CASE(unsigned_test_case)
       }
 }
 
+BOOST_AUTO_TEST_CASE(parallel_matches_serial)
+{
+  typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+  typedef math_types::vector3_type                         vector3_type;
+  typedef OpenTissue::grid::Grid<float,math_types>         grid_type;
+  typedef OpenTissue::polymesh::PolyMesh<math_types>       mesh_type;
+
+  mesh_type surface;
+  OpenTissue::polymesh::make_sphere( 1.0, 3, surface );
+
+  size_t const N = 37;
+  double const thickness = 0.3;
+
+  grid_type serial;
+  grid_type parallel;
+
+  serial.create(vector3_type(-1.5,-1.5,-1.5),vector3_type(1.5,1.5,1.5), N, N, N);
+  parallel.create(vector3_type(-1.5,-1.5,-1.5),vector3_type(1.5,1.5,1.5), N, N, N);
+  OpenTissue::detail::t4_cpu_scan_serial( surface, thickness, serial, OpenTissue::t4_cpu_signed() );
+  OpenTissue::t4_cpu_scan( surface, thickness, parallel, OpenTissue::t4_cpu_signed() );
+  for(size_t idx = 0;idx<serial.size();++idx)
+    BOOST_CHECK_EQUAL( serial(idx), parallel(idx) );
+
+  serial.create(vector3_type(-1.5,-1.5,-1.5),vector3_type(1.5,1.5,1.5), N, N, N);
+  parallel.create(vector3_type(-1.5,-1.5,-1.5),vector3_type(1.5,1.5,1.5), N, N, N);
+  OpenTissue::detail::t4_cpu_scan_serial( surface, thickness, serial, OpenTissue::t4_cpu_unsigned() );
+  OpenTissue::t4_cpu_scan( surface, thickness, parallel, OpenTissue::t4_cpu_unsigned() );
+  for(size_t idx = 0;idx<serial.size();++idx)
+    BOOST_CHECK_EQUAL( serial(idx), parallel(idx) );
+}
+
+BOOST_AUTO_TEST_CASE(fast_sweeping_test_case)
+{
+  using std::fabs;
+
+  typedef OpenTissue::math::BasicMathTypes<double, size_t> math_types;
+  typedef math_types::vector3_type                         vector3_type;
+  typedef math_types::real_type                            real_type;
+  typedef OpenTissue::grid::Grid<float,math_types>         grid_type;
+  typedef OpenTissue::polymesh::PolyMesh<math_types>       mesh_type;
+
+  real_type const radius = 1.0;
+  mesh_type surface;
+  OpenTissue::polymesh::make_sphere( radius, 4, surface );
+
+  grid_type phi;
+  OpenTissue::grid::mesh2phi_fast_sweeping( surface, phi, 0.5, 64 );
+
+  for(size_t k = 0;k<phi.K();++k)
+    for(size_t j = 0;j<phi.J();++j)
+      for(size_t i = 0;i<phi.I();++i)
+      {
+        vector3_type coord;
+        OpenTissue::grid::idx2coord(phi, i,j,k,coord);
+        real_type const tst   = OpenTissue::math::length(coord) - radius;
+        real_type const value = phi(i,j,k);
+        BOOST_CHECK( value != phi.unused() );
+        //--- Scan converted distances are exact up to the tessellation of the sphere
+        if( fabs(tst) < phi.dx() )
+          BOOST_CHECK_SMALL( value - tst, 0.01 );
+        else
+        {
+          //--- Swept distances have the right sign and are first order accurate
+          BOOST_CHECK( value*tst > 0.0 );
+          BOOST_CHECK_SMALL( value - tst, 0.1*fabs(tst) + phi.dx() );
+        }
+      }
+}
 
 BOOST_AUTO_TEST_SUITE_END();
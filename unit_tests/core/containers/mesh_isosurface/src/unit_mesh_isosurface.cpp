@@ -0,0 +1,162 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/core/math/math_basic_types.h>
+#include <OpenTissue/core/containers/grid/grid.h>
+#include <OpenTissue/core/containers/grid/util/grid_idx2coord.h>
+#include <OpenTissue/core/containers/mesh/trimesh/trimesh.h>
+#include <OpenTissue/core/containers/mesh/polymesh/polymesh.h>
+#include <OpenTissue/core/containers/mesh/common/util/mesh_isosurface.h>
+#include <cmath>
+
+#define BOOST_AUTO_TEST_MAIN
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+typedef OpenTissue::math::BasicMathTypes<double, size_t>   math_types;
+typedef math_types::vector3_type                           vector3_type;
+typedef math_types::real_type                              real_type;
+typedef OpenTissue::grid::Grid<float,math_types>           grid_type;
+typedef OpenTissue::trimesh::TriMesh<math_types>           trimesh_type;
+typedef OpenTissue::polymesh::PolyMesh<math_types>         polymesh_type;
+
+/**
+ * Fills a grid with the signed distance field of a sphere.
+ */
+void make_sphere(size_t N, real_type radius, grid_type & phi)
+{
+  phi.create( vector3_type(-1.0,-1.0,-1.0), vector3_type(1.0,1.0,1.0), N, N, N );
+  for(size_t k = 0; k < phi.K(); ++k)
+    for(size_t j = 0; j < phi.J(); ++j)
+      for(size_t i = 0; i < phi.I(); ++i)
+      {
+        vector3_type p;
+        OpenTissue::grid::idx2coord( phi, i, j, k, p );
+        phi(i,j,k) = static_cast<float>( length(p) - radius );
+      }
+}
+
+/**
+ * Counts the grid edges that cross the zero level set.
+ */
+size_t count_crossing_edges(grid_type const & phi)
+{
+  size_t count = 0;
+  for(size_t k = 0; k < phi.K(); ++k)
+    for(size_t j = 0; j < phi.J(); ++j)
+      for(size_t i = 0; i < phi.I(); ++i)
+      {
+        bool const below = phi(i,j,k) < 0;
+        if(i + 1 < phi.I() && (phi(i+1,j,k) < 0) != below) ++count;
+        if(j + 1 < phi.J() && (phi(i,j+1,k) < 0) != below) ++count;
+        if(k + 1 < phi.K() && (phi(i,j,k+1) < 0) != below) ++count;
+      }
+  return count;
+}
+
+void check_same(trimesh_type const & A, trimesh_type const & B)
+{
+  BOOST_CHECK_EQUAL( A.size_vertices(), B.size_vertices() );
+  BOOST_CHECK_EQUAL( A.size_faces(), B.size_faces() );
+  if(A.size_vertices() != B.size_vertices() || A.size_faces() != B.size_faces())
+    return;
+
+  trimesh_type::const_vertex_iterator a = A.vertex_begin();
+  trimesh_type::const_vertex_iterator b = B.vertex_begin();
+  for(; a != A.vertex_end(); ++a, ++b)
+    BOOST_CHECK( a->m_coord == b->m_coord );
+
+  trimesh_type::const_face_iterator f = A.face_begin();
+  trimesh_type::const_face_iterator g = B.face_begin();
+  for(; f != A.face_end(); ++f, ++g)
+  {
+    BOOST_CHECK_EQUAL( f->get_vertex0_handle().get_idx(), g->get_vertex0_handle().get_idx() );
+    BOOST_CHECK_EQUAL( f->get_vertex1_handle().get_idx(), g->get_vertex1_handle().get_idx() );
+    BOOST_CHECK_EQUAL( f->get_vertex2_handle().get_idx(), g->get_vertex2_handle().get_idx() );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_mesh_isosurface);
+
+BOOST_AUTO_TEST_CASE(sphere)
+{
+  grid_type phi;
+  make_sphere( 33, 0.6, phi );
+
+  trimesh_type mesh;
+  OpenTissue::mesh::isosurface( phi, 0.0f, mesh );
+
+  //--- One welded vertex for each crossing edge
+  BOOST_CHECK_EQUAL( mesh.size_vertices(), count_crossing_edges( phi ) );
+  BOOST_CHECK( mesh.size_faces() > 0 );
+
+  for(trimesh_type::vertex_iterator v = mesh.vertex_begin(); v != mesh.vertex_end(); ++v)
+    BOOST_CHECK( std::fabs( length( v->m_coord ) - 0.6 ) < 0.05*phi.dx() );
+
+  //--- A closed surface of genus zero
+  polymesh_type surface;
+  OpenTissue::mesh::isosurface( phi, 0.0f, surface );
+  long const V = static_cast<long>( surface.size_vertices() );
+  long const E = static_cast<long>( surface.size_edges() );
+  long const F = static_cast<long>( surface.size_faces() );
+  BOOST_CHECK_EQUAL( V, static_cast<long>( mesh.size_vertices() ) );
+  BOOST_CHECK_EQUAL( 2*E, 3*F );
+  BOOST_CHECK_EQUAL( V - E + F, 2 );
+}
+
+BOOST_AUTO_TEST_CASE(slab_size)
+{
+  grid_type phi;
+  make_sphere( 29, 0.7, phi );
+
+  trimesh_type reference;
+  OpenTissue::mesh::detail::IsoSurfaceGenerator single( phi.K() );
+  single( phi, 0.0f, reference );
+  BOOST_CHECK( reference.size_faces() > 0 );
+
+  for(size_t slab_size = 1; slab_size < 6; ++slab_size)
+  {
+    trimesh_type mesh;
+    OpenTissue::mesh::detail::IsoSurfaceGenerator iso( slab_size );
+    iso( phi, 0.0f, mesh );
+    check_same( reference, mesh );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(narrow_band)
+{
+  grid_type phi;
+  make_sphere( 33, 0.5, phi );
+  real_type const h = phi.dx();
+
+  trimesh_type reference;
+  OpenTissue::mesh::isosurface( phi, 0.0f, reference );
+
+  std::vector<size_t> nodes;
+  for(size_t idx = 0; idx < phi.size(); ++idx)
+    if(std::fabs( phi(idx) ) < 2.0*h)
+      nodes.push_back( idx );
+  BOOST_CHECK( nodes.size() < phi.size()/4 );
+
+  trimesh_type mesh;
+  OpenTissue::mesh::isosurface( phi, 0.0f, nodes, mesh );
+  check_same( reference, mesh );
+
+  //--- Cells with unused nodes are skipped in both modes
+  for(size_t k = 0; k < phi.K(); ++k)
+    for(size_t j = 0; j < phi.J(); ++j)
+      phi(phi.I()/2,j,k) = phi.unused();
+  OpenTissue::mesh::isosurface( phi, 0.0f, reference );
+  OpenTissue::mesh::isosurface( phi, 0.0f, nodes, mesh );
+  check_same( reference, mesh );
+  BOOST_CHECK( reference.size_vertices() < count_crossing_edges( phi ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
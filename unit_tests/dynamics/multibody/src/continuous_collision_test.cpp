@@ -0,0 +1,119 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/dynamics/mbd/math/mbd_default_math_policy.h>
+#include <OpenTissue/dynamics/mbd/mbd.h>
+
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+template<typename types>
+class ContinuousTestCollisionDetection
+  : public OpenTissue::mbd::CollisionDetection<
+  types
+  , OpenTissue::mbd::SpatialHashing
+  , OpenTissue::mbd::GeometryDispatcher
+  , OpenTissue::mbd::SingleGroupAnalysis
+  >
+{};
+
+template< typename types  >
+class ContinuousTestStepper
+  : public OpenTissue::mbd::DynamicsStepper< types, OpenTissue::mbd::ProjectedGaussSeidel<typename types::math_policy> >
+{};
+
+template<typename simulator_type>
+size_t get_substeps(simulator_type const & /*simulator*/) { return 0u; }
+
+template<typename types>
+size_t get_substeps(OpenTissue::mbd::ContinuousFixedStepSimulator<types> const & simulator) { return simulator.get_substeps(); }
+
+/**
+* Drops a small fast sphere onto a thin fixed box and returns the final height of the sphere.
+*/
+template<template <typename> class simulator_policy>
+double drop_fast_sphere(size_t & substeps)
+{
+  typedef OpenTissue::mbd::Types<
+    OpenTissue::mbd::default_ublas_math_policy<double>
+    , OpenTissue::mbd::NoSleepyPolicy
+    , ContinuousTestStepper
+    , ContinuousTestCollisionDetection
+    , simulator_policy
+  > types;
+
+  typedef typename types::math_policy                  math_policy;
+  typedef typename math_policy::vector3_type           vector3_type;
+  typedef typename math_policy::matrix3x3_type         matrix3x3_type;
+  typedef typename types::simulator_type               simulator_type;
+  typedef typename types::body_type                    body_type;
+  typedef typename types::configuration_type           configuration_type;
+  typedef typename types::material_library_type        material_library_type;
+  typedef OpenTissue::geometry::Sphere<math_policy>    sphere_type;
+  typedef OpenTissue::geometry::OBB<math_policy>       box_type;
+
+  box_type               box;
+  sphere_type            sphere;
+  body_type              floor;
+  body_type              ball;
+  material_library_type  library;
+  simulator_type         simulator;
+  configuration_type     configuration;  // Declared last such that it is destroyed before the bodies
+
+  matrix3x3_type const R = OpenTissue::math::diag( 1.0 );
+  box.set( vector3_type(0.0, 0.0, 0.0), R, vector3_type(1.0, 1.0, 0.02) );
+  sphere.radius( 0.1 );
+
+  floor.set_position( vector3_type(0.0, 0.0, 0.0) );
+  floor.set_geometry( &box );
+  floor.set_fixed( true );
+  configuration.add( &floor );
+
+  ball.set_position( vector3_type(0.0, 0.0, 1.0) );
+  ball.set_velocity( vector3_type(0.0, 0.0, -60.0) );
+  ball.set_geometry( &sphere );
+  configuration.add( &ball );
+
+  configuration.set_material_library( library );
+  library.default_material()->normal_restitution() = 0.0;
+
+  simulator.init( configuration );
+  OpenTissue::mbd::setup_default_geometry_dispatcher( simulator );
+
+  substeps = 0u;
+  for(size_t i=0u;i<10u;++i)
+  {
+    simulator.run( 0.01 );
+    substeps += get_substeps( simulator );
+  }
+
+  vector3_type r;
+  ball.get_position( r );
+  return r(2);
+}
+
+BOOST_AUTO_TEST_SUITE(opentissue_dynamics_multibody_continuous_collision_detection);
+
+BOOST_AUTO_TEST_CASE(fast_sphere_tunnels_without_ccd)
+{
+  size_t substeps = 0u;
+  double const z = drop_fast_sphere<OpenTissue::mbd::ExplicitFixedStepSimulator>( substeps );
+  BOOST_CHECK( z < -0.5 );
+}
+
+BOOST_AUTO_TEST_CASE(fast_sphere_stops_with_ccd)
+{
+  size_t substeps = 0u;
+  double const z = drop_fast_sphere<OpenTissue::mbd::ContinuousFixedStepSimulator>( substeps );
+  BOOST_CHECK( z > 0.0 );
+  BOOST_CHECK( z < 0.2 );
+  BOOST_CHECK( substeps > 0u );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -21,4 +21,5 @@ void (*case5_ptr4)() = &(simulator_type_compile_test<math_types, test5,OpenTissu
 void (*case5_ptr5)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case5_ptr6)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 //void (*case5_ptr7)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case5_ptr8)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::ContinuousFixedStepSimulator> );
 
@@ -20,3 +20,4 @@ void (*case4_ptr4)() = &(simulator_type_compile_test<math_types, test4,OpenTissu
 void (*case4_ptr5)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case4_ptr6)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 //void (*case4_ptr7)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case4_ptr8)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::ContinuousFixedStepSimulator> );
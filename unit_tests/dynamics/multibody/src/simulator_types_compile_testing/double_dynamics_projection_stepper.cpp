@@ -20,3 +20,4 @@ void (*case3_ptr4)() = &(simulator_type_compile_test<math_types, test3,OpenTissu
 void (*case3_ptr5)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case3_ptr6)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*case3_ptr7)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case3_ptr8)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::ContinuousFixedStepSimulator> );
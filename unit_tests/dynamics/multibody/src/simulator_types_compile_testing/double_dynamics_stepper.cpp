@@ -20,3 +20,4 @@ void (*case1_ptr4)() = &(simulator_type_compile_test<math_types, test1,OpenTissu
 void (*case1_ptr5)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case1_ptr6)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*case1_ptr7)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case1_ptr8)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::ContinuousFixedStepSimulator> );
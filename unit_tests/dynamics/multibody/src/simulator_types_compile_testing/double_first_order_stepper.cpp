@@ -20,3 +20,4 @@ void (*case2_ptr4)() = &(simulator_type_compile_test<math_types, test2,OpenTissu
 void (*case2_ptr5)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case2_ptr6)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*case2_ptr7)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case2_ptr8)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::ContinuousFixedStepSimulator> );
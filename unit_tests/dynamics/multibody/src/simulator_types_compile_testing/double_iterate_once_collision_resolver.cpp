@@ -20,4 +20,5 @@ void (*case6_ptr4)() = &(simulator_type_compile_test<math_types, test6,OpenTissu
 void (*case6_ptr5)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case6_ptr6)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*case6_ptr7)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case6_ptr8)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::ContinuousFixedStepSimulator> );
 
@@ -20,4 +20,5 @@ void (*case7_ptr4)() = &(simulator_type_compile_test<math_types, test7,OpenTissu
 void (*case7_ptr5)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case7_ptr6)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*case7_ptr7)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case7_ptr8)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::ContinuousFixedStepSimulator> );
 
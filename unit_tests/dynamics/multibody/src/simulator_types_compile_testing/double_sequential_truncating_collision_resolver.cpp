@@ -20,3 +20,4 @@ void (*case8_ptr4)() = &(simulator_type_compile_test<math_types, test8,OpenTissu
 void (*case8_ptr5)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*case8_ptr6)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*case8_ptr7)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*case8_ptr8)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::ContinuousFixedStepSimulator> );
@@ -20,4 +20,5 @@ void (*fcase5_ptr4)() = &(simulator_type_compile_test<math_types, test5,OpenTiss
 void (*fcase5_ptr5)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase5_ptr6)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 //void (*fcase5_ptr7)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase5_ptr8)() = &(simulator_type_compile_test<math_types, test5,OpenTissue::mbd::ContinuousFixedStepSimulator> );
 
@@ -20,3 +20,4 @@ void (*fcase4_ptr4)() = &(simulator_type_compile_test<math_types, test4,OpenTiss
 void (*fcase4_ptr5)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase4_ptr6)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 //void (*fcase4_ptr7)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase4_ptr8)() = &(simulator_type_compile_test<math_types, test4,OpenTissue::mbd::ContinuousFixedStepSimulator> );
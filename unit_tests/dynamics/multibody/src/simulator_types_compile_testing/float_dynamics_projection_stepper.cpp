@@ -20,3 +20,4 @@ void (*fcase3_ptr4)() = &(simulator_type_compile_test<math_types, test3,OpenTiss
 void (*fcase3_ptr5)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase3_ptr6)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*fcase3_ptr7)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase3_ptr8)() = &(simulator_type_compile_test<math_types, test3,OpenTissue::mbd::ContinuousFixedStepSimulator> );
@@ -20,3 +20,4 @@ void (*fcase1_ptr4)() = &(simulator_type_compile_test<math_types, test1,OpenTiss
 void (*fcase1_ptr5)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase1_ptr6)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*fcase1_ptr7)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase1_ptr8)() = &(simulator_type_compile_test<math_types, test1,OpenTissue::mbd::ContinuousFixedStepSimulator> );
@@ -21,3 +21,4 @@ void (*fcase2_ptr4)() = &(simulator_type_compile_test<math_types, test2,OpenTiss
 void (*fcase2_ptr5)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase2_ptr6)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*fcase2_ptr7)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase2_ptr8)() = &(simulator_type_compile_test<math_types, test2,OpenTissue::mbd::ContinuousFixedStepSimulator> );
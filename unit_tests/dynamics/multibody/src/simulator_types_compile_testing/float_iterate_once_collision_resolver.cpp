@@ -20,4 +20,5 @@ void (*fcase6_ptr4)() = &(simulator_type_compile_test<math_types, test6,OpenTiss
 void (*fcase6_ptr5)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase6_ptr6)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*fcase6_ptr7)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase6_ptr8)() = &(simulator_type_compile_test<math_types, test6,OpenTissue::mbd::ContinuousFixedStepSimulator> );
 
@@ -21,4 +21,5 @@ void (*fcase7_ptr4)() = &(simulator_type_compile_test<math_types, test7,OpenTiss
 void (*fcase7_ptr5)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase7_ptr6)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*fcase7_ptr7)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase7_ptr8)() = &(simulator_type_compile_test<math_types, test7,OpenTissue::mbd::ContinuousFixedStepSimulator> );
 
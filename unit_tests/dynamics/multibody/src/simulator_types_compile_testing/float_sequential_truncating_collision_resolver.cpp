@@ -20,3 +20,4 @@ void (*fcase8_ptr4)() = &(simulator_type_compile_test<math_types, test8,OpenTiss
 void (*fcase8_ptr5)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::ImplicitFixedStepSimulator> );
 void (*fcase8_ptr6)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::SemiImplicitFixedStepSimulator> );
 void (*fcase8_ptr7)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::SeparatedCollisionContactFixedStepSimulator> );
+void (*fcase8_ptr8)() = &(simulator_type_compile_test<math_types, test8,OpenTissue::mbd::ContinuousFixedStepSimulator> );
@@ -0,0 +1,106 @@
+//
+// OpenTissue, A toolbox for physical based simulation and animation.
+// Copyright (C) 2007 Department of Computer Science, University of Copenhagen
+//
+#include <OpenTissue/configuration.h>
+
+#include <OpenTissue/dynamics/mbd/math/mbd_default_math_policy.h>
+#include <OpenTissue/dynamics/mbd/mbd.h>
+#include <OpenTissue/core/containers/mesh/common/util/mesh_make_box.h>
+
+#include <OpenTissue/utility/utility_push_boost_filter.h>
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/test/unit_test_suite.hpp>
+#include <boost/test/test_tools.hpp>
+#include <OpenTissue/utility/utility_pop_boost_filter.h>
+
+template<typename types>
+class VClipTestCollisionDetection
+  : public OpenTissue::mbd::CollisionDetection<
+  types
+  , OpenTissue::mbd::SpatialHashing
+  , OpenTissue::mbd::GeometryDispatcher
+  , OpenTissue::mbd::SingleGroupAnalysis
+  >
+{};
+
+template< typename types  >
+class VClipTestStepper
+  : public OpenTissue::mbd::DynamicsStepper< types, OpenTissue::mbd::ProjectedGaussSeidel<typename types::math_policy> >
+{};
+
+BOOST_AUTO_TEST_SUITE(opentissue_dynamics_multibody_vclip_handler);
+
+BOOST_AUTO_TEST_CASE(box_rests_on_floor)
+{
+  typedef OpenTissue::mbd::Types<
+    OpenTissue::mbd::default_ublas_math_policy<double>
+    , OpenTissue::mbd::NoSleepyPolicy
+    , VClipTestStepper
+    , VClipTestCollisionDetection
+    , OpenTissue::mbd::ExplicitFixedStepSimulator
+  > types;
+
+  typedef types::math_policy                                       math_policy;
+  typedef math_policy::vector3_type                                vector3_type;
+  typedef types::simulator_type                                    simulator_type;
+  typedef types::body_type                                         body_type;
+  typedef types::configuration_type                                configuration_type;
+  typedef types::material_library_type                             material_library_type;
+  typedef OpenTissue::vclip::Geometry<math_policy>                 vclip_geometry_type;
+  typedef OpenTissue::mbd::collision_detection::VClipHandler<types> vclip_handler_type;
+  typedef OpenTissue::mbd::Gravity<types>                          gravity_type;
+
+  OpenTissue::polymesh::PolyMesh<> tmp;
+
+  vclip_geometry_type    floor_shape;
+  vclip_geometry_type    box_shape;
+  OpenTissue::mesh::make_box(4.0, 4.0, 1.0, tmp);
+  floor_shape.init( tmp );
+  OpenTissue::mesh::make_box(1.0, 1.0, 1.0, tmp);
+  box_shape.init( tmp );
+
+  gravity_type           gravity;
+  body_type              floor;
+  body_type              box;
+  material_library_type  library;
+  simulator_type         simulator;
+  configuration_type     configuration;  // Declared last such that it is destroyed before the bodies
+
+  floor.set_position( vector3_type(0.0, 0.0, 0.0) );
+  floor.set_geometry( &floor_shape );
+  floor.set_fixed( true );
+  configuration.add( &floor );
+
+  box.set_position( vector3_type(0.0, 0.0, 1.05) );
+  box.set_geometry( &box_shape );
+  box.set_mass( 1.0 );
+  box.set_inertia_bf( OpenTissue::math::diag( 1.0/6.0 ) );
+  box.attach( &gravity );
+  configuration.add( &box );
+
+  gravity.set_acceleration( vector3_type(0.0, 0.0, -9.81) );
+
+  configuration.set_material_library( library );
+  library.default_material()->normal_restitution() = 0.0;
+
+  simulator.init( configuration );
+  simulator.get_collision_detection()->get_narrow_phase()->bind( &vclip_handler_type::test );
+
+  for(size_t i=0u;i<100u;++i)
+    simulator.run( 0.01 );
+
+  vector3_type r;
+  box.get_position( r );
+  BOOST_CHECK( r(2) > 0.95 );
+  BOOST_CHECK( r(2) < 1.05 );
+  BOOST_CHECK( std::fabs( r(0) ) < 0.01 );
+  BOOST_CHECK( std::fabs( r(1) ) < 0.01 );
+
+  // The closest features of the last query are kept on the edge between the bodies
+  BOOST_CHECK( configuration.edge_begin() != configuration.edge_end() );
+  for(configuration_type::edge_iterator edge = configuration.edge_begin();edge!=configuration.edge_end();++edge)
+    BOOST_CHECK( !edge->m_vclip_cache.empty() );
+}
+
+BOOST_AUTO_TEST_SUITE_END();